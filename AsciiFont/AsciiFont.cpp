@@ -17,9 +17,126 @@
 #include "AsciiFont.h"
 #include "ascii.h"
 
+static inline const char * get_pattern(char c) {
+    if ((c >= 0x20) && (c <= 0x7e)) {
+        return &g_ascii_table[c - 0x20][0];
+    } else {
+        return &g_ascii_table[10][0]; /* '*' */
+    }
+}
+
+/* Pixel value in the memory order (the upper byte of the colour is written first) */
+template <typename T>
+static inline T make_pixel(uint32_t colour) {
+    uint8_t wk_bytes[sizeof(T)];
+    T pixel;
+    size_t k;
+
+    for (k = 0; k < sizeof(T); k++) {
+        wk_bytes[k] = (uint8_t)(colour >> (8 * (sizeof(T) - 1 - k)));
+    }
+    memcpy(&pixel, wk_bytes, sizeof(T));
+
+    return pixel;
+}
+
+/* Fill the first line, and copy it to the other lines */
+template <typename T>
+static void fill_rect(uint8_t * p_dst, int stride, int width, int height, T pixel) {
+    T * p_line = (T *)p_dst;
+    int i;
+
+    for (i = 0; i < width; i++) {
+        p_line[i] = pixel;
+    }
+    for (i = 1; i < height; i++) {
+        memcpy(p_dst + (stride * i), p_dst, width * sizeof(T));
+    }
+}
+
+template <>
+void fill_rect<uint8_t>(uint8_t * p_dst, int stride, int width, int height, uint8_t pixel) {
+    int i;
+
+    for (i = 0; i < height; i++) {
+        memset(p_dst + (stride * i), pixel, width);
+    }
+}
+
+/* Draw the characters line by line. Each glyph row is written once and copied for font_size > 1. */
+template <typename T>
+static void draw_str(uint8_t * p_dst, int stride, const char * str, int char_num, T fg, T bg, int font_size) {
+    int line_size = char_num * AsciiFont::CHAR_PIX_WIDTH * font_size * sizeof(T);
+    int i, j, n, fw, fh;
+    const char * p_pattern;
+    uint8_t mask;
+    T * p_line;
+    T pixel;
+
+    for (i = 0; i < AsciiFont::CHAR_PIX_HEIGHT; i++) {
+        mask = (uint8_t)(0x80 >> i);
+        p_line = (T *)p_dst;
+        if (font_size == 1) {
+            for (n = 0; n < char_num; n++) {
+                p_pattern = get_pattern(str[n]);
+                p_line[0] = (p_pattern[0] & mask) ? fg : bg;
+                p_line[1] = (p_pattern[1] & mask) ? fg : bg;
+                p_line[2] = (p_pattern[2] & mask) ? fg : bg;
+                p_line[3] = (p_pattern[3] & mask) ? fg : bg;
+                p_line[4] = (p_pattern[4] & mask) ? fg : bg;
+                p_line[5] = (p_pattern[5] & mask) ? fg : bg;
+                p_line += AsciiFont::CHAR_PIX_WIDTH;
+            }
+        } else {
+            for (n = 0; n < char_num; n++) {
+                p_pattern = get_pattern(str[n]);
+                for (j = 0; j < AsciiFont::CHAR_PIX_WIDTH; j++) {
+                    pixel = (p_pattern[j] & mask) ? fg : bg;
+                    for (fw = 0; fw < font_size; fw++) {
+                        *p_line++ = pixel;
+                    }
+                }
+            }
+            for (fh = 1; fh < font_size; fh++) {
+                memcpy(p_dst + (stride * fh), p_dst, line_size);
+            }
+        }
+        p_dst += stride * font_size;
+    }
+}
+
 AsciiFont::AsciiFont(uint8_t * p_buf, int width, int height, int stride, int byte_per_pixel, uint32_t const colour) : 
-    p_text_field(p_buf), max_width(width), max_height(height), buf_stride(stride), pixel_num(byte_per_pixel), background_colour(colour) {
-    
+    p_text_field(p_buf), max_width(width), max_height(height), buf_stride(stride), pixel_num(byte_per_pixel),
+    pixel_bits(0), group_pixel_num(0), background_colour(colour) {
+    /* The specialized drawing needs the pixels aligned to their size */
+    fast_pixel_num = 0;
+    if ((pixel_num == 1) || (pixel_num == 2) || (pixel_num == 4)) {
+        if (((((uintptr_t)p_buf) | (uintptr_t)stride) & (uintptr_t)(pixel_num - 1)) == 0) {
+            fast_pixel_num = pixel_num;
+        }
+    }
+}
+
+AsciiFont::AsciiFont(uint8_t * p_buf, int width, int height, int stride, packed_format_t format, uint32_t const colour,
+                     bit_order_t bit_order, uint8_t swap) :
+    p_text_field(p_buf), max_width(width), max_height(height), buf_stride(stride), pixel_num(0), fast_pixel_num(0),
+    background_colour(colour) {
+    int i, byte_pos, bit_pos, pixel_per_byte;
+
+    pixel_bits = (format == PACKED_CLUT4) ? 4 : 1;
+    pixel_per_byte = 8 / pixel_bits;
+    group_pixel_num = 64 / pixel_bits;
+
+    /* Bit position of each pixel in the 8-byte word read from the memory */
+    for (i = 0; i < group_pixel_num; i++) {
+        byte_pos = i / pixel_per_byte;
+        if (bit_order == BIT_ORDER_MSB_FIRST) {
+            bit_pos = 8 - (pixel_bits * ((i % pixel_per_byte) + 1));
+        } else {
+            bit_pos = pixel_bits * (i % pixel_per_byte);
+        }
+        shift_table[i] = (uint8_t)((8 * (byte_pos ^ (swap & 0x07))) + bit_pos);
+    }
 }
 
 void AsciiFont::Erase() {
@@ -41,7 +158,27 @@ void AsciiFont::Erase(uint32_t const colour, int x, int y, int width, int height
     if ((y + height) > max_height) {
         height = max_height - y;
     }
+    if ((width <= 0) || (height <= 0)) {
+        return;
+    }
+    if (pixel_bits != 0) {
+        fill_packed(x, y, width, height, background_colour);
+        return;
+    }
     idx_base = (x * pixel_num) + (buf_stride * y);
+    switch (fast_pixel_num) {
+        case 1:
+            fill_rect<uint8_t>(&p_text_field[idx_base], buf_stride, width, height, (uint8_t)background_colour);
+            return;
+        case 2:
+            fill_rect<uint16_t>(&p_text_field[idx_base], buf_stride, width, height, make_pixel<uint16_t>(background_colour));
+            return;
+        case 4:
+            fill_rect<uint32_t>(&p_text_field[idx_base], buf_stride, width, height, make_pixel<uint32_t>(background_colour));
+            return;
+        default:
+            break;
+    }
     for (i = 0; i < height; i++) {
         wk_idx = idx_base + (buf_stride * i);
         for (j = 0; j < width; j++) {
@@ -58,22 +195,153 @@ int AsciiFont::DrawStr(const char * str, int x, int y, uint32_t const colour, in
     if ((str == NULL) || (font_size <= 0)) {
         return 0;
     }
-    while ((*str != '\0') && (char_num < max_char_num)) {
-        if (DrawChar(*str, x, y, colour, font_size) == false) {
-            break;
+    if ((fast_pixel_num == 0) && (pixel_bits == 0)) {
+        while ((*str != '\0') && (char_num < max_char_num)) {
+            if (DrawChar(*str, x, y, colour, font_size) == false) {
+                break;
+            }
+            str++;
+            x += CHAR_PIX_WIDTH * font_size;
+            char_num++;
         }
-        str++;
-        x += CHAR_PIX_WIDTH * font_size;
+        return char_num;
+    }
+
+    /* The number of characters in the text field */
+    if ((y + (CHAR_PIX_HEIGHT * font_size)) > max_height) {
+        return 0;
+    }
+    while ((str[char_num] != '\0') && (char_num < max_char_num)
+        && ((x + (CHAR_PIX_WIDTH * font_size * (char_num + 1))) <= max_width)) {
         char_num++;
     }
+    if (char_num == 0) {
+        return 0;
+    }
+
+    if (pixel_bits != 0) {
+        draw_packed(str, char_num, x, y, colour, font_size);
+    } else {
+        draw_fast(str, char_num, x, y, colour, font_size);
+    }
     return char_num;
 }
 
+void AsciiFont::draw_fast(const char * str, int char_num, int x, int y, uint32_t const colour, int font_size) {
+    int idx_base = (x * pixel_num) + (buf_stride * y);
+
+    if (fast_pixel_num == 1) {
+        draw_str<uint8_t>(&p_text_field[idx_base], buf_stride, str, char_num,
+                          (uint8_t)colour, (uint8_t)background_colour, font_size);
+    } else if (fast_pixel_num == 2) {
+        draw_str<uint16_t>(&p_text_field[idx_base], buf_stride, str, char_num,
+                           make_pixel<uint16_t>(colour), make_pixel<uint16_t>(background_colour), font_size);
+    } else {
+        draw_str<uint32_t>(&p_text_field[idx_base], buf_stride, str, char_num,
+                           make_pixel<uint32_t>(colour), make_pixel<uint32_t>(background_colour), font_size);
+    }
+}
+
+void AsciiFont::fill_packed(int x, int y, int width, int height, uint32_t const colour) {
+    uint32_t index = colour & ((1u << pixel_bits) - 1);
+    int first_group = x / group_pixel_num;
+    int last_group = (x + width - 1) / group_pixel_num;
+    uint64_t first_mask = 0, first_val = 0;
+    uint64_t last_mask = 0, last_val = 0;
+    uint64_t full_val = 0;
+    uint8_t * p_line;
+    int i, g;
+
+    for (i = 0; i < group_pixel_num; i++) {
+        full_val |= (uint64_t)index << shift_table[i];
+    }
+    for (i = x; (i < (x + width)) && (i < ((first_group + 1) * group_pixel_num)); i++) {
+        first_mask |= (uint64_t)((1u << pixel_bits) - 1) << shift_table[i % group_pixel_num];
+    }
+    first_val = full_val & first_mask;
+    for (i = last_group * group_pixel_num; i < (x + width); i++) {
+        last_mask |= (uint64_t)((1u << pixel_bits) - 1) << shift_table[i % group_pixel_num];
+    }
+    last_val = full_val & last_mask;
+
+    for (i = 0; i < height; i++) {
+        p_line = &p_text_field[buf_stride * (y + i)];
+        rmw_packed(&p_line[first_group * 8], first_mask, first_val);
+        for (g = first_group + 1; g < last_group; g++) {
+            memcpy(&p_line[g * 8], &full_val, 8);
+        }
+        if (last_group != first_group) {
+            rmw_packed(&p_line[last_group * 8], last_mask, last_val);
+        }
+    }
+}
+
+void AsciiFont::draw_packed(const char * str, int char_num, int x, int y, uint32_t const colour, int font_size) {
+    uint64_t pixel_mask = (1u << pixel_bits) - 1;
+    uint64_t fg = colour & pixel_mask;
+    uint64_t bg = background_colour & pixel_mask;
+    int end_x = x + (char_num * CHAR_PIX_WIDTH * font_size);
+    int i, p, g, fh, n, j, fw, group_end;
+    uint64_t mask, val;
+    const char * p_pattern;
+    uint8_t row_mask;
+    uint8_t * p_line;
+
+    for (i = 0; i < CHAR_PIX_HEIGHT; i++) {
+        row_mask = (uint8_t)(0x80 >> i);
+        p_line = &p_text_field[buf_stride * (y + (i * font_size))];
+        n = 0;
+        j = 0;
+        fw = 0;
+        p_pattern = get_pattern(str[0]);
+        p = x;
+        while (p < end_x) {
+            /* Make the pixels in an 8-byte word, and write them to font_size lines */
+            g = p / group_pixel_num;
+            group_end = (g + 1) * group_pixel_num;
+            if (group_end > end_x) {
+                group_end = end_x;
+            }
+            mask = 0;
+            val = 0;
+            for (; p < group_end; p++) {
+                mask |= pixel_mask << shift_table[p % group_pixel_num];
+                val |= ((p_pattern[j] & row_mask) ? fg : bg) << shift_table[p % group_pixel_num];
+                if (++fw == font_size) {
+                    fw = 0;
+                    if (++j == CHAR_PIX_WIDTH) {
+                        j = 0;
+                        if (++n < char_num) {
+                            p_pattern = get_pattern(str[n]);
+                        }
+                    }
+                }
+            }
+            for (fh = 0; fh < font_size; fh++) {
+                rmw_packed(&p_line[(buf_stride * fh) + (g * 8)], mask, val);
+            }
+        }
+    }
+}
+
+void AsciiFont::rmw_packed(uint8_t * p_word, uint64_t mask, uint64_t val) {
+    uint64_t wk_word;
+
+    /* Little-endian: byte n of the memory is bit 8n-8n+7 of the word */
+    if (mask == 0xFFFFFFFFFFFFFFFFull) {
+        memcpy(p_word, &val, 8);
+    } else {
+        memcpy(&wk_word, p_word, 8);
+        wk_word = (wk_word & ~mask) | val;
+        memcpy(p_word, &wk_word, 8);
+    }
+}
+
 bool AsciiFont::DrawChar(char c, int x, int y, uint32_t const colour, int font_size) {
     int idx_base;
     int idx_y = 0;
     int wk_idx, i, j ,k, fw, fh;
-    char * p_pattern;
+    const char * p_pattern;
     uint8_t mask = 0x80;
     uint32_t wk_colour;
 
@@ -87,11 +355,16 @@ bool AsciiFont::DrawChar(char c, int x, int y, uint32_t const colour, int font_s
         return false;
     }
 
-    if ((c >= 0x20) && (c <= 0x7e)) {
-        p_pattern = (char *)&g_ascii_table[c - 0x20][0];
-    } else {
-        p_pattern = (char *)&g_ascii_table[10][0]; /* '*' */
+    if (pixel_bits != 0) {
+        draw_packed(&c, 1, x, y, colour, font_size);
+        return true;
     }
+    if (fast_pixel_num != 0) {
+        draw_fast(&c, 1, x, y, colour, font_size);
+        return true;
+    }
+
+    p_pattern = get_pattern(c);
     idx_base = (x * pixel_num) + (buf_stride * y);
 
     /* Drawing */
@@ -71,8 +71,22 @@
 
 class AsciiFont {
 public:
+    /** Packed pixel format */
+    typedef enum {
+        PACKED_CLUT4,       /**< CLUT4 (0.5byte / px) */
+        PACKED_CLUT1,       /**< CLUT1 (0.125byte / px) */
+    } packed_format_t;
+
+    /** Order of the pixels in a byte */
+    typedef enum {
+        BIT_ORDER_MSB_FIRST,    /**< The left pixel is in the upper bits */
+        BIT_ORDER_LSB_FIRST,    /**< The left pixel is in the lower bits */
+    } bit_order_t;
 
     /** Constructor: Initializes AsciiFont.
+     *
+     * When byte_per_pixel is 1, 2 or 4 and p_buf and stride are aligned to it,
+     * the characters are drawn by the renderers specialized for the pixel size.
      *
      * @param p_buf Text field address
      * @param width Text field width
@@ -83,6 +97,23 @@ public:
      */
     AsciiFont(uint8_t * p_buf, int width, int height, int stride, int byte_per_pixel, uint32_t const colour = 0);
 
+    /** Constructor: Initializes AsciiFont for a CLUT4 or CLUT1 layer.
+     *
+     * The colours are CLUT indexes. The pixels are written by read-modify-write of 8-byte words,
+     * so p_buf and stride must be multiples of 8.
+     *
+     * @param p_buf Text field address
+     * @param width Text field width
+     * @param height Text field height
+     * @param stride Buffer stride
+     * @param format PACKED_CLUT4 or PACKED_CLUT1
+     * @param colour Background color
+     * @param bit_order Order of the pixels in a byte
+     * @param swap Byte swap in 8-byte units, the same value as DisplayBase::wr_rd_swa_t of Graphics_Read_Setting
+     */
+    AsciiFont(uint8_t * p_buf, int width, int height, int stride, packed_format_t format, uint32_t const colour = 0,
+              bit_order_t bit_order = BIT_ORDER_MSB_FIRST, uint8_t swap = 0);
+
     /** Erase text field
      *
      */
@@ -104,6 +135,14 @@ public:
      */
     void Erase(uint32_t const colour, int x, int y, int width, int height);
 
+    /** Set the background color without erasing
+     *
+     * @param colour Background color of the characters drawn after this
+     */
+    void SetBackground(uint32_t const colour) {
+        background_colour = colour;
+    }
+
     /** Draw a string
      *
      * @param str String
@@ -142,6 +181,15 @@ private:
     int max_height;
     int buf_stride;
     int pixel_num;
+    int fast_pixel_num;      /* 1, 2, 4: specialized drawing, 0: generic drawing */
+    int pixel_bits;          /* 4, 1: packed pixel, 0: byte_per_pixel */
+    int group_pixel_num;     /* Number of the packed pixels in 8 bytes */
+    uint8_t shift_table[64];
     uint32_t background_colour;
+
+    void draw_fast(const char * str, int char_num, int x, int y, uint32_t const colour, int font_size);
+    void fill_packed(int x, int y, int width, int height, uint32_t const colour);
+    void draw_packed(const char * str, int char_num, int x, int y, uint32_t const colour, int font_size);
+    static void rmw_packed(uint8_t * p_word, uint64_t mask, uint64_t val);
 };
 #endif
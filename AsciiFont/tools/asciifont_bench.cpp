@@ -0,0 +1,135 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          asciifont_bench.cpp
+* @brief         Characters/s of AsciiFont::DrawStr on a Linux host
+*
+* A line of 80 characters is drawn repeatedly to a text field of the LCD width, and the
+* characters/s are printed for each pixel format and font size:
+*   baseline     the byte by byte renderer of the baseline (asciifont_baseline.h)
+*   generic      AsciiFont with the buffer not aligned to the pixel size (the generic path)
+*   specialized  AsciiFont with the aligned buffer (draw_fast / draw_packed)
+* "-" is printed when the path does not exist for the format.
+*
+* Build (from AsciiFont/):
+*   g++ -O2 -I. -I../DisplayApp/tools/host_mbed -o asciifont_bench tools/asciifont_bench.cpp AsciiFont.cpp ascii.c
+*
+* Usage:
+*   asciifont_bench [-n loops]
+*     -n  number of DrawStr calls of each measurement (default 20000)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "AsciiFont.h"
+#include "asciifont_baseline.h"
+
+#define LINE_CHAR_NUM   (80)
+#define FIELD_H         (AsciiFont::CHAR_PIX_HEIGHT * 4)
+
+static int loops = 20000;
+static char line_str[LINE_CHAR_NUM + 1];
+
+/* Characters/s of DrawStr of a font */
+template <class FONT>
+static double run(FONT & font, int font_size) {
+    std::chrono::steady_clock::time_point start;
+    int chars = 0;
+    double sec;
+    int n;
+
+    (void)font.DrawStr(line_str, 0, 0, 0xFFFFFFFFu, font_size);    /* Warm up */
+    start = std::chrono::steady_clock::now();
+    for (n = 0; n < loops; n++) {
+        chars += font.DrawStr(&line_str[n & 7], 0, 0, 0x12345678u + (uint32_t)n, font_size);
+    }
+    sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double)chars / sec;
+}
+
+static void print_value(double chars_per_sec) {
+    if (chars_per_sec < 0.0) {
+        printf(" %12s", "-");
+    } else {
+        printf(" %12.0f", chars_per_sec);
+    }
+}
+
+int main(int argc, char * argv[]) {
+    int font_size;
+    int bpp;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+            loops = atoi(argv[++i]);
+        } else {
+            printf("usage: asciifont_bench [-n loops]\n");
+            return 2;
+        }
+    }
+    if (loops <= 0) {
+        return 2;
+    }
+    for (i = 0; i < LINE_CHAR_NUM; i++) {
+        line_str[i] = (char)(0x20 + ((i * 7) % 0x5F));
+    }
+    line_str[LINE_CHAR_NUM] = '\0';
+
+    printf("%d DrawStr calls, characters/s\n", loops);
+    printf("%-10s %9s %12s %12s %12s\n", "format", "font_size", "baseline", "generic", "specialized");
+    for (font_size = 1; font_size <= 2; font_size++) {
+        int width = LINE_CHAR_NUM * AsciiFont::CHAR_PIX_WIDTH * font_size;
+
+        for (bpp = 1; bpp <= 4; bpp++) {
+            int stride = (width * bpp + 7) & ~7;
+            /* uint64_t for the alignment, one more word for the unaligned field */
+            std::vector<uint64_t> buf(((size_t)(stride * FIELD_H) / 8) + 1);
+            uint8_t * p_buf = (uint8_t *)&buf[0];
+            AsciiFontBaseline baseline(p_buf, width, FIELD_H, stride, bpp);
+            AsciiFont aligned(p_buf, width, FIELD_H, stride, bpp);
+            AsciiFont unaligned(p_buf + 1, width, FIELD_H, stride, bpp);
+
+            printf("%d byte/px  %9d", bpp, font_size);
+            print_value(run(baseline, font_size));
+            if ((bpp == 1) || (bpp == 3)) {
+                /* 1 byte/px is always aligned, and 3 byte/px has only the generic path */
+                print_value((bpp == 3) ? run(aligned, font_size) : -1.0);
+                print_value((bpp == 3) ? -1.0 : run(aligned, font_size));
+            } else {
+                print_value(run(unaligned, font_size));
+                print_value(run(aligned, font_size));
+            }
+            printf("\n");
+        }
+        for (i = 0; i < 2; i++) {
+            AsciiFont::packed_format_t format = (i == 0) ? AsciiFont::PACKED_CLUT4 : AsciiFont::PACKED_CLUT1;
+            int stride = (((width * ((i == 0) ? 4 : 1)) + 63) / 64) * 8;
+            std::vector<uint64_t> buf((size_t)(stride * FIELD_H) / 8);
+            AsciiFont packed((uint8_t *)&buf[0], width, FIELD_H, stride, format);
+
+            printf("%-10s %9d", (i == 0) ? "CLUT4" : "CLUT1", font_size);
+            print_value(-1.0);
+            print_value(-1.0);
+            print_value(run(packed, font_size));
+            printf("\n");
+        }
+    }
+    return 0;
+}
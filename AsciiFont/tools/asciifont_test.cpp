@@ -0,0 +1,207 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          asciifont_test.cpp
+* @brief         Byte for byte check of AsciiFont against the baseline renderer on a Linux host
+*
+* The same sequence of Erase / DrawStr / DrawChar is run by AsciiFont and by the baseline renderer
+* (asciifont_baseline.h), and the whole buffers including the stride padding and guard bytes
+* must be equal, as well as the return values. The sequences cover 1 to 4 bytes per pixel,
+* buffers aligned and not aligned to the pixel size (the specialized and the generic drawing),
+* font sizes 1 to 3, characters out of 0x20-0x7e, max_char_num and strings clipped at the right
+* and bottom edges.
+* The CLUT4 / CLUT1 fields are compared with the baseline output of 1 byte per pixel packed
+* by the bit order and the 8-byte swap.
+*
+* Build (from AsciiFont/):
+*   g++ -O2 -I. -I../DisplayApp/tools/host_mbed -o asciifont_test tools/asciifont_test.cpp AsciiFont.cpp ascii.c
+*
+* The exit status is 1 if a case fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "AsciiFont.h"
+#include "asciifont_baseline.h"
+
+#define FIELD_W     (100)
+#define FIELD_H     (40)
+#define GUARD_SIZE  (16)
+
+static const char * const str_list[] = {
+    "Hello, World!",
+    "\x01\t\x7f~ {|}",
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+    "",
+};
+
+static int total;
+static int fail;
+
+static void check(bool ok, const char * label, int font_size, int seq) {
+    total++;
+    if (!ok) {
+        printf("NG: %-28s font_size %d sequence %d\n", label, font_size, seq);
+        fail++;
+    }
+}
+
+/* Run a sequence on a font. The return values of DrawStr / DrawChar are appended to ret. */
+template <class FONT>
+static void run_sequence(FONT & font, int seq, int font_size, uint32_t fg, uint32_t bg, std::vector<int> & ret) {
+    int cw = AsciiFont::CHAR_PIX_WIDTH * font_size;
+    int ch = AsciiFont::CHAR_PIX_HEIGHT * font_size;
+    size_t s;
+
+    font.Erase(bg, 0, 0, FIELD_W, FIELD_H);
+    switch (seq) {
+        case 0:     /* Strings at various positions, clipped at the right edge */
+            for (s = 0; s < (sizeof(str_list) / sizeof(str_list[0])); s++) {
+                ret.push_back(font.DrawStr(str_list[s], (int)s * 5, (int)s * (ch / 2), fg + (uint32_t)s, font_size));
+            }
+            break;
+        case 1:     /* max_char_num, and a string just fitting the width */
+            ret.push_back(font.DrawStr(str_list[2], 1, 0, fg, font_size, 3));
+            ret.push_back(font.DrawStr(str_list[0], 3, ch, fg, font_size, 0));
+            ret.push_back(font.DrawStr(str_list[2], FIELD_W - (cw * 2), 1, fg, font_size));
+            ret.push_back(font.DrawStr(str_list[2], FIELD_W - (cw * 2) + 1, ch, fg, font_size));
+            break;
+        case 2:     /* Bottom edge and DrawChar */
+            ret.push_back(font.DrawStr(str_list[0], 2, FIELD_H - ch, fg, font_size));
+            ret.push_back(font.DrawStr(str_list[0], 2, FIELD_H - ch + 1, fg, font_size));
+            ret.push_back(font.DrawChar('Q', 7, 3, fg, font_size) ? 1 : 0);
+            ret.push_back(font.DrawChar('\n', FIELD_W - cw, 0, fg, font_size) ? 1 : 0);
+            ret.push_back(font.DrawChar('R', FIELD_W - cw + 1, 0, fg, font_size) ? 1 : 0);
+            break;
+        default:    /* Erase of a part, the background colour changed by Erase */
+            ret.push_back(font.DrawStr(str_list[0], 0, 0, fg, font_size));
+            font.Erase(bg ^ 0x5A5A5A5Au, 5, 3, 17, 9);
+            ret.push_back(font.DrawStr(str_list[1], 4, 4, fg, font_size));
+            font.Erase(bg, FIELD_W - 7, FIELD_H - 5, 20, 20);
+            ret.push_back(font.DrawStr(str_list[2], 0, ch + 2, fg, font_size));
+            break;
+    }
+}
+
+#define SEQUENCE_NUM    (4)
+
+static void test_byte_per_pixel(int bpp, int offset) {
+    int stride = (((FIELD_W * bpp) + 7) & ~7) + 8;
+    size_t size = (size_t)(stride * FIELD_H) + GUARD_SIZE + offset;
+    uint32_t fg = 0x81C3E7F0u >> (8 * (4 - bpp));
+    uint32_t bg = 0x1E2D3C4Bu >> (8 * (4 - bpp));
+    char label[32];
+    int font_size;
+    int seq;
+    size_t i;
+
+    snprintf(label, sizeof(label), "%d byte/px offset %d", bpp, offset);
+    for (font_size = 1; font_size <= 3; font_size++) {
+        for (seq = 0; seq < SEQUENCE_NUM; seq++) {
+            /* The buffers are uint64_t for the alignment */
+            std::vector<uint64_t> buf((size + 7) / 8);
+            std::vector<uint64_t> ref_buf((size + 7) / 8);
+            uint8_t * p_buf = (uint8_t *)&buf[0];
+            uint8_t * p_ref = (uint8_t *)&ref_buf[0];
+            std::vector<int> ret;
+            std::vector<int> ref_ret;
+
+            for (i = 0; i < size; i++) {
+                p_buf[i] = (uint8_t)(i * 13);
+                p_ref[i] = (uint8_t)(i * 13);
+            }
+            AsciiFont font(p_buf + offset, FIELD_W, FIELD_H, stride, bpp);
+            AsciiFontBaseline ref(p_ref + offset, FIELD_W, FIELD_H, stride, bpp);
+
+            run_sequence(font, seq, font_size, fg, bg, ret);
+            run_sequence(ref, seq, font_size, fg, bg, ref_ret);
+            check((ret == ref_ret) && (memcmp(p_buf, p_ref, size) == 0), label, font_size, seq);
+        }
+    }
+}
+
+static void test_packed(AsciiFont::packed_format_t format, AsciiFont::bit_order_t bit_order, uint8_t swap) {
+    int bits = (format == AsciiFont::PACKED_CLUT4) ? 4 : 1;
+    int stride = (((FIELD_W * bits) + 63) / 64) * 8 + 8;
+    size_t size = (size_t)(stride * FIELD_H);
+    int pixel_per_byte = 8 / bits;
+    uint32_t fg = (bits == 4) ? 0x0B : 0x01;
+    uint32_t bg = (bits == 4) ? 0x06 : 0x00;
+    char label[32];
+    int font_size;
+    int seq;
+    int x;
+    int y;
+    size_t i;
+
+    snprintf(label, sizeof(label), "CLUT%d %s swap %d", bits,
+             (bit_order == AsciiFont::BIT_ORDER_MSB_FIRST) ? "MSB first" : "LSB first", swap);
+    for (font_size = 1; font_size <= 3; font_size++) {
+        for (seq = 0; seq < SEQUENCE_NUM; seq++) {
+            std::vector<uint64_t> buf(size / 8);
+            std::vector<uint64_t> exp_buf(size / 8);
+            std::vector<uint8_t> ref_buf((size_t)FIELD_W * FIELD_H);
+            uint8_t * p_buf = (uint8_t *)&buf[0];
+            uint8_t * p_exp = (uint8_t *)&exp_buf[0];
+            std::vector<int> ret;
+            std::vector<int> ref_ret;
+
+            for (i = 0; i < size; i++) {
+                p_buf[i] = (uint8_t)(i * 29);
+                p_exp[i] = (uint8_t)(i * 29);
+            }
+            AsciiFont font(p_buf, FIELD_W, FIELD_H, stride, format, 0, bit_order, swap);
+            AsciiFontBaseline ref(&ref_buf[0], FIELD_W, FIELD_H, FIELD_W, 1);
+
+            /* The baseline writes the low byte of the colours, which are the CLUT indexes here */
+            run_sequence(font, seq, font_size, fg, bg, ret);
+            run_sequence(ref, seq, font_size, fg, bg, ref_ret);
+            for (y = 0; y < FIELD_H; y++) {
+                for (x = 0; x < FIELD_W; x++) {
+                    uint32_t idx = ref_buf[(y * FIELD_W) + x] & ((1u << bits) - 1);
+                    int byte_pos = (x / pixel_per_byte) ^ (swap & 0x07);
+                    int bit_pos = (bit_order == AsciiFont::BIT_ORDER_MSB_FIRST)
+                                  ? (8 - (bits * ((x % pixel_per_byte) + 1))) : (bits * (x % pixel_per_byte));
+                    uint8_t * p_byte = &p_exp[(stride * y) + byte_pos];
+
+                    *p_byte = (uint8_t)((*p_byte & ~(((1u << bits) - 1) << bit_pos)) | (idx << bit_pos));
+                }
+            }
+            check((ret == ref_ret) && (memcmp(p_buf, p_exp, size) == 0), label, font_size, seq);
+        }
+    }
+}
+
+int main(void) {
+    int bpp;
+    int offset;
+
+    for (bpp = 1; bpp <= 4; bpp++) {
+        for (offset = 0; offset < 2; offset++) {
+            test_byte_per_pixel(bpp, offset);
+        }
+    }
+    test_packed(AsciiFont::PACKED_CLUT4, AsciiFont::BIT_ORDER_MSB_FIRST, 0);
+    test_packed(AsciiFont::PACKED_CLUT4, AsciiFont::BIT_ORDER_LSB_FIRST, 0);
+    test_packed(AsciiFont::PACKED_CLUT4, AsciiFont::BIT_ORDER_MSB_FIRST, 7);
+    test_packed(AsciiFont::PACKED_CLUT1, AsciiFont::BIT_ORDER_MSB_FIRST, 0);
+    test_packed(AsciiFont::PACKED_CLUT1, AsciiFont::BIT_ORDER_LSB_FIRST, 6);
+
+    printf("%d / %d cases passed\n", total - fail, total);
+    return (fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,672 @@
+/* mbed AviRecorder Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "AviRecorder.h"
+
+#define SECTOR_SIZE             (512u)
+#define SECTOR_ALIGN_DOWN(x)    ((x) & ~(SECTOR_SIZE - 1))
+#define SECTOR_ALIGN_UP(x)      (((x) + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1))
+#define RIFF_MAX_SIZE           (0x3FF00000u)   /* a little less than 1GB */
+
+#define AVIF_HASINDEX           (0x00000010u)
+#define AVIIF_KEYFRAME          (0x00000010u)
+#define AVI_INDEX_OF_INDEXES    (0x00)
+#define AVI_INDEX_OF_CHUNKS     (0x01)
+
+/* Offsets in the headers of the first RIFF */
+#define OFS_RIFF_SIZE           (4)
+#define OFS_HDRL_SIZE           (16)
+#define OFS_AVIH                (24)
+#define OFS_AVIH_FLAGS          (44)
+#define OFS_AVIH_FRAMES         (48)
+#define OFS_AVIH_BUFSIZE        (60)
+#define OFS_AVIH_MAXBPS         (36)
+#define OFS_STRL                (88)
+#define OFS_STRH                (100)
+#define OFS_STRH_LENGTH         (140)
+#define OFS_STRH_BUFSIZE        (144)
+#define OFS_STRF                (164)
+#define OFS_INDX                (212)
+#define OFS_INDX_IN_USE         (224)
+#define OFS_INDX_ENTRY          (244)
+#define SUPER_INDEX_ENTRY_SIZE  (16)
+#define OFS_ODML                (OFS_INDX_ENTRY + (SUPER_INDEX_ENTRY_SIZE * AVI_RECORDER_SUPER_INDEX_NUM))
+#define OFS_DMLH_FRAMES         (OFS_ODML + 20)
+#define OFS_JUNK                (OFS_ODML + 268)
+/* The first frame starts at a sector boundary */
+#define OFS_MOVI_LIST           (SECTOR_ALIGN_UP(OFS_JUNK + 8 + 12) - 12)
+#define HEADER_SIZE             (OFS_MOVI_LIST + 12)
+
+#define STD_INDEX_HEADER_SIZE   (32)
+#define STD_INDEX_ENTRY_SIZE    (8)
+#define IDX1_ENTRY_SIZE         (16)
+
+static inline void set_le16(uint8_t * p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void set_le32(uint8_t * p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static inline void set_fourcc(uint8_t * p, const char * fourcc) {
+    memcpy(p, fourcc, 4);
+}
+
+AviRecorder::AviRecorder() : fp(NULL), header(NULL), wbuf(NULL), entries(NULL), error(false) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+AviRecorder::~AviRecorder() {
+    if (fp != NULL) {
+        Close();
+    }
+}
+
+bool AviRecorder::Open(const char * file_name, uint16_t width, uint16_t height, uint32_t frame_rate,
+                       uint32_t prealloc_size, uint32_t checkpoint_frames) {
+    uint8_t * p;
+
+    if ((fp != NULL) || (file_name == NULL) || (frame_rate == 0)) {
+        return false;
+    }
+
+    header = new uint8_t[HEADER_SIZE];
+    wbuf   = new uint8_t[AVI_RECORDER_WRITE_BUFFER_SIZE];
+    entry_max = frame_rate * 60;
+    entries = (index_entry_t *)malloc(sizeof(index_entry_t) * entry_max);
+    if ((header == NULL) || (wbuf == NULL) || (entries == NULL)) {
+        goto error_end;
+    }
+
+    fp = fopen(file_name, "wb");
+    if (fp == NULL) {
+        goto error_end;
+    }
+    setvbuf(fp, NULL, _IONBF, 0);   // The data is written in sector units from wbuf
+
+    memset(&stats, 0, sizeof(stats));
+    wbuf_pos = 0;
+    wbuf_len = 0;
+    file_end = 0;
+    entry_num = 0;
+    checkpoint_start = 0;
+    super_index_num = 0;
+    grow_index_num = AVI_RECORDER_SUPER_INDEX_NUM / 2;
+    index_full = false;
+    segment = 0;
+    riff_pos = 0;
+    movi_pos = OFS_MOVI_LIST + 8;
+    first_frames = 0;
+    indexed_frames = 0;
+    max_frame_size = 0;
+    frames_since_checkpoint = 0;
+    fps = frame_rate;
+    first_riff_closed = false;
+    error = false;
+    if (checkpoint_frames != 0) {
+        checkpoint_interval = checkpoint_frames;
+    } else {
+        checkpoint_interval = frame_rate * AVI_RECORDER_CHECKPOINT_SEC;
+    }
+
+    // Allocate the clusters in advance, so that the FAT is not updated while recording
+    prealloc_end = 0;
+    if (prealloc_size > HEADER_SIZE) {
+        if ((fseek(fp, prealloc_size - 1, SEEK_SET) == 0) && (fputc(0, fp) != EOF)) {
+            prealloc_end = prealloc_size;
+        }
+        fflush(fp);
+        fseek(fp, 0, SEEK_SET);
+    }
+
+    memset(header, 0, HEADER_SIZE);
+    p = header;
+    set_fourcc(&p[0], "RIFF");
+    set_le32(&p[OFS_RIFF_SIZE], HEADER_SIZE - 8);
+    set_fourcc(&p[8], "AVI ");
+    set_fourcc(&p[12], "LIST");
+    set_le32(&p[OFS_HDRL_SIZE], OFS_JUNK - 20);
+    set_fourcc(&p[20], "hdrl");
+
+    set_fourcc(&p[OFS_AVIH], "avih");
+    set_le32(&p[OFS_AVIH + 4], 56);
+    set_le32(&p[OFS_AVIH + 8], 1000000 / frame_rate);      // dwMicroSecPerFrame
+    set_le32(&p[OFS_AVIH + 28], 0);                         // dwInitialFrames
+    set_le32(&p[OFS_AVIH + 32], 1);                         // dwStreams
+    set_le32(&p[OFS_AVIH + 40], width);
+    set_le32(&p[OFS_AVIH + 44], height);
+
+    set_fourcc(&p[OFS_STRL], "LIST");
+    set_le32(&p[OFS_STRL + 4], OFS_ODML - (OFS_STRL + 8));
+    set_fourcc(&p[OFS_STRL + 8], "strl");
+
+    set_fourcc(&p[OFS_STRH], "strh");
+    set_le32(&p[OFS_STRH + 4], 56);
+    set_fourcc(&p[OFS_STRH + 8], "vids");
+    set_fourcc(&p[OFS_STRH + 12], "MJPG");
+    set_le32(&p[OFS_STRH + 28], 1);                         // dwScale
+    set_le32(&p[OFS_STRH + 32], frame_rate);                // dwRate
+    set_le32(&p[OFS_STRH + 48], 0xFFFFFFFF);                // dwQuality
+    set_le16(&p[OFS_STRH + 60], width);                     // rcFrame
+    set_le16(&p[OFS_STRH + 62], height);
+
+    set_fourcc(&p[OFS_STRF], "strf");
+    set_le32(&p[OFS_STRF + 4], 40);
+    set_le32(&p[OFS_STRF + 8], 40);                         // biSize
+    set_le32(&p[OFS_STRF + 12], width);
+    set_le32(&p[OFS_STRF + 16], height);
+    set_le16(&p[OFS_STRF + 20], 1);                         // biPlanes
+    set_le16(&p[OFS_STRF + 22], 24);                        // biBitCount
+    set_fourcc(&p[OFS_STRF + 24], "MJPG");
+    set_le32(&p[OFS_STRF + 28], (uint32_t)width * height * 3);
+
+    set_fourcc(&p[OFS_INDX], "indx");
+    set_le32(&p[OFS_INDX + 4], 24 + (SUPER_INDEX_ENTRY_SIZE * AVI_RECORDER_SUPER_INDEX_NUM));
+    set_le16(&p[OFS_INDX + 8], 4);                          // wLongsPerEntry
+    p[OFS_INDX + 11] = AVI_INDEX_OF_INDEXES;
+    set_fourcc(&p[OFS_INDX + 16], "00dc");
+
+    set_fourcc(&p[OFS_ODML], "LIST");
+    set_le32(&p[OFS_ODML + 4], 260);
+    set_fourcc(&p[OFS_ODML + 8], "odml");
+    set_fourcc(&p[OFS_ODML + 12], "dmlh");
+    set_le32(&p[OFS_ODML + 16], 248);
+
+    set_fourcc(&p[OFS_JUNK], "JUNK");
+    set_le32(&p[OFS_JUNK + 4], OFS_MOVI_LIST - (OFS_JUNK + 8));
+
+    set_fourcc(&p[OFS_MOVI_LIST], "LIST");
+    set_le32(&p[OFS_MOVI_LIST + 4], 4);
+    set_fourcc(&p[OFS_MOVI_LIST + 8], "movi");
+
+    if (!put_data(header, HEADER_SIZE)) {
+        goto error_end;
+    }
+    rec_timer.reset();
+    rec_timer.start();
+
+    return true;
+
+error_end:
+    if (fp != NULL) {
+        fclose(fp);
+        fp = NULL;
+    }
+    delete [] header;
+    delete [] wbuf;
+    free(entries);
+    header = NULL;
+    wbuf = NULL;
+    entries = NULL;
+    return false;
+}
+
+bool AviRecorder::AddFrame(const void * p_jpeg, size_t size) {
+    uint8_t chunk_header[8];
+    uint8_t pad = 0;
+    uint32_t chunk_size;
+    uint32_t reserve;
+    int start_us;
+    int time_us;
+
+    if ((fp == NULL) || (error) || (index_full) || (p_jpeg == NULL) || (size == 0)) {
+        return false;
+    }
+    start_us = rec_timer.read_us();
+
+    chunk_size = 8 + size + (size & 1);
+    reserve = STD_INDEX_HEADER_SIZE + ((entry_num - checkpoint_start + 1) * STD_INDEX_ENTRY_SIZE);
+    if (segment == 0) {
+        reserve += 8 + ((entry_num + 1) * IDX1_ENTRY_SIZE);
+    }
+    if ((file_end - riff_pos + chunk_size + reserve) > RIFF_MAX_SIZE) {
+        if (!next_segment()) {
+            return false;
+        }
+    }
+
+    if (!add_entry(file_end - movi_pos, size)) {
+        return false;
+    }
+    set_fourcc(&chunk_header[0], "00dc");
+    set_le32(&chunk_header[4], size);
+    if ((!put_data(chunk_header, sizeof(chunk_header))) || (!put_data(p_jpeg, size))) {
+        return false;
+    }
+    if ((size & 1) != 0) {
+        if (!put_data(&pad, 1)) {
+            return false;
+        }
+    }
+    if (size > max_frame_size) {
+        max_frame_size = size;
+    }
+    if (segment == 0) {
+        first_frames++;
+    }
+    stats.frames++;
+    stats.payload_bytes += size;
+
+    frames_since_checkpoint++;
+    if (frames_since_checkpoint >= checkpoint_interval) {
+        if (!checkpoint(false)) {
+            return false;
+        }
+    }
+
+    time_us = rec_timer.read_us() - start_us;
+    if ((uint32_t)time_us > stats.max_frame_us) {
+        stats.max_frame_us = (uint32_t)time_us;
+    }
+    stats.elapsed_ms = (uint32_t)rec_timer.read_ms();
+
+    return true;
+}
+
+bool AviRecorder::Checkpoint(void) {
+    if ((fp == NULL) || (error)) {
+        return false;
+    }
+    return checkpoint(false);
+}
+
+bool AviRecorder::Close(void) {
+    uint8_t junk_header[8];
+    bool result = true;
+
+    if (fp == NULL) {
+        return false;
+    }
+
+    if (!error) {
+        if (!checkpoint(true)) {
+            result = false;
+        }
+    }
+    if ((!error) && (!first_riff_closed)) {
+        if (!write_idx1()) {
+            result = false;
+        }
+    }
+    if ((!error) && (!flush_wbuf(true))) {
+        result = false;
+    }
+    // Mark the rest of the allocated area as JUNK
+    if ((!error) && (prealloc_end >= (file_end + sizeof(junk_header)))) {
+        set_fourcc(&junk_header[0], "JUNK");
+        set_le32(&junk_header[4], prealloc_end - file_end - sizeof(junk_header));
+        if (!write_at(file_end, junk_header, sizeof(junk_header))) {
+            result = false;
+        }
+    }
+    if (fclose(fp) != 0) {
+        result = false;
+    }
+    fp = NULL;
+    if (error) {
+        result = false;
+    }
+
+    delete [] header;
+    delete [] wbuf;
+    free(entries);
+    header = NULL;
+    wbuf = NULL;
+    entries = NULL;
+
+    return result;
+}
+
+void AviRecorder::GetStats(stats_t * p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    *p_stats = stats;
+    p_stats->checkpoint_frames = checkpoint_interval;
+    p_stats->index_full = index_full;
+    if (stats.elapsed_ms != 0) {
+        p_stats->fps_x100 = (uint32_t)(((uint64_t)stats.frames * 100000) / stats.elapsed_ms);
+    }
+    if (stats.payload_bytes != 0) {
+        p_stats->write_amplification_x100 = (uint32_t)((stats.written_bytes * 100) / stats.payload_bytes);
+    }
+}
+
+bool AviRecorder::put_data(const void * p_data, uint32_t size) {
+    const uint8_t * p_src = (const uint8_t *)p_data;
+    uint32_t len;
+
+    while (size > 0) {
+        len = AVI_RECORDER_WRITE_BUFFER_SIZE - wbuf_len;
+        if (len > size) {
+            len = size;
+        }
+        memcpy(&wbuf[wbuf_len], p_src, len);
+        wbuf_len += len;
+        file_end += len;
+        p_src += len;
+        size -= len;
+        if (wbuf_len >= AVI_RECORDER_WRITE_BUFFER_SIZE) {
+            if (!flush_wbuf(false)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Write wbuf to the file.
+ * partial = true : The last incomplete sector is written too, and is kept in wbuf
+ *                  to be written again with the following data. */
+bool AviRecorder::flush_wbuf(bool partial) {
+    uint32_t len;
+    uint32_t aligned;
+
+    if (partial) {
+        len = wbuf_len;
+    } else {
+        len = SECTOR_ALIGN_DOWN(wbuf_len);
+    }
+    if (len == 0) {
+        return true;
+    }
+    if ((fseek(fp, wbuf_pos, SEEK_SET) != 0) || (fwrite(wbuf, 1, len, fp) != len)) {
+        error = true;
+        return false;
+    }
+    count_written(wbuf_pos, len);
+
+    aligned = SECTOR_ALIGN_DOWN(wbuf_len);
+    if (aligned < wbuf_len) {
+        memmove(&wbuf[0], &wbuf[aligned], wbuf_len - aligned);
+    }
+    wbuf_pos += aligned;
+    wbuf_len -= aligned;
+
+    return true;
+}
+
+/* Overwrite the data which has already been stored */
+bool AviRecorder::write_at(uint32_t pos, const void * p_data, uint32_t size) {
+    const uint8_t * p_src = (const uint8_t *)p_data;
+    uint32_t len;
+
+    if (pos < wbuf_pos) {
+        len = wbuf_pos - pos;
+        if (len > size) {
+            len = size;
+        }
+        if ((fseek(fp, pos, SEEK_SET) != 0) || (fwrite(p_src, 1, len, fp) != len)) {
+            error = true;
+            return false;
+        }
+        count_written(pos, len);
+        pos += len;
+        p_src += len;
+        size -= len;
+    }
+    if (size > 0) {
+        if ((pos + size) <= (wbuf_pos + wbuf_len)) {
+            memcpy(&wbuf[pos - wbuf_pos], p_src, size);
+        } else {
+            // Beyond the end of the data (JUNK header of Close())
+            if ((fseek(fp, pos, SEEK_SET) != 0) || (fwrite(p_src, 1, size, fp) != size)) {
+                error = true;
+                return false;
+            }
+            count_written(pos, size);
+        }
+    }
+
+    return true;
+}
+
+bool AviRecorder::patch32(uint32_t pos, uint32_t value) {
+    uint8_t buf[4];
+
+    set_le32(buf, value);
+    return write_at(pos, buf, sizeof(buf));
+}
+
+bool AviRecorder::write_header_range(uint32_t start, uint32_t end) {
+    start = SECTOR_ALIGN_DOWN(start);
+    end = SECTOR_ALIGN_UP(end);
+    if (end > HEADER_SIZE) {
+        end = HEADER_SIZE;
+    }
+    return write_at(start, &header[start], end - start);
+}
+
+void AviRecorder::count_written(uint32_t pos, uint32_t size) {
+    // The file system writes whole sectors
+    stats.written_bytes += SECTOR_ALIGN_UP(pos + size) - SECTOR_ALIGN_DOWN(pos);
+}
+
+bool AviRecorder::add_entry(uint32_t offset, uint32_t size) {
+    index_entry_t * p_new;
+
+    if (entry_num >= entry_max) {
+        p_new = (index_entry_t *)realloc(entries, sizeof(index_entry_t) * entry_max * 2);
+        if (p_new == NULL) {
+            error = true;
+            return false;
+        }
+        entries = p_new;
+        entry_max *= 2;
+    }
+    entries[entry_num].offset = offset;
+    entries[entry_num].size = size;
+    entry_num++;
+
+    return true;
+}
+
+bool AviRecorder::checkpoint(bool last) {
+    // The last entry of the super index is kept for Close()
+    uint32_t need = (last) ? 1 : 2;
+
+    if (entry_num > checkpoint_start) {
+        if ((super_index_num + need) > AVI_RECORDER_SUPER_INDEX_NUM) {
+            // The frames would not be recoverable, so no more frames are accepted
+            index_full = true;
+            return false;
+        }
+        if (!write_std_index()) {
+            return false;
+        }
+        // Spread the remaining entries over a longer time
+        if ((!last) && (super_index_num >= grow_index_num)) {
+            checkpoint_interval *= 2;
+            grow_index_num = super_index_num + ((AVI_RECORDER_SUPER_INDEX_NUM - super_index_num) / 2);
+        }
+    }
+    // The sizes in the write buffer are updated before it is written
+    if ((!update_headers()) || (!flush_wbuf(true))) {
+        return false;
+    }
+    fflush(fp);
+    fsync(fileno(fp));
+    frames_since_checkpoint = 0;
+    stats.checkpoints++;
+
+    return true;
+}
+
+bool AviRecorder::write_std_index(void) {
+    uint8_t buf[STD_INDEX_HEADER_SIZE];
+    uint8_t * p_entry;
+    uint32_t num = entry_num - checkpoint_start;
+    uint32_t ix_pos = file_end;
+    uint32_t ix_size = STD_INDEX_HEADER_SIZE + (num * STD_INDEX_ENTRY_SIZE);
+    uint32_t i;
+
+    memset(buf, 0, sizeof(buf));
+    set_fourcc(&buf[0], "ix00");
+    set_le32(&buf[4], ix_size - 8);
+    set_le16(&buf[8], 2);                       // wLongsPerEntry
+    buf[11] = AVI_INDEX_OF_CHUNKS;
+    set_le32(&buf[12], num);                    // nEntriesInUse
+    set_fourcc(&buf[16], "00dc");
+    set_le32(&buf[20], movi_pos);               // qwBaseOffset
+    if (!put_data(buf, sizeof(buf))) {
+        return false;
+    }
+    for (i = checkpoint_start; i < entry_num; i++) {
+        set_le32(&buf[0], entries[i].offset + 8);   // offset of the data
+        set_le32(&buf[4], entries[i].size);
+        if (!put_data(buf, STD_INDEX_ENTRY_SIZE)) {
+            return false;
+        }
+    }
+
+    p_entry = &header[OFS_INDX_ENTRY + (SUPER_INDEX_ENTRY_SIZE * super_index_num)];
+    set_le32(&p_entry[0], ix_pos);              // qwOffset
+    set_le32(&p_entry[4], 0);
+    set_le32(&p_entry[8], ix_size);             // dwSize
+    set_le32(&p_entry[12], num);                // dwDuration
+    super_index_num++;
+    set_le32(&header[OFS_INDX_IN_USE], super_index_num);
+
+    indexed_frames += num;
+    if (segment == 0) {
+        checkpoint_start = entry_num;           // kept for idx1
+    } else {
+        entry_num = 0;
+        checkpoint_start = 0;
+    }
+
+    return true;
+}
+
+bool AviRecorder::write_idx1(void) {
+    uint8_t buf[IDX1_ENTRY_SIZE];
+    uint32_t i;
+
+    // The movi list ends here
+    set_le32(&header[OFS_MOVI_LIST + 4], file_end - movi_pos);
+
+    set_fourcc(&buf[0], "idx1");
+    set_le32(&buf[4], entry_num * IDX1_ENTRY_SIZE);
+    if (!put_data(buf, 8)) {
+        return false;
+    }
+    for (i = 0; i < entry_num; i++) {
+        set_fourcc(&buf[0], "00dc");
+        set_le32(&buf[4], AVIIF_KEYFRAME);
+        set_le32(&buf[8], entries[i].offset);
+        set_le32(&buf[12], entries[i].size);
+        if (!put_data(buf, IDX1_ENTRY_SIZE)) {
+            return false;
+        }
+    }
+
+    set_le32(&header[OFS_RIFF_SIZE], file_end - 8);
+    set_le32(&header[OFS_AVIH_FLAGS], AVIF_HASINDEX);
+    set_le32(&header[OFS_AVIH_FRAMES], entry_num);
+    first_riff_closed = true;
+
+    if ((!write_header_range(0, SECTOR_SIZE)) ||
+        (!write_header_range(OFS_MOVI_LIST, HEADER_SIZE))) {
+        return false;
+    }
+
+    return true;
+}
+
+bool AviRecorder::update_headers(void) {
+    uint32_t super_entry_pos;
+
+    if (!first_riff_closed) {
+        set_le32(&header[OFS_RIFF_SIZE], file_end - 8);
+        set_le32(&header[OFS_MOVI_LIST + 4], file_end - movi_pos);
+        set_le32(&header[OFS_AVIH_FRAMES], indexed_frames);
+    }
+    set_le32(&header[OFS_AVIH_BUFSIZE], max_frame_size + 8);
+    set_le32(&header[OFS_AVIH_MAXBPS], max_frame_size * fps);
+    set_le32(&header[OFS_STRH_LENGTH], indexed_frames);
+    set_le32(&header[OFS_STRH_BUFSIZE], max_frame_size + 8);
+    set_le32(&header[OFS_DMLH_FRAMES], indexed_frames);
+
+    // Only the sectors which have been changed are written
+    if (!write_header_range(0, SECTOR_SIZE)) {
+        return false;
+    }
+    if (super_index_num > 0) {
+        super_entry_pos = OFS_INDX_ENTRY + (SUPER_INDEX_ENTRY_SIZE * (super_index_num - 1));
+        if (!write_header_range(super_entry_pos, super_entry_pos + SUPER_INDEX_ENTRY_SIZE)) {
+            return false;
+        }
+    }
+    if (!write_header_range(OFS_DMLH_FRAMES, OFS_DMLH_FRAMES + 4)) {
+        return false;
+    }
+    if (!first_riff_closed) {
+        if (!write_header_range(OFS_MOVI_LIST, HEADER_SIZE)) {
+            return false;
+        }
+    } else {
+        // RIFF-AVIX
+        if ((!patch32(riff_pos + 4, file_end - riff_pos - 8)) ||
+            (!patch32(movi_pos - 4, file_end - movi_pos))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AviRecorder::next_segment(void) {
+    uint8_t buf[24];
+
+    // ix00 can not point to the chunks of the other RIFF. The new segment needs an entry for Close().
+    if ((super_index_num + 2) > AVI_RECORDER_SUPER_INDEX_NUM) {
+        index_full = true;
+        return false;
+    }
+    if (!checkpoint(true)) {
+        return false;
+    }
+    if (segment == 0) {
+        if (!write_idx1()) {
+            return false;
+        }
+    } else {
+        if (!update_headers()) {
+            return false;
+        }
+    }
+    entry_num = 0;
+    checkpoint_start = 0;
+    segment++;
+
+    riff_pos = file_end;
+    movi_pos = riff_pos + 20;
+    set_fourcc(&buf[0], "RIFF");
+    set_le32(&buf[4], 20);
+    set_fourcc(&buf[8], "AVIX");
+    set_fourcc(&buf[12], "LIST");
+    set_le32(&buf[16], 4);
+    set_fourcc(&buf[20], "movi");
+
+    return put_data(buf, sizeof(buf));
+}
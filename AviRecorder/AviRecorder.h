@@ -0,0 +1,192 @@
+/* mbed AviRecorder Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          AviRecorder.h
+* @brief         Motion-JPEG AVI recorder
+******************************************************************************/
+#ifndef __AVI_RECORDER_H__
+#define __AVI_RECORDER_H__
+
+#include "mbed.h"
+
+/** Size of the write buffer (multiple of 512 byte) */
+#ifndef AVI_RECORDER_WRITE_BUFFER_SIZE
+#define AVI_RECORDER_WRITE_BUFFER_SIZE  (1024 * 32)
+#endif
+
+/** Number of entries of the OpenDML super index (one entry per checkpoint and one per RIFF-AVIX segment)
+ *  Each time half of the remaining entries are used, the checkpoint interval is doubled.
+ *  The maximum length is about (AVI_RECORDER_SUPER_INDEX_NUM / 2) * log2(AVI_RECORDER_SUPER_INDEX_NUM)
+ *  checkpoint intervals (2.8 hours with the defaults, less when the file has many segments).
+ *  After that AddFrame() returns false, and Close() indexes the recorded frames. */
+#ifndef AVI_RECORDER_SUPER_INDEX_NUM
+#define AVI_RECORDER_SUPER_INDEX_NUM    (1024)
+#endif
+
+/** Default checkpoint interval (second) */
+#ifndef AVI_RECORDER_CHECKPOINT_SEC
+#define AVI_RECORDER_CHECKPOINT_SEC     (2)
+#endif
+
+/** A class to record JPEG frames to a Motion-JPEG AVI file
+ *
+ * The file is written in the OpenDML (AVI 2.0) format with a legacy idx1 index.
+ * Frames are stored through a write buffer and written in sector-aligned blocks.
+ * At every checkpoint a standard index (ix00) is appended to the movi list and the headers
+ * are updated, so the file can be played up to the last checkpoint after a power loss.
+ * Files larger than 1GB are continued in RIFF-AVIX segments.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "SdUsbConnect.h"
+ * #include "JPEG_Converter.h"
+ * #include "AviRecorder.h"
+ *
+ * JPEG_Converter Jcu;
+ * AviRecorder recorder;
+ *
+ * int main() {
+ *     SdUsbConnect storage("storage");
+ *
+ *     storage.wait_connect();
+ *     recorder.Open("/storage/movie.avi", 640, 480, 15, 1024 * 1024 * 64);
+ *     while (recording) {
+ *         size_t encode_size;
+ *         Jcu.encode(&bitmap, jpeg_buf, &encode_size, &options);
+ *         recorder.AddFrame(jpeg_buf, encode_size);
+ *     }
+ *     recorder.Close();
+ * }
+ * @endcode
+ */
+class AviRecorder {
+public:
+    /*! @struct stats_t
+        @brief Recording statistics
+     */
+    typedef struct {
+        uint32_t    frames;                 /*!< Number of recorded frames */
+        uint32_t    elapsed_ms;             /*!< Time from Open() to the last frame */
+        uint32_t    fps_x100;               /*!< Sustained frames per second x 100 */
+        uint64_t    payload_bytes;          /*!< Size of the JPEG data */
+        uint64_t    written_bytes;          /*!< Size written to the file system (partial sectors are rounded up) */
+        uint32_t    write_amplification_x100; /*!< written_bytes / payload_bytes x 100 */
+        uint32_t    max_frame_us;           /*!< Longest time of AddFrame() */
+        uint32_t    checkpoints;            /*!< Number of checkpoints */
+        uint32_t    checkpoint_frames;      /*!< Current checkpoint interval (frames) */
+        bool        index_full;             /*!< true = the super index is full, no more frames can be added */
+    } stats_t;
+
+    /** Constructor
+     */
+    AviRecorder();
+
+    /** Destructor
+     */
+    virtual ~AviRecorder();
+
+    /** Create a file and write the headers
+     *
+     * @param file_name file name
+     * @param width frame width
+     * @param height frame height
+     * @param fps frame rate
+     * @param prealloc_size size to allocate the file in advance (0: not allocated)
+     * @param checkpoint_frames checkpoint interval in frames (0: AVI_RECORDER_CHECKPOINT_SEC seconds)
+     * @return true = success, false = failure
+     */
+    bool Open(const char * file_name, uint16_t width, uint16_t height, uint32_t fps,
+              uint32_t prealloc_size = 0, uint32_t checkpoint_frames = 0);
+
+    /** Add a JPEG frame
+     *
+     * @param p_jpeg JPEG data
+     * @param size JPEG data size
+     * @return true = success, false = failure or the super index is full (see AVI_RECORDER_SUPER_INDEX_NUM)
+     */
+    bool AddFrame(const void * p_jpeg, size_t size);
+
+    /** Write the index and the data in the write buffer to the file
+     *
+     * Called automatically every checkpoint interval.
+     *
+     * @return true = success, false = failure or the super index is full
+     */
+    bool Checkpoint(void);
+
+    /** Finalize the index and close the file
+     *
+     * @return true = success, false = failure
+     */
+    bool Close(void);
+
+    /** Get the recording statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+private:
+    typedef struct {
+        uint32_t    offset;                 /* offset from 'movi' of the segment to the chunk */
+        uint32_t    size;                   /* JPEG data size */
+    } index_entry_t;
+
+    FILE          * fp;
+    uint8_t       * header;                 /* headers of the first RIFF */
+    uint8_t       * wbuf;
+    uint32_t        wbuf_pos;               /* file offset of wbuf[0] (sector aligned) */
+    uint32_t        wbuf_len;
+    uint32_t        file_end;               /* end of the written data */
+    uint32_t        prealloc_end;
+    index_entry_t * entries;
+    uint32_t        entry_num;
+    uint32_t        entry_max;
+    uint32_t        checkpoint_start;       /* first entry which is not in ix00 */
+    uint32_t        super_index_num;
+    uint32_t        grow_index_num;         /* the checkpoint interval is doubled when super_index_num reaches this */
+    bool            index_full;
+    uint32_t        segment;                /* 0: RIFF-AVI, 1 or more: RIFF-AVIX */
+    uint32_t        riff_pos;               /* file offset of 'RIFF' of the segment */
+    uint32_t        movi_pos;               /* file offset of 'movi' of the segment */
+    uint32_t        first_frames;           /* frames in the first RIFF */
+    uint32_t        indexed_frames;
+    uint32_t        max_frame_size;
+    uint32_t        checkpoint_interval;
+    uint32_t        frames_since_checkpoint;
+    uint32_t        fps;
+    bool            first_riff_closed;
+    bool            error;
+    Timer           rec_timer;
+    stats_t         stats;
+
+    bool put_data(const void * p_data, uint32_t size);
+    bool flush_wbuf(bool partial);
+    bool write_at(uint32_t pos, const void * p_data, uint32_t size);
+    bool patch32(uint32_t pos, uint32_t value);
+    bool write_header_range(uint32_t start, uint32_t end);
+    bool checkpoint(bool last);
+    bool write_std_index(void);
+    bool write_idx1(void);
+    bool update_headers(void);
+    bool next_segment(void);
+    bool add_entry(uint32_t offset, uint32_t size);
+    void count_written(uint32_t pos, uint32_t size);
+};
+
+#endif
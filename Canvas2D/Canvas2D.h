@@ -0,0 +1,34 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Canvas2D.h
+* @brief         Canvas2D_ContextClass for all GR-Boards
+*
+* On GR-PEACH (TARGET_RZA1H) this includes RGA_Cpp.h, and the RGA library draws.
+* On the other targets (GR-LYCHEE, RZ/A2M, a host PC) the same classes are implemented
+* by software in Canvas2D_Soft.h, so the UI code written for the RGA can be built without libRGA.a.
+******************************************************************************/
+
+#ifndef CANVAS_2D_H
+#define CANVAS_2D_H
+
+#if defined(TARGET_RZA1H)
+#include "RGA_Cpp.h"
+#else
+#include "Canvas2D_Soft.h"
+#endif
+
+#endif
@@ -0,0 +1,720 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "Canvas2D_DisplayList.h"
+
+#define STATE_MATRIX        (0x01)
+#define STATE_FILL          (0x02)
+#define STATE_ALPHA         (0x04)
+#define STATE_COMPOSITE     (0x08)
+#define STATE_DRAW          (STATE_MATRIX | STATE_FILL | STATE_ALPHA | STATE_COMPOSITE)
+
+/* Draw the call on the immediate context while recording */
+#define IMMEDIATE(call) \
+    if (_p_immediate != NULL) { \
+        uint32_t start = start_immediate(); \
+        _p_immediate->call; \
+        stop_immediate(start); \
+    }
+
+static bool is_integer_translation(const float * p_m) {
+    return (p_m[0] == 1.0f) && (p_m[1] == 0.0f) && (p_m[2] == 0.0f) && (p_m[3] == 1.0f)
+           && (p_m[4] == floorf(p_m[4])) && (p_m[5] == floorf(p_m[5]));
+}
+
+static bool is_identity(const float * p_m) {
+    return is_integer_translation(p_m) && (p_m[4] == 0.0f) && (p_m[5] == 0.0f);
+}
+
+static void set_identity(float * p_m) {
+    p_m[0] = 1.0f;
+    p_m[1] = 0.0f;
+    p_m[2] = 0.0f;
+    p_m[3] = 1.0f;
+    p_m[4] = 0.0f;
+    p_m[5] = 0.0f;
+}
+
+/* m = m * t (t is applied first) */
+static void concat(float * p_m, const float * p_t) {
+    float m[6];
+
+    m[0] = (p_m[0] * p_t[0]) + (p_m[2] * p_t[1]);
+    m[1] = (p_m[1] * p_t[0]) + (p_m[3] * p_t[1]);
+    m[2] = (p_m[0] * p_t[2]) + (p_m[2] * p_t[3]);
+    m[3] = (p_m[1] * p_t[2]) + (p_m[3] * p_t[3]);
+    m[4] = (p_m[0] * p_t[4]) + (p_m[2] * p_t[5]) + p_m[4];
+    m[5] = (p_m[1] * p_t[4]) + (p_m[3] * p_t[5]) + p_m[5];
+    memcpy(p_m, m, sizeof(m));
+}
+
+Canvas2D_DisplayList::Canvas2D_DisplayList(timer_func_t p_timer) : _p_timer(p_timer) {
+    Clear();
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void Canvas2D_DisplayList::BeginRecording(Canvas2D_ContextClass * p_immediate) {
+    Clear();
+    memset(&_stats, 0, sizeof(_stats));
+    _p_immediate = p_immediate;
+    _recording = true;
+}
+
+bool Canvas2D_DisplayList::EndRecording(void) {
+    _recording = false;
+    _p_immediate = NULL;
+    return !_error;
+}
+
+bool Canvas2D_DisplayList::Replay(Canvas2D_ContextClass & context) {
+    uint32_t start;
+    int i;
+
+    if (_recording || _error) {
+        return false;
+    }
+    start = (_p_timer != NULL) ? _p_timer() : 0;
+    context.save();
+    for (i = 0; i < _command_num; i++) {
+        const command_t * p_cmd = &_command[i];
+        const int32_t * p_i = p_cmd->a.i;
+        const float * p_f = p_cmd->a.f;
+
+        switch (p_cmd->op) {
+            case OP_CLEAR_RECT:
+                context.clearRect(p_i[0], p_i[1], p_i[2], p_i[3]);
+                break;
+            case OP_FILL_RECT:
+                context.fillRect(p_i[0], p_i[1], p_i[2], p_i[3]);
+                break;
+            case OP_DRAW_IMAGE_3:
+                context.drawImage((const graphics_image_t *)p_cmd->p, p_i[0], p_i[1]);
+                break;
+            case OP_DRAW_IMAGE_5:
+                context.drawImage((const graphics_image_t *)p_cmd->p, p_i[0], p_i[1], p_i[2], p_i[3]);
+                break;
+            case OP_DRAW_IMAGE_9:
+                context.drawImage((const graphics_image_t *)p_cmd->p, p_i[0], p_i[1], p_i[2], p_i[3],
+                                  p_i[4], p_i[5], p_i[6], p_i[7]);
+                break;
+            case OP_SAVE:
+                context.save();
+                break;
+            case OP_RESTORE:
+                context.restore();
+                break;
+            case OP_BEGIN_PATH:
+                context.beginPath();
+                break;
+            case OP_RECT:
+                context.rect(p_i[0], p_i[1], p_i[2], p_i[3]);
+                break;
+            case OP_CLIP:
+                context.clip();
+                break;
+            case OP_SET_TRANSFORM:
+                context.setTransform(p_f[0], p_f[1], p_f[2], p_f[3], p_f[4], p_f[5]);
+                break;
+            case OP_TRANSFORM:
+                context.transform(p_f[0], p_f[1], p_f[2], p_f[3], p_f[4], p_f[5]);
+                break;
+            case OP_FILL_TEXT:
+                context.fillStyle = (const char *)p_cmd->p;
+                break;
+            case OP_FILL_RGBA: {
+                r8g8b8a8_t colour;
+
+                colour.Value = p_cmd->a.u;
+                context.fillStyle = colour;
+                break;
+            }
+            case OP_FILL_PATTERN: {
+                ObjectHandleClass handle;
+                Canvas2D_PatternClass pattern;
+
+                handle.Entity = (void *)p_cmd->p;
+                pattern = handle;
+                context.fillStyle = pattern;
+                break;
+            }
+            case OP_GLOBAL_ALPHA:
+                context.globalAlpha = p_f[0];
+                break;
+            case OP_COMPOSITE:
+                context.globalCompositeOperation = (const char *)p_cmd->p;
+                break;
+            default:
+                break;
+        }
+    }
+    context.restore();
+    if (_p_timer != NULL) {
+        _stats.replay_us = _p_timer() - start;
+    }
+    _stats.replays++;
+    return true;
+}
+
+void Canvas2D_DisplayList::Clear(void) {
+    _p_immediate = NULL;
+    _recording = false;
+    _error = false;
+    _command_num = 0;
+    _text_size = 0;
+    _save_num = 0;
+    _merge_base = -1;
+    /* Nothing is set by the list yet: the drawing calls use the state of the context at Replay() */
+    memset(&_logical, 0, sizeof(_logical));
+    set_identity(_logical.matrix);
+    _context = _logical;
+}
+
+int Canvas2D_DisplayList::GetCommandNum(void) {
+    return _command_num;
+}
+
+void Canvas2D_DisplayList::GetStats(stats_t * p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    *p_stats = _stats;
+    p_stats->commands = (uint32_t)_command_num;
+    p_stats->replay_calls = (uint32_t)_command_num + 2;
+    p_stats->calls_saved = (int32_t)p_stats->calls - (int32_t)p_stats->replay_calls;
+    if ((_p_timer != NULL) && (_stats.replays != 0)) {
+        p_stats->time_saved_us = (int32_t)_stats.immediate_us - (int32_t)_stats.replay_us;
+    } else {
+        p_stats->time_saved_us = 0;
+    }
+}
+
+void Canvas2D_DisplayList::ResetStats(void) {
+    _stats.replays = 0;
+    _stats.replay_us = 0;
+}
+
+void Canvas2D_DisplayList::clearRect(int x, int y, int w, int h) {
+    command_t * p_cmd;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(clearRect(x, y, w, h));
+    _stats.calls++;
+    if ((w == 0) || (h == 0)) {
+        return;
+    }
+    if (w < 0) {
+        x += w;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h;
+        h = -h;
+    }
+    flush_state(STATE_MATRIX);
+    if (merge_rect(OP_CLEAR_RECT, x, y, w, h)) {
+        return;
+    }
+    p_cmd = add_command(OP_CLEAR_RECT);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->a.i[0] = x;
+    p_cmd->a.i[1] = y;
+    p_cmd->a.i[2] = w;
+    p_cmd->a.i[3] = h;
+    if (can_merge()) {
+        _merge_base = _command_num - 1;
+    }
+}
+
+void Canvas2D_DisplayList::fillRect(int x, int y, int w, int h) {
+    command_t * p_cmd;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(fillRect(x, y, w, h));
+    _stats.calls++;
+    if ((w == 0) || (h == 0)) {
+        return;
+    }
+    if (w < 0) {
+        x += w;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h;
+        h = -h;
+    }
+    flush_state(STATE_DRAW);
+    if (merge_rect(OP_FILL_RECT, x, y, w, h)) {
+        return;
+    }
+    p_cmd = add_command(OP_FILL_RECT);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->a.i[0] = x;
+    p_cmd->a.i[1] = y;
+    p_cmd->a.i[2] = w;
+    p_cmd->a.i[3] = h;
+    if (can_merge()) {
+        _merge_base = _command_num - 1;
+    }
+}
+
+void Canvas2D_DisplayList::drawImage(const graphics_image_t * image, int minX, int minY) {
+    command_t * p_cmd;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(drawImage(image, minX, minY));
+    _stats.calls++;
+    if (image == NULL) {
+        return;
+    }
+    flush_state(STATE_MATRIX | STATE_ALPHA | STATE_COMPOSITE);
+    p_cmd = add_command(OP_DRAW_IMAGE_3);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->p = image;
+    p_cmd->a.i[0] = minX;
+    p_cmd->a.i[1] = minY;
+}
+
+void Canvas2D_DisplayList::drawImage(const graphics_image_t * image, int minX, int minY, int width, int height) {
+    command_t * p_cmd;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(drawImage(image, minX, minY, width, height));
+    _stats.calls++;
+    if ((image == NULL) || (width == 0) || (height == 0)) {
+        return;
+    }
+    flush_state(STATE_MATRIX | STATE_ALPHA | STATE_COMPOSITE);
+    p_cmd = add_command(OP_DRAW_IMAGE_5);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->p = image;
+    p_cmd->a.i[0] = minX;
+    p_cmd->a.i[1] = minY;
+    p_cmd->a.i[2] = width;
+    p_cmd->a.i[3] = height;
+}
+
+void Canvas2D_DisplayList::drawImage(const graphics_image_t * image, int srcMinX, int srcMinY, int srcWidth, int srcHeight,
+                                     int destMinX, int destMinY, int destWidth, int destHeight) {
+    command_t * p_cmd;
+    int32_t rect[8] = {srcMinX, srcMinY, srcWidth, srcHeight, destMinX, destMinY, destWidth, destHeight};
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(drawImage(image, srcMinX, srcMinY, srcWidth, srcHeight, destMinX, destMinY, destWidth, destHeight));
+    _stats.calls++;
+    if ((image == NULL) || (srcWidth == 0) || (srcHeight == 0) || (destWidth == 0) || (destHeight == 0)) {
+        return;
+    }
+    flush_state(STATE_MATRIX | STATE_ALPHA | STATE_COMPOSITE);
+    if (merge_image(image, rect)) {
+        return;
+    }
+    p_cmd = add_command(OP_DRAW_IMAGE_9);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->p = image;
+    memcpy(p_cmd->a.i, rect, sizeof(rect));
+    if (can_merge() && (srcWidth == destWidth) && (srcHeight == destHeight)
+        && (srcWidth > 0) && (srcHeight > 0)) {
+        _merge_base = _command_num - 1;
+    }
+}
+
+void Canvas2D_DisplayList::save(void) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(save());
+    _stats.calls++;
+    if (_save_num >= CANVAS_2D_DISPLAY_LIST_SAVE_MAX) {
+        _error = true;
+        return;
+    }
+    _save[_save_num].logical = _logical;
+    _save[_save_num].context = _context;
+    _save_num++;
+    (void)add_command(OP_SAVE);
+}
+
+void Canvas2D_DisplayList::restore(void) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(restore());
+    _stats.calls++;
+    if (_save_num == 0) {
+        return;
+    }
+    _save_num--;
+    _logical = _save[_save_num].logical;
+    _context = _save[_save_num].context;
+    (void)add_command(OP_RESTORE);
+}
+
+void Canvas2D_DisplayList::beginPath(void) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(beginPath());
+    _stats.calls++;
+    (void)add_command(OP_BEGIN_PATH);
+}
+
+void Canvas2D_DisplayList::rect(int minX, int minY, int width, int height) {
+    command_t * p_cmd;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(rect(minX, minY, width, height));
+    _stats.calls++;
+    flush_state(STATE_MATRIX);
+    p_cmd = add_command(OP_RECT);
+    if (p_cmd == NULL) {
+        return;
+    }
+    p_cmd->a.i[0] = minX;
+    p_cmd->a.i[1] = minY;
+    p_cmd->a.i[2] = width;
+    p_cmd->a.i[3] = height;
+}
+
+void Canvas2D_DisplayList::clip(void) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(clip());
+    _stats.calls++;
+    (void)add_command(OP_CLIP);
+}
+
+void Canvas2D_DisplayList::setTransform(float sx, float ky, float kx, float sy, float tx, float ty) {
+    float * p_m = _logical.matrix;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(setTransform(sx, ky, kx, sy, tx, ty));
+    _stats.calls++;
+    _logical.valid |= STATE_MATRIX;
+    p_m[0] = sx;
+    p_m[1] = ky;
+    p_m[2] = kx;
+    p_m[3] = sy;
+    p_m[4] = tx;
+    p_m[5] = ty;
+}
+
+void Canvas2D_DisplayList::translate(float tx, float ty) {
+    const float t[6] = {1.0f, 0.0f, 0.0f, 1.0f, tx, ty};
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(translate(tx, ty));
+    _stats.calls++;
+    concat(_logical.matrix, t);
+}
+
+void Canvas2D_DisplayList::scale(float sx, float sy) {
+    const float t[6] = {sx, 0.0f, 0.0f, sy, 0.0f, 0.0f};
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(scale(sx, sy));
+    _stats.calls++;
+    concat(_logical.matrix, t);
+}
+
+void Canvas2D_DisplayList::rotate(float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+    const float t[6] = {c, s, -s, c, 0.0f, 0.0f};
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(rotate(angle));
+    _stats.calls++;
+    concat(_logical.matrix, t);
+}
+
+void Canvas2D_DisplayList::transform(float sx, float ky, float kx, float sy, float tx, float ty) {
+    const float t[6] = {sx, ky, kx, sy, tx, ty};
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(transform(sx, ky, kx, sy, tx, ty));
+    _stats.calls++;
+    concat(_logical.matrix, t);
+}
+
+void Canvas2D_DisplayList::set_fillStyle(const char * Color) {
+    const char * p_text;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(fillStyle = Color);
+    _stats.calls++;
+    p_text = add_text(Color);
+    if (p_text == NULL) {
+        return;
+    }
+    _logical.fill_op = OP_FILL_TEXT;
+    _logical.p_fill = p_text;
+    _logical.valid |= STATE_FILL;
+}
+
+void Canvas2D_DisplayList::set_fillStyle(r8g8b8a8_t Color) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(fillStyle = Color);
+    _stats.calls++;
+    _logical.fill_op = OP_FILL_RGBA;
+    _logical.p_fill = NULL;
+    _logical.fill_rgba = Color.Value;
+    _logical.valid |= STATE_FILL;
+}
+
+void Canvas2D_DisplayList::set_fillStyle(Canvas2D_PatternClass Pattern) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(fillStyle = Pattern);
+    _stats.calls++;
+    if (Pattern.Entity == NULL) {
+        return;
+    }
+    _logical.fill_op = OP_FILL_PATTERN;
+    _logical.p_fill = Pattern.Entity;
+    _logical.valid |= STATE_FILL;
+}
+
+void Canvas2D_DisplayList::set_globalAlpha(float alpha) {
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(globalAlpha = alpha);
+    _stats.calls++;
+    if (!(alpha >= 0.0f) || !(alpha <= 1.0f)) {
+        return;
+    }
+    _logical.alpha = alpha;
+    _logical.valid |= STATE_ALPHA;
+}
+
+void Canvas2D_DisplayList::set_globalCompositeOperation(const char * operation) {
+    const char * p_text;
+
+    if (!_recording) {
+        return;
+    }
+    IMMEDIATE(globalCompositeOperation = operation);
+    _stats.calls++;
+    p_text = add_text(operation);
+    if (p_text == NULL) {
+        return;
+    }
+    _logical.p_composite = p_text;
+    _logical.valid |= STATE_COMPOSITE;
+}
+
+uint32_t Canvas2D_DisplayList::start_immediate(void) {
+    return (_p_timer != NULL) ? _p_timer() : 0;
+}
+
+void Canvas2D_DisplayList::stop_immediate(uint32_t start) {
+    if (_p_timer != NULL) {
+        _stats.immediate_us += _p_timer() - start;
+    }
+}
+
+Canvas2D_DisplayList::command_t * Canvas2D_DisplayList::add_command(op_t op) {
+    command_t * p_cmd;
+
+    _merge_base = -1;
+    if (_command_num >= CANVAS_2D_DISPLAY_LIST_MAX) {
+        _error = true;
+        return NULL;
+    }
+    p_cmd = &_command[_command_num++];
+    memset(p_cmd, 0, sizeof(command_t));
+    p_cmd->op = (uint8_t)op;
+    return p_cmd;
+}
+
+/* Copy a string into the buffer. The same strings share the copy, so the pointers can be compared */
+const char * Canvas2D_DisplayList::add_text(const char * p_str) {
+    int pos = 0;
+    int len;
+
+    if (p_str == NULL) {
+        return NULL;
+    }
+    while (pos < _text_size) {
+        if (strcmp(&_text[pos], p_str) == 0) {
+            return &_text[pos];
+        }
+        pos += (int)strlen(&_text[pos]) + 1;
+    }
+    len = (int)strlen(p_str) + 1;
+    if ((_text_size + len) > CANVAS_2D_DISPLAY_LIST_TEXT_MAX) {
+        _error = true;
+        return NULL;
+    }
+    memcpy(&_text[_text_size], p_str, len);
+    _text_size += len;
+    return &_text[pos];
+}
+
+/* Set the state used by the next command to the context when it is changed.
+ * Only the state set by the recorded calls is set: the rest is left as the context has it at Replay().
+ * Until setTransform() is recorded, _logical.matrix is the transform not yet applied to the context,
+ * and it is recorded as one transform() relative to the transform of the context.
+ */
+void Canvas2D_DisplayList::flush_state(uint8_t state) {
+    command_t * p_cmd;
+
+    state &= _logical.valid | STATE_MATRIX;
+    if (((state & STATE_MATRIX) != 0) && ((_logical.valid & STATE_MATRIX) == 0)) {
+        if (!is_identity(_logical.matrix)) {
+            p_cmd = add_command(OP_TRANSFORM);
+            if (p_cmd != NULL) {
+                memcpy(p_cmd->a.f, _logical.matrix, sizeof(_logical.matrix));
+            }
+            set_identity(_logical.matrix);
+        }
+    } else if (((state & STATE_MATRIX) != 0)
+        && (((_context.valid & STATE_MATRIX) == 0) || (memcmp(_context.matrix, _logical.matrix, sizeof(_logical.matrix)) != 0))) {
+        p_cmd = add_command(OP_SET_TRANSFORM);
+        if (p_cmd != NULL) {
+            memcpy(p_cmd->a.f, _logical.matrix, sizeof(_logical.matrix));
+        }
+        memcpy(_context.matrix, _logical.matrix, sizeof(_logical.matrix));
+        _context.valid |= STATE_MATRIX;
+    }
+    if (((state & STATE_FILL) != 0)
+        && (((_context.valid & STATE_FILL) == 0) || (_context.fill_op != _logical.fill_op)
+            || (_context.p_fill != _logical.p_fill) || (_context.fill_rgba != _logical.fill_rgba))) {
+        p_cmd = add_command((op_t)_logical.fill_op);
+        if (p_cmd != NULL) {
+            p_cmd->p = _logical.p_fill;
+            p_cmd->a.u = _logical.fill_rgba;
+        }
+        _context.fill_op = _logical.fill_op;
+        _context.p_fill = _logical.p_fill;
+        _context.fill_rgba = _logical.fill_rgba;
+        _context.valid |= STATE_FILL;
+    }
+    if (((state & STATE_ALPHA) != 0)
+        && (((_context.valid & STATE_ALPHA) == 0) || (_context.alpha != _logical.alpha))) {
+        p_cmd = add_command(OP_GLOBAL_ALPHA);
+        if (p_cmd != NULL) {
+            p_cmd->a.f[0] = _logical.alpha;
+        }
+        _context.alpha = _logical.alpha;
+        _context.valid |= STATE_ALPHA;
+    }
+    if (((state & STATE_COMPOSITE) != 0)
+        && (((_context.valid & STATE_COMPOSITE) == 0) || (_context.p_composite != _logical.p_composite))) {
+        p_cmd = add_command(OP_COMPOSITE);
+        if (p_cmd != NULL) {
+            p_cmd->p = _logical.p_composite;
+        }
+        _context.p_composite = _logical.p_composite;
+        _context.valid |= STATE_COMPOSITE;
+    }
+}
+
+/* The calls are merged only when the transform of the context is known to be an integer translation */
+bool Canvas2D_DisplayList::can_merge(void) {
+    return ((_context.valid & STATE_MATRIX) != 0) && is_integer_translation(_context.matrix);
+}
+
+/* Extend the previous rectangle when the rectangles share an edge */
+bool Canvas2D_DisplayList::merge_rect(op_t op, int x, int y, int w, int h) {
+    int32_t * p_r;
+
+    if ((_merge_base < 0) || (_command[_merge_base].op != op)) {
+        return false;
+    }
+    p_r = _command[_merge_base].a.i;
+    if ((p_r[1] == y) && (p_r[3] == h) && (((p_r[0] + p_r[2]) == x) || ((x + w) == p_r[0]))) {
+        p_r[0] = (x < p_r[0]) ? x : p_r[0];
+        p_r[2] += w;
+    } else if ((p_r[0] == x) && (p_r[2] == w) && (((p_r[1] + p_r[3]) == y) || ((y + h) == p_r[1]))) {
+        p_r[1] = (y < p_r[1]) ? y : p_r[1];
+        p_r[3] += h;
+    } else {
+        return false;
+    }
+    _stats.merged++;
+    return true;
+}
+
+/* Extend the previous blit when the source and the destination rectangles share an edge at the same offset */
+bool Canvas2D_DisplayList::merge_image(const graphics_image_t * image, const int32_t * p_rect) {
+    int32_t * p_r;
+
+    if ((_merge_base < 0) || (_command[_merge_base].op != OP_DRAW_IMAGE_9) || (_command[_merge_base].p != image)
+        || (p_rect[2] != p_rect[6]) || (p_rect[3] != p_rect[7]) || (p_rect[2] <= 0) || (p_rect[3] <= 0)) {
+        return false;
+    }
+    p_r = _command[_merge_base].a.i;
+    if ((p_r[1] == p_rect[1]) && (p_r[3] == p_rect[3]) && (p_r[5] == p_rect[5])
+        && ((((p_r[0] + p_r[2]) == p_rect[0]) && ((p_r[4] + p_r[6]) == p_rect[4]))
+            || (((p_rect[0] + p_rect[2]) == p_r[0]) && ((p_rect[4] + p_rect[6]) == p_r[4])))) {
+        p_r[0] = (p_rect[0] < p_r[0]) ? p_rect[0] : p_r[0];
+        p_r[4] = (p_rect[4] < p_r[4]) ? p_rect[4] : p_r[4];
+        p_r[2] += p_rect[2];
+        p_r[6] += p_rect[6];
+    } else if ((p_r[0] == p_rect[0]) && (p_r[2] == p_rect[2]) && (p_r[4] == p_rect[4])
+               && ((((p_r[1] + p_r[3]) == p_rect[1]) && ((p_r[5] + p_r[7]) == p_rect[5]))
+                   || (((p_rect[1] + p_rect[3]) == p_r[1]) && ((p_rect[5] + p_rect[7]) == p_r[5])))) {
+        p_r[1] = (p_rect[1] < p_r[1]) ? p_rect[1] : p_r[1];
+        p_r[5] = (p_rect[5] < p_r[5]) ? p_rect[5] : p_r[5];
+        p_r[3] += p_rect[3];
+        p_r[7] += p_rect[7];
+    } else {
+        return false;
+    }
+    _stats.merged++;
+    return true;
+}
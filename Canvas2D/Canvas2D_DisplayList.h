@@ -0,0 +1,252 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Canvas2D_DisplayList.h
+* @brief         Display list of Canvas2D_ContextClass calls
+*
+* The drawing calls of a static part of the UI are recorded once, and replayed onto a context every frame.
+* The list is optimized while it is recorded:
+* - The state (transform, fillStyle, globalAlpha, globalCompositeOperation) is tracked by the list,
+*   and is set to the context only before a drawing call which uses it and only when it is changed.
+*   The consecutive translate(), scale(), rotate() and transform() calls are recorded as one transform(),
+*   or as one setTransform() after a setTransform().
+* - fillRect() (clearRect()) calls with the same state are merged when the rectangles share an edge
+*   and form a rectangle. drawImage() calls of the same image at the same size are merged when both
+*   the source and the destination rectangles share an edge.
+*   The calls are merged only when the transform set by setTransform() is an integer translation,
+*   so the pixels are the same as the separate calls.
+* - The calls which draw nothing (zero size, NULL image) are removed.
+*
+* Only the state set by the recorded calls is set by Replay(). The state which is not set is the state of
+* the context when Replay() is called: the list is drawn with the fillStyle, globalAlpha,
+* globalCompositeOperation and clipping region of the caller, and until setTransform() is recorded,
+* the recorded transforms are applied on top of the transform of the caller (for example, a list recorded
+* without setTransform() is drawn at an offset after context.translate()).
+* Replay() draws the list between save() and restore() of the context, so the state of the context is not changed.
+* The images, the patterns and the strings of fillStyle / globalCompositeOperation are referred to by the list
+* (the strings are copied). The strings must be valid: an invalid string is ignored by the context but not by the list.
+* The list works with RGA_Cpp.h and Canvas2D_Soft.h.
+******************************************************************************/
+
+#ifndef CANVAS_2D_DISPLAY_LIST_H
+#define CANVAS_2D_DISPLAY_LIST_H
+
+#include "Canvas2D.h"
+
+/** Maximum number of commands of a list */
+#ifndef CANVAS_2D_DISPLAY_LIST_MAX
+#define CANVAS_2D_DISPLAY_LIST_MAX          (256)
+#endif
+
+/** Size of the buffer of the strings (byte) */
+#ifndef CANVAS_2D_DISPLAY_LIST_TEXT_MAX
+#define CANVAS_2D_DISPLAY_LIST_TEXT_MAX     (512)
+#endif
+
+/** Maximum nesting of save() */
+#ifndef CANVAS_2D_DISPLAY_LIST_SAVE_MAX
+#define CANVAS_2D_DISPLAY_LIST_SAVE_MAX     (8)
+#endif
+
+/** A class of the display list of Canvas2D_ContextClass
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "Canvas2D_DisplayList.h"
+ *
+ * static Canvas2D_DisplayList background(&us_ticker_read);
+ * extern const graphics_image_t tiles[];    // 256 x 32 image made by ImagePackager
+ *
+ * void draw_frame(Canvas2D_ContextClass & canvas, bool first) {
+ *     if (first) {
+ *         // The first frame is drawn while it is recorded
+ *         background.BeginRecording(&canvas);
+ *         background.setTransform(1, 0, 0, 1, 0, 0);   // a known integer translation to merge the tiles
+ *         background.set_fillStyle("#202020");
+ *         background.fillRect(0, 0, 480, 272);
+ *         for (int i = 0; i < 8; i++) {
+ *             background.drawImage(tiles, i * 32, 0, 32, 32, i * 32, 240, 32, 32);
+ *         }
+ *         background.EndRecording();
+ *     } else {
+ *         background.Replay(canvas);
+ *     }
+ *     // draw the dynamic parts here
+ * }
+ * @endcode
+ */
+class Canvas2D_DisplayList {
+public:
+    /** Timer (us) */
+    typedef uint32_t (*timer_func_t)(void);
+
+    /*! @struct stats_t
+        @brief Recording and replay statistics
+     */
+    typedef struct {
+        uint32_t    calls;              /*!< Number of the calls recorded */
+        uint32_t    commands;           /*!< Number of the commands of the list */
+        uint32_t    merged;             /*!< Number of the drawing calls merged into the previous command */
+        uint32_t    replay_calls;       /*!< Number of the context calls of a Replay() (commands + save() and restore()) */
+        int32_t     calls_saved;        /*!< calls - replay_calls */
+        uint32_t    replays;            /*!< Number of Replay() calls */
+        uint32_t    immediate_us;       /*!< Time of the calls on the immediate context while recording (us) */
+        uint32_t    replay_us;          /*!< Time of the last Replay() (us) */
+        int32_t     time_saved_us;      /*!< immediate_us - replay_us, 0 = not measured */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param p_timer timer (us) to measure the time, NULL = the time is not measured
+     */
+    Canvas2D_DisplayList(timer_func_t p_timer = NULL);
+
+    /** Clear the list and start recording
+     *
+     * @param p_immediate context which draws the calls while recording (NULL: the calls are only recorded).
+     *                    The time of these calls is the time of the immediate mode in the statistics.
+     */
+    void BeginRecording(Canvas2D_ContextClass * p_immediate = NULL);
+
+    /** Stop recording
+     *
+     * @return true = success, false = the list, the strings or save() overflowed (the list is not replayed)
+     */
+    bool EndRecording(void);
+
+    /** Draw the list onto a context
+     *
+     * @param context context
+     * @return true = success, false = the list is being recorded or is not valid
+     */
+    bool Replay(Canvas2D_ContextClass & context);
+
+    /** Clear the list
+     */
+    void Clear(void);
+
+    /** Get the number of commands
+     *
+     * @return number of commands
+     */
+    int GetCommandNum(void);
+
+    /** Get the statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+    /** Clear the statistics of Replay()
+     */
+    void ResetStats(void);
+
+    /* Calls of Canvas2D_ContextClass to record */
+    void clearRect(int x, int y, int w, int h);
+    void fillRect(int x, int y, int w, int h);
+    void drawImage(const graphics_image_t * image, int minX, int minY);
+    void drawImage(const graphics_image_t * image, int minX, int minY, int width, int height);
+    void drawImage(const graphics_image_t * image, int srcMinX, int srcMinY, int srcWidth, int srcHeight,
+                   int destMinX, int destMinY, int destWidth, int destHeight);
+    void save(void);
+    void restore(void);
+    void beginPath(void);
+    void rect(int minX, int minY, int width, int height);
+    void clip(void);
+    void setTransform(float sx, float ky, float kx, float sy, float tx, float ty);
+    void translate(float tx, float ty);
+    void scale(float sx, float sy);
+    void rotate(float angle);
+    void transform(float sx, float ky, float kx, float sy, float tx, float ty);
+    void set_fillStyle(const char * Color);
+    void set_fillStyle(r8g8b8a8_t Color);
+    void set_fillStyle(Canvas2D_PatternClass Pattern);
+    void set_globalAlpha(float alpha);
+    void set_globalCompositeOperation(const char * operation);
+
+private:
+    typedef enum {
+        OP_CLEAR_RECT = 0,
+        OP_FILL_RECT,
+        OP_DRAW_IMAGE_3,
+        OP_DRAW_IMAGE_5,
+        OP_DRAW_IMAGE_9,
+        OP_SAVE,
+        OP_RESTORE,
+        OP_BEGIN_PATH,
+        OP_RECT,
+        OP_CLIP,
+        OP_SET_TRANSFORM,
+        OP_TRANSFORM,
+        OP_FILL_TEXT,
+        OP_FILL_RGBA,
+        OP_FILL_PATTERN,
+        OP_GLOBAL_ALPHA,
+        OP_COMPOSITE,
+    } op_t;
+
+    typedef struct {
+        uint8_t         op;
+        const void *    p;              /* Image, pattern or string */
+        union {
+            int32_t     i[8];
+            float       f[6];
+            uint32_t    u;
+        } a;
+    } command_t;
+
+    typedef struct {
+        float           matrix[6];      /* Without STATE_MATRIX: transform not yet applied to the context */
+        uint8_t         fill_op;        /* OP_FILL_TEXT, OP_FILL_RGBA or OP_FILL_PATTERN */
+        const void *    p_fill;         /* String or pattern */
+        uint32_t        fill_rgba;
+        float           alpha;
+        const char *    p_composite;
+        uint8_t         valid;          /* STATE_xxx set by the recorded calls / set to the context */
+    } state_t;
+
+    typedef struct {
+        state_t         logical;
+        state_t         context;
+    } save_t;
+
+    timer_func_t _p_timer;
+    Canvas2D_ContextClass * _p_immediate;
+    bool _recording;
+    bool _error;
+    command_t _command[CANVAS_2D_DISPLAY_LIST_MAX];
+    int _command_num;
+    char _text[CANVAS_2D_DISPLAY_LIST_TEXT_MAX];
+    int _text_size;
+    state_t _logical;                   /* State of the recorded calls */
+    state_t _context;                   /* State of the context when the list is replayed */
+    save_t _save[CANVAS_2D_DISPLAY_LIST_SAVE_MAX];
+    int _save_num;
+    int _merge_base;                    /* Command which can be merged with the next drawing call, -1 = none */
+    stats_t _stats;
+
+    uint32_t start_immediate(void);
+    void stop_immediate(uint32_t start);
+    command_t * add_command(op_t op);
+    const char * add_text(const char * p_str);
+    void flush_state(uint8_t state);
+    bool can_merge(void);
+    bool merge_rect(op_t op, int x, int y, int w, int h);
+    bool merge_image(const graphics_image_t * image, const int32_t * p_rect);
+};
+
+#endif
@@ -0,0 +1,485 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(TARGET_RZA1H)
+
+#include <string.h>
+#include <math.h>
+#include "Canvas2D_Soft.h"
+#include "Canvas2D_Raster.h"
+
+#define SUB_NUM         (4)                 /* Sub-scanlines of a row */
+#define SUB_WEIGHT      (256 / SUB_NUM)     /* Coverage of a pixel fully covered by a sub-scanline */
+#define FIX_SHIFT       (16)
+#define FIX_ONE         (1 << FIX_SHIFT)
+#define FIX_LIMIT       (32767.0f)          /* Coordinates are clamped to fit in 16.16 */
+
+static inline uint32_t div255(uint32_t x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static inline int32_t to_fixed(float v) {
+    if (v > FIX_LIMIT) {
+        v = FIX_LIMIT;
+    } else if (v < -FIX_LIMIT) {
+        v = -FIX_LIMIT;
+    }
+    return (int32_t)floorf((v * (float)FIX_ONE) + 0.5f);
+}
+
+/* Texel readers (ARGB8888, not premultiplied) */
+typedef uint32_t (*texel_func_t)(const Canvas2D_Raster::texture_t * p_tex, int x, int y);
+
+static uint32_t texel_r8g8b8a8(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    const uint8_t * p = p_tex->p_buf + (y * p_tex->stride) + (x * 4);
+
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static uint32_t texel_argb8888(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    return ((const uint32_t *)(p_tex->p_buf + (y * p_tex->stride)))[x];
+}
+
+static uint32_t texel_xrgb8888(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    return ((const uint32_t *)(p_tex->p_buf + (y * p_tex->stride)))[x] | 0xFF000000;
+}
+
+static uint32_t texel_rgb565(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    uint32_t v = ((const uint16_t *)(p_tex->p_buf + (y * p_tex->stride)))[x];
+    uint32_t r = (v >> 11) & 0x1F;
+    uint32_t g = (v >> 5) & 0x3F;
+    uint32_t b = v & 0x1F;
+    uint32_t a = 0xFF;
+
+    if (p_tex->p_alpha != NULL) {
+        a = p_tex->p_alpha[(y * p_tex->alpha_stride) + x];
+    }
+    return (a << 24) | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+static uint32_t texel_argb4444(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    uint32_t v = ((const uint16_t *)(p_tex->p_buf + (y * p_tex->stride)))[x];
+
+    return (((v >> 12) & 0xF) * 0x11000000) | (((v >> 8) & 0xF) * 0x110000)
+           | (((v >> 4) & 0xF) * 0x1100) | ((v & 0xF) * 0x11);
+}
+
+static uint32_t texel_a8(const Canvas2D_Raster::texture_t * p_tex, int x, int y) {
+    return ((uint32_t)p_tex->p_buf[(y * p_tex->stride) + x] << 24) | 0x00FFFFFF;
+}
+
+static texel_func_t get_texel_func(int format) {
+    switch (format) {
+        case PIXEL_FORMAT_R8G8B8A8: return &texel_r8g8b8a8;
+        case PIXEL_FORMAT_ARGB8888: return &texel_argb8888;
+        case PIXEL_FORMAT_XRGB8888: return &texel_xrgb8888;
+        case PIXEL_FORMAT_RGB565:   return &texel_rgb565;
+        case PIXEL_FORMAT_ARGB4444: return &texel_argb4444;
+        case PIXEL_FORMAT_A8:       return &texel_a8;
+        default:                    return NULL;
+    }
+}
+
+static inline uint32_t unpremultiply(uint32_t c) {
+    uint32_t a = c >> 24;
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+
+    if ((a == 0) || (a == 255)) {
+        return c;
+    }
+    r = (((c >> 16) & 0xFF) * 255 + (a >> 1)) / a;
+    g = (((c >> 8) & 0xFF) * 255 + (a >> 1)) / a;
+    b = ((c & 0xFF) * 255 + (a >> 1)) / a;
+    r = (r > 255) ? 255 : r;
+    g = (g > 255) ? 255 : g;
+    b = (b > 255) ? 255 : b;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static inline uint32_t premultiply(uint32_t c) {
+    uint32_t a = c >> 24;
+
+    if (a == 255) {
+        return c;
+    }
+    return (a << 24) | (div255(((c >> 16) & 0xFF) * a) << 16) | (div255(((c >> 8) & 0xFF) * a) << 8)
+           | div255((c & 0xFF) * a);
+}
+
+/* Bilinear filtering of premultiplied texels, the weights are 0 - 256 */
+static inline uint32_t bilerp(uint32_t c00, uint32_t c10, uint32_t c01, uint32_t c11, uint32_t wx, uint32_t wy) {
+    uint32_t w00 = (256 - wx) * (256 - wy);
+    uint32_t w10 = wx * (256 - wy);
+    uint32_t w01 = (256 - wx) * wy;
+    uint32_t w11 = wx * wy;
+    uint32_t result = 0;
+    int k;
+
+    for (k = 0; k < 32; k += 8) {
+        uint32_t v = (((c00 >> k) & 0xFF) * w00) + (((c10 >> k) & 0xFF) * w10)
+                     + (((c01 >> k) & 0xFF) * w01) + (((c11 >> k) & 0xFF) * w11);
+        result |= ((v + 0x8000) >> 16) << k;
+    }
+    return result;
+}
+
+/* Coordinate in the area, false = transparent */
+static inline bool wrap(int * p_v, Canvas2D_Raster::wrap_t mode, int min, int size) {
+    int v = *p_v - min;
+
+    switch (mode) {
+        case Canvas2D_Raster::WRAP_REPEAT:
+            v %= size;
+            if (v < 0) {
+                v += size;
+            }
+            break;
+        case Canvas2D_Raster::WRAP_NONE:
+            if ((v < 0) || (v >= size)) {
+                return false;
+            }
+            break;
+        default:
+            if (v < 0) {
+                v = 0;
+            } else if (v >= size) {
+                v = size - 1;
+            }
+            break;
+    }
+    *p_v = v + min;
+    return true;
+}
+
+/* Premultiplied blend of the old and the new destination by the coverage */
+static inline uint32_t lerp_coverage(uint32_t old_c, uint32_t new_c, uint32_t cov) {
+    return unpremultiply(bilerp(premultiply(old_c), premultiply(new_c), 0, 0, cov + (cov >> 7), 0));
+}
+
+bool Canvas2D_Raster::SetTexture(const uint8_t * p_buf, int width, int height, int stride, int format, texture_t * p_texture) {
+    if ((p_buf == NULL) || (width <= 0) || (height <= 0) || (get_texel_func(format) == NULL)) {
+        return false;
+    }
+    p_texture->p_buf = p_buf;
+    p_texture->width = width;
+    p_texture->height = height;
+    p_texture->stride = stride;
+    p_texture->format = format;
+    p_texture->p_alpha = NULL;
+    p_texture->alpha_stride = 0;
+    p_texture->premultiplied = false;
+    return true;
+}
+
+void Canvas2D_Raster::Fetch(const paint_t * p_paint, int x, int y, int num, uint32_t * p_argb) {
+    const texture_t * p_tex = p_paint->p_texture;
+    texel_func_t texel;
+    float px = (float)x + 0.5f;
+    float py = (float)y + 0.5f;
+    int32_t u;
+    int32_t v;
+    int32_t du;
+    int32_t dv;
+    int min_u = p_paint->area.x;
+    int min_v = p_paint->area.y;
+    int size_u = p_paint->area.width;
+    int size_v = p_paint->area.height;
+    int i;
+
+    if (p_tex == NULL) {
+        for (i = 0; i < num; i++) {
+            p_argb[i] = p_paint->colour;
+        }
+        return;
+    }
+
+    texel = get_texel_func(p_tex->format);
+    u = to_fixed((p_paint->inv[0] * px) + (p_paint->inv[2] * py) + p_paint->inv[4]);
+    v = to_fixed((p_paint->inv[1] * px) + (p_paint->inv[3] * py) + p_paint->inv[5]);
+    du = to_fixed(p_paint->inv[0]);
+    dv = to_fixed(p_paint->inv[1]);
+
+    if (!p_paint->bilinear) {
+        for (i = 0; i < num; i++, u += du, v += dv) {
+            int tu = u >> FIX_SHIFT;
+            int tv = v >> FIX_SHIFT;
+
+            if (wrap(&tu, p_paint->wrap_u, min_u, size_u) && wrap(&tv, p_paint->wrap_v, min_v, size_v)) {
+                p_argb[i] = texel(p_tex, tu, tv);
+                if (p_tex->premultiplied) {
+                    p_argb[i] = unpremultiply(p_argb[i]);
+                }
+            } else {
+                p_argb[i] = 0;
+            }
+        }
+        return;
+    }
+
+    for (i = 0; i < num; i++, u += du, v += dv) {
+        int32_t su = u - (FIX_ONE / 2);
+        int32_t sv = v - (FIX_ONE / 2);
+        int u0 = su >> FIX_SHIFT;
+        int v0 = sv >> FIX_SHIFT;
+        int u1 = u0 + 1;
+        int v1 = v0 + 1;
+        bool in_u0 = wrap(&u0, p_paint->wrap_u, min_u, size_u);
+        bool in_u1 = wrap(&u1, p_paint->wrap_u, min_u, size_u);
+        bool in_v0 = wrap(&v0, p_paint->wrap_v, min_v, size_v);
+        bool in_v1 = wrap(&v1, p_paint->wrap_v, min_v, size_v);
+        uint32_t c00 = (in_u0 && in_v0) ? texel(p_tex, u0, v0) : 0;
+        uint32_t c10 = (in_u1 && in_v0) ? texel(p_tex, u1, v0) : 0;
+        uint32_t c01 = (in_u0 && in_v1) ? texel(p_tex, u0, v1) : 0;
+        uint32_t c11 = (in_u1 && in_v1) ? texel(p_tex, u1, v1) : 0;
+
+        if (!p_tex->premultiplied) {
+            c00 = premultiply(c00);
+            c10 = premultiply(c10);
+            c01 = premultiply(c01);
+            c11 = premultiply(c11);
+        }
+        p_argb[i] = unpremultiply(bilerp(c00, c10, c01, c11, ((uint32_t)su >> 8) & 0xFF, ((uint32_t)sv >> 8) & 0xFF));
+    }
+}
+
+/* Draw pixels of a row. p_cov is the coverage of each pixel (NULL: all 255) */
+void Canvas2D_Raster::span(const Pixel2D::surface_t * p_dst, int x, int y, int num, const uint8_t * p_cov,
+                           const paint_t * p_paint, Pixel2D::blend_mode_t mode, uint8_t global_alpha) {
+    uint32_t src[PIXEL_2D_CHUNK_NUM];
+    uint32_t dst[PIXEL_2D_CHUNK_NUM];
+    uint32_t org[PIXEL_2D_CHUNK_NUM];
+    int i;
+
+    if ((p_cov == NULL) && (p_paint->p_texture == NULL)) {
+        /* Span fill of a colour */
+        Pixel2D::rect_t rect = {x, y, num, 1};
+        uint32_t colour = p_paint->colour;
+
+        colour = (div255((colour >> 24) * global_alpha) << 24) | (colour & 0x00FFFFFF);
+        Pixel2D::Fill(p_dst, &rect, colour, mode);
+        return;
+    }
+
+    Fetch(p_paint, x, y, num, src);
+    Pixel2D::ReadLine(p_dst, x, y, num, dst);
+    if (mode == Pixel2D::BLEND_SRC_OVER) {
+        if (p_cov != NULL) {
+            for (i = 0; i < num; i++) {
+                src[i] = (div255((src[i] >> 24) * p_cov[i]) << 24) | (src[i] & 0x00FFFFFF);
+            }
+        }
+        Pixel2D::BlendLine(dst, src, num, mode, global_alpha);
+    } else {
+        if (p_cov != NULL) {
+            memcpy(org, dst, num * sizeof(uint32_t));
+        }
+        Pixel2D::BlendLine(dst, src, num, mode, global_alpha);
+        if (p_cov != NULL) {
+            for (i = 0; i < num; i++) {
+                if (p_cov[i] != 255) {
+                    dst[i] = lerp_coverage(org[i], dst[i], p_cov[i]);
+                }
+            }
+        }
+    }
+    Pixel2D::WriteLine(p_dst, x, y, num, dst);
+}
+
+void Canvas2D_Raster::FillPolygon(const Pixel2D::surface_t * p_dst, const Pixel2D::rect_t * p_clip, const float * p_xy, int num,
+                                  const paint_t * p_paint, Pixel2D::blend_mode_t mode, uint8_t global_alpha, const work_t * p_work) {
+    float min_x = p_xy[0];
+    float max_x = p_xy[0];
+    float min_y = p_xy[1];
+    float max_y = p_xy[1];
+    bool is_rect = true;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    int width;
+    int x;
+    int y;
+    int i;
+
+    if (num < 3) {
+        return;
+    }
+    for (i = 1; i < num; i++) {
+        min_x = (p_xy[i * 2] < min_x) ? p_xy[i * 2] : min_x;
+        max_x = (p_xy[i * 2] > max_x) ? p_xy[i * 2] : max_x;
+        min_y = (p_xy[(i * 2) + 1] < min_y) ? p_xy[(i * 2) + 1] : min_y;
+        max_y = (p_xy[(i * 2) + 1] > max_y) ? p_xy[(i * 2) + 1] : max_y;
+    }
+    if ((min_x < -FIX_LIMIT) || (max_x > FIX_LIMIT) || (min_y < -FIX_LIMIT) || (max_y > FIX_LIMIT)) {
+        return;
+    }
+
+    /* Bounding box in the clipping rectangle */
+    x0 = (int)floorf(min_x);
+    y0 = (int)floorf(min_y);
+    x1 = (int)ceilf(max_x);
+    y1 = (int)ceilf(max_y);
+    x0 = (x0 < p_clip->x) ? p_clip->x : x0;
+    y0 = (y0 < p_clip->y) ? p_clip->y : y0;
+    x1 = (x1 > (p_clip->x + p_clip->width)) ? (p_clip->x + p_clip->width) : x1;
+    y1 = (y1 > (p_clip->y + p_clip->height)) ? (p_clip->y + p_clip->height) : y1;
+    if ((x0 >= x1) || (y0 >= y1)) {
+        return;
+    }
+    width = x1 - x0;
+    if (width > p_work->width) {
+        return;
+    }
+
+    /* An axis-aligned rectangle at integer coordinates covers the pixels fully */
+    if (num == 4) {
+        for (i = 0; i < 4; i++) {
+            float ax = p_xy[i * 2];
+            float ay = p_xy[(i * 2) + 1];
+            float bx = p_xy[((i + 1) & 3) * 2];
+            float by = p_xy[(((i + 1) & 3) * 2) + 1];
+
+            if ((ax != floorf(ax)) || (ay != floorf(ay)) || ((ax != bx) && (ay != by))) {
+                is_rect = false;
+                break;
+            }
+        }
+    } else {
+        is_rect = false;
+    }
+    if (is_rect) {
+        if (p_paint->p_texture == NULL) {
+            Pixel2D::rect_t rect = {x0, y0, width, y1 - y0};
+            uint32_t colour = p_paint->colour;
+
+            colour = (div255((colour >> 24) * global_alpha) << 24) | (colour & 0x00FFFFFF);
+            Pixel2D::Fill(p_dst, &rect, colour, mode);
+            return;
+        }
+        for (y = y0; y < y1; y++) {
+            for (x = x0; x < x1; x += PIXEL_2D_CHUNK_NUM) {
+                int n = ((x1 - x) > PIXEL_2D_CHUNK_NUM) ? PIXEL_2D_CHUNK_NUM : (x1 - x);
+
+                span(p_dst, x, y, n, NULL, p_paint, mode, global_alpha);
+            }
+        }
+        return;
+    }
+
+    for (y = y0; y < y1; y++) {
+        uint16_t * p_area = p_work->p_area;
+        int16_t * p_cover = p_work->p_cover;
+        int left = width;
+        int right = -1;
+        int cover = 0;
+        int s;
+        uint8_t cov[PIXEL_2D_CHUNK_NUM];
+        int run_x = 0;
+        int run_num = 0;
+        bool run_full = true;
+
+        memset(p_area, 0, (width + 2) * sizeof(uint16_t));
+        memset(p_cover, 0, (width + 2) * sizeof(int16_t));
+
+        /* Coverage of the sub-scanlines */
+        for (s = 0; s < SUB_NUM; s++) {
+            float sy = (float)y + (((float)s + 0.5f) / (float)SUB_NUM);
+            float xl = FIX_LIMIT;
+            float xr = -FIX_LIMIT;
+            int32_t fl;
+            int32_t fr;
+            int il;
+            int ir;
+
+            for (i = 0; i < num; i++) {
+                float ax = p_xy[i * 2];
+                float ay = p_xy[(i * 2) + 1];
+                float bx = p_xy[((i + 1) % num) * 2];
+                float by = p_xy[(((i + 1) % num) * 2) + 1];
+                float cx;
+
+                if (((sy < ay) && (sy < by)) || ((sy >= ay) && (sy >= by))) {
+                    continue;
+                }
+                cx = ax + (((sy - ay) * (bx - ax)) / (by - ay));
+                xl = (cx < xl) ? cx : xl;
+                xr = (cx > xr) ? cx : xr;
+            }
+            if (xl >= xr) {
+                continue;
+            }
+            fl = to_fixed(xl - (float)x0);
+            fr = to_fixed(xr - (float)x0);
+            fl = (fl < 0) ? 0 : fl;
+            fr = (fr > (width << FIX_SHIFT)) ? (width << FIX_SHIFT) : fr;
+            if (fl >= fr) {
+                continue;
+            }
+            il = fl >> FIX_SHIFT;
+            ir = fr >> FIX_SHIFT;
+            if (il == ir) {
+                p_area[il] += (uint16_t)(((fr - fl) * SUB_WEIGHT) >> FIX_SHIFT);
+            } else {
+                p_area[il] += (uint16_t)(((FIX_ONE - (fl & (FIX_ONE - 1))) * SUB_WEIGHT) >> FIX_SHIFT);
+                p_cover[il + 1] += SUB_WEIGHT;
+                p_cover[ir] -= SUB_WEIGHT;
+                p_area[ir] += (uint16_t)(((fr & (FIX_ONE - 1)) * SUB_WEIGHT) >> FIX_SHIFT);
+            }
+            left = (il < left) ? il : left;
+            right = (ir > right) ? ir : right;
+        }
+        if (right >= width) {
+            right = width - 1;
+        }
+
+        /* Runs of the covered pixels */
+        for (i = 0; i <= right; i++) {
+            int c;
+            uint32_t a;
+
+            cover += p_cover[i];
+            if (i < left) {
+                continue;
+            }
+            c = cover + p_area[i];
+            a = (c >= 256) ? 255 : (c <= 0) ? 0 : (uint32_t)(((c * 255) + 128) >> 8);
+            if ((a == 0) || (run_num == PIXEL_2D_CHUNK_NUM)) {
+                if (run_num != 0) {
+                    span(p_dst, x0 + run_x, y, run_num, run_full ? NULL : cov, p_paint, mode, global_alpha);
+                    run_num = 0;
+                }
+                if (a == 0) {
+                    continue;
+                }
+            }
+            if (run_num == 0) {
+                run_x = i;
+                run_full = true;
+            }
+            cov[run_num++] = (uint8_t)a;
+            if (a != 255) {
+                run_full = false;
+            }
+        }
+        if (run_num != 0) {
+            span(p_dst, x0 + run_x, y, run_num, run_full ? NULL : cov, p_paint, mode, global_alpha);
+        }
+    }
+}
+
+#endif
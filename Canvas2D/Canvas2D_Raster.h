@@ -0,0 +1,125 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Canvas2D_Raster.h
+* @brief         Anti-aliased scanline rasterizer and image sampler of Canvas2D_Soft
+*
+* A convex polygon is rasterized row by row. The coverage of each pixel is the sum of
+* 4 sub-scanlines, and each sub-scanline adds the exact horizontal area (16.16 fixed-point)
+* of the pixel. The fully covered pixels are accumulated as a difference array, so a row costs
+* O(width) regardless of the number of sub-scanlines.
+*
+* The paint is a colour or a texture mapped by an affine matrix. The texture coordinates are
+* stepped in 16.16 fixed-point along the row, and sampled with the nearest texel or bilinear
+* filtering (premultiplied by alpha).
+******************************************************************************/
+
+#ifndef CANVAS_2D_RASTER_H
+#define CANVAS_2D_RASTER_H
+
+#include "Pixel2D.h"
+
+/** A class of the rasterizer of Canvas2D_Soft
+ */
+class Canvas2D_Raster {
+public:
+    /*! @enum wrap_t
+        @brief Texture coordinate outside the area
+     */
+    typedef enum {
+        WRAP_CLAMP = 0,                 /*!< The edge texel (drawImage) */
+        WRAP_REPEAT,                    /*!< Repeated (pattern) */
+        WRAP_NONE,                      /*!< Transparent (pattern without repetition) */
+    } wrap_t;
+
+    /*! @struct texture_t
+        @brief Pixels of an image
+     */
+    typedef struct {
+        const uint8_t *     p_buf;      /*!< Top left pixel */
+        int                 width;      /*!< Width (pixel) */
+        int                 height;     /*!< Height (pixel) */
+        int                 stride;     /*!< Stride (byte) */
+        int                 format;     /*!< pixel_format_t */
+        const uint8_t *     p_alpha;    /*!< A8 plane of RGB565 (NULL: opaque) */
+        int                 alpha_stride; /*!< Stride of the A8 plane (byte) */
+        bool                premultiplied; /*!< true = the colours are premultiplied by alpha */
+    } texture_t;
+
+    /*! @struct paint_t
+        @brief Colour or texture to fill
+     */
+    typedef struct {
+        uint32_t            colour;     /*!< Colour (ARGB8888) when p_texture is NULL */
+        const texture_t *   p_texture;  /*!< Texture (NULL: colour) */
+        float               inv[6];     /*!< Frame buffer to texture: u = inv[0] * x + inv[2] * y + inv[4], v = inv[1] * x + inv[3] * y + inv[5] */
+        Pixel2D::rect_t     area;       /*!< Sampled area of the texture */
+        wrap_t              wrap_u;     /*!< Wrap of u */
+        wrap_t              wrap_v;     /*!< Wrap of v */
+        bool                bilinear;   /*!< true = bilinear filtering, false = nearest texel */
+    } paint_t;
+
+    /*! @struct work_t
+        @brief Work buffers (width + 2 elements)
+     */
+    typedef struct {
+        uint16_t *          p_area;     /*!< Partial coverage of each pixel */
+        int16_t *           p_cover;    /*!< Difference array of the full coverage */
+        int                 width;      /*!< Number of the elements - 2 */
+    } work_t;
+
+    /** Get the texture of an image format
+     *
+     * @param p_buf top left pixel
+     * @param width width
+     * @param height height
+     * @param stride stride (byte)
+     * @param format pixel_format_t
+     * @param p_texture texture
+     * @return true = supported format, false = not supported
+     */
+    static bool SetTexture(const uint8_t * p_buf, int width, int height, int stride, int format, texture_t * p_texture);
+
+    /** Fill a convex polygon
+     *
+     * @param p_dst destination
+     * @param p_clip clipping rectangle in the destination
+     * @param p_xy vertices { x0, y0, x1, y1, ... } in the destination
+     * @param num number of the vertices
+     * @param p_paint paint
+     * @param mode compositing operator
+     * @param global_alpha alpha multiplied to the paint (0 - 255)
+     * @param p_work work buffers (width >= width of the clipping rectangle)
+     */
+    static void FillPolygon(const Pixel2D::surface_t * p_dst, const Pixel2D::rect_t * p_clip, const float * p_xy, int num,
+                            const paint_t * p_paint, Pixel2D::blend_mode_t mode, uint8_t global_alpha, const work_t * p_work);
+
+    /** Sample the paint for pixels of a row
+     *
+     * @param p_paint paint
+     * @param x left of the destination
+     * @param y row of the destination
+     * @param num number of pixels
+     * @param p_argb output (ARGB8888)
+     */
+    static void Fetch(const paint_t * p_paint, int x, int y, int num, uint32_t * p_argb);
+
+private:
+    static void span(const Pixel2D::surface_t * p_dst, int x, int y, int num, const uint8_t * p_cov,
+                     const paint_t * p_paint, Pixel2D::blend_mode_t mode, uint8_t global_alpha);
+};
+
+#endif
@@ -0,0 +1,1088 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(TARGET_RZA1H)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Canvas2D_Soft.h"
+#include "Canvas2D_Raster.h"
+
+#define IMAGE_OK        (0)
+#define IMAGE_ERROR     (1)
+
+typedef struct {
+    const char *    name;
+    uint32_t        colour;
+} named_colour_t;
+
+static const named_colour_t named_colour[] = {
+    {"black",       0xFF000000},
+    {"white",       0xFFFFFFFF},
+    {"red",         0xFFFF0000},
+    {"lime",        0xFF00FF00},
+    {"green",       0xFF008000},
+    {"blue",        0xFF0000FF},
+    {"yellow",      0xFFFFFF00},
+    {"cyan",        0xFF00FFFF},
+    {"aqua",        0xFF00FFFF},
+    {"magenta",     0xFFFF00FF},
+    {"fuchsia",     0xFFFF00FF},
+    {"gray",        0xFF808080},
+    {"grey",        0xFF808080},
+    {"silver",      0xFFC0C0C0},
+    {"maroon",      0xFF800000},
+    {"navy",        0xFF000080},
+    {"olive",       0xFF808000},
+    {"purple",      0xFF800080},
+    {"teal",        0xFF008080},
+    {"orange",      0xFFFFA500},
+    {"transparent", 0x00000000},
+};
+
+/* Index = graphics_composite_operation_t */
+static const char * const composite_name[] = {
+    "copy",
+    "source-over",
+    "source-in",
+    "source-out",
+    "source-atop",
+    "destination-over",
+    "destination-in",
+    "destination-out",
+    "destination-atop",
+    "xor",
+};
+
+static const Pixel2D::blend_mode_t composite_mode[] = {
+    Pixel2D::BLEND_SRC,
+    Pixel2D::BLEND_SRC_OVER,
+    Pixel2D::BLEND_SRC_IN,
+    Pixel2D::BLEND_SRC_OUT,
+    Pixel2D::BLEND_SRC_ATOP,
+    Pixel2D::BLEND_DST_OVER,
+    Pixel2D::BLEND_DST_IN,
+    Pixel2D::BLEND_DST_OUT,
+    Pixel2D::BLEND_DST_ATOP,
+    Pixel2D::BLEND_XOR,
+};
+
+static bool get_surface(const frame_buffer_t * p_frame, Pixel2D::surface_t * p_surface) {
+    if ((p_frame == NULL) || (p_frame->draw_buffer_index < 0) || (p_frame->draw_buffer_index >= p_frame->buffer_count)) {
+        return false;
+    }
+    switch (p_frame->pixel_format) {
+        case PIXEL_FORMAT_RGB565:   p_surface->format = Pixel2D::FORMAT_RGB565;   break;
+        case PIXEL_FORMAT_ARGB8888: p_surface->format = Pixel2D::FORMAT_ARGB8888; break;
+        case PIXEL_FORMAT_XRGB8888: p_surface->format = Pixel2D::FORMAT_RGB888;   break;
+        case PIXEL_FORMAT_ARGB4444: p_surface->format = Pixel2D::FORMAT_ARGB4444; break;
+        case PIXEL_FORMAT_YUV422:   p_surface->format = Pixel2D::FORMAT_YCBCR422; break;
+        default:                    return false;
+    }
+    p_surface->p_buf = p_frame->buffer_address[p_frame->draw_buffer_index];
+    p_surface->width = (int)p_frame->width;
+    p_surface->height = (int)p_frame->height;
+    p_surface->stride = (int)p_frame->stride;
+    p_surface->p_clut = NULL;
+    p_surface->clut_num = 0;
+    return (p_surface->p_buf != NULL);
+}
+
+static int get_byte_per_pixel(int format) {
+    switch (format) {
+        case PIXEL_FORMAT_R8G8B8A8:
+        case PIXEL_FORMAT_ARGB8888:
+        case PIXEL_FORMAT_XRGB8888:
+            return 4;
+        case PIXEL_FORMAT_RGB565:
+        case PIXEL_FORMAT_ARGB4444:
+            return 2;
+        case PIXEL_FORMAT_A8:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static uint8_t * get_image_address(const graphics_image_t * p_image, uintptr_t offset) {
+    if ((p_image->flags & F_T_IMAGE_INF_RAW_MASK) == F_T_IMAGE_INF_RAW_OFFSET) {
+        return (uint8_t *)p_image + offset;
+    }
+    return (uint8_t *)offset;
+}
+
+static bool get_texture(const graphics_image_t * p_image, Canvas2D_Raster::texture_t * p_texture) {
+    int stride;
+
+    if (p_image == NULL) {
+        return false;
+    }
+    stride = (int)p_image->width * get_byte_per_pixel(p_image->type);
+    if ((p_image->flags & F_T_IMAGE_INF_LINE_OFFSET) != 0) {
+        stride = (int)p_image->color;
+    }
+    if (!Canvas2D_Raster::SetTexture(get_image_address(p_image, p_image->offset_to_image), p_image->width, p_image->height,
+                                     stride, p_image->type, p_texture)) {
+        return false;
+    }
+    if ((p_image->type == PIXEL_FORMAT_RGB565) && (p_image->offset_to_alpha != 0)) {
+        p_texture->p_alpha = get_image_address(p_image, p_image->offset_to_alpha);
+        p_texture->alpha_stride = p_image->width;
+    }
+    p_texture->premultiplied = ((p_image->flags & F_T_IMAGE_INF_PREMULTIPLIED_ALPHA) != 0);
+    return true;
+}
+
+static void get_clip(const graphics_t * p_graphics, Pixel2D::rect_t * p_clip) {
+    p_clip->x = (int)p_graphics->status.clip_x0;
+    p_clip->y = (int)p_graphics->status.clip_y0;
+    p_clip->width = (int)(p_graphics->status.clip_x1 - p_graphics->status.clip_x0);
+    p_clip->height = (int)(p_graphics->status.clip_y1 - p_graphics->status.clip_y0);
+}
+
+static void transform_point(const float * p_m, float x, float y, float * p_x, float * p_y) {
+    *p_x = (p_m[0] * x) + (p_m[2] * y) + p_m[4];
+    *p_y = (p_m[1] * x) + (p_m[3] * y) + p_m[5];
+}
+
+/* out = a * b (b is applied first) */
+static void multiply(const float * p_a, const float * p_b, float * p_out) {
+    float m[6];
+
+    m[0] = (p_a[0] * p_b[0]) + (p_a[2] * p_b[1]);
+    m[1] = (p_a[1] * p_b[0]) + (p_a[3] * p_b[1]);
+    m[2] = (p_a[0] * p_b[2]) + (p_a[2] * p_b[3]);
+    m[3] = (p_a[1] * p_b[2]) + (p_a[3] * p_b[3]);
+    m[4] = (p_a[0] * p_b[4]) + (p_a[2] * p_b[5]) + p_a[4];
+    m[5] = (p_a[1] * p_b[4]) + (p_a[3] * p_b[5]) + p_a[5];
+    memcpy(p_out, m, sizeof(m));
+}
+
+static bool invert(const float * p_m, float * p_inv) {
+    float det = (p_m[0] * p_m[3]) - (p_m[1] * p_m[2]);
+
+    if (det == 0.0f) {
+        return false;
+    }
+    p_inv[0] = p_m[3] / det;
+    p_inv[1] = -p_m[1] / det;
+    p_inv[2] = -p_m[2] / det;
+    p_inv[3] = p_m[0] / det;
+    p_inv[4] = -((p_inv[0] * p_m[4]) + (p_inv[2] * p_m[5]));
+    p_inv[5] = -((p_inv[1] * p_m[4]) + (p_inv[3] * p_m[5]));
+    return true;
+}
+
+static bool is_integer_translation(const float * p_m) {
+    return (p_m[0] == 1.0f) && (p_m[1] == 0.0f) && (p_m[2] == 0.0f) && (p_m[3] == 1.0f)
+           && (p_m[4] == floorf(p_m[4])) && (p_m[5] == floorf(p_m[5]));
+}
+
+/* Fill a rectangle of the user space transformed by the matrix */
+static void fill_rect(graphics_t * p_graphics, float x, float y, float w, float h,
+                      const Canvas2D_Raster::paint_t * p_paint, Pixel2D::blend_mode_t mode, uint8_t global_alpha) {
+    const float * p_m = p_graphics->status.matrix;
+    Pixel2D::surface_t dst;
+    Pixel2D::rect_t clip;
+    Canvas2D_Raster::work_t work;
+    float xy[8];
+
+    if (!get_surface(p_graphics->frame_buffer, &dst)) {
+        return;
+    }
+    get_clip(p_graphics, &clip);
+    if ((clip.width <= 0) || (clip.height <= 0)) {
+        return;
+    }
+    work.p_area = p_graphics->p_area;
+    work.p_cover = p_graphics->p_cover;
+    work.width = (int)p_graphics->work_width;
+
+    transform_point(p_m, x, y, &xy[0], &xy[1]);
+    transform_point(p_m, x + w, y, &xy[2], &xy[3]);
+    transform_point(p_m, x + w, y + h, &xy[4], &xy[5]);
+    transform_point(p_m, x, y + h, &xy[6], &xy[7]);
+    Canvas2D_Raster::FillPolygon(&dst, &clip, xy, 4, p_paint, mode, global_alpha, &work);
+}
+
+static bool parse_colour(const char * p_str, uint32_t * p_colour) {
+    unsigned int v;
+    int r;
+    int g;
+    int b;
+    float a;
+    size_t len;
+    size_t i;
+
+    if (p_str == NULL) {
+        return false;
+    }
+    len = strlen(p_str);
+    if (p_str[0] == '#') {
+        for (i = 1; i < len; i++) {
+            if (strchr("0123456789abcdefABCDEF", p_str[i]) == NULL) {
+                return false;
+            }
+        }
+        v = (unsigned int)strtoul(&p_str[1], NULL, 16);
+        if (len == 4) {
+            *p_colour = 0xFF000000 | (((v >> 8) & 0xF) * 0x110000) | (((v >> 4) & 0xF) * 0x1100) | ((v & 0xF) * 0x11);
+            return true;
+        }
+        if (len == 7) {
+            *p_colour = 0xFF000000 | v;
+            return true;
+        }
+        return false;
+    }
+    if (sscanf(p_str, "rgba(%d ,%d ,%d ,%f )", &r, &g, &b, &a) == 4) {
+        a = (a < 0.0f) ? 0.0f : (a > 1.0f) ? 1.0f : a;
+    } else if (sscanf(p_str, "rgb(%d ,%d ,%d )", &r, &g, &b) == 3) {
+        a = 1.0f;
+    } else {
+        for (i = 0; i < (sizeof(named_colour) / sizeof(named_colour[0])); i++) {
+            if (strcmp(p_str, named_colour[i].name) == 0) {
+                *p_colour = named_colour[i].colour;
+                return true;
+            }
+        }
+        return false;
+    }
+    r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+    g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+    b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+    *p_colour = ((uint32_t)((a * 255.0f) + 0.5f) << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    return true;
+}
+
+/* Allocate an R8G8B8A8 image and its pixels at once */
+static graphics_image_t * new_image(int width, int height) {
+    size_t size;
+    uint8_t * p_mem;
+    graphics_image_t * p_image;
+
+    if ((width <= 0) || (height <= 0) || (width > 0xFFFF) || (height > 0xFFFF)) {
+        return NULL;
+    }
+    size = (size_t)width * (size_t)height * 4;
+    p_mem = (uint8_t *)malloc(sizeof(graphics_image_t) + size);
+    if (p_mem == NULL) {
+        return NULL;
+    }
+    p_image = (graphics_image_t *)p_mem;
+    memset(p_mem + sizeof(graphics_image_t), 0, size);
+    (void)R_GRAPHICS_IMAGE_InitR8G8B8A8(p_image, p_mem + sizeof(graphics_image_t), size, width, height);
+    p_image->flags = F_T_IMAGE_INF_RAW_OFFSET;
+    p_image->offset_to_image = sizeof(graphics_image_t);
+    return p_image;
+}
+
+
+/***********************************************************************
+* Functions of the images
+************************************************************************/
+
+int R_GRAPHICS_IMAGE_InitR8G8B8A8(graphics_image_t * self, void * ImageDataArray, size_t ImageDataArraySize,
+                                  int_fast32_t width, int_fast32_t height) {
+    if ((self == NULL) || (ImageDataArray == NULL) || (width <= 0) || (height <= 0)
+        || (width > 0xFFFF) || (height > 0xFFFF) || (ImageDataArraySize < ((size_t)width * (size_t)height * 4))) {
+        return IMAGE_ERROR;
+    }
+    memset(self, 0, sizeof(graphics_image_t));
+    self->flags = F_T_IMAGE_INF_RAW_ADDRESS;
+    self->offset_to_image = (uintptr_t)ImageDataArray;
+    self->width = (uint16_t)width;
+    self->height = (uint16_t)height;
+    self->type = (uint8_t)PIXEL_FORMAT_R8G8B8A8;
+    return IMAGE_OK;
+}
+
+int R_GRAPHICS_IMAGE_InitSameSizeR8G8B8A8(graphics_image_t * self, void * ImageDataArray, size_t ImageDataArraySize,
+                                          graphics_image_t * SameSizeImage) {
+    if (SameSizeImage == NULL) {
+        return IMAGE_ERROR;
+    }
+    return R_GRAPHICS_IMAGE_InitR8G8B8A8(self, ImageDataArray, ImageDataArraySize, SameSizeImage->width, SameSizeImage->height);
+}
+
+int R_GRAPHICS_IMAGE_InitByShareFrameBuffer(graphics_image_t * self, frame_buffer_t * frame_buffer) {
+    if ((self == NULL) || (frame_buffer == NULL) || (get_byte_per_pixel(frame_buffer->pixel_format) == 0)
+        || (frame_buffer->draw_buffer_index < 0) || (frame_buffer->draw_buffer_index >= frame_buffer->buffer_count)) {
+        return IMAGE_ERROR;
+    }
+    memset(self, 0, sizeof(graphics_image_t));
+    self->flags = F_T_IMAGE_INF_RAW_ADDRESS | F_T_IMAGE_INF_LINE_OFFSET;
+    self->offset_to_image = (uintptr_t)frame_buffer->buffer_address[frame_buffer->draw_buffer_index];
+    self->width = (uint16_t)frame_buffer->width;
+    self->height = (uint16_t)frame_buffer->height;
+    self->type = (uint8_t)frame_buffer->pixel_format;
+    self->color = (uint32_t)frame_buffer->stride;
+    return IMAGE_OK;
+}
+
+int R_GRAPHICS_IMAGE_GetProperties(const graphics_image_t * self, graphics_image_properties_t * out_Properties) {
+    if ((self == NULL) || (out_Properties == NULL)) {
+        return IMAGE_ERROR;
+    }
+    out_Properties->width = self->width;
+    out_Properties->height = self->height;
+    out_Properties->pixels = get_image_address(self, self->offset_to_image);
+    out_Properties->data = (self->type == PIXEL_FORMAT_R8G8B8A8) ? (uint8_t *)out_Properties->pixels : NULL;
+    out_Properties->pixelFormat = (pixel_format_t)self->type;
+    out_Properties->CLUT = NULL;
+    out_Properties->CLUT_count = 0;
+    return IMAGE_OK;
+}
+
+int R_GRAPHICS_IMAGE_GetImageFormat(const graphics_image_t * self, pixel_format_t * out_Format) {
+    if ((self == NULL) || (out_Format == NULL)) {
+        return IMAGE_ERROR;
+    }
+    *out_Format = (pixel_format_t)self->type;
+    return IMAGE_OK;
+}
+
+
+/***********************************************************************
+* Class: ObjectHandleClass
+************************************************************************/
+
+bool operator == (ObjectHandleClass Left, ObjectHandleClass Right) {
+    return (Left.Entity == Right.Entity);
+}
+
+ObjectHandleClass get_undefined() {
+    ObjectHandleClass  object;
+
+    return object;
+}
+
+
+/***********************************************************************
+* Class: Canvas2D_ImageClass
+************************************************************************/
+
+void Canvas2D_ImageClass::set_imageClass(graphics_image_t * imageClass) {
+    if (this->Entity == NULL) {
+        this->Entity = new Canvas2D_ImageEntityClass(false);
+        if (this->Entity == NULL) {
+            return;
+        }
+    }
+    if (this->Entity->isImageDataComposition) {
+        free(this->Entity->C_Image);
+        this->Entity->isImageDataComposition = false;
+    }
+    this->Entity->C_Image = imageClass;
+}
+
+void Canvas2D_ImageClass::destroy() {
+    if (this->Entity == NULL) {
+        return;
+    }
+    if (this->Entity->isImageDataComposition) {
+        free(this->Entity->C_Image);
+    }
+    delete this->Entity;
+    this->Entity = NULL;
+}
+
+
+/***********************************************************************
+* Class: Canvas2D_PatternClass
+************************************************************************/
+
+void Canvas2D_PatternClass::destroy() {
+    delete this->Entity;
+    this->Entity = NULL;
+}
+
+
+/***********************************************************************
+* Class: Canvas2D_ContextClass
+************************************************************************/
+
+void Canvas2D_ContextClass::destroy() {
+    graphics_t * p_graphics;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    while (this->Entity->LastSavePoint != NULL) {
+        saveList_st * p_save = this->Entity->LastSavePoint;
+
+        this->Entity->LastSavePoint = p_save->beforePoint;
+        delete p_save;
+    }
+    p_graphics = this->Entity->C_Graphics;
+    if (p_graphics != NULL) {
+        delete [] p_graphics->p_area;
+        delete [] p_graphics->p_cover;
+        delete p_graphics;
+    }
+    delete this->Entity;
+    this->Entity = NULL;
+}
+
+void Canvas2D_ContextClass::clearRect(int x, int y, int w, int h) {
+    Canvas2D_Raster::paint_t paint;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    memset(&paint, 0, sizeof(paint));
+    paint.colour = 0x00000000;
+    fill_rect(this->Entity->C_Graphics, (float)x, (float)y, (float)w, (float)h, &paint, Pixel2D::BLEND_SRC, 255);
+}
+
+void Canvas2D_ContextClass::save() {
+    saveList_st * p_save;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    p_save = new saveList_st;
+    if (p_save == NULL) {
+        return;
+    }
+    p_save->saveData = this->Entity->C_Graphics->status;
+    p_save->beforePoint = this->Entity->LastSavePoint;
+    this->Entity->LastSavePoint = p_save;
+}
+
+void Canvas2D_ContextClass::restore() {
+    saveList_st * p_save;
+
+    if ((this->Entity == NULL) || (this->Entity->LastSavePoint == NULL)) {
+        return;
+    }
+    p_save = this->Entity->LastSavePoint;
+    this->Entity->C_Graphics->status = p_save->saveData;
+    this->Entity->LastSavePoint = p_save->beforePoint;
+    delete p_save;
+}
+
+void Canvas2D_ContextClass::drawImage(const graphics_image_t * image, int minX, int minY) {
+    if (image == NULL) {
+        return;
+    }
+    drawImage(image, 0, 0, image->width, image->height, minX, minY, image->width, image->height);
+}
+
+void Canvas2D_ContextClass::drawImage(const graphics_image_t * image, int minX, int minY, int width, int height) {
+    if (image == NULL) {
+        return;
+    }
+    drawImage(image, 0, 0, image->width, image->height, minX, minY, width, height);
+}
+
+void Canvas2D_ContextClass::drawImage(const graphics_image_t * image, int srcMinX, int srcMinY, int srcWidth, int srcHeight,
+                                      int destMinx, int destMinY, int destWidth, int destHeight) {
+    graphics_t * p_graphics;
+    const float * p_m;
+    Canvas2D_Raster::texture_t texture;
+    Canvas2D_Raster::paint_t paint;
+    Pixel2D::blend_mode_t mode;
+    float sx = (float)srcMinX;
+    float sy = (float)srcMinY;
+    float sw = (float)srcWidth;
+    float sh = (float)srcHeight;
+    float dx = (float)destMinx;
+    float dy = (float)destMinY;
+    float dw = (float)destWidth;
+    float dh = (float)destHeight;
+    float kx;
+    float ky;
+    float cut;
+    float scale[6];
+
+    if ((this->Entity == NULL) || !get_texture(image, &texture)) {
+        return;
+    }
+    p_graphics = this->Entity->C_Graphics;
+    p_m = p_graphics->status.matrix;
+    mode = composite_mode[p_graphics->status.composite_operation];
+
+    /* Normalize the rectangles */
+    if (sw < 0.0f) {
+        sx += sw;
+        sw = -sw;
+    }
+    if (sh < 0.0f) {
+        sy += sh;
+        sh = -sh;
+    }
+    if (dw < 0.0f) {
+        dx += dw;
+        dw = -dw;
+    }
+    if (dh < 0.0f) {
+        dy += dh;
+        dh = -dh;
+    }
+    if ((sw == 0.0f) || (sh == 0.0f) || (dw == 0.0f) || (dh == 0.0f)) {
+        return;
+    }
+
+    /* Clip the source rectangle to the image, the destination is clipped at the same ratio */
+    kx = dw / sw;
+    ky = dh / sh;
+    if (sx < 0.0f) {
+        dx -= sx * kx;
+        sw += sx;
+        sx = 0.0f;
+    }
+    if (sy < 0.0f) {
+        dy -= sy * ky;
+        sh += sy;
+        sy = 0.0f;
+    }
+    cut = (sx + sw) - (float)texture.width;
+    if (cut > 0.0f) {
+        sw -= cut;
+    }
+    cut = (sy + sh) - (float)texture.height;
+    if (cut > 0.0f) {
+        sh -= cut;
+    }
+    if ((sw <= 0.0f) || (sh <= 0.0f)) {
+        return;
+    }
+    dw = sw * kx;
+    dh = sh * ky;
+
+    /* Same size at integer coordinates: blended by Pixel2D */
+    if ((kx == 1.0f) && (ky == 1.0f) && is_integer_translation(p_m) && (texture.p_alpha == NULL) && !texture.premultiplied
+        && (dx == floorf(dx)) && (dy == floorf(dy))) {
+        Pixel2D::surface_t dst;
+        Pixel2D::surface_t src;
+        Pixel2D::rect_t clip;
+        Pixel2D::rect_t src_rect;
+        int x = (int)dx + (int)p_m[4];
+        int y = (int)dy + (int)p_m[5];
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+        bool direct = true;
+
+        switch (texture.format) {
+            case PIXEL_FORMAT_ARGB8888: src.format = Pixel2D::FORMAT_ARGB8888; break;
+            case PIXEL_FORMAT_XRGB8888: src.format = Pixel2D::FORMAT_RGB888;   break;
+            case PIXEL_FORMAT_RGB565:   src.format = Pixel2D::FORMAT_RGB565;   break;
+            case PIXEL_FORMAT_ARGB4444: src.format = Pixel2D::FORMAT_ARGB4444; break;
+            default:                    direct = false;                        break;
+        }
+        if (direct) {
+            if (!get_surface(p_graphics->frame_buffer, &dst)) {
+                return;
+            }
+            src.p_buf = (uint8_t *)texture.p_buf;
+            src.width = texture.width;
+            src.height = texture.height;
+            src.stride = texture.stride;
+            src.p_clut = NULL;
+            src.clut_num = 0;
+            get_clip(p_graphics, &clip);
+            x0 = (x > clip.x) ? x : clip.x;
+            y0 = (y > clip.y) ? y : clip.y;
+            x1 = ((x + (int)sw) < (clip.x + clip.width)) ? (x + (int)sw) : (clip.x + clip.width);
+            y1 = ((y + (int)sh) < (clip.y + clip.height)) ? (y + (int)sh) : (clip.y + clip.height);
+            if ((x0 >= x1) || (y0 >= y1)) {
+                return;
+            }
+            src_rect.x = (int)sx + (x0 - x);
+            src_rect.y = (int)sy + (y0 - y);
+            src_rect.width = x1 - x0;
+            src_rect.height = y1 - y0;
+            (void)Pixel2D::Blend(&dst, x0, y0, &src, &src_rect, mode, p_graphics->status.global_alpha);
+            return;
+        }
+    }
+
+    /* Frame buffer -> user space -> image */
+    memset(&paint, 0, sizeof(paint));
+    if (!invert(p_m, paint.inv)) {
+        return;
+    }
+    scale[0] = 1.0f / kx;
+    scale[1] = 0.0f;
+    scale[2] = 0.0f;
+    scale[3] = 1.0f / ky;
+    scale[4] = sx - (dx / kx);
+    scale[5] = sy - (dy / ky);
+    multiply(scale, paint.inv, paint.inv);
+    paint.p_texture = &texture;
+    paint.area.x = (int)floorf(sx);
+    paint.area.y = (int)floorf(sy);
+    paint.area.width = (int)ceilf(sx + sw) - paint.area.x;
+    paint.area.height = (int)ceilf(sy + sh) - paint.area.y;
+    paint.wrap_u = Canvas2D_Raster::WRAP_CLAMP;
+    paint.wrap_v = Canvas2D_Raster::WRAP_CLAMP;
+    paint.bilinear = !((kx == 1.0f) && (ky == 1.0f) && is_integer_translation(p_m)
+                       && (dx == floorf(dx)) && (dy == floorf(dy)));
+    fill_rect(p_graphics, dx, dy, dw, dh, &paint, mode, p_graphics->status.global_alpha);
+}
+
+Canvas2D_ImageClass Canvas2D_ContextClass::createImageData(Canvas2D_ImageClass image) {
+    graphics_image_properties_t prop;
+
+    if ((image.Entity == NULL) || (R_GRAPHICS_IMAGE_GetProperties(image.Entity->C_Image, &prop) != IMAGE_OK)) {
+        Canvas2D_ImageClass  empty;
+
+        return empty;
+    }
+    return createImageData((int)prop.width, (int)prop.height);
+}
+
+Canvas2D_ImageClass Canvas2D_ContextClass::createImageData(int width, int height) {
+    Canvas2D_ImageClass  image;
+    graphics_image_t * p_image = new_image(width, height);
+
+    if (p_image == NULL) {
+        return image;
+    }
+    image.Entity = new Canvas2D_ImageEntityClass(true);
+    if (image.Entity == NULL) {
+        free(p_image);
+        return image;
+    }
+    image.Entity->C_Image = p_image;
+    return image;
+}
+
+Canvas2D_ImageClass Canvas2D_ContextClass::getImageData(int minX, int minY, int width, int height) {
+    Canvas2D_ImageClass  image;
+    Pixel2D::surface_t src;
+    uint32_t argb[PIXEL_2D_CHUNK_NUM];
+    uint8_t * p_data;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    int x;
+    int y;
+    int i;
+
+    if ((this->Entity == NULL) || !get_surface(this->Entity->C_Graphics->frame_buffer, &src)) {
+        return image;
+    }
+    image = createImageData(width, height);
+    if (image.Entity == NULL) {
+        return image;
+    }
+    p_data = get_image_address(image.Entity->C_Image, image.Entity->C_Image->offset_to_image);
+
+    /* The pixels outside the frame buffer are transparent black */
+    x0 = (minX > 0) ? minX : 0;
+    y0 = (minY > 0) ? minY : 0;
+    x1 = ((minX + width) < src.width) ? (minX + width) : src.width;
+    y1 = ((minY + height) < src.height) ? (minY + height) : src.height;
+    for (y = y0; y < y1; y++) {
+        for (x = x0; x < x1; x += PIXEL_2D_CHUNK_NUM) {
+            int num = ((x1 - x) > PIXEL_2D_CHUNK_NUM) ? PIXEL_2D_CHUNK_NUM : (x1 - x);
+            uint8_t * p = p_data + ((((y - minY) * width) + (x - minX)) * 4);
+
+            Pixel2D::ReadLine(&src, x, y, num, argb);
+            for (i = 0; i < num; i++) {
+                p[(i * 4) + 0] = (uint8_t)(argb[i] >> 16);
+                p[(i * 4) + 1] = (uint8_t)(argb[i] >> 8);
+                p[(i * 4) + 2] = (uint8_t)argb[i];
+                p[(i * 4) + 3] = (uint8_t)(argb[i] >> 24);
+            }
+        }
+    }
+    return image;
+}
+
+void Canvas2D_ContextClass::putImageData(Canvas2D_ImageClass imageData, int minX, int minY) {
+    if ((imageData.Entity == NULL) || (imageData.Entity->C_Image == NULL)) {
+        return;
+    }
+    putImageData(imageData, minX, minY, 0, 0, imageData.Entity->C_Image->width, imageData.Entity->C_Image->height);
+}
+
+void Canvas2D_ContextClass::putImageData(Canvas2D_ImageClass imageData, int minX, int minY,
+                                         int dirtyX, int dirtyY, int dirtyWidth, int dirtyHeight) {
+    Pixel2D::surface_t dst;
+    Canvas2D_Raster::texture_t texture;
+    Canvas2D_Raster::paint_t paint;
+    uint32_t argb[PIXEL_2D_CHUNK_NUM];
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    int x;
+    int y;
+
+    if ((this->Entity == NULL) || (imageData.Entity == NULL) || !get_texture(imageData.Entity->C_Image, &texture)
+        || !get_surface(this->Entity->C_Graphics->frame_buffer, &dst)) {
+        return;
+    }
+    if (dirtyWidth < 0) {
+        dirtyX += dirtyWidth;
+        dirtyWidth = -dirtyWidth;
+    }
+    if (dirtyHeight < 0) {
+        dirtyY += dirtyHeight;
+        dirtyHeight = -dirtyHeight;
+    }
+
+    /* Dirty rectangle in the image and in the frame buffer (not transformed, not clipped by clip()) */
+    x0 = (dirtyX > 0) ? dirtyX : 0;
+    y0 = (dirtyY > 0) ? dirtyY : 0;
+    x1 = ((dirtyX + dirtyWidth) < texture.width) ? (dirtyX + dirtyWidth) : texture.width;
+    y1 = ((dirtyY + dirtyHeight) < texture.height) ? (dirtyY + dirtyHeight) : texture.height;
+    x0 = ((minX + x0) > 0) ? x0 : -minX;
+    y0 = ((minY + y0) > 0) ? y0 : -minY;
+    x1 = ((minX + x1) < dst.width) ? x1 : (dst.width - minX);
+    y1 = ((minY + y1) < dst.height) ? y1 : (dst.height - minY);
+
+    memset(&paint, 0, sizeof(paint));
+    paint.p_texture = &texture;
+    paint.inv[0] = 1.0f;
+    paint.inv[3] = 1.0f;
+    paint.inv[4] = (float)-minX;
+    paint.inv[5] = (float)-minY;
+    paint.area.width = texture.width;
+    paint.area.height = texture.height;
+    paint.wrap_u = Canvas2D_Raster::WRAP_CLAMP;
+    paint.wrap_v = Canvas2D_Raster::WRAP_CLAMP;
+    paint.bilinear = false;
+    for (y = y0; y < y1; y++) {
+        for (x = x0; x < x1; x += PIXEL_2D_CHUNK_NUM) {
+            int num = ((x1 - x) > PIXEL_2D_CHUNK_NUM) ? PIXEL_2D_CHUNK_NUM : (x1 - x);
+
+            Canvas2D_Raster::Fetch(&paint, minX + x, minY + y, num, argb);
+            Pixel2D::WriteLine(&dst, minX + x, minY + y, num, argb);
+        }
+    }
+}
+
+void Canvas2D_ContextClass::fillRect(int x, int y, int w, int h) {
+    graphics_t * p_graphics;
+    Canvas2D_Raster::texture_t texture;
+    Canvas2D_Raster::paint_t paint;
+    const graphics_pattern_t * p_pattern;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    p_graphics = this->Entity->C_Graphics;
+    p_pattern = p_graphics->status.fill_pattern;
+    memset(&paint, 0, sizeof(paint));
+    paint.colour = p_graphics->status.fill_colour;
+    if (p_pattern != NULL) {
+        /* The pattern is in the user space */
+        if (!get_texture(p_pattern->image, &texture) || !invert(p_graphics->status.matrix, paint.inv)) {
+            return;
+        }
+        paint.p_texture = &texture;
+        paint.area.width = texture.width;
+        paint.area.height = texture.height;
+        paint.wrap_u = ((p_pattern->repetition == GRAPHICS_REPEAT) || (p_pattern->repetition == GRAPHICS_REPEAT_X))
+                       ? Canvas2D_Raster::WRAP_REPEAT : Canvas2D_Raster::WRAP_NONE;
+        paint.wrap_v = ((p_pattern->repetition == GRAPHICS_REPEAT) || (p_pattern->repetition == GRAPHICS_REPEAT_Y))
+                       ? Canvas2D_Raster::WRAP_REPEAT : Canvas2D_Raster::WRAP_NONE;
+        paint.bilinear = !is_integer_translation(p_graphics->status.matrix);
+    }
+    fill_rect(p_graphics, (float)x, (float)y, (float)w, (float)h, &paint,
+              composite_mode[p_graphics->status.composite_operation], p_graphics->status.global_alpha);
+}
+
+Canvas2D_PatternClass Canvas2D_ContextClass::createPattern(const graphics_image_t * image, const char * repetition) {
+    Canvas2D_PatternClass  pattern;
+    repetition_t  rep;
+
+    if (image == NULL) {
+        return pattern;
+    }
+    if ((repetition == NULL) || (repetition[0] == '\0') || (strcmp(repetition, "repeat") == 0)) {
+        rep = GRAPHICS_REPEAT;
+    } else if (strcmp(repetition, "repeat-x") == 0) {
+        rep = GRAPHICS_REPEAT_X;
+    } else if (strcmp(repetition, "repeat-y") == 0) {
+        rep = GRAPHICS_REPEAT_Y;
+    } else if (strcmp(repetition, "no-repeat") == 0) {
+        rep = GRAPHICS_NO_REPEAT;
+    } else {
+        return pattern;
+    }
+    pattern.Entity = new graphics_pattern_t;
+    if (pattern.Entity == NULL) {
+        return pattern;
+    }
+    pattern.Entity->image = (graphics_image_t *)image;
+    pattern.Entity->repetition = rep;
+    return pattern;
+}
+
+void Canvas2D_ContextClass::beginPath() {
+    if (this->Entity == NULL) {
+        return;
+    }
+    this->Entity->C_Graphics->path_num = 0;
+}
+
+void Canvas2D_ContextClass::rect(int minX, int minY, int width, int height) {
+    graphics_t * p_graphics;
+    const float * p_m;
+    float xy[8];
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    int_fast32_t * p_path;
+    int i;
+
+    if ((this->Entity == NULL) || (this->Entity->C_Graphics->path_num >= CANVAS_2D_PATH_RECT_MAX)) {
+        return;
+    }
+    p_graphics = this->Entity->C_Graphics;
+    p_m = p_graphics->status.matrix;
+    transform_point(p_m, (float)minX, (float)minY, &xy[0], &xy[1]);
+    transform_point(p_m, (float)(minX + width), (float)minY, &xy[2], &xy[3]);
+    transform_point(p_m, (float)(minX + width), (float)(minY + height), &xy[4], &xy[5]);
+    transform_point(p_m, (float)minX, (float)(minY + height), &xy[6], &xy[7]);
+    x0 = xy[0];
+    y0 = xy[1];
+    x1 = xy[0];
+    y1 = xy[1];
+    for (i = 1; i < 4; i++) {
+        x0 = (xy[i * 2] < x0) ? xy[i * 2] : x0;
+        x1 = (xy[i * 2] > x1) ? xy[i * 2] : x1;
+        y0 = (xy[(i * 2) + 1] < y0) ? xy[(i * 2) + 1] : y0;
+        y1 = (xy[(i * 2) + 1] > y1) ? xy[(i * 2) + 1] : y1;
+    }
+    p_path = p_graphics->path[p_graphics->path_num];
+    p_path[0] = (int_fast32_t)floorf(x0 + 0.5f);
+    p_path[1] = (int_fast32_t)floorf(y0 + 0.5f);
+    p_path[2] = (int_fast32_t)floorf(x1 + 0.5f);
+    p_path[3] = (int_fast32_t)floorf(y1 + 0.5f);
+    p_graphics->path_num++;
+}
+
+void Canvas2D_ContextClass::clip() {
+    graphics_t * p_graphics;
+    graphics_status_t * p_status;
+    int_fast32_t x0 = 0;
+    int_fast32_t y0 = 0;
+    int_fast32_t x1 = 0;
+    int_fast32_t y1 = 0;
+    int_fast32_t i;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    p_graphics = this->Entity->C_Graphics;
+    p_status = &p_graphics->status;
+    for (i = 0; i < p_graphics->path_num; i++) {
+        const int_fast32_t * p_path = p_graphics->path[i];
+
+        if ((p_path[0] >= p_path[2]) || (p_path[1] >= p_path[3])) {
+            continue;
+        }
+        if (x0 >= x1) {
+            x0 = p_path[0];
+            y0 = p_path[1];
+            x1 = p_path[2];
+            y1 = p_path[3];
+        } else {
+            x0 = (p_path[0] < x0) ? p_path[0] : x0;
+            y0 = (p_path[1] < y0) ? p_path[1] : y0;
+            x1 = (p_path[2] > x1) ? p_path[2] : x1;
+            y1 = (p_path[3] > y1) ? p_path[3] : y1;
+        }
+    }
+    p_status->clip_x0 = (x0 > p_status->clip_x0) ? x0 : p_status->clip_x0;
+    p_status->clip_y0 = (y0 > p_status->clip_y0) ? y0 : p_status->clip_y0;
+    p_status->clip_x1 = (x1 < p_status->clip_x1) ? x1 : p_status->clip_x1;
+    p_status->clip_y1 = (y1 < p_status->clip_y1) ? y1 : p_status->clip_y1;
+    if ((p_status->clip_x0 >= p_status->clip_x1) || (p_status->clip_y0 >= p_status->clip_y1)) {
+        p_status->clip_x1 = p_status->clip_x0;
+        p_status->clip_y1 = p_status->clip_y0;
+    }
+}
+
+void Canvas2D_ContextClass::setTransform(graphics_matrix_float_t sx, graphics_matrix_float_t ky,
+                                         graphics_matrix_float_t kx, graphics_matrix_float_t sy,
+                                         graphics_matrix_float_t tx, graphics_matrix_float_t ty) {
+    float * p_m;
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    p_m = this->Entity->C_Graphics->status.matrix;
+    p_m[0] = sx;
+    p_m[1] = ky;
+    p_m[2] = kx;
+    p_m[3] = sy;
+    p_m[4] = tx;
+    p_m[5] = ty;
+}
+
+void Canvas2D_ContextClass::translate(graphics_matrix_float_t tx, graphics_matrix_float_t ty) {
+    transform(1.0f, 0.0f, 0.0f, 1.0f, tx, ty);
+}
+
+void Canvas2D_ContextClass::scale(graphics_matrix_float_t sx, graphics_matrix_float_t sy) {
+    transform(sx, 0.0f, 0.0f, sy, 0.0f, 0.0f);
+}
+
+void Canvas2D_ContextClass::rotate(graphics_matrix_float_t angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+
+    transform(c, s, -s, c, 0.0f, 0.0f);
+}
+
+void Canvas2D_ContextClass::transform(graphics_matrix_float_t sx, graphics_matrix_float_t ky,
+                                      graphics_matrix_float_t kx, graphics_matrix_float_t sy,
+                                      graphics_matrix_float_t tx, graphics_matrix_float_t ty) {
+    float m[6] = {sx, ky, kx, sy, tx, ty};
+
+    if (this->Entity == NULL) {
+        return;
+    }
+    multiply(this->Entity->C_Graphics->status.matrix, m, this->Entity->C_Graphics->status.matrix);
+}
+
+void Canvas2D_ContextClass::Set_fillStyle(const char * Color) {
+    uint32_t colour;
+
+    if ((this->Entity == NULL) || !parse_colour(Color, &colour)) {
+        return;
+    }
+    this->Entity->C_Graphics->status.fill_colour = colour;
+    this->Entity->C_Graphics->status.fill_pattern = NULL;
+}
+
+void Canvas2D_ContextClass::Set_fillStyle(r8g8b8a8_t Color) {
+    if (this->Entity == NULL) {
+        return;
+    }
+    this->Entity->C_Graphics->status.fill_colour = ((uint32_t)Color.u.Alpha << 24) | ((uint32_t)Color.u.Red << 16)
+                                                   | ((uint32_t)Color.u.Green << 8) | (uint32_t)Color.u.Blue;
+    this->Entity->C_Graphics->status.fill_pattern = NULL;
+}
+
+void Canvas2D_ContextClass::Set_fillStylePattern(const Canvas2D_PatternClass Pattern) {
+    if ((this->Entity == NULL) || (Pattern.Entity == NULL)) {
+        return;
+    }
+    this->Entity->C_Graphics->status.fill_pattern = Pattern.Entity;
+}
+
+void Canvas2D_ContextClass::set_globalAlpha(const float alpha) {
+    if ((this->Entity == NULL) || !(alpha >= 0.0f) || !(alpha <= 1.0f)) {
+        return;
+    }
+    this->Entity->C_Graphics->status.global_alpha = (uint8_t)((alpha * 255.0f) + 0.5f);
+}
+
+float Canvas2D_ContextClass::get_globalAlpha() {
+    if (this->Entity == NULL) {
+        return 1.0f;
+    }
+    return (float)this->Entity->C_Graphics->status.global_alpha / 255.0f;
+}
+
+void Canvas2D_ContextClass::set_globalCompositeOperation(const char * operation) {
+    size_t i;
+
+    if ((this->Entity == NULL) || (operation == NULL)) {
+        return;
+    }
+    for (i = 0; i < (sizeof(composite_name) / sizeof(composite_name[0])); i++) {
+        if (strcmp(operation, composite_name[i]) == 0) {
+            this->Entity->C_Graphics->status.composite_operation = (graphics_composite_operation_t)i;
+            return;
+        }
+    }
+}
+
+char * Canvas2D_ContextClass::get_globalCompositeOperation() {
+    if (this->Entity == NULL) {
+        return (char *)composite_name[GRAPHICS_SOURCE_OVER];
+    }
+    return (char *)composite_name[this->Entity->C_Graphics->status.composite_operation];
+}
+
+
+/***********************************************************************
+* Functions: Canvas2D_Constructers
+************************************************************************/
+
+Canvas2D_ContextClass R_RGA_New_Canvas2D_ContextClass(frame_buffer_t * frame_buffer) {
+    Canvas2D_ContextConfigClass  config;
+
+    config.frame_buffer = frame_buffer;
+    return R_RGA_New_Canvas2D_ContextClass(config);
+}
+
+Canvas2D_ContextClass R_RGA_New_Canvas2D_ContextClass(Canvas2D_ContextConfigClass & in_out_Config) {
+    Canvas2D_ContextClass  context;
+    Pixel2D::surface_t surface;
+    graphics_t * p_graphics;
+    graphics_status_t * p_status;
+
+    if (!get_surface(in_out_Config.frame_buffer, &surface)) {
+        return context;
+    }
+    context.Entity = new Canvas2D_ContextEntityClass();
+    if (context.Entity == NULL) {
+        return context;
+    }
+    p_graphics = new graphics_t;
+    if (p_graphics == NULL) {
+        context.destroy();
+        return context;
+    }
+    memset(p_graphics, 0, sizeof(graphics_t));
+    context.Entity->C_Graphics = p_graphics;
+    p_graphics->frame_buffer = in_out_Config.frame_buffer;
+    p_graphics->work_width = surface.width;
+    p_graphics->p_area = new uint16_t[surface.width + 2];
+    p_graphics->p_cover = new int16_t[surface.width + 2];
+    if ((p_graphics->p_area == NULL) || (p_graphics->p_cover == NULL)) {
+        context.destroy();
+        return context;
+    }
+
+    p_status = &p_graphics->status;
+    p_status->matrix[0] = 1.0f;
+    p_status->matrix[3] = 1.0f;
+    p_status->fill_colour = 0xFF000000;
+    p_status->fill_pattern = NULL;
+    p_status->global_alpha = 255;
+    p_status->composite_operation = GRAPHICS_SOURCE_OVER;
+    p_status->clip_x0 = 0;
+    p_status->clip_y0 = 0;
+    p_status->clip_x1 = surface.width;
+    p_status->clip_y1 = surface.height;
+    return context;
+}
+
+Canvas2D_ImageClass R_RGA_New_Canvas2D_ImageClass() {
+    Canvas2D_ImageClass  image;
+
+    image.Entity = new Canvas2D_ImageEntityClass(false);
+    return image;
+}
+
+#endif
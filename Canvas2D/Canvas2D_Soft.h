@@ -0,0 +1,664 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Canvas2D_Soft.h
+* @brief         Software implementation of Canvas2D_ContextClass of RGA_Cpp.h
+*
+* The classes and the functions have the same names and arguments as RGA_Cpp.h,
+* so the UI code written for the RGA can be built for the targets without the RGA. Include Canvas2D.h.
+*
+* - The shapes (rectangles transformed by the matrix) are drawn by an anti-aliased scanline rasterizer.
+*   The coverage of a pixel is calculated with 4 sub-scanlines and the exact horizontal area.
+* - The images and the patterns are sampled with a 16.16 fixed-point affine mapping.
+*   Bilinear filtering is used, except when the image is drawn at the same size at integer coordinates.
+* - The fully covered spans are filled and blended by Pixel2D (NEON when __ARM_NEON is defined).
+*   A rectangle or an image at integer coordinates is drawn by Pixel2D::Fill() / Pixel2D::Blend() directly.
+*
+* The frame buffer formats are PIXEL_FORMAT_RGB565, ARGB8888, XRGB8888, ARGB4444 and YUV422.
+* The image formats (graphics_image_t::type) are PIXEL_FORMAT_R8G8B8A8, ARGB8888, XRGB8888, RGB565
+* (with an optional A8 plane at offset_to_alpha), ARGB4444 and A8.
+* The clipping region is the bounding box (in the frame buffer) of the rectangles of the path.
+* Invalid calls are ignored.
+* The library does not depend on mbed.
+******************************************************************************/
+
+#ifndef CANVAS_2D_SOFT_H
+#define CANVAS_2D_SOFT_H
+
+#ifndef __cplusplus
+#error C++ only
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Maximum number of rectangles of a path */
+#ifndef CANVAS_2D_PATH_RECT_MAX
+#define CANVAS_2D_PATH_RECT_MAX     (8)
+#endif
+
+
+/***********************************************************************
+* Types of RGA_API_typedef.h, frame_buffer_typedef.h and RGA_raw_image_typedef.h
+************************************************************************/
+
+enum _pixel_format_t {
+    PIXEL_FORMAT_UNKNOWN  =  0,
+    PIXEL_FORMAT_ARGB8888 =  1,
+    PIXEL_FORMAT_RGB565   =  3,
+    PIXEL_FORMAT_ARGB4444 =  5,
+    PIXEL_FORMAT_A8       = 11,
+    PIXEL_FORMAT_A4       = 14,
+    PIXEL_FORMAT_A1       = 13,
+    PIXEL_FORMAT_RGB888   = 15,
+    PIXEL_FORMAT_R8G8B8A8 =  6 | (1 << 4),
+    PIXEL_FORMAT_XRGB8888 =  0 | (1 << 6),
+    PIXEL_FORMAT_ARGB1555 =  4 | (1 << 6),
+    PIXEL_FORMAT_YCbCr422 =  2 | (1 << 16),
+    PIXEL_FORMAT_YUV422   =  2 | (1 << 16),
+    PIXEL_FORMAT_YUV422_GRAY_SCALE_IS_0x80  = 2 | (1 << 16),
+    PIXEL_FORMAT_JPEG     = 12 | (2 << 8),
+    PIXEL_FORMAT_PNG      = 12 | (3 << 8),
+    PIXEL_FORMAT_GIF      = 12 | (4 << 8),
+    PIXEL_FORMAT_CLUT1    = 12 | (1 << 12),
+    PIXEL_FORMAT_CLUT4    = 12 | (4 << 12),
+    PIXEL_FORMAT_CLUT8    = 12 | (8 << 12)
+};
+typedef enum _pixel_format_t  pixel_format_t;
+
+typedef int   byte_per_pixel_t;
+typedef void  frame_buffer_delegate_t;
+enum { /* int_fast32_t */  frame_buffer_t_max_buffer_count = 4 };
+
+/*! @struct frame_buffer_t
+    @brief Frame buffer to draw (buffer_address[draw_buffer_index] is drawn)
+ */
+typedef struct st_frame_buffer_t  frame_buffer_t;
+struct st_frame_buffer_t {
+    uint8_t          *buffer_address[ frame_buffer_t_max_buffer_count ];
+    int_fast32_t      buffer_count;
+    int_fast32_t      show_buffer_index;
+    int_fast32_t      draw_buffer_index;
+    int_fast32_t      width;
+    byte_per_pixel_t  byte_per_pixel;
+    int_fast32_t      stride;
+    int_fast32_t      height;
+    pixel_format_t    pixel_format;
+    frame_buffer_delegate_t  *delegate;
+};
+
+/*! @union r8g8b8a8_t
+    @brief Colour (little-endian)
+ */
+#define  r8g8b8a8_t  r8g8b8a8_t
+typedef union st_r8g8b8a8_t  r8g8b8a8_t;
+union st_r8g8b8a8_t {
+    struct {
+        uint8_t  Red;
+        uint8_t  Green;
+        uint8_t  Blue;
+        uint8_t  Alpha;
+    } u;
+    uint32_t  Value;
+};
+
+/*! @struct graphics_image_t
+    @brief Raw image
+ *
+ * type is the pixel format (pixel_format_t). offset_to_image and offset_to_alpha are the offsets
+ * from the header (F_T_IMAGE_INF_RAW_OFFSET) or the addresses (F_T_IMAGE_INF_RAW_ADDRESS).
+ * The stride is color (F_T_IMAGE_INF_LINE_OFFSET) or width * byte per pixel.
+ */
+typedef struct st_graphics_image_t  graphics_image_t;
+struct st_graphics_image_t {
+    uint32_t    flags;
+    uintptr_t   offset_to_image;
+    uintptr_t   offset_to_alpha;
+    uint16_t    width;
+    uint16_t    height;
+    uint8_t     type;
+    uint8_t     type2;
+    uint32_t    color;
+};
+
+enum { /* graphics_image_t::flags */
+    F_T_IMAGE_INF_RAW_MASK    = 0x01,
+    F_T_IMAGE_INF_RAW_ADDRESS = 0x00,
+    F_T_IMAGE_INF_RAW_OFFSET  = 0x01,
+    F_T_IMAGE_INF_PREMULTIPLIED_ALPHA  = 0x04,
+    F_T_IMAGE_INF_LINE_OFFSET = 0x08,
+    F_T_IMAGE_INF_USED_MASK = 0x0000000F
+};
+
+typedef struct _GraphicsImagePropertiesClass  graphics_image_properties_t;
+struct _GraphicsImagePropertiesClass {
+    int_fast32_t     width;
+    int_fast32_t     height;
+    uint8_t         *data;    /* NULL, if pixelFormat != PIXEL_FORMAT_R8G8B8A8 */
+    void            *pixels;  /* Same as "data" but not NULL */
+    pixel_format_t   pixelFormat;
+    uint32_t        *CLUT;
+    int_fast32_t     CLUT_count;
+};
+
+typedef enum st_repetition_t {
+    GRAPHICS_REPEAT = 1,
+    GRAPHICS_REPEAT_X = 2,
+    GRAPHICS_REPEAT_Y = 3,
+    GRAPHICS_NO_REPEAT = 4
+} repetition_t;
+
+typedef struct st_graphics_pattern_t  graphics_pattern_t;
+struct st_graphics_pattern_t {
+    graphics_image_t *image;
+    repetition_t      repetition;
+};
+
+typedef enum st_graphics_composite_operation_t {
+    GRAPHICS_COPY = 0,
+    GRAPHICS_SOURCE_OVER = 1,
+    GRAPHICS_SOURCE_IN = 2,
+    GRAPHICS_SOURCE_OUT = 3,
+    GRAPHICS_SOURCE_ATOP = 4,
+    GRAPHICS_DESTINATION_OVER = 5,
+    GRAPHICS_DESTINATION_IN = 6,
+    GRAPHICS_DESTINATION_OUT = 7,
+    GRAPHICS_DESTINATION_ATOP = 8,
+    GRAPHICS_XOR = 9
+} graphics_composite_operation_t;
+
+typedef float  graphics_matrix_float_t;
+typedef double graphics_matrix_other_float_t;
+
+/*! @struct graphics_status_t
+    @brief Drawing state saved by save()
+ */
+typedef struct st_graphics_status_t  graphics_status_t;
+struct st_graphics_status_t {
+    graphics_matrix_float_t         matrix[6];      /* { sx, ky, kx, sy, tx, ty } */
+    uint32_t                        fill_colour;    /* ARGB8888 */
+    graphics_pattern_t             *fill_pattern;   /* NULL = fill_colour */
+    uint8_t                         global_alpha;
+    graphics_composite_operation_t  composite_operation;
+    int_fast32_t                    clip_x0;        /* Clipping region in the frame buffer */
+    int_fast32_t                    clip_y0;
+    int_fast32_t                    clip_x1;        /* Exclusive */
+    int_fast32_t                    clip_y1;        /* Exclusive */
+};
+
+/*! @struct graphics_t
+    @brief Software graphics context
+ */
+typedef struct st_graphics_t  graphics_t;
+struct st_graphics_t {
+    frame_buffer_t     *frame_buffer;
+    graphics_status_t   status;
+    int_fast32_t        path_num;
+    int_fast32_t        path[CANVAS_2D_PATH_RECT_MAX][4];   /* { x0, y0, x1, y1 } in the frame buffer */
+    uint16_t           *p_area;                             /* Work of the rasterizer */
+    int16_t            *p_cover;                            /* Work of the rasterizer */
+    int_fast32_t        work_width;
+};
+
+
+/***********************************************************************
+* Functions of RGA_API.h for the images
+************************************************************************/
+
+int  R_GRAPHICS_IMAGE_InitR8G8B8A8(
+    graphics_image_t *self, void *ImageDataArray, size_t ImageDataArraySize,
+    int_fast32_t width, int_fast32_t height );
+int  R_GRAPHICS_IMAGE_InitSameSizeR8G8B8A8(
+    graphics_image_t *self, void *ImageDataArray, size_t ImageDataArraySize,
+    graphics_image_t *SameSizeImage );
+int  R_GRAPHICS_IMAGE_InitByShareFrameBuffer( graphics_image_t *self, frame_buffer_t *frame_buffer );
+int  R_GRAPHICS_IMAGE_GetProperties( const graphics_image_t *self, graphics_image_properties_t *out_Properties );
+int  R_GRAPHICS_IMAGE_GetImageFormat( const graphics_image_t *self, pixel_format_t *out_Format );
+
+
+/***********************************************************************
+* Class: ObjectHandleClass
+************************************************************************/
+class  ObjectHandleClass
+{
+public:
+    void  *Entity;
+
+    ObjectHandleClass() {
+        this->Entity = NULL;
+    }
+};
+
+bool  operator == ( ObjectHandleClass Left, ObjectHandleClass Right );
+
+
+/** undefined */
+#define  undefined  get_undefined()
+extern ObjectHandleClass  get_undefined();
+
+
+/***********************************************************************
+* Class: saveList_st
+************************************************************************/
+struct saveList_st {
+    saveList_st       *beforePoint;
+    graphics_status_t  saveData;
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_ImageEntityClass
+************************************************************************/
+class Canvas2D_ImageEntityClass
+{
+public:
+    graphics_image_t  *C_Image;
+    bool               isImageDataComposition;  /* true = C_Image is allocated by the context */
+
+    Canvas2D_ImageEntityClass( bool composition ) {
+        this->C_Image = NULL;
+        this->isImageDataComposition = composition;
+    }
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_ImageClass
+************************************************************************/
+class  Canvas2D_ImageClass
+{
+public:
+    Canvas2D_ImageEntityClass  *Entity;
+
+    Canvas2D_ImageClass() {
+        this->Entity = NULL;
+    }
+
+    operator ObjectHandleClass () {
+        return  *(ObjectHandleClass *) this;
+    }
+
+    Canvas2D_ImageClass &operator = ( ObjectHandleClass Right ) {
+        this->Entity = (Canvas2D_ImageEntityClass *) Right.Entity;
+        return  *this;
+    }
+
+
+    void  set_imageClass( graphics_image_t *imageClass );
+    inline void  operator= ( graphics_image_t *imageClass ) {
+        this->set_imageClass( imageClass );
+    }
+
+    inline operator graphics_image_t *() {
+        return  this->Entity->C_Image;
+    }
+
+
+    void destroy();
+
+
+    /* "width" property */
+    class  widthProperty
+    {
+    public:
+        inline operator int() {
+            graphics_image_properties_t  prop;
+            Canvas2D_ImageClass  *parent = (Canvas2D_ImageClass *)(
+                                               (char *) this - offsetof( Canvas2D_ImageClass, width ) );
+            if ( (parent->Entity == NULL) || (R_GRAPHICS_IMAGE_GetProperties( parent->Entity->C_Image, &prop ) != 0) ) {
+                prop.width = 0;
+            }
+            return  prop.width;
+        }
+    } width;
+
+    /* "height" property */
+    class  heightProperty
+    {
+    public:
+        inline operator int() {
+            graphics_image_properties_t  prop;
+            Canvas2D_ImageClass  *parent = (Canvas2D_ImageClass *)(
+                                               (char *) this - offsetof( Canvas2D_ImageClass, height ) );
+            if ( (parent->Entity == NULL) || (R_GRAPHICS_IMAGE_GetProperties( parent->Entity->C_Image, &prop ) != 0) ) {
+                prop.height = 0;
+            }
+            return  prop.height;
+        }
+    } height;
+
+    /* "data" property (R, G, B, A bytes of each pixel) */
+    class  dataProperty
+    {
+    public:
+        inline operator uint8_t *() {
+            graphics_image_properties_t  prop;
+            Canvas2D_ImageClass  *parent = (Canvas2D_ImageClass *)(
+                                               (char *) this - offsetof( Canvas2D_ImageClass, data ) );
+            if ( (parent->Entity == NULL) || (R_GRAPHICS_IMAGE_GetProperties( parent->Entity->C_Image, &prop ) != 0) ) {
+                prop.data = NULL;
+            }
+            return  prop.data;
+        }
+
+        inline operator r8g8b8a8_t *() {
+            return  (r8g8b8a8_t *)(uint8_t *) *this;
+        }
+
+        inline operator void *() {
+            return  (void *)(uint8_t *) *this;
+        }
+
+        inline uint8_t  &operator[]( int Index ) {
+            return  ( (uint8_t *) *this )[ Index ];
+        }
+
+        inline uint8_t  *operator+( int Index ) {
+            return  ( (uint8_t *) *this ) + Index;
+        }
+    } data;
+
+    /* "src" property */
+    class  srcProperty
+    {
+    public:
+        inline void  operator= ( const graphics_image_t *imageClass ) {
+            Canvas2D_ImageClass  *parent = (Canvas2D_ImageClass *)(
+                                               (char *) this - offsetof( Canvas2D_ImageClass, src ) );
+
+            parent->set_imageClass( (graphics_image_t *)imageClass );
+        }
+        inline operator graphics_image_t *() {
+            graphics_image_t *outData = NULL;
+            Canvas2D_ImageClass  *parent = (Canvas2D_ImageClass *)(
+                                               (char *) this - offsetof( Canvas2D_ImageClass, src ) );
+
+            if( parent->Entity != NULL ) {
+                outData = parent->Entity->C_Image;
+            }
+            return outData;
+        }
+    } src;
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_PatternClass
+************************************************************************/
+class  Canvas2D_PatternClass
+{
+public:
+    graphics_pattern_t  *Entity;
+
+    Canvas2D_PatternClass() {
+        this->Entity = NULL;
+    }
+
+    operator ObjectHandleClass () {
+        return  *(ObjectHandleClass *) this;
+    }
+
+    Canvas2D_PatternClass &operator = ( ObjectHandleClass Right ) {
+        this->Entity = (graphics_pattern_t *) Right.Entity;
+        return  *this;
+    }
+
+    void destroy();
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_ContextEntityClass
+************************************************************************/
+class Canvas2D_ContextEntityClass
+{
+public:
+    graphics_t  *C_Graphics;
+    saveList_st    *LastSavePoint;
+
+    Canvas2D_ContextEntityClass() {
+        this->C_Graphics = NULL;
+        this->LastSavePoint = NULL;
+    }
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_ContextClass
+************************************************************************/
+class  Canvas2D_ContextClass
+{
+public:
+    Canvas2D_ContextEntityClass  *Entity;
+
+    Canvas2D_ContextClass() {
+        this->Entity = NULL;
+    }
+
+    operator ObjectHandleClass () {
+        return  *(ObjectHandleClass *) this;
+    }
+
+    Canvas2D_ContextClass &operator = ( ObjectHandleClass Right ) {
+        this->Entity = (Canvas2D_ContextEntityClass *) Right.Entity;
+        return  *this;
+    }
+
+    void  destroy();
+    void  clearRect( int x, int y, int w, int h );
+    void  save();
+    void  restore();
+    void  drawImage( const graphics_image_t *image, int minX, int minY );
+    void  drawImage( const graphics_image_t *image, int minX, int minY , int width, int height );
+    void  drawImage( const graphics_image_t *image, int srcMinX,  int srcMinY,  int srcWidth,   int srcHeight,
+                     int destMinx, int destMinY, int destWidth , int destHeight );
+    Canvas2D_ImageClass  createImageData( Canvas2D_ImageClass image );
+    Canvas2D_ImageClass  createImageData( int width, int height );
+    Canvas2D_ImageClass  getImageData( int minX, int minY, int width, int height );
+    void  putImageData( Canvas2D_ImageClass imageData, int minX, int minY );
+    void  putImageData ( Canvas2D_ImageClass imageData, int minX, int minY, int dirtyX, int dirtyY, int dirtyWidth, int dirtyHeight );
+    void  fillRect( int x, int y, int w, int h );
+    Canvas2D_PatternClass  createPattern( const graphics_image_t *image, const char *repetition );
+    void  beginPath();
+    void  rect( int minX, int minY, int width, int height );
+    void  clip();
+
+    void  setTransform( graphics_matrix_float_t sx,  graphics_matrix_float_t ky,
+                        graphics_matrix_float_t kx,  graphics_matrix_float_t sy,
+                        graphics_matrix_float_t tx,  graphics_matrix_float_t ty );
+    void  setTransform( graphics_matrix_other_float_t sx,  graphics_matrix_other_float_t ky,
+                        graphics_matrix_other_float_t kx,  graphics_matrix_other_float_t sy,
+                        graphics_matrix_other_float_t tx,  graphics_matrix_other_float_t ty ) {
+        setTransform( (graphics_matrix_float_t) sx,  (graphics_matrix_float_t) ky,
+                      (graphics_matrix_float_t) kx,  (graphics_matrix_float_t) sy,
+                      (graphics_matrix_float_t) tx,  (graphics_matrix_float_t) ty );
+    }
+    void  setTransform( int sx,  int ky, int kx,  int sy, int tx,  int ty ) {
+        setTransform( (graphics_matrix_float_t) sx,  (graphics_matrix_float_t) ky,
+                      (graphics_matrix_float_t) kx,  (graphics_matrix_float_t) sy,
+                      (graphics_matrix_float_t) tx,  (graphics_matrix_float_t) ty );
+    }
+
+    void  translate( graphics_matrix_float_t tx, graphics_matrix_float_t ty );
+    void  translate( graphics_matrix_other_float_t tx, graphics_matrix_other_float_t ty ) {
+        translate( (graphics_matrix_float_t) tx, (graphics_matrix_float_t) ty );
+    }
+    void  translate( graphics_matrix_float_t tx, graphics_matrix_other_float_t ty ) {
+        translate( tx, (graphics_matrix_float_t) ty );
+    }
+    void  translate( graphics_matrix_other_float_t tx, graphics_matrix_float_t ty ) {
+        translate( (graphics_matrix_float_t) tx, ty );
+    }
+    void  translate( int tx, int ty ) {
+        translate( (graphics_matrix_float_t) tx, (graphics_matrix_float_t) ty );
+    }
+
+    void  scale( graphics_matrix_float_t sx, graphics_matrix_float_t sy );
+    void  scale( graphics_matrix_other_float_t sx, graphics_matrix_other_float_t sy ) {
+        scale( (graphics_matrix_float_t) sx, (graphics_matrix_float_t) sy );
+    }
+    void  scale( graphics_matrix_float_t sx, graphics_matrix_other_float_t sy ) {
+        scale( sx, (graphics_matrix_float_t) sy );
+    }
+    void  scale( graphics_matrix_other_float_t sx, graphics_matrix_float_t sy ) {
+        scale( (graphics_matrix_float_t) sx, sy );
+    }
+    void  scale( int sx, int sy ) {
+        scale( (graphics_matrix_float_t) sx, (graphics_matrix_float_t) sy );
+    }
+
+    void  rotate( graphics_matrix_float_t angle );
+    void  rotate( graphics_matrix_other_float_t angle ) {
+        rotate( (graphics_matrix_float_t) angle );
+    }
+
+    void  transform( graphics_matrix_float_t sx,  graphics_matrix_float_t ky,
+                     graphics_matrix_float_t kx,  graphics_matrix_float_t sy,
+                     graphics_matrix_float_t tx,  graphics_matrix_float_t ty );
+    void  transform( graphics_matrix_other_float_t sx,  graphics_matrix_other_float_t ky,
+                     graphics_matrix_other_float_t kx,  graphics_matrix_other_float_t sy,
+                     graphics_matrix_other_float_t tx,  graphics_matrix_other_float_t ty ) {
+        transform( (graphics_matrix_float_t) sx,  (graphics_matrix_float_t) ky,
+                   (graphics_matrix_float_t) kx,  (graphics_matrix_float_t) sy,
+                   (graphics_matrix_float_t) tx,  (graphics_matrix_float_t) ty );
+    }
+    void  transform( int sx,  int ky,  int kx,  int sy,  int tx,  int ty ) {
+        transform( (graphics_matrix_float_t) sx,  (graphics_matrix_float_t) ky,
+                   (graphics_matrix_float_t) kx,  (graphics_matrix_float_t) sy,
+                   (graphics_matrix_float_t) tx,  (graphics_matrix_float_t) ty );
+    }
+
+
+    /* "fillStyle" property */
+    void  Set_fillStyle( const char *Color );
+    void  Set_fillStyle( r8g8b8a8_t Color );
+    void  Set_fillStylePattern( const Canvas2D_PatternClass Pattern );
+    class  fillStyleProperty
+    {
+    public:
+        inline void  operator= ( const char *Color ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, fillStyle ) );
+
+            parent->Set_fillStyle( Color );
+        }
+        inline void  operator= ( r8g8b8a8_t Color ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, fillStyle ) );
+
+            parent->Set_fillStyle( Color );
+        }
+        inline void  operator= ( const Canvas2D_PatternClass Pattern ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, fillStyle ) );
+
+            parent->Set_fillStylePattern( Pattern );
+        }
+    } fillStyle;
+
+
+    /* "c_LanguageContext" property */
+    class  c_LanguageContextProperty
+    {
+        inline graphics_t  *get_c_LanguageContext() {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, c_LanguageContext ) );
+
+            return  parent->Entity->C_Graphics;
+        }
+    public:
+
+        inline operator graphics_t *() {
+            return  get_c_LanguageContext();
+        }
+        inline graphics_t *operator->() {
+            return  get_c_LanguageContext();
+        }
+    } c_LanguageContext;
+
+
+    /* "globalAlpha" property */
+    void set_globalAlpha( const float alpha );
+    float get_globalAlpha();
+    class  globalAlphaProperty
+    {
+    public:
+        inline void  operator= ( const float alpha ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, globalAlpha ) );
+
+            parent->set_globalAlpha( alpha );
+        }
+        inline void  operator= ( const double alpha ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, globalAlpha ) );
+
+            parent->set_globalAlpha( (float) alpha );
+        }
+        inline operator float() {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, globalAlpha ) );
+
+            return parent->get_globalAlpha();
+        }
+    } globalAlpha;
+
+
+    /* "globalCompositeOperation" property */
+    void set_globalCompositeOperation( const char *operation );
+    char *get_globalCompositeOperation();
+    class  globalCompositeOperationProperty
+    {
+    public:
+        inline void  operator= ( const char *operation ) {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, globalCompositeOperation ) );
+
+            parent->set_globalCompositeOperation( operation );
+        }
+        inline operator char *() {
+            Canvas2D_ContextClass  *parent = (Canvas2D_ContextClass *)(
+                                                 (char *) this - offsetof( Canvas2D_ContextClass, globalCompositeOperation ) );
+
+            return parent->get_globalCompositeOperation();
+        }
+    } globalCompositeOperation;
+
+};
+
+
+/***********************************************************************
+* Class: Canvas2D_ContextConfigClass
+************************************************************************/
+struct  Canvas2D_ContextConfigClass {
+    frame_buffer_t  *frame_buffer;
+    bool             is_fast_manual_flush;  /* Not used by the software implementation */
+
+    Canvas2D_ContextConfigClass() {
+        frame_buffer = NULL;
+        is_fast_manual_flush = false;
+    }
+};
+
+
+/***********************************************************************
+* Functions: Canvas2D_Constructers
+************************************************************************/
+Canvas2D_ContextClass  R_RGA_New_Canvas2D_ContextClass( frame_buffer_t *frame_buffer );
+Canvas2D_ContextClass  R_RGA_New_Canvas2D_ContextClass( Canvas2D_ContextConfigClass &in_out_Config );
+Canvas2D_ImageClass  R_RGA_New_Canvas2D_ImageClass();
+
+#endif
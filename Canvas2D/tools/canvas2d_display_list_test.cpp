@@ -0,0 +1,271 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          canvas2d_display_list_test.cpp
+* @brief         Check of Canvas2D_DisplayList::Replay against the immediate drawing on a Linux host
+*
+* Each scene sets a state of the caller (transform, fillStyle, globalAlpha, globalCompositeOperation,
+* clipping region) on two Canvas2D_Soft contexts. The scene is recorded with the first context as the
+* immediate context, and the list is replayed onto the second one. Then both contexts draw one more
+* rectangle with the state of the caller, which must not be changed by Replay().
+* The two frame buffers must be equal byte for byte, and the number of merged calls of the scene
+* is checked.
+*
+* Build (from Canvas2D/):
+*   g++ -O2 -I. -I../Pixel2D -o canvas2d_display_list_test tools/canvas2d_display_list_test.cpp
+*       Canvas2D_DisplayList.cpp Canvas2D_Soft.cpp Canvas2D_Raster.cpp ../Pixel2D/Pixel2D.cpp
+*
+* The exit status is 1 if a scene fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Canvas2D_DisplayList.h"
+
+#define CANVAS_W        (64)
+#define CANVAS_H        (48)
+#define IMAGE_W         (16)
+#define IMAGE_H         (12)
+
+typedef void (*scene_func_t)(Canvas2D_DisplayList & list);
+typedef void (*caller_func_t)(Canvas2D_ContextClass & ctx);
+
+typedef struct {
+    const char *    name;
+    caller_func_t   caller;
+    scene_func_t    func;
+    uint32_t        merged;             /* Expected number of the merged calls */
+} scene_desc_t;
+
+static uint32_t image_argb[IMAGE_W * IMAGE_H];
+static graphics_image_t image;
+
+/***********************************************************************
+* State of the caller
+************************************************************************/
+
+static void caller_default(Canvas2D_ContextClass & ctx) {
+    (void)ctx;
+}
+
+static void caller_translate(Canvas2D_ContextClass & ctx) {
+    ctx.translate(7, 3);
+    ctx.fillStyle = "rgba(255,0,0,0.8)";
+}
+
+static void caller_all(Canvas2D_ContextClass & ctx) {
+    ctx.beginPath();
+    ctx.rect(4, 4, 50, 36);
+    ctx.clip();
+    ctx.scale(1.5f, 1.25f);
+    ctx.fillStyle = "#20c040";
+    ctx.globalAlpha = 0.5f;
+    ctx.globalCompositeOperation = "copy";
+}
+
+/***********************************************************************
+* Scenes
+************************************************************************/
+
+/* Drawing calls only: everything comes from the caller */
+static void scene_inherit(Canvas2D_DisplayList & list) {
+    list.fillRect(2, 2, 10, 8);
+    list.fillRect(12, 2, 10, 8);
+    list.drawImage(&image, 30, 20);
+}
+
+/* Relative transforms without setTransform() */
+static void scene_relative(Canvas2D_DisplayList & list) {
+    list.translate(5, 4);
+    list.fillRect(0, 0, 8, 8);
+    list.save();
+    list.rotate(0.4f);
+    list.scale(1.2f, 0.8f);
+    list.set_fillStyle("navy");
+    list.fillRect(4, 2, 12, 10);
+    list.restore();
+    list.translate(10, 10);
+    list.fillRect(0, 0, 6, 6);
+}
+
+/* Fill set by the list, state of the caller for the rest */
+static void scene_fill(Canvas2D_DisplayList & list) {
+    list.set_fillStyle("rgb(40,80,160)");
+    list.fillRect(0, 0, 20, 10);
+    list.set_globalAlpha(0.75f);
+    list.drawImage(&image, 0, 0, IMAGE_W, IMAGE_H, 24, 12, IMAGE_W, IMAGE_H);
+}
+
+/* Absolute transform: the tiles and the rectangles are merged */
+static void scene_absolute(Canvas2D_DisplayList & list) {
+    int i;
+
+    list.setTransform(1, 0, 0, 1, 3, 2);
+    list.set_fillStyle("#404040");
+    list.fillRect(0, 0, 16, 8);
+    list.fillRect(16, 0, 16, 8);
+    list.fillRect(0, 8, 32, 8);
+    for (i = 0; i < 4; i++) {
+        list.drawImage(&image, i * 4, 0, 4, IMAGE_H, 10 + (i * 4), 20, 4, IMAGE_H);
+    }
+    list.set_globalCompositeOperation("source-over");
+    list.set_globalAlpha(1.0f);
+    list.fillRect(40, 30, 8, 8);
+}
+
+/* save() / restore() between setTransform() and the relative transforms */
+static void scene_nested(Canvas2D_DisplayList & list) {
+    list.scale(0.5f, 0.5f);
+    list.save();
+    list.setTransform(1, 0, 0, 1, 0, 0);
+    list.set_fillStyle("white");
+    list.fillRect(1, 1, 6, 6);
+    list.restore();
+    list.fillRect(10, 10, 20, 20);
+    list.save();
+    list.set_fillStyle("yellow");
+    list.restore();
+    list.fillRect(40, 10, 20, 20);
+}
+
+static const scene_func_t scene_func_list[] = {
+    &scene_inherit, &scene_relative, &scene_fill, &scene_absolute, &scene_nested,
+};
+
+static const char * const scene_name_list[] = {
+    "inherit", "relative", "fill", "absolute", "nested",
+};
+
+static const uint32_t scene_merged_list[] = {
+    0, 0, 0, 5, 0,
+};
+
+static const caller_func_t caller_func_list[] = {
+    &caller_default, &caller_translate, &caller_all,
+};
+
+static const char * const caller_name_list[] = {
+    "default", "translate+fill", "clip+scale+alpha+copy",
+};
+
+/***********************************************************************
+* Test
+************************************************************************/
+
+static void make_image(void) {
+    int x;
+    int y;
+
+    for (y = 0; y < IMAGE_H; y++) {
+        for (x = 0; x < IMAGE_W; x++) {
+            image_argb[(y * IMAGE_W) + x] = 0xC0000000 | ((uint32_t)(x * 16) << 16) | ((uint32_t)(y * 21) << 8)
+                                            | (((x + y) & 1) ? 0xFF : 0x20);
+        }
+    }
+    (void)R_GRAPHICS_IMAGE_InitR8G8B8A8(&image, image_argb, sizeof(image_argb), IMAGE_W, IMAGE_H);
+    image.type = (uint8_t)PIXEL_FORMAT_ARGB8888;
+}
+
+static void init_frame(frame_buffer_t * p_frame, std::vector<uint32_t> & buf) {
+    int x;
+    int y;
+
+    for (y = 0; y < CANVAS_H; y++) {
+        for (x = 0; x < CANVAS_W; x++) {
+            buf[(y * CANVAS_W) + x] = 0xFF000000 | ((uint32_t)(x * 4) << 16) | ((uint32_t)(y * 5) << 8) | 0x60;
+        }
+    }
+    memset(p_frame, 0, sizeof(frame_buffer_t));
+    p_frame->buffer_address[0] = (uint8_t *)&buf[0];
+    p_frame->buffer_count = 1;
+    p_frame->width = CANVAS_W;
+    p_frame->height = CANVAS_H;
+    p_frame->byte_per_pixel = 4;
+    p_frame->stride = CANVAS_W * 4;
+    p_frame->pixel_format = PIXEL_FORMAT_ARGB8888;
+}
+
+static bool run_scene(int s, int c) {
+    static Canvas2D_DisplayList list;
+    std::vector<uint32_t> immediate_buf(CANVAS_W * CANVAS_H);
+    std::vector<uint32_t> replay_buf(CANVAS_W * CANVAS_H);
+    frame_buffer_t immediate_frame;
+    frame_buffer_t replay_frame;
+    Canvas2D_ContextClass immediate;
+    Canvas2D_ContextClass replay;
+    Canvas2D_DisplayList::stats_t stats;
+    bool recorded;
+    bool replayed;
+    int bad = 0;
+    int i;
+
+    init_frame(&immediate_frame, immediate_buf);
+    init_frame(&replay_frame, replay_buf);
+    immediate = R_RGA_New_Canvas2D_ContextClass(&immediate_frame);
+    replay = R_RGA_New_Canvas2D_ContextClass(&replay_frame);
+    caller_func_list[c](immediate);
+    caller_func_list[c](replay);
+
+    /* The recorded calls change the state of the immediate context, so it is restored here */
+    immediate.save();
+    list.BeginRecording(&immediate);
+    scene_func_list[s](list);
+    recorded = list.EndRecording();
+    immediate.restore();
+    replayed = list.Replay(replay);
+
+    /* Drawn with the state of the caller */
+    immediate.fillRect(20, 30, 14, 9);
+    replay.fillRect(20, 30, 14, 9);
+    immediate.destroy();
+    replay.destroy();
+
+    for (i = 0; i < (CANVAS_W * CANVAS_H); i++) {
+        if (immediate_buf[i] != replay_buf[i]) {
+            if (bad == 0) {
+                printf("    first error at (%d, %d): %08X, immediate %08X\n", i % CANVAS_W, i / CANVAS_W,
+                       replay_buf[i], immediate_buf[i]);
+            }
+            bad++;
+        }
+    }
+    list.GetStats(&stats);
+    printf("%-10s %-22s %2u commands, %u merged, %4d pixels differ  %s\n", scene_name_list[s], caller_name_list[c],
+           stats.commands, stats.merged, bad,
+           (recorded && replayed && (bad == 0) && (stats.merged == scene_merged_list[s])) ? "OK" : "NG");
+    return recorded && replayed && (bad == 0) && (stats.merged == scene_merged_list[s]);
+}
+
+int main(void) {
+    int total = 0;
+    int fail = 0;
+    size_t s;
+    size_t c;
+
+    make_image();
+    for (s = 0; s < (sizeof(scene_func_list) / sizeof(scene_func_list[0])); s++) {
+        for (c = 0; c < (sizeof(caller_func_list) / sizeof(caller_func_list[0])); c++) {
+            total++;
+            if (!run_scene((int)s, (int)c)) {
+                fail++;
+            }
+        }
+    }
+    printf("%d / %d cases passed\n", total - fail, total);
+    return (fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          canvas2d_soft_bench.cpp
+* @brief         Frames/s of Canvas2D_Soft on a Linux host
+*
+* Typical frames of a UI are drawn to a frame buffer of the LCD size, and frames/s is reported
+* for each frame and each frame buffer format. The numbers of the host are for comparing
+* changes of Canvas2D_Soft and Pixel2D, not for estimating the frame rate of the RZ/A.
+* Build for the target CPU (e.g. -mcpu=cortex-a9 -mfpu=neon) to measure the NEON kernels.
+*
+* Build (from Canvas2D/):
+*   g++ -O2 -I. -I../Pixel2D -o canvas2d_soft_bench tools/canvas2d_soft_bench.cpp
+*       Canvas2D_Soft.cpp Canvas2D_Raster.cpp ../Pixel2D/Pixel2D.cpp
+*
+* Usage:
+*   canvas2d_soft_bench [-n frames] [-s width height]
+*     -n  number of frames of each test (default 200)
+*     -s  frame buffer size (default 480 272)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "Canvas2D_Soft.h"
+
+#define ICON_SIZE       (48)
+#define PHOTO_W         (160)
+#define PHOTO_H         (120)
+
+static int lcd_w = 480;
+static int lcd_h = 272;
+
+static std::vector<uint8_t> icon_buf;
+static std::vector<uint8_t> photo_buf;
+static graphics_image_t icon;           /* R8G8B8A8 with alpha */
+static graphics_image_t icon_argb;      /* ARGB8888 (drawn by Pixel2D::Blend) */
+static graphics_image_t photo;          /* R8G8B8A8 opaque */
+static std::vector<uint32_t> icon_argb_buf;
+
+typedef void (*frame_func_t)(Canvas2D_ContextClass & ctx, int frame);
+
+/* Clear the screen */
+static void frame_clear(Canvas2D_ContextClass & ctx, int frame) {
+    (void)frame;
+    ctx.clearRect(0, 0, lcd_w, lcd_h);
+}
+
+/* Buttons and icons at integer coordinates */
+static void frame_ui(Canvas2D_ContextClass & ctx, int frame) {
+    int i;
+
+    ctx.fillStyle = "#202830";
+    ctx.fillRect(0, 0, lcd_w, lcd_h);
+    ctx.fillStyle = "#3070c0";
+    ctx.fillRect(0, 0, lcd_w, 32);
+    for (i = 0; i < 8; i++) {
+        int x = 16 + ((i % 4) * (lcd_w - 32) / 4);
+        int y = 48 + ((i / 4) * 96);
+
+        ctx.fillStyle = ((i == (frame % 8)) ? "#f0a000" : "#405060");
+        ctx.fillRect(x, y, ICON_SIZE + 32, ICON_SIZE + 32);
+        ctx.drawImage(&icon_argb, x + 16, y + 16);
+    }
+    ctx.fillStyle = "rgba(255,255,255,0.5)";
+    ctx.fillRect(0, lcd_h - 24, (frame * 4) % lcd_w, 24);
+}
+
+/* Anti-aliased rotated rectangles (a dial) */
+static void frame_dial(Canvas2D_ContextClass & ctx, int frame) {
+    int i;
+
+    ctx.fillStyle = "black";
+    ctx.fillRect(0, 0, lcd_w, lcd_h);
+    ctx.fillStyle = "rgba(0,200,255,0.8)";
+    for (i = 0; i < 24; i++) {
+        ctx.save();
+        ctx.translate((float)lcd_w / 2, (float)lcd_h / 2);
+        ctx.rotate((float)(i * 2 * M_PI / 24) + ((float)frame * 0.02f));
+        ctx.fillRect(lcd_h / 4, -3, lcd_h / 5, 6);
+        ctx.restore();
+    }
+}
+
+/* Icons moving at sub-pixel positions with alpha */
+static void frame_sprites(Canvas2D_ContextClass & ctx, int frame) {
+    int i;
+
+    ctx.fillStyle = "#102040";
+    ctx.fillRect(0, 0, lcd_w, lcd_h);
+    for (i = 0; i < 16; i++) {
+        float t = ((float)frame * 0.01f) + ((float)i * 0.4f);
+
+        ctx.save();
+        ctx.translate(((float)lcd_w / 2) + (cosf(t) * lcd_w * 0.35f), ((float)lcd_h / 2) + (sinf(t * 1.3f) * lcd_h * 0.35f));
+        ctx.drawImage(&icon, -ICON_SIZE / 2, -ICON_SIZE / 2);
+        ctx.restore();
+    }
+}
+
+/* A photo scaled to the screen and rotated */
+static void frame_photo(Canvas2D_ContextClass & ctx, int frame) {
+    ctx.fillStyle = "black";
+    ctx.fillRect(0, 0, lcd_w, lcd_h);
+    ctx.save();
+    ctx.translate((float)lcd_w / 2, (float)lcd_h / 2);
+    ctx.rotate((float)frame * 0.01f);
+    ctx.drawImage(&photo, -lcd_w / 3, -lcd_h / 3, (lcd_w * 2) / 3, (lcd_h * 2) / 3);
+    ctx.restore();
+}
+
+/* A repeated pattern scrolled at sub-pixel positions */
+static void frame_pattern(Canvas2D_ContextClass & ctx, int frame) {
+    Canvas2D_PatternClass pattern = ctx.createPattern(&icon, "repeat");
+
+    ctx.save();
+    ctx.translate((float)frame * 0.25f, 0.0f);
+    ctx.fillStyle = pattern;
+    ctx.fillRect(-(frame / 4), 0, lcd_w, lcd_h);
+    ctx.restore();
+    pattern.destroy();
+}
+
+typedef struct {
+    const char *    name;
+    frame_func_t    func;
+} frame_desc_t;
+
+static const frame_desc_t frame_list[] = {
+    {"clear",   &frame_clear},
+    {"ui",      &frame_ui},
+    {"dial",    &frame_dial},
+    {"sprites", &frame_sprites},
+    {"photo",   &frame_photo},
+    {"pattern", &frame_pattern},
+};
+
+typedef struct {
+    const char *    name;
+    pixel_format_t  format;
+    int             bpp;
+} format_desc_t;
+
+static const format_desc_t format_list[] = {
+    {"RGB565",   PIXEL_FORMAT_RGB565,   2},
+    {"ARGB8888", PIXEL_FORMAT_ARGB8888, 4},
+    {"ARGB4444", PIXEL_FORMAT_ARGB4444, 2},
+};
+
+static void make_images(void) {
+    int x;
+    int y;
+
+    icon_buf.resize(ICON_SIZE * ICON_SIZE * 4);
+    icon_argb_buf.resize(ICON_SIZE * ICON_SIZE);
+    for (y = 0; y < ICON_SIZE; y++) {
+        for (x = 0; x < ICON_SIZE; x++) {
+            uint8_t * p = &icon_buf[((y * ICON_SIZE) + x) * 4];
+            int dx = x - (ICON_SIZE / 2);
+            int dy = y - (ICON_SIZE / 2);
+            int d = (dx * dx) + (dy * dy);
+            int r = (ICON_SIZE / 2) * (ICON_SIZE / 2);
+
+            p[0] = (uint8_t)(x * 5);
+            p[1] = (uint8_t)(y * 5);
+            p[2] = 200;
+            p[3] = (uint8_t)((d < r) ? 255 - ((d * 255) / r / 2) : 0);
+            icon_argb_buf[(y * ICON_SIZE) + x] = ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        }
+    }
+    (void)R_GRAPHICS_IMAGE_InitR8G8B8A8(&icon, &icon_buf[0], icon_buf.size(), ICON_SIZE, ICON_SIZE);
+    icon_argb = icon;
+    icon_argb.offset_to_image = (uintptr_t)&icon_argb_buf[0];
+    icon_argb.type = (uint8_t)PIXEL_FORMAT_ARGB8888;
+
+    photo_buf.resize(PHOTO_W * PHOTO_H * 4);
+    for (y = 0; y < PHOTO_H; y++) {
+        for (x = 0; x < PHOTO_W; x++) {
+            uint8_t * p = &photo_buf[((y * PHOTO_W) + x) * 4];
+
+            p[0] = (uint8_t)((x * 255) / PHOTO_W);
+            p[1] = (uint8_t)((y * 255) / PHOTO_H);
+            p[2] = (uint8_t)((x ^ y) & 0xFF);
+            p[3] = 255;
+        }
+    }
+    (void)R_GRAPHICS_IMAGE_InitR8G8B8A8(&photo, &photo_buf[0], photo_buf.size(), PHOTO_W, PHOTO_H);
+}
+
+int main(int argc, char * argv[]) {
+    int frames = 200;
+    size_t f;
+    size_t i;
+    int n;
+
+    for (n = 1; n < argc; n++) {
+        if ((strcmp(argv[n], "-n") == 0) && ((n + 1) < argc)) {
+            frames = atoi(argv[++n]);
+        } else if ((strcmp(argv[n], "-s") == 0) && ((n + 2) < argc)) {
+            lcd_w = atoi(argv[++n]);
+            lcd_h = atoi(argv[++n]);
+        } else {
+            printf("usage: canvas2d_soft_bench [-n frames] [-s width height]\n");
+            return 2;
+        }
+    }
+    if ((frames <= 0) || (lcd_w <= 0) || (lcd_h <= 0)) {
+        return 2;
+    }
+
+    make_images();
+    printf("%dx%d, %d frames\n", lcd_w, lcd_h, frames);
+    printf("%-10s", "frame");
+    for (f = 0; f < (sizeof(format_list) / sizeof(format_list[0])); f++) {
+        printf(" %12s", format_list[f].name);
+    }
+    printf("   (frames/s)\n");
+
+    for (i = 0; i < (sizeof(frame_list) / sizeof(frame_list[0])); i++) {
+        printf("%-10s", frame_list[i].name);
+        for (f = 0; f < (sizeof(format_list) / sizeof(format_list[0])); f++) {
+            std::vector<uint8_t> buf((size_t)lcd_w * lcd_h * format_list[f].bpp);
+            frame_buffer_t frame;
+            Canvas2D_ContextClass ctx;
+            std::chrono::steady_clock::time_point start;
+            double sec;
+
+            memset(&frame, 0, sizeof(frame));
+            frame.buffer_address[0] = &buf[0];
+            frame.buffer_count = 1;
+            frame.width = lcd_w;
+            frame.height = lcd_h;
+            frame.byte_per_pixel = format_list[f].bpp;
+            frame.stride = lcd_w * format_list[f].bpp;
+            frame.pixel_format = format_list[f].format;
+            ctx = R_RGA_New_Canvas2D_ContextClass(&frame);
+
+            frame_list[i].func(ctx, 0);     /* Warm up */
+            start = std::chrono::steady_clock::now();
+            for (n = 0; n < frames; n++) {
+                frame_list[i].func(ctx, n);
+            }
+            sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf(" %12.1f", (double)frames / sec);
+            ctx.destroy();
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,747 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          canvas2d_soft_test.cpp
+* @brief         Pixel-diff test of Canvas2D_Soft on a Linux host
+*
+* Each scene is drawn by Canvas2D_Soft and by a floating-point reference renderer of the
+* documented model (4 sub-scanlines with the exact horizontal coverage, sampling at the pixel
+* centre, bilinear filtering of premultiplied texels, compositing in premultiplied colours).
+* The frame buffers are compared in premultiplied ARGB, and the scene fails if a channel
+* differs by more than the tolerance of the scene. Canvas2D_Soft does not depend on mbed,
+* so no mock is needed.
+*
+* Build (from Canvas2D/):
+*   g++ -O2 -I. -I../Pixel2D -o canvas2d_soft_test tools/canvas2d_soft_test.cpp
+*       Canvas2D_Soft.cpp Canvas2D_Raster.cpp ../Pixel2D/Pixel2D.cpp
+*
+* Usage:
+*   canvas2d_soft_test [-o dir]
+*     -o  write <scene>.ppm (Canvas2D_Soft | reference | difference x16) of each scene to dir
+*
+* The exit status is 1 if a scene fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "Canvas2D_Soft.h"
+
+#define CANVAS_W        (64)
+#define CANVAS_H        (48)
+#define IMAGE_W         (16)
+#define IMAGE_H         (12)
+#define SUB_NUM         (4)
+
+/* Premultiplied colour of the reference (0.0 - 1.0) */
+typedef struct {
+    double  r;
+    double  g;
+    double  b;
+    double  a;
+} colour_t;
+
+typedef enum {
+    OP_SOURCE_OVER,
+    OP_COPY,
+    OP_DESTINATION_OUT,
+} ref_op_t;
+
+typedef enum {
+    PAINT_COLOUR,
+    PAINT_IMAGE,                        /* drawImage(): clamped to the source rectangle */
+    PAINT_PATTERN_REPEAT,
+    PAINT_PATTERN_NO_REPEAT,
+} paint_type_t;
+
+/* Reference of the drawing state and the paint */
+typedef struct {
+    double          m[6];
+    uint32_t        colour;
+    uint8_t         global_alpha;
+    ref_op_t        op;
+    int             clip[4];            /* x0, y0, x1, y1 */
+    paint_type_t    paint;
+    double          inv[6];             /* Frame buffer to texture */
+    int             area[4];            /* x, y, width, height of the texture */
+    bool            bilinear;
+} ref_state_t;
+
+static uint8_t image_rgba[IMAGE_W * IMAGE_H * 4];
+static uint32_t image_argb[IMAGE_W * IMAGE_H];
+static graphics_image_t image_r8g8b8a8;
+static graphics_image_t image_argb8888;
+
+static const char * out_dir = NULL;
+
+
+/***********************************************************************
+* Colours
+************************************************************************/
+
+static colour_t from_argb(uint32_t c) {
+    colour_t col;
+
+    col.a = (double)(c >> 24) / 255.0;
+    col.r = ((double)((c >> 16) & 0xFF) / 255.0) * col.a;
+    col.g = ((double)((c >> 8) & 0xFF) / 255.0) * col.a;
+    col.b = ((double)(c & 0xFF) / 255.0) * col.a;
+    return col;
+}
+
+static colour_t scale(colour_t c, double k) {
+    c.r *= k;
+    c.g *= k;
+    c.b *= k;
+    c.a *= k;
+    return c;
+}
+
+static colour_t add(colour_t a, colour_t b) {
+    a.r += b.r;
+    a.g += b.g;
+    a.b += b.b;
+    a.a += b.a;
+    return a;
+}
+
+/* Premultiplied 8-bit channels of a pixel of the frame buffer */
+static void premultiplied8(uint32_t c, int * p_ch) {
+    int a = (int)(c >> 24);
+
+    p_ch[0] = a;
+    p_ch[1] = (int)((((c >> 16) & 0xFF) * a + 127) / 255);
+    p_ch[2] = (int)((((c >> 8) & 0xFF) * a + 127) / 255);
+    p_ch[3] = (int)(((c & 0xFF) * a + 127) / 255);
+}
+
+static void premultiplied8(colour_t c, int * p_ch) {
+    p_ch[0] = (int)floor((c.a * 255.0) + 0.5);
+    p_ch[1] = (int)floor((c.r * 255.0) + 0.5);
+    p_ch[2] = (int)floor((c.g * 255.0) + 0.5);
+    p_ch[3] = (int)floor((c.b * 255.0) + 0.5);
+}
+
+static uint32_t rgb565_to_argb(uint16_t v) {
+    uint32_t r = (v >> 11) & 0x1F;
+    uint32_t g = (v >> 5) & 0x3F;
+    uint32_t b = v & 0x1F;
+
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+
+/***********************************************************************
+* Reference renderer
+************************************************************************/
+
+static void ref_init(ref_state_t * p_state) {
+    memset(p_state, 0, sizeof(ref_state_t));
+    p_state->m[0] = 1.0;
+    p_state->m[3] = 1.0;
+    p_state->colour = 0xFF000000;
+    p_state->global_alpha = 255;
+    p_state->op = OP_SOURCE_OVER;
+    p_state->clip[2] = CANVAS_W;
+    p_state->clip[3] = CANVAS_H;
+}
+
+static void ref_transform(ref_state_t * p_state, double sx, double ky, double kx, double sy, double tx, double ty) {
+    const double * a = p_state->m;
+    double m[6];
+
+    m[0] = (a[0] * sx) + (a[2] * ky);
+    m[1] = (a[1] * sx) + (a[3] * ky);
+    m[2] = (a[0] * kx) + (a[2] * sy);
+    m[3] = (a[1] * kx) + (a[3] * sy);
+    m[4] = (a[0] * tx) + (a[2] * ty) + a[4];
+    m[5] = (a[1] * tx) + (a[3] * ty) + a[5];
+    memcpy(p_state->m, m, sizeof(m));
+}
+
+static void invert(const double * p_m, double * p_inv) {
+    double det = (p_m[0] * p_m[3]) - (p_m[1] * p_m[2]);
+
+    p_inv[0] = p_m[3] / det;
+    p_inv[1] = -p_m[1] / det;
+    p_inv[2] = -p_m[2] / det;
+    p_inv[3] = p_m[0] / det;
+    p_inv[4] = -((p_inv[0] * p_m[4]) + (p_inv[2] * p_m[5]));
+    p_inv[5] = -((p_inv[1] * p_m[4]) + (p_inv[3] * p_m[5]));
+}
+
+static bool is_integer_translation(const double * p_m) {
+    return (p_m[0] == 1.0) && (p_m[1] == 0.0) && (p_m[2] == 0.0) && (p_m[3] == 1.0)
+           && (p_m[4] == floor(p_m[4])) && (p_m[5] == floor(p_m[5]));
+}
+
+/* Coverage of a pixel by a convex polygon: mean of the horizontal overlaps at 4 sub-scanlines */
+static double coverage(const double * p_xy, int num, int px, int py) {
+    double sum = 0.0;
+    int s;
+    int i;
+
+    for (s = 0; s < SUB_NUM; s++) {
+        double sy = (double)py + (((double)s + 0.5) / SUB_NUM);
+        double xl = 1e9;
+        double xr = -1e9;
+
+        for (i = 0; i < num; i++) {
+            double ax = p_xy[i * 2];
+            double ay = p_xy[(i * 2) + 1];
+            double bx = p_xy[((i + 1) % num) * 2];
+            double by = p_xy[(((i + 1) % num) * 2) + 1];
+            double cx;
+
+            if (((sy < ay) && (sy < by)) || ((sy >= ay) && (sy >= by))) {
+                continue;
+            }
+            cx = ax + (((sy - ay) * (bx - ax)) / (by - ay));
+            xl = (cx < xl) ? cx : xl;
+            xr = (cx > xr) ? cx : xr;
+        }
+        if (xl < xr) {
+            double l = (xl > (double)px) ? xl : (double)px;
+            double r = (xr < (double)(px + 1)) ? xr : (double)(px + 1);
+
+            if (l < r) {
+                sum += r - l;
+            }
+        }
+    }
+    return sum / SUB_NUM;
+}
+
+static colour_t texel(const ref_state_t * p_state, int u, int v) {
+    colour_t none = {0.0, 0.0, 0.0, 0.0};
+
+    if (p_state->paint == PAINT_PATTERN_REPEAT) {
+        u = ((u % p_state->area[2]) + p_state->area[2]) % p_state->area[2];
+        v = ((v % p_state->area[3]) + p_state->area[3]) % p_state->area[3];
+    } else if (p_state->paint == PAINT_PATTERN_NO_REPEAT) {
+        if ((u < 0) || (u >= p_state->area[2]) || (v < 0) || (v >= p_state->area[3])) {
+            return none;
+        }
+    } else {
+        int x0 = p_state->area[0];
+        int y0 = p_state->area[1];
+
+        u = (u < x0) ? x0 : (u >= (x0 + p_state->area[2])) ? (x0 + p_state->area[2] - 1) : u;
+        v = (v < y0) ? y0 : (v >= (y0 + p_state->area[3])) ? (y0 + p_state->area[3] - 1) : v;
+    }
+    return from_argb(image_argb[(v * IMAGE_W) + u]);
+}
+
+static colour_t sample(const ref_state_t * p_state, int px, int py) {
+    const double * p_inv = p_state->inv;
+    double x = (double)px + 0.5;
+    double y = (double)py + 0.5;
+    double u;
+    double v;
+    int u0;
+    int v0;
+    double wx;
+    double wy;
+
+    if (p_state->paint == PAINT_COLOUR) {
+        return from_argb(p_state->colour);
+    }
+    u = (p_inv[0] * x) + (p_inv[2] * y) + p_inv[4];
+    v = (p_inv[1] * x) + (p_inv[3] * y) + p_inv[5];
+    if (!p_state->bilinear) {
+        return texel(p_state, (int)floor(u), (int)floor(v));
+    }
+    u -= 0.5;
+    v -= 0.5;
+    u0 = (int)floor(u);
+    v0 = (int)floor(v);
+    wx = u - u0;
+    wy = v - v0;
+    return add(add(scale(texel(p_state, u0, v0), (1.0 - wx) * (1.0 - wy)), scale(texel(p_state, u0 + 1, v0), wx * (1.0 - wy))),
+               add(scale(texel(p_state, u0, v0 + 1), (1.0 - wx) * wy), scale(texel(p_state, u0 + 1, v0 + 1), wx * wy)));
+}
+
+/* Fill the rectangle of the user space with the paint of the state */
+static void ref_fill(const ref_state_t * p_state, std::vector<colour_t> & fb, double x, double y, double w, double h) {
+    const double * m = p_state->m;
+    double ux[4] = {x, x + w, x + w, x};
+    double uy[4] = {y, y, y + h, y + h};
+    double xy[8];
+    double ga = (double)p_state->global_alpha / 255.0;
+    int px;
+    int py;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        xy[i * 2] = (m[0] * ux[i]) + (m[2] * uy[i]) + m[4];
+        xy[(i * 2) + 1] = (m[1] * ux[i]) + (m[3] * uy[i]) + m[5];
+    }
+    for (py = p_state->clip[1]; py < p_state->clip[3]; py++) {
+        for (px = p_state->clip[0]; px < p_state->clip[2]; px++) {
+            double cov = coverage(xy, 4, px, py);
+            colour_t * p_dst = &fb[(py * CANVAS_W) + px];
+            colour_t s;
+            colour_t r;
+
+            if (cov <= 0.0) {
+                continue;
+            }
+            s = scale(sample(p_state, px, py), ga);
+            switch (p_state->op) {
+                case OP_COPY:
+                    r = s;
+                    break;
+                case OP_DESTINATION_OUT:
+                    r = scale(*p_dst, 1.0 - s.a);
+                    break;
+                default:
+                    r = add(s, scale(*p_dst, 1.0 - s.a));
+                    break;
+            }
+            *p_dst = add(scale(r, cov), scale(*p_dst, 1.0 - cov));
+        }
+    }
+}
+
+/* Reference of drawImage(image, sx, sy, sw, sh, dx, dy, dw, dh) (the source is in the image) */
+static void ref_draw_image(ref_state_t * p_state, std::vector<colour_t> & fb,
+                           int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh) {
+    double kx = (double)dw / sw;
+    double ky = (double)dh / sh;
+    double m_inv[6];
+    double s[6] = {1.0 / kx, 0.0, 0.0, 1.0 / ky, sx - (dx / kx), sy - (dy / ky)};
+
+    invert(p_state->m, m_inv);
+    p_state->inv[0] = (s[0] * m_inv[0]) + (s[2] * m_inv[1]);
+    p_state->inv[1] = (s[1] * m_inv[0]) + (s[3] * m_inv[1]);
+    p_state->inv[2] = (s[0] * m_inv[2]) + (s[2] * m_inv[3]);
+    p_state->inv[3] = (s[1] * m_inv[2]) + (s[3] * m_inv[3]);
+    p_state->inv[4] = (s[0] * m_inv[4]) + (s[2] * m_inv[5]) + s[4];
+    p_state->inv[5] = (s[1] * m_inv[4]) + (s[3] * m_inv[5]) + s[5];
+    p_state->paint = PAINT_IMAGE;
+    p_state->area[0] = sx;
+    p_state->area[1] = sy;
+    p_state->area[2] = sw;
+    p_state->area[3] = sh;
+    p_state->bilinear = !((kx == 1.0) && (ky == 1.0) && is_integer_translation(p_state->m));
+    ref_fill(p_state, fb, dx, dy, dw, dh);
+    p_state->paint = PAINT_COLOUR;
+}
+
+static void ref_set_pattern(ref_state_t * p_state, bool repeat) {
+    invert(p_state->m, p_state->inv);
+    p_state->paint = repeat ? PAINT_PATTERN_REPEAT : PAINT_PATTERN_NO_REPEAT;
+    p_state->area[0] = 0;
+    p_state->area[1] = 0;
+    p_state->area[2] = IMAGE_W;
+    p_state->area[3] = IMAGE_H;
+    p_state->bilinear = !is_integer_translation(p_state->m);
+}
+
+
+/***********************************************************************
+* Scenes
+************************************************************************/
+
+typedef struct {
+    Canvas2D_ContextClass       ctx;
+    ref_state_t                 ref;
+    std::vector<colour_t> *     p_fb;
+} scene_t;
+
+typedef void (*scene_func_t)(scene_t * p_scene);
+
+static void scene_fill_integer(scene_t * p) {
+    p->ctx.fillStyle = "rgb(200,100,50)";
+    p->ctx.fillRect(5, 6, 20, 10);
+    p->ref.colour = 0xFFC86432;
+    ref_fill(&p->ref, *p->p_fb, 5, 6, 20, 10);
+}
+
+static void scene_fill_alpha(scene_t * p) {
+    p->ctx.fillStyle = "rgba(10,200,30,0.5)";
+    p->ctx.fillRect(-4, 10, 40, 30);
+    p->ref.colour = 0x800AC81E;
+    ref_fill(&p->ref, *p->p_fb, -4, 10, 40, 30);
+}
+
+static void scene_fill_subpixel(scene_t * p) {
+    p->ctx.translate(0.3f, 0.6f);
+    p->ctx.fillStyle = "#3366ff";
+    p->ctx.fillRect(10, 8, 21, 13);
+    ref_transform(&p->ref, 1, 0, 0, 1, 0.3f, 0.6f);
+    p->ref.colour = 0xFF3366FF;
+    ref_fill(&p->ref, *p->p_fb, 10, 8, 21, 13);
+}
+
+static void scene_fill_rotate(scene_t * p) {
+    float c = cosf(0.5f);
+    float s = sinf(0.5f);
+
+    p->ctx.translate(32, 24);
+    p->ctx.rotate(0.5f);
+    p->ctx.fillStyle = "rgba(255,255,0,0.75)";
+    p->ctx.fillRect(-15, -8, 30, 16);
+    ref_transform(&p->ref, 1, 0, 0, 1, 32, 24);
+    ref_transform(&p->ref, c, s, -s, c, 0, 0);
+    p->ref.colour = 0xBFFFFF00;
+    ref_fill(&p->ref, *p->p_fb, -15, -8, 30, 16);
+}
+
+static void scene_fill_scale(scene_t * p) {
+    p->ctx.scale(1.7f, 0.6f);
+    p->ctx.fillStyle = "navy";
+    p->ctx.fillRect(3, 7, 25, 50);
+    ref_transform(&p->ref, 1.7f, 0, 0, 0.6f, 0, 0);
+    p->ref.colour = 0xFF000080;
+    ref_fill(&p->ref, *p->p_fb, 3, 7, 25, 50);
+}
+
+static void scene_global_alpha(scene_t * p) {
+    float c = cosf(-0.3f);
+    float s = sinf(-0.3f);
+
+    p->ctx.globalAlpha = 0.3f;
+    p->ctx.translate(20.5f, 10.25f);
+    p->ctx.rotate(-0.3f);
+    p->ctx.fillStyle = "white";
+    p->ctx.fillRect(0, 0, 30, 25);
+    p->ref.global_alpha = (uint8_t)((0.3f * 255.0f) + 0.5f);
+    ref_transform(&p->ref, 1, 0, 0, 1, 20.5f, 10.25f);
+    ref_transform(&p->ref, c, s, -s, c, 0, 0);
+    p->ref.colour = 0xFFFFFFFF;
+    ref_fill(&p->ref, *p->p_fb, 0, 0, 30, 25);
+}
+
+static void scene_copy(scene_t * p) {
+    p->ctx.globalCompositeOperation = "copy";
+    p->ctx.translate(0.5f, 0.25f);
+    p->ctx.fillStyle = "rgba(255,0,128,0.6)";
+    p->ctx.fillRect(8, 8, 30, 20);
+    p->ref.op = OP_COPY;
+    ref_transform(&p->ref, 1, 0, 0, 1, 0.5f, 0.25f);
+    p->ref.colour = ((uint32_t)((0.6f * 255.0f) + 0.5f) << 24) | 0xFF0080;
+    ref_fill(&p->ref, *p->p_fb, 8, 8, 30, 20);
+}
+
+static void scene_destination_out(scene_t * p) {
+    float c = cosf(0.8f);
+    float s = sinf(0.8f);
+
+    p->ctx.globalCompositeOperation = "destination-out";
+    p->ctx.translate(30, 20);
+    p->ctx.rotate(0.8f);
+    p->ctx.fillStyle = "rgba(0,0,0,0.5)";
+    p->ctx.fillRect(-12, -12, 24, 24);
+    p->ref.op = OP_DESTINATION_OUT;
+    ref_transform(&p->ref, 1, 0, 0, 1, 30, 20);
+    ref_transform(&p->ref, c, s, -s, c, 0, 0);
+    p->ref.colour = 0x80000000;
+    ref_fill(&p->ref, *p->p_fb, -12, -12, 24, 24);
+}
+
+static void scene_image_nearest(scene_t * p) {
+    p->ctx.drawImage(&image_r8g8b8a8, 7, 9);
+    ref_draw_image(&p->ref, *p->p_fb, 0, 0, IMAGE_W, IMAGE_H, 7, 9, IMAGE_W, IMAGE_H);
+}
+
+static void scene_image_direct(scene_t * p) {
+    p->ctx.globalAlpha = 0.75f;
+    p->ctx.drawImage(&image_argb8888, 40, -3);
+    p->ref.global_alpha = (uint8_t)((0.75f * 255.0f) + 0.5f);
+    ref_draw_image(&p->ref, *p->p_fb, 0, 0, IMAGE_W, IMAGE_H, 40, -3, IMAGE_W, IMAGE_H);
+}
+
+static void scene_image_scaled(scene_t * p) {
+    p->ctx.drawImage(&image_r8g8b8a8, 3, 4, 40, 30);
+    ref_draw_image(&p->ref, *p->p_fb, 0, 0, IMAGE_W, IMAGE_H, 3, 4, 40, 30);
+}
+
+static void scene_image_source_rect(scene_t * p) {
+    p->ctx.drawImage(&image_r8g8b8a8, 2, 2, 8, 6, 10, 10, 24, 18);
+    ref_draw_image(&p->ref, *p->p_fb, 2, 2, 8, 6, 10, 10, 24, 18);
+}
+
+static void scene_image_rotated(scene_t * p) {
+    float c = cosf(0.4f);
+    float s = sinf(0.4f);
+
+    p->ctx.translate(32, 24);
+    p->ctx.rotate(0.4f);
+    p->ctx.drawImage(&image_r8g8b8a8, -16, -12, 32, 24);
+    ref_transform(&p->ref, 1, 0, 0, 1, 32, 24);
+    ref_transform(&p->ref, c, s, -s, c, 0, 0);
+    ref_draw_image(&p->ref, *p->p_fb, 0, 0, IMAGE_W, IMAGE_H, -16, -12, 32, 24);
+}
+
+static void scene_pattern_repeat(scene_t * p) {
+    Canvas2D_PatternClass pattern = p->ctx.createPattern(&image_r8g8b8a8, "repeat");
+
+    p->ctx.fillStyle = pattern;
+    p->ctx.fillRect(2, 3, 58, 40);
+    pattern.destroy();
+    ref_set_pattern(&p->ref, true);
+    ref_fill(&p->ref, *p->p_fb, 2, 3, 58, 40);
+}
+
+static void scene_pattern_no_repeat(scene_t * p) {
+    Canvas2D_PatternClass pattern = p->ctx.createPattern(&image_r8g8b8a8, "no-repeat");
+
+    p->ctx.translate(5.5f, 3.25f);
+    p->ctx.scale(1.5f, 1.5f);
+    p->ctx.fillStyle = pattern;
+    p->ctx.fillRect(-2, -2, 30, 20);
+    pattern.destroy();
+    ref_transform(&p->ref, 1, 0, 0, 1, 5.5f, 3.25f);
+    ref_transform(&p->ref, 1.5f, 0, 0, 1.5f, 0, 0);
+    ref_set_pattern(&p->ref, false);
+    ref_fill(&p->ref, *p->p_fb, -2, -2, 30, 20);
+}
+
+static void scene_clip(scene_t * p) {
+    p->ctx.beginPath();
+    p->ctx.rect(10, 10, 20, 15);
+    p->ctx.rect(25, 20, 10, 10);
+    p->ctx.clip();
+    p->ctx.fillStyle = "red";
+    p->ctx.translate(0.5f, 0.5f);
+    p->ctx.fillRect(0, 0, 64, 48);
+    p->ref.clip[0] = 10;
+    p->ref.clip[1] = 10;
+    p->ref.clip[2] = 35;
+    p->ref.clip[3] = 30;
+    ref_transform(&p->ref, 1, 0, 0, 1, 0.5f, 0.5f);
+    p->ref.colour = 0xFFFF0000;
+    ref_fill(&p->ref, *p->p_fb, 0, 0, 64, 48);
+}
+
+static void scene_save_restore(scene_t * p) {
+    ref_state_t saved = p->ref;
+
+    p->ctx.save();
+    p->ctx.translate(20, 20);
+    p->ctx.scale(0.5f, 0.5f);
+    p->ctx.fillStyle = "lime";
+    p->ctx.fillRect(0, 0, 21, 21);
+    p->ctx.restore();
+    p->ctx.fillRect(1, 1, 9, 9);
+    ref_transform(&p->ref, 1, 0, 0, 1, 20, 20);
+    ref_transform(&p->ref, 0.5f, 0, 0, 0.5f, 0, 0);
+    p->ref.colour = 0xFF00FF00;
+    ref_fill(&p->ref, *p->p_fb, 0, 0, 21, 21);
+    p->ref = saved;
+    ref_fill(&p->ref, *p->p_fb, 1, 1, 9, 9);
+}
+
+typedef struct {
+    const char *    name;
+    scene_func_t    func;
+    pixel_format_t  format;
+    int             tolerance;          /* Maximum difference of a premultiplied channel */
+} scene_desc_t;
+
+/* The tolerances cover the truncation of the coverage (1/64 of a pixel for each sub-scanline), the 8-bit
+ * coverage, the 16.16 texture coordinates, the 8-bit bilinear weights and the RGB565 quantization */
+static const scene_desc_t scene_list[] = {
+    {"fill_integer",        &scene_fill_integer,        PIXEL_FORMAT_ARGB8888, 0},
+    {"fill_alpha",          &scene_fill_alpha,          PIXEL_FORMAT_ARGB8888, 1},
+    {"fill_subpixel",       &scene_fill_subpixel,       PIXEL_FORMAT_ARGB8888, 3},
+    {"fill_rotate",         &scene_fill_rotate,         PIXEL_FORMAT_ARGB8888, 3},
+    {"fill_scale",          &scene_fill_scale,          PIXEL_FORMAT_ARGB8888, 3},
+    {"global_alpha",        &scene_global_alpha,        PIXEL_FORMAT_ARGB8888, 3},
+    {"copy",                &scene_copy,                PIXEL_FORMAT_ARGB8888, 3},
+    {"destination_out",     &scene_destination_out,     PIXEL_FORMAT_ARGB8888, 3},
+    {"image_nearest",       &scene_image_nearest,       PIXEL_FORMAT_ARGB8888, 1},
+    {"image_direct",        &scene_image_direct,        PIXEL_FORMAT_ARGB8888, 1},
+    {"image_scaled",        &scene_image_scaled,        PIXEL_FORMAT_ARGB8888, 3},
+    {"image_source_rect",   &scene_image_source_rect,   PIXEL_FORMAT_ARGB8888, 3},
+    {"image_rotated",       &scene_image_rotated,       PIXEL_FORMAT_ARGB8888, 3},
+    {"pattern_repeat",      &scene_pattern_repeat,      PIXEL_FORMAT_ARGB8888, 1},
+    {"pattern_no_repeat",   &scene_pattern_no_repeat,   PIXEL_FORMAT_ARGB8888, 3},
+    {"clip",                &scene_clip,                PIXEL_FORMAT_ARGB8888, 3},
+    {"save_restore",        &scene_save_restore,        PIXEL_FORMAT_ARGB8888, 3},
+    {"fill_rotate_565",     &scene_fill_rotate,         PIXEL_FORMAT_RGB565,   9},
+    {"image_rotated_565",   &scene_image_rotated,       PIXEL_FORMAT_RGB565,   9},
+};
+
+
+/***********************************************************************
+* Test
+************************************************************************/
+
+static void make_image(void) {
+    int x;
+    int y;
+
+    for (y = 0; y < IMAGE_H; y++) {
+        for (x = 0; x < IMAGE_W; x++) {
+            uint8_t * p = &image_rgba[((y * IMAGE_W) + x) * 4];
+
+            p[0] = (uint8_t)(x * 16);
+            p[1] = (uint8_t)(y * 21);
+            p[2] = (uint8_t)(((x + y) & 1) ? 255 : 40);
+            p[3] = (uint8_t)(((x == 0) || (y == 0)) ? 255 : (128 + (x * 8)));
+            image_argb[(y * IMAGE_W) + x] = ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        }
+    }
+    (void)R_GRAPHICS_IMAGE_InitR8G8B8A8(&image_r8g8b8a8, image_rgba, sizeof(image_rgba), IMAGE_W, IMAGE_H);
+    image_argb8888 = image_r8g8b8a8;
+    image_argb8888.offset_to_image = (uintptr_t)image_argb;
+    image_argb8888.type = (uint8_t)PIXEL_FORMAT_ARGB8888;
+}
+
+/* Opaque background */
+static uint32_t background(int x, int y) {
+    return 0xFF000000 | ((uint32_t)(x * 4) << 16) | ((uint32_t)(y * 5) << 8) | (uint32_t)(((x ^ y) & 4) ? 0xC0 : 0x30);
+}
+
+static uint32_t read_pixel(const frame_buffer_t * p_frame, int x, int y) {
+    const uint8_t * p_row = p_frame->buffer_address[0] + (y * p_frame->stride);
+
+    if (p_frame->pixel_format == PIXEL_FORMAT_RGB565) {
+        return rgb565_to_argb(((const uint16_t *)p_row)[x]);
+    }
+    return ((const uint32_t *)p_row)[x];
+}
+
+static void write_ppm(const char * name, const std::vector<uint32_t> & result, const std::vector<colour_t> & ref) {
+    char path[256];
+    FILE * fp;
+    int x;
+    int y;
+    int i;
+
+    snprintf(path, sizeof(path), "%s/%s.ppm", out_dir, name);
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return;
+    }
+    fprintf(fp, "P6\n%d %d\n255\n", CANVAS_W * 3, CANVAS_H);
+    for (y = 0; y < CANVAS_H; y++) {
+        for (x = 0; x < (CANVAS_W * 3); x++) {
+            int a[4];
+            int b[4];
+            uint8_t rgb[3];
+
+            premultiplied8(result[(y * CANVAS_W) + (x % CANVAS_W)], a);
+            premultiplied8(ref[(y * CANVAS_W) + (x % CANVAS_W)], b);
+            for (i = 0; i < 3; i++) {
+                int v = (x < CANVAS_W) ? a[i + 1] : (x < (CANVAS_W * 2)) ? b[i + 1] : (abs(a[i + 1] - b[i + 1]) * 16);
+
+                rgb[i] = (uint8_t)((v > 255) ? 255 : v);
+            }
+            fwrite(rgb, 1, 3, fp);
+        }
+    }
+    fclose(fp);
+}
+
+static bool run_scene(const scene_desc_t * p_desc) {
+    std::vector<uint8_t> buf(CANVAS_W * CANVAS_H * 4);
+    std::vector<colour_t> ref(CANVAS_W * CANVAS_H);
+    std::vector<uint32_t> result(CANVAS_W * CANVAS_H);
+    frame_buffer_t frame;
+    scene_t scene;
+    int bpp = (p_desc->format == PIXEL_FORMAT_RGB565) ? 2 : 4;
+    int max_diff = 0;
+    int bad = 0;
+    int x;
+    int y;
+    int i;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.buffer_address[0] = &buf[0];
+    frame.buffer_count = 1;
+    frame.width = CANVAS_W;
+    frame.height = CANVAS_H;
+    frame.byte_per_pixel = bpp;
+    frame.stride = CANVAS_W * bpp;
+    frame.pixel_format = p_desc->format;
+
+    for (y = 0; y < CANVAS_H; y++) {
+        for (x = 0; x < CANVAS_W; x++) {
+            uint32_t c = background(x, y);
+
+            if (bpp == 2) {
+                ((uint16_t *)&buf[0])[(y * CANVAS_W) + x] = (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+            } else {
+                ((uint32_t *)&buf[0])[(y * CANVAS_W) + x] = c;
+            }
+            ref[(y * CANVAS_W) + x] = from_argb(read_pixel(&frame, x, y));
+        }
+    }
+
+    scene.ctx = R_RGA_New_Canvas2D_ContextClass(&frame);
+    ref_init(&scene.ref);
+    scene.p_fb = &ref;
+    p_desc->func(&scene);
+    scene.ctx.destroy();
+
+    for (y = 0; y < CANVAS_H; y++) {
+        for (x = 0; x < CANVAS_W; x++) {
+            int a[4];
+            int b[4];
+            int diff = 0;
+
+            result[(y * CANVAS_W) + x] = read_pixel(&frame, x, y);
+            premultiplied8(result[(y * CANVAS_W) + x], a);
+            premultiplied8(ref[(y * CANVAS_W) + x], b);
+            for (i = 0; i < 4; i++) {
+                diff = (abs(a[i] - b[i]) > diff) ? abs(a[i] - b[i]) : diff;
+            }
+            max_diff = (diff > max_diff) ? diff : max_diff;
+            if (diff > p_desc->tolerance) {
+                if (bad == 0) {
+                    printf("    first error at (%d, %d): %02X %02X %02X %02X, reference %02X %02X %02X %02X\n",
+                           x, y, a[0], a[1], a[2], a[3], b[0], b[1], b[2], b[3]);
+                }
+                bad++;
+            }
+        }
+    }
+    if (out_dir != NULL) {
+        write_ppm(p_desc->name, result, ref);
+    }
+    printf("%-20s %-8s max diff %3d (tolerance %d), %4d pixels over  %s\n", p_desc->name,
+           (bpp == 2) ? "RGB565" : "ARGB8888", max_diff, p_desc->tolerance, bad, (bad == 0) ? "OK" : "NG");
+    return (bad == 0);
+}
+
+int main(int argc, char * argv[]) {
+    int fail = 0;
+    size_t i;
+
+    for (i = 1; i < (size_t)argc; i++) {
+        if ((strcmp(argv[i], "-o") == 0) && ((i + 1) < (size_t)argc)) {
+            out_dir = argv[++i];
+        } else {
+            printf("usage: canvas2d_soft_test [-o dir]\n");
+            return 2;
+        }
+    }
+
+    make_image();
+    for (i = 0; i < (sizeof(scene_list) / sizeof(scene_list[0])); i++) {
+        if (!run_scene(&scene_list[i])) {
+            fail++;
+        }
+    }
+    printf("%d / %d scenes passed\n", (int)(sizeof(scene_list) / sizeof(scene_list[0])) - fail,
+           (int)(sizeof(scene_list) / sizeof(scene_list[0])));
+    return (fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,394 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "Compositor.h"
+
+static bool intersect(const Pixel2D::rect_t * p_a, const Pixel2D::rect_t * p_b, Pixel2D::rect_t * p_out) {
+    int x0 = (p_a->x > p_b->x) ? p_a->x : p_b->x;
+    int y0 = (p_a->y > p_b->y) ? p_a->y : p_b->y;
+    int x1 = ((p_a->x + p_a->width) < (p_b->x + p_b->width)) ? (p_a->x + p_a->width) : (p_b->x + p_b->width);
+    int y1 = ((p_a->y + p_a->height) < (p_b->y + p_b->height)) ? (p_a->y + p_a->height) : (p_b->y + p_b->height);
+
+    if ((x0 >= x1) || (y0 >= y1)) {
+        return false;
+    }
+    p_out->x = x0;
+    p_out->y = y0;
+    p_out->width = x1 - x0;
+    p_out->height = y1 - y0;
+    return true;
+}
+
+static void unite(const Pixel2D::rect_t * p_a, const Pixel2D::rect_t * p_b, Pixel2D::rect_t * p_out) {
+    int x0 = (p_a->x < p_b->x) ? p_a->x : p_b->x;
+    int y0 = (p_a->y < p_b->y) ? p_a->y : p_b->y;
+    int x1 = ((p_a->x + p_a->width) > (p_b->x + p_b->width)) ? (p_a->x + p_a->width) : (p_b->x + p_b->width);
+    int y1 = ((p_a->y + p_a->height) > (p_b->y + p_b->height)) ? (p_a->y + p_a->height) : (p_b->y + p_b->height);
+
+    p_out->x = x0;
+    p_out->y = y0;
+    p_out->width = x1 - x0;
+    p_out->height = y1 - y0;
+}
+
+/* true when the rectangles overlap or share a part of an edge (touching only at a corner is false) */
+static bool touch(const Pixel2D::rect_t * p_a, const Pixel2D::rect_t * p_b) {
+    bool x_overlap = (p_a->x < (p_b->x + p_b->width)) && (p_b->x < (p_a->x + p_a->width));
+    bool y_overlap = (p_a->y < (p_b->y + p_b->height)) && (p_b->y < (p_a->y + p_a->height));
+    bool x_adjacent = (p_a->x == (p_b->x + p_b->width)) || (p_b->x == (p_a->x + p_a->width));
+    bool y_adjacent = (p_a->y == (p_b->y + p_b->height)) || (p_b->y == (p_a->y + p_a->height));
+
+    return (x_overlap && y_overlap) || (x_overlap && y_adjacent) || (x_adjacent && y_overlap);
+}
+
+static bool contain(const Pixel2D::rect_t * p_outer, const Pixel2D::rect_t * p_inner) {
+    return (p_inner->x >= p_outer->x) && (p_inner->y >= p_outer->y)
+           && ((p_inner->x + p_inner->width) <= (p_outer->x + p_outer->width))
+           && ((p_inner->y + p_inner->height) <= (p_outer->y + p_outer->height));
+}
+
+static uint32_t area(const Pixel2D::rect_t * p_rect) {
+    return (uint32_t)p_rect->width * (uint32_t)p_rect->height;
+}
+
+Compositor::Compositor(int width, int height, uint32_t background) :
+    _width(width), _height(height), _background(background), _layer_num(0), _use_count(0) {
+    memset(_layer, 0, sizeof(_layer));
+    ResetTargets();
+    ResetStats();
+}
+
+int Compositor::AddLayer(const Pixel2D::surface_t * p_surface, int x, int y, Pixel2D::blend_mode_t mode, uint8_t global_alpha) {
+    int id;
+
+    if ((p_surface == NULL) || (p_surface->p_buf == NULL) || (_layer_num >= COMPOSITOR_LAYER_MAX)) {
+        return -1;
+    }
+    for (id = 0; id < COMPOSITOR_LAYER_MAX; id++) {
+        if (_layer[id].p_surface == NULL) {
+            break;
+        }
+    }
+    _layer[id].p_surface = p_surface;
+    _layer[id].x = x;
+    _layer[id].y = y;
+    _layer[id].mode = mode;
+    _layer[id].global_alpha = global_alpha;
+    _layer[id].visible = true;
+    _order[_layer_num++] = id;
+    damage_layer(id);
+
+    return id;
+}
+
+bool Compositor::RemoveLayer(int id) {
+    int i;
+
+    if (!check_id(id)) {
+        return false;
+    }
+    damage_layer(id);
+    _layer[id].p_surface = NULL;
+    for (i = 0; i < _layer_num; i++) {
+        if (_order[i] == id) {
+            break;
+        }
+    }
+    _layer_num--;
+    for (; i < _layer_num; i++) {
+        _order[i] = _order[i + 1];
+    }
+
+    return true;
+}
+
+bool Compositor::SetPosition(int id, int x, int y) {
+    if (!check_id(id)) {
+        return false;
+    }
+    if ((_layer[id].x != x) || (_layer[id].y != y)) {
+        damage_layer(id);
+        _layer[id].x = x;
+        _layer[id].y = y;
+        damage_layer(id);
+    }
+
+    return true;
+}
+
+bool Compositor::SetVisible(int id, bool visible) {
+    if (!check_id(id)) {
+        return false;
+    }
+    if (_layer[id].visible != visible) {
+        // damage_layer() ignores hidden layers
+        _layer[id].visible = true;
+        damage_layer(id);
+        _layer[id].visible = visible;
+    }
+
+    return true;
+}
+
+bool Compositor::SetAlpha(int id, uint8_t global_alpha) {
+    if (!check_id(id)) {
+        return false;
+    }
+    if (_layer[id].global_alpha != global_alpha) {
+        _layer[id].global_alpha = global_alpha;
+        damage_layer(id);
+    }
+
+    return true;
+}
+
+void Compositor::SetBackground(uint32_t background) {
+    if (_background != background) {
+        _background = background;
+        InvalidateScreen(NULL);
+    }
+}
+
+bool Compositor::Invalidate(int id, const Pixel2D::rect_t * p_rect) {
+    Pixel2D::rect_t layer_rect;
+    Pixel2D::rect_t rect;
+
+    if (!check_id(id)) {
+        return false;
+    }
+    if (!_layer[id].visible) {
+        return true;
+    }
+    if (p_rect == NULL) {
+        damage_layer(id);
+        return true;
+    }
+    layer_rect.x = 0;
+    layer_rect.y = 0;
+    layer_rect.width = _layer[id].p_surface->width;
+    layer_rect.height = _layer[id].p_surface->height;
+    if (intersect(&layer_rect, p_rect, &rect)) {
+        rect.x += _layer[id].x;
+        rect.y += _layer[id].y;
+        damage(&rect);
+    }
+
+    return true;
+}
+
+void Compositor::InvalidateScreen(const Pixel2D::rect_t * p_rect) {
+    Pixel2D::rect_t rect = {0, 0, _width, _height};
+
+    damage((p_rect == NULL) ? &rect : p_rect);
+}
+
+bool Compositor::Compose(const Pixel2D::surface_t * p_dst) {
+    Pixel2D::rect_t screen = {0, 0, _width, _height};
+    target_t * p_target = NULL;
+    region_t full;
+    region_t * p_region;
+    uint32_t touched = 0;
+    int i;
+
+    if ((p_dst == NULL) || (p_dst->p_buf == NULL) || (p_dst->width < _width) || (p_dst->height < _height)) {
+        return false;
+    }
+
+    for (i = 0; i < COMPOSITOR_TARGET_MAX; i++) {
+        if (_target[i].p_buf == p_dst->p_buf) {
+            p_target = &_target[i];
+            break;
+        }
+    }
+    if (p_target == NULL) {
+        // A new frame buffer, the least recently used one is forgotten
+        p_target = &_target[0];
+        for (i = 1; i < COMPOSITOR_TARGET_MAX; i++) {
+            if ((p_target->p_buf != NULL) && ((_target[i].p_buf == NULL) || (_target[i].last_used < p_target->last_used))) {
+                p_target = &_target[i];
+            }
+        }
+        p_target->p_buf = p_dst->p_buf;
+        full.rects[0] = screen;
+        full.num = 1;
+        p_region = &full;
+        _stats.full_frames++;
+    } else {
+        p_region = &p_target->damage;
+    }
+    p_target->last_used = ++_use_count;
+
+    for (i = 0; i < p_region->num; i++) {
+        compose_rect(p_dst, &p_region->rects[i]);
+        touched += area(&p_region->rects[i]);
+    }
+
+    _stats.frames++;
+    _stats.rects = p_region->num;
+    _stats.pixels_touched = touched;
+    _stats.pixels_full = area(&screen);
+    _stats.total_touched += touched;
+    _stats.total_full += area(&screen);
+    p_target->damage.num = 0;
+
+    return true;
+}
+
+void Compositor::ResetTargets(void) {
+    memset(_target, 0, sizeof(_target));
+}
+
+void Compositor::GetStats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = _stats;
+    }
+}
+
+void Compositor::ResetStats(void) {
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.pixels_full = (uint32_t)_width * (uint32_t)_height;
+}
+
+bool Compositor::check_id(int id) {
+    return (id >= 0) && (id < COMPOSITOR_LAYER_MAX) && (_layer[id].p_surface != NULL);
+}
+
+void Compositor::damage_layer(int id) {
+    Pixel2D::rect_t rect;
+
+    if (!_layer[id].visible) {
+        return;
+    }
+    rect.x = _layer[id].x;
+    rect.y = _layer[id].y;
+    rect.width = _layer[id].p_surface->width;
+    rect.height = _layer[id].p_surface->height;
+    damage(&rect);
+}
+
+void Compositor::damage(const Pixel2D::rect_t * p_rect) {
+    Pixel2D::rect_t screen = {0, 0, _width, _height};
+    Pixel2D::rect_t rect;
+    int i;
+
+    if (!intersect(&screen, p_rect, &rect)) {
+        return;
+    }
+    for (i = 0; i < COMPOSITOR_TARGET_MAX; i++) {
+        if (_target[i].p_buf != NULL) {
+            add_rect(&_target[i].damage, &rect);
+        }
+    }
+}
+
+void Compositor::compose_rect(const Pixel2D::surface_t * p_dst, const Pixel2D::rect_t * p_rect) {
+    uint32_t acc[PIXEL_2D_CHUNK_NUM];
+    uint32_t line[PIXEL_2D_CHUNK_NUM];
+    Pixel2D::rect_t layer_rect[COMPOSITOR_LAYER_MAX];
+    const layer_t * p_layer;
+    int bottom = -1;
+    int x0;
+    int x1;
+    int num;
+    int i;
+    int j;
+    int k;
+
+    for (k = 0; k < _layer_num; k++) {
+        p_layer = &_layer[_order[k]];
+        layer_rect[k].x = p_layer->x;
+        layer_rect[k].y = p_layer->y;
+        layer_rect[k].width = p_layer->visible ? p_layer->p_surface->width : 0;
+        layer_rect[k].height = p_layer->visible ? p_layer->p_surface->height : 0;
+        // The layers under an opaque layer which covers the rectangle are not read
+        if ((p_layer->visible) && (p_layer->mode == Pixel2D::BLEND_SRC) && (p_layer->global_alpha == 255)
+                && (contain(&layer_rect[k], p_rect))) {
+            bottom = k;
+        }
+    }
+
+    for (i = p_rect->y; i < (p_rect->y + p_rect->height); i++) {
+        for (j = p_rect->x; j < (p_rect->x + p_rect->width); j += num) {
+            num = p_rect->x + p_rect->width - j;
+            if (num > PIXEL_2D_CHUNK_NUM) {
+                num = PIXEL_2D_CHUNK_NUM;
+            }
+            if (bottom < 0) {
+                for (k = 0; k < num; k++) {
+                    acc[k] = _background;
+                }
+            }
+            for (k = (bottom < 0) ? 0 : bottom; k < _layer_num; k++) {
+                p_layer = &_layer[_order[k]];
+                if ((i < layer_rect[k].y) || (i >= (layer_rect[k].y + layer_rect[k].height))) {
+                    continue;
+                }
+                x0 = (j > layer_rect[k].x) ? j : layer_rect[k].x;
+                x1 = ((j + num) < (layer_rect[k].x + layer_rect[k].width)) ? (j + num) : (layer_rect[k].x + layer_rect[k].width);
+                if (x0 >= x1) {
+                    continue;
+                }
+                Pixel2D::ReadLine(p_layer->p_surface, x0 - p_layer->x, i - p_layer->y, x1 - x0, line);
+                Pixel2D::BlendLine(&acc[x0 - j], line, x1 - x0, p_layer->mode, p_layer->global_alpha);
+            }
+            Pixel2D::WriteLine(p_dst, j, i, num, acc);
+        }
+    }
+}
+
+void Compositor::add_rect(region_t * p_region, const Pixel2D::rect_t * p_rect) {
+    Pixel2D::rect_t rect = *p_rect;
+    Pixel2D::rect_t merged;
+    uint32_t cost;
+    uint32_t best_cost;
+    int best;
+    int i;
+
+    while (true) {
+        // Merge the rectangles which overlap or touch
+        for (i = 0; i < p_region->num; i++) {
+            if (touch(&p_region->rects[i], &rect)) {
+                break;
+            }
+        }
+        if (i < p_region->num) {
+            if (contain(&p_region->rects[i], &rect)) {
+                return;
+            }
+            unite(&p_region->rects[i], &rect, &rect);
+            p_region->rects[i] = p_region->rects[--p_region->num];
+            continue;
+        }
+        if (p_region->num < COMPOSITOR_DAMAGE_MAX) {
+            break;
+        }
+        // No more rectangles, merge with the rectangle which adds the fewest pixels
+        best = 0;
+        best_cost = 0xFFFFFFFF;
+        for (i = 0; i < p_region->num; i++) {
+            unite(&p_region->rects[i], &rect, &merged);
+            cost = area(&merged) - area(&p_region->rects[i]);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best = i;
+            }
+        }
+        unite(&p_region->rects[best], &rect, &rect);
+        p_region->rects[best] = p_region->rects[--p_region->num];
+    }
+    p_region->rects[p_region->num++] = rect;
+}
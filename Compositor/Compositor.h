@@ -0,0 +1,238 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Compositor.h
+* @brief         Retained-mode compositor which redraws only the damaged areas
+*
+* The layers are surfaces of Pixel2D placed on the screen. When a layer is changed, the area is
+* recorded as a damage rectangle, and Compose() blends only the damaged areas of the layers into
+* the destination. The rectangles which overlap or share a part of an edge are merged into their
+* bounding rectangle. The rectangles which touch only at a corner are kept apart, because their
+* bounding rectangle would add two areas which are not damaged.
+*
+* The destination can be one of several frame buffers (e.g. the buffer got by PresentQueue::Acquire()).
+* The damage is kept for each frame buffer, so a buffer is updated with all the changes made
+* since it was composed last time. A buffer which has not been composed yet is composed entirely.
+*
+* The pixels are blended in ARGB8888 line buffers by Pixel2D::ReadLine(), BlendLine() and WriteLine(),
+* and each pixel of the destination is written once.
+* The library does not depend on mbed.
+******************************************************************************/
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "Pixel2D.h"
+
+/** Maximum number of layers */
+#ifndef COMPOSITOR_LAYER_MAX
+#define COMPOSITOR_LAYER_MAX        (8)
+#endif
+
+/** Maximum number of damage rectangles of a frame buffer (more rectangles are merged) */
+#ifndef COMPOSITOR_DAMAGE_MAX
+#define COMPOSITOR_DAMAGE_MAX       (16)
+#endif
+
+/** Maximum number of frame buffers whose damage is kept */
+#ifndef COMPOSITOR_TARGET_MAX
+#define COMPOSITOR_TARGET_MAX       (4)
+#endif
+
+/** A class of the damage-tracking compositor
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "PresentQueue.h"
+ * #include "Compositor.h"
+ *
+ * DisplayBase Display;
+ * PresentQueue Presenter(&Display, DisplayBase::GRAPHICS_LAYER_0);
+ * Compositor Comp(480, 272, 0xFF000000);
+ *
+ * static uint32_t wallpaper[480 * 272];
+ * static uint32_t clock_buf[96 * 32];
+ *
+ * int main() {
+ *     Pixel2D::surface_t wall = {(uint8_t *)wallpaper, 480, 272, 480 * 4, Pixel2D::FORMAT_ARGB8888, NULL, 0};
+ *     Pixel2D::surface_t clk  = {(uint8_t *)clock_buf, 96, 32, 96 * 4, Pixel2D::FORMAT_ARGB8888, NULL, 0};
+ *     Pixel2D::surface_t lcd  = {NULL, 480, 272, 480 * 2, Pixel2D::FORMAT_RGB565, NULL, 0};
+ *     Pixel2D::rect_t digit = {48, 0, 16, 32};
+ *     int id_clk;
+ *
+ *     // Start the LCD and PresentQueue here
+ *     Comp.AddLayer(&wall, 0, 0, Pixel2D::BLEND_SRC);
+ *     id_clk = Comp.AddLayer(&clk, 380, 8);
+ *     while (1) {
+ *         // draw a digit of clock_buf
+ *         Comp.Invalidate(id_clk, &digit);
+ *         lcd.p_buf = Presenter.Acquire();
+ *         Comp.Compose(&lcd);
+ *         Presenter.Present(lcd.p_buf);
+ *     }
+ * }
+ * @endcode
+ */
+class Compositor {
+public:
+    /*! @struct stats_t
+        @brief Composition statistics
+     */
+    typedef struct {
+        uint32_t    frames;             /*!< Number of Compose() calls */
+        uint32_t    full_frames;        /*!< Number of Compose() calls which composed the whole screen */
+        uint32_t    rects;              /*!< Number of rectangles composed by the last Compose() */
+        uint32_t    pixels_touched;     /*!< Number of pixels composed by the last Compose() */
+        uint32_t    pixels_full;        /*!< Number of pixels of the screen */
+        uint64_t    total_touched;      /*!< Number of pixels composed by all Compose() calls */
+        uint64_t    total_full;         /*!< pixels_full * frames */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param width width of the screen
+     * @param height height of the screen
+     * @param background colour of the area without layers (ARGB8888)
+     */
+    Compositor(int width, int height, uint32_t background = 0xFF000000);
+
+    /** Add a layer on the top
+     *
+     * The surface is referred to by the compositor (the pixels are not copied).
+     *
+     * @param p_surface surface of the layer
+     * @param x left of the layer on the screen
+     * @param y top of the layer on the screen
+     * @param mode compositing operator with the lower layers
+     * @param global_alpha alpha multiplied to the layer (0 - 255)
+     * @return layer ID, -1 = no more layers
+     */
+    int AddLayer(const Pixel2D::surface_t * p_surface, int x, int y,
+                 Pixel2D::blend_mode_t mode = Pixel2D::BLEND_SRC_OVER, uint8_t global_alpha = 255);
+
+    /** Remove a layer
+     *
+     * @param id layer ID
+     * @return true = success, false = invalid ID
+     */
+    bool RemoveLayer(int id);
+
+    /** Move a layer
+     *
+     * @param id layer ID
+     * @param x left of the layer on the screen
+     * @param y top of the layer on the screen
+     * @return true = success, false = invalid ID
+     */
+    bool SetPosition(int id, int x, int y);
+
+    /** Show or hide a layer
+     *
+     * @param id layer ID
+     * @param visible true = show, false = hide
+     * @return true = success, false = invalid ID
+     */
+    bool SetVisible(int id, bool visible);
+
+    /** Change the global alpha of a layer
+     *
+     * @param id layer ID
+     * @param global_alpha alpha multiplied to the layer (0 - 255)
+     * @return true = success, false = invalid ID
+     */
+    bool SetAlpha(int id, uint8_t global_alpha);
+
+    /** Change the background colour
+     *
+     * @param background colour of the area without layers (ARGB8888)
+     */
+    void SetBackground(uint32_t background);
+
+    /** Notify that pixels of a layer have been changed
+     *
+     * @param id layer ID
+     * @param p_rect changed rectangle in the layer (NULL: whole layer)
+     * @return true = success, false = invalid ID
+     */
+    bool Invalidate(int id, const Pixel2D::rect_t * p_rect = NULL);
+
+    /** Notify that an area of the screen must be redrawn
+     *
+     * @param p_rect rectangle on the screen (NULL: whole screen)
+     */
+    void InvalidateScreen(const Pixel2D::rect_t * p_rect = NULL);
+
+    /** Compose the damaged areas into a frame buffer
+     *
+     * @param p_dst frame buffer (the size must be the size of the screen)
+     * @return true = success, false = invalid parameter
+     */
+    bool Compose(const Pixel2D::surface_t * p_dst);
+
+    /** Forget the damage of all frame buffers (the next Compose() of each buffer composes the whole screen)
+     */
+    void ResetTargets(void);
+
+    /** Get the composition statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+    /** Clear the composition statistics
+     */
+    void ResetStats(void);
+
+private:
+    typedef struct {
+        Pixel2D::rect_t rects[COMPOSITOR_DAMAGE_MAX];
+        int num;
+    } region_t;
+
+    typedef struct {
+        const Pixel2D::surface_t * p_surface;
+        int x;
+        int y;
+        Pixel2D::blend_mode_t mode;
+        uint8_t global_alpha;
+        bool visible;
+    } layer_t;
+
+    typedef struct {
+        const uint8_t * p_buf;
+        uint32_t last_used;
+        region_t damage;
+    } target_t;
+
+    int _width;
+    int _height;
+    uint32_t _background;
+    layer_t _layer[COMPOSITOR_LAYER_MAX];
+    int _order[COMPOSITOR_LAYER_MAX];
+    int _layer_num;
+    target_t _target[COMPOSITOR_TARGET_MAX];
+    uint32_t _use_count;
+    stats_t _stats;
+
+    bool check_id(int id);
+    void damage_layer(int id);
+    void damage(const Pixel2D::rect_t * p_rect);
+    void compose_rect(const Pixel2D::surface_t * p_dst, const Pixel2D::rect_t * p_rect);
+    static void add_rect(region_t * p_region, const Pixel2D::rect_t * p_rect);
+};
+
+#endif
@@ -0,0 +1,345 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          compositor_damage_test.cpp
+* @brief         Check of the damage merging of Compositor on a Linux host
+*
+* Merge cases: the frame buffer is composed once, filled with a marker colour which Compose() never
+* writes, and composed again after some InvalidateScreen() calls. The pixels which are not the marker
+* any more are the pixels composed, and they must be exactly the expected rectangles:
+* the rectangles touching only at a corner are composed apart, the rectangles sharing a part of an
+* edge or overlapping are composed as their bounding rectangle.
+*
+* Random case: layers are moved, shown / hidden, faded and invalidated at random while 3 frame buffers
+* are composed in turn. Each buffer must be equal to the whole screen composed by a new Compositor.
+*
+* Build (from Compositor/):
+*   g++ -O2 -I. -I../Pixel2D -o compositor_damage_test tools/compositor_damage_test.cpp Compositor.cpp
+*       ../Pixel2D/Pixel2D.cpp
+*
+* The exit status is 1 if a case fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Compositor.h"
+
+#define SCREEN_W        (96)
+#define SCREEN_H        (64)
+#define SPRITE_W        (20)
+#define SPRITE_H        (14)
+#define LAYER_NUM       (3)
+#define MARKER          (0x12345678u)   /* Alpha 0x12: never written, the wallpaper is opaque */
+
+typedef struct {
+    int x;
+    int y;
+    bool visible;
+    uint8_t global_alpha;
+} layer_state_t;
+
+static uint32_t wallpaper[SCREEN_W * SCREEN_H];
+static uint32_t sprite[SPRITE_W * SPRITE_H];
+static uint16_t panel[SPRITE_H * SPRITE_W * 2];
+static Pixel2D::surface_t layer_surface[LAYER_NUM];
+static const Pixel2D::blend_mode_t layer_mode[LAYER_NUM] = {
+    Pixel2D::BLEND_SRC, Pixel2D::BLEND_SRC_OVER, Pixel2D::BLEND_SRC_OVER
+};
+static layer_state_t layer_state[LAYER_NUM];
+
+static int total;
+static int fail;
+
+static void make_layers(void) {
+    int x;
+    int y;
+
+    for (y = 0; y < SCREEN_H; y++) {
+        for (x = 0; x < SCREEN_W; x++) {
+            wallpaper[(y * SCREEN_W) + x] = 0xFF000000 | ((uint32_t)(x * 2) << 16) | ((uint32_t)(y * 3) << 8) | 0x40;
+        }
+    }
+    for (y = 0; y < SPRITE_H; y++) {
+        for (x = 0; x < SPRITE_W; x++) {
+            sprite[(y * SPRITE_W) + x] = ((uint32_t)(0x40 + (x * 9)) << 24) | 0x00E02010 | ((uint32_t)(y * 16) << 8);
+        }
+    }
+    for (y = 0; y < SPRITE_H; y++) {
+        for (x = 0; x < (SPRITE_W * 2); x++) {
+            panel[(y * SPRITE_W * 2) + x] = (uint16_t)(0xF000 | ((x & 0x0F) << 4) | (y & 0x0F) | ((x & 1) ? 0x0F00 : 0));
+        }
+    }
+    layer_surface[0].p_buf = (uint8_t *)wallpaper;
+    layer_surface[0].width = SCREEN_W;
+    layer_surface[0].height = SCREEN_H;
+    layer_surface[0].stride = SCREEN_W * 4;
+    layer_surface[0].format = Pixel2D::FORMAT_ARGB8888;
+    layer_surface[1].p_buf = (uint8_t *)sprite;
+    layer_surface[1].width = SPRITE_W;
+    layer_surface[1].height = SPRITE_H;
+    layer_surface[1].stride = SPRITE_W * 4;
+    layer_surface[1].format = Pixel2D::FORMAT_ARGB8888;
+    layer_surface[2].p_buf = (uint8_t *)panel;
+    layer_surface[2].width = SPRITE_W * 2;
+    layer_surface[2].height = SPRITE_H;
+    layer_surface[2].stride = SPRITE_W * 2 * 2;
+    layer_surface[2].format = Pixel2D::FORMAT_ARGB4444;
+}
+
+static void init_dst(Pixel2D::surface_t * p_dst, std::vector<uint32_t> & buf) {
+    memset(p_dst, 0, sizeof(Pixel2D::surface_t));
+    p_dst->p_buf = (uint8_t *)&buf[0];
+    p_dst->width = SCREEN_W;
+    p_dst->height = SCREEN_H;
+    p_dst->stride = SCREEN_W * 4;
+    p_dst->format = Pixel2D::FORMAT_ARGB8888;
+}
+
+static void add_layers(Compositor & comp) {
+    int i;
+
+    for (i = 0; i < LAYER_NUM; i++) {
+        (void)comp.AddLayer(&layer_surface[i], layer_state[i].x, layer_state[i].y, layer_mode[i],
+                            layer_state[i].global_alpha);
+        (void)comp.SetVisible(i, layer_state[i].visible);
+    }
+}
+
+static void reset_layers(void) {
+    int i;
+
+    for (i = 0; i < LAYER_NUM; i++) {
+        layer_state[i].x = (i == 0) ? 0 : (i * 23);
+        layer_state[i].y = (i == 0) ? 0 : (i * 11);
+        layer_state[i].visible = true;
+        layer_state[i].global_alpha = (i == 2) ? 160 : 255;
+    }
+}
+
+/***********************************************************************
+* Merge cases
+************************************************************************/
+
+typedef struct {
+    const char *        name;
+    int                 num;
+    Pixel2D::rect_t     damage[4];
+    int                 expected_num;
+    Pixel2D::rect_t     expected[2];
+} merge_case_t;
+
+static const merge_case_t merge_case_list[] = {
+    {"corner",          2, {{10, 10, 8, 8}, {18, 18, 8, 8}},                    2, {{10, 10, 8, 8}, {18, 18, 8, 8}}},
+    {"corner (up)",     2, {{30, 10, 8, 8}, {22, 18, 8, 8}},                    2, {{30, 10, 8, 8}, {22, 18, 8, 8}}},
+    {"gap of 1 pixel",  2, {{10, 10, 8, 8}, {19, 10, 8, 8}},                    2, {{10, 10, 8, 8}, {19, 10, 8, 8}}},
+    {"edge",            2, {{10, 10, 8, 8}, {18, 12, 8, 4}},                    1, {{10, 10, 16, 8}}},
+    {"edge (1 pixel)",  2, {{10, 10, 8, 8}, {13, 18, 8, 8}},                    1, {{10, 10, 11, 16}}},
+    {"overlap",         2, {{10, 10, 8, 8}, {14, 14, 8, 8}},                    1, {{10, 10, 12, 12}}},
+    {"contained",       2, {{10, 10, 20, 20}, {12, 12, 4, 4}},                  1, {{10, 10, 20, 20}}},
+    {"bridge",          3, {{10, 10, 8, 8}, {18, 18, 8, 8}, {14, 14, 8, 8}},    1, {{10, 10, 16, 16}}},
+    {"corner + edge",   3, {{10, 10, 8, 8}, {18, 18, 8, 8}, {26, 18, 8, 8}},    2, {{10, 10, 8, 8}, {18, 18, 16, 8}}},
+};
+
+static bool in_rects(const Pixel2D::rect_t * p_rects, int num, int x, int y) {
+    int i;
+
+    for (i = 0; i < num; i++) {
+        if ((x >= p_rects[i].x) && (x < (p_rects[i].x + p_rects[i].width))
+         && (y >= p_rects[i].y) && (y < (p_rects[i].y + p_rects[i].height))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Composes after the damage. The composed pixels are returned in touched (0 / 1). */
+static void compose_damage(const Pixel2D::rect_t * p_damage, int num, std::vector<uint8_t> & touched,
+                           Compositor::stats_t * p_stats) {
+    Compositor comp(SCREEN_W, SCREEN_H);
+    std::vector<uint32_t> buf(SCREEN_W * SCREEN_H);
+    Pixel2D::surface_t dst;
+    size_t i;
+    int k;
+
+    reset_layers();
+    add_layers(comp);
+    init_dst(&dst, buf);
+    (void)comp.Compose(&dst);
+    for (i = 0; i < buf.size(); i++) {
+        buf[i] = MARKER;
+    }
+    for (k = 0; k < num; k++) {
+        comp.InvalidateScreen(&p_damage[k]);
+    }
+    (void)comp.Compose(&dst);
+    comp.GetStats(p_stats);
+    touched.resize(buf.size());
+    for (i = 0; i < buf.size(); i++) {
+        touched[i] = (buf[i] != MARKER) ? 1 : 0;
+    }
+}
+
+static void test_merge(const merge_case_t * p_case) {
+    Compositor::stats_t stats;
+    std::vector<uint8_t> touched;
+    int wrong = 0;
+    int x;
+    int y;
+
+    compose_damage(p_case->damage, p_case->num, touched, &stats);
+    for (y = 0; y < SCREEN_H; y++) {
+        for (x = 0; x < SCREEN_W; x++) {
+            if (touched[(y * SCREEN_W) + x] != (in_rects(p_case->expected, p_case->expected_num, x, y) ? 1 : 0)) {
+                wrong++;
+            }
+        }
+    }
+    total++;
+    if ((wrong != 0) || ((int)stats.rects != p_case->expected_num)) {
+        fail++;
+    }
+    printf("%-20s %u rects (expected %d), %5u pixels composed, %4d pixels wrong  %s\n", p_case->name,
+           stats.rects, p_case->expected_num, stats.pixels_touched, wrong,
+           ((wrong == 0) && ((int)stats.rects == p_case->expected_num)) ? "OK" : "NG");
+}
+
+/* More rectangles than COMPOSITOR_DAMAGE_MAX: every rectangle is composed within the limit */
+static void test_overflow(void) {
+    Pixel2D::rect_t damage[COMPOSITOR_DAMAGE_MAX * 2];
+    Compositor::stats_t stats;
+    std::vector<uint8_t> touched;
+    int missed = 0;
+    int num = COMPOSITOR_DAMAGE_MAX * 2;
+    int x;
+    int y;
+    int k;
+
+    for (k = 0; k < num; k++) {
+        damage[k].x = (k % 8) * 12;
+        damage[k].y = (k / 8) * 12;
+        damage[k].width = 3;
+        damage[k].height = 3;
+    }
+    compose_damage(damage, num, touched, &stats);
+    for (y = 0; y < SCREEN_H; y++) {
+        for (x = 0; x < SCREEN_W; x++) {
+            if (in_rects(damage, num, x, y) && (touched[(y * SCREEN_W) + x] == 0)) {
+                missed++;
+            }
+        }
+    }
+    total++;
+    if ((missed != 0) || (stats.rects > COMPOSITOR_DAMAGE_MAX)) {
+        fail++;
+    }
+    printf("%-20s %u rects (max %d), %5u pixels composed, %4d pixels missed  %s\n", "overflow",
+           stats.rects, COMPOSITOR_DAMAGE_MAX, stats.pixels_touched, missed,
+           ((missed == 0) && (stats.rects <= COMPOSITOR_DAMAGE_MAX)) ? "OK" : "NG");
+}
+
+/***********************************************************************
+* Random case
+************************************************************************/
+
+static void test_random(int frames) {
+    Compositor comp(SCREEN_W, SCREEN_H);
+    std::vector<uint32_t> buf[3];
+    std::vector<uint32_t> ref_buf(SCREEN_W * SCREEN_H);
+    Pixel2D::surface_t dst[3];
+    Pixel2D::surface_t ref_dst;
+    Compositor::stats_t stats;
+    uint32_t seed = 12345;
+    int bad_frames = 0;
+    int frame;
+    int i;
+    int n;
+
+    reset_layers();
+    add_layers(comp);
+    for (i = 0; i < 3; i++) {
+        buf[i].assign(SCREEN_W * SCREEN_H, MARKER);
+        init_dst(&dst[i], buf[i]);
+    }
+    init_dst(&ref_dst, ref_buf);
+    for (frame = 0; frame < frames; frame++) {
+        for (n = 0; n < 3; n++) {
+            int id;
+
+            seed = (seed * 1103515245u) + 12345u;
+            id = 1 + (int)((seed >> 16) % 2);
+            switch ((seed >> 8) % 5) {
+                case 0:
+                    layer_state[id].x = (int)((seed >> 20) % (SCREEN_W + 20)) - 20;
+                    layer_state[id].y = (int)((seed >> 12) % (SCREEN_H + 10)) - 10;
+                    (void)comp.SetPosition(id, layer_state[id].x, layer_state[id].y);
+                    break;
+                case 1:
+                    layer_state[id].visible = !layer_state[id].visible;
+                    (void)comp.SetVisible(id, layer_state[id].visible);
+                    break;
+                case 2:
+                    layer_state[id].global_alpha = (uint8_t)(seed >> 24);
+                    (void)comp.SetAlpha(id, layer_state[id].global_alpha);
+                    break;
+                default: {
+                    /* A pixel of the layer changed */
+                    Pixel2D::rect_t rect = {(int)((seed >> 16) % SPRITE_W), (int)((seed >> 24) % SPRITE_H), 2, 2};
+
+                    if (id == 1) {
+                        sprite[(rect.y * SPRITE_W) + rect.x] ^= 0x00FF00FF;
+                    } else {
+                        panel[(rect.y * SPRITE_W * 2) + rect.x] ^= 0x0F0F;
+                    }
+                    (void)comp.Invalidate(id, &rect);
+                    break;
+                }
+            }
+        }
+        (void)comp.Compose(&dst[frame % 3]);
+        {
+            Compositor ref(SCREEN_W, SCREEN_H);
+
+            add_layers(ref);
+            (void)ref.Compose(&ref_dst);
+        }
+        if (memcmp(&buf[frame % 3][0], &ref_buf[0], ref_buf.size() * 4) != 0) {
+            bad_frames++;
+        }
+    }
+    comp.GetStats(&stats);
+    total++;
+    if (bad_frames != 0) {
+        fail++;
+    }
+    printf("%-20s %d frames, %d wrong, %.1f %% of the pixels composed  %s\n", "random", frames, bad_frames,
+           (100.0 * (double)stats.total_touched) / (double)stats.total_full, (bad_frames == 0) ? "OK" : "NG");
+}
+
+int main(void) {
+    size_t i;
+
+    make_layers();
+    for (i = 0; i < (sizeof(merge_case_list) / sizeof(merge_case_list[0])); i++) {
+        test_merge(&merge_case_list[i]);
+    }
+    test_overflow();
+    test_random(300);
+
+    printf("%d / %d cases passed\n", total - fail, total);
+    return (fail == 0) ? 0 : 1;
+}
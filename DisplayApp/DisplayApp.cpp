@@ -16,108 +16,113 @@
 #include "mbed.h"
 #include "DisplayApp.h"
 
+void DisplayApp::touch_batch(void * p_user, const touch_event_t * p_events, int num) {
+    DisplayApp * p_app = (DisplayApp *)p_user;
+
+    if (p_app->batch_event) {
+        p_app->batch_event.call(p_events, num);
+    }
+    if (p_app->event) {
+        p_app->event.call();
+    }
+}
+
+void DisplayApp::rx_callback(void) {
+    rx_sem.release();
+}
+
 void DisplayApp::display_app_process() {
-    int data;
-    int pos_x_wk;
-    int pos_wk;
+    uint8_t buf[64];
+    int num;
 
     PcApp.connect();
 
     while (!PcApp.configured()) {
         ThisThread::sleep_for(100);
     }
+    touch_timer.start();
+    PcApp.attach(this, &DisplayApp::rx_callback);
 
     while (1) {
-        if (PcApp.readable()) {
-            data = PcApp.getc();
-            if (data == '{') {
-                pos_seq = POS_SEQ_START;
-            } else if (data == 'X') {
-                if (pos_seq == POS_SEQ_START) {
-                    pos_seq = POS_SEQ_X;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if (data == 'Y') {
-                if (pos_seq == POS_SEQ_C) {
-                    pos_seq = POS_SEQ_Y;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if (data == '=') {
-                if (pos_seq == POS_SEQ_X) {
-                    pos_seq = POS_SEQ_X_POS;
-                    pos_wk = 0;
-                } else if (pos_seq == POS_SEQ_Y) {
-                    pos_seq = POS_SEQ_Y_POS;
-                    pos_wk = 0;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if (data == '-') {
-                if (pos_seq == POS_SEQ_X_POS) {
-                    pos_seq = POS_SEQ_X_M;
-                } else if (pos_seq == POS_SEQ_Y_POS) {
-                    pos_seq = POS_SEQ_Y_M;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if ((data >= '0') && (data <= '9')) {
-                if ((pos_seq == POS_SEQ_X_POS) || (pos_seq == POS_SEQ_Y_POS)) {
-                    pos_wk = (pos_wk * 10) + (data - '0');
-                } else if ((pos_seq == POS_SEQ_X_M) && (data == '1')) {
-                    pos_wk = -1;
-                } else if ((pos_seq == POS_SEQ_Y_M) && (data == '1')) {
-                    pos_wk = -1;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if (data == ',') {
-                if ((pos_seq == POS_SEQ_X_POS) || (pos_seq == POS_SEQ_X_M)) {
-                    pos_x_wk = pos_wk;
-                    pos_seq = POS_SEQ_C;
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else if (data == '}') {
-                if ((pos_seq == POS_SEQ_Y_POS) || (pos_seq == POS_SEQ_Y_M)) {
-                    pos_seq = POS_SEQ_END;
-                    if ((pos_x != pos_x_wk) || (pos_y != pos_wk)) {
-                        pos_x = pos_x_wk;
-                        pos_y = pos_wk;
-                        if (event) {
-                            event.call();
-                        }
-                    }
-                } else {
-                    pos_seq = POS_SEQ_INIT;
-                }
-            } else {
-                pos_seq = POS_SEQ_INIT;
+        // The timeout is for the data received before attach()
+        rx_sem.wait(DISPLAY_APP_RX_TIMEOUT);
+        while (PcApp.readable()) {
+            num = 0;
+            while ((num < (int)sizeof(buf)) && (PcApp.readable())) {
+                buf[num++] = (uint8_t)PcApp.getc();
             }
+            touch_mutex.lock();
+            touch_parser.Feed(buf, num, (uint32_t)touch_timer.read_ms());
+            touch_mutex.unlock();
+        }
+    }
+}
+
+void DisplayApp::send_process() {
+    send_frame_t frame;
+    uint32_t start_us;
+    uint32_t time_us;
+    int size;
+
+    send_timer.start();
+    while (1) {
+        send_sem.wait();
+        queue_mutex.lock();
+        if (send_num == 0) {
+            queue_mutex.unlock();
+            continue;
+        }
+        frame = send_queue[send_rd_idx];
+        send_queue[send_rd_idx].release = NULL;
+        send_rd_idx = (send_rd_idx + 1) % DISPLAY_APP_SEND_QUEUE_NUM;
+        send_num--;
+        queue_mutex.unlock();
+
+        start_us = (uint32_t)send_timer.read_us();
+        if (frame.type == SEND_TYPE_JPEG) {
+            size = SendJpeg(frame.buf, frame.size);
+        } else {
+            size = SendRgb888(frame.buf, frame.width, frame.height);
+        }
+        time_us = (uint32_t)send_timer.read_us() - start_us;
+
+        queue_mutex.lock();
+        if (size > 0) {
+            send_stats.delivered++;
+            send_stats.bytes += (uint32_t)size;
+            send_time_us += time_us;
         } else {
-            ThisThread::sleep_for(10);
+            send_stats.dropped++;
+        }
+        queue_mutex.unlock();
+
+        if (frame.release) {
+            frame.release(frame.buf);
         }
     }
 }
 
 DisplayApp::DisplayApp(osPriority tsk_pri, uint32_t stack_size) : 
-  PcApp(false), displayThread(tsk_pri, stack_size) {
+  PcApp(false), displayThread(tsk_pri, stack_size), rx_sem(0, 1), delta_buf(NULL), delta_buf_size(0),
+  sendThread(tsk_pri, stack_size), send_thread_started(false), send_sem(0, DISPLAY_APP_SEND_QUEUE_NUM),
+  send_rd_idx(0), send_num(0), send_time_us(0) {
+    memset(&send_stats, 0, sizeof(send_stats));
+    touch_parser.SetBatchFunc(&DisplayApp::touch_batch, this);
     displayThread.start(callback(this, &DisplayApp::display_app_process));
 }
 
-void DisplayApp::SendHeader(uint32_t size) {
+bool DisplayApp::SendHeader(uint32_t size) {
     uint8_t headder_data[12] = {0xFF,0xFF,0xAA,0x55,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00};
 
     headder_data[8]  = (uint8_t)((uint32_t)size >> 0);
     headder_data[9]  = (uint8_t)((uint32_t)size >> 8);
     headder_data[10] = (uint8_t)((uint32_t)size >> 16);
     headder_data[11] = (uint8_t)((uint32_t)size >> 24);
-    PcApp.send((uint8_t *)headder_data, sizeof(headder_data));
+    return PcApp.send((uint8_t *)headder_data, sizeof(headder_data));
 }
 
-void DisplayApp::SendData(uint8_t * buf, uint32_t size) {
-    PcApp.send(buf, size);
+bool DisplayApp::SendData(uint8_t * buf, uint32_t size) {
+    return PcApp.send(buf, size);
 }
 
 int DisplayApp::SendRgb888(uint8_t * buf, uint32_t pic_width, uint32_t pic_height) {
@@ -131,6 +136,7 @@ int DisplayApp::SendRgb888(uint8_t * buf, uint32_t pic_width, uint32_t pic_heigh
     if (!PcApp.configured()) {
         return 0;
     }
+    usb_mutex.lock();
     SendHeader(total_size);
 
     /* BITMAPFILEHEADER */
@@ -195,6 +201,7 @@ int DisplayApp::SendRgb888(uint8_t * buf, uint32_t pic_width, uint32_t pic_heigh
     PcApp.send(wk_bitmap_buf, wk_idx);
 
     SendData(buf, pic_size);
+    usb_mutex.unlock();
     wk_idx += pic_size;
 
     return wk_idx;
@@ -208,37 +215,183 @@ int DisplayApp::SendJpeg(uint8_t * buf, uint32_t size) {
     if (!PcApp.configured()) {
         return 0;
     }
+    usb_mutex.lock();
     SendHeader(size);
     SendData(buf, size);
+    usb_mutex.unlock();
+
+    return size;
+}
+
+bool DisplayApp::push_frame(const send_frame_t * p_frame) {
+    send_frame_t dropped_frame;
+    bool dropped = false;
+
+    if (!PcApp.configured()) {
+        queue_mutex.lock();
+        send_stats.dropped++;
+        queue_mutex.unlock();
+        if (p_frame->release) {
+            p_frame->release(p_frame->buf);
+        }
+        return false;
+    }
+
+    queue_mutex.lock();
+    if (!send_thread_started) {
+        sendThread.start(callback(this, &DisplayApp::send_process));
+        send_thread_started = true;
+    }
+    if (send_num >= DISPLAY_APP_SEND_QUEUE_NUM) {
+        // Latest frame wins
+        dropped_frame = send_queue[send_rd_idx];
+        send_queue[send_rd_idx].release = NULL;
+        send_rd_idx = (send_rd_idx + 1) % DISPLAY_APP_SEND_QUEUE_NUM;
+        send_num--;
+        send_stats.dropped++;
+        dropped = true;
+    }
+    send_queue[(send_rd_idx + send_num) % DISPLAY_APP_SEND_QUEUE_NUM] = *p_frame;
+    send_num++;
+    queue_mutex.unlock();
+
+    if (dropped) {
+        // The number of frames is not changed
+        if (dropped_frame.release) {
+            dropped_frame.release(dropped_frame.buf);
+        }
+    } else {
+        send_sem.release();
+    }
+
+    return true;
+}
+
+bool DisplayApp::SendJpegAsync(uint8_t * buf, uint32_t size, Callback<void(uint8_t *)> release) {
+    send_frame_t frame;
+
+    frame.type    = SEND_TYPE_JPEG;
+    frame.buf     = buf;
+    frame.size    = size;
+    frame.width   = 0;
+    frame.height  = 0;
+    frame.release = release;
+
+    return push_frame(&frame);
+}
+
+bool DisplayApp::SendRgb888Async(uint8_t * buf, uint32_t pic_width, uint32_t pic_height,
+                                 Callback<void(uint8_t *)> release) {
+    send_frame_t frame;
+
+    frame.type    = SEND_TYPE_RGB888;
+    frame.buf     = buf;
+    frame.size    = 0;
+    frame.width   = pic_width;
+    frame.height  = pic_height;
+    frame.release = release;
+
+    return push_frame(&frame);
+}
+
+void DisplayApp::GetSendStats(send_stats_t * p_stats) {
+    if (p_stats == NULL) {
+        return;
+    }
+    queue_mutex.lock();
+    *p_stats = send_stats;
+    p_stats->pending = send_num;
+    if (send_time_us > 0) {
+        p_stats->bytes_per_sec = (uint32_t)((send_stats.bytes * 1000000u) / send_time_us);
+    } else {
+        p_stats->bytes_per_sec = 0;
+    }
+    queue_mutex.unlock();
+}
+
+int DisplayApp::SendDelta(uint8_t * buf, uint32_t pic_width, uint32_t pic_height,
+                          DisplayAppDeltaEncoder::wire_format_t wire_format,
+                          DisplayAppDeltaEncoder::input_format_t input_format) {
+    uint32_t buf_stride;
+    size_t need_size;
+    bool sent;
+    int size;
+
+    if (!PcApp.configured()) {
+        // The PC may have lost the reference frame
+        delta_encoder.ForceKeyFrame();
+        return 0;
+    }
+    if (input_format == DisplayAppDeltaEncoder::INPUT_ARGB8888) {
+        buf_stride = (((pic_width * 4u) + 31u) & ~31u);
+    } else {
+        buf_stride = pic_width * 2u;
+    }
+    need_size = delta_encoder.GetMaxEncodeSize(pic_width, pic_height, wire_format);
+    if (need_size > delta_buf_size) {
+        free(delta_buf);
+        delta_buf = (uint8_t *)malloc(need_size);
+        if (delta_buf == NULL) {
+            delta_buf_size = 0;
+            return 0;
+        }
+        delta_buf_size = need_size;
+    }
+    size = delta_encoder.Encode(buf, buf_stride, pic_width, pic_height, input_format, wire_format,
+                                delta_buf, delta_buf_size);
+    if (size <= 0) {
+        return 0;
+    }
+    usb_mutex.lock();
+    sent = SendHeader(size) && SendData(delta_buf, size);
+    usb_mutex.unlock();
+    if (!sent) {
+        // The reference frame of the encoder has been updated, but the PC did not receive it
+        delta_encoder.ForceKeyFrame();
+        return 0;
+    }
 
     return size;
 }
 
+void DisplayApp::ForceKeyFrame(void) {
+    delta_encoder.ForceKeyFrame();
+}
+
+void DisplayApp::SetBatchCallback(Callback<void(const touch_event_t *, int)> func) {
+    batch_event = func;
+}
+
 int DisplayApp::GetMaxTouchNum(void) {
-    return 1;
+    return DISPLAY_APP_TOUCH_MAX;
 }
 
 int DisplayApp::GetCoordinates(int touch_buff_num, touch_pos_t * p_touch) {
+    touch_event_t touch[DISPLAY_APP_TOUCH_MAX];
     touch_pos_t * wk_touch;
-    int count = 0;
-    int x = pos_x;
-    int y = pos_y;
+    int count;
+    int i;
 
-    if (touch_buff_num > 0) {
-        count = 0;
-        wk_touch        = &p_touch[0];
+    touch_mutex.lock();
+    count = touch_parser.GetTouches(DISPLAY_APP_TOUCH_MAX, touch);
+    touch_mutex.unlock();
+
+    if (count > touch_buff_num) {
+        count = touch_buff_num;
+    }
+    for (i = 0; i < touch_buff_num; i++) {
+        wk_touch        = &p_touch[i];
         wk_touch->valid = false;
         wk_touch->x     = 0;
         wk_touch->y     = 0;
-        if (x >= 0) {
-            count = 1;
+        if (i < count) {
             wk_touch->valid = true;
-            wk_touch->x = (uint32_t)x;
-        }
-        if (y >= 0) {
-            count = 1;
-            wk_touch->valid = true;
-            wk_touch->y = (uint32_t)y;
+            if (touch[i].x >= 0) {
+                wk_touch->x = (uint32_t)touch[i].x;
+            }
+            if (touch[i].y >= 0) {
+                wk_touch->y = (uint32_t)touch[i].y;
+            }
         }
     }
 
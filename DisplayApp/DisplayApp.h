@@ -24,6 +24,18 @@
 #include "mbed.h"
 #include "rtos.h"
 #include "USBSerial.h"
+#include "DisplayAppDelta.h"
+#include "DisplayAppTouch.h"
+
+/** Timeout to check the received data without the interrupt (ms) */
+#ifndef DISPLAY_APP_RX_TIMEOUT
+#define DISPLAY_APP_RX_TIMEOUT      (100)
+#endif
+
+/** The maximum number of frames waiting in the send queue of SendJpegAsync/SendRgb888Async */
+#ifndef DISPLAY_APP_SEND_QUEUE_NUM
+#define DISPLAY_APP_SEND_QUEUE_NUM  (1)
+#endif
 
 /** A class to communicate a DisplayApp
  *
@@ -37,6 +49,18 @@ public:
         bool     valid;  /**< Whether a valid data.. */
     } touch_pos_t;
 
+    /** Touch event (id, position and timestamp) */
+    typedef DisplayAppTouchParser::touch_event_t touch_event_t;
+
+    /** Send queue statistics */
+    typedef struct {
+        uint32_t delivered;         /**< Number of frames sent to the PC. */
+        uint32_t dropped;           /**< Number of frames replaced by a newer frame or not sent. */
+        uint32_t pending;           /**< Number of frames waiting in the queue. */
+        uint64_t bytes;             /**< Total size of the sent frames. */
+        uint32_t bytes_per_sec;     /**< Link throughput while sending. */
+    } send_stats_t;
+
     /** Constructor: Initializes DisplayApp.
      *
      * @param   tsk_pri        Priority of the thread function. (default: osPriorityNormal).
@@ -62,6 +86,62 @@ public:
      */
     int SendJpeg(uint8_t * buf, uint32_t size);
 
+    /** Queue JPEG data to be sent by the sender thread
+     *
+     * The data is not copied. buf must be kept until release is called.
+     * If the queue is full, the oldest frame waiting in the queue is dropped and released,
+     * so the caller is never blocked by a slow or disconnected PC.
+     *
+     * @param buf data buffer address
+     * @param size data size
+     * @param release function called with buf when the frame has been sent or dropped
+     *                (from the sender thread, or from the caller when dropped)
+     * @return true = queued, false = not connected (release has been called)
+     */
+    bool SendJpegAsync(uint8_t * buf, uint32_t size, Callback<void(uint8_t *)> release = NULL);
+
+    /** Queue RGB888 data to be sent by the sender thread
+     *
+     * The same as SendJpegAsync except for the data format.
+     *
+     * @param buf data buffer address
+     * @param pic_width picture width
+     * @param pic_height picture height
+     * @param release function called with buf when the frame has been sent or dropped
+     * @return true = queued, false = not connected (release has been called)
+     */
+    bool SendRgb888Async(uint8_t * buf, uint32_t pic_width, uint32_t pic_height,
+                         Callback<void(uint8_t *)> release = NULL);
+
+    /** Get the send queue statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetSendStats(send_stats_t * p_stats);
+
+    /** Send only the tiles which have changed since the previous SendDelta
+     *
+     * The first frame, and the frame after the picture size or the wire format is changed,
+     * is sent as a key frame. The data format is described in DisplayAppDelta.h.
+     * If the frame cannot be sent, the next frame is sent as a key frame,
+     * because the PC does not have the frame which the next delta is based on.
+     *
+     * @param buf data buffer address (the same line offset as SendRgb888 for INPUT_ARGB8888,
+     *            pic_width * 2 for INPUT_RGB565)
+     * @param pic_width picture width
+     * @param pic_height picture height
+     * @param wire_format pixel format on the USB
+     * @param input_format pixel format of buf
+     * @return send data size, 0 = not connected or failure
+     */
+    int SendDelta(uint8_t * buf, uint32_t pic_width, uint32_t pic_height,
+                  DisplayAppDeltaEncoder::wire_format_t wire_format = DisplayAppDeltaEncoder::WIRE_RGB565,
+                  DisplayAppDeltaEncoder::input_format_t input_format = DisplayAppDeltaEncoder::INPUT_ARGB8888);
+
+    /** Send all tiles in the next SendDelta
+     */
+    void ForceKeyFrame(void);
+
     /** Attach a function to call whenever a serial interrupt is generated
      *
      * @param func A pointer to a void function, or 0 to set as none
@@ -89,6 +169,15 @@ public:
         // Underlying call thread safe
         SetCallback(callback(obj, method));
     }
+    /** Attach a function to receive the touch events
+     *
+     * The events received at once are delivered together.
+     * The function is called from the thread of DisplayApp.
+     *
+     * @param func A pointer to a function, or 0 to set as none
+     */
+    void SetBatchCallback(Callback<void(const touch_event_t *, int)> func);
+
     /** Get the maximum number of simultaneous touches 
      * 
      * @return The maximum number of simultaneous touches.
@@ -105,28 +194,48 @@ public:
 
 private:
     typedef enum {
-        POS_SEQ_INIT,
-        POS_SEQ_START,
-        POS_SEQ_X,
-        POS_SEQ_X_POS,
-        POS_SEQ_X_M,
-        POS_SEQ_C,
-        POS_SEQ_Y,
-        POS_SEQ_Y_POS,
-        POS_SEQ_Y_M,
-        POS_SEQ_END,
-    } pos_seq_t;
+        SEND_TYPE_JPEG,
+        SEND_TYPE_RGB888,
+    } send_type_t;
+
+    typedef struct {
+        send_type_t type;
+        uint8_t * buf;
+        uint32_t size;
+        uint32_t width;
+        uint32_t height;
+        Callback<void(uint8_t *)> release;
+    } send_frame_t;
 
     USBSerial PcApp;
     Thread displayThread;
-    pos_seq_t pos_seq;
-    int pos_x;
-    int pos_y;
     Callback<void()> event;
+    Callback<void(const touch_event_t *, int)> batch_event;
+    DisplayAppTouchParser touch_parser;
+    Mutex touch_mutex;
+    Semaphore rx_sem;
+    Timer touch_timer;
+    DisplayAppDeltaEncoder delta_encoder;
+    uint8_t * delta_buf;
+    size_t delta_buf_size;
+    Thread sendThread;
+    bool send_thread_started;
+    Mutex usb_mutex;
+    Mutex queue_mutex;
+    Semaphore send_sem;
+    send_frame_t send_queue[DISPLAY_APP_SEND_QUEUE_NUM];
+    int send_rd_idx;
+    int send_num;
+    send_stats_t send_stats;
+    uint64_t send_time_us;
+    Timer send_timer;
 
-    void touch_int_callback(void);
+    static void touch_batch(void * p_user, const touch_event_t * p_events, int num);
+    void rx_callback(void);
     void display_app_process();
-    void SendHeader(uint32_t size);
-    void SendData(uint8_t * buf, uint32_t size);
+    bool SendHeader(uint32_t size);
+    bool SendData(uint8_t * buf, uint32_t size);
+    void send_process();
+    bool push_frame(const send_frame_t * p_frame);
 };
 #endif
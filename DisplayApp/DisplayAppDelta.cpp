@@ -0,0 +1,509 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "DisplayAppDelta.h"
+
+#define FLAG_KEY_FRAME      (0x01)
+#define METHOD_RAW          (0)
+#define METHOD_RLE          (1)
+#define RLE_LITERAL_MAX     (128)
+#define RLE_REPEAT_MIN      (2)
+#define RLE_REPEAT_MAX      (129)
+
+static const uint8_t delta_magic[4] = {'D', 'L', 'T', '1'};
+
+static inline void set_le16(uint8_t * p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void set_le32(uint8_t * p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint32_t get_le16(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int wire_bpp(int wire_format) {
+    if (wire_format == DisplayAppDeltaEncoder::WIRE_RGB565) {
+        return 2;
+    } else if (wire_format == DisplayAppDeltaEncoder::WIRE_GRAY8) {
+        return 1;
+    } else if (wire_format == DisplayAppDeltaEncoder::WIRE_RGB888) {
+        return 3;
+    } else {
+        return 0;
+    }
+}
+
+static inline bool same_pixel(const uint8_t * a, const uint8_t * b, int bpp) {
+    if (a[0] != b[0]) {
+        return false;
+    }
+    if ((bpp >= 2) && (a[1] != b[1])) {
+        return false;
+    }
+    if ((bpp >= 3) && (a[2] != b[2])) {
+        return false;
+    }
+    return true;
+}
+
+/* Returns the encoded size. Stops when the size exceeds limit. */
+static size_t rle_encode(const uint8_t * src, int num, int bpp, uint8_t * dst, size_t limit) {
+    size_t pos = 0;
+    int literal_start = 0;
+    int literal_num = 0;
+    int i = 0;
+    int run;
+
+    while (i < num) {
+        // Length of the run from i
+        run = 1;
+        while (((i + run) < num) && (run < RLE_REPEAT_MAX) && (same_pixel(&src[i * bpp], &src[(i + run) * bpp], bpp))) {
+            run++;
+        }
+        if (run >= RLE_REPEAT_MIN) {
+            if (literal_num > 0) {
+                if ((pos + 1 + (literal_num * bpp)) > limit) {
+                    return limit + 1;
+                }
+                dst[pos++] = (uint8_t)(literal_num - 1);
+                memcpy(&dst[pos], &src[literal_start * bpp], literal_num * bpp);
+                pos += literal_num * bpp;
+                literal_num = 0;
+            }
+            if ((pos + 1 + bpp) > limit) {
+                return limit + 1;
+            }
+            dst[pos++] = (uint8_t)(run + 0x7E);
+            memcpy(&dst[pos], &src[i * bpp], bpp);
+            pos += bpp;
+            i += run;
+        } else {
+            if (literal_num == 0) {
+                literal_start = i;
+            }
+            literal_num++;
+            i++;
+            if (literal_num == RLE_LITERAL_MAX) {
+                if ((pos + 1 + (literal_num * bpp)) > limit) {
+                    return limit + 1;
+                }
+                dst[pos++] = (uint8_t)(literal_num - 1);
+                memcpy(&dst[pos], &src[literal_start * bpp], literal_num * bpp);
+                pos += literal_num * bpp;
+                literal_num = 0;
+            }
+        }
+    }
+    if (literal_num > 0) {
+        if ((pos + 1 + (literal_num * bpp)) > limit) {
+            return limit + 1;
+        }
+        dst[pos++] = (uint8_t)(literal_num - 1);
+        memcpy(&dst[pos], &src[literal_start * bpp], literal_num * bpp);
+        pos += literal_num * bpp;
+    }
+
+    return pos;
+}
+
+DisplayAppDeltaEncoder::DisplayAppDeltaEncoder(uint8_t tile_width, uint8_t tile_height) :
+  tile_w(tile_width), tile_h(tile_height), prev_frame(NULL), tile_buf(NULL), prev_width(0), prev_height(0),
+  prev_format(WIRE_RGB565), key_request(true), frame_no(0) {
+    if (tile_w == 0) {
+        tile_w = 32;
+    }
+    if (tile_h == 0) {
+        tile_h = 32;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+DisplayAppDeltaEncoder::~DisplayAppDeltaEncoder() {
+    free(prev_frame);
+    free(tile_buf);
+}
+
+void DisplayAppDeltaEncoder::ForceKeyFrame(void) {
+    key_request = true;
+}
+
+size_t DisplayAppDeltaEncoder::GetMaxEncodeSize(uint16_t width, uint16_t height, wire_format_t wire_format) {
+    size_t tiles = (size_t)((width + tile_w - 1) / tile_w) * (size_t)((height + tile_h - 1) / tile_h);
+
+    // A tile is sent raw when RLE is larger
+    return DISPLAY_APP_DELTA_HEADER_SIZE + (tiles * DISPLAY_APP_DELTA_TILE_HEADER_SIZE)
+           + ((size_t)width * height * wire_bpp(wire_format));
+}
+
+void DisplayAppDeltaEncoder::GetStats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = stats;
+    }
+}
+
+void DisplayAppDeltaEncoder::convert_line(const uint8_t * src, input_format_t input_format, wire_format_t wire_format,
+                                          uint8_t * dst, int num) {
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+    uint32_t pix;
+    int i;
+
+    if ((input_format == INPUT_RGB565) && (wire_format == WIRE_RGB565)) {
+        memcpy(dst, src, num * 2);
+        return;
+    }
+    for (i = 0; i < num; i++) {
+        if (input_format == INPUT_ARGB8888) {
+            b = src[0];
+            g = src[1];
+            r = src[2];
+            src += 4;
+        } else {
+            pix = get_le16(src);
+            r = ((pix >> 8) & 0xF8) | (pix >> 13);
+            g = ((pix >> 3) & 0xFC) | ((pix >> 9) & 0x03);
+            b = ((pix << 3) & 0xF8) | ((pix >> 2) & 0x07);
+            src += 2;
+        }
+        if (wire_format == WIRE_RGB565) {
+            set_le16(dst, ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+            dst += 2;
+        } else if (wire_format == WIRE_GRAY8) {
+            *dst++ = (uint8_t)(((r * 77) + (g * 150) + (b * 29)) >> 8);
+        } else {
+            *dst++ = (uint8_t)b;
+            *dst++ = (uint8_t)g;
+            *dst++ = (uint8_t)r;
+        }
+    }
+}
+
+int DisplayAppDeltaEncoder::Encode(const uint8_t * buf, uint32_t stride, uint16_t width, uint16_t height,
+                                   input_format_t input_format, wire_format_t wire_format, uint8_t * out, size_t out_size) {
+    int bpp = wire_bpp(wire_format);
+    int in_bpp = (input_format == INPUT_ARGB8888) ? 4 : 2;
+    uint32_t tiles_x;
+    uint32_t tiles_y;
+    uint32_t tx;
+    uint32_t ty;
+    uint32_t tile_num = 0;
+    uint32_t frame_stride;
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t tw;
+    uint32_t th;
+    uint32_t y;
+    uint32_t line_size;
+    uint32_t raw_size;
+    size_t pos;
+    size_t data_size;
+    uint8_t * p_prev;
+    uint8_t * p_tile;
+    uint8_t * p_tile_header;
+    bool key;
+    bool changed;
+
+    if ((buf == NULL) || (out == NULL) || (bpp == 0) || (width == 0) || (height == 0)
+     || (out_size < DISPLAY_APP_DELTA_HEADER_SIZE)) {
+        return -1;
+    }
+
+    // A new reference frame is needed when the picture is changed
+    if ((prev_frame == NULL) || (width != prev_width) || (height != prev_height) || (wire_format != prev_format)) {
+        free(prev_frame);
+        prev_frame = (uint8_t *)malloc((size_t)width * height * bpp);
+        if (tile_buf == NULL) {
+            tile_buf = (uint8_t *)malloc((size_t)tile_w * tile_h * 3);
+        }
+        if ((prev_frame == NULL) || (tile_buf == NULL)) {
+            free(prev_frame);
+            prev_frame = NULL;
+            return -1;
+        }
+        prev_width = width;
+        prev_height = height;
+        prev_format = wire_format;
+        key_request = true;
+    }
+    key = key_request;
+
+    frame_stride = (uint32_t)width * bpp;
+    tiles_x = (width + tile_w - 1) / tile_w;
+    tiles_y = (height + tile_h - 1) / tile_h;
+    pos = DISPLAY_APP_DELTA_HEADER_SIZE;
+    for (ty = 0; ty < tiles_y; ty++) {
+        y0 = ty * tile_h;
+        th = ((y0 + tile_h) <= height) ? tile_h : (height - y0);
+        for (tx = 0; tx < tiles_x; tx++) {
+            x0 = tx * tile_w;
+            tw = ((x0 + tile_w) <= width) ? tile_w : (width - x0);
+            line_size = tw * bpp;
+            raw_size = line_size * th;
+
+            // Convert the tile and compare with the previous frame
+            changed = key;
+            p_tile = tile_buf;
+            p_prev = &prev_frame[(frame_stride * y0) + (x0 * bpp)];
+            for (y = 0; y < th; y++) {
+                convert_line(&buf[(stride * (y0 + y)) + (x0 * in_bpp)], input_format, wire_format, p_tile, tw);
+                if ((!changed) && (memcmp(p_tile, p_prev, line_size) != 0)) {
+                    changed = true;
+                }
+                p_tile += line_size;
+                p_prev += frame_stride;
+            }
+            stats.tiles_total++;
+            if (!changed) {
+                continue;
+            }
+
+            if ((pos + DISPLAY_APP_DELTA_TILE_HEADER_SIZE + raw_size) > out_size) {
+                // The reference frame may have been partly updated
+                key_request = true;
+                return -1;
+            }
+            p_tile_header = &out[pos];
+            pos += DISPLAY_APP_DELTA_TILE_HEADER_SIZE;
+            data_size = rle_encode(tile_buf, tw * th, bpp, &out[pos], raw_size - 1);
+            set_le16(&p_tile_header[0], tx);
+            set_le16(&p_tile_header[2], ty);
+            if (data_size < raw_size) {
+                set_le32(&p_tile_header[4], ((uint32_t)METHOD_RLE << 24) | data_size);
+            } else {
+                memcpy(&out[pos], tile_buf, raw_size);
+                data_size = raw_size;
+                set_le32(&p_tile_header[4], ((uint32_t)METHOD_RAW << 24) | data_size);
+            }
+            pos += data_size;
+            tile_num++;
+
+            // Update the reference frame
+            p_tile = tile_buf;
+            p_prev = &prev_frame[(frame_stride * y0) + (x0 * bpp)];
+            for (y = 0; y < th; y++) {
+                memcpy(p_prev, p_tile, line_size);
+                p_tile += line_size;
+                p_prev += frame_stride;
+            }
+        }
+    }
+
+    memcpy(&out[0], delta_magic, sizeof(delta_magic));
+    set_le16(&out[4], width);
+    set_le16(&out[6], height);
+    out[8]  = (uint8_t)wire_format;
+    out[9]  = key ? FLAG_KEY_FRAME : 0;
+    out[10] = tile_w;
+    out[11] = tile_h;
+    set_le32(&out[12], frame_no);
+    set_le16(&out[16], tile_num);
+    set_le16(&out[18], 0);
+
+    key_request = false;
+    frame_no++;
+    stats.frames++;
+    if (key) {
+        stats.key_frames++;
+    }
+    stats.tiles_sent += tile_num;
+    stats.raw_bytes += (uint64_t)width * height * bpp;
+    stats.encoded_bytes += pos;
+
+    return (int)pos;
+}
+
+DisplayAppDeltaDecoder::DisplayAppDeltaDecoder() :
+  frame(NULL), width(0), height(0), format(DisplayAppDeltaEncoder::WIRE_RGB565), frame_no(0) {
+}
+
+DisplayAppDeltaDecoder::~DisplayAppDeltaDecoder() {
+    free(frame);
+}
+
+bool DisplayAppDeltaDecoder::IsDeltaFrame(const uint8_t * data, size_t size) {
+    if ((data == NULL) || (size < DISPLAY_APP_DELTA_HEADER_SIZE)) {
+        return false;
+    }
+    return (memcmp(data, delta_magic, sizeof(delta_magic)) == 0);
+}
+
+bool DisplayAppDeltaDecoder::Decode(const uint8_t * data, size_t size) {
+    uint16_t new_width;
+    uint16_t new_height;
+    int new_format;
+    int bpp;
+    uint32_t tile_w;
+    uint32_t tile_h;
+    uint32_t tile_num;
+    uint32_t i;
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t tw;
+    uint32_t th;
+    uint32_t method;
+    uint32_t data_size;
+    uint32_t pix_num;
+    uint32_t pix;
+    uint32_t count;
+    uint32_t frame_stride;
+    uint32_t x;
+    uint32_t y;
+    size_t pos;
+    size_t rd;
+    uint8_t c;
+    const uint8_t * p_src;
+
+    if (!IsDeltaFrame(data, size)) {
+        return false;
+    }
+    new_width  = (uint16_t)get_le16(&data[4]);
+    new_height = (uint16_t)get_le16(&data[6]);
+    new_format = data[8];
+    tile_w     = data[10];
+    tile_h     = data[11];
+    tile_num   = get_le16(&data[16]);
+    bpp = wire_bpp(new_format);
+    if ((bpp == 0) || (new_width == 0) || (new_height == 0) || (tile_w == 0) || (tile_h == 0)) {
+        return false;
+    }
+    if ((frame == NULL) || (new_width != width) || (new_height != height) || (new_format != (int)format)) {
+        // A delta frame can not be decoded without the key frame
+        if ((data[9] & FLAG_KEY_FRAME) == 0) {
+            return false;
+        }
+        free(frame);
+        frame = (uint8_t *)malloc((size_t)new_width * new_height * bpp);
+        if (frame == NULL) {
+            return false;
+        }
+        width  = new_width;
+        height = new_height;
+        format = (DisplayAppDeltaEncoder::wire_format_t)new_format;
+    }
+    frame_stride = (uint32_t)width * bpp;
+
+    pos = DISPLAY_APP_DELTA_HEADER_SIZE;
+    for (i = 0; i < tile_num; i++) {
+        if ((pos + DISPLAY_APP_DELTA_TILE_HEADER_SIZE) > size) {
+            return false;
+        }
+        x0 = get_le16(&data[pos + 0]) * tile_w;
+        y0 = get_le16(&data[pos + 2]) * tile_h;
+        method = data[pos + 7];
+        data_size = get_le32(&data[pos + 4]) & 0x00FFFFFF;
+        pos += DISPLAY_APP_DELTA_TILE_HEADER_SIZE;
+        if (((pos + data_size) > size) || (x0 >= width) || (y0 >= height)) {
+            return false;
+        }
+        tw = ((x0 + tile_w) <= width) ? tile_w : (width - x0);
+        th = ((y0 + tile_h) <= height) ? tile_h : (height - y0);
+        pix_num = tw * th;
+        p_src = &data[pos];
+
+        if (method == METHOD_RAW) {
+            if (data_size != (pix_num * bpp)) {
+                return false;
+            }
+            for (y = 0; y < th; y++) {
+                memcpy(&frame[(frame_stride * (y0 + y)) + (x0 * bpp)], &p_src[tw * bpp * y], tw * bpp);
+            }
+        } else if (method == METHOD_RLE) {
+            pix = 0;
+            rd = 0;
+            while (pix < pix_num) {
+                if (rd >= data_size) {
+                    return false;
+                }
+                c = p_src[rd++];
+                if (c < 0x80) {
+                    count = (uint32_t)c + 1;
+                    if (((rd + (count * bpp)) > data_size) || ((pix + count) > pix_num)) {
+                        return false;
+                    }
+                    while (count > 0) {
+                        x = pix % tw;
+                        y = pix / tw;
+                        memcpy(&frame[(frame_stride * (y0 + y)) + ((x0 + x) * bpp)], &p_src[rd], bpp);
+                        rd += bpp;
+                        pix++;
+                        count--;
+                    }
+                } else {
+                    count = (uint32_t)c - 0x7E;
+                    if (((rd + bpp) > data_size) || ((pix + count) > pix_num)) {
+                        return false;
+                    }
+                    while (count > 0) {
+                        x = pix % tw;
+                        y = pix / tw;
+                        memcpy(&frame[(frame_stride * (y0 + y)) + ((x0 + x) * bpp)], &p_src[rd], bpp);
+                        pix++;
+                        count--;
+                    }
+                    rd += bpp;
+                }
+            }
+        } else {
+            return false;
+        }
+        pos += data_size;
+    }
+    frame_no = get_le32(&data[12]);
+
+    return true;
+}
+
+void DisplayAppDeltaDecoder::ConvertToRgb888(uint8_t * dst) {
+    uint32_t num = (uint32_t)width * height;
+    uint32_t i;
+    uint32_t pix;
+    const uint8_t * p_src = frame;
+
+    if ((frame == NULL) || (dst == NULL)) {
+        return;
+    }
+    for (i = 0; i < num; i++) {
+        if (format == DisplayAppDeltaEncoder::WIRE_RGB565) {
+            pix = get_le16(p_src);
+            *dst++ = (uint8_t)(((pix << 3) & 0xF8) | ((pix >> 2) & 0x07));
+            *dst++ = (uint8_t)(((pix >> 3) & 0xFC) | ((pix >> 9) & 0x03));
+            *dst++ = (uint8_t)(((pix >> 8) & 0xF8) | (pix >> 13));
+            p_src += 2;
+        } else if (format == DisplayAppDeltaEncoder::WIRE_GRAY8) {
+            *dst++ = *p_src;
+            *dst++ = *p_src;
+            *dst++ = *p_src;
+            p_src += 1;
+        } else {
+            *dst++ = *p_src++;
+            *dst++ = *p_src++;
+            *dst++ = *p_src++;
+        }
+    }
+}
@@ -0,0 +1,239 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          DisplayAppDelta.h
+* @brief         DisplayApp delta frame encoder and decoder
+*
+* Delta frame format (little-endian) sent after the "FF FF AA 55" header
+*
+*   offset  size  contents
+*   0       4     'D' 'L' 'T' '1'
+*   4       2     width
+*   6       2     height
+*   8       1     wire format (0: RGB565, 1: gray scale 8bit, 2: RGB888 (B, G, R))
+*   9       1     flags (bit0: key frame, all tiles are included)
+*   10      1     tile width
+*   11      1     tile height
+*   12      4     frame number
+*   16      2     number of tiles
+*   18      2     reserved
+*   20      -     tiles
+*
+* Tile
+*   0       2     tile x (in tiles)
+*   2       2     tile y (in tiles)
+*   4       4     bit31-24: method (0: raw, 1: RLE), bit23-0: data size
+*   8       -     data (pixels of the tile from the top line, the tiles at the right and
+*                 bottom edges are clipped by the picture size)
+*
+* RLE
+*   control byte c = 0x00-0x7F : (c + 1) pixels follow
+*   control byte c = 0x80-0xFF : the following pixel is repeated (c - 0x7E) times
+*
+* The encoder and the decoder do not depend on mbed, so they can be built on a PC.
+******************************************************************************/
+
+#ifndef DISPLAY_APP_DELTA_H
+#define DISPLAY_APP_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DISPLAY_APP_DELTA_HEADER_SIZE       (20)
+#define DISPLAY_APP_DELTA_TILE_HEADER_SIZE  (8)
+
+/** A class to encode the difference from the previously sent frame
+ *
+ * The frame is divided into tiles, and only the tiles which have changed
+ * in the wire format are sent with RLE compression.
+ */
+class DisplayAppDeltaEncoder {
+public:
+    /*! @enum wire_format_t
+        @brief Pixel format on the USB
+     */
+    typedef enum {
+        WIRE_RGB565 = 0,                /*!< RGB565 (2byte / px) */
+        WIRE_GRAY8  = 1,                /*!< Gray scale (1byte / px) */
+        WIRE_RGB888 = 2,                /*!< RGB888 (3byte / px, B G R) */
+    } wire_format_t;
+
+    /*! @enum input_format_t
+        @brief Pixel format of the frame buffer
+     */
+    typedef enum {
+        INPUT_ARGB8888 = 0,             /*!< ARGB8888 (4byte / px, the same as SendRgb888) */
+        INPUT_RGB565   = 1,             /*!< RGB565 (2byte / px) */
+    } input_format_t;
+
+    /*! @struct stats_t
+        @brief Encode statistics
+     */
+    typedef struct {
+        uint32_t    frames;             /*!< Number of encoded frames */
+        uint32_t    key_frames;         /*!< Number of key frames */
+        uint32_t    tiles_total;        /*!< Number of tiles checked */
+        uint32_t    tiles_sent;         /*!< Number of tiles sent */
+        uint64_t    raw_bytes;          /*!< Size of the frames in the wire format */
+        uint64_t    encoded_bytes;      /*!< Size of the encoded data */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param tile_width tile width (pixel)
+     * @param tile_height tile height (line)
+     */
+    DisplayAppDeltaEncoder(uint8_t tile_width = 32, uint8_t tile_height = 32);
+
+    /** Destructor
+     */
+    virtual ~DisplayAppDeltaEncoder();
+
+    /** Send all tiles in the next frame
+     */
+    void ForceKeyFrame(void);
+
+    /** Get the maximum size of the encoded data
+     *
+     * @param width picture width
+     * @param height picture height
+     * @param wire_format wire format
+     * @return size (byte)
+     */
+    size_t GetMaxEncodeSize(uint16_t width, uint16_t height, wire_format_t wire_format);
+
+    /** Encode a frame
+     *
+     * @param buf frame buffer
+     * @param stride line offset of the frame buffer (byte)
+     * @param width picture width
+     * @param height picture height
+     * @param input_format format of the frame buffer
+     * @param wire_format wire format
+     * @param out output buffer
+     * @param out_size size of the output buffer
+     * @return size of the encoded data, -1 = failure (the next frame is encoded as a key frame)
+     */
+    int Encode(const uint8_t * buf, uint32_t stride, uint16_t width, uint16_t height, input_format_t input_format,
+               wire_format_t wire_format, uint8_t * out, size_t out_size);
+
+    /** Get the encode statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+private:
+    uint8_t tile_w;
+    uint8_t tile_h;
+    uint8_t * prev_frame;               /* previous frame in the wire format */
+    uint8_t * tile_buf;
+    uint16_t prev_width;
+    uint16_t prev_height;
+    wire_format_t prev_format;
+    bool key_request;
+    uint32_t frame_no;
+    stats_t stats;
+
+    void convert_line(const uint8_t * src, input_format_t input_format, wire_format_t wire_format,
+                      uint8_t * dst, int num);
+};
+
+/** A reference decoder of the delta frames
+ *
+ * Keeps the decoded frame in the wire format.
+ */
+class DisplayAppDeltaDecoder {
+public:
+    /** Constructor
+     */
+    DisplayAppDeltaDecoder();
+
+    /** Destructor
+     */
+    virtual ~DisplayAppDeltaDecoder();
+
+    /** Check if the data is a delta frame
+     *
+     * @param data data following the "FF FF AA 55" header
+     * @param size data size
+     * @return true = delta frame, false = other (BMP, JPEG)
+     */
+    static bool IsDeltaFrame(const uint8_t * data, size_t size);
+
+    /** Decode a delta frame
+     *
+     * @param data delta frame
+     * @param size data size
+     * @return true = success, false = failure (format error, or a delta frame without the key frame)
+     */
+    bool Decode(const uint8_t * data, size_t size);
+
+    /** Get the decoded frame
+     *
+     * @return frame in the wire format (width x height, no padding), NULL = no frame
+     */
+    const uint8_t * GetFrame(void) {
+        return frame;
+    }
+
+    /** Get the picture width
+     *
+     * @return width
+     */
+    uint16_t GetWidth(void) {
+        return width;
+    }
+
+    /** Get the picture height
+     *
+     * @return height
+     */
+    uint16_t GetHeight(void) {
+        return height;
+    }
+
+    /** Get the wire format
+     *
+     * @return wire format
+     */
+    DisplayAppDeltaEncoder::wire_format_t GetFormat(void) {
+        return format;
+    }
+
+    /** Get the frame number of the last decoded frame
+     *
+     * @return frame number
+     */
+    uint32_t GetFrameNo(void) {
+        return frame_no;
+    }
+
+    /** Convert the decoded frame to RGB888 (B, G, R)
+     *
+     * @param dst output buffer (width x height x 3 byte)
+     */
+    void ConvertToRgb888(uint8_t * dst);
+
+private:
+    uint8_t * frame;
+    uint16_t width;
+    uint16_t height;
+    DisplayAppDeltaEncoder::wire_format_t format;
+    uint32_t frame_no;
+};
+
+#endif
@@ -0,0 +1,275 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "DisplayAppHost.h"
+
+#define SYNC_SIZE       (8)
+#define BMP_HEADER_SIZE (54)
+
+static const uint8_t frame_sync[SYNC_SIZE] = {0xFF, 0xFF, 0xAA, 0x55, 0x00, 0x00, 0x00, 0x00};
+
+static inline uint32_t get_le16(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t get_be16(const uint8_t * p) {
+    return ((uint32_t)p[0] << 8) | (uint32_t)p[1];
+}
+
+static void verify_jpeg(const uint8_t * data, uint32_t size, DisplayAppHostEndpoint::frame_info_t * p_frame) {
+    uint32_t pos = 2;
+    uint8_t marker;
+
+    if ((size < 4) || (data[size - 2] != 0xFF) || (data[size - 1] != 0xD9)) {
+        return;
+    }
+    while ((pos + 4) <= size) {
+        if (data[pos] != 0xFF) {
+            return;
+        }
+        marker = data[pos + 1];
+        if (marker == 0xFF) {
+            pos++;
+        } else if ((marker == 0x01) || ((marker >= 0xD0) && (marker <= 0xD8))) {
+            pos += 2;
+        } else if (marker == 0xDA) {
+            // SOS: the size is known
+            p_frame->valid = (p_frame->width != 0) && (p_frame->height != 0);
+            return;
+        } else {
+            if ((marker >= 0xC0) && (marker <= 0xCF) && (marker != 0xC4) && (marker != 0xC8) && (marker != 0xCC)) {
+                if ((pos + 9) > size) {
+                    return;
+                }
+                p_frame->height = get_be16(&data[pos + 5]);
+                p_frame->width  = get_be16(&data[pos + 7]);
+            }
+            pos += 2 + get_be16(&data[pos + 2]);
+        }
+    }
+}
+
+static void verify_bmp(const uint8_t * data, uint32_t size, DisplayAppHostEndpoint::frame_info_t * p_frame) {
+    uint32_t off_bits;
+    uint32_t image_size;
+    int32_t height;
+
+    if (size < BMP_HEADER_SIZE) {
+        return;
+    }
+    off_bits   = get_le32(&data[10]);
+    image_size = get_le32(&data[34]);
+    height     = (int32_t)get_le32(&data[22]);
+    p_frame->width  = get_le32(&data[18]);
+    p_frame->height = (height < 0) ? (uint32_t)(-height) : (uint32_t)height;
+    if ((get_le32(&data[2]) != size) || (get_le32(&data[14]) != 40) || (get_le16(&data[28]) != 32)
+     || (off_bits < BMP_HEADER_SIZE) || (off_bits > size) || ((size - off_bits) != image_size)) {
+        return;
+    }
+    if (((uint64_t)p_frame->width * 4 * p_frame->height) > image_size) {
+        return;
+    }
+    p_frame->valid = true;
+}
+
+DisplayAppHostEndpoint::DisplayAppHostEndpoint(uint32_t max_frame_size) :
+  frame_buf(NULL), frame_buf_size(0), max_size(max_frame_size), frame_func(NULL), frame_user(NULL) {
+    Reset();
+}
+
+DisplayAppHostEndpoint::~DisplayAppHostEndpoint() {
+    free(frame_buf);
+}
+
+void DisplayAppHostEndpoint::SetFrameFunc(frame_func_t func, void * p_user) {
+    frame_func = func;
+    frame_user = p_user;
+}
+
+void DisplayAppHostEndpoint::Reset(void) {
+    header_pos = 0;
+    data_size = 0;
+    data_pos = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DisplayAppHostEndpoint::GetStats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = stats;
+    }
+}
+
+void DisplayAppHostEndpoint::Feed(const uint8_t * data, size_t size) {
+    size_t i = 0;
+    uint32_t num;
+    uint8_t c;
+
+    if (data == NULL) {
+        return;
+    }
+    stats.bytes += size;
+    while (i < size) {
+        if (header_pos < SYNC_SIZE) {
+            c = data[i++];
+            if (c == frame_sync[header_pos]) {
+                header[header_pos++] = c;
+            } else {
+                stats.sync_errors++;
+                if ((c == 0xFF) && (header_pos != 1)) {
+                    header_pos = (header_pos == 2) ? 2 : 1;
+                } else {
+                    header_pos = 0;
+                }
+            }
+        } else if (header_pos < DISPLAY_APP_HOST_FRAME_HEADER_SIZE) {
+            header[header_pos++] = data[i++];
+            if (header_pos == DISPLAY_APP_HOST_FRAME_HEADER_SIZE) {
+                data_size = get_le32(&header[SYNC_SIZE]);
+                data_pos = 0;
+                if ((data_size <= max_size) && (data_size > frame_buf_size)) {
+                    free(frame_buf);
+                    frame_buf = (uint8_t *)malloc(data_size);
+                    frame_buf_size = (frame_buf != NULL) ? data_size : 0;
+                }
+                if (data_size == 0) {
+                    frame_received();
+                }
+            }
+        } else {
+            num = data_size - data_pos;
+            if (num > (size - i)) {
+                num = (uint32_t)(size - i);
+            }
+            if (data_size <= frame_buf_size) {
+                memcpy(&frame_buf[data_pos], &data[i], num);
+            }
+            data_pos += num;
+            i += num;
+            if (data_pos == data_size) {
+                frame_received();
+            }
+        }
+    }
+}
+
+void DisplayAppHostEndpoint::frame_received(void) {
+    frame_info_t frame;
+
+    header_pos = 0;
+    if (data_size > frame_buf_size) {
+        // Too large, or no memory
+        frame.type   = FRAME_UNKNOWN;
+        frame.valid  = false;
+        frame.data   = NULL;
+        frame.size   = data_size;
+        frame.width  = 0;
+        frame.height = 0;
+    } else {
+        VerifyFrame(frame_buf, data_size, &frame, &delta_decoder);
+    }
+
+    stats.frames++;
+    if (frame.type == FRAME_JPEG) {
+        stats.jpeg_frames++;
+    } else if (frame.type == FRAME_BMP) {
+        stats.bmp_frames++;
+    } else if (frame.type == FRAME_DELTA) {
+        stats.delta_frames++;
+    } else {
+        // do nothing
+    }
+    if (!frame.valid) {
+        stats.invalid_frames++;
+    }
+    if (frame_func != NULL) {
+        frame_func(frame_user, &frame);
+    }
+}
+
+void DisplayAppHostEndpoint::VerifyFrame(const uint8_t * data, uint32_t size, frame_info_t * p_frame,
+                                         DisplayAppDeltaDecoder * p_decoder) {
+    p_frame->type   = FRAME_UNKNOWN;
+    p_frame->valid  = false;
+    p_frame->data   = data;
+    p_frame->size   = size;
+    p_frame->width  = 0;
+    p_frame->height = 0;
+
+    if ((data == NULL) || (size < 2)) {
+        return;
+    }
+    if ((data[0] == 0xFF) && (data[1] == 0xD8)) {
+        p_frame->type = FRAME_JPEG;
+        verify_jpeg(data, size, p_frame);
+    } else if ((data[0] == 'B') && (data[1] == 'M')) {
+        p_frame->type = FRAME_BMP;
+        verify_bmp(data, size, p_frame);
+    } else if (DisplayAppDeltaDecoder::IsDeltaFrame(data, size)) {
+        p_frame->type   = FRAME_DELTA;
+        p_frame->width  = get_le16(&data[4]);
+        p_frame->height = get_le16(&data[6]);
+        if (p_decoder != NULL) {
+            p_frame->valid = p_decoder->Decode(data, size);
+        } else {
+            p_frame->valid = true;
+        }
+    } else {
+        // do nothing
+    }
+}
+
+int DisplayAppHostEndpoint::MakeTouchMessage(const DisplayAppTouchParser::touch_event_t * p_touch, int num,
+                                             bool with_timestamp, char * buf, size_t buf_size) {
+    size_t pos = 0;
+    int len;
+    int x;
+    int y;
+    int i;
+
+    if ((p_touch == NULL) || (buf == NULL) || (num <= 0) || (num > DISPLAY_APP_TOUCH_MAX)) {
+        return -1;
+    }
+    for (i = 0; i < num; i++) {
+        x = p_touch[i].valid ? (int)p_touch[i].x : -1;
+        y = p_touch[i].valid ? (int)p_touch[i].y : -1;
+        if ((num == 1) && (p_touch[i].id == 0)) {
+            len = snprintf(&buf[pos], buf_size - pos, "{X=%d,Y=%d", x, y);
+        } else {
+            len = snprintf(&buf[pos], buf_size - pos, "%cI=%d,X=%d,Y=%d", (i == 0) ? '{' : ';', p_touch[i].id, x, y);
+        }
+        if ((len < 0) || ((size_t)len >= (buf_size - pos))) {
+            return -1;
+        }
+        pos += len;
+    }
+    if (with_timestamp) {
+        len = snprintf(&buf[pos], buf_size - pos, ",T=%lu}", (unsigned long)p_touch[0].timestamp);
+    } else {
+        len = snprintf(&buf[pos], buf_size - pos, "}");
+    }
+    if ((len < 0) || ((size_t)len >= (buf_size - pos))) {
+        return -1;
+    }
+    pos += len;
+
+    return (int)pos;
+}
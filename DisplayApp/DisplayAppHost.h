@@ -0,0 +1,196 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          DisplayAppHost.h
+* @brief         PC side endpoint of the DisplayApp protocol
+*
+* Frame (board to PC)
+*
+*   offset  size  contents
+*   0       8     FF FF AA 55 00 00 00 00
+*   8       4     data size (little-endian)
+*   12      -     data (JPEG, BMP (32bit, top-down) or delta frame of DisplayAppDelta.h)
+*
+* Touch message (PC to board) : see DisplayAppTouch.h
+*
+* The endpoint does not depend on mbed. It can be used on a PC to receive the data of
+* a serial port, a pty or a pipe, to verify the frames and to make the touch messages.
+* tools/display_app_host.cpp is the tool for Linux, and tools/display_app_loopback.cpp measures DisplayApp
+* built with a mock USBSerial on the host. The tools are excluded from the mbed build by .mbedignore.
+******************************************************************************/
+
+#ifndef DISPLAY_APP_HOST_H
+#define DISPLAY_APP_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DisplayAppDelta.h"
+#include "DisplayAppTouch.h"
+
+#define DISPLAY_APP_HOST_FRAME_HEADER_SIZE  (12)
+
+/** A class to receive and verify the frames sent by DisplayApp
+ *
+ * Example
+ * @code
+ * #include <stdio.h>
+ * #include <unistd.h>
+ * #include "DisplayAppHost.h"
+ *
+ * static void frame_received(void * p_user, const DisplayAppHostEndpoint::frame_info_t * p_frame) {
+ *     printf("type %d %dx%d %s\n", p_frame->type, p_frame->width, p_frame->height, p_frame->valid ? "OK" : "NG");
+ * }
+ *
+ * int main() {
+ *     DisplayAppHostEndpoint endpoint;
+ *     uint8_t buf[4096];
+ *     ssize_t size;
+ *
+ *     endpoint.SetFrameFunc(&frame_received, NULL);
+ *     while ((size = read(0, buf, sizeof(buf))) > 0) {
+ *         endpoint.Feed(buf, size);
+ *     }
+ * }
+ * @endcode
+ */
+class DisplayAppHostEndpoint {
+public:
+    /*! @enum frame_type_t
+        @brief Kind of frame
+     */
+    typedef enum {
+        FRAME_JPEG    = 0,              /*!< JPEG (SendJpeg) */
+        FRAME_BMP     = 1,              /*!< BMP (SendRgb888) */
+        FRAME_DELTA   = 2,              /*!< Delta frame (SendDelta) */
+        FRAME_UNKNOWN = 3,              /*!< Other */
+    } frame_type_t;
+
+    /*! @struct frame_info_t
+        @brief Received frame
+     */
+    typedef struct {
+        frame_type_t    type;           /*!< Kind of frame */
+        bool            valid;          /*!< true = the format was verified */
+        const uint8_t * data;           /*!< Data following the frame header */
+        uint32_t        size;           /*!< Data size */
+        uint32_t        width;          /*!< Picture width (0: unknown) */
+        uint32_t        height;         /*!< Picture height (0: unknown) */
+    } frame_info_t;
+
+    /*! @struct stats_t
+        @brief Receive statistics
+     */
+    typedef struct {
+        uint32_t    frames;             /*!< Number of received frames */
+        uint32_t    jpeg_frames;        /*!< Number of JPEG frames */
+        uint32_t    bmp_frames;         /*!< Number of BMP frames */
+        uint32_t    delta_frames;       /*!< Number of delta frames */
+        uint32_t    invalid_frames;     /*!< Number of frames which failed the verification */
+        uint32_t    sync_errors;        /*!< Number of unexpected bytes before a frame header */
+        uint64_t    bytes;              /*!< Number of received bytes */
+    } stats_t;
+
+    /** Function to receive a frame
+     *
+     * @param p_user user data
+     * @param p_frame frame (valid only while the function is called)
+     */
+    typedef void (* frame_func_t)(void * p_user, const frame_info_t * p_frame);
+
+    /** Constructor
+     *
+     * @param max_frame_size maximum data size of a frame (larger frames are skipped)
+     */
+    DisplayAppHostEndpoint(uint32_t max_frame_size = (4 * 1024 * 1024));
+
+    /** Destructor
+     */
+    virtual ~DisplayAppHostEndpoint();
+
+    /** Set the function to receive the frames
+     *
+     * @param func function (NULL: none)
+     * @param p_user user data of func
+     */
+    void SetFrameFunc(frame_func_t func, void * p_user);
+
+    /** Parse bytes received from the board
+     *
+     * @param data received bytes
+     * @param size number of bytes
+     */
+    void Feed(const uint8_t * data, size_t size);
+
+    /** Get the receive statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+    /** Clear the statistics and the receive state
+     */
+    void Reset(void);
+
+    /** Get the decoder of the delta frames
+     *
+     * @return decoder which holds the last decoded frame
+     */
+    DisplayAppDeltaDecoder * GetDeltaDecoder(void) {
+        return &delta_decoder;
+    }
+
+    /** Verify a frame
+     *
+     * @param data data following the frame header
+     * @param size data size
+     * @param p_frame frame information
+     * @param p_decoder decoder for the delta frames (NULL: the delta frames are not decoded)
+     */
+    static void VerifyFrame(const uint8_t * data, uint32_t size, frame_info_t * p_frame,
+                            DisplayAppDeltaDecoder * p_decoder);
+
+    /** Make a touch message
+     *
+     * One point of id 0 without a timestamp is made in the format of the previous DisplayApp ("{X=..,Y=..}").
+     * A released point (valid = false) is sent as X=-1,Y=-1.
+     *
+     * @param p_touch touch points
+     * @param num number of points (1 - DISPLAY_APP_TOUCH_MAX)
+     * @param with_timestamp true = add the timestamp of p_touch[0]
+     * @param buf output buffer
+     * @param buf_size size of buf
+     * @return length of the message (not including '\0'), -1 = failure
+     */
+    static int MakeTouchMessage(const DisplayAppTouchParser::touch_event_t * p_touch, int num, bool with_timestamp,
+                                char * buf, size_t buf_size);
+
+private:
+    uint8_t * frame_buf;
+    uint32_t frame_buf_size;
+    uint32_t max_size;
+    int header_pos;
+    uint32_t data_size;
+    uint32_t data_pos;
+    uint8_t header[DISPLAY_APP_HOST_FRAME_HEADER_SIZE];
+    stats_t stats;
+    frame_func_t frame_func;
+    void * frame_user;
+    DisplayAppDeltaDecoder delta_decoder;
+
+    void frame_received(void);
+};
+
+#endif
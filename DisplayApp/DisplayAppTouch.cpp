@@ -0,0 +1,262 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "DisplayAppTouch.h"
+
+/* Character classes */
+enum {
+    C_OPEN,         /* '{' */
+    C_CLOSE,        /* '}' */
+    C_KEY,          /* 'X' 'Y' 'I' 'T' */
+    C_EQ,           /* '=' */
+    C_MINUS,        /* '-' */
+    C_DIGIT,        /* '0' - '9' */
+    C_COMMA,        /* ',' */
+    C_SEMI,         /* ';' */
+    C_OTHER,
+    C_NUM
+};
+
+/* States */
+enum {
+    ST_IDLE,        /* waiting for '{' */
+    ST_KEY,         /* waiting for a key */
+    ST_EQ,          /* waiting for '=' */
+    ST_SIGN,        /* waiting for '-' or a digit */
+    ST_DIGIT1,      /* waiting for the first digit after '-' */
+    ST_VALUE,       /* in the digits */
+    ST_NUM
+};
+
+/* Actions */
+enum {
+    A_NONE,
+    A_START,        /* start a message */
+    A_KEY,          /* start a field */
+    A_NEG,
+    A_DIGIT,
+    A_FIELD,        /* end of a field */
+    A_POINT,        /* end of a point */
+    A_END,          /* end of a message */
+    A_ERROR
+};
+
+#define FIELD_X             (0x01)
+#define FIELD_Y             (0x02)
+#define FIELD_I             (0x04)
+#define VALUE_MAX           (0xFFFFFFFFu)
+
+#define TR(next, action)    (uint8_t)(((next) << 4) | (action))
+
+static const uint8_t transition_table[ST_NUM][C_NUM] = {
+    /*              C_OPEN                C_CLOSE              C_KEY               C_EQ                 C_MINUS                C_DIGIT               C_COMMA              C_SEMI               C_OTHER */
+    /* ST_IDLE   */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_NONE),  TR(ST_IDLE, A_NONE), TR(ST_IDLE, A_NONE),  TR(ST_IDLE, A_NONE),    TR(ST_IDLE, A_NONE),   TR(ST_IDLE, A_NONE),  TR(ST_IDLE, A_NONE),  TR(ST_IDLE, A_NONE)},
+    /* ST_KEY    */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_ERROR), TR(ST_EQ, A_KEY),    TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR),   TR(ST_IDLE, A_ERROR),  TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR)},
+    /* ST_EQ     */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_SIGN, A_NONE),  TR(ST_IDLE, A_ERROR),   TR(ST_IDLE, A_ERROR),  TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR)},
+    /* ST_SIGN   */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_DIGIT1, A_NEG),   TR(ST_VALUE, A_DIGIT), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR)},
+    /* ST_DIGIT1 */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR),   TR(ST_VALUE, A_DIGIT), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR)},
+    /* ST_VALUE  */ {TR(ST_KEY, A_START), TR(ST_IDLE, A_END),   TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR), TR(ST_IDLE, A_ERROR),   TR(ST_VALUE, A_DIGIT), TR(ST_KEY, A_FIELD),  TR(ST_KEY, A_POINT),  TR(ST_IDLE, A_ERROR)},
+};
+
+static inline int char_class(uint8_t c) {
+    if ((c >= '0') && (c <= '9')) {
+        return C_DIGIT;
+    }
+    switch (c) {
+        case '{': return C_OPEN;
+        case '}': return C_CLOSE;
+        case 'X':
+        case 'Y':
+        case 'I':
+        case 'T': return C_KEY;
+        case '=': return C_EQ;
+        case '-': return C_MINUS;
+        case ',': return C_COMMA;
+        case ';': return C_SEMI;
+        default:  return C_OTHER;
+    }
+}
+
+DisplayAppTouchParser::DisplayAppTouchParser() : batch_func(NULL), batch_user(NULL) {
+    Reset();
+}
+
+void DisplayAppTouchParser::SetBatchFunc(batch_func_t func, void * p_user) {
+    batch_func = func;
+    batch_user = p_user;
+}
+
+void DisplayAppTouchParser::Reset(void) {
+    int i;
+
+    state = ST_IDLE;
+    point_num = 0;
+    event_num = 0;
+    error_count = 0;
+    for (i = 0; i < DISPLAY_APP_TOUCH_MAX; i++) {
+        touch[i].id        = (uint8_t)i;
+        touch[i].valid     = false;
+        touch[i].x         = -1;
+        touch[i].y         = -1;
+        touch[i].timestamp = 0;
+    }
+}
+
+void DisplayAppTouchParser::Feed(const uint8_t * data, size_t size, uint32_t now_ms) {
+    uint8_t entry;
+    size_t i;
+
+    if (data == NULL) {
+        return;
+    }
+    for (i = 0; i < size; i++) {
+        entry = transition_table[state][char_class(data[i])];
+        state = entry >> 4;
+        if (!do_action(entry & 0x0F, data[i], now_ms)) {
+            state = ST_IDLE;
+            error_count++;
+        }
+    }
+    flush_events();
+}
+
+int DisplayAppTouchParser::GetTouches(int buff_num, touch_event_t * p_touch) {
+    int count = 0;
+    int i;
+
+    for (i = 0; (i < DISPLAY_APP_TOUCH_MAX) && (count < buff_num); i++) {
+        if (touch[i].valid) {
+            p_touch[count++] = touch[i];
+        }
+    }
+
+    return count;
+}
+
+bool DisplayAppTouchParser::do_action(uint8_t action, uint8_t c, uint32_t now_ms) {
+    switch (action) {
+        case A_START:
+            point_num = 0;
+            points[0].fields = 0;
+            points[0].id = 0;
+            has_timestamp = false;
+            break;
+        case A_KEY:
+            key = (char)c;
+            negative = false;
+            value = 0;
+            break;
+        case A_NEG:
+            negative = true;
+            break;
+        case A_DIGIT:
+            if (value <= ((VALUE_MAX - (c - '0')) / 10)) {
+                value = (value * 10) + (c - '0');
+            }
+            break;
+        case A_FIELD:
+            return store_field();
+        case A_POINT:
+            return store_field() && end_point();
+        case A_END:
+            if ((!store_field()) || (!end_point())) {
+                return false;
+            }
+            end_message(now_ms);
+            break;
+        case A_ERROR:
+            return false;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+bool DisplayAppTouchParser::store_field(void) {
+    point_t * p_point;
+    int32_t wk_value = negative ? -(int32_t)value : (int32_t)value;
+
+    if (point_num >= DISPLAY_APP_TOUCH_MAX) {
+        return false;
+    }
+    p_point = &points[point_num];
+    if (key == 'X') {
+        p_point->x = wk_value;
+        p_point->fields |= FIELD_X;
+    } else if (key == 'Y') {
+        p_point->y = wk_value;
+        p_point->fields |= FIELD_Y;
+    } else if (key == 'I') {
+        if ((wk_value < 0) || (wk_value >= DISPLAY_APP_TOUCH_MAX)) {
+            return false;
+        }
+        p_point->id = wk_value;
+        p_point->fields |= FIELD_I;
+    } else {
+        timestamp = (uint32_t)wk_value;
+        has_timestamp = true;
+    }
+
+    return true;
+}
+
+bool DisplayAppTouchParser::end_point(void) {
+    if ((points[point_num].fields & (FIELD_X | FIELD_Y)) != (FIELD_X | FIELD_Y)) {
+        return false;
+    }
+    point_num++;
+    if (point_num < DISPLAY_APP_TOUCH_MAX) {
+        points[point_num].fields = 0;
+        points[point_num].id = 0;
+    }
+
+    return true;
+}
+
+void DisplayAppTouchParser::end_message(uint32_t now_ms) {
+    touch_event_t * p_touch;
+    point_t * p_point;
+    bool valid;
+    int i;
+
+    for (i = 0; i < point_num; i++) {
+        p_point = &points[i];
+        p_touch = &touch[p_point->id];
+        valid = (p_point->x >= 0) || (p_point->y >= 0);
+        if ((p_touch->valid == valid) && (p_touch->x == p_point->x) && (p_touch->y == p_point->y)) {
+            continue;
+        }
+        p_touch->valid     = valid;
+        p_touch->x         = p_point->x;
+        p_touch->y         = p_point->y;
+        p_touch->timestamp = has_timestamp ? timestamp : now_ms;
+        if (event_num >= DISPLAY_APP_TOUCH_EVENT_MAX) {
+            flush_events();
+        }
+        events[event_num++] = *p_touch;
+    }
+    point_num = 0;
+}
+
+void DisplayAppTouchParser::flush_events(void) {
+    if (event_num > 0) {
+        if (batch_func != NULL) {
+            batch_func(batch_user, events, event_num);
+        }
+        event_num = 0;
+    }
+}
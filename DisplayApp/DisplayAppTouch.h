@@ -0,0 +1,147 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          DisplayAppTouch.h
+* @brief         DisplayApp touch message parser
+*
+* Touch message (ASCII)
+*
+*   message := '{' point (';' point)* '}'
+*   point   := field (',' field)*
+*   field   := key '=' ['-'] digits
+*
+*   key  X : x-coordinate (-1: released)
+*        Y : y-coordinate (-1: released)
+*        I : touch id (0 - DISPLAY_APP_TOUCH_MAX - 1, default 0)
+*        T : timestamp of the message (ms, default: time of the reception)
+*
+* "{X=10,Y=20}" of the previous DisplayApp is a message of one point with id 0.
+* Multi-touch example : "{I=0,X=10,Y=20;I=1,X=200,Y=120,T=5230}"
+*
+* The parser does not depend on mbed, so it can be tested on a PC by feeding byte streams.
+******************************************************************************/
+
+#ifndef DISPLAY_APP_TOUCH_H
+#define DISPLAY_APP_TOUCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** The maximum number of simultaneous touches */
+#ifndef DISPLAY_APP_TOUCH_MAX
+#define DISPLAY_APP_TOUCH_MAX       (5)
+#endif
+
+/** The maximum number of events in a batch */
+#ifndef DISPLAY_APP_TOUCH_EVENT_MAX
+#define DISPLAY_APP_TOUCH_EVENT_MAX (16)
+#endif
+
+/** A class to parse the touch messages from the DisplayApp
+ *
+ * The received bytes are classified and parsed by a state transition table.
+ * When a message changes the state of a touch point, an event is made.
+ * The events made by one Feed() are delivered together as a batch.
+ */
+class DisplayAppTouchParser {
+public:
+    /** Touch event */
+    typedef struct {
+        uint8_t  id;                    /**< Touch id. */
+        bool     valid;                 /**< true = touched, false = released. */
+        int32_t  x;                     /**< The position of the x-coordinate. */
+        int32_t  y;                     /**< The position of the y-coordinate. */
+        uint32_t timestamp;             /**< Timestamp (ms). */
+    } touch_event_t;
+
+    /** Function to receive a batch of events
+     *
+     * @param p_user user data
+     * @param p_events events (in the received order)
+     * @param num number of events
+     */
+    typedef void (* batch_func_t)(void * p_user, const touch_event_t * p_events, int num);
+
+    /** Constructor
+     */
+    DisplayAppTouchParser();
+
+    /** Set the function to receive the batches
+     *
+     * @param func function (NULL: none)
+     * @param p_user user data of func
+     */
+    void SetBatchFunc(batch_func_t func, void * p_user);
+
+    /** Parse received bytes
+     *
+     * @param data received bytes
+     * @param size number of bytes
+     * @param now_ms time of the reception (ms), used when the message has no timestamp
+     */
+    void Feed(const uint8_t * data, size_t size, uint32_t now_ms);
+
+    /** Get the current touch points
+     *
+     * @param buff_num number of p_touch
+     * @param p_touch touch points (the touched points in the order of id)
+     * @return number of the touched points
+     */
+    int GetTouches(int buff_num, touch_event_t * p_touch);
+
+    /** Get the number of format errors
+     *
+     * @return number of errors
+     */
+    uint32_t GetErrorCount(void) {
+        return error_count;
+    }
+
+    /** Release all touch points and clear the parser state
+     */
+    void Reset(void);
+
+private:
+    typedef struct {
+        uint8_t  fields;
+        int32_t  id;
+        int32_t  x;
+        int32_t  y;
+    } point_t;
+
+    uint8_t state;
+    char key;
+    bool negative;
+    uint32_t value;
+    point_t points[DISPLAY_APP_TOUCH_MAX];
+    int point_num;
+    bool has_timestamp;
+    uint32_t timestamp;
+    touch_event_t touch[DISPLAY_APP_TOUCH_MAX];
+    touch_event_t events[DISPLAY_APP_TOUCH_EVENT_MAX];
+    int event_num;
+    uint32_t error_count;
+    batch_func_t batch_func;
+    void * batch_user;
+
+    bool do_action(uint8_t action, uint8_t c, uint32_t now_ms);
+    bool store_field(void);
+    bool end_point(void);
+    void end_message(uint32_t now_ms);
+    void flush_events(void);
+};
+
+#endif
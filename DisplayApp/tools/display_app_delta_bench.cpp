@@ -0,0 +1,245 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          display_app_delta_bench.cpp
+* @brief         Compression ratio and encode cost of DisplayAppDeltaEncoder on a Linux host
+*
+* Sequences of ARGB8888 frames typical of a UI are encoded for each wire format and tile size.
+* The compression ratio (the size of the frames in the wire format / the encoded size), the
+* average size of a frame, the ratio of the sent tiles and the encode / decode time of a frame
+* are printed. Every frame is decoded by DisplayAppDeltaDecoder and compared with the frame
+* converted to the wire format.
+*
+* Build (from DisplayApp/):
+*   g++ -O2 -I. -o display_app_delta_bench tools/display_app_delta_bench.cpp DisplayAppDelta.cpp
+*
+* Usage:
+*   display_app_delta_bench [-n frames] [-s width height]
+*     -n  number of frames of each sequence (default 200)
+*     -s  picture size (default 480 272)
+*
+* The exit status is 1 if a frame is not decoded to the same picture.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "DisplayAppDelta.h"
+
+static uint32_t pic_w = 480;
+static uint32_t pic_h = 272;
+static uint32_t pic_stride;
+
+typedef void (*scene_func_t)(uint8_t * buf, int frame);
+
+static inline void put_pixel(uint8_t * buf, uint32_t x, uint32_t y, uint32_t rgb) {
+    uint8_t * p = &buf[(pic_stride * y) + (x * 4)];
+
+    p[0] = (uint8_t)rgb;
+    p[1] = (uint8_t)(rgb >> 8);
+    p[2] = (uint8_t)(rgb >> 16);
+    p[3] = 0xFF;
+}
+
+static void fill(uint8_t * buf, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, uint32_t rgb) {
+    uint32_t x;
+    uint32_t y;
+
+    for (y = y0; (y < (y0 + h)) && (y < pic_h); y++) {
+        for (x = x0; (x < (x0 + w)) && (x < pic_w); x++) {
+            put_pixel(buf, x, y, rgb);
+        }
+    }
+}
+
+/* The same picture in every frame */
+static void scene_static(uint8_t * buf, int frame) {
+    (void)frame;
+    fill(buf, 0, 0, pic_w, pic_h, 0x304050);
+    fill(buf, 20, 20, pic_w / 2, pic_h / 2, 0xC0C0C0);
+}
+
+/* A cursor of 16 x 16 moving on a gradient */
+static void scene_cursor(uint8_t * buf, int frame) {
+    uint32_t cx = ((uint32_t)frame * 5) % (pic_w - 16);
+    uint32_t cy = ((uint32_t)frame * 3) % (pic_h - 16);
+    uint32_t x;
+    uint32_t y;
+
+    for (y = 0; y < pic_h; y++) {
+        for (x = 0; x < pic_w; x++) {
+            put_pixel(buf, x, y, ((x * 255 / pic_w) << 16) | ((y * 255 / pic_h) << 8) | 0x40);
+        }
+    }
+    fill(buf, cx, cy, 16, 16, 0xFFFFFF);
+}
+
+/* A text-like pattern scrolled by 1 line each frame */
+static void scene_scroll(uint8_t * buf, int frame) {
+    uint32_t x;
+    uint32_t y;
+
+    for (y = 0; y < pic_h; y++) {
+        uint32_t line = y + (uint32_t)frame;
+
+        for (x = 0; x < pic_w; x++) {
+            bool ink = ((line % 12) < 8) && ((((x / 6) * 7 + (line / 12) * 13) % 5) != 0)
+                    && ((((x * 3) ^ (line * 5)) & 0x06) != 0) && ((x % 6) != 5);
+
+            put_pixel(buf, x, y, ink ? 0x000000 : 0xF0F0F0);
+        }
+    }
+}
+
+/* A progress bar, a clock and a blinking icon on a static screen */
+static void scene_widgets(uint8_t * buf, int frame) {
+    scene_static(buf, 0);
+    fill(buf, 10, pic_h - 30, ((uint32_t)frame * 2) % (pic_w - 20), 16, 0x20C020);
+    fill(buf, pic_w - 70, 4, 60, 20, 0x000000);
+    fill(buf, pic_w - 70 + ((uint32_t)(frame / 10) % 6) * 10, 8, 8, 12, 0xFFFF00);
+    if (((frame / 15) % 2) != 0) {
+        fill(buf, pic_w - 40, pic_h / 2, 24, 24, 0xFF2020);
+    }
+}
+
+/* Noise in every pixel (camera image, the worst case) */
+static void scene_noise(uint8_t * buf, int frame) {
+    uint32_t seed = 1u + (uint32_t)frame * 7919u;
+    uint32_t x;
+    uint32_t y;
+
+    for (y = 0; y < pic_h; y++) {
+        for (x = 0; x < pic_w; x++) {
+            seed = (seed * 1103515245u) + 12345u;
+            put_pixel(buf, x, y, seed >> 8);
+        }
+    }
+}
+
+typedef struct {
+    const char *    name;
+    scene_func_t    func;
+} scene_desc_t;
+
+static const scene_desc_t scene_list[] = {
+    {"static",  &scene_static},
+    {"cursor",  &scene_cursor},
+    {"scroll",  &scene_scroll},
+    {"widgets", &scene_widgets},
+    {"noise",   &scene_noise},
+};
+
+typedef struct {
+    const char *                            name;
+    DisplayAppDeltaEncoder::wire_format_t   format;
+    int                                     bpp;
+} wire_desc_t;
+
+static const wire_desc_t wire_list[] = {
+    {"RGB565", DisplayAppDeltaEncoder::WIRE_RGB565, 2},
+    {"GRAY8",  DisplayAppDeltaEncoder::WIRE_GRAY8,  1},
+    {"RGB888", DisplayAppDeltaEncoder::WIRE_RGB888, 3},
+};
+
+static const uint8_t tile_list[] = {16, 32, 64};
+
+int main(int argc, char * argv[]) {
+    std::vector<uint8_t> picture;
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> key_out;
+    int frames = 200;
+    bool error = false;
+    size_t s;
+    size_t w;
+    size_t t;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+            frames = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-s") == 0) && ((i + 2) < argc)) {
+            pic_w = (uint32_t)atoi(argv[++i]);
+            pic_h = (uint32_t)atoi(argv[++i]);
+        } else {
+            printf("usage: display_app_delta_bench [-n frames] [-s width height]\n");
+            return 2;
+        }
+    }
+    if ((frames <= 0) || (pic_w < 32) || (pic_h < 32) || (pic_w > 0xFFFF) || (pic_h > 0xFFFF)) {
+        return 2;
+    }
+    pic_stride = ((pic_w * 4u) + 31u) & ~31u;
+    picture.assign((size_t)pic_stride * pic_h, 0);
+
+    printf("%ux%u, %d frames (ratio: raw size / encoded size, time: us / frame)\n", pic_w, pic_h, frames);
+    printf("%-8s %-6s %4s %8s %12s %8s %10s %10s\n", "scene", "wire", "tile", "ratio", "bytes/frame",
+           "tiles %", "encode", "decode");
+    for (s = 0; s < (sizeof(scene_list) / sizeof(scene_list[0])); s++) {
+        for (w = 0; w < (sizeof(wire_list) / sizeof(wire_list[0])); w++) {
+            for (t = 0; t < sizeof(tile_list); t++) {
+                DisplayAppDeltaEncoder encoder(tile_list[t], tile_list[t]);
+                DisplayAppDeltaEncoder::stats_t stats;
+                DisplayAppDeltaDecoder decoder;
+                double encode_us = 0.0;
+                double decode_us = 0.0;
+                int mismatch = 0;
+                int size;
+
+                out.resize(encoder.GetMaxEncodeSize(pic_w, pic_h, wire_list[w].format));
+                key_out.resize(out.size());
+                for (i = 0; i < frames; i++) {
+                    std::chrono::steady_clock::time_point start;
+
+                    scene_list[s].func(&picture[0], i);
+                    start = std::chrono::steady_clock::now();
+                    size = encoder.Encode(&picture[0], pic_stride, pic_w, pic_h, DisplayAppDeltaEncoder::INPUT_ARGB8888,
+                                          wire_list[w].format, &out[0], out.size());
+                    encode_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                    start = std::chrono::steady_clock::now();
+                    if ((size <= 0) || (!decoder.Decode(&out[0], (size_t)size))) {
+                        mismatch++;
+                        continue;
+                    }
+                    decode_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+                    // The decoded frame must be the same as a key frame of the picture
+                    {
+                        DisplayAppDeltaEncoder key_encoder(tile_list[t], tile_list[t]);
+                        DisplayAppDeltaDecoder key_decoder;
+
+                        size = key_encoder.Encode(&picture[0], pic_stride, pic_w, pic_h,
+                                                  DisplayAppDeltaEncoder::INPUT_ARGB8888, wire_list[w].format,
+                                                  &key_out[0], key_out.size());
+                        if ((size <= 0) || (!key_decoder.Decode(&key_out[0], (size_t)size))
+                         || (memcmp(decoder.GetFrame(), key_decoder.GetFrame(),
+                                    (size_t)pic_w * pic_h * wire_list[w].bpp) != 0)) {
+                            mismatch++;
+                        }
+                    }
+                }
+                encoder.GetStats(&stats);
+                printf("%-8s %-6s %4u %8.1f %12.0f %8.1f %10.1f %10.1f%s\n", scene_list[s].name, wire_list[w].name,
+                       tile_list[t], (double)stats.raw_bytes / (double)stats.encoded_bytes,
+                       (double)stats.encoded_bytes / frames, (100.0 * stats.tiles_sent) / stats.tiles_total,
+                       encode_us / frames, decode_us / frames, (mismatch != 0) ? "  NG" : "");
+                error |= (mismatch != 0);
+            }
+        }
+    }
+    return error ? 1 : 0;
+}
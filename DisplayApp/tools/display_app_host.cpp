@@ -0,0 +1,268 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          display_app_host.cpp
+* @brief         DisplayApp viewer side for Linux (serial port, pty or pipe)
+*
+* Receives the frames sent by DisplayApp, verifies them with DisplayAppHostEndpoint,
+* and prints the statistics (frames/s, bytes/s) at the end of the data or by Ctrl+C.
+* The touch messages given by -t are sent to the board, one after each received frame.
+*
+* Build (from DisplayApp/):
+*   g++ -O2 -I. -o display_app_host tools/display_app_host.cpp DisplayAppHost.cpp DisplayAppDelta.cpp DisplayAppTouch.cpp
+*
+* Usage:
+*   display_app_host [-q] [-o dir] [-t x,y[,id]] ... [device]
+*     device  serial port or pty of the board (e.g. /dev/ttyACM0). "-" or none: standard input (pipe)
+*     -q      print only the statistics
+*     -o dir  write the data of each frame to dir/frame_NNNNNN.{jpg,bmp,dlt}
+*     -t      touch to send (x = -1 and y = -1: released). Repeat -t to send several touches.
+*
+* Example:
+*   display_app_host -o /tmp/frames -t 100,50 -t -1,-1 /dev/ttyACM0
+*
+* The exit status is 1 if a frame fails the verification.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "DisplayAppHost.h"
+
+#define TOUCH_MAX           (256)
+
+typedef struct {
+    bool        quiet;
+    const char * out_dir;
+    int         fd;
+    bool        writable;
+    DisplayAppTouchParser::touch_event_t touch[TOUCH_MAX];
+    int         touch_num;
+    int         touch_sent;
+} host_t;
+
+static volatile sig_atomic_t stop_request = 0;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    stop_request = 1;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static bool write_all(int fd, const void * data, size_t size) {
+    const uint8_t * p = (const uint8_t *)data;
+    ssize_t num;
+
+    while (size > 0) {
+        num = write(fd, p, size);
+        if (num < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += num;
+        size -= (size_t)num;
+    }
+
+    return true;
+}
+
+static void save_frame(const host_t * p_host, uint32_t no, const DisplayAppHostEndpoint::frame_info_t * p_frame) {
+    static const char * const ext[] = {"jpg", "bmp", "dlt", "bin"};
+    char path[512];
+    FILE * fp;
+
+    snprintf(path, sizeof(path), "%s/frame_%06u.%s", p_host->out_dir, no, ext[p_frame->type]);
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return;
+    }
+    fwrite(p_frame->data, 1, p_frame->size, fp);
+    fclose(fp);
+}
+
+static void send_touch(host_t * p_host) {
+    char msg[64];
+    int len;
+
+    if ((!p_host->writable) || (p_host->touch_sent >= p_host->touch_num)) {
+        return;
+    }
+    len = DisplayAppHostEndpoint::MakeTouchMessage(&p_host->touch[p_host->touch_sent], 1, false, msg, sizeof(msg));
+    if ((len > 0) && (write_all(p_host->fd, msg, (size_t)len))) {
+        if (!p_host->quiet) {
+            printf("touch %s\n", msg);
+        }
+    } else {
+        fprintf(stderr, "cannot send the touch\n");
+    }
+    p_host->touch_sent++;
+}
+
+static void frame_received(void * p_user, const DisplayAppHostEndpoint::frame_info_t * p_frame) {
+    static const char * const name[] = {"JPEG", "BMP", "DELTA", "UNKNOWN"};
+    static uint32_t no = 0;
+    host_t * p_host = (host_t *)p_user;
+
+    if (!p_host->quiet) {
+        printf("%6u %-7s %4ux%-4u %8u bytes %s\n", no, name[p_frame->type], p_frame->width, p_frame->height,
+               p_frame->size, p_frame->valid ? "OK" : "NG");
+    }
+    if (p_host->out_dir != NULL) {
+        save_frame(p_host, no, p_frame);
+    }
+    no++;
+    send_touch(p_host);
+}
+
+static bool parse_touch(const char * str, DisplayAppTouchParser::touch_event_t * p_touch) {
+    int x;
+    int y;
+    int id = 0;
+
+    if (sscanf(str, "%d,%d,%d", &x, &y, &id) < 2) {
+        return false;
+    }
+    p_touch->id        = (uint8_t)id;
+    p_touch->valid     = (x >= 0) && (y >= 0);
+    p_touch->x         = x;
+    p_touch->y         = y;
+    p_touch->timestamp = 0;
+
+    return true;
+}
+
+static int open_device(const char * path, bool * p_writable) {
+    struct termios tio;
+    int fd;
+
+    if ((path == NULL) || (strcmp(path, "-") == 0)) {
+        *p_writable = false;
+        return STDIN_FILENO;
+    }
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        *p_writable = false;
+        fd = open(path, O_RDONLY);
+    } else {
+        *p_writable = true;
+    }
+    if ((fd >= 0) && (isatty(fd)) && (tcgetattr(fd, &tio) == 0)) {
+        // USB CDC: the baud rate is not used
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN]  = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    return fd;
+}
+
+int main(int argc, char * argv[]) {
+    DisplayAppHostEndpoint endpoint;
+    DisplayAppHostEndpoint::stats_t stats;
+    struct sigaction sa;
+    host_t host;
+    uint8_t buf[16 * 1024];
+    ssize_t size;
+    double start = 0.0;
+    double sec;
+    int opt;
+
+    memset(&host, 0, sizeof(host));
+    while ((opt = getopt(argc, argv, "qo:t:")) != -1) {
+        switch (opt) {
+            case 'q':
+                host.quiet = true;
+                break;
+            case 'o':
+                host.out_dir = optarg;
+                break;
+            case 't':
+                if ((host.touch_num >= TOUCH_MAX) || (!parse_touch(optarg, &host.touch[host.touch_num]))) {
+                    fprintf(stderr, "invalid touch: %s\n", optarg);
+                    return 2;
+                }
+                host.touch_num++;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-q] [-o dir] [-t x,y[,id]] ... [device]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    host.fd = open_device((optind < argc) ? argv[optind] : NULL, &host.writable);
+    if (host.fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", argv[optind], strerror(errno));
+        return 2;
+    }
+    if ((host.touch_num != 0) && (!host.writable)) {
+        fprintf(stderr, "the touches are not sent: the input is read only\n");
+    }
+
+    // Ctrl+C stops read() and prints the statistics
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = &signal_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    endpoint.SetFrameFunc(&frame_received, &host);
+    while (stop_request == 0) {
+        size = read(host.fd, buf, sizeof(buf));
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // A pty returns EIO when the other side is closed
+            break;
+        }
+        if (size == 0) {
+            break;
+        }
+        if (start == 0.0) {
+            start = now_sec();
+        }
+        endpoint.Feed(buf, (size_t)size);
+    }
+    sec = (start == 0.0) ? 0.0 : (now_sec() - start);
+
+    endpoint.GetStats(&stats);
+    printf("frames %u (JPEG %u, BMP %u, delta %u), invalid %u, sync errors %u\n", stats.frames, stats.jpeg_frames,
+           stats.bmp_frames, stats.delta_frames, stats.invalid_frames, stats.sync_errors);
+    if (sec > 0.0) {
+        printf("%llu bytes in %.2f s: %.1f frames/s, %.0f bytes/s\n", (unsigned long long)stats.bytes, sec,
+               (double)stats.frames / sec, (double)stats.bytes / sec);
+    }
+    if (host.fd != STDIN_FILENO) {
+        close(host.fd);
+    }
+
+    return (stats.invalid_frames != 0) ? 1 : 0;
+}
@@ -0,0 +1,384 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          display_app_loopback.cpp
+* @brief         Benchmark of DisplayApp on a Linux host
+*
+* DisplayApp is built with the mock USBSerial of host_mbed/, which passes the sent data to
+* DisplayAppHostEndpoint. Every frame is verified by the endpoint, and frames/s and bytes/s are
+* reported for SendRgb888, SendJpeg, SendJpegAsync and SendDelta. The touch messages are
+* written to the mock USBSerial, and the time until SetBatchCallback() is called is reported.
+* SendDelta is also run with send errors of the mock USBSerial, and each frame received after an
+* error must be decoded to the same picture as a key frame of the frame.
+*
+* Build (from DisplayApp/):
+*   g++ -O2 -pthread -Itools/host_mbed -I. -o display_app_loopback tools/display_app_loopback.cpp
+*       tools/host_mbed/USBSerial.cpp DisplayApp.cpp DisplayAppDelta.cpp DisplayAppTouch.cpp DisplayAppHost.cpp
+*
+* Usage:
+*   display_app_loopback [-n frames] [-s width height] [-r bytes_per_sec] [-j jpeg_file]
+*     -n  number of frames of each test (default 100)
+*     -s  picture size (default 480 272)
+*     -r  throughput of the link (default 0: no limit, 1000000: about USB full speed)
+*     -j  JPEG file to send (default: a dummy JPEG of 32KB)
+*
+* The exit status is 1 if a frame is lost or fails the verification.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "mbed.h"
+#include "DisplayApp.h"
+#include "DisplayAppHost.h"
+
+#define DUMMY_JPEG_SIZE     (32 * 1024)
+#define TOUCH_NUM           (100)
+#define DELTA_ERROR_FRAMES  (40)
+
+typedef struct {
+    uint32_t    valid;
+    uint32_t    invalid;
+} rx_count_t;
+
+static DisplayAppHostEndpoint endpoint;
+static rx_count_t rx_count;
+static Timer touch_timer;
+static Semaphore touch_sem(0);
+static uint32_t touch_time_us;
+static int touch_x;
+static int touch_y;
+
+static void link_tx(void * p_user, const uint8_t * data, uint32_t size) {
+    (void)p_user;
+    endpoint.Feed(data, size);
+}
+
+static void frame_received(void * p_user, const DisplayAppHostEndpoint::frame_info_t * p_frame) {
+    rx_count_t * p_count = (rx_count_t *)p_user;
+
+    if (p_frame->valid) {
+        p_count->valid++;
+    } else {
+        p_count->invalid++;
+    }
+}
+
+static void touch_received(const DisplayApp::touch_event_t * p_events, int num) {
+    if ((num > 0) && (p_events[0].valid)) {
+        touch_time_us = (uint32_t)touch_timer.read_us();
+        touch_x = p_events[0].x;
+        touch_y = p_events[0].y;
+        touch_sem.release();
+    }
+}
+
+static void jpeg_released(uint8_t * buf) {
+    (void)buf;
+}
+
+static void make_dummy_jpeg(std::vector<uint8_t> & jpeg, uint32_t width, uint32_t height) {
+    static const uint8_t head[] = {
+        0xFF, 0xD8,                                             /* SOI */
+        0xFF, 0xC0, 0x00, 0x0B, 0x08, 0x00, 0x00, 0x00, 0x00,   /* SOF0 (the size is set below) */
+        0x01, 0x01, 0x11, 0x00,
+        0xFF, 0xDA, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00,     /* SOS */
+    };
+    uint32_t i;
+
+    jpeg.assign(head, head + sizeof(head));
+    jpeg[7]  = (uint8_t)(height >> 8);
+    jpeg[8]  = (uint8_t)height;
+    jpeg[9]  = (uint8_t)(width >> 8);
+    jpeg[10] = (uint8_t)width;
+    for (i = (uint32_t)jpeg.size(); i < (DUMMY_JPEG_SIZE - 2); i++) {
+        jpeg.push_back((uint8_t)(i & 0x7F));
+    }
+    jpeg.push_back(0xFF);
+    jpeg.push_back(0xD9);                                       /* EOI */
+}
+
+static bool load_jpeg(const char * path, std::vector<uint8_t> & jpeg) {
+    FILE * fp = fopen(path, "rb");
+    uint8_t buf[4096];
+    size_t size;
+
+    if (fp == NULL) {
+        return false;
+    }
+    jpeg.clear();
+    while ((size = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        jpeg.insert(jpeg.end(), buf, buf + size);
+    }
+    fclose(fp);
+
+    return (jpeg.size() != 0);
+}
+
+/* Moving box on a gray background (ARGB8888, the stride of SendRgb888) */
+static void draw_picture(uint8_t * buf, uint32_t stride, uint32_t width, uint32_t height, int frame) {
+    uint32_t box_x = ((uint32_t)frame * 8) % width;
+    uint32_t x;
+    uint32_t y;
+    uint8_t * p;
+
+    for (y = 0; y < height; y++) {
+        p = &buf[y * stride];
+        for (x = 0; x < width; x++) {
+            if ((x >= box_x) && (x < (box_x + 32)) && (y >= (height / 2)) && (y < ((height / 2) + 32))) {
+                p[0] = 0x00;
+                p[1] = 0x00;
+                p[2] = 0xFF;
+            } else {
+                p[0] = 0x40;
+                p[1] = 0x40;
+                p[2] = 0x40;
+            }
+            p[3] = 0xFF;
+            p += 4;
+        }
+    }
+}
+
+/* Compare the frame decoded by the endpoint with a key frame of the picture */
+static bool check_delta_frame(const uint8_t * buf, uint32_t stride, uint32_t width, uint32_t height) {
+    DisplayAppDeltaEncoder ref_encoder;
+    DisplayAppDeltaDecoder ref_decoder;
+    DisplayAppDeltaDecoder * p_decoder = endpoint.GetDeltaDecoder();
+    std::vector<uint8_t> out(ref_encoder.GetMaxEncodeSize(width, height, DisplayAppDeltaEncoder::WIRE_RGB565));
+    int size;
+
+    size = ref_encoder.Encode(buf, stride, width, height, DisplayAppDeltaEncoder::INPUT_ARGB8888,
+                              DisplayAppDeltaEncoder::WIRE_RGB565, &out[0], out.size());
+    if ((size <= 0) || (!ref_decoder.Decode(&out[0], (size_t)size)) || (p_decoder->GetFrame() == NULL)) {
+        return false;
+    }
+    return (memcmp(p_decoder->GetFrame(), ref_decoder.GetFrame(), (size_t)width * height * 2) == 0);
+}
+
+static void print_result(const char * name, int frames, uint64_t bytes, uint64_t time_us, const rx_count_t * p_count) {
+    double sec = (double)time_us / 1000000.0;
+
+    if (sec <= 0.0) {
+        sec = 0.000001;
+    }
+    printf("%-14s %6d frames %10llu bytes %9.1f frames/s %12.0f bytes/s  verified %u  invalid %u\n",
+           name, frames, (unsigned long long)bytes, (double)frames / sec, (double)bytes / sec,
+           p_count->valid, p_count->invalid);
+}
+
+int main(int argc, char * argv[]) {
+    DisplayApp * p_app;
+    DisplayApp::send_stats_t send_stats;
+    std::vector<uint8_t> jpeg;
+    std::vector<uint8_t> picture;
+    const char * jpeg_path = NULL;
+    uint32_t width = 480;
+    uint32_t height = 272;
+    uint32_t stride;
+    uint32_t link_rate = 0;
+    uint32_t touch_total_us = 0;
+    uint32_t touch_max_us = 0;
+    uint32_t touch_lost = 0;
+    uint32_t done_base;
+    uint32_t delta_errors;
+    uint32_t delta_mismatch;
+    uint64_t bytes;
+    uint64_t time_us;
+    int frames = 100;
+    int delta_size;
+    int opt;
+    int i;
+    bool error = false;
+    char msg[64];
+    Timer timer;
+
+    while ((opt = getopt(argc, argv, "n:s:r:j:")) != -1) {
+        switch (opt) {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 's':
+                if (optind >= argc) {
+                    fprintf(stderr, "-s width height\n");
+                    return 2;
+                }
+                width  = (uint32_t)atoi(optarg);
+                height = (uint32_t)atoi(argv[optind++]);
+                break;
+            case 'r':
+                link_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                jpeg_path = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n frames] [-s width height] [-r bytes_per_sec] [-j jpeg_file]\n", argv[0]);
+                return 2;
+        }
+    }
+    if ((frames <= 0) || (width == 0) || (height == 0)) {
+        fprintf(stderr, "invalid parameter\n");
+        return 2;
+    }
+    if (jpeg_path != NULL) {
+        if (!load_jpeg(jpeg_path, jpeg)) {
+            fprintf(stderr, "cannot read %s\n", jpeg_path);
+            return 2;
+        }
+    } else {
+        make_dummy_jpeg(jpeg, width, height);
+    }
+    stride = ((width * 4u) + 31u) & ~31u;
+    picture.assign(stride * height, 0);
+
+    endpoint.SetFrameFunc(&frame_received, &rx_count);
+    USBSerial::SetTxFunc(&link_tx, NULL);
+    USBSerial::SetLinkRate(link_rate);
+    p_app = new DisplayApp();   // The threads of DisplayApp never end
+    p_app->SetBatchCallback(callback(&touch_received));
+
+    printf("picture %ux%u, JPEG %u bytes, link %s\n", width, height, (uint32_t)jpeg.size(),
+           (link_rate == 0) ? "no limit" : "limited");
+    if (link_rate != 0) {
+        printf("link rate %u bytes/s\n", link_rate);
+    }
+
+    // SendRgb888
+    memset(&rx_count, 0, sizeof(rx_count));
+    draw_picture(&picture[0], stride, width, height, 0);
+    bytes = 0;
+    timer.reset();
+    timer.start();
+    for (i = 0; i < frames; i++) {
+        bytes += (uint32_t)p_app->SendRgb888(&picture[0], width, height);
+    }
+    time_us = timer.read_high_resolution_us();
+    timer.stop();
+    print_result("SendRgb888", frames, bytes, time_us, &rx_count);
+    error |= ((rx_count.valid != (uint32_t)frames) || (rx_count.invalid != 0));
+
+    // SendJpeg
+    memset(&rx_count, 0, sizeof(rx_count));
+    bytes = 0;
+    timer.reset();
+    timer.start();
+    for (i = 0; i < frames; i++) {
+        bytes += (uint32_t)p_app->SendJpeg(&jpeg[0], (uint32_t)jpeg.size());
+    }
+    time_us = timer.read_high_resolution_us();
+    timer.stop();
+    print_result("SendJpeg", frames, bytes, time_us, &rx_count);
+    error |= ((rx_count.valid != (uint32_t)frames) || (rx_count.invalid != 0));
+
+    // SendJpegAsync
+    memset(&rx_count, 0, sizeof(rx_count));
+    p_app->GetSendStats(&send_stats);
+    bytes = send_stats.bytes;
+    done_base = send_stats.delivered + send_stats.dropped;
+    timer.reset();
+    timer.start();
+    for (i = 0; i < frames; i++) {
+        // The next frame is made while the previous one is sent
+        do {
+            ThisThread::yield();
+            p_app->GetSendStats(&send_stats);
+        } while (send_stats.pending >= DISPLAY_APP_SEND_QUEUE_NUM);
+        p_app->SendJpegAsync(&jpeg[0], (uint32_t)jpeg.size(), callback(&jpeg_released));
+    }
+    do {
+        ThisThread::yield();
+        p_app->GetSendStats(&send_stats);
+    } while ((send_stats.delivered + send_stats.dropped - done_base) < (uint32_t)frames);
+    time_us = timer.read_high_resolution_us();
+    timer.stop();
+    print_result("SendJpegAsync", (int)rx_count.valid + (int)rx_count.invalid, send_stats.bytes - bytes, time_us,
+                 &rx_count);
+    printf("%-14s delivered %u  dropped %u  link %u bytes/s\n", "", send_stats.delivered,
+           send_stats.dropped, send_stats.bytes_per_sec);
+    error |= ((rx_count.valid != send_stats.delivered) || (rx_count.invalid != 0));
+
+    // SendDelta
+    memset(&rx_count, 0, sizeof(rx_count));
+    bytes = 0;
+    timer.reset();
+    timer.start();
+    for (i = 0; i < frames; i++) {
+        draw_picture(&picture[0], stride, width, height, i);
+        delta_size = p_app->SendDelta(&picture[0], width, height);
+        if (delta_size > 0) {
+            bytes += (uint32_t)delta_size;
+        }
+    }
+    time_us = timer.read_high_resolution_us();
+    timer.stop();
+    print_result("SendDelta", frames, bytes, time_us, &rx_count);
+    error |= ((rx_count.valid != (uint32_t)frames) || (rx_count.invalid != 0));
+
+    // SendDelta with send errors: every 3rd frame is not sent, so the errors are at all positions of the box
+    // relative to the tiles
+    delta_errors = 0;
+    delta_mismatch = 0;
+    for (i = 0; i < DELTA_ERROR_FRAMES; i++) {
+        draw_picture(&picture[0], stride, width, height, i);
+        if ((i % 3) == 2) {
+            USBSerial::SetSendError(0);
+        }
+        if (p_app->SendDelta(&picture[0], width, height) <= 0) {
+            delta_errors++;
+            continue;
+        }
+        if (!check_delta_frame(&picture[0], stride, width, height)) {
+            delta_mismatch++;
+        }
+    }
+    USBSerial::SetSendError(-1);
+    printf("%-14s %6d frames  send errors %u  mismatched frames %u\n", "SendDelta err", DELTA_ERROR_FRAMES,
+           delta_errors, delta_mismatch);
+    error |= ((delta_errors != (DELTA_ERROR_FRAMES / 3)) || (delta_mismatch != 0));
+
+    // Touch: from the message written by the host to SetBatchCallback()
+    for (i = 0; i < TOUCH_NUM; i++) {
+        snprintf(msg, sizeof(msg), "{X=%d,Y=%d}", i, i + 1);
+        touch_timer.reset();
+        touch_timer.start();
+        USBSerial::HostWrite((const uint8_t *)msg, (uint32_t)strlen(msg));
+        if ((touch_sem.wait(1000) <= 0) || (touch_x != i) || (touch_y != (i + 1))) {
+            touch_lost++;
+        } else {
+            touch_total_us += touch_time_us;
+            if (touch_time_us > touch_max_us) {
+                touch_max_us = touch_time_us;
+            }
+        }
+        touch_timer.stop();
+    }
+    if (touch_lost < TOUCH_NUM) {
+        printf("%-14s %6d events  latency avg %u us  max %u us  lost %u\n", "Touch", TOUCH_NUM,
+               touch_total_us / (TOUCH_NUM - touch_lost), touch_max_us, touch_lost);
+    } else {
+        printf("%-14s %6d events  lost %u\n", "Touch", TOUCH_NUM, touch_lost);
+    }
+    error |= (touch_lost != 0);
+
+    printf("%s\n", error ? "NG" : "OK");
+    fflush(stdout);
+
+    // The threads of DisplayApp are still running
+    _exit(error ? 1 : 0);
+}
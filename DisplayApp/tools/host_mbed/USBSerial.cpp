@@ -0,0 +1,142 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "USBSerial.h"
+
+static std::mutex link_mutex;
+static USBSerial::tx_func_t tx_func = NULL;
+static void * tx_user = NULL;
+static uint32_t link_rate = 0;
+static bool link_configured = true;
+static int32_t send_error_skip = -1;
+static mbed::Callback<void()> rx_func;
+static uint8_t rx_buf[HOST_USB_SERIAL_RX_BUF_SIZE];
+static uint32_t rx_rd_idx = 0;
+static uint32_t rx_num = 0;
+
+USBSerial::USBSerial(bool connect_blocking) {
+    (void)connect_blocking;
+}
+
+void USBSerial::connect(void) {
+}
+
+bool USBSerial::configured(void) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    return link_configured;
+}
+
+bool USBSerial::readable(void) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    return (rx_num != 0);
+}
+
+int USBSerial::getc(void) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+    int c;
+
+    if (rx_num == 0) {
+        return -1;
+    }
+    c = rx_buf[rx_rd_idx];
+    rx_rd_idx = (rx_rd_idx + 1) % HOST_USB_SERIAL_RX_BUF_SIZE;
+    rx_num--;
+
+    return c;
+}
+
+bool USBSerial::send(uint8_t * buffer, uint32_t size) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tx_func_t func;
+    void * p_user;
+    uint32_t rate;
+
+    link_mutex.lock();
+    if (send_error_skip >= 0) {
+        if (send_error_skip-- == 0) {
+            link_mutex.unlock();
+            return false;
+        }
+    }
+    func   = tx_func;
+    p_user = tx_user;
+    rate   = link_rate;
+    link_mutex.unlock();
+
+    if (func != NULL) {
+        func(p_user, buffer, size);
+    }
+    if (rate != 0) {
+        std::this_thread::sleep_until(start + std::chrono::microseconds(((uint64_t)size * 1000000u) / rate));
+    }
+
+    return true;
+}
+
+void USBSerial::attach(mbed::Callback<void()> func) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    rx_func = func;
+}
+
+void USBSerial::SetTxFunc(tx_func_t func, void * p_user) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    tx_func = func;
+    tx_user = p_user;
+}
+
+void USBSerial::SetLinkRate(uint32_t bytes_per_sec) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    link_rate = bytes_per_sec;
+}
+
+void USBSerial::SetConfigured(bool connected) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    link_configured = connected;
+}
+
+void USBSerial::SetSendError(int32_t skip) {
+    std::lock_guard<std::mutex> lock(link_mutex);
+
+    send_error_skip = skip;
+}
+
+uint32_t USBSerial::HostWrite(const uint8_t * data, uint32_t size) {
+    mbed::Callback<void()> func;
+    uint32_t num = 0;
+
+    link_mutex.lock();
+    while ((num < size) && (rx_num < HOST_USB_SERIAL_RX_BUF_SIZE)) {
+        rx_buf[(rx_rd_idx + rx_num) % HOST_USB_SERIAL_RX_BUF_SIZE] = data[num++];
+        rx_num++;
+    }
+    func = rx_func;
+    link_mutex.unlock();
+
+    // Receive interrupt
+    if ((num != 0) && (func)) {
+        func.call();
+    }
+
+    return num;
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          USBSerial.h
+* @brief         Mock USBSerial which loops the data back to the host program
+*
+* The data sent by the board (send()) is passed to the function set by SetTxFunc().
+* The data written by HostWrite() is read by the board (readable(), getc()), and the function
+* set by attach() is called like the receive interrupt.
+* SetLinkRate() limits send() to a throughput, to measure DisplayApp with the speed of a real link.
+* SetSendError() makes a send() fail, to test the recovery of DisplayApp.
+* All instances share one link.
+*
+* Only for the host tools (display_app_loopback). Not used by the mbed build.
+******************************************************************************/
+
+#ifndef HOST_USB_SERIAL_H
+#define HOST_USB_SERIAL_H
+
+#include <stdint.h>
+#include "mbed.h"
+
+/** Size of the receive buffer of the board (byte) */
+#ifndef HOST_USB_SERIAL_RX_BUF_SIZE
+#define HOST_USB_SERIAL_RX_BUF_SIZE     (1024)
+#endif
+
+class USBSerial {
+public:
+    /** Function to receive the data sent by the board
+     *
+     * @param p_user user data
+     * @param data sent data
+     * @param size data size
+     */
+    typedef void (* tx_func_t)(void * p_user, const uint8_t * data, uint32_t size);
+
+    USBSerial(bool connect_blocking = true);
+
+    void connect(void);
+    bool configured(void);
+    bool readable(void);
+    int getc(void);
+    bool send(uint8_t * buffer, uint32_t size);
+    void attach(mbed::Callback<void()> func);
+
+    template<typename T>
+    void attach(T * obj, void (T::*method)()) {
+        attach(mbed::callback(obj, method));
+    }
+
+    /** Set the function to receive the data sent by the board
+     *
+     * @param func function (NULL: the data is discarded)
+     * @param p_user user data of func
+     */
+    static void SetTxFunc(tx_func_t func, void * p_user);
+
+    /** Limit the throughput of send()
+     *
+     * @param bytes_per_sec throughput (0: no limit)
+     */
+    static void SetLinkRate(uint32_t bytes_per_sec);
+
+    /** Connect or disconnect the host
+     *
+     * @param connected true = configured() returns true
+     */
+    static void SetConfigured(bool connected);
+
+    /** Make a send() fail
+     *
+     * @param skip number of the send() calls which succeed before the one which returns false
+     *             without sending the data (-1: no error)
+     */
+    static void SetSendError(int32_t skip);
+
+    /** Write data from the host to the board
+     *
+     * @param data data
+     * @param size data size
+     * @return number of bytes written (less than size if the receive buffer is full)
+     */
+    static uint32_t HostWrite(const uint8_t * data, uint32_t size);
+};
+
+#endif
@@ -0,0 +1,157 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          mbed.h
+* @brief         Part of the mbed API used by the libraries, for a Linux host
+*
+* Only for the host tools (display_app_loopback, asciifont_test, text_console_test, ...).
+* Not used by the mbed build.
+******************************************************************************/
+
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <chrono>
+#include <functional>
+
+namespace mbed {
+
+template <typename F> class Callback;
+
+/** Callback (std::function based) */
+template <typename R, typename... A>
+class Callback<R(A...)> {
+public:
+    Callback(R (*func)(A...) = NULL) {
+        if (func != NULL) {
+            _func = func;
+        }
+    }
+
+    template <typename T>
+    Callback(T * obj, R (T::*method)(A...)) : _func([obj, method](A... a) -> R { return (obj->*method)(a...); }) {
+    }
+
+    template <typename T>
+    Callback(T * obj, R (*func)(T *, A...)) : _func([obj, func](A... a) -> R { return func(obj, a...); }) {
+    }
+
+    R call(A... a) const {
+        return _func(a...);
+    }
+
+    R operator()(A... a) const {
+        return _func(a...);
+    }
+
+    operator bool() const {
+        return (bool)_func;
+    }
+
+private:
+    std::function<R(A...)> _func;
+};
+
+template <typename R, typename... A>
+Callback<R(A...)> callback(R (*func)(A...)) {
+    return Callback<R(A...)>(func);
+}
+
+template <typename T, typename R, typename... A>
+Callback<R(A...)> callback(T * obj, R (T::*method)(A...)) {
+    return Callback<R(A...)>(obj, method);
+}
+
+template <typename T, typename R, typename... A>
+Callback<R(A...)> callback(T * obj, R (*func)(T *, A...)) {
+    return Callback<R(A...)>(obj, func);
+}
+
+/** Timer (steady_clock) */
+class Timer {
+public:
+    Timer() : _running(false), _time_us(0) {
+    }
+
+    void start(void) {
+        if (!_running) {
+            _start = std::chrono::steady_clock::now();
+            _running = true;
+        }
+    }
+
+    void stop(void) {
+        _time_us = read_high_resolution_us();
+        _running = false;
+    }
+
+    void reset(void) {
+        _start = std::chrono::steady_clock::now();
+        _time_us = 0;
+    }
+
+    int read_ms(void) {
+        return (int)(read_high_resolution_us() / 1000);
+    }
+
+    int read_us(void) {
+        return (int)read_high_resolution_us();
+    }
+
+    uint64_t read_high_resolution_us(void) {
+        if (!_running) {
+            return _time_us;
+        }
+        return _time_us + (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+    bool _running;
+    uint64_t _time_us;
+    std::chrono::steady_clock::time_point _start;
+};
+
+/** FileHandle (the interface only) */
+class FileHandle {
+public:
+    virtual ~FileHandle() {
+    }
+
+    virtual ssize_t read(void * buffer, size_t size) = 0;
+    virtual ssize_t write(const void * buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+
+    virtual int isatty() {
+        return 0;
+    }
+};
+
+} // namespace mbed
+
+using namespace mbed;
+
+#include "rtos.h"
+
+#endif
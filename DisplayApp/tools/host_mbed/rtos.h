@@ -0,0 +1,168 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          rtos.h
+* @brief         Part of the mbed RTOS API used by DisplayApp, for a Linux host
+*
+* The threads are std::thread. The priority and the stack size are ignored.
+* Only for the host tools (display_app_loopback). Not used by the mbed build.
+******************************************************************************/
+
+#ifndef HOST_RTOS_H
+#define HOST_RTOS_H
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "mbed.h"
+
+typedef enum {
+    osPriorityIdle         = 1,
+    osPriorityLow          = 8,
+    osPriorityBelowNormal  = 16,
+    osPriorityNormal       = 24,
+    osPriorityAboveNormal  = 32,
+    osPriorityHigh         = 40,
+    osPriorityRealtime     = 48,
+} osPriority;
+
+typedef int32_t osStatus;
+
+#define osOK                (0)
+#define osErrorResource     (-3)
+#define osWaitForever       (0xFFFFFFFFu)
+
+namespace rtos {
+
+/** Thread (std::thread, detached at the destruction) */
+class Thread {
+public:
+    Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = 0,
+           unsigned char * stack_mem = NULL, const char * name = NULL) {
+        (void)priority;
+        (void)stack_size;
+        (void)stack_mem;
+        (void)name;
+    }
+
+    ~Thread() {
+        if (_thread.joinable()) {
+            _thread.detach();
+        }
+    }
+
+    osStatus start(mbed::Callback<void()> task) {
+        if (_thread.joinable()) {
+            return osErrorResource;
+        }
+        _thread = std::thread([task]() { task.call(); });
+        return osOK;
+    }
+
+    osStatus join(void) {
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        return osOK;
+    }
+
+private:
+    std::thread _thread;
+};
+
+/** Mutex (recursive, like the mbed Mutex) */
+class Mutex {
+public:
+    void lock(void) {
+        _mutex.lock();
+    }
+
+    bool trylock(void) {
+        return _mutex.try_lock();
+    }
+
+    void unlock(void) {
+        _mutex.unlock();
+    }
+
+private:
+    std::recursive_mutex _mutex;
+};
+
+/** Semaphore */
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0, uint16_t max_count = 0xFFFF) : _count(count), _max_count(max_count) {
+    }
+
+    /** Wait until a token is available
+     *
+     * @param millisec timeout (ms)
+     * @return number of tokens before the token was taken, 0 = timeout
+     */
+    int32_t wait(uint32_t millisec = osWaitForever) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        int32_t count;
+
+        if (millisec == osWaitForever) {
+            _cond.wait(lock, [this]() { return _count > 0; });
+        } else if (!_cond.wait_for(lock, std::chrono::milliseconds(millisec), [this]() { return _count > 0; })) {
+            return 0;
+        }
+        count = _count;
+        _count--;
+
+        return count;
+    }
+
+    osStatus release(void) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_count >= _max_count) {
+            return osErrorResource;
+        }
+        _count++;
+        _cond.notify_one();
+
+        return osOK;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    int32_t _count;
+    int32_t _max_count;
+};
+
+} // namespace rtos
+
+namespace ThisThread {
+
+static inline void sleep_for(uint32_t millisec) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
+
+static inline void yield(void) {
+    std::this_thread::yield();
+}
+
+} // namespace ThisThread
+
+using namespace rtos;
+
+#endif
@@ -0,0 +1,381 @@
+/* mbed EasyPlayback Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "EasyMoviePlayer.h"
+#include "dcache-control.h"
+
+EasyMoviePlayer::EasyMoviePlayer(EasyPlayback * playback, DisplayBase * display, DisplayBase::graphics_layer_t layer,
+                                 JPEG_Converter * jcu, bool use_vsync_irq, osPriority tsk_pri, uint32_t stack_size) :
+    _playback(playback), _display(display), _layer(layer), _jcu(jcu), _use_vsync_irq(use_vsync_irq), _vsync_id(-1),
+    _jpeg_buf_size(0), _buf_num(0), _queue_top(0), _queue_num(0), _active(false), _sem_free(0),
+    _decode_thread(tsk_pri, stack_size), _sem_decode(0, 1), _sem_decoded(0, 1)
+{
+    int i;
+
+    memset(&_stats, 0, sizeof(_stats));
+    memset(&_bitmap, 0, sizeof(_bitmap));
+    _skew_sum = 0;
+    _skew_abs_sum = 0;
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        _jpeg[i] = NULL;
+        _jpeg_state[i] = JPEG_FREE;
+    }
+    _decode_thread.start(callback(this, &EasyMoviePlayer::decode_process));
+}
+
+bool EasyMoviePlayer::set_frame_buffer(uint8_t ** buffers, int num, int width, int height,
+                                       JPEG_Converter::wr_rd_format_t format, JPEG_Converter::decode_options_t * options)
+{
+    int i;
+
+    if ((_active) || (buffers == NULL) || (num < 2) || (num > EASY_MOVIE_PLAYER_BUFFER_MAX)) {
+        return false;
+    }
+    for (i = 0; i < num; i++) {
+        if (buffers[i] == NULL) {
+            return false;
+        }
+        _buf[i] = buffers[i];
+    }
+    _buf_num = num;
+    _bitmap.width  = width;
+    _bitmap.height = height;
+    _bitmap.format = format;
+    if (options != NULL) {
+        _decode_options = *options;
+    } else {
+        _decode_options = JPEG_Converter::decode_options_t();
+    }
+    _decode_options.p_DecodeCallBackFunc = NULL;
+
+    return true;
+}
+
+bool EasyMoviePlayer::play(const char * filename, uint8_t * jpeg_buf, uint32_t jpeg_buf_size)
+{
+    bool ret;
+    int i;
+
+    if ((_active) || (_buf_num == 0) || (jpeg_buf == NULL)) {
+        return false;
+    }
+    _jpeg_buf_size = (jpeg_buf_size / EASY_MOVIE_PLAYER_JPEG_NUM) & ~31u;
+    if (_jpeg_buf_size == 0) {
+        return false;
+    }
+
+    core_util_critical_section_enter();
+    for (i = 0; i < _buf_num; i++) {
+        _state[i] = BUF_FREE;
+    }
+    _queue_top = 0;
+    _queue_num = 0;
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        _jpeg[i] = jpeg_buf + (_jpeg_buf_size * i);
+        _jpeg_state[i] = (i == 0) ? JPEG_READING : JPEG_FREE;
+    }
+    core_util_critical_section_exit();
+    memset(&_stats, 0, sizeof(_stats));
+    _skew_sum = 0;
+    _skew_abs_sum = 0;
+    _frame_interval = 0;
+    _last_read_pts = 0;
+    _last_presented_pts = 0;
+    _vsync_samples = 0;
+    _sampling_rate = 0;
+    _presented_any = false;
+    _vsync_timer.reset();
+    _vsync_timer.start();
+
+    if (_use_vsync_irq) {
+        _vsync_id = VsyncDispatcher::Attach(_display, callback(this, &EasyMoviePlayer::vsync));
+        if (_vsync_id < 0) {
+            return false;
+        }
+    }
+
+    EasyDec_Mov::attach(callback(this, &EasyMoviePlayer::video_callback), _jpeg[0], _jpeg_buf_size);
+    _active = true;
+    ret = _playback->play(filename);
+    _active = false;
+    EasyDec_Mov::attach(NULL, NULL, 0);
+
+    // The images which have not been decoded are discarded, and the image being decoded is waited for
+    core_util_critical_section_enter();
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        if (_jpeg_state[i] != JPEG_DECODING) {
+            _jpeg_state[i] = JPEG_FREE;
+        }
+    }
+    core_util_critical_section_exit();
+    while (is_decoding()) {
+        _sem_decoded.wait(EASY_MOVIE_PLAYER_WAIT_MS);
+    }
+
+    VsyncDispatcher::Detach(_vsync_id);
+    _vsync_id = -1;
+    _vsync_timer.stop();
+
+    return ret;
+}
+
+void EasyMoviePlayer::vsync(void)
+{
+    uint32_t now;
+    uint32_t vsync_us;
+    int idx;
+    int i;
+
+    vsync_us = _vsync_timer.read_us();
+    _vsync_timer.reset();
+    if ((!_active) || (_sampling_rate == 0)) {
+        return;
+    }
+    _vsync_samples = (uint32_t)(((uint64_t)vsync_us * _sampling_rate) / 1000000);
+
+    // The buffer replaced at the previous vsync is no longer read by the VDC
+    for (i = 0; i < _buf_num; i++) {
+        if (_state[i] == BUF_RELEASING) {
+            release_buffer(i);
+        }
+    }
+
+    // The image changed now is displayed from the next vsync
+    now = _playback->get_played_samples() + _vsync_samples;
+
+    // If the next image is also due, the first one is not displayed
+    while ((_queue_num >= 2) && ((int32_t)(now - _pts[_queue[(_queue_top + 1) % _buf_num]]) >= 0)) {
+        idx = _queue[_queue_top];
+        _queue_top = (_queue_top + 1) % _buf_num;
+        _queue_num--;
+        release_buffer(idx);
+        _stats.dropped++;
+    }
+
+    if ((_queue_num >= 1) && ((int32_t)(now - _pts[_queue[_queue_top]]) >= 0)) {
+        idx = _queue[_queue_top];
+        _queue_top = (_queue_top + 1) % _buf_num;
+        _queue_num--;
+        _display->Graphics_Read_Change(_layer, (void *)_buf[idx]);
+        for (i = 0; i < _buf_num; i++) {
+            if (_state[i] == BUF_DISPLAYED) {
+                _state[i] = BUF_RELEASING;
+            }
+        }
+        _state[idx] = BUF_DISPLAYED;
+        _stats.presented++;
+        _last_presented_pts = _pts[idx];
+        _presented_any = true;
+        add_skew((int32_t)(now - _pts[idx]));
+    } else if ((_presented_any) && (_frame_interval != 0) &&
+               ((int32_t)(now - (_last_presented_pts + _frame_interval)) >= 0)) {
+        // The next image is not ready
+        _stats.repeated++;
+    } else {
+        // do nothing
+    }
+}
+
+void EasyMoviePlayer::get_stats(stats_t * p_stats)
+{
+    if (p_stats == NULL) {
+        return;
+    }
+    core_util_critical_section_enter();
+    *p_stats = _stats;
+    if (_stats.presented != 0) {
+        p_stats->skew_avg_ms = (int32_t)(_skew_sum / _stats.presented);
+        p_stats->skew_abs_avg_ms = (uint32_t)(_skew_abs_sum / _stats.presented);
+    }
+    core_util_critical_section_exit();
+}
+
+/* Called from EasyPlayback::play() each time an image is read. Only queues the image for the decode thread. */
+void EasyMoviePlayer::video_callback(void)
+{
+    uint32_t pts = EasyDec_Mov::get_video_timestamp();
+    int idx;
+    int i;
+
+    _sampling_rate = _playback->get_sampling_rate();
+    if ((_stats.frames != 0) && (pts > _last_read_pts)) {
+        _frame_interval = pts - _last_read_pts;
+    }
+    _last_read_pts = pts;
+
+    core_util_critical_section_enter();
+    _stats.frames++;
+    // An image which the decode thread has not started is replaced by the newer one
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        if (_jpeg_state[i] == JPEG_QUEUED) {
+            _jpeg_state[i] = JPEG_FREE;
+            _stats.dropped++;
+        }
+    }
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        if (_jpeg_state[i] == JPEG_READING) {
+            _jpeg_state[i] = JPEG_QUEUED;
+            _jpeg_pts[i] = pts;
+            _jpeg_size[i] = EasyDec_Mov::get_video_size();
+            break;
+        }
+    }
+    // One buffer is decoded and one is queued at most, so another one is free
+    for (idx = 0; idx < EASY_MOVIE_PLAYER_JPEG_NUM; idx++) {
+        if (_jpeg_state[idx] == JPEG_FREE) {
+            _jpeg_state[idx] = JPEG_READING;
+            break;
+        }
+    }
+    core_util_critical_section_exit();
+
+    EasyDec_Mov::set_video_buffer(_jpeg[idx], _jpeg_buf_size);
+    _sem_decode.release();
+}
+
+void EasyMoviePlayer::decode_process(void)
+{
+    int i;
+
+    while (true) {
+        _sem_decode.wait();
+        while (true) {
+            core_util_critical_section_enter();
+            for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+                if (_jpeg_state[i] == JPEG_QUEUED) {
+                    _jpeg_state[i] = JPEG_DECODING;
+                    break;
+                }
+            }
+            core_util_critical_section_exit();
+            if (i >= EASY_MOVIE_PLAYER_JPEG_NUM) {
+                break;
+            }
+            decode_image(i);
+            core_util_critical_section_enter();
+            _jpeg_state[i] = JPEG_FREE;
+            core_util_critical_section_exit();
+            _sem_decoded.release();
+        }
+    }
+}
+
+void EasyMoviePlayer::decode_image(int jpeg_idx)
+{
+    JPEG_Converter::jpeg_conv_error_t e;
+    uint32_t pts = _jpeg_pts[jpeg_idx];
+    uint32_t now = _playback->get_played_samples();
+    int idx;
+
+    // Already later than the next image: not decoded
+    if ((_presented_any) && (_frame_interval != 0) && ((int32_t)(now - (pts + _frame_interval)) >= 0)) {
+        core_util_critical_section_enter();
+        _stats.dropped++;
+        core_util_critical_section_exit();
+        return;
+    }
+
+    idx = get_free_buffer();
+    if (idx < 0) {
+        core_util_critical_section_enter();
+        _stats.dropped++;
+        core_util_critical_section_exit();
+        return;
+    }
+    _bitmap.buffer_address = (void *)_buf[idx];
+    // The JCU reads the image by DMA
+    dcache_clean(_jpeg[jpeg_idx], _jpeg_size[jpeg_idx]);
+    e = _jcu->decode((void *)_jpeg[jpeg_idx], &_bitmap, &_decode_options);
+    if (e != JPEG_Converter::JPEG_CONV_OK) {
+        core_util_critical_section_enter();
+        release_buffer(idx);
+        _stats.decode_errors++;
+        core_util_critical_section_exit();
+        return;
+    }
+
+    _pts[idx] = pts;
+    core_util_critical_section_enter();
+    _state[idx] = BUF_QUEUED;
+    _queue[(_queue_top + _queue_num) % _buf_num] = idx;
+    _queue_num++;
+    core_util_critical_section_exit();
+}
+
+bool EasyMoviePlayer::is_decoding(void)
+{
+    bool ret = false;
+    int i;
+
+    core_util_critical_section_enter();
+    for (i = 0; i < EASY_MOVIE_PLAYER_JPEG_NUM; i++) {
+        if (_jpeg_state[i] == JPEG_DECODING) {
+            ret = true;
+        }
+    }
+    core_util_critical_section_exit();
+
+    return ret;
+}
+
+int EasyMoviePlayer::get_free_buffer(void)
+{
+    int i;
+
+    while (true) {
+        core_util_critical_section_enter();
+        for (i = 0; i < _buf_num; i++) {
+            if (_state[i] == BUF_FREE) {
+                _state[i] = BUF_DECODING;
+                break;
+            }
+        }
+        core_util_critical_section_exit();
+        if (i < _buf_num) {
+            return i;
+        }
+        // All buffers are waiting for the display. The audio continues while waiting.
+        if (_sem_free.wait(EASY_MOVIE_PLAYER_WAIT_MS) <= 0) {
+            return -1;
+        }
+    }
+}
+
+void EasyMoviePlayer::release_buffer(int idx)
+{
+    _state[idx] = BUF_FREE;
+    _sem_free.release();
+}
+
+void EasyMoviePlayer::add_skew(int32_t skew)
+{
+    int32_t skew_ms = (int32_t)(((int64_t)skew * 1000) / (int32_t)_sampling_rate);
+
+    if ((_stats.presented == 1) || (skew_ms < _stats.skew_min_ms)) {
+        _stats.skew_min_ms = skew_ms;
+    }
+    if ((_stats.presented == 1) || (skew_ms > _stats.skew_max_ms)) {
+        _stats.skew_max_ms = skew_ms;
+    }
+    _stats.skew_last_ms = skew_ms;
+    _skew_sum += skew_ms;
+    if (skew_ms < 0) {
+        _skew_abs_sum += (uint32_t)(-skew_ms);
+    } else {
+        _skew_abs_sum += (uint32_t)skew_ms;
+    }
+}
@@ -0,0 +1,223 @@
+/* mbed EasyPlayback Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          EasyMoviePlayer.h
+* @brief         Motion-JPEG movie playback synchronized with the audio
+******************************************************************************/
+#ifndef __EASY_MOVIE_PLAYER_H__
+#define __EASY_MOVIE_PLAYER_H__
+
+#include "mbed.h"
+#include "EasyPlayback.h"
+#include "EasyDec_Mov.h"
+#include "DisplayBace.h"
+#include "JPEG_Converter.h"
+#include "VsyncDispatcher.h"
+
+/** Maximum number of frame buffers */
+#ifndef EASY_MOVIE_PLAYER_BUFFER_MAX
+#define EASY_MOVIE_PLAYER_BUFFER_MAX    (4)
+#endif
+
+/** Number of buffers the images are read into (jpeg_buf of play() is divided into them) */
+#ifndef EASY_MOVIE_PLAYER_JPEG_NUM
+#define EASY_MOVIE_PLAYER_JPEG_NUM      (3)
+#endif
+#if EASY_MOVIE_PLAYER_JPEG_NUM < 3
+#error "EASY_MOVIE_PLAYER_JPEG_NUM must be 3 or more (reading, queued and decoding)"
+#endif
+
+/** Time to wait for a free frame buffer before the image is dropped (ms) */
+#ifndef EASY_MOVIE_PLAYER_WAIT_MS
+#define EASY_MOVIE_PLAYER_WAIT_MS       (100)
+#endif
+
+/** A class to play a movie (.mov) with the audio clock as the master clock
+ *
+ * The images read by EasyDec_Mov are decoded by the JCU into a rotating set of frame buffers.
+ * The decoding is done by a decode thread, so the thread of EasyPlayback::play() which feeds
+ * the audio never waits for the JCU or for a free frame buffer. While an image is decoded,
+ * the next one is read into another part of jpeg_buf.
+ * At every vsync the image whose time has come is displayed by Graphics_Read_Change(),
+ * so the images follow the number of audio samples that have been output.
+ * Images that are too late are dropped, and the previous image is kept (repeated)
+ * until the next image is ready.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "EasyAttach_CameraAndLCD.h"
+ * #include "EasyPlayback.h"
+ * #include "EasyDec_Mov.h"
+ * #include "EasyMoviePlayer.h"
+ *
+ * static uint8_t fb0[480 * 272 * 2] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t fb1[480 * 272 * 2] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t fb2[480 * 272 * 2] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t jpeg_buf[1024 * 32 * EASY_MOVIE_PLAYER_JPEG_NUM] __attribute((aligned(32)));
+ *
+ * DisplayBase Display;
+ * JPEG_Converter Jcu;
+ * EasyPlayback AudioPlayer;
+ * EasyMoviePlayer MoviePlayer(&AudioPlayer, &Display, DisplayBase::GRAPHICS_LAYER_0, &Jcu);
+ *
+ * int main() {
+ *     uint8_t * fb[3] = {fb0, fb1, fb2};
+ *
+ *     // Start the LCD and the graphics layer 0 with fb0 (RGB565) here
+ *     AudioPlayer.add_decoder<EasyDec_Mov>(".mov");
+ *     MoviePlayer.set_frame_buffer(fb, 3, 480, 272, JPEG_Converter::WR_RD_RGB565);
+ *     MoviePlayer.play("/storage/movie.mov", jpeg_buf, sizeof(jpeg_buf));
+ * }
+ * @endcode
+ */
+class EasyMoviePlayer {
+public:
+    /*! @struct stats_t
+        @brief Playback statistics
+     */
+    typedef struct {
+        uint32_t    frames;             /*!< Number of images read from the file */
+        uint32_t    presented;          /*!< Number of images displayed */
+        uint32_t    dropped;            /*!< Number of images not displayed (too late or no free buffer) */
+        uint32_t    repeated;           /*!< Number of vsyncs the previous image was kept although the next image was due */
+        uint32_t    decode_errors;      /*!< Number of JCU errors */
+        int32_t     skew_last_ms;       /*!< A/V skew of the last image (plus: the image is late) */
+        int32_t     skew_min_ms;        /*!< Minimum A/V skew */
+        int32_t     skew_max_ms;        /*!< Maximum A/V skew */
+        int32_t     skew_avg_ms;        /*!< Average A/V skew */
+        uint32_t    skew_abs_avg_ms;    /*!< Average of the absolute A/V skew */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param playback audio player (the decoder of ".mov" must be added)
+     * @param display display
+     * @param layer graphics layer to display the images
+     * @param jcu JPEG converter
+     * @param use_vsync_irq true: vsync() is attached to VsyncDispatcher while play() is running,
+     *                      false: the application calls vsync().
+     * @param tsk_pri priority of the decode thread (default: osPriorityNormal)
+     * @param stack_size stack size (in bytes) of the decode thread (default: 2048)
+     */
+    EasyMoviePlayer(EasyPlayback * playback, DisplayBase * display, DisplayBase::graphics_layer_t layer,
+                    JPEG_Converter * jcu, bool use_vsync_irq = true,
+                    osPriority tsk_pri = osPriorityNormal, uint32_t stack_size = 2048);
+
+    /** Set the frame buffers
+     *
+     * Three or more buffers are recommended. The buffer which has been replaced is
+     * reused after the next vsync.
+     *
+     * @param buffers frame buffer addresses
+     * @param num number of frame buffers (2 to EASY_MOVIE_PLAYER_BUFFER_MAX)
+     * @param width width of the frame buffer (pixel, the line offset of the graphics layer)
+     * @param height height of the frame buffer
+     * @param format format of the frame buffer
+     * @param options decode options (NULL: default)
+     * @return true = success, false = failure
+     */
+    bool set_frame_buffer(uint8_t ** buffers, int num, int width, int height,
+                          JPEG_Converter::wr_rd_format_t format, JPEG_Converter::decode_options_t * options = NULL);
+
+    /** Play a movie file
+     *
+     * Returns when the playback is finished, like EasyPlayback::play().
+     * jpeg_buf is divided into EASY_MOVIE_PLAYER_JPEG_NUM buffers (32 byte aligned).
+     * An image larger than one of them is skipped.
+     *
+     * @param filename file name
+     * @param jpeg_buf buffer to read the images (32 byte aligned)
+     * @param jpeg_buf_size size of jpeg_buf
+     * @return true = success, false = failure
+     */
+    bool play(const char * filename, uint8_t * jpeg_buf, uint32_t jpeg_buf_size);
+
+    /** Vsync process
+     *
+     * Called from the vsync interrupt when use_vsync_irq of the constructor is false.
+     */
+    void vsync(void);
+
+    /** Get the playback statistics
+     *
+     * @param p_stats statistics
+     */
+    void get_stats(stats_t * p_stats);
+
+private:
+    typedef enum {
+        BUF_FREE,
+        BUF_DECODING,
+        BUF_QUEUED,
+        BUF_DISPLAYED,
+        BUF_RELEASING
+    } buf_state_t;
+
+    typedef enum {
+        JPEG_FREE,
+        JPEG_READING,
+        JPEG_QUEUED,
+        JPEG_DECODING
+    } jpeg_state_t;
+
+    EasyPlayback * _playback;
+    DisplayBase * _display;
+    DisplayBase::graphics_layer_t _layer;
+    JPEG_Converter * _jcu;
+    JPEG_Converter::decode_options_t _decode_options;
+    JPEG_Converter::bitmap_buff_info_t _bitmap;
+    bool _use_vsync_irq;
+    int _vsync_id;                      /* ID of VsyncDispatcher, -1 = not attached */
+    uint8_t * _jpeg[EASY_MOVIE_PLAYER_JPEG_NUM];
+    volatile jpeg_state_t _jpeg_state[EASY_MOVIE_PLAYER_JPEG_NUM];
+    uint32_t _jpeg_pts[EASY_MOVIE_PLAYER_JPEG_NUM];
+    uint32_t _jpeg_size[EASY_MOVIE_PLAYER_JPEG_NUM];
+    uint32_t _jpeg_buf_size;            /* size of each _jpeg[] */
+    uint8_t * _buf[EASY_MOVIE_PLAYER_BUFFER_MAX];
+    volatile buf_state_t _state[EASY_MOVIE_PLAYER_BUFFER_MAX];
+    uint32_t _pts[EASY_MOVIE_PLAYER_BUFFER_MAX];
+    int _buf_num;
+    int _queue[EASY_MOVIE_PLAYER_BUFFER_MAX];
+    volatile int _queue_top;
+    volatile int _queue_num;
+    volatile bool _active;
+    uint32_t _sampling_rate;
+    uint32_t _frame_interval;           /* samples */
+    uint32_t _last_read_pts;
+    uint32_t _last_presented_pts;
+    uint32_t _vsync_samples;
+    bool _presented_any;
+    Timer _vsync_timer;
+    Semaphore _sem_free;
+    Thread _decode_thread;
+    Semaphore _sem_decode;              /* released when an image is queued */
+    Semaphore _sem_decoded;             /* released when the decode thread has finished an image */
+    stats_t _stats;
+    int64_t _skew_sum;
+    uint64_t _skew_abs_sum;
+
+    void video_callback(void);
+    void decode_process(void);
+    void decode_image(int jpeg_idx);
+    bool is_decoding(void);
+    int get_free_buffer(void);
+    void release_buffer(int idx);
+    void add_skew(int32_t skew);
+};
+
+#endif
@@ -31,6 +31,10 @@ EasyPlayback::EasyPlayback(audio_type_t type, PinName pin1, PinName pin2) :
     _audio_soundless = NULL;
     _heap_buf = NULL;
     _audio_buf = NULL;
+    _audio_data_size = NULL;
+    _played_samples = 0;
+    _sample_byte = 0;
+    _sampling_rate = 0;
     if (_type == AUDIO_TPYE_SSIF) {
         _audio_buff_size = 4096;
         _audio_write_buff_num = 8;
@@ -66,6 +70,7 @@ EasyPlayback::EasyPlayback(audio_type_t type, PinName pin1, PinName pin2) :
     if ((_audio_buff_size != 0) && (_audio_write_buff_num != 0)) {
         _heap_buf = new uint8_t[_audio_buff_size * _audio_write_buff_num + 31];
         _audio_buf = (uint8_t *)(((uint32_t)_heap_buf + 31ul) & ~31ul);
+        _audio_data_size = new uint32_t[_audio_write_buff_num];
     }
 }
 
@@ -88,6 +93,9 @@ EasyPlayback::~EasyPlayback()
     if (_heap_buf != NULL) {
         delete [] _heap_buf;
     }
+    if (_audio_data_size != NULL) {
+        delete [] _audio_data_size;
+    }
 }
 
 bool EasyPlayback::get_tag(const char* filename, char* p_title, char* p_artist, char* p_album, uint16_t tag_size)
@@ -117,7 +125,7 @@ bool EasyPlayback::get_tag(const char* filename, char* p_title, char* p_artist,
 
 bool EasyPlayback::play(const char* filename)
 {
-    const rbsp_data_conf_t audio_write_async_ctl = {NULL, NULL};
+    rbsp_data_conf_t audio_write_async_ctl = {NULL, NULL};
     size_t audio_data_size;
     FILE * fp = NULL;
     uint8_t * p_buf;
@@ -159,6 +167,14 @@ bool EasyPlayback::play(const char* filename)
             padding_size = 0;
             read_size = _audio_buff_size;
         }
+        _sample_byte = ((decoder->GetBlockSize() + 7) / 8) * decoder->GetChannel();
+        _sampling_rate = decoder->GetSamplingRate();
+        _played_samples = 0;
+        if ((_type == AUDIO_TPYE_SSIF) || (_type == AUDIO_TPYE_SPDIF)) {
+            // The samples are counted when the transfer is completed
+            audio_write_async_ctl.p_notify_func = &audio_write_end;
+            audio_write_async_ctl.p_app_data = this;
+        }
         setvbuf(fp, NULL, _IONBF, 0); // unbuffered
 
         while (true) {
@@ -176,6 +192,7 @@ bool EasyPlayback::play(const char* filename)
                     } else {
                         _audio->write(NULL, audio_data_size, &audio_write_async_ctl);
                     }
+                    _played_samples += audio_data_size / _sample_byte;
                 } else {
                     break;
                 }
@@ -183,6 +200,7 @@ bool EasyPlayback::play(const char* filename)
                 p_buf = &_audio_buf[_audio_buff_size * _buff_index];
                 audio_data_size = decoder->GetNextData(p_buf, read_size);
                 if (audio_data_size > 0) {
+                    _audio_data_size[_buff_index] = audio_data_size;
                     if (padding_size != 0) {
                         int idx_w = _audio_buff_size - 1;
                         int idx_r = read_size - 1;
@@ -208,6 +226,9 @@ bool EasyPlayback::play(const char* filename)
                         dcache_clean(p_buf, audio_data_size);
                         _audio->write(p_buf, audio_data_size, &audio_write_async_ctl);
                     }
+                    if (audio_write_async_ctl.p_notify_func == NULL) {
+                        _played_samples += audio_data_size / _sample_byte;
+                    }
                     if ((_buff_index + 1) < _audio_write_buff_num) {
                         _buff_index++;
                     } else {
@@ -219,6 +240,7 @@ bool EasyPlayback::play(const char* filename)
             }
         }
         ThisThread::sleep_for(500);
+        _sampling_rate = 0;
         ret = true;
     }
     delete decoder;
@@ -258,6 +280,31 @@ bool EasyPlayback::outputVolume(float VolumeOut)
     return _audio->outputVolume(VolumeOut, VolumeOut);
 }
 
+uint32_t EasyPlayback::get_played_samples(void)
+{
+    return _played_samples;
+}
+
+uint32_t EasyPlayback::get_sampling_rate(void)
+{
+    return _sampling_rate;
+}
+
+void EasyPlayback::audio_write_end(void * p_data, int32_t result, void * p_app_data)
+{
+    EasyPlayback * me = (EasyPlayback *)p_app_data;
+    uint32_t index;
+
+    if ((result <= 0) || (p_data == NULL)) {
+        return;
+    }
+    // The padded data is converted to the size of the file
+    index = ((uint32_t)p_data - (uint32_t)me->_audio_buf) / me->_audio_buff_size;
+    if (index < me->_audio_write_buff_num) {
+        me->_played_samples += me->_audio_data_size[index] / me->_sample_byte;
+    }
+}
+
 EasyDecoder * EasyPlayback::create_decoer_class(const char* filename)
 {
     std::map<std::string, EasyDecoder*(*)()>::iterator itr;
@@ -48,6 +48,20 @@ public:
     void skip(void);
     bool outputVolume(float VolumeOut);
 
+    /** Get the number of audio samples that have been output since play() started
+     *
+     * The count stops while paused, so it can be used as the clock of the movie playback.
+     *
+     * @return number of samples (per channel)
+     */
+    uint32_t get_played_samples(void);
+
+    /** Get the sampling rate of the file being played
+     *
+     * @return sampling rate (0: not playing)
+     */
+    uint32_t get_sampling_rate(void);
+
     template<typename T>
     void add_decoder(const string& extension) {
         m_lpDecoders[extension] = &T::inst;
@@ -71,9 +85,14 @@ private:
     uint32_t _audio_buff_size;
     uint8_t *_heap_buf;
     uint8_t *_audio_buf;
+    uint32_t *_audio_data_size;
+    volatile uint32_t _played_samples;
+    uint32_t _sample_byte;
+    uint32_t _sampling_rate;
     std::map<std::string, EasyDecoder*(*)()> m_lpDecoders;
 
     EasyDecoder * create_decoer_class(const char* filename);
+    static void audio_write_end(void * p_data, int32_t result, void * p_app_data);
 };
 
 #endif
@@ -28,6 +28,8 @@
 uint8_t * EasyDec_Mov::_videoBuf = NULL;
 uint32_t EasyDec_Mov::_videoBufSize = 0;
 Callback<void()> EasyDec_Mov::_function = NULL;
+uint32_t EasyDec_Mov::_videoTimestamp = 0;
+uint32_t EasyDec_Mov::_videoSize = 0;
 
 void EasyDec_Mov::attach(Callback<void()> func, uint8_t * video_buf, uint32_t video_buf_size) {
     _function = func;
@@ -35,6 +37,19 @@ void EasyDec_Mov::attach(Callback<void()> func, uint8_t * video_buf, uint32_t vi
     _videoBufSize = video_buf_size;
 }
 
+void EasyDec_Mov::set_video_buffer(uint8_t * video_buf, uint32_t video_buf_size) {
+    _videoBuf = video_buf;
+    _videoBufSize = video_buf_size;
+}
+
+uint32_t EasyDec_Mov::get_video_timestamp(void) {
+    return _videoTimestamp;
+}
+
+uint32_t EasyDec_Mov::get_video_size(void) {
+    return _videoSize;
+}
+
 bool EasyDec_Mov::AnalyzeHeder(char* p_title, char* p_artist, char* p_album, uint16_t tag_size, FILE* fp) {
     Buffer buf;
 
@@ -77,6 +92,7 @@ bool EasyDec_Mov::AnalyzeHeder(char* p_title, char* p_artist, char* p_album, uin
     fillCaches();
 
     _video_flg = true;
+    audioBytes = 0;
 
     return true;
 }
@@ -96,6 +112,8 @@ size_t EasyDec_Mov::GetNextData(void *buf, size_t len) {
             fseek(mov_fp, *frameSizesP, SEEK_CUR);
         } else {
             fread(_videoBuf, 1, *frameSizesP, mov_fp);
+            _videoTimestamp = audioBytes / (GetChannel() * (GetBlockSize() / 8));
+            _videoSize = *frameSizesP;
             if (_function) {
                 _function();
             }
@@ -117,6 +135,7 @@ size_t EasyDec_Mov::GetNextData(void *buf, size_t len) {
         } else {
             ret = (uint32_t)fread(buf, 1, aSize, mov_fp);
         }
+        audioBytes += ret;
     }
     if (rest_size == 0) {
         _video_flg = true;
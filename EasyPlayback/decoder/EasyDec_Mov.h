@@ -39,6 +39,29 @@ public:
      */
     static void attach(Callback<void()> func, uint8_t * video_buf, uint32_t video_buf_size);
 
+    /** Change the buffer the next image is read into
+     *
+     * Can be called from the callback, e.g. to read the next image while the previous one is decoded.
+     *
+     * @param video_buf video buffer address
+     * @param video_buf_size video buffer size
+     */
+    static void set_video_buffer(uint8_t * video_buf, uint32_t video_buf_size);
+
+    /** Get the presentation time of the image passed to the callback
+     *
+     * The time is the position of the audio data following the image.
+     *
+     * @return number of audio samples (per channel) from the beginning of the file
+     */
+    static uint32_t get_video_timestamp(void);
+
+    /** Get the size of the image passed to the callback
+     *
+     * @return image data size
+     */
+    static uint32_t get_video_size(void);
+
     /** analyze header
      *
      * @param p_title title tag buffer
@@ -84,6 +107,8 @@ private:
     static uint8_t * _videoBuf;
     static uint32_t _videoBufSize;
     static Callback<void()> _function;  /**< Callback. */
+    static uint32_t _videoTimestamp;
+    static uint32_t _videoSize;
 
     static const int bufSize = 32;
     uint32_t frameSizes[bufSize];
@@ -97,6 +122,7 @@ private:
     uint32_t lastFrameAddress;
     int availableCount;
     bool _video_flg;
+    uint32_t audioBytes;
 
     void search(uint32_t pattern);
     void fillCaches();
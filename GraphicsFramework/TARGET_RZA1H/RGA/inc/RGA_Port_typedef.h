@@ -36,6 +36,7 @@ Includes   <System Includes> , "Project Includes"
 ******************************************************************************/
 #include  "r_ospl_typedef.h"
 #include  "clib_drivers.h"  /* ceil_8 */
+#include  "vram_heap.h"
 #include  "RGA_Port_typedef.h"
 
 #ifdef __cplusplus
@@ -122,7 +123,8 @@ typedef struct _vram_ex_stack_t  vram_ex_stack_t;
 struct _vram_ex_stack_t {
     uint8_t  *Start;
     uint8_t  *Over;
-    uint8_t  *StackPointer;
+    uint8_t  *StackPointer;  /* Not used. Buffers are allocated from "Heap" */
+    vram_heap_t  Heap;
 };
 
 
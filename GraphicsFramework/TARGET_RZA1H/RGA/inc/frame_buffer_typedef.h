@@ -123,10 +123,10 @@ typedef enum _pixel_format_t  pixel_format_t;
 typedef struct st_frame_buffer_t  frame_buffer_t;
 struct st_frame_buffer_t {
 
-    /** Cached address, [2] is Reserved */
+    /** Cached address, [2] is used by triple buffering */
     uint8_t          *buffer_address[ frame_buffer_t_max_buffer_count ];
 
-    /** max is 2 */
+    /** max is 3 (frame_buffer_t_max_buffer_count). The layout is used by the RGA library */
     int_fast32_t      buffer_count;
 
     /** Index of "buffer_address" */
@@ -0,0 +1,248 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          vram_heap.h
+* @brief         Best-fit VRAM allocator with coalescing
+*
+* The memory is managed in units of VRAM_HEAP_UNIT bytes (= RGA_VDC5_BUFFER_ADDRESS_ALIGNMENT),
+* so every block satisfies the address alignment of the VDC5 and the RGA.
+* Larger alignments (power of 2) can be requested for each allocation.
+*
+* The block headers (boundary tags) are kept in vram_heap_t, not in the VRAM. Each block has
+* the links to its physical neighbours, so a freed block is merged with the free neighbours at once.
+* The free blocks are sorted by (size, address), and the best-fit block is found by a binary search.
+* The blocks can be freed in any order.
+*
+* The module does not depend on the OS or the hardware, so it can be built and tested on a host PC.
+******************************************************************************/
+
+#ifndef  VRAM_HEAP_H
+#define  VRAM_HEAP_H
+
+#include  <stdint.h>
+#include  <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+/******************************************************************************
+Macro definitions
+******************************************************************************/
+
+/** Allocation unit and minimum alignment (byte) */
+#define  VRAM_HEAP_UNIT          64
+
+/** Maximum number of blocks (used and free) */
+#ifndef  VRAM_HEAP_BLOCK_MAX
+#define  VRAM_HEAP_BLOCK_MAX     64
+#endif
+
+/** Alignment classes (byte) */
+#define  VRAM_HEAP_ALIGN_DEFAULT    VRAM_HEAP_UNIT   /* VDC5 frame buffer, RGA frame buffer and work buffer */
+#define  VRAM_HEAP_ALIGN_MAX        0x100000         /* 1MB */
+
+/** Error codes */
+enum {
+    VRAM_HEAP_OK = 0,
+    VRAM_HEAP_E_PARAM,            /* Invalid parameter */
+    VRAM_HEAP_E_NO_MEMORY,        /* No free block is large enough */
+    VRAM_HEAP_E_NO_BLOCK,         /* VRAM_HEAP_BLOCK_MAX blocks are used */
+    VRAM_HEAP_E_NOT_ALLOCATED     /* The address was not allocated */
+};
+
+
+/******************************************************************************
+Typedef definitions
+******************************************************************************/
+
+/**
+* @struct  vram_heap_block_t
+* @brief  Boundary tag of a block
+*/
+typedef struct st_vram_heap_block_t  vram_heap_block_t;
+struct st_vram_heap_block_t {
+
+    /** Offset from the start (unit) */
+    uint32_t  offset;
+
+    /** Size (unit) */
+    uint32_t  size;
+
+    /** Index of the block before this block in the memory, -1 = none */
+    int16_t   prev;
+
+    /** Index of the block after this block in the memory, -1 = none. Next unused block when the descriptor is unused */
+    int16_t   next;
+
+    /** 1 = free block */
+    uint8_t   is_free;
+};
+
+
+/**
+* @struct  vram_heap_t
+* @brief  VRAM heap
+*/
+typedef struct st_vram_heap_t  vram_heap_t;
+struct st_vram_heap_t {
+
+    /** Aligned start address */
+    uint8_t  *start;
+
+    /** Size of the heap (unit) */
+    uint32_t  unit_count;
+
+    /** Boundary tags */
+    vram_heap_block_t  block[ VRAM_HEAP_BLOCK_MAX ];
+
+    /** Top of the unused descriptors, -1 = none */
+    int16_t   unused_top;
+
+    /** Free blocks sorted by (size, offset) */
+    int16_t   free_index[ VRAM_HEAP_BLOCK_MAX ];
+    int_fast32_t  free_num;
+
+    /** Used blocks sorted by offset */
+    int16_t   used_index[ VRAM_HEAP_BLOCK_MAX ];
+    int_fast32_t  used_num;
+
+    /** Statistics */
+    uint32_t  used_units;
+    uint32_t  peak_used_units;
+    uint32_t  alloc_count;
+    uint32_t  free_count;
+    uint32_t  fail_count;
+};
+
+
+/**
+* @struct  vram_heap_stats_t
+* @brief  Statistics of <vram_heap_t>
+*/
+typedef struct st_vram_heap_stats_t  vram_heap_stats_t;
+struct st_vram_heap_stats_t {
+    size_t    total_size;           /* Size of the heap (byte) */
+    size_t    used_size;            /* Allocated size (byte) */
+    size_t    free_size;            /* Free size (byte) */
+    size_t    largest_free_size;    /* Size of the largest free block (byte) */
+    size_t    peak_used_size;       /* Maximum of used_size (byte) */
+    uint32_t  used_blocks;          /* Number of the allocated blocks */
+    uint32_t  free_blocks;          /* Number of the free blocks */
+    uint32_t  alloc_count;          /* Number of the successful allocations */
+    uint32_t  free_count;           /* Number of the frees */
+    uint32_t  fail_count;           /* Number of the failed allocations */
+    uint32_t  fragmentation;        /* 1000 - (largest_free_size * 1000 / free_size), 0 = not fragmented */
+};
+
+
+/**
+* @struct  vram_heap_defrag_report_t
+* @brief  Result of <R_VRAM_HEAP_GetDefragReport>
+*/
+typedef struct st_vram_heap_defrag_report_t  vram_heap_defrag_report_t;
+struct st_vram_heap_defrag_report_t {
+    uint32_t  hole_count;           /* Number of the free blocks between the allocated blocks */
+    size_t    hole_size;            /* Total size of the holes (byte) */
+    uint8_t  *first_hole;           /* Address of the lowest hole, NULL = none */
+    uint32_t  move_blocks;          /* Number of the allocated blocks which would move by compaction */
+    size_t    move_size;            /* Total size of move_blocks (byte) */
+    size_t    largest_free_size;    /* Size of the largest free block now (byte) */
+    size_t    largest_free_after;   /* Size of the largest free block after compaction (byte) */
+};
+
+
+/******************************************************************************
+Functions Prototypes
+******************************************************************************/
+
+/**
+* @brief   Initialize the heap
+*
+* @param   self vram_heap_t
+* @param   address start of the memory (aligned up to VRAM_HEAP_UNIT)
+* @param   size size of the memory (byte), the heap is empty when it is less than VRAM_HEAP_UNIT
+* @return  Error code, 0=No error
+*/
+int  R_VRAM_HEAP_Initialize( vram_heap_t *self, uint8_t *address, size_t size );
+
+
+/**
+* @brief   Allocate a block with the best-fit
+*
+* @param   self vram_heap_t
+* @param   size size (byte), rounded up to VRAM_HEAP_UNIT
+* @param   alignment alignment class (power of 2, VRAM_HEAP_ALIGN_DEFAULT to VRAM_HEAP_ALIGN_MAX).
+*          Alignments less than VRAM_HEAP_ALIGN_DEFAULT are treated as VRAM_HEAP_ALIGN_DEFAULT.
+* @param   out_address allocated address
+* @return  Error code, 0=No error
+*/
+int  R_VRAM_HEAP_Alloc( vram_heap_t *self, size_t size, size_t alignment, uint8_t **out_address );
+
+
+/**
+* @brief   Free a block
+*
+* @param   self vram_heap_t
+* @param   address address returned by <R_VRAM_HEAP_Alloc>
+* @return  Error code, 0=No error
+*/
+int  R_VRAM_HEAP_Free( vram_heap_t *self, const void *address );
+
+
+/**
+* @brief   Get the size of an allocated block
+*
+* @param   self vram_heap_t
+* @param   address address returned by <R_VRAM_HEAP_Alloc>
+* @return  Size (byte), 0 = not allocated
+*/
+size_t  R_VRAM_HEAP_GetSize( const vram_heap_t *self, const void *address );
+
+
+/**
+* @brief   Get the statistics
+*
+* @param   self vram_heap_t
+* @param   out_stats statistics
+*/
+void  R_VRAM_HEAP_GetStats( const vram_heap_t *self, vram_heap_stats_t *out_stats );
+
+
+/**
+* @brief   Report how much compaction would gain (the blocks are not moved)
+*
+* @param   self vram_heap_t
+* @param   out_report report
+*/
+void  R_VRAM_HEAP_GetDefragReport( const vram_heap_t *self, vram_heap_defrag_report_t *out_report );
+
+
+/**
+* @brief   Check the consistency of the boundary tags and the indexes (for debug)
+*
+* @param   self vram_heap_t
+* @return  Error code, 0=No error
+*/
+int  R_VRAM_HEAP_Check( const vram_heap_t *self );
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif /* __cplusplus */
+
+#endif
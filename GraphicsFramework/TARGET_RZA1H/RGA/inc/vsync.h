@@ -125,9 +125,38 @@ errnum_t  R_V_SYNC_GetAsyncStatus( int_fast32_t const  ChannelNum,
                                    const r_v_sync_async_status_t **const  out_Status );
 
 
+/**
+* @brief   Get the number of V-Sync since the initialization
+*
+* @par Description
+*    - The count is incremented at every V-Sync interrupt, even if nobody waits.
+*    - The count wraps around. Compare 2 counts by "(a - b) >= 0".
+*
+* @param   ChannelNum ChannelNum
+* @return  V-Sync count
+*/
+int_fast32_t  R_V_SYNC_GetVSyncCount( int_fast32_t const  ChannelNum );
+
+
+/**
+* @brief   Get the V-Sync count at which a register written just now is latched
+*
+* @par Description
+*    - Call this with all interrupts disabled, after writing the register and
+*      before enabling the interrupts. Then the V-Sync interrupt does not run between them.
+*    - If a V-Sync interrupt is pending, the V-Sync may be before or after the writing.
+*      The later one (count + 2) is returned, so the register is latched at or before the returned count.
+*
+* @param   ChannelNum ChannelNum
+* @return  V-Sync count. Compare with <R_V_SYNC_GetVSyncCount> by "(a - b) >= 0".
+*/
+int_fast32_t  R_V_SYNC_GetLatchVSyncCount( int_fast32_t const  ChannelNum );
+
+
 /* Following functions can not be called from Application. */
 void      R_V_SYNC_EnableInterrupt( int_fast32_t const  ChannelNum );
 bool_t    R_V_SYNC_DisableInterrupt( int_fast32_t const  ChannelNum );
+void      R_V_SYNC_OnVSync( int_fast32_t const  ChannelNum );
 /* It is not necessary: R_V_SYNC_FinalizeAsync(), R_V_SYNC_OnInterrupted() */
 
 
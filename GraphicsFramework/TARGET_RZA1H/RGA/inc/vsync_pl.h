@@ -121,6 +121,15 @@ extern "C"
                                            r_v_sync_interrupt_lines_t const  Disables );
 
 
+    /**
+    * @brief   Check whether the V-Sync interrupt is pending
+    *
+    * @param   ChannelNum ChannelNum parameters
+    * @return  true = The V-Sync interrupt has been requested, and the handler has not run yet
+    */
+    bool_t    R_V_SYNC_OnIsInterruptPending( int_fast32_t const  ChannelNum );
+
+
     /**
     * @brief   Default interrupt callback function
     *
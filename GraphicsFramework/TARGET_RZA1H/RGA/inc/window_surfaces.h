@@ -138,6 +138,83 @@ errnum_t  R_WINDOW_SURFACES_SwapBuffersStart( window_surfaces_t *const  self,
         int_fast32_t const  layer_num,  r_ospl_async_t *async );
 
 
+/**
+* @brief   Swap buffers without waiting for V-Sync
+*
+* @param   self window_surfaces_t
+* @param   layer_num layer_num
+* @param   context Graphics context or NULL
+* @param   out_present_fence Fence signaled when the swapped buffer is shown, or NULL
+* @return  Error code, 0=No error
+*
+* @par Description
+*    - The drawn buffer is shown from the next V-Sync.
+*    - The buffer which was shown is released at the next V-Sync.
+*      Call <R_WINDOW_SURFACES_WaitForDrawBuffer> before drawing the next frame.
+*    - If the layer has 3 buffers, the next frame can be drawn
+*      while the VDC5 is showing this frame.
+*/
+#ifdef  IS_WINDOW_SURFACES_EX
+errnum_t  R_WINDOW_SURFACES_SwapBuffersAsync( window_surfaces_t *const  self,
+        int_fast32_t const  layer_num,  graphics_t *const  context,
+        window_surfaces_fence_t *const  out_present_fence );
+#else
+errnum_t  R_WINDOW_SURFACES_SwapBuffersAsync( window_surfaces_t *const  self,
+        int_fast32_t const  layer_num,  const void *const  null_context,
+        window_surfaces_fence_t *const  out_present_fence );
+#endif
+
+
+/**
+* @brief   Get the release fence of a buffer
+*
+* @param   self window_surfaces_t
+* @param   layer_num layer_num
+* @param   buffer_index Index of "frame_buffer_t::buffer_address"
+* @param   out_release_fence Fence signaled when the VDC5 stops reading the buffer
+* @return  Error code, 0=No error
+*/
+errnum_t  R_WINDOW_SURFACES_GetBufferFence( const window_surfaces_t *const  self,
+        int_fast32_t const  layer_num,  int_fast32_t const  buffer_index,
+        window_surfaces_fence_t *const  out_release_fence );
+
+
+/**
+* @brief   Check whether a fence is signaled
+*
+* @param   self window_surfaces_t
+* @param   fence window_surfaces_fence_t
+* @return  true = signaled
+*/
+bool_t  R_WINDOW_SURFACES_IsFenceSignaled( const window_surfaces_t *const  self,
+        const window_surfaces_fence_t *const  fence );
+
+
+/**
+* @brief   Wait until a fence is signaled
+*
+* @param   self window_surfaces_t
+* @param   fence window_surfaces_fence_t
+* @return  Error code, 0=No error
+*/
+errnum_t  R_WINDOW_SURFACES_WaitFence( window_surfaces_t *const  self,
+                                       const window_surfaces_fence_t *const  fence );
+
+
+/**
+* @brief   Wait until the draw buffer of the layer is released by the VDC5
+*
+* @param   self window_surfaces_t
+* @param   layer_num layer_num
+* @return  Error code, 0=No error
+*
+* @par Description
+*    - If the layer has 3 buffers, this returns soon in most cases.
+*/
+errnum_t  R_WINDOW_SURFACES_WaitForDrawBuffer( window_surfaces_t *const  self,
+        int_fast32_t const  layer_num );
+
+
 /**
 * @brief   Wait for V-Sync
 *
@@ -150,7 +227,7 @@ errnum_t  R_WINDOW_SURFACES_WaitForVSync( window_surfaces_t *const  self,
 
 
 /**
-* @brief   Allocate offscreen from stack
+* @brief   Allocate offscreen from VRAM
 *
 * @param   self window_surfaces_t
 * @param   in_out_frame_buffer frame_buffer_t
@@ -159,13 +236,15 @@ errnum_t  R_WINDOW_SURFACES_WaitForVSync( window_surfaces_t *const  self,
 * @par Description
 *    - (input) - >stride, ->height, ->buffer_count
 *    - (output) - >buffer_address[(all)]
+*    - The buffers are allocated from the VRAM heap by the best-fit (see "vram_heap.h").
+*      They can be freed in any order.
 */
 errnum_t  R_WINDOW_SURFACES_AllocOffscreenStack( window_surfaces_t *const  self,
         frame_buffer_t *const  in_out_frame_buffer );
 
 
 /**
-* @brief   Free offscreen to stack
+* @brief   Free offscreen to VRAM
 *
 * @param   self window_surfaces_t
 * @param   frame_buffer frame_buffer_t
@@ -178,6 +257,28 @@ errnum_t  R_WINDOW_SURFACES_FreeOffscreenStack( window_surfaces_t *const  self,
         const frame_buffer_t *const  frame_buffer );
 
 
+/**
+* @brief   Get statistics of offscreen VRAM
+*
+* @param   self window_surfaces_t
+* @param   out_stats vram_heap_stats_t
+* @return  Error code, 0=No error
+*/
+errnum_t  R_WINDOW_SURFACES_GetOffscreenStats( window_surfaces_t *const  self,
+        vram_heap_stats_t *const  out_stats );
+
+
+/**
+* @brief   Get fragmentation report of offscreen VRAM
+*
+* @param   self window_surfaces_t
+* @param   out_report vram_heap_defrag_report_t
+* @return  Error code, 0=No error
+*/
+errnum_t  R_WINDOW_SURFACES_GetOffscreenDefragReport( window_surfaces_t *const  self,
+        vram_heap_defrag_report_t *const  out_report );
+
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif /* __cplusplus */
@@ -119,6 +119,51 @@ public:
 */
 	errnum_t  swap_buffers_start( int_fast32_t const  layer_num,  r_ospl_async_t* async );
 
+	/**
+* @brief   swap_buffers_async
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	#ifdef  IS_WINDOW_SURFACES_EX
+	errnum_t  swap_buffers_async( int_fast32_t const  layer_num,  Canvas2D_ContextClass&  context,  window_surfaces_fence_t* const  out_present_fence = NULL );
+	#else
+	errnum_t  swap_buffers_async( int_fast32_t const  layer_num,  const void* const  null_context,  window_surfaces_fence_t* const  out_present_fence = NULL );
+	#endif
+
+	/**
+* @brief   get_buffer_fence
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	errnum_t  get_buffer_fence( int_fast32_t const  layer_num,  int_fast32_t const  buffer_index,  window_surfaces_fence_t* const  out_release_fence );
+	/**
+* @brief   is_fence_signaled
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	bool_t  is_fence_signaled( const window_surfaces_fence_t& fence );
+	/**
+* @brief   wait_fence
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	errnum_t  wait_fence( const window_surfaces_fence_t& fence );
+	/**
+* @brief   wait_for_draw_buffer
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	errnum_t  wait_for_draw_buffer( int_fast32_t const  layer_num );
 	/**
 * @brief   wait_for_v_sync
 *
@@ -146,6 +191,24 @@ public:
 */
 	errnum_t  free_offscreen_stack( const frame_buffer_t* const  frame_buffer );
 
+	/**
+* @brief   get_offscreen_stats
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	errnum_t  get_offscreen_stats( vram_heap_stats_t* const  out_stats );
+
+	/**
+* @brief   get_offscreen_defrag_report
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+	errnum_t  get_offscreen_defrag_report( vram_heap_defrag_report_t* const  out_report );
+
 #ifdef  IS_WINDOW_SURFACES_EX
 	/**
 * @brief   do_message_loop
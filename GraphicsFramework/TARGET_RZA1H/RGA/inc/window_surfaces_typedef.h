@@ -104,6 +104,23 @@ struct st_window_surfaces_vdc5_layer_t {
 };
 
 
+/**
+* @struct  window_surfaces_fence_t
+* @brief  Fence which is signaled at a V-Sync
+*
+* @par Description
+*    - A present fence is signaled, when the VDC5 starts to scan out the swapped buffer.
+*    - A release fence is signaled, when the VDC5 stops reading the buffer.
+*      The buffer can be drawn after that.
+*/
+typedef struct st_window_surfaces_fence_t  window_surfaces_fence_t;
+struct st_window_surfaces_fence_t {
+
+    /** Value of <R_V_SYNC_GetVSyncCount> at which the fence is signaled */
+    int_fast32_t  v_sync_count;
+};
+
+
 /**
 * @struct  window_surfaces_t
 * @brief  window_surfaces_t
@@ -142,6 +159,16 @@ struct st_window_surfaces_t {
     int_fast32_t   background_frame_count;
 
 
+    /*-----------------------------------------------------------*/
+    /* Group: Fence */
+
+    /** release_fences. Index is same as "frame_buffers" and "buffer_address" */
+    window_surfaces_fence_t  release_fences[ WINDOW_SURFACES_T_MAX_LAYERS_COUNT ][ frame_buffer_t_max_buffer_count ];
+
+    /** present_fences. Index is same as "frame_buffers" */
+    window_surfaces_fence_t  present_fences[ WINDOW_SURFACES_T_MAX_LAYERS_COUNT ];
+
+
     /*-----------------------------------------------------------*/
     /* Group: VRAM */
 
@@ -154,6 +181,9 @@ struct st_window_surfaces_t {
     /** stack_pointer_of_VRAM */
     uint8_t  *stack_pointer_of_VRAM;
 
+    /** heap_of_VRAM. Offscreen buffers are allocated from over "stack_pointer_of_VRAM" */
+    vram_heap_t  heap_of_VRAM;
+
 
     /*-----------------------------------------------------------*/
     /* Group: State */
@@ -186,6 +216,9 @@ struct st_window_surfaces_config_t {
 
     /** background_format */
     background_format_t  background_format;
+
+    /** buffer_count. Count of buffers of the layers which are swapped. 2 or 3 (frame_buffer_t_max_buffer_count) */
+    int_fast32_t  buffer_count;
 };
 enum  /* "window_surfaces_config_t::flags" */
 {
@@ -193,7 +226,8 @@ enum  /* "window_surfaces_config_t::flags" */
     F_WINDOW_SURFACES_LAYER_COUNT       = 0x20,
 #define  F_WINDOW_SURFACES_BACKGROUND_COLOR    0x40u
     F_WINDOW_SURFACES_BUFFER_HEIGHT     = 0x80,
-    F_WINDOW_SURFACES_BACKGROUND_FORMAT = 0x100
+    F_WINDOW_SURFACES_BACKGROUND_FORMAT = 0x100,
+    F_WINDOW_SURFACES_BUFFER_COUNT      = 0x200
 };
 
 
@@ -322,6 +322,17 @@ void  R_V_SYNC_OnDisableInterrupt( int_fast32_t const  ChannelNum,
 }
 
 
+/***********************************************************************
+* Implement: R_V_SYNC_OnIsInterruptPending
+************************************************************************/
+bool_t  R_V_SYNC_OnIsInterruptPending( int_fast32_t const  ChannelNum )
+{
+    bsp_int_src_t const  num_of_IRQ = gs_array_of_i_context[ ChannelNum ].IRQ_Num;
+
+    return  (bool_t)( GIC_GetPendingIRQ( R_CAST_bsp_int_src_t_to_IRQn_Type( num_of_IRQ ) ) != 0u );
+}
+
+
 /***********************************************************************
 * Implement: R_V_SYNC_OnInterruptDefault
 ************************************************************************/
@@ -347,6 +358,8 @@ static void  R_V_SYNC_IRQ_HandlerN( int_fast32_t const  ChannelNum )
 
     /* V-Sync interrupt always be enabled. Because clear interrupt status */
 
+    R_V_SYNC_OnVSync( ChannelNum );
+
     if ( self->InterruptCallbackCaller != NULL ) {
         R_OSPL_CallInterruptCallback( self->InterruptCallbackCaller, i_context );
     }
@@ -0,0 +1,479 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+* @file  vram_heap.c
+* @brief   Best-fit VRAM allocator with coalescing
+*/
+
+#include  <string.h>
+#include  "vram_heap.h"
+
+
+/* Position of the first free block whose (size, offset) is not less than the key */
+static int_fast32_t  free_lower_bound( const vram_heap_t *self, uint32_t size, uint32_t offset )
+{
+    int_fast32_t  low = 0;
+    int_fast32_t  high = self->free_num;
+    int_fast32_t  mid;
+    const vram_heap_block_t  *b;
+
+    while ( low < high ) {
+        mid = (low + high) / 2;
+        b = &self->block[ self->free_index[ mid ] ];
+        if ( (b->size < size) || ((b->size == size) && (b->offset < offset)) ) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return  low;
+}
+
+
+/* Position of the first used block whose offset is not less than the key */
+static int_fast32_t  used_lower_bound( const vram_heap_t *self, uint32_t offset )
+{
+    int_fast32_t  low = 0;
+    int_fast32_t  high = self->used_num;
+    int_fast32_t  mid;
+
+    while ( low < high ) {
+        mid = (low + high) / 2;
+        if ( self->block[ self->used_index[ mid ] ].offset < offset ) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return  low;
+}
+
+
+static void  free_insert( vram_heap_t *self, int16_t idx )
+{
+    int_fast32_t  pos = free_lower_bound( self, self->block[ idx ].size, self->block[ idx ].offset );
+
+    memmove( &self->free_index[ pos + 1 ], &self->free_index[ pos ],
+             (size_t)(self->free_num - pos) * sizeof(self->free_index[0]) );
+    self->free_index[ pos ] = idx;
+    self->free_num++;
+    self->block[ idx ].is_free = 1;
+}
+
+
+static void  free_remove( vram_heap_t *self, int16_t idx )
+{
+    int_fast32_t  pos = free_lower_bound( self, self->block[ idx ].size, self->block[ idx ].offset );
+
+    self->free_num--;
+    memmove( &self->free_index[ pos ], &self->free_index[ pos + 1 ],
+             (size_t)(self->free_num - pos) * sizeof(self->free_index[0]) );
+    self->block[ idx ].is_free = 0;
+}
+
+
+static int16_t  new_block( vram_heap_t *self )
+{
+    int16_t  idx = self->unused_top;
+
+    self->unused_top = self->block[ idx ].next;
+    return  idx;
+}
+
+
+static void  delete_block( vram_heap_t *self, int16_t idx )
+{
+    self->block[ idx ].size = 0;
+    self->block[ idx ].next = self->unused_top;
+    self->unused_top = idx;
+}
+
+
+/* Insert a new block of "size" units at the beginning (is_before != 0) or at the end of block "idx" */
+static int16_t  split_block( vram_heap_t *self, int16_t idx, uint32_t size, int is_before )
+{
+    vram_heap_block_t  *b = &self->block[ idx ];
+    int16_t  new_idx = new_block( self );
+    vram_heap_block_t  *n = &self->block[ new_idx ];
+
+    n->size = size;
+    b->size -= size;
+    if ( is_before ) {
+        n->offset = b->offset;
+        b->offset += size;
+        n->prev = b->prev;
+        n->next = idx;
+        if ( b->prev >= 0 ) {
+            self->block[ b->prev ].next = new_idx;
+        }
+        b->prev = new_idx;
+    } else {
+        n->offset = b->offset + b->size;
+        n->prev = idx;
+        n->next = b->next;
+        if ( b->next >= 0 ) {
+            self->block[ b->next ].prev = new_idx;
+        }
+        b->next = new_idx;
+    }
+    return  new_idx;
+}
+
+
+/* Merge block "idx" into the previous block */
+static void  merge_with_prev( vram_heap_t *self, int16_t idx )
+{
+    vram_heap_block_t  *b = &self->block[ idx ];
+    vram_heap_block_t  *p = &self->block[ b->prev ];
+
+    p->size += b->size;
+    p->next = b->next;
+    if ( b->next >= 0 ) {
+        self->block[ b->next ].prev = b->prev;
+    }
+    delete_block( self, idx );
+}
+
+
+static int16_t  first_block( const vram_heap_t *self )
+{
+    int16_t  idx;
+
+    if ( self->used_num > 0 ) {
+        idx = self->used_index[ 0 ];
+    } else if ( self->free_num > 0 ) {
+        idx = self->free_index[ 0 ];
+    } else {
+        return  -1;
+    }
+    while ( self->block[ idx ].prev >= 0 ) {
+        idx = self->block[ idx ].prev;
+    }
+    return  idx;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_Initialize
+************************************************************************/
+int  R_VRAM_HEAP_Initialize( vram_heap_t *self, uint8_t *address, size_t size )
+{
+    uintptr_t  pad;
+    int_fast32_t  i;
+
+    if ( (self == NULL) || (address == NULL) ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    memset( self, 0, sizeof(*self) );
+
+    for ( i = 0; i < VRAM_HEAP_BLOCK_MAX; i++ ) {
+        self->block[ i ].next = (int16_t)(i + 1);
+    }
+    self->block[ VRAM_HEAP_BLOCK_MAX - 1 ].next = -1;
+    self->unused_top = 0;
+
+    pad = (VRAM_HEAP_UNIT - ((uintptr_t) address % VRAM_HEAP_UNIT)) % VRAM_HEAP_UNIT;
+    self->start = address + pad;
+    if ( size < (pad + VRAM_HEAP_UNIT) ) {
+        return  VRAM_HEAP_OK;  /* Empty heap */
+    }
+    self->unit_count = (uint32_t)((size - pad) / VRAM_HEAP_UNIT);
+
+    i = new_block( self );
+    self->block[ i ].offset = 0;
+    self->block[ i ].size = self->unit_count;
+    self->block[ i ].prev = -1;
+    self->block[ i ].next = -1;
+    free_insert( self, (int16_t) i );
+
+    return  VRAM_HEAP_OK;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_Alloc
+************************************************************************/
+int  R_VRAM_HEAP_Alloc( vram_heap_t *self, size_t size, size_t alignment, uint8_t **out_address )
+{
+    uint32_t  units;
+    uint32_t  pad = 0;
+    int_fast32_t  pos;
+    int_fast32_t  unused_num;
+    int16_t   idx = -1;
+    int16_t   i;
+    vram_heap_block_t  *b;
+
+    if ( (self == NULL) || (out_address == NULL) || (size == 0) ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    if ( alignment < VRAM_HEAP_ALIGN_DEFAULT ) {
+        alignment = VRAM_HEAP_ALIGN_DEFAULT;
+    }
+    if ( (alignment > VRAM_HEAP_ALIGN_MAX) || ((alignment & (alignment - 1)) != 0) ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    if ( size > ((size_t) self->unit_count * VRAM_HEAP_UNIT) ) {
+        self->fail_count++;
+        return  VRAM_HEAP_E_NO_MEMORY;
+    }
+    units = (uint32_t)((size + VRAM_HEAP_UNIT - 1) / VRAM_HEAP_UNIT);
+
+    /* Best-fit: the smallest free block which can hold the aligned size */
+    for ( pos = free_lower_bound( self, units, 0 ); pos < self->free_num; pos++ ) {
+        b = &self->block[ self->free_index[ pos ] ];
+        pad = (uint32_t)(((alignment - ((uintptr_t)(self->start + ((size_t) b->offset * VRAM_HEAP_UNIT)) % alignment))
+                          % alignment) / VRAM_HEAP_UNIT);
+        if ( b->size >= (units + pad) ) {
+            idx = self->free_index[ pos ];
+            break;
+        }
+    }
+    if ( idx < 0 ) {
+        self->fail_count++;
+        return  VRAM_HEAP_E_NO_MEMORY;
+    }
+
+    /* Descriptors for the padding and the remainder */
+    unused_num = 0;
+    for ( i = self->unused_top; (i >= 0) && (unused_num < 2); i = self->block[ i ].next ) {
+        unused_num++;
+    }
+    b = &self->block[ idx ];
+    if ( unused_num < (((pad != 0) ? 1 : 0) + ((b->size != (units + pad)) ? 1 : 0)) ) {
+        self->fail_count++;
+        return  VRAM_HEAP_E_NO_BLOCK;
+    }
+
+    free_remove( self, idx );
+    if ( pad != 0 ) {
+        free_insert( self, split_block( self, idx, pad, 1 ) );
+    }
+    if ( b->size != units ) {
+        free_insert( self, split_block( self, idx, b->size - units, 0 ) );
+    }
+
+    pos = used_lower_bound( self, b->offset );
+    memmove( &self->used_index[ pos + 1 ], &self->used_index[ pos ],
+             (size_t)(self->used_num - pos) * sizeof(self->used_index[0]) );
+    self->used_index[ pos ] = idx;
+    self->used_num++;
+
+    self->used_units += units;
+    if ( self->used_units > self->peak_used_units ) {
+        self->peak_used_units = self->used_units;
+    }
+    self->alloc_count++;
+
+    *out_address = self->start + ((size_t) b->offset * VRAM_HEAP_UNIT);
+    return  VRAM_HEAP_OK;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_Free
+************************************************************************/
+int  R_VRAM_HEAP_Free( vram_heap_t *self, const void *address )
+{
+    const uint8_t  *p = (const uint8_t *) address;
+    uint32_t  offset;
+    int_fast32_t  pos;
+    int16_t   idx;
+    vram_heap_block_t  *b;
+
+    if ( (self == NULL) || (p < self->start) ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    if ( ((size_t)(p - self->start) % VRAM_HEAP_UNIT) != 0 ) {
+        return  VRAM_HEAP_E_NOT_ALLOCATED;
+    }
+    offset = (uint32_t)((size_t)(p - self->start) / VRAM_HEAP_UNIT);
+    pos = used_lower_bound( self, offset );
+    if ( (pos >= self->used_num) || (self->block[ self->used_index[ pos ] ].offset != offset) ) {
+        return  VRAM_HEAP_E_NOT_ALLOCATED;
+    }
+    idx = self->used_index[ pos ];
+    self->used_num--;
+    memmove( &self->used_index[ pos ], &self->used_index[ pos + 1 ],
+             (size_t)(self->used_num - pos) * sizeof(self->used_index[0]) );
+
+    b = &self->block[ idx ];
+    self->used_units -= b->size;
+    self->free_count++;
+
+    /* Coalesce with the free neighbours */
+    if ( (b->next >= 0) && (self->block[ b->next ].is_free) ) {
+        free_remove( self, b->next );
+        merge_with_prev( self, b->next );
+    }
+    if ( (b->prev >= 0) && (self->block[ b->prev ].is_free) ) {
+        int16_t  prev = b->prev;
+
+        free_remove( self, prev );
+        merge_with_prev( self, idx );
+        idx = prev;
+    }
+    free_insert( self, idx );
+
+    return  VRAM_HEAP_OK;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_GetSize
+************************************************************************/
+size_t  R_VRAM_HEAP_GetSize( const vram_heap_t *self, const void *address )
+{
+    const uint8_t  *p = (const uint8_t *) address;
+    uint32_t  offset;
+    int_fast32_t  pos;
+
+    if ( (self == NULL) || (p < self->start) || (((size_t)(p - self->start) % VRAM_HEAP_UNIT) != 0) ) {
+        return  0;
+    }
+    offset = (uint32_t)((size_t)(p - self->start) / VRAM_HEAP_UNIT);
+    pos = used_lower_bound( self, offset );
+    if ( (pos >= self->used_num) || (self->block[ self->used_index[ pos ] ].offset != offset) ) {
+        return  0;
+    }
+    return  (size_t) self->block[ self->used_index[ pos ] ].size * VRAM_HEAP_UNIT;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_GetStats
+************************************************************************/
+void  R_VRAM_HEAP_GetStats( const vram_heap_t *self, vram_heap_stats_t *out_stats )
+{
+    if ( (self == NULL) || (out_stats == NULL) ) {
+        return;
+    }
+    memset( out_stats, 0, sizeof(*out_stats) );
+    out_stats->total_size = (size_t) self->unit_count * VRAM_HEAP_UNIT;
+    out_stats->used_size = (size_t) self->used_units * VRAM_HEAP_UNIT;
+    out_stats->free_size = out_stats->total_size - out_stats->used_size;
+    if ( self->free_num > 0 ) {
+        out_stats->largest_free_size =
+            (size_t) self->block[ self->free_index[ self->free_num - 1 ] ].size * VRAM_HEAP_UNIT;
+    }
+    out_stats->peak_used_size = (size_t) self->peak_used_units * VRAM_HEAP_UNIT;
+    out_stats->used_blocks = (uint32_t) self->used_num;
+    out_stats->free_blocks = (uint32_t) self->free_num;
+    out_stats->alloc_count = self->alloc_count;
+    out_stats->free_count = self->free_count;
+    out_stats->fail_count = self->fail_count;
+    if ( out_stats->free_size != 0 ) {
+        out_stats->fragmentation = 1000u - (uint32_t)(((uint64_t) out_stats->largest_free_size * 1000u)
+                                                      / out_stats->free_size);
+    }
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_GetDefragReport
+************************************************************************/
+void  R_VRAM_HEAP_GetDefragReport( const vram_heap_t *self, vram_heap_defrag_report_t *out_report )
+{
+    const vram_heap_block_t  *b;
+    int16_t   idx;
+    size_t    free_size = 0;
+
+    if ( (self == NULL) || (out_report == NULL) ) {
+        return;
+    }
+    memset( out_report, 0, sizeof(*out_report) );
+
+    /* Compaction moves all used blocks after the first hole down to the start */
+    for ( idx = first_block( self ); idx >= 0; idx = b->next ) {
+        b = &self->block[ idx ];
+        if ( b->is_free ) {
+            free_size += (size_t) b->size * VRAM_HEAP_UNIT;
+            if ( b->next >= 0 ) {
+                if ( out_report->first_hole == NULL ) {
+                    out_report->first_hole = self->start + ((size_t) b->offset * VRAM_HEAP_UNIT);
+                }
+                out_report->hole_count++;
+                out_report->hole_size += (size_t) b->size * VRAM_HEAP_UNIT;
+            }
+        } else if ( out_report->first_hole != NULL ) {
+            out_report->move_blocks++;
+            out_report->move_size += (size_t) b->size * VRAM_HEAP_UNIT;
+        }
+    }
+    if ( self->free_num > 0 ) {
+        out_report->largest_free_size =
+            (size_t) self->block[ self->free_index[ self->free_num - 1 ] ].size * VRAM_HEAP_UNIT;
+    }
+    out_report->largest_free_after = free_size;
+}
+
+
+/***********************************************************************
+* Implement: R_VRAM_HEAP_Check
+************************************************************************/
+int  R_VRAM_HEAP_Check( const vram_heap_t *self )
+{
+    const vram_heap_block_t  *b;
+    const vram_heap_block_t  *prev_b;
+    int16_t   idx;
+    int16_t   prev = -1;
+    uint32_t  offset = 0;
+    uint32_t  used_units = 0;
+    int_fast32_t  free_num = 0;
+    int_fast32_t  used_num = 0;
+    int_fast32_t  i;
+
+    if ( self == NULL ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    for ( idx = first_block( self ); idx >= 0; idx = b->next ) {
+        b = &self->block[ idx ];
+        if ( (b->prev != prev) || (b->offset != offset) || (b->size == 0) ) {
+            return  VRAM_HEAP_E_PARAM;
+        }
+        if ( b->is_free ) {
+            if ( (prev >= 0) && (self->block[ prev ].is_free) ) {
+                return  VRAM_HEAP_E_PARAM;  /* not coalesced */
+            }
+            free_num++;
+        } else {
+            used_num++;
+            used_units += b->size;
+        }
+        offset += b->size;
+        prev = idx;
+        if ( (free_num + used_num) > VRAM_HEAP_BLOCK_MAX ) {
+            return  VRAM_HEAP_E_PARAM;
+        }
+    }
+    if ( (offset != self->unit_count) || (free_num != self->free_num) || (used_num != self->used_num)
+            || (used_units != self->used_units) ) {
+        return  VRAM_HEAP_E_PARAM;
+    }
+    for ( i = 1; i < self->free_num; i++ ) {
+        prev_b = &self->block[ self->free_index[ i - 1 ] ];
+        b = &self->block[ self->free_index[ i ] ];
+        if ( (!b->is_free) || (prev_b->size > b->size) || ((prev_b->size == b->size) && (prev_b->offset >= b->offset)) ) {
+            return  VRAM_HEAP_E_PARAM;
+        }
+    }
+    for ( i = 1; i < self->used_num; i++ ) {
+        if ( self->block[ self->used_index[ i - 1 ] ].offset >= self->block[ self->used_index[ i ] ].offset ) {
+            return  VRAM_HEAP_E_PARAM;
+        }
+    }
+
+    return  VRAM_HEAP_OK;
+}
@@ -72,6 +72,9 @@ struct st_r_v_sync_channel_t {
     /** VSync_TargetCount */
     volatile int_fast32_t  VSync_TargetCount;
 
+    /** VSync_TotalCount. Counted at every V-Sync, even if nobody waits */
+    volatile int_fast32_t  VSync_TotalCount;
+
 
     /*-----------------------------------------------------------*/
     /* Group: Interrupt */
@@ -405,6 +408,63 @@ fin:
 }
 
 
+/***********************************************************************
+* Implement: R_V_SYNC_GetVSyncCount
+************************************************************************/
+int_fast32_t  R_V_SYNC_GetVSyncCount( int_fast32_t const  ChannelNum )
+{
+    int_fast32_t  count = 0;
+
+    IF_DQ( (ChannelNum < 0) || (ChannelNum >= R_V_SYNC_CHANNEL_COUNT) ) {
+        goto fin;
+    }
+
+    count = gs_v_sync_channel[ ChannelNum ].VSync_TotalCount;
+
+fin:
+    return  count;
+}
+
+
+/***********************************************************************
+* Implement: R_V_SYNC_GetLatchVSyncCount
+************************************************************************/
+int_fast32_t  R_V_SYNC_GetLatchVSyncCount( int_fast32_t const  ChannelNum )
+{
+    int_fast32_t  count = 0;
+
+    IF_DQ( (ChannelNum < 0) || (ChannelNum >= R_V_SYNC_CHANNEL_COUNT) ) {
+        goto fin;
+    }
+
+    count = gs_v_sync_channel[ ChannelNum ].VSync_TotalCount + 1;
+
+    /* The pending V-Sync has not been counted yet */
+    if ( R_V_SYNC_OnIsInterruptPending( ChannelNum ) ) {
+        count += 1;
+    }
+
+fin:
+    return  count;
+}
+
+
+/***********************************************************************
+* Implement: R_V_SYNC_OnVSync
+************************************************************************/
+void  R_V_SYNC_OnVSync( int_fast32_t const  ChannelNum )
+{
+    IF_DQ( (ChannelNum < 0) || (ChannelNum >= R_V_SYNC_CHANNEL_COUNT) ) {
+        goto fin;
+    }
+
+    gs_v_sync_channel[ ChannelNum ].VSync_TotalCount += 1;
+
+fin:
+    return;
+}
+
+
 /**
 * @brief   Enable interrupt API
 *
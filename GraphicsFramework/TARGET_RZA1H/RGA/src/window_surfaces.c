@@ -262,83 +262,130 @@ fin:
 
 
 /**
-* @brief   free_VRAM_stack_sub
+* @brief   alloc_VRAM_heap_sub
 *
-* @param   in_out_StackPointer in_out_StackPointer
-* @param   frame_buffer frame_buffer
-* @param   StartOfVRAM StartOfVRAM
+* @param   heap heap
+* @param   in_out_FrameBuffer in_out_FrameBuffer
 * @return  Error code, 0=No error
 *
 * @par Description
-*    - If frame_buffer - >buffer_count == 0, do nothing.
+*    - (input) - >stride, ->height, ->buffer_count
+*    - (output) - >buffer_address[(all)]
+*    - All buffers are allocated as one block, as "alloc_VRAM_stack_sub" does.
 */
-static errnum_t  free_VRAM_stack_sub( uint8_t **const  in_out_StackPointer,
-                                      const frame_buffer_t *const  frame_buffer,
-                                      const uint8_t *const  StartOfVRAM ); /* QAC-3450 */
-static errnum_t  free_VRAM_stack_sub( uint8_t **const  in_out_StackPointer,
-                                      const frame_buffer_t *const  frame_buffer,
-                                      const uint8_t *const  StartOfVRAM )
+static errnum_t  alloc_VRAM_heap_sub( vram_heap_t *const  heap,
+                                      frame_buffer_t *const  in_out_FrameBuffer ); /* QAC-3450 */
+static errnum_t  alloc_VRAM_heap_sub( vram_heap_t *const  heap,
+                                      frame_buffer_t *const  in_out_FrameBuffer )
 {
     errnum_t      e;
+    int           ee;
     int_fast32_t  size_1;
-    int_fast32_t  size_all;
     int_fast32_t  buffer_num;
-    uint8_t      *next_stack_pointer;
+    uint8_t      *address;
 
 
-    IF_DQ( frame_buffer == NULL ) {
+    IF_DQ( heap == NULL ) {
         e=E_OTHERS;
         goto fin;
     }
-    IF_DQ( in_out_StackPointer == NULL ) {
+    IF_DQ( in_out_FrameBuffer == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    IF ( in_out_FrameBuffer->buffer_count >
+         (int_fast32_t) R_COUNT_OF( in_out_FrameBuffer->buffer_address ) ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+    IF ( in_out_FrameBuffer->buffer_count <= 0 ) {
         e=E_OTHERS;
         goto fin;
     }
 
 
     /* Set "size_1" */
-    size_1 = frame_buffer->stride * frame_buffer->height;
+    size_1 = in_out_FrameBuffer->stride * in_out_FrameBuffer->height;
     size_1 = ( R_Ceil_64s( size_1 ) );
-    R_STATIC_ASSERT( RGA_STACK_ADDRESS_ALIGNMENT == 64, "" );  /* check of ceil_xx */
+    R_STATIC_ASSERT( RGA_STACK_ADDRESS_ALIGNMENT == VRAM_HEAP_UNIT, "" );
 
 
-    /* Set "size_all" */
-    size_all = frame_buffer->buffer_count * size_1;
+    ee= R_VRAM_HEAP_Alloc( heap, (size_t)( in_out_FrameBuffer->buffer_count * size_1 ),
+                           VRAM_HEAP_ALIGN_DEFAULT, &address );
+    IF ( ee != VRAM_HEAP_OK ) {
+        in_out_FrameBuffer->buffer_count = 0;
+        e=( ee == VRAM_HEAP_E_PARAM ) ? E_OTHERS : E_FEW_ARRAY;
+        goto fin;
+    }
 
 
-    /* Set "next_stack_pointer" */
-    /* ->MISRA 17.4 */ /* ->SEC R1.3.1 (1) */
-    next_stack_pointer = *in_out_StackPointer - size_all;
-    /* MISRA 17.4: Bound check is done by "StartOfVRAM" */
-    /* <-MISRA 17.4 */ /* <-SEC R1.3.1 (1) */
+    /* Set "in_out_FrameBuffer->buffer_address" */
+    for ( buffer_num = 0;
+            buffer_num < in_out_FrameBuffer->buffer_count;
+            buffer_num += 1 ) {
+        in_out_FrameBuffer->buffer_address[ buffer_num ] = address;
 
+        /* ->MISRA 17.4 */ /* ->SEC R1.3.1 (1) */
+        address += size_1;  /* MISRA 17.4: Bound check is done by "R_VRAM_HEAP_Alloc" */
+        /* <-MISRA 17.4 */ /* <-SEC R1.3.1 (1) */
+    }
+    for ( /* buffer_num */;
+                          buffer_num < (int_fast32_t) R_COUNT_OF( in_out_FrameBuffer->buffer_address );
+                          buffer_num += 1 ) {
+        in_out_FrameBuffer->buffer_address[ buffer_num ] = NULL;
+    }
 
-    /* Check */
-    IF ( next_stack_pointer < StartOfVRAM ) {
+    e=0;
+fin:
+    return  e;
+}
+
+
+/**
+* @brief   free_VRAM_heap_sub
+*
+* @param   heap heap
+* @param   frame_buffer frame_buffer
+* @return  Error code, 0=No error
+*
+* @par Description
+*    - If frame_buffer - >buffer_count == 0, do nothing.
+*    - The frame buffers can be freed in any order.
+*/
+static errnum_t  free_VRAM_heap_sub( vram_heap_t *const  heap,
+                                     const frame_buffer_t *const  frame_buffer ); /* QAC-3450 */
+static errnum_t  free_VRAM_heap_sub( vram_heap_t *const  heap,
+                                     const frame_buffer_t *const  frame_buffer )
+{
+    errnum_t  e;
+    int       ee;
+
+
+    IF_DQ( frame_buffer == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+    IF_DQ( heap == NULL ) {
         e=E_OTHERS;
         goto fin;
     }
 
+    if ( frame_buffer->buffer_count == 0 ) {
+        e=0;
+        goto fin;
+    }
     IF ( frame_buffer->buffer_count > (int_fast32_t) R_COUNT_OF( frame_buffer->buffer_address ) ) {
         e=E_OTHERS;
         goto fin;
     }
 
-    for ( buffer_num = frame_buffer->buffer_count - 1;  buffer_num >= 0;  buffer_num -= 1 ) {
-        /* ->MISRA 17.4 */ /* ->SEC R1.3.1 (1) */
-        IF ( frame_buffer->buffer_address[ buffer_num ] !=
-             (next_stack_pointer + (size_1 * buffer_num)) ) {
-            e=E_ACCESS_DENIED;
-            goto fin;
-        }
-        /* MISRA 17.4: Bound check is done by "size_all" */
-        /* <-MISRA 17.4 */ /* <-SEC R1.3.1 (1) */
+    ee= R_VRAM_HEAP_Free( heap, frame_buffer->buffer_address[0] );
+    IF ( ee != VRAM_HEAP_OK ) {
+        e=E_ACCESS_DENIED;
+        goto fin;
     }
 
-
-    /* Set "*in_out_StackPointer" */
-    *in_out_StackPointer = next_stack_pointer;
-
     e=0;
 fin:
     return  e;
@@ -602,6 +649,17 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
     }
 
 
+    if ( IS_BIT_NOT_SET( in_out_config->flags, F_WINDOW_SURFACES_BUFFER_COUNT ) ) {
+        in_out_config->buffer_count = num_2;
+        in_out_config->flags |= F_WINDOW_SURFACES_BUFFER_COUNT;
+    }
+    IF ( in_out_config->buffer_count < num_2  ||
+         in_out_config->buffer_count > frame_buffer_t_max_buffer_count ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+
     /* Set layers */
 #ifndef  RZ_A1L  /* RZ/A1H */
     self->layer_num_min = -1;
@@ -718,6 +776,8 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
         frame_buffer_t  *frame;
         window_surfaces_vdc5_layer_t  *layer = main_layer[ layer_num ];
         pixel_format_t  pixel_format;
+        int_fast32_t    swap_buffer_count;
+        int_fast32_t    buffer_num;
 
         e= R_WINDOW_SURFACES_GetLayerFrameBuffer( self, layer_num, &frame );
         IF(e) {
@@ -732,6 +792,12 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
             pixel_format = in_out_config->pixel_format;
         }
 
+        if ( layer_num <= -1 ) {
+            swap_buffer_count = num_2;
+        } else {
+            swap_buffer_count = in_out_config->buffer_count;
+        }
+
 
         /* Set "self->frame_buffers" */
         frame->buffer_count      = num_2;
@@ -758,49 +824,49 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
                 break;
 
             case PIXEL_FORMAT_RGB565:
-                frame->buffer_count      = num_2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = num_2;
                 layer->vdc5_format = VDC5_GR_FORMAT_RGB565;
                 break;
 
             case PIXEL_FORMAT_ARGB1555:
-                frame->buffer_count      = num_2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = num_2;
                 layer->vdc5_format = VDC5_GR_FORMAT_ARGB1555;
                 break;
 
             case PIXEL_FORMAT_ARGB4444:
-                frame->buffer_count      = num_2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = num_2;
                 layer->vdc5_format = VDC5_GR_FORMAT_ARGB4444;
                 break;
 
             case PIXEL_FORMAT_YUV422:
-                frame->buffer_count      = num_2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = num_2;
                 layer->vdc5_format = VDC5_GR_FORMAT_YCBCR422;
                 break;
 
             case PIXEL_FORMAT_CLUT8:
-                frame->buffer_count      = 2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = R_RGA_BitPerPixelType_To_BytePerPixelType( 8 );
                 layer->vdc5_format = VDC5_GR_FORMAT_CLUT8;
                 break;
 
             case PIXEL_FORMAT_CLUT4:
-                frame->buffer_count      = 2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = R_RGA_BitPerPixelType_To_BytePerPixelType( 4 );
                 layer->vdc5_format = VDC5_GR_FORMAT_CLUT4;
                 break;
 
             case PIXEL_FORMAT_CLUT1:
-                frame->buffer_count      = 2;
+                frame->buffer_count      = swap_buffer_count;
                 frame->draw_buffer_index = 1;
                 frame->byte_per_pixel    = R_RGA_BitPerPixelType_To_BytePerPixelType( 1 );
                 layer->vdc5_format = VDC5_GR_FORMAT_CLUT1;
@@ -823,6 +889,14 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
             goto fin;
         }
 
+        /* All buffers are released */
+        for ( buffer_num = 0;  buffer_num < frame_buffer_t_max_buffer_count;  buffer_num += 1 ) {
+            self->release_fences[ layer_num + self->background_frame_count ][ buffer_num ].v_sync_count =
+                R_V_SYNC_GetVSyncCount( (int_fast32_t) self->screen_channel );
+        }
+        self->present_fences[ layer_num + self->background_frame_count ].v_sync_count =
+            R_V_SYNC_GetVSyncCount( (int_fast32_t) self->screen_channel );
+
 #ifndef R_OSPL_NDEBUG
         printf( "Screen %dx%dx%dx%d vdc5_format=%d stride=%d \n address[0]=0x%08X address[1]=0x%08X\n",
                 frame->buffer_count, frame->width, frame->height, frame->byte_per_pixel,
@@ -833,6 +907,14 @@ errnum_t  R_WINDOW_SURFACES_Initialize( window_surfaces_t *const  self,
     }
 
 
+    /* Offscreen buffers are allocated from the rest of VRAM */
+    IF ( R_VRAM_HEAP_Initialize( &self->heap_of_VRAM, self->stack_pointer_of_VRAM,
+                                 (size_t)( self->over_of_VRAM - self->stack_pointer_of_VRAM ) ) != VRAM_HEAP_OK ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+
     if ( ! self->is_initialized ) {
 
         /* Call "R_VDC5_Initialize" */
@@ -1414,6 +1496,8 @@ static errnum_t  R_WINDOW_SURFACES_SwapBuffers_Sub( window_surfaces_t *const  se
     errnum_t         e;
     vdc5_error_t     error_vdc;
     frame_buffer_t  *frame;
+    int_fast32_t     released_index;
+    int_fast32_t     signal_count;
     window_surfaces_vdc5_layer_t  *layer = NULL;
     /* NULL is for avoiding warning C417W of mbed cloud compiler */
 
@@ -1438,6 +1522,7 @@ static errnum_t  R_WINDOW_SURFACES_SwapBuffers_Sub( window_surfaces_t *const  se
     IF(e) {
         goto fin;
     }
+    released_index = frame->show_buffer_index;
     frame->show_buffer_index = frame->draw_buffer_index;
     frame->draw_buffer_index += 1;
     if ( frame->draw_buffer_index >= (int_t) frame->buffer_count ) {
@@ -1464,6 +1549,10 @@ static errnum_t  R_WINDOW_SURFACES_SwapBuffers_Sub( window_surfaces_t *const  se
             goto fin;
         }
 
+        /* The address is written and the V-Sync count is got with the interrupts disabled. */
+        /* The V-Sync interrupt which is pending at that time is counted in "signal_count" */
+        error_vdc = VDC5_OK;
+        R_OSPL_DisableAllInterrupt();
         if ( attribute->OffsetByte != GS_OFFSET_BYTE_NOT_SHOW ) {
             physical_address += attribute->OffsetByte;
 
@@ -1472,11 +1561,25 @@ static errnum_t  R_WINDOW_SURFACES_SwapBuffers_Sub( window_surfaces_t *const  se
             config.gr_grc         = NULL;
             config.gr_disp_sel    = NULL;
             error_vdc = R_VDC5_ChangeReadProcess( self->screen_channel, layer->data_control_ID, &config );
-            IF ( error_vdc != VDC5_OK ) {
-                e=E_OTHERS;
-                goto  fin;
-            }
         }
+        signal_count = R_V_SYNC_GetLatchVSyncCount( (int_fast32_t) self->screen_channel );
+        R_OSPL_EnableAllInterrupt();
+        IF ( error_vdc != VDC5_OK ) {
+            e=E_OTHERS;
+            goto  fin;
+        }
+    }
+
+
+    /* Set fences */
+    /* The VDC5 reads the new address from the V-Sync of "signal_count" or earlier */
+    {
+        int_fast32_t const  index = layer_num + self->background_frame_count;
+
+        if ( released_index != frame->show_buffer_index ) {
+            self->release_fences[ index ][ released_index ].v_sync_count = signal_count;
+        }
+        self->present_fences[ index ].v_sync_count = signal_count;
     }
 
 
@@ -1539,6 +1642,150 @@ errnum_t  R_WINDOW_SURFACES_WaitForVSync( window_surfaces_t *const  self,
 }
 
 
+/***********************************************************************
+* Implement: R_WINDOW_SURFACES_SwapBuffersAsync
+************************************************************************/
+errnum_t  R_WINDOW_SURFACES_SwapBuffersAsync( window_surfaces_t *const  self,
+        int_fast32_t const  layer_num,  graphics_t *const  context,
+        window_surfaces_fence_t *const  out_present_fence )
+{
+    errnum_t  e;
+
+
+    e= R_GRAPHICS_Finish( context );
+    IF(e!=0) {
+        goto fin;
+    }
+
+
+    e= R_WINDOW_SURFACES_SwapBuffers_Sub( self, layer_num );
+    IF(e!=0) {
+        goto fin;
+    }
+
+
+    if ( out_present_fence != NULL ) {
+        *out_present_fence = self->present_fences[ layer_num + self->background_frame_count ];
+    }
+
+    e=0;
+fin:
+    return  e;
+}
+
+
+/***********************************************************************
+* Implement: R_WINDOW_SURFACES_GetBufferFence
+************************************************************************/
+errnum_t  R_WINDOW_SURFACES_GetBufferFence( const window_surfaces_t *const  self,
+        int_fast32_t const  layer_num,  int_fast32_t const  buffer_index,
+        window_surfaces_fence_t *const  out_release_fence )
+{
+    errnum_t         e;
+    frame_buffer_t  *frame;
+
+    IF_DQ( out_release_fence == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    e= R_WINDOW_SURFACES_GetLayerFrameBuffer( self, layer_num, &frame );
+    IF(e) {
+        goto fin;
+    }
+    IF ( buffer_index < 0  ||  buffer_index >= frame->buffer_count ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    *out_release_fence = self->release_fences[ layer_num + self->background_frame_count ][ buffer_index ];
+
+    e=0;
+fin:
+    return  e;
+}
+
+
+/***********************************************************************
+* Implement: R_WINDOW_SURFACES_IsFenceSignaled
+************************************************************************/
+bool_t  R_WINDOW_SURFACES_IsFenceSignaled( const window_surfaces_t *const  self,
+        const window_surfaces_fence_t *const  fence )
+{
+    bool_t        is_signaled = true;
+    int_fast32_t  operand1;
+    int_fast32_t  operand2;
+
+    IF_DQ( self == NULL  ||  fence == NULL ) {
+        goto fin;
+    }
+
+    operand1 = R_V_SYNC_GetVSyncCount( (int_fast32_t) self->screen_channel );
+    operand2 = fence->v_sync_count;
+    is_signaled = (bool_t)( (operand1 - operand2) >= 0 );
+
+fin:
+    return  is_signaled;
+}
+
+
+/***********************************************************************
+* Implement: R_WINDOW_SURFACES_WaitFence
+************************************************************************/
+errnum_t  R_WINDOW_SURFACES_WaitFence( window_surfaces_t *const  self,
+                                       const window_surfaces_fence_t *const  fence )
+{
+    errnum_t  e;
+
+    IF_DQ( self == NULL  ||  fence == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    while ( ! R_WINDOW_SURFACES_IsFenceSignaled( self, fence ) ) {
+        e= R_V_SYNC_Wait( self->screen_channel, 1, true );
+        IF(e!=0) {
+            goto fin;
+        }
+    }
+
+    e=0;
+fin:
+    return  e;
+}
+
+
+/***********************************************************************
+* Implement: R_WINDOW_SURFACES_WaitForDrawBuffer
+************************************************************************/
+errnum_t  R_WINDOW_SURFACES_WaitForDrawBuffer( window_surfaces_t *const  self,
+        int_fast32_t const  layer_num )
+{
+    errnum_t                 e;
+    frame_buffer_t          *frame;
+    window_surfaces_fence_t  fence;
+
+    e= R_WINDOW_SURFACES_GetLayerFrameBuffer( self, layer_num, &frame );
+    IF(e) {
+        goto fin;
+    }
+
+    e= R_WINDOW_SURFACES_GetBufferFence( self, layer_num, frame->draw_buffer_index, &fence );
+    IF(e) {
+        goto fin;
+    }
+
+    e= R_WINDOW_SURFACES_WaitFence( self, &fence );
+    IF(e) {
+        goto fin;
+    }
+
+    e=0;
+fin:
+    return  e;
+}
+
+
 /**
 * @brief   R_WINDOW_SURFACES_AllocOffscreenStack
 *
@@ -1556,8 +1803,7 @@ errnum_t  R_WINDOW_SURFACES_AllocOffscreenStack( window_surfaces_t *const  self,
         goto fin;
     }
 
-    e= alloc_VRAM_stack_sub( &self->stack_pointer_of_VRAM,  self->over_of_VRAM,
-                             in_out_frame_buffer );
+    e= alloc_VRAM_heap_sub( &self->heap_of_VRAM, in_out_frame_buffer );
     IF(e!=0) {
         goto fin;
     }
@@ -1585,8 +1831,7 @@ errnum_t  R_WINDOW_SURFACES_FreeOffscreenStack( window_surfaces_t *const  self,
         goto fin;
     }
 
-    e= free_VRAM_stack_sub( &self->stack_pointer_of_VRAM, frame_buffer,
-                            self->start_of_VRAM );
+    e= free_VRAM_heap_sub( &self->heap_of_VRAM, frame_buffer );
     IF(e!=0) {
         goto fin;
     }
@@ -1597,6 +1842,64 @@ fin:
 }
 
 
+/**
+* @brief   R_WINDOW_SURFACES_GetOffscreenStats
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+errnum_t  R_WINDOW_SURFACES_GetOffscreenStats( window_surfaces_t *const  self,
+        vram_heap_stats_t *const  out_stats )
+{
+    errnum_t  e;
+
+    IF_DQ( self == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+    IF_DQ( out_stats == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    R_VRAM_HEAP_GetStats( &self->heap_of_VRAM, out_stats );
+
+    e=0;
+fin:
+    return  e;
+}
+
+
+/**
+* @brief   R_WINDOW_SURFACES_GetOffscreenDefragReport
+*
+* @par Parameters
+*    None
+* @return  None.
+*/
+errnum_t  R_WINDOW_SURFACES_GetOffscreenDefragReport( window_surfaces_t *const  self,
+        vram_heap_defrag_report_t *const  out_report )
+{
+    errnum_t  e;
+
+    IF_DQ( self == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+    IF_DQ( out_report == NULL ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
+    R_VRAM_HEAP_GetDefragReport( &self->heap_of_VRAM, out_report );
+
+    e=0;
+fin:
+    return  e;
+}
+
+
 /***********************************************************************
 * Implement: R_WINDOW_SURFACES_DoMessageLoop
 ************************************************************************/
@@ -2141,6 +2444,11 @@ errnum_t  R_VRAM_EX_STACK_Initialize( vram_ex_stack_t *self, void *NullConfig )
     self->Over  = address + size;
     self->StackPointer = self->Start;
 
+    IF ( R_VRAM_HEAP_Initialize( &self->Heap, address, size ) != VRAM_HEAP_OK ) {
+        e=E_OTHERS;
+        goto fin;
+    }
+
     e=0;
 fin:
     return  e;
@@ -2152,7 +2460,7 @@ fin:
 ************************************************************************/
 errnum_t  R_VRAM_EX_STACK_Alloc( vram_ex_stack_t *self, frame_buffer_t *in_out_FrameBuffer )
 {
-    return  alloc_VRAM_stack_sub( &self->StackPointer, self->Over, in_out_FrameBuffer );
+    return  alloc_VRAM_heap_sub( &self->Heap, in_out_FrameBuffer );
 }
 
 
@@ -2161,7 +2469,7 @@ errnum_t  R_VRAM_EX_STACK_Alloc( vram_ex_stack_t *self, frame_buffer_t *in_out_F
 ************************************************************************/
 errnum_t  R_VRAM_EX_STACK_Free( vram_ex_stack_t *self, frame_buffer_t *frame_buffer )
 {
-    return  free_VRAM_stack_sub( &self->StackPointer, frame_buffer, self->Start );
+    return  free_VRAM_heap_sub( &self->Heap, frame_buffer );
 }
 
 
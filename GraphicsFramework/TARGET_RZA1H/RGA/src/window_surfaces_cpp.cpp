@@ -95,7 +95,8 @@ errnum_t  WindowSurfacesClass::initialize( WindowSurfacesConfigClass &in_out_con
         F_WINDOW_SURFACES_PIXEL_FORMAT |
         F_WINDOW_SURFACES_LAYER_COUNT |
         F_WINDOW_SURFACES_BACKGROUND_COLOR |
-        F_WINDOW_SURFACES_BUFFER_HEIGHT;
+        F_WINDOW_SURFACES_BUFFER_HEIGHT |
+        F_WINDOW_SURFACES_BUFFER_COUNT;
 
     if ( in_out_config.buffer_height == GS_DEFAULT_HEIGHT ) {
         in_out_config.flags &= ~F_WINDOW_SURFACES_BUFFER_HEIGHT;
@@ -157,6 +158,61 @@ errnum_t  WindowSurfacesClass::swap_buffers_start( int_fast32_t const  layer_num
 }
 
 
+/***********************************************************************
+* Implement: swap_buffers_async
+************************************************************************/
+#ifdef  IS_WINDOW_SURFACES_EX
+errnum_t  WindowSurfacesClass::swap_buffers_async( int_fast32_t const  layer_num,  Canvas2D_ContextClass  &context,
+        window_surfaces_fence_t *const  out_present_fence )
+{
+    return  R_WINDOW_SURFACES_SwapBuffersAsync( this->_self,  layer_num,  context.c_LanguageContext,  out_present_fence );
+}
+#else
+errnum_t  WindowSurfacesClass::swap_buffers_async( int_fast32_t const  layer_num,  const void *const  null_context,
+        window_surfaces_fence_t *const  out_present_fence )
+{
+    return  R_WINDOW_SURFACES_SwapBuffersAsync( this->_self,  layer_num,  null_context,  out_present_fence );
+}
+#endif
+
+
+/***********************************************************************
+* Implement: get_buffer_fence
+************************************************************************/
+errnum_t  WindowSurfacesClass::get_buffer_fence( int_fast32_t const  layer_num,  int_fast32_t const  buffer_index,
+        window_surfaces_fence_t *const  out_release_fence )
+{
+    return  R_WINDOW_SURFACES_GetBufferFence( this->_self,  layer_num,  buffer_index,  out_release_fence );
+}
+
+
+/***********************************************************************
+* Implement: is_fence_signaled
+************************************************************************/
+bool_t  WindowSurfacesClass::is_fence_signaled( const window_surfaces_fence_t &fence )
+{
+    return  R_WINDOW_SURFACES_IsFenceSignaled( this->_self,  &fence );
+}
+
+
+/***********************************************************************
+* Implement: wait_fence
+************************************************************************/
+errnum_t  WindowSurfacesClass::wait_fence( const window_surfaces_fence_t &fence )
+{
+    return  R_WINDOW_SURFACES_WaitFence( this->_self,  &fence );
+}
+
+
+/***********************************************************************
+* Implement: wait_for_draw_buffer
+************************************************************************/
+errnum_t  WindowSurfacesClass::wait_for_draw_buffer( int_fast32_t const  layer_num )
+{
+    return  R_WINDOW_SURFACES_WaitForDrawBuffer( this->_self,  layer_num );
+}
+
+
 /***********************************************************************
 * Implement: wait_for_v_sync
 ************************************************************************/
@@ -184,6 +240,24 @@ errnum_t  WindowSurfacesClass::free_offscreen_stack( const frame_buffer_t *const
 }
 
 
+/***********************************************************************
+* Implement: get_offscreen_stats
+************************************************************************/
+errnum_t  WindowSurfacesClass::get_offscreen_stats( vram_heap_stats_t *const  out_stats )
+{
+    return  R_WINDOW_SURFACES_GetOffscreenStats( this->_self,  out_stats );
+}
+
+
+/***********************************************************************
+* Implement: get_offscreen_defrag_report
+************************************************************************/
+errnum_t  WindowSurfacesClass::get_offscreen_defrag_report( vram_heap_defrag_report_t *const  out_report )
+{
+    return  R_WINDOW_SURFACES_GetOffscreenDefragReport( this->_self,  out_report );
+}
+
+
 /***********************************************************************
 * Implement: do_message_loop
 ************************************************************************/
@@ -264,6 +338,7 @@ WindowSurfacesConfigClass::WindowSurfacesConfigClass()
     this->layer_count = 1;
     this->buffer_height = GS_DEFAULT_HEIGHT;
     this->background_color.Value = GS_DEFAULT_CLEAR_COLOR;
+    this->buffer_count = 2;
 }
 
 
@@ -0,0 +1,400 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+* @file  vram_heap_test.c
+* @brief   Random trace test of vram_heap on a Linux host
+*
+* R_VRAM_HEAP_Alloc and R_VRAM_HEAP_Free are called with a random trace (frame buffer sizes,
+* small buffers, large alignments, invalid and double frees). After every operation
+* R_VRAM_HEAP_Check must succeed, and the result is compared with a shadow list of the
+* allocated blocks:
+*   - an allocated block is in the heap, aligned, not overlapping another block, and
+*     R_VRAM_HEAP_GetSize returns the rounded size
+*   - the block is taken from the smallest free block which can hold it (best-fit)
+*   - VRAM_HEAP_E_NO_MEMORY is returned only when no free block can hold the request
+*   - a failed call or an invalid free does not change the heap
+*   - the contents of the blocks are not overwritten by other allocations
+*   - the statistics match the shadow list
+*
+* Build (from GraphicsFramework/TARGET_RZA1H/RGA/):
+*   gcc -O2 -Iinc -o vram_heap_test tools/vram_heap_test.c src/vram_heap.c
+*
+* Usage:
+*   vram_heap_test [-n operations] [-s seed] [-m heap_size]
+*     -n  number of operations (default 200000)
+*     -s  seed of the trace (default 1)
+*     -m  size of the heap in bytes (default 0x300000)
+*
+* The exit status is 1 if a check fails. The operation number and the seed are printed.
+*/
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  "vram_heap.h"
+
+#define  SHADOW_MAX      (VRAM_HEAP_BLOCK_MAX)
+#define  STAMP_SIZE      (VRAM_HEAP_UNIT)
+
+typedef struct {
+    uint8_t  *address;
+    size_t    size;             /* Rounded size */
+    uint8_t   stamp;
+} shadow_t;
+
+static vram_heap_t  heap;
+static shadow_t     shadow[ SHADOW_MAX ];
+static int          shadow_num;
+static uint32_t     rand_state;
+static unsigned long  op_no;
+static unsigned long  seed;
+
+static uint32_t  next_rand( void )
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return  rand_state;
+}
+
+static int  fail( const char *message )
+{
+    printf( "NG: operation %lu (seed %lu): %s\n", op_no, seed, message );
+    return  1;
+}
+
+static size_t  round_size( size_t size )
+{
+    return  ((size + VRAM_HEAP_UNIT - 1) / VRAM_HEAP_UNIT) * VRAM_HEAP_UNIT;
+}
+
+static uint32_t  padding( size_t alignment, uint32_t offset )
+{
+    uintptr_t  address = (uintptr_t)(heap.start + ((size_t) offset * VRAM_HEAP_UNIT));
+
+    return  (uint32_t)(((alignment - (address % alignment)) % alignment) / VRAM_HEAP_UNIT);
+}
+
+/* Size (unit) of the smallest free block which can hold the request, 0 = none */
+static uint32_t  best_fit_size( size_t size, size_t alignment )
+{
+    uint32_t  units = (uint32_t)(round_size( size ) / VRAM_HEAP_UNIT);
+    uint32_t  best = 0;
+    int_fast32_t  i;
+
+    for ( i = 0; i < heap.free_num; i++ ) {
+        const vram_heap_block_t  *b = &heap.block[ heap.free_index[ i ] ];
+
+        if ( (b->size >= (units + padding( alignment, b->offset ))) && ((best == 0) || (b->size < best)) ) {
+            best = b->size;
+        }
+    }
+    return  best;
+}
+
+/* Size (unit) of the free block of the snapshot which contains the address, 0 = none */
+static uint32_t  free_block_size_at( const vram_heap_block_t *free_list, int_fast32_t free_num, const uint8_t *address )
+{
+    uint32_t  offset = (uint32_t)((size_t)(address - heap.start) / VRAM_HEAP_UNIT);
+    int_fast32_t  i;
+
+    for ( i = 0; i < free_num; i++ ) {
+        if ( (offset >= free_list[ i ].offset) && (offset < (free_list[ i ].offset + free_list[ i ].size)) ) {
+            return  free_list[ i ].size;
+        }
+    }
+    return  0;
+}
+
+static void  write_stamp( const shadow_t *s )
+{
+    memset( s->address, s->stamp, STAMP_SIZE );
+    memset( s->address + s->size - STAMP_SIZE, s->stamp, STAMP_SIZE );
+}
+
+static int  check_stamp( const shadow_t *s )
+{
+    size_t  i;
+
+    for ( i = 0; i < STAMP_SIZE; i++ ) {
+        if ( (s->address[ i ] != s->stamp) || (s->address[ s->size - STAMP_SIZE + i ] != s->stamp) ) {
+            return  0;
+        }
+    }
+    return  1;
+}
+
+/* Consistency of the heap and the shadow list */
+static int  check_all( void )
+{
+    vram_heap_stats_t  stats;
+    size_t  used = 0;
+    int  i;
+
+    if ( R_VRAM_HEAP_Check( &heap ) != VRAM_HEAP_OK ) {
+        return  fail( "R_VRAM_HEAP_Check" );
+    }
+    for ( i = 0; i < shadow_num; i++ ) {
+        used += shadow[ i ].size;
+        if ( R_VRAM_HEAP_GetSize( &heap, shadow[ i ].address ) != shadow[ i ].size ) {
+            return  fail( "R_VRAM_HEAP_GetSize of an allocated block" );
+        }
+    }
+    R_VRAM_HEAP_GetStats( &heap, &stats );
+    if ( (stats.used_size != used) || (stats.used_blocks != (uint32_t) shadow_num)
+            || ((stats.used_size + stats.free_size) != stats.total_size)
+            || (stats.largest_free_size > stats.free_size) ) {
+        return  fail( "statistics" );
+    }
+    return  0;
+}
+
+static int  do_alloc( void )
+{
+    static const size_t  frame_sizes[] = {
+        480 * 272 * 2, 480 * 272 * 4, 800 * 480 * 2, 320 * 240 * 2, 128 * 128 * 4
+    };
+    vram_heap_stats_t  before;
+    vram_heap_stats_t  after;
+    vram_heap_block_t  free_list[ VRAM_HEAP_BLOCK_MAX ];
+    int_fast32_t  free_num;
+    uint8_t  *address = NULL;
+    size_t  size;
+    size_t  alignment;
+    size_t  min_alignment;
+    uint32_t  best;
+    uint32_t  r = next_rand() % 100;
+    int  e;
+    int  i;
+
+    if ( r < 30 ) {
+        size = frame_sizes[ next_rand() % (sizeof(frame_sizes) / sizeof(frame_sizes[0])) ];
+    } else if ( r < 80 ) {
+        size = 1 + (next_rand() % 8192);
+    } else {
+        size = 1 + (next_rand() % 0x80000);
+    }
+    r = next_rand() % 100;
+    if ( r < 70 ) {
+        alignment = VRAM_HEAP_ALIGN_DEFAULT;
+    } else if ( r < 75 ) {
+        alignment = (size_t)1 << (next_rand() % 6);     /* Less than the default */
+    } else {
+        alignment = (size_t)128 << (next_rand() % 14);  /* 128 to VRAM_HEAP_ALIGN_MAX */
+    }
+    min_alignment = (alignment < VRAM_HEAP_ALIGN_DEFAULT) ? VRAM_HEAP_ALIGN_DEFAULT : alignment;
+
+    best = best_fit_size( size, min_alignment );
+    free_num = heap.free_num;
+    for ( i = 0; i < free_num; i++ ) {
+        free_list[ i ] = heap.block[ heap.free_index[ i ] ];
+    }
+    R_VRAM_HEAP_GetStats( &heap, &before );
+    e = R_VRAM_HEAP_Alloc( &heap, size, alignment, &address );
+    R_VRAM_HEAP_GetStats( &heap, &after );
+
+    if ( e != VRAM_HEAP_OK ) {
+        if ( (e == VRAM_HEAP_E_NO_MEMORY) && (best != 0) ) {
+            return  fail( "VRAM_HEAP_E_NO_MEMORY while a free block can hold the request" );
+        }
+        if ( (e != VRAM_HEAP_E_NO_MEMORY) && (e != VRAM_HEAP_E_NO_BLOCK) ) {
+            return  fail( "unexpected error of R_VRAM_HEAP_Alloc" );
+        }
+        if ( (after.used_size != before.used_size) || (after.free_blocks != before.free_blocks)
+                || (after.fail_count != (before.fail_count + 1)) ) {
+            return  fail( "failed R_VRAM_HEAP_Alloc changed the heap" );
+        }
+        return  0;
+    }
+
+    if ( shadow_num >= SHADOW_MAX ) {
+        return  fail( "more allocated blocks than VRAM_HEAP_BLOCK_MAX" );
+    }
+    if ( (address < heap.start) || ((address + round_size( size )) > (heap.start + ((size_t) heap.unit_count * VRAM_HEAP_UNIT))) ) {
+        return  fail( "block out of the heap" );
+    }
+    if ( ((uintptr_t) address % min_alignment) != 0 ) {
+        return  fail( "block not aligned" );
+    }
+    for ( i = 0; i < shadow_num; i++ ) {
+        if ( (address < (shadow[ i ].address + shadow[ i ].size)) && (shadow[ i ].address < (address + round_size( size ))) ) {
+            return  fail( "block overlaps an allocated block" );
+        }
+    }
+    shadow[ shadow_num ].address = address;
+    shadow[ shadow_num ].size = round_size( size );
+    shadow[ shadow_num ].stamp = (uint8_t)(op_no | 1);
+    shadow_num++;
+
+    /* The block came from a free block of the best-fit size */
+    if ( best == 0 ) {
+        return  fail( "allocated while no free block can hold the request" );
+    }
+    if ( free_block_size_at( free_list, free_num, address ) != best ) {
+        return  fail( "the block is not taken from the best-fit free block" );
+    }
+    if ( after.alloc_count != (before.alloc_count + 1) ) {
+        return  fail( "alloc_count" );
+    }
+    return  0;
+}
+
+static int  do_free( void )
+{
+    vram_heap_stats_t  before;
+    vram_heap_stats_t  after;
+    shadow_t  s;
+    int  i;
+
+    if ( shadow_num == 0 ) {
+        return  0;
+    }
+    i = (int)(next_rand() % (uint32_t) shadow_num);
+    s = shadow[ i ];
+    if ( !check_stamp( &s ) ) {
+        return  fail( "contents of an allocated block were overwritten" );
+    }
+    if ( R_VRAM_HEAP_Free( &heap, s.address ) != VRAM_HEAP_OK ) {
+        return  fail( "R_VRAM_HEAP_Free of an allocated block" );
+    }
+    shadow[ i ] = shadow[ shadow_num - 1 ];
+    shadow_num--;
+
+    /* Double free */
+    R_VRAM_HEAP_GetStats( &heap, &before );
+    if ( (next_rand() % 8) == 0 ) {
+        if ( R_VRAM_HEAP_Free( &heap, s.address ) != VRAM_HEAP_E_NOT_ALLOCATED ) {
+            return  fail( "double free was accepted" );
+        }
+        R_VRAM_HEAP_GetStats( &heap, &after );
+        if ( (after.used_size != before.used_size) || (after.free_count != before.free_count) ) {
+            return  fail( "double free changed the heap" );
+        }
+    }
+    return  0;
+}
+
+static int  do_invalid_free( void )
+{
+    vram_heap_stats_t  before;
+    vram_heap_stats_t  after;
+    const uint8_t  *address;
+    int  e;
+
+    R_VRAM_HEAP_GetStats( &heap, &before );
+    if ( (shadow_num > 0) && ((next_rand() % 2) == 0) ) {
+        /* Inside an allocated block */
+        const shadow_t  *s = &shadow[ next_rand() % (uint32_t) shadow_num ];
+
+        address = s->address + 1 + (next_rand() % (s->size - 1));
+    } else {
+        address = heap.start + (next_rand() % (heap.unit_count * VRAM_HEAP_UNIT));
+        if ( R_VRAM_HEAP_GetSize( &heap, address ) != 0 ) {
+            return  0;
+        }
+    }
+    e = R_VRAM_HEAP_Free( &heap, address );
+    R_VRAM_HEAP_GetStats( &heap, &after );
+    if ( e != VRAM_HEAP_E_NOT_ALLOCATED ) {
+        return  fail( "invalid free was accepted" );
+    }
+    if ( (after.used_size != before.used_size) || (after.free_count != before.free_count) ) {
+        return  fail( "invalid free changed the heap" );
+    }
+    return  0;
+}
+
+int  main( int argc, char *argv[] )
+{
+    unsigned long  op_num = 200000;
+    size_t  heap_size = 0x300000;
+    uint8_t  *memory;
+    vram_heap_stats_t  stats;
+    vram_heap_defrag_report_t  report;
+    unsigned long  alloc_fail = 0;
+    int  i;
+
+    seed = 1;
+    for ( i = 1; i < argc; i++ ) {
+        if ( (strcmp( argv[ i ], "-n" ) == 0) && ((i + 1) < argc) ) {
+            op_num = strtoul( argv[ ++i ], NULL, 0 );
+        } else if ( (strcmp( argv[ i ], "-s" ) == 0) && ((i + 1) < argc) ) {
+            seed = strtoul( argv[ ++i ], NULL, 0 );
+        } else if ( (strcmp( argv[ i ], "-m" ) == 0) && ((i + 1) < argc) ) {
+            heap_size = (size_t) strtoul( argv[ ++i ], NULL, 0 );
+        } else {
+            printf( "usage: vram_heap_test [-n operations] [-s seed] [-m heap_size]\n" );
+            return  2;
+        }
+    }
+    rand_state = (uint32_t)(seed * 2654435761u) | 1u;
+
+    /* The start is not aligned, so the heap aligns it */
+    memory = (uint8_t *) malloc( heap_size + VRAM_HEAP_UNIT );
+    if ( memory == NULL ) {
+        return  2;
+    }
+    if ( R_VRAM_HEAP_Initialize( &heap, memory + 1 + (seed % (VRAM_HEAP_UNIT - 1)), heap_size ) != VRAM_HEAP_OK ) {
+        return  fail( "R_VRAM_HEAP_Initialize" );
+    }
+    if ( check_all() != 0 ) {
+        return  1;
+    }
+
+    for ( op_no = 1; op_no <= op_num; op_no++ ) {
+        uint32_t  r = next_rand() % 100;
+        int  used_before = shadow_num;
+        int  e;
+
+        if ( r < 55 ) {
+            e = do_alloc();
+            if ( (e == 0) && (shadow_num == used_before) ) {
+                alloc_fail++;
+            } else if ( e == 0 ) {
+                write_stamp( &shadow[ shadow_num - 1 ] );
+            }
+        } else if ( r < 95 ) {
+            e = do_free();
+        } else {
+            e = do_invalid_free();
+        }
+        if ( (e != 0) || (check_all() != 0) ) {
+            return  1;
+        }
+    }
+
+    /* Free all: one free block must remain */
+    while ( shadow_num > 0 ) {
+        if ( !check_stamp( &shadow[ 0 ] ) || (R_VRAM_HEAP_Free( &heap, shadow[ 0 ].address ) != VRAM_HEAP_OK) ) {
+            return  fail( "free at the end" );
+        }
+        shadow[ 0 ] = shadow[ --shadow_num ];
+        if ( check_all() != 0 ) {
+            return  1;
+        }
+    }
+    R_VRAM_HEAP_GetStats( &heap, &stats );
+    R_VRAM_HEAP_GetDefragReport( &heap, &report );
+    if ( (stats.free_blocks != 1) || (stats.largest_free_size != stats.total_size) || (report.hole_count != 0) ) {
+        return  fail( "the heap is not one free block after freeing all blocks" );
+    }
+
+    printf( "OK: %lu operations (seed %lu), %lu allocations, %lu failed allocations, peak %lu / %lu bytes\n",
+            op_num, seed, (unsigned long) stats.alloc_count, alloc_fail,
+            (unsigned long) stats.peak_used_size, (unsigned long) stats.total_size );
+    free( memory );
+    return  0;
+}
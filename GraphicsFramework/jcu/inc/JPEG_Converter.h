@@ -35,6 +35,10 @@ Includes   <System Includes> , "Project Includes"
 /******************************************************************************
 Macro definitions
 ******************************************************************************/
+/** Recommended size of a chunk of encode_stream() (multiple of 8 byte, 30KB or less) */
+#ifndef JPEG_CONV_STREAM_CHUNK_SIZE
+#define JPEG_CONV_STREAM_CHUNK_SIZE     (1024 * 8)
+#endif
 
 /** A class to communicate a JCU
  *
@@ -200,7 +204,53 @@ public:
     JPEG_Converter::jpeg_conv_error_t encode(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize );
     JPEG_Converter::jpeg_conv_error_t encode(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize, encode_options_t* pOptions );
 
+    /** Function to receive the encoded data of encode_stream()
+     *
+     * @param[in]   void*                   p_user          : User data passed to encode_stream()
+     * @param[in]   const uint8_t*          p_data          : Encoded data (valid until the function returns)
+     * @param[in]   size_t                  size            : Data size
+     * @return true to continue, false to abort the encode
+     */
+    typedef bool (* encode_sink_func_t)(void * p_user, const uint8_t * p_data, size_t size);
+
+    /** Encode rinear data to JPEG and output the data in chunks
+     *
+     * The JCU pauses every chunk_size bytes of output. The encoded data is written to
+     * the two chunks of pChunkBuff alternately, and each filled chunk is passed to func
+     * while the JCU fills the other one, so the whole JPEG data is never held in RAM and
+     * the size of the encoded data is not limited.
+     * pChunkBuff is written by the JCU like the output buffer of encode(), so place it in
+     * a non-cacheable area (e.g. NC_BSS) aligned to 32 bytes. The JCU has stopped writing
+     * it when encode_stream() returns, even if func returned false.
+     * func is called from the calling thread. encode_buff_size and p_EncodeCallBackFunc
+     * of the options are not used.
+     *
+     * @code
+     * static uint8_t chunk_buf[2 * JPEG_CONV_STREAM_CHUNK_SIZE] __attribute((section("NC_BSS"),aligned(32)));
+     *
+     * Jcu.encode_stream(&bitmap, chunk_buf, JPEG_CONV_STREAM_CHUNK_SIZE, &sink, &file, &encode_size);
+     * @endcode
+     *
+     * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
+     * @param[in]   void*                   pChunkBuff      : Two chunks of chunk_size bytes (2 * chunk_size byte)
+     * @param[in]   size_t                  chunk_size      : Size of a chunk (multiple of 8 byte, 30KB or less)
+     * @param[in]   encode_sink_func_t      func            : Function to receive the encoded data
+     * @param[in]   void*                   p_user          : User data passed to func
+     * @param[out]  size_t*                 pEncodeSize     : Encode size address
+     * @param[in]   encode_options_t*       pOptions        : Encode option(Optional)
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_JCU_ERR         = failure (JCU error or func returned false)
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (input parameter range error)
+     */
+    JPEG_Converter::jpeg_conv_error_t encode_stream(bitmap_buff_info_t* psInputBuff, void* pChunkBuff, size_t chunk_size,
+                                                    encode_sink_func_t func, void* p_user,
+                                                    size_t* pEncodeSize, encode_options_t* pOptions = NULL );
+
     /** Set encode quality
+     *
+     * The quantization tables are held by each instance, so several converters
+     * with different quality settings can share the JCU.
      *
      * @param[in]   uint8_t                  qual           : Encode quality (1 <= qual <= 100)
      * @return JPEG_CONV_OK              = success
@@ -208,8 +258,25 @@ public:
      */
     JPEG_Converter::jpeg_conv_error_t SetQuality(const uint8_t qual);
 
+    /** Make quantization tables for an encode quality
+     *
+     * The tables are scaled from ITU-T T.81 Annex K tables in the same way as SetQuality().
+     *
+     * @param[in]   uint8_t                  qual           : Encode quality (1 <= qual <= 100)
+     * @param[out]  uint8_t*                 p_table_y      : Quantization table (Y) 64 byte
+     * @param[out]  uint8_t*                 p_table_c      : Quantization table (C) 64 byte
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (input parameter range error)
+     */
+    static JPEG_Converter::jpeg_conv_error_t MakeQuantizationTable(const uint8_t qual, uint8_t * p_table_y, uint8_t * p_table_c);
+
 private:
+    uint8_t QuantizationTable_Y[64];    /*!< Quantization table of this context (Y) */
+    uint8_t QuantizationTable_C[64];    /*!< Quantization table of this context (C) */
+    void *  p_context;                  /*!< Asynchronous context of this converter (callback and JCU interrupt state) */
 
+    JPEG_Converter::jpeg_conv_error_t encode_setup(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, encode_options_t* pOptions);
 };
 
 #endif  /* JPEG_CONVERTER_H */
@@ -0,0 +1,172 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          JPEG_ConverterQueue.h
+* @brief         Asynchronous job queue for JPEG_Converter
+******************************************************************************/
+
+#ifndef JPEG_CONVERTER_QUEUE_H
+#define JPEG_CONVERTER_QUEUE_H
+
+#include "mbed.h"
+#include "rtos.h"
+#include "JPEG_Converter.h"
+
+/** The maximum number of jobs waiting in the queue */
+#ifndef JPEG_CONVERTER_QUEUE_DEPTH
+#define JPEG_CONVERTER_QUEUE_DEPTH  (8)
+#endif
+
+/** A class to queue decode/encode jobs to the JCU
+ *
+ * Jobs are executed one by one by a worker thread, so the caller is not blocked
+ * while the JCU is running. Each job refers to a JPEG_Converter instance
+ * (converter context) which holds its own quantization tables and callback state.
+ *
+ * The registers of the next job are not written while a job is running.
+ * The JCU has one register set, and it is reset and rewritten at the start of each job
+ * (codec selection, decode/encode parameters), so the jobs run back-to-back.
+ * The queue saves the wait of the caller, not the setup time of the JCU.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "JPEG_ConverterQueue.h"
+ *
+ * JPEG_Converter camera_ctx;
+ * JPEG_ConverterQueue jcu_queue;
+ * JPEG_ConverterQueue::job_t job;
+ *
+ * void encode_frame(void * p_frame, int width, int height, uint8_t * p_jpeg, size_t size) {
+ *     JPEG_Converter::bitmap_buff_info_t bitmap;
+ *     JPEG_Converter::encode_options_t   options;
+ *
+ *     bitmap.width          = width;
+ *     bitmap.height         = height;
+ *     bitmap.format         = JPEG_Converter::WR_RD_YCbCr422;
+ *     bitmap.buffer_address = p_frame;
+ *     options.encode_buff_size = size;
+ *
+ *     jcu_queue.encode(&camera_ctx, &job, &bitmap, p_jpeg, &options);
+ *     // ... capture the next frame here ...
+ *     if (job.wait() && (job.result == JPEG_Converter::JPEG_CONV_OK)) {
+ *         printf("size %d\r\n", job.encode_size);
+ *     }
+ * }
+ * @endcode
+ */
+class JPEG_ConverterQueue {
+public:
+    /*! @enum job_type_t
+        @brief Kind of job
+     */
+    typedef enum {
+        JOB_DECODE = 0,                 /*!< JPEG to bitmap */
+        JOB_ENCODE = 1,                 /*!< Bitmap to JPEG */
+    } job_type_t;
+
+    /** Job descriptor
+     *
+     * Allocated by the caller and must remain valid until the job has completed.
+     * It works as a future: wait() blocks until the result is available.
+     */
+    class job_t {
+    public:
+        job_t() : done_sem(0), done(true), result(JPEG_Converter::JPEG_CONV_OK), encode_size(0) {
+        }
+
+        /** Wait for the job to complete
+         *
+         * @param millisec timeout value (default: osWaitForever)
+         * @return true if the job has completed
+         */
+        bool wait(uint32_t millisec = osWaitForever);
+
+        Semaphore       done_sem;           /*!< Released when the job has completed */
+        volatile bool   done;               /*!< true if the job has completed (set after func has returned) */
+        volatile JPEG_Converter::jpeg_conv_error_t result;  /*!< Result of decode()/encode() */
+        size_t          encode_size;        /*!< Encode size (encode job only) */
+
+    private:
+        friend class JPEG_ConverterQueue;
+
+        job_type_t                          type;
+        JPEG_Converter                    * context;
+        void                              * p_jpeg;
+        JPEG_Converter::bitmap_buff_info_t  bitmap;
+        JPEG_Converter::decode_options_t    decode_options;
+        JPEG_Converter::encode_options_t    encode_options;
+        Callback<void(job_t *)>             func;
+    };
+
+    /** Constructor: Initializes JPEG_ConverterQueue.
+     *
+     * @param   tsk_pri        Priority of the worker thread. (default: osPriorityNormal).
+     * @param   stack_size     stack size (in bytes) requirements for the worker thread. (default: 2048).
+     */
+    JPEG_ConverterQueue(osPriority tsk_pri = osPriorityNormal, uint32_t stack_size = 2048);
+
+    /** Queue a decode job
+     *
+     * The bitmap information and the options are copied into the job,
+     * so the caller may reuse them as soon as this function returns.
+     *
+     * @param context converter context used for the job
+     * @param job job descriptor
+     * @param pJpegBuff input JPEG data address
+     * @param psOutputBuff output bitmap data information
+     * @param pOptions decode options (NULL: default options)
+     * @param func function called from the worker thread when the job has completed
+     * @return JPEG_CONV_OK if the job was queued, JPEG_CONV_BUSY if the queue is full
+     */
+    JPEG_Converter::jpeg_conv_error_t decode(JPEG_Converter * context, job_t * job, void * pJpegBuff,
+                                             JPEG_Converter::bitmap_buff_info_t * psOutputBuff,
+                                             JPEG_Converter::decode_options_t * pOptions = NULL,
+                                             Callback<void(job_t *)> func = NULL);
+
+    /** Queue an encode job
+     *
+     * The bitmap information and the options are copied into the job,
+     * so the caller may reuse them as soon as this function returns.
+     *
+     * @param context converter context used for the job
+     * @param job job descriptor
+     * @param psInputBuff input bitmap data information
+     * @param pJpegBuff output JPEG data address
+     * @param pOptions encode options (NULL: default options)
+     * @param func function called from the worker thread when the job has completed
+     * @return JPEG_CONV_OK if the job was queued, JPEG_CONV_BUSY if the queue is full
+     */
+    JPEG_Converter::jpeg_conv_error_t encode(JPEG_Converter * context, job_t * job,
+                                             JPEG_Converter::bitmap_buff_info_t * psInputBuff, void * pJpegBuff,
+                                             JPEG_Converter::encode_options_t * pOptions = NULL,
+                                             Callback<void(job_t *)> func = NULL);
+
+    /** Get the number of jobs which have not completed yet
+     *
+     * @return number of jobs (including the running job)
+     */
+    int GetPendingNum(void);
+
+private:
+    Queue<job_t, JPEG_CONVERTER_QUEUE_DEPTH> job_queue;
+    Thread queueThread;
+    volatile uint32_t pending_num;
+
+    JPEG_Converter::jpeg_conv_error_t submit(job_t * job);
+    void queue_process();
+};
+#endif
@@ -0,0 +1,167 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          JPEG_Probe.h
+* @brief         JPEG header probe and decode buffer planner
+******************************************************************************/
+
+#ifndef JPEG_PROBE_H
+#define JPEG_PROBE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "JPEG_Converter.h"
+
+/** A class to read the JPEG header before decoding
+ *
+ * Parses the markers up to SOS (SOF, DQT, DHT, DRI) without decoding the image,
+ * and calculates the bitmap buffer needed by JPEG_Converter::decode().
+ * It does not use the JCU, so it can be used on a host PC too.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "JPEG_Probe.h"
+ *
+ * JPEG_Converter Jcu;
+ *
+ * void * decode_jpeg(uint8_t * p_jpeg, size_t size) {
+ *     JPEG_Probe::jpeg_info_t info;
+ *     JPEG_Probe::output_plan_t plan;
+ *     JPEG_Converter::bitmap_buff_info_t bitmap;
+ *     JPEG_Converter::decode_options_t options;
+ *
+ *     if ((JPEG_Probe::Probe(p_jpeg, size, &info) != JPEG_Converter::JPEG_CONV_OK) || (!info.jcu_supported)) {
+ *         return NULL;
+ *     }
+ *     options.horizontal_sub_sampling = JPEG_Converter::SUB_SAMPLING_1_2;
+ *     options.vertical_sub_sampling   = JPEG_Converter::SUB_SAMPLING_1_2;
+ *     JPEG_Probe::GetOutputPlan(&info, JPEG_Converter::WR_RD_RGB565, &options, &plan);
+ *     bitmap.width          = plan.width;
+ *     bitmap.height         = plan.height;
+ *     bitmap.format         = JPEG_Converter::WR_RD_RGB565;
+ *     bitmap.buffer_address = malloc(plan.buffer_size);
+ *     Jcu.decode(p_jpeg, &bitmap, &options);
+ *     return bitmap.buffer_address;
+ * }
+ * @endcode
+ */
+class JPEG_Probe {
+public:
+    /*! @enum sampling_t
+        @brief Component sampling of the JPEG data
+     */
+    typedef enum {
+        SAMPLING_OTHER   = 0,           /*!< Other sampling */
+        SAMPLING_GRAY    = 1,           /*!< 1 component */
+        SAMPLING_YCC444  = 2,           /*!< YCbCr 4:4:4 */
+        SAMPLING_YCC422  = 3,           /*!< YCbCr 4:2:2 */
+        SAMPLING_YCC420  = 4,           /*!< YCbCr 4:2:0 */
+        SAMPLING_YCC411  = 5,           /*!< YCbCr 4:1:1 */
+    } sampling_t;
+
+    /*! @struct component_info_t
+        @brief Component information of SOF
+     */
+    typedef struct {
+        uint8_t     id;                 /*!< Component identifier */
+        uint8_t     h;                  /*!< Horizontal sampling factor */
+        uint8_t     v;                  /*!< Vertical sampling factor */
+        uint8_t     tq;                 /*!< Quantization table number */
+    } component_info_t;
+
+    /*! @struct jpeg_info_t
+        @brief JPEG header information
+     */
+    typedef struct {
+        int32_t             width;              /*!< Image width */
+        int32_t             height;             /*!< Image height */
+        uint8_t             sof_marker;         /*!< SOFn marker (0xC0: baseline, 0xC2: progressive, ...) */
+        uint8_t             precision;          /*!< Sample precision */
+        uint8_t             component_num;      /*!< Number of components */
+        component_info_t    component[4];       /*!< Components */
+        sampling_t          sampling;           /*!< Component sampling */
+        int32_t             mcu_width;          /*!< MCU width (pixel) */
+        int32_t             mcu_height;         /*!< MCU height (pixel) */
+        uint16_t            restart_interval;   /*!< DRI (0: no restart marker) */
+        uint8_t             qt_defined;         /*!< Defined quantization tables (bit n: table n) */
+        uint8_t             dc_defined;         /*!< Defined DC Huffman tables (bit n: table n) */
+        uint8_t             ac_defined;         /*!< Defined AC Huffman tables (bit n: table n) */
+        bool                jcu_supported;      /*!< true: JPEG_Converter::decode() supports this data */
+        uint32_t            data_offset;        /*!< Offset of the entropy-coded data following SOS */
+        uint32_t            required_size;      /*!< Size of the data needed to continue the probe */
+    } jpeg_info_t;
+
+    /*! @struct output_plan_t
+        @brief Bitmap buffer needed by JPEG_Converter::decode()
+     */
+    typedef struct {
+        int32_t     width;              /*!< bitmap_buff_info_t::width (line offset, pixel) */
+        int32_t     height;             /*!< bitmap_buff_info_t::height (line) */
+        int32_t     image_width;        /*!< Width of the valid image (pixel) */
+        int32_t     image_height;       /*!< Height of the valid image (line) */
+        size_t      buffer_size;        /*!< Size of the bitmap buffer (byte) */
+    } output_plan_t;
+
+    /** Read the JPEG header in a memory
+     *
+     * Only the data up to the SOS marker is read, so a prefix of a file can be passed.
+     * If the data ends before SOS, JPEG_CONV_PARAM_RANGE_ERR is returned and
+     * required_size of info holds the data size needed to continue.
+     *
+     * @param[in]   const void*     p_data      : JPEG data
+     * @param[in]   size_t          size        : Size of the data
+     * @param[out]  jpeg_info_t*    info        : Header information
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_FORMA_ERR       = failure (data format error)
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (the data ends before SOS)
+     */
+    static JPEG_Converter::jpeg_conv_error_t Probe(const void * p_data, size_t size, jpeg_info_t * info);
+
+    /** Read the JPEG header from a file
+     *
+     * The file is read from the current position. APPn and COM segments are skipped by fseek(),
+     * so large Exif data is not read.
+     *
+     * @param[in]   FILE*           fp          : File of the JPEG data
+     * @param[out]  jpeg_info_t*    info        : Header information
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_FORMA_ERR       = failure (data format error)
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (the file ends before SOS)
+     */
+    static JPEG_Converter::jpeg_conv_error_t ProbeFile(FILE * fp, jpeg_info_t * info);
+
+    /** Calculate the bitmap buffer for decoding
+     *
+     * The JCU writes whole MCUs, so the size is rounded up to the MCU and
+     * the line offset is rounded up to 8 bytes.
+     *
+     * @param[in]   const jpeg_info_t*  info        : Header information
+     * @param[in]   wr_rd_format_t      format      : Output format
+     * @param[in]   decode_options_t*   pOptions    : Decode option (sub-sampling, NULL: 1/1)
+     * @param[out]  output_plan_t*      plan        : Bitmap buffer information
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (input parameter range error)
+     */
+    static JPEG_Converter::jpeg_conv_error_t GetOutputPlan(const jpeg_info_t * info, JPEG_Converter::wr_rd_format_t format,
+                                                           const JPEG_Converter::decode_options_t * pOptions, output_plan_t * plan);
+};
+
+#endif  /* JPEG_PROBE_H */
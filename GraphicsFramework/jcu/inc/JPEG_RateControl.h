@@ -0,0 +1,146 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          JPEG_RateControl.h
+* @brief         Target-size rate control for JPEG_Converter
+******************************************************************************/
+
+#ifndef JPEG_RATE_CONTROL_H
+#define JPEG_RATE_CONTROL_H
+
+#include "mbed.h"
+#include "JPEG_Converter.h"
+
+/** The number of frames used to predict the quality */
+#ifndef JPEG_RATE_CONTROL_HISTORY_NUM
+#define JPEG_RATE_CONTROL_HISTORY_NUM       (4)
+#endif
+
+/** The number of quality levels whose quantization tables are cached */
+#ifndef JPEG_RATE_CONTROL_TABLE_CACHE_NUM
+#define JPEG_RATE_CONTROL_TABLE_CACHE_NUM   (4)
+#endif
+
+/** A class to encode JPEG to a target size
+ *
+ * The quality of the next frame is predicted from the size and the quality of the previous frames.
+ * If the encoded size is not within the target size +-10%, the frame is encoded once more
+ * with the quality corrected by the result. The quantization tables are cached per quality level,
+ * so they are not rebuilt every frame.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "JPEG_RateControl.h"
+ *
+ * JPEG_Converter Jcu;
+ * JPEG_RateControl rate_ctl(&Jcu, 1024 * 20);    // 20KB per frame
+ *
+ * size_t encode_frame(JPEG_Converter::bitmap_buff_info_t * p_bitmap, uint8_t * p_jpeg, size_t size) {
+ *     JPEG_Converter::encode_options_t options;
+ *     JPEG_RateControl::rate_result_t result;
+ *     size_t encode_size = 0;
+ *
+ *     options.encode_buff_size = size;
+ *     rate_ctl.encode(p_bitmap, p_jpeg, &encode_size, &options);
+ *     rate_ctl.GetResult(&result);
+ *     printf("Q%d %d.%02dbpp\r\n", result.quality, result.bits_per_pixel_x100 / 100, result.bits_per_pixel_x100 % 100);
+ *     return encode_size;
+ * }
+ * @endcode
+ */
+class JPEG_RateControl {
+public:
+    /*! @struct rate_result_t
+        @brief Result of the last encode
+     */
+    typedef struct {
+        uint8_t     quality;                /*!< Quality of the output data */
+        uint8_t     encode_count;           /*!< Number of times the frame was encoded (1 or 2) */
+        size_t      encode_size;            /*!< Encode size */
+        uint32_t    bits_per_pixel_x100;    /*!< Achieved bits per pixel x 100 */
+    } rate_result_t;
+
+    /** Constructor
+     *
+     * @param converter JPEG_Converter used to encode
+     * @param target_size target size of a JPEG data (byte)
+     * @param quality quality of the first frame (1 - 100)
+     */
+    JPEG_RateControl(JPEG_Converter * converter, size_t target_size, uint8_t quality = 75);
+
+    /** Set the target size
+     *
+     * @param target_size target size of a JPEG data (byte)
+     */
+    void SetTargetSize(size_t target_size);
+
+    /** Limit the range of the quality
+     *
+     * @param min_quality lower limit (1 - 100, default: 5)
+     * @param max_quality upper limit (1 - 100, default: 95)
+     */
+    void SetQualityRange(uint8_t min_quality, uint8_t max_quality);
+
+    /** Clear the history (e.g. when the scene has changed)
+     */
+    void Reset(void);
+
+    /** Encode rinear data to JPEG of the target size
+     *
+     * Encodes synchronously. p_EncodeCallBackFunc, quantization_table_Y and
+     * quantization_table_C of the options are not used.
+     *
+     * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
+     * @param[out]  void*                   pJpegBuff       : Output JPEG data address
+     * @param[out]  size_t*                 pEncodeSize     : Encode size address
+     * @param[in]   encode_options_t*       pOptions        : Encode option(Optional)
+     * @return same as JPEG_Converter::encode()
+     */
+    JPEG_Converter::jpeg_conv_error_t encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize,
+                                             JPEG_Converter::encode_options_t* pOptions = NULL);
+
+    /** Get the result of the last encode
+     *
+     * @param p_result result
+     */
+    void GetResult(rate_result_t * p_result);
+
+private:
+    typedef struct {
+        uint8_t     quality;                /* 0: unused */
+        uint32_t    last_use;
+        uint8_t     table_y[64];
+        uint8_t     table_c[64];
+    } table_cache_t;
+
+    JPEG_Converter * conv;
+    size_t          target;
+    uint8_t         first_quality;
+    uint8_t         min_quality;
+    uint8_t         max_quality;
+    uint32_t        history[JPEG_RATE_CONTROL_HISTORY_NUM];
+    int             history_num;
+    int             history_pos;
+    table_cache_t   table_cache[JPEG_RATE_CONTROL_TABLE_CACHE_NUM];
+    uint32_t        use_count;
+    rate_result_t   result;
+
+    table_cache_t * get_table(uint8_t quality);
+    uint8_t predict_quality(uint32_t complexity);
+    void add_history(uint32_t complexity);
+};
+#endif
@@ -0,0 +1,114 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          JPEG_SoftConverter.h
+* @brief         Software JPEG codec with the JPEG_Converter interface
+******************************************************************************/
+
+#ifndef JPEG_SOFT_CONVERTER_H
+#define JPEG_SOFT_CONVERTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "JPEG_Converter.h"
+
+/** Baseline JPEG encoder/decoder in software
+ *
+ * Works with the same parameter types as JPEG_Converter and does not use the JCU,
+ * so it can be used when the JCU is busy, on targets without a JCU and on a host PC.
+ * The bitmap layout (pixel format, swap setting, Cb/Cr offset, line offset
+ * and sub-sampling) is the same as with the JCU.
+ *
+ * Decode supports baseline (SOF0/SOF1) JPEG with 1 or 3 components.
+ * Encode outputs YCbCr422 JPEG like the JCU, and additionally accepts ARGB8888 and RGB565 input.
+ * Callback functions in the options are called before decode()/encode() returns.
+ *
+ * Example
+ * @code
+ * #include "JPEG_SoftConverter.h"
+ *
+ * JPEG_SoftConverter Jcu;
+ *
+ * size_t encode(uint8_t * p_ycbcr, int width, int height, uint8_t * p_jpeg, size_t size) {
+ *     JPEG_Converter::bitmap_buff_info_t bitmap;
+ *     JPEG_Converter::encode_options_t   options;
+ *     size_t encode_size = 0;
+ *
+ *     bitmap.width          = width;
+ *     bitmap.height         = height;
+ *     bitmap.format         = JPEG_Converter::WR_RD_YCbCr422;
+ *     bitmap.buffer_address = p_ycbcr;
+ *     options.encode_buff_size = size;
+ *     Jcu.SetQuality(60);
+ *     Jcu.encode(&bitmap, p_jpeg, &encode_size, &options);
+ *     return encode_size;
+ * }
+ * @endcode
+ */
+class JPEG_SoftConverter {
+public:
+    /** Constructor method of software JPEG converter(encode/decode)
+     */
+    JPEG_SoftConverter();
+
+    /** Destructor method of software JPEG converter(encode/decode)
+     */
+    virtual ~JPEG_SoftConverter();
+
+    /** Decode JPEG to rinear data
+     *
+     * @param[in]     void*                 pJpegBuff       : Input JPEG data address
+     * @param[in/out] bitmap_buff_info_t*   psOutputBuff    : Output bitmap data address
+     * @param[in]     decode_options_t*     pOptions        : Decode option(Optional)
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_FORMA_ERR       = failure (data format error)
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_BUSY            = failure (work memory cannot be allocated)
+     */
+    JPEG_Converter::jpeg_conv_error_t decode(void* pJpegBuff, JPEG_Converter::bitmap_buff_info_t* psOutputBuff);
+    JPEG_Converter::jpeg_conv_error_t decode(void* pJpegBuff, JPEG_Converter::bitmap_buff_info_t* psOutputBuff,
+                                             JPEG_Converter::decode_options_t* pOptions);
+
+    /** Encode rinear data to JPEG
+     *
+     * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
+     * @param[out]  void*                   pJpegBuff       : Output JPEG data address
+     * @param[out]  size_t*                 pEncodeSize     : Encode size address
+     * @param[in]   encode_options_t*       pOptions[IN]    : Encode option(Optional)
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_FORMA_ERR       = failure (data format error)
+     *         JPEG_CONV_PARAM_ERR       = failure (input parameter error)
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (output buffer is too small)
+     *         JPEG_CONV_BUSY            = failure (work memory cannot be allocated)
+     */
+    JPEG_Converter::jpeg_conv_error_t encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize);
+    JPEG_Converter::jpeg_conv_error_t encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize,
+                                             JPEG_Converter::encode_options_t* pOptions);
+
+    /** Set encode quality
+     *
+     * @param[in]   uint8_t                  qual           : Encode quality (1 <= qual <= 100)
+     * @return JPEG_CONV_OK              = success
+     *         JPEG_CONV_PARAM_RANGE_ERR = failure (input parameter range error)
+     */
+    JPEG_Converter::jpeg_conv_error_t SetQuality(const uint8_t qual);
+
+private:
+    uint8_t QuantizationTable_Y[64];    /*!< Quantization table of this context (Y) */
+    uint8_t QuantizationTable_C[64];    /*!< Quantization table of this context (C) */
+};
+
+#endif  /* JPEG_SOFT_CONVERTER_H */
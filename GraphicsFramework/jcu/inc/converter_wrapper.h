@@ -55,18 +55,34 @@ typedef	enum {
 
 /** Callback function format
  */
-typedef void (mbed_CallbackFunc_t)(mbed_jcu_err_t err_code);
+typedef void (mbed_CallbackFunc_t)(void * p_user, mbed_jcu_err_t err_code);
+
+/*! @struct mbed_jcu_async_t
+    @brief Context of an asynchronous decode/encode. Each JPEG_Converter has its own context.
+ */
+typedef struct {
+    r_ospl_async_t          Async;          /*!< Must be the first member. The interrupt callback gets the context from it */
+    mbed_CallbackFunc_t    *pCallback;      /*!< Callback function address */
+    void                   *pUser;          /*!< Argument of the callback function */
+    size_t                 *pEncodeSize;    /*!< Encode size output address */
+    int32_t                 EncodeCount;    /*!< Number of output buffer pauses */
+    int32_t                 EncodeCountMax; /*!< Maximum number of output buffer pauses */
+    size_t                  DecodeWidth;    /*!< Maximum decode width */
+    size_t                  DecodeHeight;   /*!< Maximum decode height */
+} mbed_jcu_async_t;
 
 
 /**************************************************************************//**
  * @brief       Set callback function address for decode
+ * @param[in]   p_context        Context of the asynchronous decode
  * @param[in]   pSetCallbackAdr  Callback function address
- * @param[in]   p_async          ospl async data address
+ * @param[in]   p_user           Argument of the callback function
  * @param[in]   width            Decode data width
  * @param[in]   height           Decode data height
  * @retval      error code
 ******************************************************************************/
-errnum_t R_wrpper_set_decode_callback(mbed_CallbackFunc_t* pSetCallbackAdr, size_t width, size_t height);
+errnum_t R_wrpper_set_decode_callback(mbed_jcu_async_t* p_context, mbed_CallbackFunc_t* pSetCallbackAdr, void* p_user,
+                                      size_t width, size_t height);
 
 /**************************************************************************//**
  * @brief       Set callback function address for encode
@@ -78,13 +94,15 @@ errnum_t R_wrpper_LocalDecodeCallback(const r_ospl_interrupt_t *InterruptSource,
 
 /**************************************************************************//**
  * @brief       Set callback function address for encode
+ * @param[in]   p_context        Context of the asynchronous encode
  * @param[in]   pSetCallbackAdr  Callback function address
- * @param[in]   p_async          ospl async data address
+ * @param[in]   p_user           Argument of the callback function
  * @param[in]   pSize            Encode size input address
  * @param[in]   count_max        Encode count max num
  * @retval      error code
 ******************************************************************************/
-errnum_t R_wrpper_set_encode_callback(mbed_CallbackFunc_t* pSetCallbackAdr, size_t* pSize, int32_t count_max);
+errnum_t R_wrpper_set_encode_callback(mbed_jcu_async_t* p_context, mbed_CallbackFunc_t* pSetCallbackAdr, void* p_user,
+                                      size_t* pSize, int32_t count_max);
 
 /**************************************************************************//**
  * @brief       Set callback function address for encode
@@ -0,0 +1,143 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "JPEG_ConverterQueue.h"
+
+#define JPEG_HEADER_LETTER_1       (0xFFu)
+#define JPEG_HEADER_LETTER_2       (0xD8u)
+
+bool JPEG_ConverterQueue::job_t::wait(uint32_t millisec) {
+    while (done == false) {
+        if (done_sem.wait(millisec) <= 0) {
+            break;
+        }
+    }
+
+    return done;
+}
+
+JPEG_ConverterQueue::JPEG_ConverterQueue(osPriority tsk_pri, uint32_t stack_size) :
+  queueThread(tsk_pri, stack_size), pending_num(0) {
+    queueThread.start(callback(this, &JPEG_ConverterQueue::queue_process));
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_ConverterQueue::decode(JPEG_Converter * context, job_t * job, void * pJpegBuff,
+                                                              JPEG_Converter::bitmap_buff_info_t * psOutputBuff,
+                                                              JPEG_Converter::decode_options_t * pOptions,
+                                                              Callback<void(job_t *)> func) {
+    uint8_t * pBuff = (uint8_t *)pJpegBuff;
+
+    if ((context == NULL) || (job == NULL) || (pJpegBuff == NULL) || (psOutputBuff == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if (job->done == false) {
+        return JPEG_Converter::JPEG_CONV_BUSY;
+    }
+    // Check JPEG header before queuing, the worker thread only has to start the JCU.
+    if (((uint32_t)(pBuff[0]) != JPEG_HEADER_LETTER_1) ||
+        ((uint32_t)(pBuff[1]) != JPEG_HEADER_LETTER_2)) {
+        return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+    }
+
+    job->type    = JOB_DECODE;
+    job->context = context;
+    job->p_jpeg  = pJpegBuff;
+    job->bitmap  = *psOutputBuff;
+    if (pOptions != NULL) {
+        job->decode_options = *pOptions;
+    } else {
+        job->decode_options = JPEG_Converter::decode_options_t();
+    }
+    job->decode_options.p_DecodeCallBackFunc = NULL;   // The worker thread waits for the JCU.
+    job->func = func;
+
+    return submit(job);
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_ConverterQueue::encode(JPEG_Converter * context, job_t * job,
+                                                              JPEG_Converter::bitmap_buff_info_t * psInputBuff, void * pJpegBuff,
+                                                              JPEG_Converter::encode_options_t * pOptions,
+                                                              Callback<void(job_t *)> func) {
+    if ((context == NULL) || (job == NULL) || (pJpegBuff == NULL) || (psInputBuff == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if (job->done == false) {
+        return JPEG_Converter::JPEG_CONV_BUSY;
+    }
+
+    job->type    = JOB_ENCODE;
+    job->context = context;
+    job->p_jpeg  = pJpegBuff;
+    job->bitmap  = *psInputBuff;
+    if (pOptions != NULL) {
+        job->encode_options = *pOptions;
+    } else {
+        job->encode_options = JPEG_Converter::encode_options_t();
+    }
+    job->encode_options.p_EncodeCallBackFunc = NULL;   // The worker thread waits for the JCU.
+    job->func = func;
+
+    return submit(job);
+}
+
+int JPEG_ConverterQueue::GetPendingNum(void) {
+    return (int)pending_num;
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_ConverterQueue::submit(job_t * job) {
+    job->done        = false;
+    job->result      = JPEG_Converter::JPEG_CONV_OK;
+    job->encode_size = 0;
+    while (job->done_sem.wait(0) > 0) {
+        // discard a release which was not waited for
+    }
+
+    core_util_atomic_incr_u32(&pending_num, 1);
+    if (job_queue.put(job, 0) != osOK) {
+        core_util_atomic_decr_u32(&pending_num, 1);
+        job->done = true;
+        return JPEG_Converter::JPEG_CONV_BUSY;
+    }
+
+    return JPEG_Converter::JPEG_CONV_OK;
+}
+
+void JPEG_ConverterQueue::queue_process() {
+    osEvent evt;
+    job_t * job;
+
+    while (1) {
+        evt = job_queue.get();
+        if (evt.status != osEventMessage) {
+            continue;
+        }
+        job = (job_t *)evt.value.p;
+        if (job->type == JOB_DECODE) {
+            job->result = job->context->decode(job->p_jpeg, &job->bitmap, &job->decode_options);
+        } else {
+            job->result = job->context->encode(&job->bitmap, job->p_jpeg, &job->encode_size, &job->encode_options);
+        }
+        core_util_atomic_decr_u32(&pending_num, 1);
+        if (job->func) {
+            job->func(job);
+        }
+        // done is the last store of the job: once it is true, the caller may submit the job again.
+        // A release left over from the previous run is ignored by wait(), which checks done.
+        __DMB();
+        job->done = true;
+        job->done_sem.release();
+    }
+}
@@ -54,7 +54,6 @@ Macro definitions
 #define  JPEG_HEADER_LETTER_2       (0xD8u)
 #define  ALPHA_VAL_MAX              (0xFF)
 #define  LOC_KIND_COLOR_FORMAT      (3u)
-#define  QUANTIZATION_TABLE_NUM     (2)
 
 #define  ENC_SIZE_MAX               (1024 * 30)
 #define  MASK_8BYTE                 (0xFFFFFFF8)
@@ -109,19 +108,16 @@ Macro definitions
 
 typedef void (JPEG_CallbackFunc_t)(JPEG_Converter::jpeg_conv_error_t err_code);
 
+/* Asynchronous context of each JPEG_Converter */
+typedef struct {
+    mbed_jcu_async_t        jcu_async;
+    JPEG_CallbackFunc_t*    pCallback;
+} jpeg_conv_context_t;
+
+/* The JCU is one unit, so the count, the error flag and the semaphore are shared by all instances */
 static uint32_t             driver_ac_count = 0;
 static bool                 jcu_error_flag;
-static JPEG_CallbackFunc_t* pJPEG_ConverterCallback;
 Semaphore                   jpeg_converter_semaphore(1);
-#if defined(__ICCARM__)
-#pragma data_alignment=32
-static uint8_t QuantizationTable_Y[QUANTIZATION_TABLE_SIZE]@ ".mirrorram";
-#pragma data_alignment=32
-static uint8_t QuantizationTable_C[QUANTIZATION_TABLE_SIZE]@ ".mirrorram";
-#else
-static uint8_t QuantizationTable_Y[QUANTIZATION_TABLE_SIZE]__attribute((section("NC_BSS"),aligned(32)));
-static uint8_t QuantizationTable_C[QUANTIZATION_TABLE_SIZE]__attribute((section("NC_BSS"),aligned(32)));
-#endif
 
 /**************************************************************************//**
  * @brief       Set encode quality
@@ -130,88 +126,21 @@ static uint8_t QuantizationTable_C[QUANTIZATION_TABLE_SIZE]__attribute((section(
 ******************************************************************************/
 JPEG_Converter::jpeg_conv_error_t
 JPEG_Converter::SetQuality(const uint8_t qual) {
-    uint8_t*            pqs[QUANTIZATION_TABLE_NUM];
-    const uint8_t*      pqb[QUANTIZATION_TABLE_NUM];
-    uint8_t*            ptqs;
-    const uint8_t*      ptqb;
-    int_t temp;
-    uint32_t i;
-    uint32_t j;
-
-    /* ITU-T Recommendation T.81 "K.1 Quantization tables for luminance and chrominance components" */
-    /* Table K.1 - Luminance quantization table */
-    const uint8_t quantization_table_y_50[QUANTIZATION_TABLE_SIZE] = {
-        16,  11,  10,  16,  24,  40,  51,  61,
-        12,  12,  14,  19,  26,  58,  60,  55,
-        14,  13,  16,  24,  40,  57,  69,  56,
-        14,  17,  22,  29,  51,  87,  80,  62,
-        18,  22,  37,  56,  68, 109, 103,  77,
-        24,  35,  55,  64,  81, 104, 113,  92,
-        49,  64,  78,  87, 103, 121, 120, 101,
-        72,  92,  95,  98, 112, 100, 103,  99
-    };
-
-    /* Table K.2 - Chrominance quantization table */
-    const uint8_t quantization_table_c_50[QUANTIZATION_TABLE_SIZE] = {
-        17,  18,  24,  47,  99,  99,  99,  99,
-        18,  21,  26,  66,  99,  99,  99,  99,
-        24,  26,  56,  99,  99,  99,  99,  99,
-        47,  66,  99,  99,  99,  99,  99,  99,
-        99,  99,  99,  99,  99,  99,  99,  99,
-        99,  99,  99,  99,  99,  99,  99,  99,
-        99,  99,  99,  99,  99,  99,  99,  99,
-        99,  99,  99,  99,  99,  99,  99,  99
-    };
-
-    if (((int_t)qual < 1) || ((int_t)qual > 100)) {
-        return JPEG_CONV_PARAM_RANGE_ERR;
-    }
-
-    pqs[0] = QuantizationTable_Y;
-    pqb[0] = quantization_table_y_50;
-    pqs[1] = QuantizationTable_C;
-    pqb[1] = quantization_table_c_50;
-
-    for (j = 0; j < QUANTIZATION_TABLE_NUM; j++) {
-        ptqs = pqs[j];
-        ptqb = pqb[j];
-        if ((int_t)qual < 50) {
-            for (i = 0; i < QUANTIZATION_TABLE_SIZE; i++) {
-                temp = (((int_t)ptqb[i] * 100) + (int_t)qual) / (2 * (int_t)qual);
-                if (temp == 0) {
-                    temp = 1;
-                }
-                if (temp > 255) {
-                    temp = 255;
-                }
-                ptqs[i] = (uint8_t)temp;
-            }
-        } else {
-            for (i = 0; i < QUANTIZATION_TABLE_SIZE; i++) {
-                temp = (((200 - (2 * (int_t)qual)) * (int_t)ptqb[i]) + 50) / 100;
-                if (temp == 0) {
-                    temp = 1;
-                }
-                if (temp > 255) {
-                    temp = 255;
-                }
-                ptqs[i] = (uint8_t)temp;
-            }
-        }
-    }
-
-    return JPEG_CONV_OK;
+    return MakeQuantizationTable(qual, QuantizationTable_Y, QuantizationTable_C);
 }
 
 
 /**************************************************************************//**
  * @brief       Callback function from JCU async mode
+ * @param[in]   void*                   p_user         : Context of the converter (jpeg_conv_context_t)
  * @param[in]   mbed_jcu_err_t          err_code       : JCU result
  * @retval      None
 ******************************************************************************/
-void JPEG_CallbackFunction(mbed_jcu_err_t err_code) {
-    if (pJPEG_ConverterCallback != NULL) {
-        pJPEG_ConverterCallback((JPEG_Converter::jpeg_conv_error_t)err_code);
+static void JPEG_CallbackFunction(void* p_user, mbed_jcu_err_t err_code) {
+    jpeg_conv_context_t* p_context = (jpeg_conv_context_t*)p_user;
+
+    if (p_context->pCallback != NULL) {
+        p_context->pCallback((JPEG_Converter::jpeg_conv_error_t)err_code);
     }
     if (err_code != MBED_JCU_E_OK) {
         jcu_error_flag = true;
@@ -227,8 +156,9 @@ void JPEG_CallbackFunction(mbed_jcu_err_t err_code) {
 JPEG_Converter::JPEG_Converter(void) {
     jcu_errorcode_t           jcu_error;
     
+    SetQuality(75);
+    p_context = new jpeg_conv_context_t;
     if (driver_ac_count == 0) {
-        SetQuality(75);
         jcu_error = R_JCU_Initialize(NULL);
         if (jcu_error == JCU_ERROR_OK) {
             driver_ac_count++;
@@ -245,12 +175,16 @@ JPEG_Converter::JPEG_Converter(void) {
  * @retval      None
 ******************************************************************************/
 JPEG_Converter::~JPEG_Converter(void) {
+    // Wait for the end of the asynchronous conversion, which uses the context
+    jpeg_converter_semaphore.wait(0xFFFFFFFFuL); // WAIT
+    jpeg_converter_semaphore.release(); // RELEASE
     if (driver_ac_count > 0) {
         driver_ac_count--;
         if (driver_ac_count == 0) {
             (void)R_JCU_Terminate();
         }
     }
+    delete (jpeg_conv_context_t*)p_context;
 } /* End of destructor method () */
 
 /**************************************************************************//**
@@ -403,8 +337,11 @@ JPEG_Converter::decode(void* pJpegBuff, bitmap_buff_info_t* psOutputBuff, decode
                 }
             }
         } else {
-            pJPEG_ConverterCallback = pOptions->p_DecodeCallBackFunc;
-            jcu_error = R_wrpper_set_decode_callback((mbed_CallbackFunc_t*)JPEG_CallbackFunction, (size_t)calc_width, calc_height);
+            jpeg_conv_context_t* p_cont = (jpeg_conv_context_t*)p_context;
+
+            p_cont->pCallback = pOptions->p_DecodeCallBackFunc;
+            jcu_error = R_wrpper_set_decode_callback(&p_cont->jcu_async, &JPEG_CallbackFunction, p_cont,
+                                                     (size_t)calc_width, calc_height);
             if (jcu_error != JCU_ERROR_OK) {
                 e = JPEG_CONV_JCU_ERR;
                 mutex_release = true;
@@ -426,6 +363,132 @@ fin:
 } /* End of method decode() */
 
 
+/**************************************************************************//**
+ * @brief       Set the tables and the parameters of encode to the JCU
+ * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
+ * @param[out]  void*                   pJpegBuff       : Output JPEG data address
+ * @param[in]   encode_options_t*       pOptions        : Encode option
+ * @retval      error code
+******************************************************************************/
+JPEG_Converter::jpeg_conv_error_t
+JPEG_Converter::encode_setup(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, encode_options_t* pOptions) {
+    jpeg_conv_error_t   e;
+    jcu_errorcode_t     jcu_error;
+    jcu_buffer_param_t  buffer;
+    uint8_t*            TableAddress;
+    jcu_encode_param_t  encode;
+
+    // Select encode
+    jcu_error = R_JCU_SelectCodec(JCU_ENCODE);
+    if (jcu_error != JCU_ERROR_OK) {
+        e = JPEG_CONV_JCU_ERR;
+        goto fin;
+    }
+    /* Set tables */
+    if ( pOptions->quantization_table_Y != NULL ) {
+        TableAddress = (uint8_t*)pOptions->quantization_table_Y;
+    } else {
+        TableAddress = (uint8_t*)QuantizationTable_Y;
+    }
+    jcu_error = R_JCU_SetQuantizationTable( JCU_TABLE_NO_0, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    if ( pOptions->quantization_table_C != NULL ) {
+        TableAddress = (uint8_t*)pOptions->quantization_table_C;
+    } else {
+        TableAddress = (uint8_t*)QuantizationTable_C;
+    }
+    jcu_error = R_JCU_SetQuantizationTable( JCU_TABLE_NO_1, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    if ( pOptions->huffman_table_Y_DC != NULL ) {
+        TableAddress = (uint8_t*)pOptions->huffman_table_Y_DC;
+    } else {
+        TableAddress = (uint8_t*)csaDefaultHuffmanTable_Y_DC;
+    }
+    jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_0, JCU_HUFFMAN_DC, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    if ( pOptions->huffman_table_C_DC != NULL ) {
+        TableAddress = (uint8_t*)pOptions->huffman_table_C_DC;
+    } else {
+        TableAddress = (uint8_t*)csaDefaultHuffmanTable_C_DC;
+    }
+    jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_1, JCU_HUFFMAN_DC, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    if ( pOptions->huffman_table_Y_AC != NULL ) {
+        TableAddress = (uint8_t*)pOptions->huffman_table_Y_AC;
+    } else {
+        TableAddress = (uint8_t*)csaDefaultHuffmanTable_Y_AC;
+    }
+    jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_0, JCU_HUFFMAN_AC, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    if ( pOptions->huffman_table_C_AC != NULL ) {
+        TableAddress = (uint8_t*)pOptions->huffman_table_C_AC;
+    } else {
+        TableAddress = (uint8_t*)csaDefaultHuffmanTable_C_AC;
+    }
+    jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_1, JCU_HUFFMAN_AC, (uint8_t*)TableAddress );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+
+    // JPEG encode
+    buffer.source.swapSetting       = (jcu_swap_t)pOptions->input_swapsetting;
+    buffer.source.address           = (uint32_t *)psInputBuff->buffer_address;
+    buffer.destination.swapSetting  = JCU_SWAP_LONG_WORD_AND_WORD_AND_BYTE;
+    buffer.destination.address      = (uint32_t *)pJpegBuff;
+    buffer.lineOffset               = psInputBuff->width;
+    encode.encodeFormat = (jcu_jpeg_format_t)JCU_JPEG_YCbCr422;
+    encode.QuantizationTable[ JCU_ELEMENT_Y  ] = JCU_TABLE_NO_0;
+    encode.QuantizationTable[ JCU_ELEMENT_Cb ] = JCU_TABLE_NO_1;
+    encode.QuantizationTable[ JCU_ELEMENT_Cr ] = JCU_TABLE_NO_1;
+    encode.HuffmanTable[ JCU_ELEMENT_Y  ] = JCU_TABLE_NO_0;
+    encode.HuffmanTable[ JCU_ELEMENT_Cb ] = JCU_TABLE_NO_1;
+    encode.HuffmanTable[ JCU_ELEMENT_Cr ] = JCU_TABLE_NO_1;
+    encode.DRI_value = pOptions->DRI_value;
+    if ( pOptions->width != 0 ) {
+        encode.width  = pOptions->width;
+    } else {
+        encode.width  = psInputBuff->width;
+    }
+    if ( pOptions->height != 0 ) {
+        encode.height = pOptions->height;
+    } else {
+        encode.height = psInputBuff->height;
+    }
+    encode.inputCbCrOffset = (jcu_cbcr_offset_t)pOptions->input_cb_cr_offset;
+    jcu_error = R_JCU_SetEncodeParam( &encode, &buffer );
+    if ( jcu_error != JCU_ERROR_OK ) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    e = JPEG_CONV_OK;
+fin:
+    return  e;
+} /* End of method encode_setup() */
+
+
 /**************************************************************************//**
  * @brief       Bitmap data encode to JPEG
  * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
@@ -454,9 +517,6 @@ JPEG_Converter::encode(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t*
 
     jpeg_conv_error_t   e;
     jcu_errorcode_t     jcu_error;
-    jcu_buffer_param_t  buffer;
-    uint8_t*            TableAddress;
-    jcu_encode_param_t  encode;
     jcu_count_mode_param_t      count_para;
     int32_t     encode_count;
     int32_t    size_max_count = 1;
@@ -486,117 +546,9 @@ JPEG_Converter::encode(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t*
                 goto  fin;
             }
         }
-        // Select encode
-        jcu_error = R_JCU_SelectCodec(JCU_ENCODE);
-        if (jcu_error != JCU_ERROR_OK) {
-            e = JPEG_CONV_JCU_ERR;
-            mutex_release = true;
-            goto fin;
-        }
-        /* Set tables */
-        if ( pOptions->quantization_table_Y != NULL ) {
-            TableAddress = (uint8_t*)pOptions->quantization_table_Y;
-        } else {
-            TableAddress = (uint8_t*)QuantizationTable_Y;
-        }
-        jcu_error = R_JCU_SetQuantizationTable( JCU_TABLE_NO_0, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-        if ( pOptions->quantization_table_C != NULL ) {
-            TableAddress = (uint8_t*)pOptions->quantization_table_C;
-        } else {
-            TableAddress = (uint8_t*)QuantizationTable_C;
-        }
-        jcu_error = R_JCU_SetQuantizationTable( JCU_TABLE_NO_1, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
+        e = encode_setup(psInputBuff, pJpegBuff, pOptions);
+        if (e != JPEG_CONV_OK) {
             mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-        if ( pOptions->huffman_table_Y_DC != NULL ) {
-            TableAddress = (uint8_t*)pOptions->huffman_table_Y_DC;
-        } else {
-            TableAddress = (uint8_t*)csaDefaultHuffmanTable_Y_DC;
-        }
-        jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_0, JCU_HUFFMAN_DC, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-        if ( pOptions->huffman_table_C_DC != NULL ) {
-            TableAddress = (uint8_t*)pOptions->huffman_table_C_DC;
-        } else {
-            TableAddress = (uint8_t*)csaDefaultHuffmanTable_C_DC;
-        }
-        jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_1, JCU_HUFFMAN_DC, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-        if ( pOptions->huffman_table_Y_AC != NULL ) {
-            TableAddress = (uint8_t*)pOptions->huffman_table_Y_AC;
-        } else {
-            TableAddress = (uint8_t*)csaDefaultHuffmanTable_Y_AC;
-        }
-        jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_0, JCU_HUFFMAN_AC, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-        if ( pOptions->huffman_table_C_AC != NULL ) {
-            TableAddress = (uint8_t*)pOptions->huffman_table_C_AC;
-        } else {
-            TableAddress = (uint8_t*)csaDefaultHuffmanTable_C_AC;
-        }
-        jcu_error = R_JCU_SetHuffmanTable( JCU_TABLE_NO_1, JCU_HUFFMAN_AC, (uint8_t*)TableAddress );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
-            goto fin;
-        }
-
-        // JPEG encode
-        buffer.source.swapSetting       = (jcu_swap_t)pOptions->input_swapsetting;
-        buffer.source.address           = (uint32_t *)psInputBuff->buffer_address;
-        buffer.destination.swapSetting  = JCU_SWAP_LONG_WORD_AND_WORD_AND_BYTE;
-        buffer.destination.address      = (uint32_t *)pJpegBuff;
-        buffer.lineOffset               = psInputBuff->width;
-        encode.encodeFormat = (jcu_jpeg_format_t)JCU_JPEG_YCbCr422;
-        encode.QuantizationTable[ JCU_ELEMENT_Y  ] = JCU_TABLE_NO_0;
-        encode.QuantizationTable[ JCU_ELEMENT_Cb ] = JCU_TABLE_NO_1;
-        encode.QuantizationTable[ JCU_ELEMENT_Cr ] = JCU_TABLE_NO_1;
-        encode.HuffmanTable[ JCU_ELEMENT_Y  ] = JCU_TABLE_NO_0;
-        encode.HuffmanTable[ JCU_ELEMENT_Cb ] = JCU_TABLE_NO_1;
-        encode.HuffmanTable[ JCU_ELEMENT_Cr ] = JCU_TABLE_NO_1;
-        encode.DRI_value = pOptions->DRI_value;
-        if ( pOptions->width != 0 ) {
-            encode.width  = pOptions->width;
-        } else {
-            encode.width  = psInputBuff->width;
-        }
-        if ( pOptions->height != 0 ) {
-            encode.height = pOptions->height;
-        } else {
-            encode.height = psInputBuff->height;
-        }
-        encode.inputCbCrOffset = (jcu_cbcr_offset_t)pOptions->input_cb_cr_offset;
-        jcu_error = R_JCU_SetEncodeParam( &encode, &buffer );
-        if ( jcu_error != JCU_ERROR_OK ) {
-            e = JPEG_CONV_PARAM_RANGE_ERR;
-            mutex_release = true;
-            jcu_error_flag = true;
             goto fin;
         }
         if (pOptions->encode_buff_size > 0) {
@@ -654,8 +606,11 @@ JPEG_Converter::encode(bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t*
             }
             (void)R_JCU_GetEncodedSize(pEncodeSize);
         } else {
-            pJPEG_ConverterCallback = pOptions->p_EncodeCallBackFunc;
-            jcu_error = R_wrpper_set_encode_callback((mbed_CallbackFunc_t*)JPEG_CallbackFunction, pEncodeSize, size_max_count);
+            jpeg_conv_context_t* p_cont = (jpeg_conv_context_t*)p_context;
+
+            p_cont->pCallback = pOptions->p_EncodeCallBackFunc;
+            jcu_error = R_wrpper_set_encode_callback(&p_cont->jcu_async, &JPEG_CallbackFunction, p_cont,
+                                                     pEncodeSize, size_max_count);
             if ( jcu_error != JCU_ERROR_OK ) {
                 e = JPEG_CONV_JCU_ERR;
                 goto fin;
@@ -673,3 +628,147 @@ fin:
     return  e;
 } /* End of method encode() */
 
+/**************************************************************************//**
+ * @brief       Bitmap data encode to JPEG and output the data in chunks
+ * @param[in]   bitmap_buff_info_t*     psInputBuff     : Input bitmap data address
+ * @param[in]   void*                   pChunkBuff      : Two chunks of chunk_size bytes
+ * @param[in]   size_t                  chunk_size      : Size of a chunk
+ * @param[in]   encode_sink_func_t      func            : Function to receive the encoded data
+ * @param[in]   void*                   p_user          : User data passed to func
+ * @param[out]  size_t*                 pEncodeSize     : Encode size address
+ * @param[in]   encode_options_t*       pOptions        : Encode option(Optional)
+ * @retval      error code
+******************************************************************************/
+JPEG_Converter::jpeg_conv_error_t
+JPEG_Converter::encode_stream(bitmap_buff_info_t* psInputBuff, void* pChunkBuff, size_t chunk_size,
+                              encode_sink_func_t func, void* p_user,
+                              size_t* pEncodeSize, encode_options_t* pOptions ) {
+    encode_options_t    Options;
+    uint8_t*            StreamBuffer[2];
+    jpeg_conv_error_t   e;
+    jcu_errorcode_t     jcu_error;
+    jcu_count_mode_param_t      count_para;
+    const jcu_async_status_t*  status;
+    r_ospl_async_t      async;
+    bit_flags32_t       got_flags;
+    errnum_t            err;
+    size_t              total_size;
+    size_t              output_size = 0;
+    int                 buf_idx = 0;
+    bool                sink_result;
+
+    if (pOptions == NULL) {
+        pOptions = &Options;
+    }
+    // Check JCU initialized
+    if (driver_ac_count == 0) {
+        return JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    // Check input address
+    if ((psInputBuff == NULL) || (pChunkBuff == NULL) || (((uint32_t)pChunkBuff & ~MASK_8BYTE) != 0)
+     || (func == NULL) || (pEncodeSize == NULL)) {
+        return JPEG_CONV_PARAM_ERR;  // Input address error
+    }
+    if ((chunk_size == 0) || ((chunk_size & ~MASK_8BYTE) != 0) || (chunk_size > ENC_SIZE_MAX)) {
+        return JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    StreamBuffer[0] = (uint8_t *)pChunkBuff;
+    StreamBuffer[1] = (uint8_t *)pChunkBuff + chunk_size;
+    // JCU Error reset
+    if (jcu_error_flag == true) {
+        (void)R_JCU_Terminate();
+        (void)R_JCU_Initialize(NULL);
+        jcu_error_flag = false;
+    }
+    // Get mutex
+    jpeg_converter_semaphore.wait(0xFFFFFFFFuL); // WAIT
+
+    e = encode_setup(psInputBuff, StreamBuffer[0], pOptions);
+    if (e != JPEG_CONV_OK) {
+        goto fin;
+    }
+
+    // The JCU pauses each time a chunk is filled, and restarts from the address set to restartAddress
+    count_para.inputBuffer.isEnable       = false;
+    count_para.inputBuffer.isInitAddress  = false;
+    count_para.inputBuffer.restartAddress = NULL;
+    count_para.inputBuffer.dataCount      = 0;
+    count_para.outputBuffer.isEnable       = true;
+    count_para.outputBuffer.isInitAddress  = true;
+    count_para.outputBuffer.restartAddress = (uint32_t *)StreamBuffer[0];
+    count_para.outputBuffer.dataCount      = chunk_size;
+    jcu_error = R_JCU_SetCountMode(&count_para);
+    if (jcu_error != JCU_ERROR_OK) {
+        e = JPEG_CONV_PARAM_RANGE_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+
+    jcu_error = R_JCU_Start();
+    if (jcu_error != JCU_ERROR_OK) {
+        e = JPEG_CONV_JCU_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    R_JCU_GetAsyncStatus( &status );
+    while (status->IsPaused != false) {
+        if ((status->SubStatusFlags & JCU_SUB_ENCODE_OUTPUT_PAUSE) == 0) {
+            e = JPEG_CONV_JCU_ERR;
+            jcu_error_flag = true;
+            goto fin;
+        }
+        // The JCU fills the other buffer while the filled chunk is passed to func
+        buf_idx ^= 1;
+        count_para.outputBuffer.restartAddress = (uint32_t *)StreamBuffer[buf_idx];
+        jcu_error = R_JCU_SetCountMode(&count_para);
+        if (jcu_error != JCU_ERROR_OK) {
+            e = JPEG_CONV_JCU_ERR;
+            jcu_error_flag = true;
+            goto fin;
+        }
+        async.Flags = R_F_OSPL_A_Thread;
+        async.A_Thread = R_OSPL_THREAD_GetCurrentId();
+        jcu_error = R_JCU_ContinueAsync( JCU_OUTPUT_BUFFER, &async );
+        if (jcu_error != JCU_ERROR_OK) {
+            e = JPEG_CONV_JCU_ERR;
+            jcu_error_flag = true;
+            goto fin;
+        }
+        sink_result = func(p_user, StreamBuffer[buf_idx ^ 1], chunk_size);
+        // The JCU is writing the other chunk of the caller, so wait for it even if func returned false
+        err = R_OSPL_EVENT_Wait( async.A_EventValue, &got_flags, R_OSPL_INFINITE );
+        if ((err != 0) || (async.ReturnValue != 0) || (sink_result == false)) {
+            e = JPEG_CONV_JCU_ERR;
+            jcu_error_flag = true;
+            goto fin;
+        }
+        output_size += chunk_size;
+        R_JCU_GetAsyncStatus( &status );
+    }
+    (void)R_JCU_GetEncodedSize(&total_size);
+    if (total_size < output_size) {
+        e = JPEG_CONV_JCU_ERR;
+        jcu_error_flag = true;
+        goto fin;
+    }
+    // The last chunk
+    if (total_size > output_size) {
+        if (func(p_user, StreamBuffer[buf_idx], total_size - output_size) == false) {
+            e = JPEG_CONV_JCU_ERR;
+            goto fin;
+        }
+    }
+    *pEncodeSize = total_size;
+    e = JPEG_CONV_OK;
+
+fin:
+    // Do not leave the JCU paused in the middle of the encode (func returned false or JCU error)
+    if (jcu_error_flag == true) {
+        (void)R_JCU_Terminate();
+        (void)R_JCU_Initialize(NULL);
+        jcu_error_flag = false;
+    }
+    jpeg_converter_semaphore.release(); // RELEASE
+
+    return  e;
+} /* End of method encode_stream() */
@@ -0,0 +1,354 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "JPEG_Probe.h"
+
+#define M_SOF0      (0xC0)
+#define M_SOF1      (0xC1)
+#define M_SOF15     (0xCF)
+#define M_DHT       (0xC4)
+#define M_JPG       (0xC8)
+#define M_DAC       (0xCC)
+#define M_RST0      (0xD0)
+#define M_RST7      (0xD7)
+#define M_SOI       (0xD8)
+#define M_EOI       (0xD9)
+#define M_SOS       (0xDA)
+#define M_DQT       (0xDB)
+#define M_DRI       (0xDD)
+#define M_TEM       (0x01)
+
+/* Reads the header sequentially from a memory or a file */
+class probe_reader {
+public:
+    probe_reader() : pos(0), short_data(false) {
+    }
+    virtual ~probe_reader() {
+    }
+    virtual bool read(uint8_t * p_buf, uint32_t size) = 0;
+    virtual bool skip(uint32_t size) = 0;
+
+    uint32_t pos;
+    bool     short_data;
+};
+
+class probe_mem_reader : public probe_reader {
+public:
+    probe_mem_reader(const uint8_t * p_data, size_t size) : p_top(p_data), data_size(size) {
+    }
+    virtual bool read(uint8_t * p_buf, uint32_t size) {
+        if ((pos + size) > data_size) {
+            short_data = true;
+            pos += size;
+            return false;
+        }
+        memcpy(p_buf, &p_top[pos], size);
+        pos += size;
+        return true;
+    }
+    virtual bool skip(uint32_t size) {
+        pos += size;
+        if (pos > data_size) {
+            short_data = true;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t * p_top;
+    size_t data_size;
+};
+
+class probe_file_reader : public probe_reader {
+public:
+    probe_file_reader(FILE * p_fp) : fp(p_fp) {
+    }
+    virtual bool read(uint8_t * p_buf, uint32_t size) {
+        size_t read_size = fread(p_buf, 1, size, fp);
+
+        pos += size;
+        if (read_size != size) {
+            short_data = true;
+            return false;
+        }
+        return true;
+    }
+    virtual bool skip(uint32_t size) {
+        if (fseek(fp, size, SEEK_CUR) != 0) {
+            short_data = true;
+            return false;
+        }
+        pos += size;
+        return true;
+    }
+
+private:
+    FILE * fp;
+};
+
+static void probe_finish(JPEG_Probe::jpeg_info_t * info, bool qt_16bit) {
+    int hmax = 1;
+    int vmax = 1;
+    int i;
+
+    for (i = 0; i < info->component_num; i++) {
+        if (info->component[i].h > hmax) {
+            hmax = info->component[i].h;
+        }
+        if (info->component[i].v > vmax) {
+            vmax = info->component[i].v;
+        }
+    }
+    if (info->component_num == 1) {
+        hmax = 1;   /* non-interleaved: one block per MCU */
+        vmax = 1;
+    }
+    info->mcu_width  = 8 * hmax;
+    info->mcu_height = 8 * vmax;
+
+    info->sampling = JPEG_Probe::SAMPLING_OTHER;
+    if (info->component_num == 1) {
+        info->sampling = JPEG_Probe::SAMPLING_GRAY;
+    } else if ((info->component_num == 3) &&
+               (info->component[1].h == 1) && (info->component[1].v == 1) &&
+               (info->component[2].h == 1) && (info->component[2].v == 1)) {
+        if ((info->component[0].h == 1) && (info->component[0].v == 1)) {
+            info->sampling = JPEG_Probe::SAMPLING_YCC444;
+        } else if ((info->component[0].h == 2) && (info->component[0].v == 1)) {
+            info->sampling = JPEG_Probe::SAMPLING_YCC422;
+        } else if ((info->component[0].h == 2) && (info->component[0].v == 2)) {
+            info->sampling = JPEG_Probe::SAMPLING_YCC420;
+        } else if ((info->component[0].h == 4) && (info->component[0].v == 1)) {
+            info->sampling = JPEG_Probe::SAMPLING_YCC411;
+        } else {
+            /* do nothing */
+        }
+    } else {
+        /* do nothing */
+    }
+
+    /* The JCU decodes baseline YCbCr with 8 bit quantization tables */
+    info->jcu_supported = (info->sof_marker == M_SOF0) && (info->precision == 8) && (qt_16bit == false) &&
+                          (info->sampling != JPEG_Probe::SAMPLING_OTHER) && (info->sampling != JPEG_Probe::SAMPLING_GRAY);
+}
+
+static JPEG_Converter::jpeg_conv_error_t probe_main(probe_reader * rd, JPEG_Probe::jpeg_info_t * info) {
+    JPEG_Converter::jpeg_conv_error_t e = JPEG_Converter::JPEG_CONV_FORMA_ERR;
+    uint8_t buf[17];
+    uint8_t marker;
+    int32_t len;
+    int32_t count;
+    int32_t table_size;
+    bool sof_found = false;
+    bool qt_16bit = false;
+    int i;
+
+    memset(info, 0, sizeof(JPEG_Probe::jpeg_info_t));
+
+    if (!rd->read(buf, 2)) {
+        goto fin;
+    }
+    if ((buf[0] != 0xFF) || (buf[1] != M_SOI)) {
+        goto fin;
+    }
+
+    while (1) {
+        if (!rd->read(buf, 1)) {
+            goto fin;
+        }
+        if (buf[0] != 0xFF) {
+            goto fin;
+        }
+        /* Fill bytes */
+        do {
+            if (!rd->read(buf, 1)) {
+                goto fin;
+            }
+        } while (buf[0] == 0xFF);
+        marker = buf[0];
+        if ((marker == M_SOI) || (marker == M_TEM) || ((marker >= M_RST0) && (marker <= M_RST7))) {
+            continue;
+        }
+        if ((marker == M_EOI) || (marker == 0x00)) {
+            goto fin;
+        }
+        if (!rd->read(buf, 2)) {
+            goto fin;
+        }
+        len = (((int32_t)buf[0] << 8) | buf[1]) - 2;
+        if (len < 0) {
+            goto fin;
+        }
+
+        if ((marker >= M_SOF0) && (marker <= M_SOF15) && (marker != M_DHT) && (marker != M_JPG) && (marker != M_DAC)) {
+            if ((sof_found) || (len < 6)) {
+                goto fin;
+            }
+            if (!rd->read(buf, 6)) {
+                goto fin;
+            }
+            info->sof_marker    = marker;
+            info->precision     = buf[0];
+            info->height        = ((int32_t)buf[1] << 8) | buf[2];
+            info->width         = ((int32_t)buf[3] << 8) | buf[4];
+            info->component_num = buf[5];
+            if ((info->component_num == 0) || (info->component_num > 4) ||
+                (len != (6 + (info->component_num * 3))) || (info->width == 0)) {
+                goto fin;
+            }
+            for (i = 0; i < info->component_num; i++) {
+                if (!rd->read(buf, 3)) {
+                    goto fin;
+                }
+                info->component[i].id = buf[0];
+                info->component[i].h  = buf[1] >> 4;
+                info->component[i].v  = buf[1] & 0x0F;
+                info->component[i].tq = buf[2];
+                if ((info->component[i].h == 0) || (info->component[i].h > 4) ||
+                    (info->component[i].v == 0) || (info->component[i].v > 4) || (info->component[i].tq > 3)) {
+                    goto fin;
+                }
+            }
+            sof_found = true;
+        } else if (marker == M_DQT) {
+            while (len > 0) {
+                if (!rd->read(buf, 1)) {
+                    goto fin;
+                }
+                table_size = ((buf[0] >> 4) != 0) ? 128 : 64;
+                if ((buf[0] & 0x0F) > 3) {
+                    goto fin;
+                }
+                if (table_size == 128) {
+                    qt_16bit = true;
+                }
+                info->qt_defined |= (uint8_t)(1u << (buf[0] & 0x0F));
+                len -= 1 + table_size;
+                if ((len < 0) || (!rd->skip(table_size))) {
+                    goto fin;
+                }
+            }
+        } else if (marker == M_DHT) {
+            while (len > 0) {
+                if ((len < 17) || (!rd->read(buf, 17))) {
+                    goto fin;
+                }
+                if (((buf[0] >> 4) > 1) || ((buf[0] & 0x0F) > 3)) {
+                    goto fin;
+                }
+                if ((buf[0] >> 4) == 0) {
+                    info->dc_defined |= (uint8_t)(1u << (buf[0] & 0x0F));
+                } else {
+                    info->ac_defined |= (uint8_t)(1u << (buf[0] & 0x0F));
+                }
+                count = 0;
+                for (i = 1; i < 17; i++) {
+                    count += buf[i];
+                }
+                len -= 17 + count;
+                if ((count > 256) || (len < 0) || (!rd->skip(count))) {
+                    goto fin;
+                }
+            }
+        } else if (marker == M_DRI) {
+            if ((len != 2) || (!rd->read(buf, 2))) {
+                goto fin;
+            }
+            info->restart_interval = (uint16_t)(((uint32_t)buf[0] << 8) | buf[1]);
+        } else if (marker == M_SOS) {
+            if ((!sof_found) || (!rd->skip(len))) {
+                goto fin;
+            }
+            info->data_offset = rd->pos;
+            probe_finish(info, qt_16bit);
+            e = JPEG_Converter::JPEG_CONV_OK;
+            goto fin;
+        } else {
+            /* APPn, COM, DNL, ... */
+            if (!rd->skip(len)) {
+                goto fin;
+            }
+        }
+    }
+
+fin:
+    if (rd->short_data) {
+        info->required_size = rd->pos;
+        e = JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+
+    return e;
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_Probe::Probe(const void * p_data, size_t size, jpeg_info_t * info) {
+    if ((p_data == NULL) || (info == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    probe_mem_reader rd((const uint8_t *)p_data, size);
+
+    return probe_main(&rd, info);
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_Probe::ProbeFile(FILE * fp, jpeg_info_t * info) {
+    if ((fp == NULL) || (info == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    probe_file_reader rd(fp);
+
+    return probe_main(&rd, info);
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_Probe::GetOutputPlan(const jpeg_info_t * info, JPEG_Converter::wr_rd_format_t format,
+                                                            const JPEG_Converter::decode_options_t * pOptions, output_plan_t * plan) {
+    int32_t hs = 0;
+    int32_t vs = 0;
+    int32_t byte_per_pixel;
+    int32_t align;
+
+    if ((info == NULL) || (plan == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if ((info->width <= 0) || (info->height <= 0) || (info->mcu_width <= 0) || (info->mcu_height <= 0)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    if (format == JPEG_Converter::WR_RD_ARGB8888) {
+        byte_per_pixel = 4;
+    } else if ((format == JPEG_Converter::WR_RD_RGB565) || (format == JPEG_Converter::WR_RD_YCbCr422)) {
+        byte_per_pixel = 2;
+    } else {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    if (pOptions != NULL) {
+        hs = (int32_t)pOptions->horizontal_sub_sampling;
+        vs = (int32_t)pOptions->vertical_sub_sampling;
+    }
+    if ((hs < 0) || (hs > 3) || (vs < 0) || (vs > 3)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+
+    plan->image_width  = (info->width + (1 << hs) - 1) >> hs;
+    plan->image_height = (info->height + (1 << vs) - 1) >> vs;
+    /* Whole MCUs are written */
+    plan->width  = (((info->width + info->mcu_width - 1) / info->mcu_width) * info->mcu_width) >> hs;
+    plan->height = (((info->height + info->mcu_height - 1) / info->mcu_height) * info->mcu_height) >> vs;
+    /* The line offset is a multiple of 8 bytes */
+    align = 8 / byte_per_pixel;
+    plan->width = (plan->width + align - 1) & ~(align - 1);
+    plan->buffer_size = (size_t)plan->width * (size_t)plan->height * (size_t)byte_per_pixel;
+
+    return JPEG_Converter::JPEG_CONV_OK;
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+/**************************************************************************//**
+* @file         JPEG_Quantization.cpp
+* @brief        Quantization tables for the encode quality
+******************************************************************************/
+
+/******************************************************************************
+Includes   <System Includes> , "Project Includes"
+******************************************************************************/
+#include  <stdint.h>
+#include  <stddef.h>
+#include  "JPEG_Converter.h"
+
+/******************************************************************************
+Macro definitions
+******************************************************************************/
+#define  QUANTIZATION_TABLE_SIZE    (64u)
+#define  QUANTIZATION_TABLE_NUM     (2)
+
+/* ITU-T Recommendation T.81 "K.1 Quantization tables for luminance and chrominance components" */
+/* Table K.1 - Luminance quantization table */
+static const uint8_t quantization_table_y_50[QUANTIZATION_TABLE_SIZE] = {
+    16,  11,  10,  16,  24,  40,  51,  61,
+    12,  12,  14,  19,  26,  58,  60,  55,
+    14,  13,  16,  24,  40,  57,  69,  56,
+    14,  17,  22,  29,  51,  87,  80,  62,
+    18,  22,  37,  56,  68, 109, 103,  77,
+    24,  35,  55,  64,  81, 104, 113,  92,
+    49,  64,  78,  87, 103, 121, 120, 101,
+    72,  92,  95,  98, 112, 100, 103,  99
+};
+
+/* Table K.2 - Chrominance quantization table */
+static const uint8_t quantization_table_c_50[QUANTIZATION_TABLE_SIZE] = {
+    17,  18,  24,  47,  99,  99,  99,  99,
+    18,  21,  26,  66,  99,  99,  99,  99,
+    24,  26,  56,  99,  99,  99,  99,  99,
+    47,  66,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99,
+    99,  99,  99,  99,  99,  99,  99,  99
+};
+
+/**************************************************************************//**
+ * @brief       Make quantization tables for the encode quality
+ * @param[in]   uint8_t                 qual            : Encode quality (1 <= qual <= 100)
+ * @param[out]  uint8_t*                p_table_y       : Quantization table (Y)
+ * @param[out]  uint8_t*                p_table_c       : Quantization table (C)
+ * @retval      error code
+******************************************************************************/
+JPEG_Converter::jpeg_conv_error_t
+JPEG_Converter::MakeQuantizationTable(const uint8_t qual, uint8_t * p_table_y, uint8_t * p_table_c) {
+    uint8_t*            pqs[QUANTIZATION_TABLE_NUM];
+    const uint8_t*      pqb[QUANTIZATION_TABLE_NUM];
+    uint8_t*            ptqs;
+    const uint8_t*      ptqb;
+    int temp;
+    uint32_t i;
+    uint32_t j;
+
+    if (((int)qual < 1) || ((int)qual > 100)) {
+        return JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    if ((p_table_y == NULL) || (p_table_c == NULL)) {
+        return JPEG_CONV_PARAM_ERR;
+    }
+
+    pqs[0] = p_table_y;
+    pqb[0] = quantization_table_y_50;
+    pqs[1] = p_table_c;
+    pqb[1] = quantization_table_c_50;
+
+    for (j = 0; j < QUANTIZATION_TABLE_NUM; j++) {
+        ptqs = pqs[j];
+        ptqb = pqb[j];
+        if ((int)qual < 50) {
+            for (i = 0; i < QUANTIZATION_TABLE_SIZE; i++) {
+                temp = (((int)ptqb[i] * 100) + (int)qual) / (2 * (int)qual);
+                if (temp == 0) {
+                    temp = 1;
+                }
+                if (temp > 255) {
+                    temp = 255;
+                }
+                ptqs[i] = (uint8_t)temp;
+            }
+        } else {
+            for (i = 0; i < QUANTIZATION_TABLE_SIZE; i++) {
+                temp = (((200 - (2 * (int)qual)) * (int)ptqb[i]) + 50) / 100;
+                if (temp == 0) {
+                    temp = 1;
+                }
+                if (temp > 255) {
+                    temp = 255;
+                }
+                ptqs[i] = (uint8_t)temp;
+            }
+        }
+    }
+
+    return JPEG_CONV_OK;
+}
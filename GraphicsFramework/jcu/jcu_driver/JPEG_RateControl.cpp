@@ -0,0 +1,217 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "JPEG_RateControl.h"
+
+#define RATIO_BASE          (256)   /* size ratio of quality 50 */
+#define RATIO_STEP          (5)
+
+/* Relative encode size for each 5 steps of the quality (quality 50 = 256).
+ * Average of the Annex K tables on several 320x240 images, headers included. */
+static const uint16_t size_ratio_table[(100 / RATIO_STEP) + 1] = {
+      89,  106,  123,  142,  159,  177,  194,  211,  226,  242,
+     256,  272,  290,  316,  347,  384,  440,  519,  653,  947,
+    2284
+};
+
+static uint32_t size_ratio(uint8_t quality) {
+    int idx = quality / RATIO_STEP;
+    int rem = quality % RATIO_STEP;
+
+    if (idx >= (100 / RATIO_STEP)) {
+        return size_ratio_table[100 / RATIO_STEP];
+    }
+    return size_ratio_table[idx] + (((size_ratio_table[idx + 1] - size_ratio_table[idx]) * rem) / RATIO_STEP);
+}
+
+JPEG_RateControl::JPEG_RateControl(JPEG_Converter * converter, size_t target_size, uint8_t quality) :
+  conv(converter), target(target_size), first_quality(quality), min_quality(5), max_quality(95),
+  history_num(0), history_pos(0), use_count(0) {
+    int i;
+
+    if ((first_quality < 1) || (first_quality > 100)) {
+        first_quality = 75;
+    }
+    for (i = 0; i < JPEG_RATE_CONTROL_TABLE_CACHE_NUM; i++) {
+        table_cache[i].quality = 0;
+        table_cache[i].last_use = 0;
+    }
+    memset(&result, 0, sizeof(result));
+}
+
+void JPEG_RateControl::SetTargetSize(size_t target_size) {
+    target = target_size;
+}
+
+void JPEG_RateControl::SetQualityRange(uint8_t min_q, uint8_t max_q) {
+    if ((min_q < 1) || (max_q > 100) || (min_q > max_q)) {
+        return;
+    }
+    min_quality = min_q;
+    max_quality = max_q;
+}
+
+void JPEG_RateControl::Reset(void) {
+    history_num = 0;
+    history_pos = 0;
+}
+
+void JPEG_RateControl::GetResult(rate_result_t * p_result) {
+    if (p_result != NULL) {
+        *p_result = result;
+    }
+}
+
+JPEG_RateControl::table_cache_t * JPEG_RateControl::get_table(uint8_t quality) {
+    table_cache_t * p_entry = &table_cache[0];
+    int i;
+
+    use_count++;
+    for (i = 0; i < JPEG_RATE_CONTROL_TABLE_CACHE_NUM; i++) {
+        if (table_cache[i].quality == quality) {
+            table_cache[i].last_use = use_count;
+            return &table_cache[i];
+        }
+        if (table_cache[i].last_use < p_entry->last_use) {
+            p_entry = &table_cache[i];
+        }
+    }
+
+    // Replace the least recently used entry
+    if (JPEG_Converter::MakeQuantizationTable(quality, p_entry->table_y, p_entry->table_c) != JPEG_Converter::JPEG_CONV_OK) {
+        return NULL;
+    }
+    p_entry->quality = quality;
+    p_entry->last_use = use_count;
+
+    return p_entry;
+}
+
+/* complexity : encode size converted to quality 50 */
+uint8_t JPEG_RateControl::predict_quality(uint32_t complexity) {
+    uint8_t quality;
+
+    for (quality = max_quality; quality > min_quality; quality--) {
+        if ((((uint64_t)complexity * size_ratio(quality)) / RATIO_BASE) <= target) {
+            break;
+        }
+    }
+
+    return quality;
+}
+
+void JPEG_RateControl::add_history(uint32_t complexity) {
+    history[history_pos] = complexity;
+    history_pos++;
+    if (history_pos >= JPEG_RATE_CONTROL_HISTORY_NUM) {
+        history_pos = 0;
+    }
+    if (history_num < JPEG_RATE_CONTROL_HISTORY_NUM) {
+        history_num++;
+    }
+}
+
+JPEG_Converter::jpeg_conv_error_t JPEG_RateControl::encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff,
+                                                           size_t* pEncodeSize, JPEG_Converter::encode_options_t* pOptions) {
+    JPEG_Converter::jpeg_conv_error_t e;
+    JPEG_Converter::encode_options_t options;
+    table_cache_t * p_table;
+    uint32_t complexity;
+    uint64_t sum;
+    uint32_t pixels;
+    size_t encode_size;
+    uint8_t quality;
+    uint8_t next_quality;
+    int encode_count;
+    int i;
+
+    if ((conv == NULL) || (psInputBuff == NULL) || (pEncodeSize == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if (pOptions != NULL) {
+        options = *pOptions;
+    }
+    options.p_EncodeCallBackFunc = NULL;   // The result is needed to control the next encode.
+
+    // Predict the quality from the average of the previous frames
+    if (history_num > 0) {
+        sum = 0;
+        for (i = 0; i < history_num; i++) {
+            sum += history[i];
+        }
+        quality = predict_quality((uint32_t)(sum / history_num));
+    } else {
+        quality = first_quality;
+        if (quality < min_quality) {
+            quality = min_quality;
+        } else if (quality > max_quality) {
+            quality = max_quality;
+        }
+    }
+
+    for (encode_count = 1; ; encode_count++) {
+        p_table = get_table(quality);
+        if (p_table == NULL) {
+            return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+        }
+        options.quantization_table_Y = p_table->table_y;
+        options.quantization_table_C = p_table->table_c;
+        encode_size = 0;
+        e = conv->encode(psInputBuff, pJpegBuff, &encode_size, &options);
+        if (e == JPEG_Converter::JPEG_CONV_OK) {
+            complexity = (uint32_t)(((uint64_t)encode_size * RATIO_BASE) / size_ratio(quality));
+        } else if ((e == JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR) && (options.encode_buff_size > 0)) {
+            // The output buffer overflowed: the actual size is unknown, assume twice the buffer.
+            complexity = (uint32_t)(((uint64_t)options.encode_buff_size * 2 * RATIO_BASE) / size_ratio(quality));
+        } else {
+            return e;
+        }
+        if (encode_count >= 2) {
+            break;
+        }
+        // Within the target size +-10%
+        if ((e == JPEG_Converter::JPEG_CONV_OK) &&
+            ((encode_size * 10) >= (target * 9)) && ((encode_size * 10) <= (target * 11))) {
+            break;
+        }
+        next_quality = predict_quality(complexity);
+        if ((next_quality == quality) && (e == JPEG_Converter::JPEG_CONV_OK)) {
+            break;
+        }
+        if ((next_quality == quality) && (quality > min_quality)) {
+            next_quality--;
+        }
+        quality = next_quality;
+    }
+    add_history(complexity);
+    if (e != JPEG_Converter::JPEG_CONV_OK) {
+        return e;
+    }
+
+    pixels = (uint32_t)((options.width != 0) ? options.width : psInputBuff->width) *
+             (uint32_t)((options.height != 0) ? options.height : psInputBuff->height);
+    result.quality      = quality;
+    result.encode_count = (uint8_t)encode_count;
+    result.encode_size  = encode_size;
+    if (pixels != 0) {
+        result.bits_per_pixel_x100 = (uint32_t)(((uint64_t)encode_size * 8 * 100) / pixels);
+    } else {
+        result.bits_per_pixel_x100 = 0;
+    }
+    *pEncodeSize = encode_size;
+
+    return JPEG_Converter::JPEG_CONV_OK;
+}
@@ -36,36 +36,32 @@ Includes   <System Includes> , "Project Includes"
 #include  "r_jcu_api.h"
 #include  "r_jcu_pl.h"
 
-static mbed_CallbackFunc_t*     SetCallback;
-static size_t*                  pEncodeSize;
-static int32_t                  EncodeCount;
-static int32_t                  EncodeCountMax;
-static size_t                   DecodeWidth;
-static size_t                   DecodeHeight;
-static r_ospl_async_t           Async;
-
 /******************************************************************************
 Imported global variables and functions (from other files)
 ******************************************************************************/
 /**************************************************************************//**
  * @brief       Set callback function address for decode
+ * @param[in]   p_context        Context of the asynchronous decode
  * @param[in]   pSetCallbackAdr  Callback function address
+ * @param[in]   p_user           Argument of the callback function
  * @param[in]   width            Decode data width
  * @param[in]   height           Decode data height
  * @retval      error code
 ******************************************************************************/
-errnum_t    R_wrpper_set_decode_callback(mbed_CallbackFunc_t* pSetCallbackAdr, size_t width, size_t height)
+errnum_t    R_wrpper_set_decode_callback(mbed_jcu_async_t* p_context, mbed_CallbackFunc_t* pSetCallbackAdr, void* p_user,
+                                         size_t width, size_t height)
 {
     errnum_t    e;
 
-    Async.Flags             = R_F_OSPL_InterruptCallback;
-    Async.A_Thread          = R_OSPL_THREAD_GetCurrentId();
-    Async.InterruptCallback = &R_wrpper_LocalDecodeCallback;
-    SetCallback             = pSetCallbackAdr;
-    DecodeWidth             = width;
-    DecodeHeight            = height;
+    p_context->Async.Flags             = R_F_OSPL_InterruptCallback;
+    p_context->Async.A_Thread          = R_OSPL_THREAD_GetCurrentId();
+    p_context->Async.InterruptCallback = &R_wrpper_LocalDecodeCallback;
+    p_context->pCallback               = pSetCallbackAdr;
+    p_context->pUser                   = p_user;
+    p_context->DecodeWidth             = width;
+    p_context->DecodeHeight            = height;
 
-    e = R_JCU_StartAsync(&Async);
+    e = R_JCU_StartAsync(&p_context->Async);
 
     return e;
 }
@@ -82,25 +78,27 @@ errnum_t R_wrpper_LocalDecodeCallback(const r_ospl_interrupt_t *InterruptSource,
     const jcu_async_status_t* status;
     jcu_image_info_t          image_info;
     jcu_errorcode_t           jcu_error;
+    /* "Async" is the first member of the context */
+    mbed_jcu_async_t* const   p_context = (mbed_jcu_async_t *)Caller->Async;
 
     e = R_JCU_OnInterruptDefault(InterruptSource, Caller);
     if (e != 0) {
-        SetCallback(MBED_JCU_E_JCU_ERR);
+        p_context->pCallback(p_context->pUser, MBED_JCU_E_JCU_ERR);
         goto fin;
     }
     R_JCU_GetAsyncStatus( &status );
     if (status -> IsPaused == true) {
         if ((status->SubStatusFlags & JCU_SUB_INFOMATION_READY) == 0) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_FORMA_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_FORMA_ERR);
             goto fin;
         }
         R_JCU_GetImageInfo( &image_info );
         if ((image_info.width == 0u) || (image_info.height == 0u) || 
-            (image_info.width > DecodeWidth) || 
-            (image_info.height > DecodeHeight)) {
+            (image_info.width > p_context->DecodeWidth) || 
+            (image_info.height > p_context->DecodeHeight)) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_FORMA_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_FORMA_ERR);
             goto fin;
         }
         if ((image_info.encodedFormat != JCU_JPEG_YCbCr444) &&
@@ -108,17 +106,17 @@ errnum_t R_wrpper_LocalDecodeCallback(const r_ospl_interrupt_t *InterruptSource,
             (image_info.encodedFormat != JCU_JPEG_YCbCr420) &&
             (image_info.encodedFormat != JCU_JPEG_YCbCr411)) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_FORMA_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_FORMA_ERR);
             goto fin;
         }
-        jcu_error = R_JCU_ContinueAsync(JCU_IMAGE_INFO, &Async);
+        jcu_error = R_JCU_ContinueAsync(JCU_IMAGE_INFO, &p_context->Async);
         if (jcu_error != JCU_ERROR_OK) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_JCU_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_JCU_ERR);
             goto fin;
         }
     } else {
-        SetCallback(MBED_JCU_E_OK);
+        p_context->pCallback(p_context->pUser, MBED_JCU_E_OK);
     }
 
 fin:
@@ -128,25 +126,29 @@ fin:
 
 /**************************************************************************//**
  * @brief       Set callback function address for encode
+ * @param[in]   p_context        Context of the asynchronous encode
  * @param[in]   pSetCallbackAdr  Callback function address
+ * @param[in]   p_user           Argument of the callback function
  * @param[in]   pSize            Encode size input address
  * @param[in]   count_max        Encode count max num
  * @retval      error code
 ******************************************************************************/
-errnum_t R_wrpper_set_encode_callback( mbed_CallbackFunc_t* pSetCallbackAdr, size_t* pSize, int32_t count_max)
+errnum_t R_wrpper_set_encode_callback( mbed_jcu_async_t* p_context, mbed_CallbackFunc_t* pSetCallbackAdr, void* p_user,
+                                       size_t* pSize, int32_t count_max)
 {
     errnum_t e;
 
-    Async.Flags             = R_F_OSPL_InterruptCallback;
-    Async.A_Thread          = R_OSPL_THREAD_GetCurrentId();
-    Async.InterruptCallback = &R_wrpper_LocalEncodeCallback;
-    SetCallback             = pSetCallbackAdr;
-    pEncodeSize             = pSize;
-    *pEncodeSize            = 0;
-    EncodeCount             = 1;
-    EncodeCountMax          = count_max;
+    p_context->Async.Flags             = R_F_OSPL_InterruptCallback;
+    p_context->Async.A_Thread          = R_OSPL_THREAD_GetCurrentId();
+    p_context->Async.InterruptCallback = &R_wrpper_LocalEncodeCallback;
+    p_context->pCallback               = pSetCallbackAdr;
+    p_context->pUser                   = p_user;
+    p_context->pEncodeSize             = pSize;
+    *p_context->pEncodeSize            = 0;
+    p_context->EncodeCount             = 1;
+    p_context->EncodeCountMax          = count_max;
 
-    e = R_JCU_StartAsync(&Async);
+    e = R_JCU_StartAsync(&p_context->Async);
 
     return e;
 }
@@ -162,10 +164,12 @@ errnum_t    R_wrpper_LocalEncodeCallback(const r_ospl_interrupt_t *InterruptSour
     errnum_t                  e = 0;
     const jcu_async_status_t* status;
     jcu_errorcode_t           jcu_error;
+    /* "Async" is the first member of the context */
+    mbed_jcu_async_t* const   p_context = (mbed_jcu_async_t *)Caller->Async;
 
     e = R_JCU_OnInterruptDefault(InterruptSource, Caller);
     if (e != 0) {
-        SetCallback(MBED_JCU_E_JCU_ERR);
+        p_context->pCallback(p_context->pUser, MBED_JCU_E_JCU_ERR);
         goto fin;
     }
     R_JCU_GetAsyncStatus(&status);
@@ -174,21 +178,21 @@ errnum_t    R_wrpper_LocalEncodeCallback(const r_ospl_interrupt_t *InterruptSour
             e = E_OTHERS;
             goto fin;
         }
-        if (EncodeCount >= EncodeCountMax) {
+        if (p_context->EncodeCount >= p_context->EncodeCountMax) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_JCU_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_JCU_ERR);
             goto fin;
         }
-        EncodeCount++;
-        jcu_error = R_JCU_ContinueAsync(JCU_OUTPUT_BUFFER, &Async);
+        p_context->EncodeCount++;
+        jcu_error = R_JCU_ContinueAsync(JCU_OUTPUT_BUFFER, &p_context->Async);
         if (jcu_error != JCU_ERROR_OK) {
             e = E_OTHERS;
-            SetCallback(MBED_JCU_E_JCU_ERR);
+            p_context->pCallback(p_context->pUser, MBED_JCU_E_JCU_ERR);
             goto fin;
         }
     } else {
-        (void)R_JCU_GetEncodedSize(pEncodeSize);
-        SetCallback(MBED_JCU_E_OK);
+        (void)R_JCU_GetEncodedSize(p_context->pEncodeSize);
+        p_context->pCallback(p_context->pUser, MBED_JCU_E_OK);
     }
 
 fin:
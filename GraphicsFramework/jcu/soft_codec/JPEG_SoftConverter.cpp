@@ -0,0 +1,1427 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "JPEG_SoftConverter.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JPEG_SOFT_USE_NEON
+#endif
+
+#define DCT_SIZE                (8)
+#define DCT_SIZE2               (64)
+#define CONST_BITS              (13)
+#define PASS1_BITS              (2)
+#define FIX_BITS                (16)
+#define MAX_COMPONENT           (3)
+#define MAX_SAMP_FACTOR         (4)
+#define MCU_PIX_MAX             (DCT_SIZE * MAX_SAMP_FACTOR)
+#define HUFF_TABLE_NUM          (4)
+#define HUFF_LOOKAHEAD          (8)
+#define HUFFMAN_TABLE_DC_SIZE   (28u)
+#define HUFFMAN_TABLE_AC_SIZE   (178u)
+
+#define M_SOF0                  (0xC0)
+#define M_SOF1                  (0xC1)
+#define M_DHT                   (0xC4)
+#define M_RST0                  (0xD0)
+#define M_SOI                   (0xD8)
+#define M_EOI                   (0xD9)
+#define M_SOS                   (0xDA)
+#define M_DQT                   (0xDB)
+#define M_DRI                   (0xDD)
+
+/* zigzag index -> natural index */
+static const uint8_t jpeg_natural_order[DCT_SIZE2] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+/* C[k][n] = c(k) / 2 * cos((2n + 1) * k * pi / 16) scaled by 2^CONST_BITS, stored as [n][k] */
+static const int32_t fdct_table[DCT_SIZE][DCT_SIZE] = {
+    {  2896,   4017,   3784,   3406,   2896,   2276,   1567,    799},
+    {  2896,   3406,   1567,   -799,  -2896,  -4017,  -3784,  -2276},
+    {  2896,   2276,  -1567,  -4017,  -2896,    799,   3784,   3406},
+    {  2896,    799,  -3784,  -2276,   2896,   3406,  -1567,  -4017},
+    {  2896,   -799,  -3784,   2276,   2896,  -3406,  -1567,   4017},
+    {  2896,  -2276,  -1567,   4017,  -2896,   -799,   3784,  -3406},
+    {  2896,  -3406,   1567,    799,  -2896,   4017,  -3784,   2276},
+    {  2896,  -4017,   3784,  -3406,   2896,  -2276,   1567,   -799},
+};
+
+/* The same matrix stored as [k][n] */
+static const int32_t idct_table[DCT_SIZE][DCT_SIZE] = {
+    {  2896,   2896,   2896,   2896,   2896,   2896,   2896,   2896},
+    {  4017,   3406,   2276,    799,   -799,  -2276,  -3406,  -4017},
+    {  3784,   1567,  -1567,  -3784,  -3784,  -1567,   1567,   3784},
+    {  3406,   -799,  -4017,  -2276,   2276,   4017,    799,  -3406},
+    {  2896,  -2896,  -2896,   2896,   2896,  -2896,  -2896,   2896},
+    {  2276,  -4017,    799,   3406,  -3406,   -799,   4017,  -2276},
+    {  1567,  -3784,   3784,  -1567,  -1567,   3784,  -3784,   1567},
+    {   799,  -2276,   3406,  -4017,   4017,  -3406,   2276,   -799},
+};
+
+/* ITU-T T.81 Annex K.3 (same as JPEG_Converter) */
+static const uint8_t csaDefaultHuffmanTable_Y_DC[HUFFMAN_TABLE_DC_SIZE] = {
+    0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B
+};
+
+static const uint8_t csaDefaultHuffmanTable_C_DC[HUFFMAN_TABLE_DC_SIZE] = {
+    0x00, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B
+};
+
+static const uint8_t csaDefaultHuffmanTable_Y_AC[HUFFMAN_TABLE_AC_SIZE] = {
+    0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04, 0x04, 0x00, 0x00, 0x01, 0x7D,
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+    0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA
+};
+
+static const uint8_t csaDefaultHuffmanTable_C_AC[HUFFMAN_TABLE_AC_SIZE] = {
+    0x00, 0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00, 0x01, 0x02, 0x77,
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+    0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+    0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+    0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+    0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA
+};
+
+typedef struct {
+    uint8_t  lookup_len[1 << HUFF_LOOKAHEAD];   /* 0: code is longer than HUFF_LOOKAHEAD */
+    uint8_t  lookup_val[1 << HUFF_LOOKAHEAD];
+    int32_t  maxcode[18];
+    int32_t  mincode[17];
+    int32_t  valptr[17];
+    uint8_t  huffval[256];
+    bool     valid;
+} huff_dec_table_t;
+
+typedef struct {
+    uint16_t code[256];
+    uint8_t  size[256];                         /* 0: symbol is not in the table */
+} huff_enc_table_t;
+
+typedef struct {
+    int id;
+    int h;
+    int v;
+    int tq;
+    int td;
+    int ta;
+    int dc_pred;
+} jpeg_component_t;
+
+typedef struct {
+    const uint8_t    * p;
+    uint32_t           bit_buf;
+    int                bit_cnt;
+    bool               marker_hit;
+    bool               error;
+    int                width;
+    int                height;
+    int                comp_num;
+    int                hmax;
+    int                vmax;
+    int                restart_interval;
+    bool               sof_found;
+    jpeg_component_t   comp[MAX_COMPONENT];
+    int32_t            qt[4][DCT_SIZE2];        /* natural order */
+    bool               qt_valid[4];
+    huff_dec_table_t   dc[HUFF_TABLE_NUM];
+    huff_dec_table_t   ac[HUFF_TABLE_NUM];
+    uint8_t            plane[MAX_COMPONENT][MCU_PIX_MAX * MCU_PIX_MAX];
+} jpeg_dec_t;
+
+typedef struct {
+    uint8_t          * buf;
+    size_t             pos;
+    size_t             limit;                   /* 0: no limit */
+    bool               overflow;
+    uint32_t           bit_buf;
+    int                bit_cnt;
+    huff_enc_table_t   dc[2];
+    huff_enc_table_t   ac[2];
+    int32_t            qt[2][DCT_SIZE2];        /* natural order */
+} jpeg_enc_t;
+
+/******************************************************************************
+ * DCT
+ ******************************************************************************/
+/* One 1-D pass over the rows of in, the result is stored transposed.
+ * out[k][r] = round((sum of in[r][i] * tbl[i][k]) >> shift) */
+static void dct_pass(const int32_t * in, int32_t * out, const int32_t (* tbl)[DCT_SIZE], int shift) {
+    int r;
+    int i;
+    int k;
+#if defined(JPEG_SOFT_USE_NEON)
+    int32_t wk[DCT_SIZE];
+    int32x4_t vshift = vdupq_n_s32(-shift);
+
+    for (r = 0; r < DCT_SIZE; r++) {
+        int32x4_t acc0 = vdupq_n_s32(0);
+        int32x4_t acc1 = vdupq_n_s32(0);
+
+        for (i = 0; i < DCT_SIZE; i++) {
+            int32_t v = in[(r * DCT_SIZE) + i];
+            if (v != 0) {
+                acc0 = vmlaq_n_s32(acc0, vld1q_s32(&tbl[i][0]), v);
+                acc1 = vmlaq_n_s32(acc1, vld1q_s32(&tbl[i][4]), v);
+            }
+        }
+        vst1q_s32(&wk[0], vrshlq_s32(acc0, vshift));
+        vst1q_s32(&wk[4], vrshlq_s32(acc1, vshift));
+        for (k = 0; k < DCT_SIZE; k++) {
+            out[(k * DCT_SIZE) + r] = wk[k];
+        }
+    }
+#else
+    int32_t acc[DCT_SIZE];
+    int32_t round = (int32_t)1 << (shift - 1);
+
+    for (r = 0; r < DCT_SIZE; r++) {
+        for (k = 0; k < DCT_SIZE; k++) {
+            acc[k] = round;
+        }
+        for (i = 0; i < DCT_SIZE; i++) {
+            int32_t v = in[(r * DCT_SIZE) + i];
+            if (v != 0) {
+                const int32_t * p_tbl = tbl[i];
+                for (k = 0; k < DCT_SIZE; k++) {
+                    acc[k] += v * p_tbl[k];
+                }
+            }
+        }
+        for (k = 0; k < DCT_SIZE; k++) {
+            out[(k * DCT_SIZE) + r] = acc[k] >> shift;
+        }
+    }
+#endif
+}
+
+/* samples(-128 to 127) -> DCT coefficients */
+static void jpeg_fdct(int32_t * data) {
+    int32_t wk[DCT_SIZE2];
+
+    dct_pass(data, wk, fdct_table, CONST_BITS - PASS1_BITS);
+    dct_pass(wk, data, fdct_table, CONST_BITS + PASS1_BITS);
+}
+
+/* DCT coefficients -> samples(0 to 255) */
+static void jpeg_idct(int32_t * data, uint8_t * out, int out_stride) {
+    int32_t wk[DCT_SIZE2];
+    int32_t v;
+    int i;
+    int j;
+
+    dct_pass(data, wk, idct_table, CONST_BITS - PASS1_BITS);
+    dct_pass(wk, data, idct_table, CONST_BITS + PASS1_BITS);
+    for (i = 0; i < DCT_SIZE; i++) {
+        for (j = 0; j < DCT_SIZE; j++) {
+            v = data[(i * DCT_SIZE) + j] + 128;
+            if (v < 0) {
+                v = 0;
+            } else if (v > 255) {
+                v = 255;
+            }
+            out[j] = (uint8_t)v;
+        }
+        out += out_stride;
+    }
+}
+
+/******************************************************************************
+ * Colour conversion (JFIF, full range)
+ ******************************************************************************/
+#define FIX(x)          ((int32_t)((x) * (1L << FIX_BITS) + 0.5))
+#define CLAMP_U8(x)     (((x) < 0) ? 0 : (((x) > 255) ? 255 : (x)))
+
+static void ycc_to_rgb(const uint8_t * y, const uint8_t * cb, const uint8_t * cr,
+                       uint8_t * r, uint8_t * g, uint8_t * b, int num) {
+    int i = 0;
+#if defined(JPEG_SOFT_USE_NEON)
+    for (; (i + 8) <= num; i += 8) {
+        int16x8_t ys  = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(&y[i])));
+        int16x8_t cbs = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(&cb[i]), vdup_n_u8(128)));
+        int16x8_t crs = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(&cr[i]), vdup_n_u8(128)));
+        int32x4_t y_lo  = vshll_n_s16(vget_low_s16(ys), FIX_BITS);
+        int32x4_t y_hi  = vshll_n_s16(vget_high_s16(ys), FIX_BITS);
+        int32x4_t cb_lo = vmovl_s16(vget_low_s16(cbs));
+        int32x4_t cb_hi = vmovl_s16(vget_high_s16(cbs));
+        int32x4_t cr_lo = vmovl_s16(vget_low_s16(crs));
+        int32x4_t cr_hi = vmovl_s16(vget_high_s16(crs));
+        int32x4_t t_lo;
+        int32x4_t t_hi;
+
+        t_lo = vmlaq_n_s32(y_lo, cr_lo, FIX(1.40200));
+        t_hi = vmlaq_n_s32(y_hi, cr_hi, FIX(1.40200));
+        vst1_u8(&r[i], vqmovun_s16(vcombine_s16(vrshrn_n_s32(t_lo, FIX_BITS), vrshrn_n_s32(t_hi, FIX_BITS))));
+        t_lo = vmlsq_n_s32(vmlsq_n_s32(y_lo, cb_lo, FIX(0.34414)), cr_lo, FIX(0.71414));
+        t_hi = vmlsq_n_s32(vmlsq_n_s32(y_hi, cb_hi, FIX(0.34414)), cr_hi, FIX(0.71414));
+        vst1_u8(&g[i], vqmovun_s16(vcombine_s16(vrshrn_n_s32(t_lo, FIX_BITS), vrshrn_n_s32(t_hi, FIX_BITS))));
+        t_lo = vmlaq_n_s32(y_lo, cb_lo, FIX(1.77200));
+        t_hi = vmlaq_n_s32(y_hi, cb_hi, FIX(1.77200));
+        vst1_u8(&b[i], vqmovun_s16(vcombine_s16(vrshrn_n_s32(t_lo, FIX_BITS), vrshrn_n_s32(t_hi, FIX_BITS))));
+    }
+#endif
+    for (; i < num; i++) {
+        int32_t wy  = ((int32_t)y[i] << FIX_BITS) + (1L << (FIX_BITS - 1));
+        int32_t wcb = (int32_t)cb[i] - 128;
+        int32_t wcr = (int32_t)cr[i] - 128;
+        int32_t v;
+
+        v = (wy + (FIX(1.40200) * wcr)) >> FIX_BITS;
+        r[i] = (uint8_t)CLAMP_U8(v);
+        v = (wy - (FIX(0.34414) * wcb) - (FIX(0.71414) * wcr)) >> FIX_BITS;
+        g[i] = (uint8_t)CLAMP_U8(v);
+        v = (wy + (FIX(1.77200) * wcb)) >> FIX_BITS;
+        b[i] = (uint8_t)CLAMP_U8(v);
+    }
+}
+
+static void rgb_to_ycc(const uint8_t * r, const uint8_t * g, const uint8_t * b,
+                       uint8_t * y, uint8_t * cb, uint8_t * cr, int num) {
+    int i = 0;
+#if defined(JPEG_SOFT_USE_NEON)
+    for (; (i + 8) <= num; i += 8) {
+        uint16x8_t r16 = vmovl_u8(vld1_u8(&r[i]));
+        uint16x8_t g16 = vmovl_u8(vld1_u8(&g[i]));
+        uint16x8_t b16 = vmovl_u8(vld1_u8(&b[i]));
+        int32x4_t r_lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(r16)));
+        int32x4_t r_hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(r16)));
+        int32x4_t g_lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(g16)));
+        int32x4_t g_hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(g16)));
+        int32x4_t b_lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(b16)));
+        int32x4_t b_hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(b16)));
+        int32x4_t c128 = vdupq_n_s32((128L << FIX_BITS) + (1L << (FIX_BITS - 1)) - 1);
+        int32x4_t t_lo;
+        int32x4_t t_hi;
+
+        t_lo = vmlaq_n_s32(vmlaq_n_s32(vmulq_n_s32(r_lo, FIX(0.29900)), g_lo, FIX(0.58700)), b_lo, FIX(0.11400));
+        t_hi = vmlaq_n_s32(vmlaq_n_s32(vmulq_n_s32(r_hi, FIX(0.29900)), g_hi, FIX(0.58700)), b_hi, FIX(0.11400));
+        vst1_u8(&y[i], vqmovun_s16(vcombine_s16(vrshrn_n_s32(t_lo, FIX_BITS), vrshrn_n_s32(t_hi, FIX_BITS))));
+        t_lo = vmlaq_n_s32(vmlsq_n_s32(vmlsq_n_s32(c128, r_lo, FIX(0.16874)), g_lo, FIX(0.33126)), b_lo, FIX(0.50000));
+        t_hi = vmlaq_n_s32(vmlsq_n_s32(vmlsq_n_s32(c128, r_hi, FIX(0.16874)), g_hi, FIX(0.33126)), b_hi, FIX(0.50000));
+        vst1_u8(&cb[i], vqmovun_s16(vcombine_s16(vshrn_n_s32(t_lo, FIX_BITS), vshrn_n_s32(t_hi, FIX_BITS))));
+        t_lo = vmlsq_n_s32(vmlsq_n_s32(vmlaq_n_s32(c128, r_lo, FIX(0.50000)), g_lo, FIX(0.41869)), b_lo, FIX(0.08131));
+        t_hi = vmlsq_n_s32(vmlsq_n_s32(vmlaq_n_s32(c128, r_hi, FIX(0.50000)), g_hi, FIX(0.41869)), b_hi, FIX(0.08131));
+        vst1_u8(&cr[i], vqmovun_s16(vcombine_s16(vshrn_n_s32(t_lo, FIX_BITS), vshrn_n_s32(t_hi, FIX_BITS))));
+    }
+#endif
+    for (; i < num; i++) {
+        int32_t wr = r[i];
+        int32_t wg = g[i];
+        int32_t wb = b[i];
+        int32_t c128 = (128L << FIX_BITS) + (1L << (FIX_BITS - 1)) - 1;
+        int32_t v;
+
+        v = ((FIX(0.29900) * wr) + (FIX(0.58700) * wg) + (FIX(0.11400) * wb) + (1L << (FIX_BITS - 1))) >> FIX_BITS;
+        y[i] = (uint8_t)CLAMP_U8(v);
+        v = (c128 - (FIX(0.16874) * wr) - (FIX(0.33126) * wg) + (FIX(0.50000) * wb)) >> FIX_BITS;
+        cb[i] = (uint8_t)CLAMP_U8(v);
+        v = (c128 + (FIX(0.50000) * wr) - (FIX(0.41869) * wg) - (FIX(0.08131) * wb)) >> FIX_BITS;
+        cr[i] = (uint8_t)CLAMP_U8(v);
+    }
+}
+
+/******************************************************************************
+ * Bitmap access
+ * The JCU transfers the bitmap in 8 byte units with the swap setting,
+ * so byte n of the big-endian pixel data is located at (n ^ swap).
+ ******************************************************************************/
+static int bitmap_byte_per_pixel(JPEG_Converter::wr_rd_format_t format) {
+    if (format == JPEG_Converter::WR_RD_ARGB8888) {
+        return 4;
+    }
+    return 2;
+}
+
+/******************************************************************************
+ * Huffman
+ ******************************************************************************/
+/* Make code lengths and codes from DHT data (ITU-T T.81 Annex C) */
+static bool huff_make_codes(const uint8_t * p_bits, int * p_count, uint8_t * huffsize, uint16_t * huffcode) {
+    int l;
+    int i;
+    int p = 0;
+    uint32_t code;
+    int si;
+
+    for (l = 1; l <= 16; l++) {
+        for (i = 0; i < (int)p_bits[l - 1]; i++) {
+            if (p >= 256) {
+                return false;
+            }
+            huffsize[p++] = (uint8_t)l;
+        }
+    }
+    *p_count = p;
+
+    code = 0;
+    si = (p > 0) ? huffsize[0] : 0;
+    p = 0;
+    while (p < *p_count) {
+        while ((p < *p_count) && (huffsize[p] == si)) {
+            huffcode[p++] = (uint16_t)code;
+            code++;
+        }
+        if (code > (1UL << si)) {
+            return false;
+        }
+        code <<= 1;
+        si++;
+    }
+
+    return true;
+}
+
+static bool huff_make_enc_table(const uint8_t * p_dht, huff_enc_table_t * tbl, int max_symbol) {
+    uint8_t  huffsize[256];
+    uint16_t huffcode[256];
+    int count;
+    int i;
+
+    if (huff_make_codes(p_dht, &count, huffsize, huffcode) == false) {
+        return false;
+    }
+    memset(tbl->size, 0, sizeof(tbl->size));
+    for (i = 0; i < count; i++) {
+        int sym = p_dht[16 + i];
+        if ((sym > max_symbol) || (tbl->size[sym] != 0)) {
+            return false;
+        }
+        tbl->code[sym] = huffcode[i];
+        tbl->size[sym] = huffsize[i];
+    }
+
+    return true;
+}
+
+static bool huff_make_dec_table(const uint8_t * p_dht, huff_dec_table_t * tbl) {
+    uint8_t  huffsize[256];
+    uint16_t huffcode[256];
+    int count;
+    int l;
+    int i;
+    int p;
+
+    if (huff_make_codes(p_dht, &count, huffsize, huffcode) == false) {
+        return false;
+    }
+    memcpy(tbl->huffval, &p_dht[16], count);
+
+    p = 0;
+    for (l = 1; l <= 16; l++) {
+        if (p_dht[l - 1] != 0) {
+            tbl->valptr[l]  = p;
+            tbl->mincode[l] = huffcode[p];
+            p += p_dht[l - 1];
+            tbl->maxcode[l] = huffcode[p - 1];
+        } else {
+            tbl->maxcode[l] = -1;
+        }
+    }
+    tbl->maxcode[17] = 0x7FFFFFFF;
+
+    memset(tbl->lookup_len, 0, sizeof(tbl->lookup_len));
+    for (i = 0; i < count; i++) {
+        if (huffsize[i] <= HUFF_LOOKAHEAD) {
+            int shift = HUFF_LOOKAHEAD - huffsize[i];
+            int base  = (int)huffcode[i] << shift;
+            int j;
+            for (j = 0; j < (1 << shift); j++) {
+                tbl->lookup_len[base + j] = huffsize[i];
+                tbl->lookup_val[base + j] = tbl->huffval[i];
+            }
+        }
+    }
+    tbl->valid = true;
+
+    return true;
+}
+
+/******************************************************************************
+ * Decoder
+ ******************************************************************************/
+static inline uint32_t get_word(const uint8_t * p) {
+    return ((uint32_t)p[0] << 8) | (uint32_t)p[1];
+}
+
+static void dec_fill_bits(jpeg_dec_t * dec) {
+    while (dec->bit_cnt <= 24) {
+        uint32_t c = 0;
+
+        if (dec->marker_hit == false) {
+            c = dec->p[0];
+            if (c == 0xFF) {
+                if (dec->p[1] == 0x00) {
+                    dec->p += 2;
+                } else {
+                    dec->marker_hit = true;    /* feed zero until the marker is processed */
+                    c = 0;
+                }
+            } else {
+                dec->p++;
+            }
+        }
+        dec->bit_buf |= c << (24 - dec->bit_cnt);
+        dec->bit_cnt += 8;
+    }
+}
+
+static inline int32_t dec_get_bits(jpeg_dec_t * dec, int num) {
+    int32_t v;
+
+    if (num == 0) {
+        return 0;
+    }
+    if (dec->bit_cnt < num) {
+        dec_fill_bits(dec);
+    }
+    v = (int32_t)(dec->bit_buf >> (32 - num));
+    dec->bit_buf <<= num;
+    dec->bit_cnt -= num;
+
+    return v;
+}
+
+static inline int32_t dec_extend(int32_t v, int num) {
+    if (v < (1L << (num - 1))) {
+        v += (int32_t)(((uint32_t)-1) << num) + 1;
+    }
+    return v;
+}
+
+static int dec_huff_decode(jpeg_dec_t * dec, const huff_dec_table_t * tbl) {
+    uint32_t look;
+    int32_t code;
+    int l;
+
+    if (dec->bit_cnt < 16) {
+        dec_fill_bits(dec);
+    }
+    look = dec->bit_buf >> (32 - HUFF_LOOKAHEAD);
+    l = tbl->lookup_len[look];
+    if (l != 0) {
+        dec->bit_buf <<= l;
+        dec->bit_cnt -= l;
+        return tbl->lookup_val[look];
+    }
+    for (l = HUFF_LOOKAHEAD + 1; l <= 16; l++) {
+        code = (int32_t)(dec->bit_buf >> (32 - l));
+        if (code <= tbl->maxcode[l]) {
+            dec->bit_buf <<= l;
+            dec->bit_cnt -= l;
+            return tbl->huffval[tbl->valptr[l] + code - tbl->mincode[l]];
+        }
+    }
+    dec->error = true;
+
+    return 0;
+}
+
+static void dec_block(jpeg_dec_t * dec, jpeg_component_t * comp, int32_t * coef) {
+    const int32_t * qt = dec->qt[comp->tq];
+    const huff_dec_table_t * ac = &dec->ac[comp->ta];
+    int s;
+    int r;
+    int k;
+
+    memset(coef, 0, sizeof(int32_t) * DCT_SIZE2);
+    s = dec_huff_decode(dec, &dec->dc[comp->td]);
+    if (s != 0) {
+        if (s > 11) {
+            dec->error = true;
+            return;
+        }
+        s = dec_extend(dec_get_bits(dec, s), s);
+    }
+    comp->dc_pred += s;
+    coef[0] = comp->dc_pred * qt[0];
+
+    for (k = 1; k < DCT_SIZE2; k++) {
+        s = dec_huff_decode(dec, ac);
+        r = s >> 4;
+        s &= 15;
+        if (s != 0) {
+            k += r;
+            if (k >= DCT_SIZE2) {
+                dec->error = true;
+                return;
+            }
+            coef[jpeg_natural_order[k]] = dec_extend(dec_get_bits(dec, s), s) * qt[jpeg_natural_order[k]];
+        } else {
+            if (r != 15) {
+                break;
+            }
+            k += 15;
+        }
+    }
+}
+
+static bool dec_restart(jpeg_dec_t * dec) {
+    int i;
+
+    dec->bit_buf = 0;
+    dec->bit_cnt = 0;
+    /* search RSTn */
+    while (!((dec->p[0] == 0xFF) && (dec->p[1] >= M_RST0) && (dec->p[1] <= (M_RST0 + 7)))) {
+        if ((dec->p[0] == 0xFF) && (dec->p[1] != 0x00) && (dec->p[1] != 0xFF)) {
+            return false;   /* other marker */
+        }
+        dec->p++;
+    }
+    dec->p += 2;
+    dec->marker_hit = false;
+    for (i = 0; i < dec->comp_num; i++) {
+        dec->comp[i].dc_pred = 0;
+    }
+
+    return true;
+}
+
+static bool dec_read_sof(jpeg_dec_t * dec, const uint8_t * p, int len) {
+    int i;
+
+    if ((len < 8) || (p[0] != 8)) {
+        return false;   /* 8 bit precision only */
+    }
+    dec->height   = (int)get_word(&p[1]);
+    dec->width    = (int)get_word(&p[3]);
+    dec->comp_num = p[5];
+    if ((dec->width == 0) || (dec->height == 0) ||
+        ((dec->comp_num != 1) && (dec->comp_num != 3)) ||
+        (len < (6 + (dec->comp_num * 3)))) {
+        return false;
+    }
+    dec->hmax = 1;
+    dec->vmax = 1;
+    for (i = 0; i < dec->comp_num; i++) {
+        jpeg_component_t * comp = &dec->comp[i];
+
+        comp->id = p[6 + (i * 3)];
+        comp->h  = p[7 + (i * 3)] >> 4;
+        comp->v  = p[7 + (i * 3)] & 0x0F;
+        comp->tq = p[8 + (i * 3)];
+        if ((comp->h < 1) || (comp->h > MAX_SAMP_FACTOR) ||
+            (comp->v < 1) || (comp->v > MAX_SAMP_FACTOR) || (comp->tq > 3)) {
+            return false;
+        }
+        if (dec->comp_num == 1) {
+            comp->h = 1;    /* non-interleaved: one block per MCU */
+            comp->v = 1;
+        }
+        if (comp->h > dec->hmax) {
+            dec->hmax = comp->h;
+        }
+        if (comp->v > dec->vmax) {
+            dec->vmax = comp->v;
+        }
+    }
+    for (i = 0; i < dec->comp_num; i++) {
+        if (((dec->hmax % dec->comp[i].h) != 0) || ((dec->vmax % dec->comp[i].v) != 0)) {
+            return false;
+        }
+    }
+    dec->sof_found = true;
+
+    return true;
+}
+
+static bool dec_read_dqt(jpeg_dec_t * dec, const uint8_t * p, int len) {
+    int i;
+
+    while (len > 0) {
+        int tq = p[0] & 0x0F;
+        if (((p[0] >> 4) != 0) || (tq > 3) || (len < 65)) {
+            return false;   /* 8 bit tables only */
+        }
+        for (i = 0; i < DCT_SIZE2; i++) {
+            dec->qt[tq][jpeg_natural_order[i]] = p[1 + i];
+        }
+        dec->qt_valid[tq] = true;
+        p += 65;
+        len -= 65;
+    }
+
+    return true;
+}
+
+static bool dec_read_dht(jpeg_dec_t * dec, const uint8_t * p, int len) {
+    int i;
+    int count;
+
+    while (len > 17) {
+        int tc = p[0] >> 4;
+        int th = p[0] & 0x0F;
+
+        count = 0;
+        for (i = 0; i < 16; i++) {
+            count += p[1 + i];
+        }
+        if ((tc > 1) || (th > 3) || (count > 256) || (len < (17 + count))) {
+            return false;
+        }
+        if (huff_make_dec_table(&p[1], (tc == 0) ? &dec->dc[th] : &dec->ac[th]) == false) {
+            return false;
+        }
+        p += 17 + count;
+        len -= 17 + count;
+    }
+
+    return true;
+}
+
+static bool dec_read_sos(jpeg_dec_t * dec, const uint8_t * p, int len) {
+    int ns = p[0];
+    int i;
+    int j;
+
+    if ((dec->sof_found == false) || (ns != dec->comp_num) || (len < (4 + (ns * 2)))) {
+        return false;   /* single interleaved scan only */
+    }
+    for (i = 0; i < ns; i++) {
+        int id = p[1 + (i * 2)];
+        for (j = 0; j < dec->comp_num; j++) {
+            if (dec->comp[j].id == id) {
+                break;
+            }
+        }
+        if (j >= dec->comp_num) {
+            return false;
+        }
+        dec->comp[j].td = p[2 + (i * 2)] >> 4;
+        dec->comp[j].ta = p[2 + (i * 2)] & 0x0F;
+        if ((dec->comp[j].td > 3) || (dec->comp[j].ta > 3) ||
+            (dec->dc[dec->comp[j].td].valid == false) || (dec->ac[dec->comp[j].ta].valid == false) ||
+            (dec->qt_valid[dec->comp[j].tq] == false)) {
+            return false;
+        }
+        dec->comp[j].dc_pred = 0;
+    }
+
+    return true;
+}
+
+/* Average fx * fy samples of a plane with the up-sampling rate sx, sy */
+static inline uint8_t dec_sample(const uint8_t * plane, int stride, int x, int y, int sx, int sy, int fx, int fy) {
+    int i;
+    int j;
+    int sum;
+
+    if ((fx == 1) && (fy == 1)) {
+        return plane[((y / sy) * stride) + (x / sx)];
+    }
+    sum = 0;
+    for (i = 0; i < fy; i++) {
+        for (j = 0; j < fx; j++) {
+            sum += plane[(((y + i) / sy) * stride) + ((x + j) / sx)];
+        }
+    }
+
+    return (uint8_t)((sum + ((fx * fy) >> 1)) / (fx * fy));
+}
+
+static void dec_output_mcu(jpeg_dec_t * dec, int mcu_x, int mcu_y, JPEG_Converter::bitmap_buff_info_t * psOutputBuff,
+                           JPEG_Converter::decode_options_t * pOptions, int fx, int fy, int out_w, int out_h) {
+    uint8_t y_row[MCU_PIX_MAX];
+    uint8_t cb_row[MCU_PIX_MAX];
+    uint8_t cr_row[MCU_PIX_MAX];
+    uint8_t r_row[MCU_PIX_MAX];
+    uint8_t g_row[MCU_PIX_MAX];
+    uint8_t b_row[MCU_PIX_MAX];
+    uint8_t * p_dst = (uint8_t *)psOutputBuff->buffer_address;
+    JPEG_Converter::wr_rd_format_t format = psOutputBuff->format;
+    uint32_t swa = (uint32_t)pOptions->output_swapsetting & 7u;
+    int bpp = bitmap_byte_per_pixel(format);
+    int mcu_w = DCT_SIZE * dec->hmax;
+    int mcu_h = DCT_SIZE * dec->vmax;
+    int ox0 = (mcu_x * mcu_w) / fx;
+    int oy0 = (mcu_y * mcu_h) / fy;
+    int num = mcu_w / fx;
+    int rows = mcu_h / fy;
+    int c;
+    int i;
+    int j;
+
+    if ((ox0 + num) > out_w) {
+        num = out_w - ox0;
+    }
+    if ((oy0 + rows) > out_h) {
+        rows = out_h - oy0;
+    }
+
+    for (i = 0; i < rows; i++) {
+        uint8_t * p_row[MAX_COMPONENT] = {y_row, cb_row, cr_row};
+        uint32_t offset;
+
+        for (c = 0; c < dec->comp_num; c++) {
+            jpeg_component_t * comp = &dec->comp[c];
+            int sx = dec->hmax / comp->h;
+            int sy = dec->vmax / comp->v;
+            int stride = DCT_SIZE * comp->h;
+            for (j = 0; j < num; j++) {
+                p_row[c][j] = dec_sample(dec->plane[c], stride, j * fx, i * fy, sx, sy, fx, fy);
+            }
+        }
+        if (dec->comp_num == 1) {
+            memset(cb_row, 128, num);
+            memset(cr_row, 128, num);
+        }
+
+        offset = (uint32_t)((((oy0 + i) * psOutputBuff->width) + ox0) * bpp);
+        if (format == JPEG_Converter::WR_RD_YCbCr422) {
+            uint8_t cbcr_xor = (pOptions->output_cb_cr_offset == JPEG_Converter::CBCR_OFFSET_0) ? 0x80 : 0x00;
+            for (j = 0; j < num; j++) {
+                /* Cb0 Y0 Cr0 Y1 */
+                if (((ox0 + j) & 1) == 0) {
+                    p_dst[offset ^ swa] = cb_row[j] ^ cbcr_xor;
+                } else {
+                    p_dst[offset ^ swa] = cr_row[j] ^ cbcr_xor;
+                }
+                p_dst[(offset + 1) ^ swa] = y_row[j];
+                offset += 2;
+            }
+        } else {
+            ycc_to_rgb(y_row, cb_row, cr_row, r_row, g_row, b_row, num);
+            if (format == JPEG_Converter::WR_RD_ARGB8888) {
+                uint8_t alpha = (uint8_t)pOptions->alpha;
+                for (j = 0; j < num; j++) {
+                    p_dst[offset ^ swa]       = alpha;
+                    p_dst[(offset + 1) ^ swa] = r_row[j];
+                    p_dst[(offset + 2) ^ swa] = g_row[j];
+                    p_dst[(offset + 3) ^ swa] = b_row[j];
+                    offset += 4;
+                }
+            } else {
+                for (j = 0; j < num; j++) {
+                    uint32_t v = (((uint32_t)r_row[j] >> 3) << 11) | (((uint32_t)g_row[j] >> 2) << 5) | ((uint32_t)b_row[j] >> 3);
+                    p_dst[offset ^ swa]       = (uint8_t)(v >> 8);
+                    p_dst[(offset + 1) ^ swa] = (uint8_t)v;
+                    offset += 2;
+                }
+            }
+        }
+    }
+}
+
+static JPEG_Converter::jpeg_conv_error_t dec_scan(jpeg_dec_t * dec, JPEG_Converter::bitmap_buff_info_t * psOutputBuff,
+                                                  JPEG_Converter::decode_options_t * pOptions) {
+    int32_t coef[DCT_SIZE2];
+    int fx = 1 << (int)pOptions->horizontal_sub_sampling;
+    int fy = 1 << (int)pOptions->vertical_sub_sampling;
+    int out_w = (dec->width + fx - 1) / fx;
+    int out_h = (dec->height + fy - 1) / fy;
+    int mcus_x = (dec->width + (DCT_SIZE * dec->hmax) - 1) / (DCT_SIZE * dec->hmax);
+    int mcus_y = (dec->height + (DCT_SIZE * dec->vmax) - 1) / (DCT_SIZE * dec->vmax);
+    bool dc_only = ((fx == 8) && (fy == 8));
+    int restart_cnt = dec->restart_interval;
+    int mx;
+    int my;
+    int c;
+    int bx;
+    int by;
+
+    if ((out_w > psOutputBuff->width) || (out_h > psOutputBuff->height)) {
+        return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+    }
+
+    dec->bit_buf    = 0;
+    dec->bit_cnt    = 0;
+    dec->marker_hit = false;
+    for (my = 0; my < mcus_y; my++) {
+        for (mx = 0; mx < mcus_x; mx++) {
+            if (dec->restart_interval != 0) {
+                if (restart_cnt == 0) {
+                    if (dec_restart(dec) == false) {
+                        return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                    }
+                    restart_cnt = dec->restart_interval;
+                }
+                restart_cnt--;
+            }
+            for (c = 0; c < dec->comp_num; c++) {
+                jpeg_component_t * comp = &dec->comp[c];
+                int stride = DCT_SIZE * comp->h;
+                for (by = 0; by < comp->v; by++) {
+                    for (bx = 0; bx < comp->h; bx++) {
+                        uint8_t * p_out = &dec->plane[c][(by * DCT_SIZE * stride) + (bx * DCT_SIZE)];
+                        dec_block(dec, comp, coef);
+                        if (dec->error) {
+                            return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                        }
+                        if (dc_only) {
+                            /* 1/8: only the average of the block is needed */
+                            int32_t v = ((coef[0] + 4) >> 3) + 128;
+                            int i;
+                            v = CLAMP_U8(v);
+                            for (i = 0; i < DCT_SIZE; i++) {
+                                memset(&p_out[i * stride], (int)v, DCT_SIZE);
+                            }
+                        } else {
+                            jpeg_idct(coef, p_out, stride);
+                        }
+                    }
+                }
+            }
+            dec_output_mcu(dec, mx, my, psOutputBuff, pOptions, fx, fy, out_w, out_h);
+        }
+    }
+
+    return JPEG_Converter::JPEG_CONV_OK;
+}
+
+static JPEG_Converter::jpeg_conv_error_t jpeg_soft_decode(jpeg_dec_t * dec, const uint8_t * p_jpeg,
+                                                          JPEG_Converter::bitmap_buff_info_t * psOutputBuff,
+                                                          JPEG_Converter::decode_options_t * pOptions) {
+    JPEG_Converter::jpeg_conv_error_t e;
+    uint8_t marker;
+    int len;
+
+    if ((p_jpeg[0] != 0xFF) || (p_jpeg[1] != M_SOI)) {
+        return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+    }
+    dec->p = &p_jpeg[2];
+
+    while (1) {
+        /* Skip to the marker */
+        while (dec->p[0] != 0xFF) {
+            dec->p++;
+        }
+        while (dec->p[0] == 0xFF) {
+            dec->p++;
+        }
+        marker = *dec->p++;
+        if ((marker == M_SOI) || ((marker >= M_RST0) && (marker <= (M_RST0 + 7)))) {
+            continue;   /* no length */
+        }
+        if (marker == M_EOI) {
+            return JPEG_Converter::JPEG_CONV_FORMA_ERR;     /* no image */
+        }
+        len = (int)get_word(dec->p) - 2;
+        if (len < 0) {
+            return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+        }
+        dec->p += 2;
+        switch (marker) {
+            case M_SOF0:
+            case M_SOF1:
+                if (dec_read_sof(dec, dec->p, len) == false) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                }
+                break;
+            case M_DQT:
+                if (dec_read_dqt(dec, dec->p, len) == false) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                }
+                break;
+            case M_DHT:
+                if (dec_read_dht(dec, dec->p, len) == false) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                }
+                break;
+            case M_DRI:
+                if (len < 2) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                }
+                dec->restart_interval = (int)get_word(dec->p);
+                break;
+            case M_SOS:
+                if (dec_read_sos(dec, dec->p, len) == false) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;
+                }
+                dec->p += len;
+                e = dec_scan(dec, psOutputBuff, pOptions);
+                return e;
+            default:
+                if ((marker >= 0xC0) && (marker <= 0xCF) && (marker != 0xC8) && (marker != 0xCC)) {
+                    return JPEG_Converter::JPEG_CONV_FORMA_ERR;     /* progressive, lossless, arithmetic */
+                }
+                break;      /* APPn, COM, DAC, etc. */
+        }
+        dec->p += len;
+    }
+}
+
+/******************************************************************************
+ * Encoder
+ ******************************************************************************/
+static inline void enc_emit(jpeg_enc_t * enc, uint8_t data) {
+    if ((enc->limit != 0) && (enc->pos >= enc->limit)) {
+        enc->overflow = true;
+        return;
+    }
+    enc->buf[enc->pos++] = data;
+}
+
+static void enc_emit_word(jpeg_enc_t * enc, uint32_t data) {
+    enc_emit(enc, (uint8_t)(data >> 8));
+    enc_emit(enc, (uint8_t)data);
+}
+
+static inline void enc_put_bits(jpeg_enc_t * enc, uint32_t code, int size) {
+    enc->bit_buf = (enc->bit_buf << size) | (code & ((1UL << size) - 1));
+    enc->bit_cnt += size;
+    while (enc->bit_cnt >= 8) {
+        uint8_t c = (uint8_t)(enc->bit_buf >> (enc->bit_cnt - 8));
+        enc_emit(enc, c);
+        if (c == 0xFF) {
+            enc_emit(enc, 0x00);    /* byte stuffing */
+        }
+        enc->bit_cnt -= 8;
+    }
+}
+
+static void enc_flush_bits(jpeg_enc_t * enc) {
+    if (enc->bit_cnt > 0) {
+        enc_put_bits(enc, 0x7F, 8 - enc->bit_cnt);  /* pad with 1-bits */
+    }
+    enc->bit_buf = 0;
+    enc->bit_cnt = 0;
+}
+
+static inline int enc_bit_length(int32_t v) {
+    int nbits = 0;
+
+    while (v != 0) {
+        nbits++;
+        v >>= 1;
+    }
+    return nbits;
+}
+
+static bool enc_block(jpeg_enc_t * enc, int32_t * data, int tbl_no, int * p_dc_pred) {
+    const int32_t * qt = enc->qt[tbl_no];
+    const huff_enc_table_t * dc = &enc->dc[tbl_no];
+    const huff_enc_table_t * ac = &enc->ac[tbl_no];
+    int32_t quant[DCT_SIZE2];
+    int32_t v;
+    int32_t t;
+    int nbits;
+    int r;
+    int k;
+
+    jpeg_fdct(data);
+    for (k = 0; k < DCT_SIZE2; k++) {
+        int32_t q = qt[k];
+        v = data[k];
+        if (v < 0) {
+            v = -((-v + (q >> 1)) / q);
+        } else {
+            v = (v + (q >> 1)) / q;
+        }
+        if (v > 1023) {
+            v = 1023;
+        } else if (v < -1023) {
+            v = -1023;
+        }
+        quant[k] = v;
+    }
+
+    /* DC */
+    v = quant[0] - *p_dc_pred;
+    *p_dc_pred = quant[0];
+    t = v;
+    if (t < 0) {
+        t = -t;
+        v--;
+    }
+    nbits = enc_bit_length(t);
+    if (dc->size[nbits] == 0) {
+        return false;
+    }
+    enc_put_bits(enc, dc->code[nbits], dc->size[nbits]);
+    if (nbits != 0) {
+        enc_put_bits(enc, (uint32_t)v, nbits);
+    }
+
+    /* AC */
+    r = 0;
+    for (k = 1; k < DCT_SIZE2; k++) {
+        v = quant[jpeg_natural_order[k]];
+        if (v == 0) {
+            r++;
+            continue;
+        }
+        while (r > 15) {
+            if (ac->size[0xF0] == 0) {
+                return false;
+            }
+            enc_put_bits(enc, ac->code[0xF0], ac->size[0xF0]);
+            r -= 16;
+        }
+        t = v;
+        if (t < 0) {
+            t = -t;
+            v--;
+        }
+        nbits = enc_bit_length(t);
+        if (ac->size[(r << 4) + nbits] == 0) {
+            return false;
+        }
+        enc_put_bits(enc, ac->code[(r << 4) + nbits], ac->size[(r << 4) + nbits]);
+        enc_put_bits(enc, (uint32_t)v, nbits);
+        r = 0;
+    }
+    if (r > 0) {
+        if (ac->size[0x00] == 0) {
+            return false;
+        }
+        enc_put_bits(enc, ac->code[0x00], ac->size[0x00]);
+    }
+
+    return true;
+}
+
+static void enc_write_dht(jpeg_enc_t * enc, const uint8_t * p_dht, uint8_t tc_th) {
+    int count = 0;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        count += p_dht[i];
+    }
+    enc_emit(enc, tc_th);
+    for (i = 0; i < (16 + count); i++) {
+        enc_emit(enc, p_dht[i]);
+    }
+}
+
+static int dht_size(const uint8_t * p_dht) {
+    int count = 0;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        count += p_dht[i];
+    }
+    return 17 + count;
+}
+
+/* Read one line of 16 pixels as Y, Cb and Cr */
+static void enc_read_line(JPEG_Converter::bitmap_buff_info_t * psInputBuff, JPEG_Converter::encode_options_t * pOptions,
+                          int x0, int y, int width, uint8_t * y_row, uint8_t * cb_row, uint8_t * cr_row) {
+    const uint8_t * p_src = (const uint8_t *)psInputBuff->buffer_address;
+    JPEG_Converter::wr_rd_format_t format = psInputBuff->format;
+    uint32_t swa = (uint32_t)pOptions->input_swapsetting & 7u;
+    int bpp = bitmap_byte_per_pixel(format);
+    uint8_t r_row[DCT_SIZE * 2];
+    uint8_t g_row[DCT_SIZE * 2];
+    uint8_t b_row[DCT_SIZE * 2];
+    uint32_t line = (uint32_t)(y * psInputBuff->width * bpp);
+    int j;
+
+    for (j = 0; j < (DCT_SIZE * 2); j++) {
+        int x = x0 + j;
+        uint32_t offset;
+
+        if (x >= width) {
+            x = width - 1;  /* replicate the right edge */
+        }
+        offset = line + (uint32_t)(x * bpp);
+        if (format == JPEG_Converter::WR_RD_YCbCr422) {
+            uint8_t cbcr_xor = (pOptions->input_cb_cr_offset == JPEG_Converter::CBCR_OFFSET_0) ? 0x80 : 0x00;
+            uint32_t pair = line + (uint32_t)((x & ~1) * 2);
+            y_row[j]  = p_src[(offset + 1) ^ swa];
+            cb_row[j] = p_src[pair ^ swa] ^ cbcr_xor;
+            cr_row[j] = p_src[(pair + 2) ^ swa] ^ cbcr_xor;
+        } else if (format == JPEG_Converter::WR_RD_ARGB8888) {
+            r_row[j] = p_src[(offset + 1) ^ swa];
+            g_row[j] = p_src[(offset + 2) ^ swa];
+            b_row[j] = p_src[(offset + 3) ^ swa];
+        } else {
+            uint32_t v = ((uint32_t)p_src[offset ^ swa] << 8) | (uint32_t)p_src[(offset + 1) ^ swa];
+            r_row[j] = (uint8_t)(((v >> 8) & 0xF8) | ((v >> 13) & 0x07));
+            g_row[j] = (uint8_t)(((v >> 3) & 0xFC) | ((v >> 9) & 0x03));
+            b_row[j] = (uint8_t)(((v << 3) & 0xF8) | ((v >> 2) & 0x07));
+        }
+    }
+    if (format != JPEG_Converter::WR_RD_YCbCr422) {
+        rgb_to_ycc(r_row, g_row, b_row, y_row, cb_row, cr_row, DCT_SIZE * 2);
+    }
+}
+
+static JPEG_Converter::jpeg_conv_error_t jpeg_soft_encode(jpeg_enc_t * enc, JPEG_Converter::bitmap_buff_info_t * psInputBuff,
+                                                          JPEG_Converter::encode_options_t * pOptions,
+                                                          const uint8_t * p_qt_y, const uint8_t * p_qt_c,
+                                                          const uint8_t * p_dht[2][2]) {
+    int32_t data_y0[DCT_SIZE2];
+    int32_t data_y1[DCT_SIZE2];
+    int32_t data_cb[DCT_SIZE2];
+    int32_t data_cr[DCT_SIZE2];
+    uint8_t y_row[DCT_SIZE * 2];
+    uint8_t cb_row[DCT_SIZE * 2];
+    uint8_t cr_row[DCT_SIZE * 2];
+    int width  = (pOptions->width != 0) ? pOptions->width : psInputBuff->width;
+    int height = (pOptions->height != 0) ? pOptions->height : psInputBuff->height;
+    int mcus_x;
+    int mcus_y;
+    int dc_pred[MAX_COMPONENT];
+    int restart_cnt = 0;
+    int restart_no = 0;
+    int mx;
+    int my;
+    int i;
+    int j;
+
+    if ((width <= 0) || (height <= 0) || (width > 0xFFFF) || (height > 0xFFFF) || (width > psInputBuff->width)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    for (i = 0; i < DCT_SIZE2; i++) {
+        if ((p_qt_y[i] == 0) || (p_qt_c[i] == 0)) {
+            return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+        }
+        enc->qt[0][i] = p_qt_y[i];
+        enc->qt[1][i] = p_qt_c[i];
+    }
+    for (i = 0; i < 2; i++) {
+        if ((huff_make_enc_table(p_dht[i][0], &enc->dc[i], 11) == false) ||
+            (huff_make_enc_table(p_dht[i][1], &enc->ac[i], 255) == false)) {
+            return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+        }
+    }
+
+    /* Header */
+    enc_emit_word(enc, 0xFF00 | M_SOI);
+    enc_emit_word(enc, 0xFF00 | M_DQT);
+    enc_emit_word(enc, 2 + (65 * 2));
+    for (i = 0; i < 2; i++) {
+        enc_emit(enc, (uint8_t)i);
+        for (j = 0; j < DCT_SIZE2; j++) {
+            enc_emit(enc, (uint8_t)enc->qt[i][jpeg_natural_order[j]]);
+        }
+    }
+    enc_emit_word(enc, 0xFF00 | M_SOF0);
+    enc_emit_word(enc, 8 + (3 * 3));
+    enc_emit(enc, 8);
+    enc_emit_word(enc, (uint32_t)height);
+    enc_emit_word(enc, (uint32_t)width);
+    enc_emit(enc, 3);
+    enc_emit(enc, 1);       /* Y  : H=2 V=1 Tq=0 */
+    enc_emit(enc, 0x21);
+    enc_emit(enc, 0);
+    enc_emit(enc, 2);       /* Cb : H=1 V=1 Tq=1 */
+    enc_emit(enc, 0x11);
+    enc_emit(enc, 1);
+    enc_emit(enc, 3);       /* Cr : H=1 V=1 Tq=1 */
+    enc_emit(enc, 0x11);
+    enc_emit(enc, 1);
+    enc_emit_word(enc, 0xFF00 | M_DHT);
+    enc_emit_word(enc, 2 + dht_size(p_dht[0][0]) + dht_size(p_dht[0][1]) + dht_size(p_dht[1][0]) + dht_size(p_dht[1][1]));
+    enc_write_dht(enc, p_dht[0][0], 0x00);
+    enc_write_dht(enc, p_dht[0][1], 0x10);
+    enc_write_dht(enc, p_dht[1][0], 0x01);
+    enc_write_dht(enc, p_dht[1][1], 0x11);
+    if (pOptions->DRI_value > 0) {
+        enc_emit_word(enc, 0xFF00 | M_DRI);
+        enc_emit_word(enc, 4);
+        enc_emit_word(enc, (uint32_t)pOptions->DRI_value);
+    }
+    enc_emit_word(enc, 0xFF00 | M_SOS);
+    enc_emit_word(enc, 6 + (2 * 3));
+    enc_emit(enc, 3);
+    enc_emit(enc, 1);
+    enc_emit(enc, 0x00);
+    enc_emit(enc, 2);
+    enc_emit(enc, 0x11);
+    enc_emit(enc, 3);
+    enc_emit(enc, 0x11);
+    enc_emit(enc, 0);
+    enc_emit(enc, 63);
+    enc_emit(enc, 0);
+
+    /* Scan (YCbCr422 : MCU = 16 x 8) */
+    mcus_x = (width + (DCT_SIZE * 2) - 1) / (DCT_SIZE * 2);
+    mcus_y = (height + DCT_SIZE - 1) / DCT_SIZE;
+    dc_pred[0] = 0;
+    dc_pred[1] = 0;
+    dc_pred[2] = 0;
+    for (my = 0; my < mcus_y; my++) {
+        for (mx = 0; mx < mcus_x; mx++) {
+            if (pOptions->DRI_value > 0) {
+                if (restart_cnt == pOptions->DRI_value) {
+                    enc_flush_bits(enc);
+                    enc_emit_word(enc, 0xFF00 | (M_RST0 + restart_no));
+                    restart_no = (restart_no + 1) & 7;
+                    restart_cnt = 0;
+                    dc_pred[0] = 0;
+                    dc_pred[1] = 0;
+                    dc_pred[2] = 0;
+                }
+                restart_cnt++;
+            }
+            for (i = 0; i < DCT_SIZE; i++) {
+                int y = (my * DCT_SIZE) + i;
+                if (y >= height) {
+                    y = height - 1;     /* replicate the bottom edge */
+                }
+                enc_read_line(psInputBuff, pOptions, mx * DCT_SIZE * 2, y, width, y_row, cb_row, cr_row);
+                for (j = 0; j < DCT_SIZE; j++) {
+                    data_y0[(i * DCT_SIZE) + j] = (int32_t)y_row[j] - 128;
+                    data_y1[(i * DCT_SIZE) + j] = (int32_t)y_row[DCT_SIZE + j] - 128;
+                    data_cb[(i * DCT_SIZE) + j] = (((int32_t)cb_row[j * 2] + (int32_t)cb_row[(j * 2) + 1] + 1) >> 1) - 128;
+                    data_cr[(i * DCT_SIZE) + j] = (((int32_t)cr_row[j * 2] + (int32_t)cr_row[(j * 2) + 1] + 1) >> 1) - 128;
+                }
+            }
+            if ((enc_block(enc, data_y0, 0, &dc_pred[0]) == false) ||
+                (enc_block(enc, data_y1, 0, &dc_pred[0]) == false) ||
+                (enc_block(enc, data_cb, 1, &dc_pred[1]) == false) ||
+                (enc_block(enc, data_cr, 1, &dc_pred[2]) == false)) {
+                return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+            }
+            if (enc->overflow) {
+                return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+            }
+        }
+    }
+    enc_flush_bits(enc);
+    enc_emit_word(enc, 0xFF00 | M_EOI);
+    if (enc->overflow) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+
+    return JPEG_Converter::JPEG_CONV_OK;
+}
+
+/******************************************************************************
+ * JPEG_SoftConverter
+ ******************************************************************************/
+JPEG_SoftConverter::JPEG_SoftConverter(void) {
+    SetQuality(75);
+}
+
+JPEG_SoftConverter::~JPEG_SoftConverter(void) {
+}
+
+JPEG_Converter::jpeg_conv_error_t
+JPEG_SoftConverter::SetQuality(const uint8_t qual) {
+    return JPEG_Converter::MakeQuantizationTable(qual, QuantizationTable_Y, QuantizationTable_C);
+}
+
+JPEG_Converter::jpeg_conv_error_t
+JPEG_SoftConverter::decode(void* pJpegBuff, JPEG_Converter::bitmap_buff_info_t* psOutputBuff) {
+    JPEG_Converter::decode_options_t Options;
+
+    return (decode(pJpegBuff, psOutputBuff, &Options));
+}
+
+JPEG_Converter::jpeg_conv_error_t
+JPEG_SoftConverter::decode(void* pJpegBuff, JPEG_Converter::bitmap_buff_info_t* psOutputBuff,
+                           JPEG_Converter::decode_options_t* pOptions) {
+    JPEG_Converter::jpeg_conv_error_t e;
+    jpeg_dec_t * dec;
+
+    if ((pJpegBuff == NULL) || (psOutputBuff == NULL) || (pOptions == NULL) ||
+        (psOutputBuff->buffer_address == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if ((psOutputBuff->format != JPEG_Converter::WR_RD_YCbCr422) &&
+        (psOutputBuff->format != JPEG_Converter::WR_RD_ARGB8888) &&
+        (psOutputBuff->format != JPEG_Converter::WR_RD_RGB565)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    if ((pOptions->alpha < 0) || (pOptions->alpha > 0xFF)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+
+    dec = (jpeg_dec_t *)malloc(sizeof(jpeg_dec_t));
+    if (dec == NULL) {
+        return JPEG_Converter::JPEG_CONV_BUSY;
+    }
+    memset(dec, 0, sizeof(jpeg_dec_t));
+    e = jpeg_soft_decode(dec, (const uint8_t *)pJpegBuff, psOutputBuff, pOptions);
+    free(dec);
+
+    if (pOptions->p_DecodeCallBackFunc != NULL) {
+        pOptions->p_DecodeCallBackFunc(e);
+    }
+
+    return e;
+}
+
+JPEG_Converter::jpeg_conv_error_t
+JPEG_SoftConverter::encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize) {
+    JPEG_Converter::encode_options_t Options;
+
+    return (encode(psInputBuff, pJpegBuff, pEncodeSize, &Options));
+}
+
+JPEG_Converter::jpeg_conv_error_t
+JPEG_SoftConverter::encode(JPEG_Converter::bitmap_buff_info_t* psInputBuff, void* pJpegBuff, size_t* pEncodeSize,
+                           JPEG_Converter::encode_options_t* pOptions) {
+    JPEG_Converter::jpeg_conv_error_t e;
+    jpeg_enc_t * enc;
+    const uint8_t * p_dht[2][2];
+    const uint8_t * p_qt_y;
+    const uint8_t * p_qt_c;
+
+    if ((pJpegBuff == NULL) || (psInputBuff == NULL) || (pEncodeSize == NULL) || (pOptions == NULL) ||
+        (psInputBuff->buffer_address == NULL)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_ERR;
+    }
+    if ((psInputBuff->format != JPEG_Converter::WR_RD_YCbCr422) &&
+        (psInputBuff->format != JPEG_Converter::WR_RD_ARGB8888) &&
+        (psInputBuff->format != JPEG_Converter::WR_RD_RGB565)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    if ((pOptions->DRI_value < 0) || (pOptions->DRI_value > 0xFFFF)) {
+        return JPEG_Converter::JPEG_CONV_PARAM_RANGE_ERR;
+    }
+    *pEncodeSize = 0;
+
+    p_qt_y = (pOptions->quantization_table_Y != NULL) ? (const uint8_t *)pOptions->quantization_table_Y : QuantizationTable_Y;
+    p_qt_c = (pOptions->quantization_table_C != NULL) ? (const uint8_t *)pOptions->quantization_table_C : QuantizationTable_C;
+    p_dht[0][0] = (pOptions->huffman_table_Y_DC != NULL) ? (const uint8_t *)pOptions->huffman_table_Y_DC : csaDefaultHuffmanTable_Y_DC;
+    p_dht[0][1] = (pOptions->huffman_table_Y_AC != NULL) ? (const uint8_t *)pOptions->huffman_table_Y_AC : csaDefaultHuffmanTable_Y_AC;
+    p_dht[1][0] = (pOptions->huffman_table_C_DC != NULL) ? (const uint8_t *)pOptions->huffman_table_C_DC : csaDefaultHuffmanTable_C_DC;
+    p_dht[1][1] = (pOptions->huffman_table_C_AC != NULL) ? (const uint8_t *)pOptions->huffman_table_C_AC : csaDefaultHuffmanTable_C_AC;
+
+    enc = (jpeg_enc_t *)malloc(sizeof(jpeg_enc_t));
+    if (enc == NULL) {
+        return JPEG_Converter::JPEG_CONV_BUSY;
+    }
+    memset(enc, 0, sizeof(jpeg_enc_t));
+    enc->buf   = (uint8_t *)pJpegBuff;
+    enc->limit = pOptions->encode_buff_size;
+    e = jpeg_soft_encode(enc, psInputBuff, pOptions, p_qt_y, p_qt_c, p_dht);
+    if (e == JPEG_Converter::JPEG_CONV_OK) {
+        *pEncodeSize = enc->pos;
+    }
+    free(enc);
+
+    if (pOptions->p_EncodeCallBackFunc != NULL) {
+        pOptions->p_EncodeCallBackFunc(e);
+    }
+
+    return e;
+}
@@ -0,0 +1,350 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          jpeg_conv_bench.cpp
+* @brief         Throughput of JPEG_SoftConverter compared with the JCU (JPEG_Converter)
+*
+* A synthetic YCbCr422 image (gradients, edges and noise) is encoded and the result is
+* decoded to YCbCr422, to ARGB8888 and with 1/2 sub-sampling. The time of each operation,
+* the JPEG size and the PSNR of Y of the decoded image against the source are printed for
+* each converter. The JPEG data of the JCU is also decoded by the software converter and
+* vice versa, to check that both converters read each other's output.
+* With the JCU, encode_stream() must output the same data as encode(), and after func aborts
+* encode_stream() the next encode_stream() must succeed.
+*
+* On the RZ/A (mbed), copy this file to an application as main.cpp: both the JCU and the
+* software converter are measured. The buffers are in NC_BSS as the JCU requires.
+* On a Linux host, only the software converter is measured ("-" for the JCU).
+*
+* Build on a Linux host (from GraphicsFramework/jcu/):
+*   g++ -O2 -Iinc -o jpeg_conv_bench tools/jpeg_conv_bench.cpp
+*       soft_codec/JPEG_SoftConverter.cpp jcu_driver/JPEG_Quantization.cpp
+*
+* Usage (host):
+*   jpeg_conv_bench [-n loops] [-s width height] [-q quality]
+*     -n  number of loops of each operation (default 20)
+*     -s  image size, multiple of 16 x 8 (default 640 480)
+*     -q  encode quality (default 75)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "JPEG_SoftConverter.h"
+
+#if defined(__MBED__)
+#include "mbed.h"
+#include "JPEG_Converter.h"
+#define BENCH_USE_JCU
+#define BENCH_NC_BSS    __attribute((section("NC_BSS"),aligned(32)))
+#else
+#include <chrono>
+#define BENCH_NC_BSS    __attribute((aligned(32)))
+#endif
+
+#define IMAGE_W_MAX     (640)
+#define IMAGE_H_MAX     (480)
+#define JPEG_BUFF_SIZE  (1024 * 256)
+
+static uint8_t src_buf[IMAGE_W_MAX * IMAGE_H_MAX * 2] BENCH_NC_BSS;
+static uint8_t dst_buf[IMAGE_W_MAX * IMAGE_H_MAX * 4] BENCH_NC_BSS;
+static uint8_t jpeg_buf[2][JPEG_BUFF_SIZE] BENCH_NC_BSS;
+#if defined(BENCH_USE_JCU)
+static uint8_t chunk_buf[2 * JPEG_CONV_STREAM_CHUNK_SIZE] BENCH_NC_BSS;
+#endif
+
+static int image_w = IMAGE_W_MAX;
+static int image_h = IMAGE_H_MAX;
+static int loops = 20;
+static int quality = 75;
+
+typedef enum {
+    OP_ENCODE,
+    OP_DECODE_YCBCR422,
+    OP_DECODE_ARGB8888,
+    OP_DECODE_1_2,
+    OP_NUM
+} op_t;
+
+static const char * const op_name[OP_NUM] = {
+    "encode YCbCr422",
+    "decode YCbCr422",
+    "decode ARGB8888",
+    "decode 1/2",
+};
+
+/* Time in microseconds */
+#if defined(__MBED__)
+static Timer bench_timer;
+
+static void timer_start(void) {
+    bench_timer.reset();
+    bench_timer.start();
+}
+
+static double timer_us(void) {
+    bench_timer.stop();
+    return (double)bench_timer.read_us();
+}
+#else
+static std::chrono::steady_clock::time_point bench_start;
+
+static void timer_start(void) {
+    bench_start = std::chrono::steady_clock::now();
+}
+
+static double timer_us(void) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - bench_start).count();
+}
+#endif
+
+/* Byte n of the big-endian pixel data (Cb0 Y0 Cr0 Y1) with the default swap (WR_RD_WRSWA_8BIT) */
+#define SWAP_8BIT(n)    ((n) ^ 1)
+
+/* YCbCr422 source image */
+static void make_image(void) {
+    uint32_t seed = 12345;
+    int x;
+    int y;
+
+    for (y = 0; y < image_h; y++) {
+        for (x = 0; x < image_w; x += 2) {
+            uint8_t * p = &src_buf[((y * image_w) + x) * 2];
+            int base = ((x * 200) / image_w) + ((y * 40) / image_h);
+            int noise;
+            int i;
+
+            if ((((x / 64) + (y / 48)) & 1) != 0) {
+                base = 255 - base;
+            }
+            for (i = 0; i < 2; i++) {
+                seed = (seed * 1103515245u) + 12345u;
+                noise = (int)((seed >> 16) & 0x0F) - 8;
+                p[SWAP_8BIT((i * 2) + 1)] = (uint8_t)((base + noise < 16) ? 16 : ((base + noise > 235) ? 235 : (base + noise)));
+            }
+            p[SWAP_8BIT(0)] = (uint8_t)(128 + ((x * 64) / image_w) - 32);
+            p[SWAP_8BIT(2)] = (uint8_t)(128 + ((y * 64) / image_h) - 32);
+        }
+    }
+}
+
+/* PSNR of Y of a YCbCr422 image of the same size and swap as the source */
+static double psnr_y(const uint8_t * p_img) {
+    double sum = 0.0;
+    int i;
+
+    for (i = 0; i < (image_w * image_h); i++) {
+        int d = (int)p_img[SWAP_8BIT((i * 2) + 1)] - (int)src_buf[SWAP_8BIT((i * 2) + 1)];
+        sum += (double)(d * d);
+    }
+    if (sum == 0.0) {
+        return 99.0;
+    }
+    return 10.0 * log10((255.0 * 255.0) / (sum / (image_w * image_h)));
+}
+
+#if defined(BENCH_USE_JCU)
+typedef struct {
+    uint8_t *   p_buf;
+    size_t      pos;
+    size_t      abort_pos;      /* func returns false when this size has been received */
+} stream_sink_t;
+
+static bool stream_sink(void * p_user, const uint8_t * p_data, size_t size) {
+    stream_sink_t * p_sink = (stream_sink_t *)p_user;
+
+    if ((p_sink->pos + size) <= sizeof(dst_buf)) {
+        memcpy(&p_sink->p_buf[p_sink->pos], p_data, size);
+    }
+    p_sink->pos += size;
+    return (p_sink->pos < p_sink->abort_pos);
+}
+
+/* encode_stream() to dst_buf */
+static JPEG_Converter::jpeg_conv_error_t encode_stream(JPEG_Converter & jcu, size_t abort_pos, size_t * p_size) {
+    JPEG_Converter::bitmap_buff_info_t bitmap;
+    stream_sink_t sink;
+
+    bitmap.width = image_w;
+    bitmap.height = image_h;
+    bitmap.format = JPEG_Converter::WR_RD_YCbCr422;
+    bitmap.buffer_address = src_buf;
+    sink.p_buf = dst_buf;
+    sink.pos = 0;
+    sink.abort_pos = abort_pos;
+    return jcu.encode_stream(&bitmap, chunk_buf, JPEG_CONV_STREAM_CHUNK_SIZE, &stream_sink, &sink, p_size);
+}
+#endif
+
+/* Runs an operation "loops" times with a converter (JPEG_Converter or JPEG_SoftConverter) */
+template <class CONV>
+static bool run(CONV & conv, op_t op, uint8_t * p_jpeg, size_t * p_size, double * p_us) {
+    JPEG_Converter::bitmap_buff_info_t bitmap;
+    JPEG_Converter::encode_options_t   enc_options;
+    JPEG_Converter::decode_options_t   dec_options;
+    JPEG_Converter::jpeg_conv_error_t  ret = JPEG_Converter::JPEG_CONV_OK;
+    int n;
+
+    bitmap.width = image_w;
+    bitmap.height = image_h;
+    bitmap.format = JPEG_Converter::WR_RD_YCbCr422;
+    enc_options.encode_buff_size = JPEG_BUFF_SIZE;
+    if (op == OP_ENCODE) {
+        bitmap.buffer_address = src_buf;
+    } else {
+        bitmap.buffer_address = dst_buf;
+        if (op == OP_DECODE_ARGB8888) {
+            bitmap.format = JPEG_Converter::WR_RD_ARGB8888;
+            dec_options.output_cb_cr_offset = JPEG_Converter::CBCR_OFFSET_0;
+            dec_options.alpha = 0xFF;
+        } else if (op == OP_DECODE_1_2) {
+            bitmap.width = image_w / 2;
+            bitmap.height = image_h / 2;
+            dec_options.vertical_sub_sampling = JPEG_Converter::SUB_SAMPLING_1_2;
+            dec_options.horizontal_sub_sampling = JPEG_Converter::SUB_SAMPLING_1_2;
+        }
+    }
+
+    timer_start();
+    for (n = 0; (n < loops) && (ret == JPEG_Converter::JPEG_CONV_OK); n++) {
+        if (op == OP_ENCODE) {
+            ret = conv.encode(&bitmap, p_jpeg, p_size, &enc_options);
+        } else {
+            ret = conv.decode(p_jpeg, &bitmap, &dec_options);
+        }
+    }
+    *p_us = timer_us() / loops;
+    return (ret == JPEG_Converter::JPEG_CONV_OK);
+}
+
+static void print_result(bool ok, double us) {
+    if (!ok) {
+        printf(" %10s", "error");
+    } else if (us < 0.0) {
+        printf(" %10s", "-");
+    } else {
+        printf(" %10.2f", us / 1000.0);
+    }
+}
+
+int main(int argc, char * argv[]) {
+    JPEG_SoftConverter soft;
+    size_t soft_size = 0;
+    double soft_us[OP_NUM];
+    bool soft_ok[OP_NUM];
+    double soft_psnr;
+    double psnr_us;
+    double jcu_us[OP_NUM];
+    bool jcu_ok[OP_NUM];
+    int i;
+
+#if defined(__MBED__)
+    (void)argc;
+    (void)argv;
+#else
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+            loops = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-s") == 0) && ((i + 2) < argc)) {
+            image_w = atoi(argv[++i]);
+            image_h = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-q") == 0) && ((i + 1) < argc)) {
+            quality = atoi(argv[++i]);
+        } else {
+            printf("usage: jpeg_conv_bench [-n loops] [-s width height] [-q quality]\n");
+            return 2;
+        }
+    }
+    if ((loops <= 0) || (image_w <= 0) || (image_h <= 0) || (image_w > IMAGE_W_MAX) || (image_h > IMAGE_H_MAX)
+     || ((image_w % 16) != 0) || ((image_h % 8) != 0)) {
+        return 2;
+    }
+#endif
+    make_image();
+    (void)soft.SetQuality((uint8_t)quality);
+
+    /* Software converter */
+    soft_ok[OP_ENCODE] = run(soft, OP_ENCODE, jpeg_buf[0], &soft_size, &soft_us[OP_ENCODE]);
+    for (i = OP_DECODE_YCBCR422; i < OP_NUM; i++) {
+        soft_ok[i] = soft_ok[OP_ENCODE] && run(soft, (op_t)i, jpeg_buf[0], NULL, &soft_us[i]);
+    }
+    /* The last decode was 1/2, decode the full size again for the PSNR */
+    (void)run(soft, OP_DECODE_YCBCR422, jpeg_buf[0], NULL, &psnr_us);
+    soft_psnr = psnr_y(dst_buf);
+
+    for (i = 0; i < OP_NUM; i++) {
+        jcu_ok[i] = true;
+        jcu_us[i] = -1.0;
+    }
+#if defined(BENCH_USE_JCU)
+    JPEG_Converter jcu;
+    size_t jcu_size = 0;
+    double jcu_psnr;
+    size_t stream_size = 0;
+    bool stream_ok;
+    bool cross_ok;
+
+    (void)jcu.SetQuality((uint8_t)quality);
+    jcu_ok[OP_ENCODE] = run(jcu, OP_ENCODE, jpeg_buf[1], &jcu_size, &jcu_us[OP_ENCODE]);
+    for (i = OP_DECODE_YCBCR422; i < OP_NUM; i++) {
+        jcu_ok[i] = jcu_ok[OP_ENCODE] && run(jcu, (op_t)i, jpeg_buf[1], NULL, &jcu_us[i]);
+    }
+    (void)run(jcu, OP_DECODE_YCBCR422, jpeg_buf[1], NULL, &psnr_us);
+    jcu_psnr = psnr_y(dst_buf);
+#endif
+
+    printf("%dx%d, quality %d, %d loops, ms per image\n", image_w, image_h, quality, loops);
+    printf("%-18s %10s %10s\n", "", "JCU", "soft");
+    for (i = 0; i < OP_NUM; i++) {
+        printf("%-18s", op_name[i]);
+        print_result(jcu_ok[i], jcu_us[i]);
+        print_result(soft_ok[i], soft_us[i]);
+        printf("\n");
+    }
+#if defined(BENCH_USE_JCU)
+    printf("%-18s %10u %10u\n", "JPEG size", (unsigned)jcu_size, (unsigned)soft_size);
+    printf("%-18s %10.2f %10.2f\n", "PSNR of Y (dB)", jcu_psnr, soft_psnr);
+
+    /* Each converter decodes the output of the other */
+    cross_ok = run(soft, OP_DECODE_YCBCR422, jpeg_buf[1], NULL, &psnr_us);
+    printf("soft decode of JCU JPEG: %s, PSNR %.2f dB\n", cross_ok ? "OK" : "error", psnr_y(dst_buf));
+    cross_ok = run(jcu, OP_DECODE_YCBCR422, jpeg_buf[0], NULL, &psnr_us);
+    printf("JCU decode of soft JPEG: %s, PSNR %.2f dB\n", cross_ok ? "OK" : "error", psnr_y(dst_buf));
+
+    /* encode_stream() outputs the same data as encode(), also after an abort by func */
+    timer_start();
+    stream_ok = (encode_stream(jcu, (size_t)-1, &stream_size) == JPEG_Converter::JPEG_CONV_OK);
+    psnr_us = timer_us();
+    stream_ok = stream_ok && (stream_size == jcu_size) && (memcmp(dst_buf, jpeg_buf[1], jcu_size) == 0);
+    printf("encode_stream: %s, %.2f ms\n", stream_ok ? "OK" : "NG", psnr_us / 1000.0);
+    jcu_ok[OP_ENCODE] = jcu_ok[OP_ENCODE] && stream_ok;
+    stream_ok = (encode_stream(jcu, 1, &stream_size) == JPEG_Converter::JPEG_CONV_JCU_ERR);
+    stream_ok = stream_ok && (encode_stream(jcu, (size_t)-1, &stream_size) == JPEG_Converter::JPEG_CONV_OK);
+    stream_ok = stream_ok && (stream_size == jcu_size) && (memcmp(dst_buf, jpeg_buf[1], jcu_size) == 0);
+    printf("encode_stream after an abort: %s\n", stream_ok ? "OK" : "NG");
+    jcu_ok[OP_ENCODE] = jcu_ok[OP_ENCODE] && stream_ok;
+#else
+    printf("%-18s %10s %10u\n", "JPEG size", "-", (unsigned)soft_size);
+    printf("%-18s %10s %10.2f\n", "PSNR of Y (dB)", "-", soft_psnr);
+#endif
+    for (i = 0; i < OP_NUM; i++) {
+        if ((!soft_ok[i]) || (!jcu_ok[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
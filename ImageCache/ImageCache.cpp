@@ -0,0 +1,370 @@
+/* mbed ImageCache Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "dcache-control.h"
+#include "JPEG_Probe.h"
+#include "ImageCache.h"
+
+#define ALIGN_UP(x)     (((x) + (IMAGE_CACHE_ALIGN - 1)) & ~(IMAGE_CACHE_ALIGN - 1))
+#define LAYER_NUM       (sizeof(_layer_handle) / sizeof(_layer_handle[0]))
+
+static uint32_t name_hash(const char * name) {
+    uint32_t hash = 2166136261u;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+ImageCache::ImageCache(void * vram, uint32_t vram_size, JPEG_Converter * jcu) :
+    _vram(NULL), _vram_size(0), _jcu(jcu), _vsync_count(0), _use_count(0) {
+    uint32_t top = ALIGN_UP((uint32_t)vram);
+    uint32_t i;
+
+    if ((vram != NULL) && (vram_size > (top - (uint32_t)vram))) {
+        _vram = (uint8_t *)top;
+        _vram_size = vram_size - (top - (uint32_t)vram);
+    }
+    for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+        _entry[i].used = false;
+    }
+    for (i = 0; i < LAYER_NUM; i++) {
+        _layer_handle[i] = -1;
+        _layer_pending[i] = -1;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.budget_size = _vram_size;
+}
+
+bool ImageCache::get_jpeg(const char * name, const void * jpeg, size_t size, JPEG_Converter::wr_rd_format_t format,
+                          JPEG_Converter::sub_sampling_t scale, image_t * p_image) {
+    JPEG_Probe::jpeg_info_t info;
+    JPEG_Probe::output_plan_t plan;
+    JPEG_Converter::decode_options_t options;
+    JPEG_Converter::bitmap_buff_info_t bitmap;
+    int idx;
+
+    if ((name == NULL) || (p_image == NULL) || (_jcu == NULL)) {
+        return false;
+    }
+    idx = lookup(name, (int)format, (int)scale);
+    if (idx >= 0) {
+        _stats.hits++;
+        *p_image = _entry[idx].image;
+        return true;
+    }
+
+    _stats.misses++;
+    options.horizontal_sub_sampling = scale;
+    options.vertical_sub_sampling   = scale;
+    if ((jpeg == NULL)
+     || (JPEG_Probe::Probe(jpeg, size, &info) != JPEG_Converter::JPEG_CONV_OK)
+     || (!info.jcu_supported)
+     || (JPEG_Probe::GetOutputPlan(&info, format, &options, &plan) != JPEG_Converter::JPEG_CONV_OK)) {
+        _stats.errors++;
+        return false;
+    }
+    idx = alloc_entry(name, (int)format, (int)scale, plan.buffer_size);
+    if (idx < 0) {
+        _stats.errors++;
+        return false;
+    }
+    set_image(idx, format, plan.width, plan.height, plan.image_width, plan.image_height);
+
+    dcache_clean((void *)jpeg, size);
+    bitmap.width          = plan.width;
+    bitmap.height         = plan.height;
+    bitmap.format         = format;
+    bitmap.buffer_address = _entry[idx].image.buffer;
+    if (_jcu->decode((void *)jpeg, &bitmap, &options) != JPEG_Converter::JPEG_CONV_OK) {
+        release_entry(idx);
+        _stats.errors++;
+        return false;
+    }
+    dcache_invalid(_entry[idx].image.buffer, plan.buffer_size);
+    *p_image = _entry[idx].image;
+
+    return true;
+}
+
+bool ImageCache::get(const char * name, JPEG_Converter::wr_rd_format_t format, int scale, int32_t width, int32_t height,
+                     decode_func_t func, void * p_user, image_t * p_image) {
+    uint32_t byte_per_pixel;
+    uint32_t stride;
+    int idx;
+
+    if ((name == NULL) || (p_image == NULL) || (func == NULL) || (width <= 0) || (height <= 0)) {
+        return false;
+    }
+    idx = lookup(name, (int)format, scale);
+    if (idx >= 0) {
+        _stats.hits++;
+        *p_image = _entry[idx].image;
+        return true;
+    }
+
+    _stats.misses++;
+    byte_per_pixel = (format == JPEG_Converter::WR_RD_ARGB8888) ? 4 : 2;
+    stride = ((uint32_t)width * byte_per_pixel + 7u) & ~7u;     // The line offset is a multiple of 8 bytes
+    idx = alloc_entry(name, (int)format, scale, stride * height);
+    if (idx < 0) {
+        _stats.errors++;
+        return false;
+    }
+    set_image(idx, format, stride / byte_per_pixel, height, width, height);
+    if (!func(p_user, _entry[idx].image.buffer, stride)) {
+        release_entry(idx);
+        _stats.errors++;
+        return false;
+    }
+    *p_image = _entry[idx].image;
+
+    return true;
+}
+
+bool ImageCache::find(const char * name, JPEG_Converter::wr_rd_format_t format, int scale, image_t * p_image) {
+    int idx;
+
+    if ((name == NULL) || (p_image == NULL)) {
+        return false;
+    }
+    idx = lookup(name, (int)format, scale);
+    if (idx < 0) {
+        return false;
+    }
+    *p_image = _entry[idx].image;
+
+    return true;
+}
+
+void ImageCache::pin(int handle) {
+    if ((handle >= 0) && (handle < IMAGE_CACHE_ENTRY_MAX) && (_entry[handle].used)) {
+        _entry[handle].pin_count++;
+    }
+}
+
+void ImageCache::unpin(int handle) {
+    if ((handle >= 0) && (handle < IMAGE_CACHE_ENTRY_MAX) && (_entry[handle].used) && (_entry[handle].pin_count > 0)) {
+        _entry[handle].pin_count--;
+    }
+}
+
+bool ImageCache::bind_layer(DisplayBase * display, DisplayBase::graphics_layer_t layer, const image_t * p_image) {
+    if ((display == NULL) || (p_image == NULL) || ((uint32_t)layer >= LAYER_NUM)) {
+        return false;
+    }
+    if ((p_image->handle < 0) || (p_image->handle >= IMAGE_CACHE_ENTRY_MAX) || (!_entry[p_image->handle].used)
+     || (_entry[p_image->handle].image.buffer != p_image->buffer)) {
+        return false;
+    }
+    if (display->Graphics_Read_Change(layer, p_image->buffer) != DisplayBase::GRAPHICS_OK) {
+        return false;
+    }
+    pin(p_image->handle);
+    // After Graphics_Read_Change(): a vsync before this point has latched the image being replaced
+    release_pending();
+    if (_layer_handle[layer] >= 0) {
+        if (_layer_pending[layer] < 0) {
+            _layer_pending[layer] = _layer_handle[layer];
+            _layer_pending_vsync[layer] = _vsync_count;
+        } else {
+            // Replaced before a vsync: it has never been read by the VDC
+            unpin(_layer_handle[layer]);
+        }
+    }
+    _layer_handle[layer] = p_image->handle;
+
+    return true;
+}
+
+void ImageCache::vsync(void) {
+    _vsync_count++;
+}
+
+void ImageCache::flush(void) {
+    int i;
+
+    release_pending();
+    for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+        if ((_entry[i].used) && (_entry[i].pin_count == 0)) {
+            release_entry(i);
+        }
+    }
+}
+
+void ImageCache::get_stats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = _stats;
+    }
+}
+
+int ImageCache::lookup(const char * name, int format, int scale) {
+    uint32_t hash = name_hash(name);
+    int i;
+
+    for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+        if ((_entry[i].used) && (_entry[i].hash == hash) && (_entry[i].format == format)
+         && (_entry[i].scale == scale) && (strcmp(_entry[i].name, name) == 0)) {
+            _use_count++;
+            _entry[i].last_use = _use_count;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int ImageCache::alloc_entry(const char * name, int format, int scale, uint32_t size) {
+    uint32_t offset;
+    int idx = -1;
+    int lru;
+    int i;
+
+    if ((strlen(name) >= IMAGE_CACHE_NAME_MAX) || (size == 0) || (size > _vram_size)) {
+        return -1;
+    }
+    size = ALIGN_UP(size);
+    release_pending();
+
+    while (true) {
+        if (idx < 0) {
+            for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+                if (!_entry[i].used) {
+                    idx = i;
+                    break;
+                }
+            }
+        }
+        if ((idx >= 0) && (find_space(size, &offset))) {
+            break;
+        }
+        // Release the least recently used image
+        lru = -1;
+        for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+            if ((_entry[i].used) && (_entry[i].pin_count == 0)
+             && ((lru < 0) || ((int32_t)(_entry[i].last_use - _entry[lru].last_use) < 0))) {
+                lru = i;
+            }
+        }
+        if (lru < 0) {
+            return -1;      // All images are pinned
+        }
+        release_entry(lru);
+        _stats.evictions++;
+    }
+
+    _use_count++;
+    _entry[idx].used      = true;
+    _entry[idx].hash      = name_hash(name);
+    strcpy(_entry[idx].name, name);
+    _entry[idx].format    = format;
+    _entry[idx].scale     = scale;
+    _entry[idx].offset    = offset;
+    _entry[idx].size      = size;
+    _entry[idx].last_use  = _use_count;
+    _entry[idx].pin_count = 0;
+    _stats.entry_num++;
+    _stats.used_size += size;
+
+    return idx;
+}
+
+/* First fit in the gaps between the images */
+bool ImageCache::find_space(uint32_t size, uint32_t * p_offset) {
+    uint32_t pos = 0;
+    uint32_t next;
+    uint32_t next_end;
+    int i;
+
+    while (true) {
+        // The image which starts first at or after pos
+        next = _vram_size;
+        next_end = _vram_size;
+        for (i = 0; i < IMAGE_CACHE_ENTRY_MAX; i++) {
+            if ((_entry[i].used) && (_entry[i].offset >= pos) && (_entry[i].offset < next)) {
+                next = _entry[i].offset;
+                next_end = _entry[i].offset + _entry[i].size;
+            }
+        }
+        if ((next - pos) >= size) {
+            *p_offset = pos;
+            return true;
+        }
+        if (next >= _vram_size) {
+            return false;
+        }
+        pos = next_end;
+    }
+}
+
+void ImageCache::release_entry(int idx) {
+    uint32_t i;
+
+    for (i = 0; i < LAYER_NUM; i++) {
+        if (_layer_handle[i] == idx) {
+            _layer_handle[i] = -1;
+        }
+        if (_layer_pending[i] == idx) {
+            _layer_pending[i] = -1;
+        }
+    }
+    _entry[idx].used = false;
+    _stats.entry_num--;
+    _stats.used_size -= _entry[idx].size;
+}
+
+/* Unpin the images replaced on the layers before the last vsync */
+void ImageCache::release_pending(void) {
+    uint32_t vsync_count = _vsync_count;
+    uint32_t i;
+
+    for (i = 0; i < LAYER_NUM; i++) {
+        if ((_layer_pending[i] >= 0) && (_layer_pending_vsync[i] != vsync_count)) {
+            unpin(_layer_pending[i]);
+            _layer_pending[i] = -1;
+        }
+    }
+}
+
+void ImageCache::set_image(int idx, JPEG_Converter::wr_rd_format_t format, int32_t width, int32_t height,
+                           int32_t image_width, int32_t image_height) {
+    image_t * p_image = &_entry[idx].image;
+
+    p_image->buffer       = (void *)&_vram[_entry[idx].offset];
+    p_image->width        = width;
+    p_image->height       = height;
+    p_image->image_width  = image_width;
+    p_image->image_height = image_height;
+    p_image->format       = format;
+    p_image->handle       = idx;
+    if (format == JPEG_Converter::WR_RD_ARGB8888) {
+        p_image->stride    = (uint32_t)width * 4;
+        p_image->gr_format = DisplayBase::GRAPHICS_FORMAT_ARGB8888;
+        p_image->gr_swa    = DisplayBase::WR_RD_WRSWA_32BIT;
+    } else if (format == JPEG_Converter::WR_RD_RGB565) {
+        p_image->stride    = (uint32_t)width * 2;
+        p_image->gr_format = DisplayBase::GRAPHICS_FORMAT_RGB565;
+        p_image->gr_swa    = DisplayBase::WR_RD_WRSWA_32_16BIT;
+    } else {
+        p_image->stride    = (uint32_t)width * 2;
+        p_image->gr_format = DisplayBase::GRAPHICS_FORMAT_YCBCR422;
+        p_image->gr_swa    = DisplayBase::WR_RD_WRSWA_32_16BIT;
+    }
+}
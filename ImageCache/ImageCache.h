@@ -0,0 +1,236 @@
+/* mbed ImageCache Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          ImageCache.h
+* @brief         LRU cache of decoded images in video memory
+******************************************************************************/
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include "mbed.h"
+#include "DisplayBace.h"
+#include "JPEG_Converter.h"
+
+/** Maximum number of images in the cache */
+#ifndef IMAGE_CACHE_ENTRY_MAX
+#define IMAGE_CACHE_ENTRY_MAX       (32)
+#endif
+
+/** Maximum length of the source name (including '\0') */
+#ifndef IMAGE_CACHE_NAME_MAX
+#define IMAGE_CACHE_NAME_MAX        (64)
+#endif
+
+/** Alignment of the image buffers (byte) */
+#ifndef IMAGE_CACHE_ALIGN
+#define IMAGE_CACHE_ALIGN           (32)
+#endif
+
+/** A class to keep decoded images in a video memory region
+ *
+ * The images are keyed by (source name, format, scale). When the region is full,
+ * the least recently used images which are not pinned are released.
+ * JPEG is decoded by JPEG_Converter. Other formats (PNG, etc.) can be decoded
+ * by a function of the application.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "ImageCache.h"
+ *
+ * static uint8_t vram[1024 * 1024 * 2] __attribute((section("NC_BSS"),aligned(32)));
+ *
+ * DisplayBase Display;
+ * JPEG_Converter Jcu;
+ * ImageCache image_cache(vram, sizeof(vram), &Jcu);
+ *
+ * void show(const char * name, const void * jpeg, size_t size) {
+ *     ImageCache::image_t image;
+ *
+ *     if (image_cache.get_jpeg(name, jpeg, size, JPEG_Converter::WR_RD_RGB565,
+ *                              JPEG_Converter::SUB_SAMPLING_1_1, &image)) {
+ *         image_cache.bind_layer(&Display, DisplayBase::GRAPHICS_LAYER_0, &image);
+ *     }
+ * }
+ * @endcode
+ */
+class ImageCache {
+public:
+    /*! @struct image_t
+        @brief Decoded image
+     */
+    typedef struct {
+        void *                          buffer;         /*!< Address of the image (for Graphics_Read_Change) */
+        uint32_t                        stride;         /*!< Line offset (byte) */
+        int32_t                         width;          /*!< Width of the buffer (pixel) */
+        int32_t                         height;         /*!< Height of the buffer (line) */
+        int32_t                         image_width;    /*!< Width of the valid image (pixel) */
+        int32_t                         image_height;   /*!< Height of the valid image (line) */
+        JPEG_Converter::wr_rd_format_t  format;         /*!< Format */
+        DisplayBase::graphics_format_t  gr_format;      /*!< Format for Graphics_Read_Setting */
+        DisplayBase::wr_rd_swa_t        gr_swa;         /*!< Swap setting for Graphics_Read_Setting */
+        int                             handle;         /*!< Handle for pin()/unpin() */
+    } image_t;
+
+    /*! @struct stats_t
+        @brief Cache statistics
+     */
+    typedef struct {
+        uint32_t    hits;               /*!< Number of images found in the cache */
+        uint32_t    misses;             /*!< Number of images decoded */
+        uint32_t    evictions;          /*!< Number of images released to make room */
+        uint32_t    errors;             /*!< Number of decode errors or no room */
+        uint32_t    entry_num;          /*!< Number of images in the cache */
+        uint32_t    used_size;          /*!< Size used by the images (byte) */
+        uint32_t    budget_size;        /*!< Size of the region (byte) */
+    } stats_t;
+
+    /** Function to decode an image other than JPEG
+     *
+     * @param p_user user data
+     * @param buffer address to write the image
+     * @param stride line offset of the buffer (byte)
+     * @return true = success, false = failure
+     */
+    typedef bool (* decode_func_t)(void * p_user, void * buffer, uint32_t stride);
+
+    /** Constructor
+     *
+     * @param vram video memory region for the images
+     * @param vram_size size of the region (byte budget)
+     * @param jcu JPEG converter
+     */
+    ImageCache(void * vram, uint32_t vram_size, JPEG_Converter * jcu);
+
+    /** Get a decoded JPEG image
+     *
+     * @param name source name (file path, asset name, etc.)
+     * @param jpeg JPEG data (used only when the image is not in the cache)
+     * @param size JPEG data size
+     * @param format output format
+     * @param scale sub-sampling of the JCU (same for both directions)
+     * @param p_image image
+     * @return true = success, false = failure
+     */
+    bool get_jpeg(const char * name, const void * jpeg, size_t size, JPEG_Converter::wr_rd_format_t format,
+                  JPEG_Converter::sub_sampling_t scale, image_t * p_image);
+
+    /** Get an image decoded by a function of the application
+     *
+     * @param name source name
+     * @param format format written by func
+     * @param scale scale value of the key (any value defined by the application)
+     * @param width width of the image (pixel)
+     * @param height height of the image (line)
+     * @param func decode function (called only when the image is not in the cache)
+     * @param p_user user data of func
+     * @param p_image image
+     * @return true = success, false = failure
+     */
+    bool get(const char * name, JPEG_Converter::wr_rd_format_t format, int scale, int32_t width, int32_t height,
+             decode_func_t func, void * p_user, image_t * p_image);
+
+    /** Look up an image without decoding
+     *
+     * @param name source name
+     * @param format format
+     * @param scale scale
+     * @param p_image image
+     * @return true = found, false = not found
+     */
+    bool find(const char * name, JPEG_Converter::wr_rd_format_t format, int scale, image_t * p_image);
+
+    /** Keep an image in the cache
+     *
+     * Pinned images are not released. pin() and unpin() are counted.
+     *
+     * @param handle handle of the image
+     */
+    void pin(int handle);
+
+    /** Release the pin of an image
+     *
+     * @param handle handle of the image
+     */
+    void unpin(int handle);
+
+    /** Display an image on a graphics layer and keep it while it is displayed
+     *
+     * Calls Graphics_Read_Change(). The VDC reads the image displayed before until the next vsync,
+     * so it is unpinned by the first bind_layer(), get_jpeg(), get() or flush() after vsync() has been called.
+     * If vsync() is not called, the image displayed before is kept pinned until the layer is bound again
+     * (one extra image per layer).
+     * The layer must be set by Graphics_Read_Setting() with the same stride and format.
+     *
+     * @param display display
+     * @param layer graphics layer
+     * @param p_image image
+     * @return true = success, false = failure
+     */
+    bool bind_layer(DisplayBase * display, DisplayBase::graphics_layer_t layer, const image_t * p_image);
+
+    /** Vsync process
+     *
+     * Called from the vsync interrupt of the display, when bind_layer() is used.
+     */
+    void vsync(void);
+
+    /** Release the images which are not pinned
+     */
+    void flush(void);
+
+    /** Get the cache statistics
+     *
+     * @param p_stats statistics
+     */
+    void get_stats(stats_t * p_stats);
+
+private:
+    typedef struct {
+        bool        used;
+        uint32_t    hash;
+        char        name[IMAGE_CACHE_NAME_MAX];
+        int         format;
+        int         scale;
+        uint32_t    offset;
+        uint32_t    size;
+        uint32_t    last_use;
+        uint32_t    pin_count;
+        image_t     image;
+    } entry_t;
+
+    uint8_t * _vram;
+    uint32_t _vram_size;
+    JPEG_Converter * _jcu;
+    entry_t _entry[IMAGE_CACHE_ENTRY_MAX];
+    int _layer_handle[4];
+    int _layer_pending[4];              /* Image replaced on the layer and still read by the VDC, -1 = none */
+    uint32_t _layer_pending_vsync[4];   /* _vsync_count when the image was replaced */
+    volatile uint32_t _vsync_count;
+    uint32_t _use_count;
+    stats_t _stats;
+
+    int lookup(const char * name, int format, int scale);
+    int alloc_entry(const char * name, int format, int scale, uint32_t size);
+    bool find_space(uint32_t size, uint32_t * p_offset);
+    void release_entry(int idx);
+    void release_pending(void);
+    void set_image(int idx, JPEG_Converter::wr_rd_format_t format, int32_t width, int32_t height,
+                   int32_t image_width, int32_t image_height);
+};
+
+#endif
@@ -0,0 +1,1028 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "Pixel2D.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_2D_USE_NEON
+#endif
+
+#define CLUT_CACHE_NUM      (64)
+
+typedef struct {
+    uint32_t    argb[CLUT_CACHE_NUM];
+    uint8_t     index[CLUT_CACHE_NUM];
+    bool        valid[CLUT_CACHE_NUM];
+} clut_cache_t;
+
+/* x / 255 rounded, x <= 255 * 255 */
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+#define YCBCR_COEF_BITS     (13)
+
+/* Coefficients of YCbCr to RGB (scaled by 2^YCBCR_COEF_BITS) */
+typedef struct {
+    int16_t     y_offset;
+    int16_t     y_gain;
+    int16_t     cr_r;
+    int16_t     cb_g;
+    int16_t     cr_g;
+    int16_t     cb_b;
+} ycbcr_coef_t;
+
+/* [matrix][range] */
+static const ycbcr_coef_t ycbcr_coef[2][2] = {
+    {{16, 9539, 13075, 3209, 6660, 16525}, {0, 8192, 11485, 2819, 5850, 14516}},    /* BT.601 */
+    {{16, 9539, 14686, 1747, 4366, 17305}, {0, 8192, 12901, 1535, 3835, 15201}},    /* BT.709 */
+};
+
+/* The value of the rounding is the same as vqrshrun_n_s32 */
+static inline uint32_t ycbcr_clip(int32_t v) {
+    v = (v + (1 << (YCBCR_COEF_BITS - 1))) >> YCBCR_COEF_BITS;
+    return (v < 0) ? 0 : ((v > 255) ? 255 : (uint32_t)v);
+}
+
+static inline uint32_t ycbcr_to_argb(int32_t y, int32_t cb, int32_t cr, const ycbcr_coef_t * p_coef) {
+    int32_t yv = (y - p_coef->y_offset) * p_coef->y_gain;
+    int32_t d = cb - 128;
+    int32_t e = cr - 128;
+
+    return 0xFF000000
+         | (ycbcr_clip(yv + (p_coef->cr_r * e)) << 16)
+         | (ycbcr_clip(yv - (p_coef->cb_g * d) - (p_coef->cr_g * e)) << 8)
+         | ycbcr_clip(yv + (p_coef->cb_b * d));
+}
+
+static inline uint8_t argb_to_y(uint32_t argb) {
+    int32_t r = (argb >> 16) & 0xFF;
+    int32_t g = (argb >> 8) & 0xFF;
+    int32_t b = argb & 0xFF;
+
+    return (uint8_t)(16 + (((66 * r) + (129 * g) + (25 * b) + 128) >> 8));
+}
+
+static inline uint8_t argb_to_cb(int32_t r, int32_t g, int32_t b) {
+    return (uint8_t)(128 + (((-38 * r) - (74 * g) + (112 * b) + 128) >> 8));
+}
+
+static inline uint8_t argb_to_cr(int32_t r, int32_t g, int32_t b) {
+    return (uint8_t)(128 + (((112 * r) - (94 * g) - (18 * b) + 128) >> 8));
+}
+
+static inline uint32_t rgb565_to_argb(uint32_t v) {
+    uint32_t r = (v >> 11) & 0x1F;
+    uint32_t g = (v >> 5) & 0x3F;
+    uint32_t b = v & 0x1F;
+
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+static inline uint16_t argb_to_rgb565(uint32_t argb) {
+    return (uint16_t)(((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 3) & 0x001F));
+}
+
+static inline uint32_t argb4444_to_argb(uint32_t v) {
+    return (((v >> 12) & 0x0F) * 0x11000000) | (((v >> 8) & 0x0F) * 0x00110000)
+         | (((v >> 4) & 0x0F) * 0x00001100) | ((v & 0x0F) * 0x00000011);
+}
+
+static inline uint16_t argb_to_argb4444(uint32_t argb) {
+    return (uint16_t)(((argb >> 16) & 0xF000) | ((argb >> 12) & 0x0F00) | ((argb >> 8) & 0x00F0) | ((argb >> 4) & 0x000F));
+}
+
+static uint8_t nearest_index(const uint32_t * p_clut, int clut_num, uint32_t argb, clut_cache_t * p_cache) {
+    uint32_t hash = ((argb * 0x9E3779B1u) >> 26) & (CLUT_CACHE_NUM - 1);
+    uint32_t best = 0xFFFFFFFF;
+    uint32_t dist;
+    int32_t diff;
+    int best_idx = 0;
+    int i;
+    int k;
+
+    if ((p_cache != NULL) && p_cache->valid[hash] && (p_cache->argb[hash] == argb)) {
+        return p_cache->index[hash];
+    }
+    for (i = 0; (i < clut_num) && (i < 256); i++) {
+        dist = 0;
+        for (k = 0; k < 32; k += 8) {
+            diff = (int32_t)((p_clut[i] >> k) & 0xFF) - (int32_t)((argb >> k) & 0xFF);
+            dist += (uint32_t)(diff * diff);
+        }
+        if (dist < best) {
+            best = dist;
+            best_idx = i;
+            if (dist == 0) {
+                break;
+            }
+        }
+    }
+    if (p_cache != NULL) {
+        p_cache->valid[hash] = true;
+        p_cache->argb[hash]  = argb;
+        p_cache->index[hash] = (uint8_t)best_idx;
+    }
+    return (uint8_t)best_idx;
+}
+
+static inline uint32_t get_index(const uint8_t * p_row, int bits, int x) {
+    if (bits == 8) {
+        return p_row[x];
+    } else if (bits == 4) {
+        return (p_row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F;
+    } else {
+        return (p_row[x >> 3] >> (7 - (x & 7))) & 0x01;
+    }
+}
+
+static inline void set_index(uint8_t * p_row, int bits, int x, uint32_t idx) {
+    int shift;
+    uint8_t mask;
+
+    if (bits == 8) {
+        p_row[x] = (uint8_t)idx;
+        return;
+    } else if (bits == 4) {
+        shift = (x & 1) ? 0 : 4;
+        mask = 0x0F;
+        x >>= 1;
+    } else {
+        shift = 7 - (x & 7);
+        mask = 0x01;
+        x >>= 3;
+    }
+    p_row[x] = (uint8_t)((p_row[x] & ~(mask << shift)) | ((idx & mask) << shift));
+}
+
+/* Porter-Duff with not premultiplied pixels */
+static inline uint32_t blend_pixel(uint32_t s, uint32_t d, Pixel2D::blend_mode_t mode, uint32_t global_alpha) {
+    uint32_t sa = div255(((s >> 24) & 0xFF) * global_alpha);
+    uint32_t da = (d >> 24) & 0xFF;
+    uint32_t fa;
+    uint32_t fb;
+    uint32_t wa;
+    uint32_t wb;
+    uint32_t ao;
+    uint32_t result;
+    int k;
+
+    switch (mode) {
+        case Pixel2D::BLEND_SRC:      fa = 255;      fb = 0;        break;
+        case Pixel2D::BLEND_DST:      fa = 0;        fb = 255;      break;
+        case Pixel2D::BLEND_SRC_OVER: fa = 255;      fb = 255 - sa; break;
+        case Pixel2D::BLEND_DST_OVER: fa = 255 - da; fb = 255;      break;
+        case Pixel2D::BLEND_SRC_IN:   fa = da;       fb = 0;        break;
+        case Pixel2D::BLEND_DST_IN:   fa = 0;        fb = sa;       break;
+        case Pixel2D::BLEND_SRC_OUT:  fa = 255 - da; fb = 0;        break;
+        case Pixel2D::BLEND_DST_OUT:  fa = 0;        fb = 255 - sa; break;
+        case Pixel2D::BLEND_SRC_ATOP: fa = da;       fb = 255 - sa; break;
+        case Pixel2D::BLEND_DST_ATOP: fa = 255 - da; fb = sa;       break;
+        case Pixel2D::BLEND_XOR:      fa = 255 - da; fb = 255 - sa; break;
+        default:                      fa = 0;        fb = 0;        break;
+    }
+
+    /* weights of the colours (scale 255 * 255) */
+    wa = sa * fa;
+    wb = da * fb;
+    ao = wa + wb;
+    if (ao == 0) {
+        return 0;
+    }
+    result = div255(ao) << 24;
+    for (k = 0; k < 24; k += 8) {
+        result |= ((((s >> k) & 0xFF) * wa + ((d >> k) & 0xFF) * wb + (ao >> 1)) / ao) << k;
+    }
+    return result;
+}
+
+/* Source over an opaque destination */
+static inline uint32_t blend_over_opaque(uint32_t s, uint32_t d, uint32_t sa) {
+    uint32_t ia = 255 - sa;
+
+    return 0xFF000000
+         | (div255((((s >> 16) & 0xFF) * sa) + (((d >> 16) & 0xFF) * ia)) << 16)
+         | (div255((((s >> 8) & 0xFF) * sa) + (((d >> 8) & 0xFF) * ia)) << 8)
+         | div255(((s & 0xFF) * sa) + ((d & 0xFF) * ia));
+}
+
+static void read_rgb565(const uint16_t * p_src, uint32_t * p_argb, int num) {
+    int i = 0;
+
+#if defined(PIXEL_2D_USE_NEON)
+    for (; (i + 8) <= num; i += 8) {
+        uint16x8_t v = vld1q_u16(&p_src[i]);
+        uint8x8_t hi = vshrn_n_u16(v, 8);
+        uint8x8_t mid = vshrn_n_u16(v, 3);
+        uint8x8_t lo = vshl_n_u8(vmovn_u16(v), 3);
+        uint8x8x4_t out;
+
+        out.val[0] = vorr_u8(lo, vshr_n_u8(lo, 5));
+        mid = vand_u8(mid, vdup_n_u8(0xFC));
+        out.val[1] = vorr_u8(mid, vshr_n_u8(mid, 6));
+        hi = vand_u8(hi, vdup_n_u8(0xF8));
+        out.val[2] = vorr_u8(hi, vshr_n_u8(hi, 5));
+        out.val[3] = vdup_n_u8(0xFF);
+        vst4_u8((uint8_t *)&p_argb[i], out);
+    }
+#endif
+    for (; i < num; i++) {
+        p_argb[i] = rgb565_to_argb(p_src[i]);
+    }
+}
+
+static void write_rgb565(uint16_t * p_dst, const uint32_t * p_argb, int num) {
+    int i = 0;
+
+#if defined(PIXEL_2D_USE_NEON)
+    for (; (i + 8) <= num; i += 8) {
+        uint8x8x4_t in = vld4_u8((const uint8_t *)&p_argb[i]);
+        uint16x8_t v = vshll_n_u8(in.val[2], 8);
+
+        v = vsriq_n_u16(v, vshll_n_u8(in.val[1], 8), 5);
+        v = vsriq_n_u16(v, vshll_n_u8(in.val[0], 8), 11);
+        vst1q_u16(&p_dst[i], v);
+    }
+#endif
+    for (; i < num; i++) {
+        p_dst[i] = argb_to_rgb565(p_argb[i]);
+    }
+}
+
+static void blend_src_over_scalar(uint32_t * p_dst, const uint32_t * p_src, int num, uint32_t global_alpha) {
+    uint32_t s;
+    uint32_t d;
+    uint32_t sa;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        s = p_src[i];
+        d = p_dst[i];
+        sa = div255((s >> 24) * global_alpha);
+        if (sa == 0) {
+            // do nothing
+        } else if (sa == 255) {
+            p_dst[i] = s;
+        } else if ((d >> 24) == 0xFF) {
+            p_dst[i] = blend_over_opaque(s, d, sa);
+        } else {
+            p_dst[i] = blend_pixel(s, d, Pixel2D::BLEND_SRC_OVER, global_alpha);
+        }
+    }
+}
+
+static void blend_src_over(uint32_t * p_dst, const uint32_t * p_src, int num, uint32_t global_alpha) {
+    int i = 0;
+
+#if defined(PIXEL_2D_USE_NEON)
+    uint8x8_t ga = vdup_n_u8((uint8_t)global_alpha);
+
+    for (; (i + 8) <= num; i += 8) {
+        uint8x8x4_t sv = vld4_u8((const uint8_t *)&p_src[i]);
+        uint8x8x4_t dv = vld4_u8((const uint8_t *)&p_dst[i]);
+        uint8x8_t opaque = vand_u8(dv.val[3], vrev16_u8(dv.val[3]));
+        uint16x8_t t;
+        uint8x8_t a;
+        uint8x8_t ia;
+        int k;
+
+        opaque = vand_u8(opaque, vrev32_u8(opaque));
+        opaque = vand_u8(opaque, vrev64_u8(opaque));
+        if (vget_lane_u8(opaque, 0) != 0xFF) {
+            // The destination has transparent pixels
+            blend_src_over_scalar(&p_dst[i], &p_src[i], 8, global_alpha);
+            continue;
+        }
+        t = vmull_u8(sv.val[3], ga);
+        a = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        ia = vmvn_u8(a);
+        for (k = 0; k < 3; k++) {
+            t = vmull_u8(sv.val[k], a);
+            t = vmlal_u8(t, dv.val[k], ia);
+            dv.val[k] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        }
+        vst4_u8((uint8_t *)&p_dst[i], dv);
+    }
+#endif
+    blend_src_over_scalar(&p_dst[i], &p_src[i], num - i, global_alpha);
+}
+
+static inline void store_rgb(uint8_t * p_dst, Pixel2D::format_t format, int i, uint32_t argb) {
+    if (format == Pixel2D::FORMAT_RGB565) {
+        ((uint16_t *)p_dst)[i] = argb_to_rgb565(argb);
+    } else if (format == Pixel2D::FORMAT_ARGB8888) {
+        ((uint32_t *)p_dst)[i] = argb;
+    } else {
+        ((uint32_t *)p_dst)[i] = argb & 0x00FFFFFF;
+    }
+}
+
+#if defined(PIXEL_2D_USE_NEON)
+/* 8 pairs of YCbCr422 to 16 pixels */
+static inline void ycbcr_16px(const uint8_t * p_src, uint8_t * p_dst, Pixel2D::format_t format,
+                              const ycbcr_coef_t * p_coef) {
+    uint8x8x4_t in = vld4_u8(p_src);
+    uint8x8_t y_offset = vdup_n_u8((uint8_t)p_coef->y_offset);
+    int16x8_t ys[2];
+    int16x8_t cb = vreinterpretq_s16_u16(vsubl_u8(in.val[1], vdup_n_u8(128)));
+    int16x8_t cr = vreinterpretq_s16_u16(vsubl_u8(in.val[3], vdup_n_u8(128)));
+    uint16x4_t r16[2][2];
+    uint16x4_t g16[2][2];
+    uint16x4_t b16[2][2];
+    uint8x8_t r8[2];
+    uint8x8_t g8[2];
+    uint8x8_t b8[2];
+    uint8x8x2_t r;
+    uint8x8x2_t g;
+    uint8x8x2_t b;
+    int h;
+    int e;
+
+    ys[0] = vreinterpretq_s16_u16(vsubl_u8(in.val[0], y_offset));
+    ys[1] = vreinterpretq_s16_u16(vsubl_u8(in.val[2], y_offset));
+    for (h = 0; h < 2; h++) {
+        int16x4_t cb_h = (h == 0) ? vget_low_s16(cb) : vget_high_s16(cb);
+        int16x4_t cr_h = (h == 0) ? vget_low_s16(cr) : vget_high_s16(cr);
+        int32x4_t rc = vmull_n_s16(cr_h, p_coef->cr_r);
+        int32x4_t gc = vmlal_n_s16(vmull_n_s16(cb_h, -p_coef->cb_g), cr_h, -p_coef->cr_g);
+        int32x4_t bc = vmull_n_s16(cb_h, p_coef->cb_b);
+
+        // The chroma of a pair is used by the even and the odd pixel
+        for (e = 0; e < 2; e++) {
+            int32x4_t yv = vmull_n_s16((h == 0) ? vget_low_s16(ys[e]) : vget_high_s16(ys[e]), p_coef->y_gain);
+            r16[e][h] = vqrshrun_n_s32(vaddq_s32(yv, rc), YCBCR_COEF_BITS);
+            g16[e][h] = vqrshrun_n_s32(vaddq_s32(yv, gc), YCBCR_COEF_BITS);
+            b16[e][h] = vqrshrun_n_s32(vaddq_s32(yv, bc), YCBCR_COEF_BITS);
+        }
+    }
+    for (e = 0; e < 2; e++) {
+        r8[e] = vqmovn_u16(vcombine_u16(r16[e][0], r16[e][1]));
+        g8[e] = vqmovn_u16(vcombine_u16(g16[e][0], g16[e][1]));
+        b8[e] = vqmovn_u16(vcombine_u16(b16[e][0], b16[e][1]));
+    }
+    r = vzip_u8(r8[0], r8[1]);
+    g = vzip_u8(g8[0], g8[1]);
+    b = vzip_u8(b8[0], b8[1]);
+
+    for (h = 0; h < 2; h++) {
+        if (format == Pixel2D::FORMAT_RGB565) {
+            uint16x8_t v = vshll_n_u8(r.val[h], 8);
+
+            v = vsriq_n_u16(v, vshll_n_u8(g.val[h], 8), 5);
+            v = vsriq_n_u16(v, vshll_n_u8(b.val[h], 8), 11);
+            vst1q_u16((uint16_t *)p_dst + (h * 8), v);
+        } else {
+            uint8x8x4_t out;
+
+            out.val[0] = b.val[h];
+            out.val[1] = g.val[h];
+            out.val[2] = r.val[h];
+            out.val[3] = vdup_n_u8((format == Pixel2D::FORMAT_ARGB8888) ? 0xFF : 0x00);
+            vst4_u8(p_dst + (h * 32), out);
+        }
+    }
+}
+#endif
+
+/* A row of YCbCr422 from the pixel x to RGB565, ARGB8888 or RGB888 */
+static void ycbcr_row(const uint8_t * p_src_row, int x, int num, uint8_t * p_dst, Pixel2D::format_t format,
+                      const ycbcr_coef_t * p_coef) {
+    const uint8_t * p_pair;
+    int32_t yv0;
+    int32_t yv1;
+    int32_t rc;
+    int32_t gc;
+    int32_t bc;
+    int i = 0;
+
+    if ((x & 1) != 0) {
+        p_pair = &p_src_row[(x - 1) * 2];
+        store_rgb(p_dst, format, 0, ycbcr_to_argb(p_pair[2], p_pair[1], p_pair[3], p_coef));
+        i = 1;
+    }
+#if defined(PIXEL_2D_USE_NEON)
+    for (; (i + 16) <= num; i += 16) {
+        ycbcr_16px(&p_src_row[(x + i) * 2], p_dst + (i * ((format == Pixel2D::FORMAT_RGB565) ? 2 : 4)), format, p_coef);
+    }
+#endif
+    for (; (i + 1) < num; i += 2) {
+        p_pair = &p_src_row[(x + i) * 2];
+        rc = p_coef->cr_r * (p_pair[3] - 128);
+        gc = -(p_coef->cb_g * (p_pair[1] - 128)) - (p_coef->cr_g * (p_pair[3] - 128));
+        bc = p_coef->cb_b * (p_pair[1] - 128);
+        yv0 = (p_pair[0] - p_coef->y_offset) * p_coef->y_gain;
+        yv1 = (p_pair[2] - p_coef->y_offset) * p_coef->y_gain;
+        store_rgb(p_dst, format, i, 0xFF000000 | (ycbcr_clip(yv0 + rc) << 16) | (ycbcr_clip(yv0 + gc) << 8) | ycbcr_clip(yv0 + bc));
+        store_rgb(p_dst, format, i + 1, 0xFF000000 | (ycbcr_clip(yv1 + rc) << 16) | (ycbcr_clip(yv1 + gc) << 8) | ycbcr_clip(yv1 + bc));
+    }
+    if (i < num) {
+        p_pair = &p_src_row[(x + i) * 2];
+        store_rgb(p_dst, format, i, ycbcr_to_argb(p_pair[0], p_pair[1], p_pair[3], p_coef));
+    }
+}
+
+/* Y of a row of YCbCr422 from the pixel x */
+static void y_row(const uint8_t * p_src_row, int x, int num, uint8_t * p_dst, const ycbcr_coef_t * p_coef) {
+    int i = 0;
+
+    if (p_coef->y_offset == 0) {
+        // full range : as it is
+#if defined(PIXEL_2D_USE_NEON)
+        for (; (i + 16) <= num; i += 16) {
+            vst1q_u8(&p_dst[i], vld2q_u8(&p_src_row[(x + i) * 2]).val[0]);
+        }
+#endif
+        for (; i < num; i++) {
+            p_dst[i] = p_src_row[(x + i) * 2];
+        }
+        return;
+    }
+#if defined(PIXEL_2D_USE_NEON)
+    for (; (i + 16) <= num; i += 16) {
+        uint8x16_t y = vld2q_u8(&p_src_row[(x + i) * 2]).val[0];
+        uint8x8_t y_offset = vdup_n_u8((uint8_t)p_coef->y_offset);
+        int16x8_t lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), y_offset));
+        int16x8_t hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), y_offset));
+        uint16x8_t lo16 = vcombine_u16(vqrshrun_n_s32(vmull_n_s16(vget_low_s16(lo), p_coef->y_gain), YCBCR_COEF_BITS),
+                                       vqrshrun_n_s32(vmull_n_s16(vget_high_s16(lo), p_coef->y_gain), YCBCR_COEF_BITS));
+        uint16x8_t hi16 = vcombine_u16(vqrshrun_n_s32(vmull_n_s16(vget_low_s16(hi), p_coef->y_gain), YCBCR_COEF_BITS),
+                                       vqrshrun_n_s32(vmull_n_s16(vget_high_s16(hi), p_coef->y_gain), YCBCR_COEF_BITS));
+
+        vst1q_u8(&p_dst[i], vcombine_u8(vqmovn_u16(lo16), vqmovn_u16(hi16)));
+    }
+#endif
+    for (; i < num; i++) {
+        p_dst[i] = (uint8_t)ycbcr_clip((p_src_row[(x + i) * 2] - p_coef->y_offset) * p_coef->y_gain);
+    }
+}
+
+template <typename T>
+static void fill_rows(uint8_t * p_buf, int stride, int width, int height, T value) {
+    int i;
+    int j;
+
+    for (i = 0; i < height; i++) {
+        T * p_row = (T *)&p_buf[stride * i];
+        for (j = 0; j < width; j++) {
+            p_row[j] = value;
+        }
+    }
+}
+
+template <>
+void fill_rows<uint8_t>(uint8_t * p_buf, int stride, int width, int height, uint8_t value) {
+    int i;
+
+    for (i = 0; i < height; i++) {
+        memset(&p_buf[stride * i], value, width);
+    }
+}
+
+// Pixels of the next chunk of a row. A chunk of YCbCr422 ends at an even x of the destination,
+// so that WriteLine() averages the chroma of a pair as the whole row in one call does.
+static inline int chunk_num(Pixel2D::format_t dst_format, int dst_x, int remain) {
+    if (remain <= PIXEL_2D_CHUNK_NUM) {
+        return remain;
+    }
+    if ((dst_format == Pixel2D::FORMAT_YCBCR422) && (((dst_x + PIXEL_2D_CHUNK_NUM) & 1) != 0)) {
+        return PIXEL_2D_CHUNK_NUM - 1;
+    }
+    return PIXEL_2D_CHUNK_NUM;
+}
+
+int Pixel2D::GetBitsPerPixel(format_t format) {
+    switch (format) {
+        case FORMAT_YCBCR422:
+        case FORMAT_RGB565:
+        case FORMAT_ARGB4444:
+            return 16;
+        case FORMAT_RGB888:
+        case FORMAT_ARGB8888:
+            return 32;
+        case FORMAT_CLUT8:
+            return 8;
+        case FORMAT_CLUT4:
+            return 4;
+        case FORMAT_CLUT1:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+bool Pixel2D::check_surface(const surface_t * p_surface) {
+    if ((p_surface == NULL) || (p_surface->p_buf == NULL) || (p_surface->width <= 0) || (p_surface->height <= 0)) {
+        return false;
+    }
+    if (GetBitsPerPixel(p_surface->format) == 0) {
+        return false;
+    }
+    if ((p_surface->format >= FORMAT_CLUT8) && ((p_surface->p_clut == NULL) || (p_surface->clut_num <= 0))) {
+        return false;
+    }
+    return true;
+}
+
+bool Pixel2D::clip(const surface_t * p_dst, int * p_x, int * p_y, const surface_t * p_src, const rect_t * p_src_rect,
+                   rect_t * p_rect) {
+    int diff;
+
+    if (p_src_rect == NULL) {
+        p_rect->x = 0;
+        p_rect->y = 0;
+        p_rect->width = p_src->width;
+        p_rect->height = p_src->height;
+    } else {
+        *p_rect = *p_src_rect;
+    }
+
+    /* source */
+    if (p_rect->x < 0) {
+        *p_x -= p_rect->x;
+        p_rect->width += p_rect->x;
+        p_rect->x = 0;
+    }
+    if (p_rect->y < 0) {
+        *p_y -= p_rect->y;
+        p_rect->height += p_rect->y;
+        p_rect->y = 0;
+    }
+    if ((p_rect->x + p_rect->width) > p_src->width) {
+        p_rect->width = p_src->width - p_rect->x;
+    }
+    if ((p_rect->y + p_rect->height) > p_src->height) {
+        p_rect->height = p_src->height - p_rect->y;
+    }
+
+    /* destination */
+    if (*p_x < 0) {
+        diff = -*p_x;
+        p_rect->x += diff;
+        p_rect->width -= diff;
+        *p_x = 0;
+    }
+    if (*p_y < 0) {
+        diff = -*p_y;
+        p_rect->y += diff;
+        p_rect->height -= diff;
+        *p_y = 0;
+    }
+    if ((*p_x + p_rect->width) > p_dst->width) {
+        p_rect->width = p_dst->width - *p_x;
+    }
+    if ((*p_y + p_rect->height) > p_dst->height) {
+        p_rect->height = p_dst->height - *p_y;
+    }
+
+    return (p_rect->width > 0) && (p_rect->height > 0);
+}
+
+void Pixel2D::ReadLine(const surface_t * p_src, int x, int y, int num, uint32_t * p_argb) {
+    const uint8_t * p_row = &p_src->p_buf[p_src->stride * y];
+    const uint16_t * p_row16 = (const uint16_t *)p_row;
+    const uint32_t * p_row32 = (const uint32_t *)p_row;
+    const uint8_t * p_pair;
+    uint32_t idx;
+    int bits;
+    int i;
+
+    switch (p_src->format) {
+        case FORMAT_YCBCR422:
+            for (i = 0; i < num; i++) {
+                p_pair = &p_row[((x + i) & ~1) * 2];
+                p_argb[i] = ycbcr_to_argb(p_pair[((x + i) & 1) * 2], p_pair[1], p_pair[3], &ycbcr_coef[0][0]);
+            }
+            break;
+        case FORMAT_RGB565:
+            read_rgb565(&p_row16[x], p_argb, num);
+            break;
+        case FORMAT_RGB888:
+            for (i = 0; i < num; i++) {
+                p_argb[i] = 0xFF000000 | p_row32[x + i];
+            }
+            break;
+        case FORMAT_ARGB8888:
+            memcpy(p_argb, &p_row32[x], num * sizeof(uint32_t));
+            break;
+        case FORMAT_ARGB4444:
+            for (i = 0; i < num; i++) {
+                p_argb[i] = argb4444_to_argb(p_row16[x + i]);
+            }
+            break;
+        default:
+            bits = GetBitsPerPixel(p_src->format);
+            for (i = 0; i < num; i++) {
+                idx = get_index(p_row, bits, x + i);
+                p_argb[i] = ((int)idx < p_src->clut_num) ? p_src->p_clut[idx] : 0;
+            }
+            break;
+    }
+}
+
+void Pixel2D::WriteLine(const surface_t * p_dst, int x, int y, int num, const uint32_t * p_argb) {
+    uint8_t * p_row = &p_dst->p_buf[p_dst->stride * y];
+    uint16_t * p_row16 = (uint16_t *)p_row;
+    uint32_t * p_row32 = (uint32_t *)p_row;
+    uint8_t * p_pixel;
+    clut_cache_t cache;
+    uint32_t c0;
+    uint32_t c1;
+    int32_t r;
+    int32_t g;
+    int32_t b;
+    int bits;
+    int i;
+
+    switch (p_dst->format) {
+        case FORMAT_YCBCR422:
+            i = 0;
+            while (i < num) {
+                p_pixel = &p_row[(x + i) * 2];
+                c0 = p_argb[i];
+                if ((((x + i) & 1) == 0) && ((i + 1) < num)) {
+                    // The chroma of a pair is the average of 2 pixels
+                    c1 = p_argb[i + 1];
+                    r = (((c0 >> 16) & 0xFF) + ((c1 >> 16) & 0xFF) + 1) >> 1;
+                    g = (((c0 >> 8) & 0xFF) + ((c1 >> 8) & 0xFF) + 1) >> 1;
+                    b = ((c0 & 0xFF) + (c1 & 0xFF) + 1) >> 1;
+                    p_pixel[0] = argb_to_y(c0);
+                    p_pixel[1] = argb_to_cb(r, g, b);
+                    p_pixel[2] = argb_to_y(c1);
+                    p_pixel[3] = argb_to_cr(r, g, b);
+                    i += 2;
+                } else {
+                    // A pixel at the edge of the rectangle writes its own chroma (Cb: even, Cr: odd)
+                    r = (c0 >> 16) & 0xFF;
+                    g = (c0 >> 8) & 0xFF;
+                    b = c0 & 0xFF;
+                    p_pixel[0] = argb_to_y(c0);
+                    p_pixel[1] = ((x + i) & 1) ? argb_to_cr(r, g, b) : argb_to_cb(r, g, b);
+                    i++;
+                }
+            }
+            break;
+        case FORMAT_RGB565:
+            write_rgb565(&p_row16[x], p_argb, num);
+            break;
+        case FORMAT_RGB888:
+            for (i = 0; i < num; i++) {
+                p_row32[x + i] = p_argb[i] & 0x00FFFFFF;
+            }
+            break;
+        case FORMAT_ARGB8888:
+            memcpy(&p_row32[x], p_argb, num * sizeof(uint32_t));
+            break;
+        case FORMAT_ARGB4444:
+            for (i = 0; i < num; i++) {
+                p_row16[x + i] = argb_to_argb4444(p_argb[i]);
+            }
+            break;
+        default:
+            bits = GetBitsPerPixel(p_dst->format);
+            memset(cache.valid, 0, sizeof(cache.valid));
+            for (i = 0; i < num; i++) {
+                set_index(p_row, bits, x + i, nearest_index(p_dst->p_clut, p_dst->clut_num, p_argb[i], &cache));
+            }
+            break;
+    }
+}
+
+void Pixel2D::BlendLine(uint32_t * p_dst, const uint32_t * p_src, int num, blend_mode_t mode, uint8_t global_alpha) {
+    int i;
+
+    switch (mode) {
+        case BLEND_CLEAR:
+            memset(p_dst, 0, num * sizeof(uint32_t));
+            break;
+        case BLEND_DST:
+            break;
+        case BLEND_SRC_OVER:
+            blend_src_over(p_dst, p_src, num, global_alpha);
+            break;
+        case BLEND_SRC:
+            if (global_alpha == 255) {
+                memcpy(p_dst, p_src, num * sizeof(uint32_t));
+                break;
+            }
+            /* fall through */
+        default:
+            for (i = 0; i < num; i++) {
+                p_dst[i] = blend_pixel(p_src[i], p_dst[i], mode, global_alpha);
+            }
+            break;
+    }
+}
+
+bool Pixel2D::Fill(const surface_t * p_dst, const rect_t * p_rect, uint32_t colour, blend_mode_t mode) {
+    uint32_t src_line[PIXEL_2D_CHUNK_NUM];
+    uint32_t dst_line[PIXEL_2D_CHUNK_NUM];
+    uint8_t * p_buf;
+    rect_t rect;
+    int x1;
+    int y1;
+    int i;
+    int j;
+    int num;
+
+    if (!check_surface(p_dst)) {
+        return false;
+    }
+    if (p_rect == NULL) {
+        rect.x = 0;
+        rect.y = 0;
+        rect.width = p_dst->width;
+        rect.height = p_dst->height;
+    } else {
+        // The rectangle is clipped to the surface: {-10, 0, 105, 1} fills x = 0 - 94
+        rect.x = (p_rect->x > 0) ? p_rect->x : 0;
+        rect.y = (p_rect->y > 0) ? p_rect->y : 0;
+        x1 = ((p_rect->x + p_rect->width) < p_dst->width) ? (p_rect->x + p_rect->width) : p_dst->width;
+        y1 = ((p_rect->y + p_rect->height) < p_dst->height) ? (p_rect->y + p_rect->height) : p_dst->height;
+        rect.width = x1 - rect.x;
+        rect.height = y1 - rect.y;
+        if ((rect.width <= 0) || (rect.height <= 0)) {
+            return true;
+        }
+    }
+    if (mode == BLEND_DST) {
+        return true;
+    }
+    if ((mode == BLEND_SRC_OVER) && ((colour >> 24) == 0xFF)) {
+        mode = BLEND_SRC;
+    }
+
+    if (mode == BLEND_SRC) {
+        p_buf = &p_dst->p_buf[p_dst->stride * rect.y];
+        switch (p_dst->format) {
+            case FORMAT_RGB565:
+                fill_rows<uint16_t>(p_buf + (rect.x * 2), p_dst->stride, rect.width, rect.height, argb_to_rgb565(colour));
+                return true;
+            case FORMAT_ARGB4444:
+                fill_rows<uint16_t>(p_buf + (rect.x * 2), p_dst->stride, rect.width, rect.height, argb_to_argb4444(colour));
+                return true;
+            case FORMAT_RGB888:
+                fill_rows<uint32_t>(p_buf + (rect.x * 4), p_dst->stride, rect.width, rect.height, colour & 0x00FFFFFF);
+                return true;
+            case FORMAT_ARGB8888:
+                fill_rows<uint32_t>(p_buf + (rect.x * 4), p_dst->stride, rect.width, rect.height, colour);
+                return true;
+            case FORMAT_CLUT8:
+                fill_rows<uint8_t>(p_buf + rect.x, p_dst->stride, rect.width, rect.height,
+                                   nearest_index(p_dst->p_clut, p_dst->clut_num, colour, NULL));
+                return true;
+            default:
+                break;
+        }
+    }
+
+    // The other formats and operators are processed in ARGB8888
+    for (i = 0; i < PIXEL_2D_CHUNK_NUM; i++) {
+        src_line[i] = colour;
+    }
+    for (i = 0; i < rect.height; i++) {
+        for (j = 0; j < rect.width; j += num) {
+            num = chunk_num(p_dst->format, rect.x + j, rect.width - j);
+            if (mode == BLEND_SRC) {
+                WriteLine(p_dst, rect.x + j, rect.y + i, num, src_line);
+            } else {
+                ReadLine(p_dst, rect.x + j, rect.y + i, num, dst_line);
+                BlendLine(dst_line, src_line, num, mode);
+                WriteLine(p_dst, rect.x + j, rect.y + i, num, dst_line);
+            }
+        }
+    }
+    return true;
+}
+
+void Pixel2D::copy_rows(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect) {
+    int bits = GetBitsPerPixel(p_src->format);
+    bool same_buf = (p_dst->p_buf == p_src->p_buf);
+    uint8_t * p_dst_row;
+    const uint8_t * p_src_row;
+    uint32_t idx;
+    int i;
+    int j;
+    int row;
+
+    for (i = 0; i < p_rect->height; i++) {
+        // Bottom-up when the destination is below the source in the same buffer
+        row = (same_buf && (y > p_rect->y)) ? (p_rect->height - 1 - i) : i;
+        p_dst_row = &p_dst->p_buf[p_dst->stride * (y + row)];
+        p_src_row = &p_src->p_buf[p_src->stride * (p_rect->y + row)];
+        if ((((x | p_rect->x | p_rect->width) * bits) & 7) == 0) {
+            memmove(&p_dst_row[(x * bits) >> 3], &p_src_row[(p_rect->x * bits) >> 3], (p_rect->width * bits) >> 3);
+        } else if (same_buf && (x > p_rect->x)) {
+            for (j = p_rect->width - 1; j >= 0; j--) {
+                idx = get_index(p_src_row, bits, p_rect->x + j);
+                set_index(p_dst_row, bits, x + j, idx);
+            }
+        } else {
+            for (j = 0; j < p_rect->width; j++) {
+                idx = get_index(p_src_row, bits, p_rect->x + j);
+                set_index(p_dst_row, bits, x + j, idx);
+            }
+        }
+    }
+}
+
+/* Copy with the conversion between the surfaces which may overlap */
+bool Pixel2D::copy_overlap(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect) {
+    uint32_t * p_line;
+    bool bottom_up;
+    int i;
+    int row;
+
+    // A whole row is read before it is written: the chunks and the chroma pairs of YCbCr422 overlap
+    p_line = (uint32_t *)malloc(p_rect->width * sizeof(uint32_t));
+    if (p_line == NULL) {
+        return false;
+    }
+    // Bottom-up when the destination is below the source
+    bottom_up = (&p_dst->p_buf[p_dst->stride * y] > &p_src->p_buf[p_src->stride * p_rect->y]);
+    for (i = 0; i < p_rect->height; i++) {
+        row = bottom_up ? (p_rect->height - 1 - i) : i;
+        ReadLine(p_src, p_rect->x, p_rect->y + row, p_rect->width, p_line);
+        WriteLine(p_dst, x, y + row, p_rect->width, p_line);
+    }
+    free(p_line);
+
+    return true;
+}
+
+/* Blend between the surfaces which may overlap */
+bool Pixel2D::blend_overlap(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect,
+                            blend_mode_t mode, uint8_t global_alpha) {
+    uint32_t dst_line[PIXEL_2D_CHUNK_NUM];
+    uint32_t * p_line;
+    bool bottom_up;
+    int i;
+    int j;
+    int num;
+    int row;
+
+    // The source row is read before the destination row is written, as copy_overlap()
+    p_line = (uint32_t *)malloc(p_rect->width * sizeof(uint32_t));
+    if (p_line == NULL) {
+        return false;
+    }
+    bottom_up = (&p_dst->p_buf[p_dst->stride * y] > &p_src->p_buf[p_src->stride * p_rect->y]);
+    for (i = 0; i < p_rect->height; i++) {
+        row = bottom_up ? (p_rect->height - 1 - i) : i;
+        ReadLine(p_src, p_rect->x, p_rect->y + row, p_rect->width, p_line);
+        for (j = 0; j < p_rect->width; j += num) {
+            num = chunk_num(p_dst->format, x + j, p_rect->width - j);
+            ReadLine(p_dst, x + j, y + row, num, dst_line);
+            BlendLine(dst_line, &p_line[j], num, mode, global_alpha);
+            WriteLine(p_dst, x + j, y + row, num, dst_line);
+        }
+    }
+    free(p_line);
+
+    return true;
+}
+
+bool Pixel2D::Copy(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect) {
+    uint32_t line[PIXEL_2D_CHUNK_NUM];
+    rect_t rect;
+    int i;
+    int j;
+    int num;
+
+    if ((!check_surface(p_dst)) || (!check_surface(p_src))) {
+        return false;
+    }
+    if (!clip(p_dst, &x, &y, p_src, p_src_rect, &rect)) {
+        return true;
+    }
+
+    if ((p_dst->format == p_src->format)
+     && ((p_dst->format < FORMAT_CLUT8) || ((p_dst->p_clut == p_src->p_clut) && (p_dst->clut_num == p_src->clut_num)))
+     && ((p_dst->format != FORMAT_YCBCR422) || (((x ^ rect.x) & 1) == 0))) {
+        copy_rows(p_dst, x, y, p_src, &rect);
+        return true;
+    }
+    if ((p_src->format == FORMAT_YCBCR422)
+     && ((p_dst->format == FORMAT_RGB565) || (p_dst->format == FORMAT_ARGB8888) || (p_dst->format == FORMAT_RGB888))) {
+        return ConvertYCbCr422(p_dst, x, y, p_src, &rect);
+    }
+    if ((&p_dst->p_buf[p_dst->stride * p_dst->height] > p_src->p_buf)
+     && (&p_src->p_buf[p_src->stride * p_src->height] > p_dst->p_buf)) {
+        return copy_overlap(p_dst, x, y, p_src, &rect);
+    }
+
+    for (i = 0; i < rect.height; i++) {
+        for (j = 0; j < rect.width; j += num) {
+            num = chunk_num(p_dst->format, x + j, rect.width - j);
+            ReadLine(p_src, rect.x + j, rect.y + i, num, line);
+            WriteLine(p_dst, x + j, y + i, num, line);
+        }
+    }
+    return true;
+}
+
+bool Pixel2D::Blend(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect,
+                    blend_mode_t mode, uint8_t global_alpha) {
+    uint32_t src_line[PIXEL_2D_CHUNK_NUM];
+    uint32_t dst_line[PIXEL_2D_CHUNK_NUM];
+    rect_t rect;
+    int i;
+    int j;
+    int num;
+
+    if ((!check_surface(p_dst)) || (!check_surface(p_src)) || ((int)mode > (int)BLEND_XOR)) {
+        return false;
+    }
+    if ((mode == BLEND_SRC) && (global_alpha == 255)) {
+        return Copy(p_dst, x, y, p_src, p_src_rect);
+    }
+    if (!clip(p_dst, &x, &y, p_src, p_src_rect, &rect)) {
+        return true;
+    }
+    if (mode == BLEND_DST) {
+        return true;
+    }
+    if ((&p_dst->p_buf[p_dst->stride * p_dst->height] > p_src->p_buf)
+     && (&p_src->p_buf[p_src->stride * p_src->height] > p_dst->p_buf)) {
+        return blend_overlap(p_dst, x, y, p_src, &rect, mode, global_alpha);
+    }
+
+    for (i = 0; i < rect.height; i++) {
+        for (j = 0; j < rect.width; j += num) {
+            num = chunk_num(p_dst->format, x + j, rect.width - j);
+            ReadLine(p_src, rect.x + j, rect.y + i, num, src_line);
+            ReadLine(p_dst, x + j, y + i, num, dst_line);
+            BlendLine(dst_line, src_line, num, mode, global_alpha);
+            WriteLine(p_dst, x + j, y + i, num, dst_line);
+        }
+    }
+    return true;
+}
+
+bool Pixel2D::ConvertYCbCr422(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect,
+                              ycbcr_matrix_t matrix, ycbcr_range_t range, int strip, int strip_num) {
+    const ycbcr_coef_t * p_coef;
+    rect_t rect;
+    int start;
+    int end;
+    int i;
+
+    if ((!check_surface(p_dst)) || (!check_surface(p_src)) || (p_src->format != FORMAT_YCBCR422)
+     || ((p_dst->format != FORMAT_RGB565) && (p_dst->format != FORMAT_ARGB8888) && (p_dst->format != FORMAT_RGB888))
+     || ((int)matrix > (int)YCBCR_BT709) || ((int)range > (int)YCBCR_RANGE_FULL)
+     || (strip_num <= 0) || (strip < 0) || (strip >= strip_num)) {
+        return false;
+    }
+    if (!clip(p_dst, &x, &y, p_src, p_src_rect, &rect)) {
+        return true;
+    }
+    p_coef = &ycbcr_coef[matrix][range];
+    start = (rect.height * strip) / strip_num;
+    end   = (rect.height * (strip + 1)) / strip_num;
+    for (i = start; i < end; i++) {
+        ycbcr_row(&p_src->p_buf[p_src->stride * (rect.y + i)], rect.x, rect.width,
+                  &p_dst->p_buf[(p_dst->stride * (y + i)) + ((x * GetBitsPerPixel(p_dst->format)) >> 3)],
+                  p_dst->format, p_coef);
+    }
+    return true;
+}
+
+bool Pixel2D::ExtractY(uint8_t * p_dst, int dst_stride, const surface_t * p_src, const rect_t * p_src_rect,
+                       ycbcr_range_t range, int strip, int strip_num) {
+    rect_t rect;
+    int x = 0;
+    int y = 0;
+    int start;
+    int end;
+    int i;
+
+    if ((p_dst == NULL) || (!check_surface(p_src)) || (p_src->format != FORMAT_YCBCR422)
+     || ((int)range > (int)YCBCR_RANGE_FULL) || (strip_num <= 0) || (strip < 0) || (strip >= strip_num)) {
+        return false;
+    }
+    if (!clip(p_src, &x, &y, p_src, p_src_rect, &rect)) {
+        return true;
+    }
+    start = (rect.height * strip) / strip_num;
+    end   = (rect.height * (strip + 1)) / strip_num;
+    for (i = start; i < end; i++) {
+        y_row(&p_src->p_buf[p_src->stride * (rect.y + i)], rect.x, rect.width,
+              &p_dst[(dst_stride * (y + i)) + x], &ycbcr_coef[YCBCR_BT601][range]);
+    }
+    return true;
+}
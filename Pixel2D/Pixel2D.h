@@ -0,0 +1,271 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          Pixel2D.h
+* @brief         Fill, copy, format conversion and alpha blending of pixels
+*
+* Pixel formats (the values are the same as DisplayBase::graphics_format_t)
+*
+*   FORMAT_YCBCR422 : Y0 Cb0 Y1 Cr0 in bytes (camera with WR_RD_WRSWA_32_16BIT),
+*                     ITU-R BT.601 limited range except ConvertYCbCr422() and ExtractY()
+*   FORMAT_RGB565   : uint16_t RRRRRGGGGGGBBBBB (WR_RD_WRSWA_32_16BIT)
+*   FORMAT_RGB888   : uint32_t 0x00RRGGBB (WR_RD_WRSWA_32BIT)
+*   FORMAT_ARGB8888 : uint32_t 0xAARRGGBB (WR_RD_WRSWA_32BIT)
+*   FORMAT_ARGB4444 : uint16_t 0xARGB (WR_RD_WRSWA_32_16BIT)
+*   FORMAT_CLUT8    : index of 8 bits (WR_RD_WRSWA_32_16_8BIT)
+*   FORMAT_CLUT4    : index of 4 bits, the left pixel is in the upper bits
+*   FORMAT_CLUT1    : index of 1 bit, the left pixel is in the MSB
+*
+* The words are in CPU byte order (little-endian), so the buffers can be accessed as uint16_t / uint32_t arrays.
+* The buffer address and the stride must be aligned to the word size of the format.
+* The colour of the functions is ARGB8888 (not premultiplied). The CLUT is ARGB8888 as DisplayBase::clut_t.
+*
+* The rows are processed in ARGB8888 by the kernels of each format. When the compiler targets NEON
+* (__ARM_NEON), RGB565 / ARGB8888 conversions, YCbCr422 conversions and source-over blending use NEON,
+* otherwise the scalar code is used.
+* The library does not depend on mbed.
+******************************************************************************/
+
+#ifndef PIXEL_2D_H
+#define PIXEL_2D_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Number of pixels processed at a time (size of the line buffers on the stack) */
+#ifndef PIXEL_2D_CHUNK_NUM
+#define PIXEL_2D_CHUNK_NUM  (128)
+#endif
+
+/** A class of 2D pixel operations
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "Pixel2D.h"
+ *
+ * static uint8_t frame_buf[480 * 2 * 272] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint32_t icon[32 * 32];
+ *
+ * int main() {
+ *     Pixel2D::surface_t lcd  = {frame_buf, 480, 272, 480 * 2, Pixel2D::FORMAT_RGB565, NULL, 0};
+ *     Pixel2D::surface_t argb = {(uint8_t *)icon, 32, 32, 32 * 4, Pixel2D::FORMAT_ARGB8888, NULL, 0};
+ *     Pixel2D::rect_t rect = {0, 0, 480, 272};
+ *
+ *     Pixel2D::Fill(&lcd, &rect, 0xFF000080);
+ *     Pixel2D::Fill(&argb, NULL, 0x80FF0000);
+ *     Pixel2D::Blend(&lcd, 100, 100, &argb, NULL, Pixel2D::BLEND_SRC_OVER);
+ * }
+ * @endcode
+ */
+class Pixel2D {
+public:
+    /*! @enum format_t
+        @brief Pixel format
+     */
+    typedef enum {
+        FORMAT_YCBCR422 = 0,            /*!< YCbCr422 (2byte / px) */
+        FORMAT_RGB565,                  /*!< RGB565 (2byte / px) */
+        FORMAT_RGB888,                  /*!< RGB888 (4byte / px) */
+        FORMAT_ARGB8888,                /*!< ARGB8888 (4byte / px) */
+        FORMAT_ARGB4444,                /*!< ARGB4444 (2byte / px) */
+        FORMAT_CLUT8,                   /*!< CLUT8 (1byte / px) */
+        FORMAT_CLUT4,                   /*!< CLUT4 (0.5byte / px) */
+        FORMAT_CLUT1,                   /*!< CLUT1 (0.125byte / px) */
+    } format_t;
+
+    /*! @enum blend_mode_t
+        @brief Porter-Duff compositing operator (result = source op destination)
+     */
+    typedef enum {
+        BLEND_CLEAR = 0,                /*!< 0 */
+        BLEND_SRC,                      /*!< source */
+        BLEND_DST,                      /*!< destination */
+        BLEND_SRC_OVER,                 /*!< source over destination */
+        BLEND_DST_OVER,                 /*!< destination over source */
+        BLEND_SRC_IN,                   /*!< source in destination */
+        BLEND_DST_IN,                   /*!< destination in source */
+        BLEND_SRC_OUT,                  /*!< source out of destination */
+        BLEND_DST_OUT,                  /*!< destination out of source */
+        BLEND_SRC_ATOP,                 /*!< source atop destination */
+        BLEND_DST_ATOP,                 /*!< destination atop source */
+        BLEND_XOR,                      /*!< source xor destination */
+    } blend_mode_t;
+
+    /*! @enum ycbcr_matrix_t
+        @brief Conversion matrix of YCbCr
+     */
+    typedef enum {
+        YCBCR_BT601 = 0,                /*!< ITU-R BT.601 (SD) */
+        YCBCR_BT709,                    /*!< ITU-R BT.709 (HD) */
+    } ycbcr_matrix_t;
+
+    /*! @enum ycbcr_range_t
+        @brief Range of YCbCr
+     */
+    typedef enum {
+        YCBCR_RANGE_LIMITED = 0,        /*!< Y : 16 - 235, CbCr : 16 - 240 */
+        YCBCR_RANGE_FULL,               /*!< Y, CbCr : 0 - 255 */
+    } ycbcr_range_t;
+
+    /*! @struct surface_t
+        @brief Pixel buffer
+     */
+    typedef struct {
+        uint8_t *           p_buf;      /*!< Buffer address */
+        int                 width;      /*!< Width (pixel) */
+        int                 height;     /*!< Height (pixel) */
+        int                 stride;     /*!< Stride (byte) */
+        format_t            format;     /*!< Pixel format */
+        const uint32_t *    p_clut;     /*!< CLUT of FORMAT_CLUTn (ARGB8888) */
+        int                 clut_num;   /*!< Number of the CLUT entries */
+    } surface_t;
+
+    /*! @struct rect_t
+        @brief Rectangle
+     */
+    typedef struct {
+        int x;                          /*!< Left */
+        int y;                          /*!< Top */
+        int width;                      /*!< Width */
+        int height;                     /*!< Height */
+    } rect_t;
+
+    /** Fill a rectangle
+     *
+     * @param p_dst destination
+     * @param p_rect rectangle (NULL: whole surface), clipped to the surface
+     * @param colour colour (ARGB8888)
+     * @param mode compositing operator, the colour is the source
+     * @return true = success, false = invalid parameter
+     */
+    static bool Fill(const surface_t * p_dst, const rect_t * p_rect, uint32_t colour, blend_mode_t mode = BLEND_SRC);
+
+    /** Copy a rectangle with the format conversion
+     *
+     * The pixels are copied as they are when the formats (and the CLUTs) are the same.
+     * The rectangles may overlap when they are in the same surface. When the pixels are converted
+     * (YCbCr422 moved by an odd number of pixels, or different formats), the overlapping rows are
+     * read into a line buffer of the rectangle width allocated by malloc().
+     *
+     * @param p_dst destination
+     * @param x left of the destination
+     * @param y top of the destination
+     * @param p_src source
+     * @param p_src_rect source rectangle (NULL: whole surface), clipped to both surfaces
+     * @return true = success, false = invalid parameter or no memory for the line buffer
+     */
+    static bool Copy(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect);
+
+    /** Blend a rectangle
+     *
+     * The rectangles may overlap when they are in the same surface. Each source row is read
+     * into a line buffer of the rectangle width allocated by malloc() before the destination row is written.
+     *
+     * @param p_dst destination
+     * @param x left of the destination
+     * @param y top of the destination
+     * @param p_src source
+     * @param p_src_rect source rectangle (NULL: whole surface), clipped to both surfaces
+     * @param mode compositing operator
+     * @param global_alpha alpha multiplied to the source (0 - 255)
+     * @return true = success, false = invalid parameter or no memory for the line buffer
+     */
+    static bool Blend(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect,
+                      blend_mode_t mode, uint8_t global_alpha = 255);
+
+    /** Convert YCbCr422 to RGB565, ARGB8888 or RGB888
+     *
+     * The rows of the rectangle can be divided into strips, and the strips can be converted
+     * in parallel by the threads (the function has no shared state).
+     *
+     * @param p_dst destination (FORMAT_RGB565, FORMAT_ARGB8888 (alpha 255) or FORMAT_RGB888)
+     * @param x left of the destination
+     * @param y top of the destination
+     * @param p_src source (FORMAT_YCBCR422)
+     * @param p_src_rect source rectangle (NULL: whole surface), clipped to both surfaces
+     * @param matrix conversion matrix
+     * @param range range of the source
+     * @param strip index of the strip to convert (0 - strip_num - 1)
+     * @param strip_num number of the strips of the rectangle
+     * @return true = success, false = invalid parameter
+     */
+    static bool ConvertYCbCr422(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_src_rect,
+                                ycbcr_matrix_t matrix = YCBCR_BT601, ycbcr_range_t range = YCBCR_RANGE_LIMITED,
+                                int strip = 0, int strip_num = 1);
+
+    /** Extract the Y plane of YCbCr422
+     *
+     * @param p_dst destination (1byte / px, the top left of the rectangle)
+     * @param dst_stride stride of the destination
+     * @param p_src source (FORMAT_YCBCR422)
+     * @param p_src_rect source rectangle (NULL: whole surface), clipped to the source
+     * @param range range of the source, YCBCR_RANGE_LIMITED is expanded to 0 - 255
+     * @param strip index of the strip to convert (0 - strip_num - 1)
+     * @param strip_num number of the strips of the rectangle
+     * @return true = success, false = invalid parameter
+     */
+    static bool ExtractY(uint8_t * p_dst, int dst_stride, const surface_t * p_src, const rect_t * p_src_rect,
+                         ycbcr_range_t range = YCBCR_RANGE_FULL, int strip = 0, int strip_num = 1);
+
+    /** Read pixels of a row as ARGB8888
+     *
+     * @param p_src surface
+     * @param x left (the pixels must be in the surface)
+     * @param y row
+     * @param num number of pixels
+     * @param p_argb output
+     */
+    static void ReadLine(const surface_t * p_src, int x, int y, int num, uint32_t * p_argb);
+
+    /** Write ARGB8888 pixels to a row
+     *
+     * @param p_dst surface
+     * @param x left (the pixels must be in the surface)
+     * @param y row
+     * @param num number of pixels
+     * @param p_argb input
+     */
+    static void WriteLine(const surface_t * p_dst, int x, int y, int num, const uint32_t * p_argb);
+
+    /** Blend ARGB8888 pixels
+     *
+     * @param p_dst destination pixels, overwritten with the result
+     * @param p_src source pixels
+     * @param num number of pixels
+     * @param mode compositing operator
+     * @param global_alpha alpha multiplied to the source (0 - 255)
+     */
+    static void BlendLine(uint32_t * p_dst, const uint32_t * p_src, int num, blend_mode_t mode, uint8_t global_alpha = 255);
+
+    /** Get the number of bits of a pixel
+     *
+     * @param format pixel format
+     * @return bits per pixel
+     */
+    static int GetBitsPerPixel(format_t format);
+
+private:
+    static bool clip(const surface_t * p_dst, int * p_x, int * p_y, const surface_t * p_src, const rect_t * p_src_rect,
+                     rect_t * p_rect);
+    static bool check_surface(const surface_t * p_surface);
+    static void copy_rows(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect);
+    static bool copy_overlap(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect);
+    static bool blend_overlap(const surface_t * p_dst, int x, int y, const surface_t * p_src, const rect_t * p_rect,
+                              blend_mode_t mode, uint8_t global_alpha);
+};
+
+#endif
@@ -0,0 +1,208 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          pixel2d_bench.cpp
+* @brief         Megapixels/s of Pixel2D on a Linux host
+*
+* Each operation (Fill, Copy, Blend, ConvertYCbCr422) is run on a rectangle of the LCD size
+* for each pair of the destination and the source formats, and megapixels/s is printed as a matrix.
+* "-" is printed for the pairs which Pixel2D does not support.
+* Build for the target CPU (e.g. -mcpu=cortex-a9 -mfpu=neon) to measure the NEON kernels.
+*
+* Build (from Pixel2D/):
+*   g++ -O2 -I. -o pixel2d_bench tools/pixel2d_bench.cpp Pixel2D.cpp
+*
+* Usage:
+*   pixel2d_bench [-n loops] [-s width height]
+*     -n  number of loops of each operation (default 50)
+*     -s  rectangle size (default 480 272)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "Pixel2D.h"
+
+static int rect_w = 480;
+static int rect_h = 272;
+static int loops = 50;
+static uint32_t clut[256];
+
+typedef struct {
+    const char *        name;
+    Pixel2D::format_t   format;
+} format_desc_t;
+
+static const format_desc_t format_list[] = {
+    {"YCbCr422", Pixel2D::FORMAT_YCBCR422},
+    {"RGB565",   Pixel2D::FORMAT_RGB565},
+    {"RGB888",   Pixel2D::FORMAT_RGB888},
+    {"ARGB8888", Pixel2D::FORMAT_ARGB8888},
+    {"ARGB4444", Pixel2D::FORMAT_ARGB4444},
+    {"CLUT8",    Pixel2D::FORMAT_CLUT8},
+};
+
+#define FORMAT_NUM  ((int)(sizeof(format_list) / sizeof(format_list[0])))
+
+typedef enum {
+    OP_FILL,
+    OP_FILL_SRC_OVER,
+    OP_COPY,
+    OP_BLEND_SRC_OVER,
+    OP_BLEND_SRC_OVER_ALPHA,
+    OP_CONVERT_YCBCR422,
+} op_t;
+
+typedef struct {
+    const char *    name;
+    op_t            op;
+    bool            has_source;
+} op_desc_t;
+
+static const op_desc_t op_list[] = {
+    {"Fill (BLEND_SRC)",                    OP_FILL,                    false},
+    {"Fill (BLEND_SRC_OVER, alpha 128)",    OP_FILL_SRC_OVER,           false},
+    {"Copy",                                OP_COPY,                    true},
+    {"Blend (BLEND_SRC_OVER)",              OP_BLEND_SRC_OVER,          true},
+    {"Blend (BLEND_SRC_OVER, global 128)",  OP_BLEND_SRC_OVER_ALPHA,    true},
+    {"ConvertYCbCr422",                     OP_CONVERT_YCBCR422,        true},
+};
+
+static void make_surface(Pixel2D::format_t format, std::vector<uint8_t> & buf, Pixel2D::surface_t * p_surface) {
+    int stride = ((rect_w * Pixel2D::GetBitsPerPixel(format)) + 7) / 8;
+    size_t i;
+
+    stride = (stride + 3) & ~3;
+    buf.resize((size_t)stride * rect_h);
+    for (i = 0; i < buf.size(); i++) {
+        buf[i] = (uint8_t)((i * 37) ^ (i >> 7));
+    }
+    p_surface->p_buf = &buf[0];
+    p_surface->width = rect_w;
+    p_surface->height = rect_h;
+    p_surface->stride = stride;
+    p_surface->format = format;
+    p_surface->p_clut = clut;
+    p_surface->clut_num = 256;
+}
+
+/* Megapixels/s, negative = not supported */
+static double run(op_t op, const Pixel2D::surface_t * p_dst, const Pixel2D::surface_t * p_src) {
+    std::chrono::steady_clock::time_point start;
+    bool ok = true;
+    double sec;
+    int n;
+
+    start = std::chrono::steady_clock::now();
+    for (n = 0; (n < loops) && ok; n++) {
+        switch (op) {
+            case OP_FILL:
+                ok = Pixel2D::Fill(p_dst, NULL, 0xFF3060C0 + n);
+                break;
+            case OP_FILL_SRC_OVER:
+                ok = Pixel2D::Fill(p_dst, NULL, 0x803060C0 + n, Pixel2D::BLEND_SRC_OVER);
+                break;
+            case OP_COPY:
+                ok = Pixel2D::Copy(p_dst, 0, 0, p_src, NULL);
+                break;
+            case OP_BLEND_SRC_OVER:
+                ok = Pixel2D::Blend(p_dst, 0, 0, p_src, NULL, Pixel2D::BLEND_SRC_OVER);
+                break;
+            case OP_BLEND_SRC_OVER_ALPHA:
+                ok = Pixel2D::Blend(p_dst, 0, 0, p_src, NULL, Pixel2D::BLEND_SRC_OVER, 128);
+                break;
+            default:
+                ok = Pixel2D::ConvertYCbCr422(p_dst, 0, 0, p_src, NULL);
+                break;
+        }
+    }
+    if (!ok) {
+        return -1.0;
+    }
+    sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ((double)rect_w * rect_h * loops) / sec / 1000000.0;
+}
+
+static void print_value(double mpix) {
+    if (mpix < 0.0) {
+        printf(" %9s", "-");
+    } else {
+        printf(" %9.1f", mpix);
+    }
+}
+
+int main(int argc, char * argv[]) {
+    std::vector<uint8_t> buf[FORMAT_NUM];
+    std::vector<uint8_t> dst_buf;
+    Pixel2D::surface_t src[FORMAT_NUM];
+    Pixel2D::surface_t dst;
+    size_t o;
+    int d;
+    int s;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+            loops = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-s") == 0) && ((i + 2) < argc)) {
+            rect_w = atoi(argv[++i]);
+            rect_h = atoi(argv[++i]);
+        } else {
+            printf("usage: pixel2d_bench [-n loops] [-s width height]\n");
+            return 2;
+        }
+    }
+    if ((loops <= 0) || (rect_w <= 0) || (rect_h <= 0)) {
+        return 2;
+    }
+    for (i = 0; i < 256; i++) {
+        clut[i] = 0xFF000000 | ((uint32_t)(i * 7) << 16) | ((uint32_t)(i * 13) << 8) | (uint32_t)(i * 3);
+    }
+    for (s = 0; s < FORMAT_NUM; s++) {
+        make_surface(format_list[s].format, buf[s], &src[s]);
+    }
+
+    printf("%dx%d, %d loops, megapixels/s (row: destination, column: source)\n", rect_w, rect_h, loops);
+    for (o = 0; o < (sizeof(op_list) / sizeof(op_list[0])); o++) {
+        printf("\n%s\n", op_list[o].name);
+        if (op_list[o].has_source) {
+            printf("%-10s", "");
+            for (s = 0; s < FORMAT_NUM; s++) {
+                printf(" %9s", format_list[s].name);
+            }
+            printf("\n");
+        }
+        for (d = 0; d < FORMAT_NUM; d++) {
+            make_surface(format_list[d].format, dst_buf, &dst);
+            printf("%-10s", format_list[d].name);
+            if (!op_list[o].has_source) {
+                print_value(run(op_list[o].op, &dst, NULL));
+            } else {
+                for (s = 0; s < FORMAT_NUM; s++) {
+                    if ((op_list[o].op == OP_CONVERT_YCBCR422) && (format_list[s].format != Pixel2D::FORMAT_YCBCR422)) {
+                        print_value(-1.0);
+                        continue;
+                    }
+                    print_value(run(op_list[o].op, &dst, &src[s]));
+                }
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
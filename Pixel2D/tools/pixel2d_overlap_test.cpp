@@ -0,0 +1,155 @@
+/* Copyright (c) 2019 dkato
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          pixel2d_overlap_test.cpp
+* @brief         Test of Copy() and Blend() between overlapping rectangles on a Linux host
+*
+* A rectangle is copied or blended to a shifted position in the same surface. The result must be
+* the same as the operation from a separate copy of the surface. The shifts include odd pixels
+* (the chroma pairs of YCbCr422, the sub-byte pixels of CLUT4 / CLUT1) and widths of more than
+* PIXEL_2D_CHUNK_NUM pixels.
+*
+* Build (from Pixel2D/):
+*   g++ -O2 -I. -o pixel2d_overlap_test tools/pixel2d_overlap_test.cpp Pixel2D.cpp
+*
+* The exit status is 1 if a case fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Pixel2D.h"
+
+#define SURFACE_W   (300)
+#define SURFACE_H   (40)
+
+static uint32_t clut[16];
+
+typedef struct {
+    const char *        name;
+    Pixel2D::format_t   format;
+} format_desc_t;
+
+static const format_desc_t format_list[] = {
+    {"YCbCr422", Pixel2D::FORMAT_YCBCR422},
+    {"RGB565",   Pixel2D::FORMAT_RGB565},
+    {"RGB888",   Pixel2D::FORMAT_RGB888},
+    {"ARGB8888", Pixel2D::FORMAT_ARGB8888},
+    {"ARGB4444", Pixel2D::FORMAT_ARGB4444},
+    {"CLUT8",    Pixel2D::FORMAT_CLUT8},
+    {"CLUT4",    Pixel2D::FORMAT_CLUT4},
+    {"CLUT1",    Pixel2D::FORMAT_CLUT1},
+};
+
+typedef struct {
+    const char *            name;
+    bool                    blend;
+    Pixel2D::blend_mode_t   mode;
+    uint8_t                 global_alpha;
+} op_desc_t;
+
+static const op_desc_t op_list[] = {
+    {"Copy",                    false, Pixel2D::BLEND_SRC,      255},
+    {"Blend SRC_OVER",          true,  Pixel2D::BLEND_SRC_OVER, 255},
+    {"Blend SRC_OVER alpha",    true,  Pixel2D::BLEND_SRC_OVER, 100},
+    {"Blend SRC alpha",         true,  Pixel2D::BLEND_SRC,      200},
+    {"Blend XOR",               true,  Pixel2D::BLEND_XOR,      255},
+};
+
+/* Shifts of the destination from the source */
+static const int shift_list[][2] = {
+    {1, 0}, {-1, 0}, {3, 0}, {-5, 0}, {0, 1}, {0, -1}, {2, 3}, {-3, -2}, {7, -1}, {-1, 2}, {130, 0}, {-129, 1},
+};
+
+static void init_surface(Pixel2D::format_t format, std::vector<uint8_t> & buf, Pixel2D::surface_t * p_surface) {
+    int stride = (((SURFACE_W * Pixel2D::GetBitsPerPixel(format)) + 31) / 32) * 4;
+    size_t i;
+
+    buf.resize((size_t)stride * SURFACE_H);
+    for (i = 0; i < buf.size(); i++) {
+        buf[i] = (uint8_t)((i * 151) ^ (i >> 5) ^ 0x5A);
+    }
+    p_surface->p_buf = &buf[0];
+    p_surface->width = SURFACE_W;
+    p_surface->height = SURFACE_H;
+    p_surface->stride = stride;
+    p_surface->format = format;
+    p_surface->p_clut = clut;
+    p_surface->clut_num = (format == Pixel2D::FORMAT_CLUT1) ? 2 : 16;
+}
+
+static bool run(const op_desc_t * p_op, Pixel2D::surface_t * p_surface, int x, int y, const Pixel2D::rect_t * p_rect) {
+    if (p_op->blend) {
+        return Pixel2D::Blend(p_surface, x, y, p_surface, p_rect, p_op->mode, p_op->global_alpha);
+    }
+    return Pixel2D::Copy(p_surface, x, y, p_surface, p_rect);
+}
+
+static bool run_reference(const op_desc_t * p_op, Pixel2D::surface_t * p_dst, int x, int y,
+                          const Pixel2D::surface_t * p_src, const Pixel2D::rect_t * p_rect) {
+    if (p_op->blend) {
+        return Pixel2D::Blend(p_dst, x, y, p_src, p_rect, p_op->mode, p_op->global_alpha);
+    }
+    return Pixel2D::Copy(p_dst, x, y, p_src, p_rect);
+}
+
+int main(void) {
+    int total = 0;
+    int fail = 0;
+    size_t f;
+    size_t o;
+    size_t s;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        clut[i] = ((uint32_t)(0x40 + (i * 12)) << 24) | ((uint32_t)(i * 17) << 16) | ((uint32_t)(255 - (i * 13)) << 8) | (uint32_t)(i * 5);
+    }
+    for (f = 0; f < (sizeof(format_list) / sizeof(format_list[0])); f++) {
+        for (o = 0; o < (sizeof(op_list) / sizeof(op_list[0])); o++) {
+            for (s = 0; s < (sizeof(shift_list) / sizeof(shift_list[0])); s++) {
+                std::vector<uint8_t> buf;
+                std::vector<uint8_t> ref_buf;
+                std::vector<uint8_t> src_buf;
+                Pixel2D::surface_t surface;
+                Pixel2D::surface_t ref;
+                Pixel2D::surface_t src;
+                Pixel2D::rect_t rect = {135, 10, 150, 20};
+                int x = rect.x + shift_list[s][0];
+                int y = rect.y + shift_list[s][1];
+                bool ok;
+
+                init_surface(format_list[f].format, buf, &surface);
+                init_surface(format_list[f].format, ref_buf, &ref);
+                init_surface(format_list[f].format, src_buf, &src);
+                if (shift_list[s][0] < -100) {
+                    rect.x = 140;
+                    x = rect.x + shift_list[s][0];
+                }
+
+                ok = run(&op_list[o], &surface, x, y, &rect) && run_reference(&op_list[o], &ref, x, y, &src, &rect);
+                total++;
+                if (!ok || (buf != ref_buf)) {
+                    printf("NG: %-8s %-22s shift (%d, %d)\n", format_list[f].name, op_list[o].name,
+                           shift_list[s][0], shift_list[s][1]);
+                    fail++;
+                }
+            }
+        }
+    }
+    printf("%d / %d cases passed\n", total - fail, total);
+    return (fail == 0) ? 0 : 1;
+}
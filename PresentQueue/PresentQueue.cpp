@@ -0,0 +1,258 @@
+/* mbed PresentQueue Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "PresentQueue.h"
+
+PresentQueue::PresentQueue(DisplayBase * display, DisplayBase::graphics_layer_t layer, bool use_vsync_irq) :
+    _display(display), _layer(layer), _use_vsync_irq(use_vsync_irq), _vsync_id(-1), _mode(MODE_MAILBOX),
+    _buf_num(0), _queue_top(0), _queue_num(0), _sem_free(0, PRESENT_QUEUE_BUFFER_MAX)
+{
+    ResetStats();
+}
+
+PresentQueue::~PresentQueue()
+{
+    VsyncDispatcher::Detach(_vsync_id);
+}
+
+bool PresentQueue::SetBuffers(uint8_t ** buffers, int num, mode_t mode)
+{
+    int i;
+
+    if ((buffers == NULL) || (num < 2) || (num > PRESENT_QUEUE_BUFFER_MAX)) {
+        return false;
+    }
+    for (i = 0; i < num; i++) {
+        if (buffers[i] == NULL) {
+            return false;
+        }
+    }
+
+    core_util_critical_section_enter();
+    for (i = 0; i < num; i++) {
+        _buf[i] = buffers[i];
+        _state[i] = (i == 0) ? BUF_DISPLAYED : BUF_FREE;
+    }
+    _buf_num = num;
+    _mode = mode;
+    _queue_top = 0;
+    _queue_num = 0;
+    core_util_critical_section_exit();
+    ResetStats();
+    _timer.reset();
+    _timer.start();
+
+    if ((_use_vsync_irq) && (_vsync_id < 0)) {
+        _vsync_id = VsyncDispatcher::Attach(_display, callback(this, &PresentQueue::Vsync));
+        if (_vsync_id < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint8_t * PresentQueue::Acquire(uint32_t timeout_ms)
+{
+    bool waited = false;
+    int i;
+
+    while (true) {
+        core_util_critical_section_enter();
+        for (i = 0; i < _buf_num; i++) {
+            if (_state[i] == BUF_FREE) {
+                _state[i] = BUF_DRAWING;
+                break;
+            }
+        }
+        core_util_critical_section_exit();
+        if (i < _buf_num) {
+            return _buf[i];
+        }
+        // All buffers are in flight
+        if (!waited) {
+            waited = true;
+            core_util_critical_section_enter();
+            _stats.waits++;
+            core_util_critical_section_exit();
+        }
+        if (_sem_free.wait(timeout_ms) <= 0) {
+            core_util_critical_section_enter();
+            _stats.timeouts++;
+            core_util_critical_section_exit();
+            return NULL;
+        }
+    }
+}
+
+bool PresentQueue::Present(uint8_t * p_buf)
+{
+    int idx;
+    int old_idx;
+    uint32_t now = _timer.read_us();
+
+    core_util_critical_section_enter();
+    idx = find_buffer(p_buf, BUF_DRAWING);
+    if (idx < 0) {
+        core_util_critical_section_exit();
+        return false;
+    }
+    if ((_mode == MODE_MAILBOX) && (_queue_num > 0)) {
+        // The buffer which has not been displayed is replaced
+        old_idx = _queue[_queue_top];
+        _queue_num = 0;
+        release_buffer(old_idx);
+        _stats.dropped++;
+    }
+    _present_us[idx] = now;
+    _state[idx] = BUF_QUEUED;
+    _queue[(_queue_top + _queue_num) % _buf_num] = idx;
+    _queue_num++;
+    _stats.presented++;
+    core_util_critical_section_exit();
+
+    return true;
+}
+
+bool PresentQueue::Cancel(uint8_t * p_buf)
+{
+    int idx;
+
+    core_util_critical_section_enter();
+    idx = find_buffer(p_buf, BUF_DRAWING);
+    if (idx >= 0) {
+        release_buffer(idx);
+    }
+    core_util_critical_section_exit();
+
+    return (idx >= 0);
+}
+
+uint8_t * PresentQueue::GetDisplayed(void)
+{
+    uint8_t * p_buf = NULL;
+    int i;
+
+    core_util_critical_section_enter();
+    for (i = 0; i < _buf_num; i++) {
+        if (_state[i] == BUF_DISPLAYED) {
+            p_buf = _buf[i];
+            break;
+        }
+    }
+    core_util_critical_section_exit();
+
+    return p_buf;
+}
+
+void PresentQueue::Vsync(void)
+{
+    uint32_t now = _timer.read_us();
+    uint32_t interval;
+    int idx;
+    int i;
+
+    if (_buf_num == 0) {
+        return;
+    }
+    _stats.vsyncs++;
+
+    // The buffer replaced at the previous vsync is no longer read by the VDC
+    for (i = 0; i < _buf_num; i++) {
+        if (_state[i] == BUF_RELEASING) {
+            release_buffer(i);
+        }
+    }
+
+    if (_queue_num == 0) {
+        if (_changed_any) {
+            _stats.repeated++;
+        }
+        return;
+    }
+
+    // The buffer changed now is read from the next frame
+    idx = _queue[_queue_top];
+    _queue_top = (_queue_top + 1) % _buf_num;
+    _queue_num--;
+    _display->Graphics_Read_Change(_layer, (void *)_buf[idx]);
+    for (i = 0; i < _buf_num; i++) {
+        if (_state[i] == BUF_DISPLAYED) {
+            _state[i] = BUF_RELEASING;
+        }
+    }
+    _state[idx] = BUF_DISPLAYED;
+    _stats.displayed++;
+    _latency_sum += (uint32_t)(now - _present_us[idx]);
+
+    if (_changed_any) {
+        interval = now - _last_change_us;
+        if ((_stats.interval_min_us == 0) || (interval < _stats.interval_min_us)) {
+            _stats.interval_min_us = interval;
+        }
+        if (interval > _stats.interval_max_us) {
+            _stats.interval_max_us = interval;
+        }
+        _interval_sum += interval;
+    }
+    _last_change_us = now;
+    _changed_any = true;
+}
+
+void PresentQueue::GetStats(stats_t * p_stats)
+{
+    if (p_stats == NULL) {
+        return;
+    }
+    core_util_critical_section_enter();
+    *p_stats = _stats;
+    if (_stats.displayed > 1) {
+        p_stats->interval_avg_us = (uint32_t)(_interval_sum / (_stats.displayed - 1));
+    }
+    if (_stats.displayed != 0) {
+        p_stats->latency_avg_us = (uint32_t)(_latency_sum / _stats.displayed);
+    }
+    core_util_critical_section_exit();
+}
+
+void PresentQueue::ResetStats(void)
+{
+    core_util_critical_section_enter();
+    memset(&_stats, 0, sizeof(_stats));
+    _interval_sum = 0;
+    _latency_sum = 0;
+    _changed_any = false;
+    core_util_critical_section_exit();
+}
+
+int PresentQueue::find_buffer(uint8_t * p_buf, buf_state_t state)
+{
+    int i;
+
+    for (i = 0; i < _buf_num; i++) {
+        if ((_buf[i] == p_buf) && (_state[i] == state)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PresentQueue::release_buffer(int idx)
+{
+    _state[idx] = BUF_FREE;
+    _sem_free.release();
+}
@@ -0,0 +1,207 @@
+/* mbed PresentQueue Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          PresentQueue.h
+* @brief         Frame buffer presentation paced by the vsync
+******************************************************************************/
+#ifndef __PRESENT_QUEUE_H__
+#define __PRESENT_QUEUE_H__
+
+#include "mbed.h"
+#include "DisplayBace.h"
+#include "VsyncDispatcher.h"
+
+/** Maximum number of frame buffers */
+#ifndef PRESENT_QUEUE_BUFFER_MAX
+#define PRESENT_QUEUE_BUFFER_MAX    (4)
+#endif
+
+/** A class to present the frame buffers of a graphics layer at the vsync
+ *
+ * The renderer gets a free buffer by Acquire(), draws it and passes it to Present().
+ * The presented buffer is displayed by Graphics_Read_Change() in the vsync interrupt,
+ * so the picture does not tear. The buffer which has been replaced is still read by the VDC
+ * until the next vsync, then it becomes free.
+ *
+ * MODE_FIFO    : All presented buffers are displayed in order, one per vsync.
+ *                Present() never waits, Acquire() waits while all buffers are queued or displayed.
+ * MODE_MAILBOX : Only the latest presented buffer is displayed. A presented buffer which has not
+ *                been displayed yet is freed (dropped) by the next Present(). With 4 buffers
+ *                (displayed, replaced at the last vsync, queued and drawing) Acquire() does not wait,
+ *                so the renderer runs at its own rate. With 3 buffers Acquire() can wait until the
+ *                next vsync frees the replaced buffer.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "EasyAttach_CameraAndLCD.h"
+ * #include "PresentQueue.h"
+ *
+ * #define STRIDE          (((LCD_PIXEL_WIDTH * 2u) + 31u) & ~31u)
+ *
+ * static uint8_t fb0[STRIDE * LCD_PIXEL_HEIGHT] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t fb1[STRIDE * LCD_PIXEL_HEIGHT] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t fb2[STRIDE * LCD_PIXEL_HEIGHT] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t fb3[STRIDE * LCD_PIXEL_HEIGHT] __attribute((section("NC_BSS"),aligned(32)));
+ *
+ * DisplayBase Display;
+ * PresentQueue Presenter(&Display, DisplayBase::GRAPHICS_LAYER_0);
+ *
+ * int main() {
+ *     uint8_t * fb[4] = {fb0, fb1, fb2, fb3};
+ *     uint8_t * p_buf;
+ *
+ *     // Start the LCD and the graphics layer 0 with fb0 (RGB565) here
+ *     Presenter.SetBuffers(fb, 4, PresentQueue::MODE_MAILBOX);
+ *     while (1) {
+ *         p_buf = Presenter.Acquire();
+ *         // draw p_buf
+ *         Presenter.Present(p_buf);
+ *     }
+ * }
+ * @endcode
+ */
+class PresentQueue {
+public:
+    /*! @enum mode_t
+        @brief Presentation mode
+     */
+    typedef enum {
+        MODE_FIFO = 0,                  /*!< Display all presented buffers in order */
+        MODE_MAILBOX,                   /*!< Display the latest presented buffer */
+    } mode_t;
+
+    /*! @struct stats_t
+        @brief Presentation statistics
+     */
+    typedef struct {
+        uint32_t    vsyncs;             /*!< Number of vsyncs */
+        uint32_t    presented;          /*!< Number of buffers passed to Present() */
+        uint32_t    displayed;          /*!< Number of buffers displayed */
+        uint32_t    dropped;            /*!< Number of buffers replaced before they were displayed (MODE_MAILBOX) */
+        uint32_t    repeated;           /*!< Number of vsyncs without a new buffer (the previous buffer was kept) */
+        uint32_t    waits;              /*!< Number of Acquire() calls which waited for a free buffer */
+        uint32_t    timeouts;           /*!< Number of Acquire() calls which timed out */
+        uint32_t    interval_min_us;    /*!< Minimum time between the changes of the buffer */
+        uint32_t    interval_max_us;    /*!< Maximum time between the changes of the buffer */
+        uint32_t    interval_avg_us;    /*!< Average time between the changes of the buffer */
+        uint32_t    latency_avg_us;     /*!< Average time from Present() to the display */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param display display
+     * @param layer graphics layer
+     * @param use_vsync_irq true: Vsync() is attached to VsyncDispatcher by SetBuffers(), false: the application calls Vsync()
+     *                      The interrupt is shared with the other queues, the other modules and the application
+     *                      through VsyncDispatcher (e.g. one queue per graphics layer).
+     */
+    PresentQueue(DisplayBase * display, DisplayBase::graphics_layer_t layer, bool use_vsync_irq = true);
+
+    /** Destructor
+     */
+    ~PresentQueue();
+
+    /** Set the frame buffers
+     *
+     * @param buffers frame buffer addresses, buffers[0] must be the buffer displayed now (set by Graphics_Read_Setting())
+     * @param num number of frame buffers (2 to PRESENT_QUEUE_BUFFER_MAX)
+     * @param mode presentation mode
+     * @return true = success, false = failure
+     */
+    bool SetBuffers(uint8_t ** buffers, int num, mode_t mode = MODE_MAILBOX);
+
+    /** Get a buffer to draw
+     *
+     * @param timeout_ms time to wait for a free buffer (ms)
+     * @return buffer address, NULL = timeout
+     */
+    uint8_t * Acquire(uint32_t timeout_ms = osWaitForever);
+
+    /** Present a buffer got by Acquire()
+     *
+     * The buffer is displayed from the next vsync or later.
+     *
+     * @param p_buf buffer address
+     * @return true = success, false = the buffer was not got by Acquire()
+     */
+    bool Present(uint8_t * p_buf);
+
+    /** Return a buffer got by Acquire() without presenting it
+     *
+     * @param p_buf buffer address
+     * @return true = success, false = the buffer was not got by Acquire()
+     */
+    bool Cancel(uint8_t * p_buf);
+
+    /** Get the buffer displayed now
+     *
+     * @return buffer address
+     */
+    uint8_t * GetDisplayed(void);
+
+    /** Vsync process
+     *
+     * Called from the vsync interrupt when use_vsync_irq of the constructor is false.
+     */
+    void Vsync(void);
+
+    /** Get the presentation statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+    /** Clear the presentation statistics
+     */
+    void ResetStats(void);
+
+private:
+    typedef enum {
+        BUF_FREE,
+        BUF_DRAWING,
+        BUF_QUEUED,
+        BUF_DISPLAYED,
+        BUF_RELEASING
+    } buf_state_t;
+
+
+    DisplayBase * _display;
+    DisplayBase::graphics_layer_t _layer;
+    bool _use_vsync_irq;
+    int _vsync_id;                      /* ID of VsyncDispatcher, -1 = not attached */
+    mode_t _mode;
+    uint8_t * _buf[PRESENT_QUEUE_BUFFER_MAX];
+    volatile buf_state_t _state[PRESENT_QUEUE_BUFFER_MAX];
+    uint32_t _present_us[PRESENT_QUEUE_BUFFER_MAX];
+    int _buf_num;
+    int _queue[PRESENT_QUEUE_BUFFER_MAX];
+    volatile int _queue_top;
+    volatile int _queue_num;
+    bool _changed_any;
+    uint32_t _last_change_us;
+    uint64_t _interval_sum;
+    uint64_t _latency_sum;
+    Timer _timer;
+    Semaphore _sem_free;
+    stats_t _stats;
+
+    int find_buffer(uint8_t * p_buf, buf_state_t state);
+    void release_buffer(int idx);
+};
+
+#endif
@@ -0,0 +1,540 @@
+/* mbed TextConsole Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "TextConsole.h"
+
+#define ATTR_DEFAULT    (0x07)          /* white on black */
+#define ATTR_BLANK      (0x00)          /* erased cell of the default background */
+#define TAB_SIZE        (8)
+#define PARAM_VALUE_MAX (9999)
+
+/* VGA colours (RGB888) */
+static const uint32_t default_rgb[16] = {
+    0x000000, 0xAA0000, 0x00AA00, 0xAA5500, 0x0000AA, 0xAA00AA, 0x00AAAA, 0xAAAAAA,
+    0x555555, 0xFF5555, 0x55FF55, 0xFFFF55, 0x5555FF, 0xFF55FF, 0x55FFFF, 0xFFFFFF
+};
+
+TextConsole::TextConsole(uint8_t * p_buf, int width, int height, int stride, int byte_per_pixel, int font_size,
+                         scroll_mode_t mode) :
+  _p_buf(p_buf), _width(width), _height(height), _stride(stride), _font_size((font_size < 1) ? 1 : font_size),
+  _mode(mode), _font(p_buf, width, (mode == SCROLL_ADDRESS) ? (height * 2) : height, stride, byte_per_pixel),
+  _cells(NULL), _dirty(NULL), _dirty_row(NULL), _line_buf(NULL), _cur_x(0), _cur_y(0), _save_x(0), _save_y(0),
+  _fg(ATTR_DEFAULT & 0x0F), _bg(ATTR_DEFAULT >> 4), _bold(false), _reverse(false), _state(STATE_NORMAL),
+  _param_num(0), _pending_scroll(0), _top(0), _address_changed(false), _auto_flush(true), _address_func(NULL) {
+    uint32_t rgb;
+    int i;
+
+    _cell_width  = AsciiFont::CHAR_PIX_WIDTH * _font_size;
+    _cell_height = AsciiFont::CHAR_PIX_HEIGHT * _font_size;
+    _columns = _width / _cell_width;
+    _rows    = _height / _cell_height;
+    _row_bytes = (uint32_t)_stride * _cell_height;
+
+    for (i = 0; i < 16; i++) {
+        rgb = default_rgb[i];
+        if (byte_per_pixel == 2) {
+            _palette[i] = ((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F);
+        } else if (byte_per_pixel == 3) {
+            _palette[i] = rgb;
+        } else if (byte_per_pixel == 4) {
+            _palette[i] = 0xFF000000 | rgb;
+        } else {
+            _palette[i] = i;
+        }
+    }
+
+    if ((_columns <= 0) || (_rows <= 0)) {
+        _columns = 0;
+        _rows = 0;
+        return;
+    }
+    _cells     = new cell_t[_columns * _rows];
+    _dirty     = new bool[_columns * _rows];
+    _dirty_row = new bool[_rows];
+    _line_buf  = new char[_columns + 1];
+    for (i = 0; i < (_columns * _rows); i++) {
+        _cells[i].c = ' ';
+        _cells[i].attr = ATTR_BLANK;
+        _dirty[i] = true;
+    }
+    for (i = 0; i < _rows; i++) {
+        _dirty_row[i] = true;
+    }
+}
+
+TextConsole::~TextConsole() {
+    delete [] _cells;
+    delete [] _dirty;
+    delete [] _dirty_row;
+    delete [] _line_buf;
+}
+
+void TextConsole::SetPalette(const uint32_t * p_palette) {
+    int i;
+
+    if (p_palette == NULL) {
+        return;
+    }
+    _mutex.lock();
+    memcpy(_palette, p_palette, sizeof(_palette));
+    for (i = 0; i < (_columns * _rows); i++) {
+        _dirty[i] = true;
+    }
+    for (i = 0; i < _rows; i++) {
+        _dirty_row[i] = true;
+    }
+    _mutex.unlock();
+}
+
+void TextConsole::SetAddressFunc(Callback<void(uint8_t *)> func) {
+    _mutex.lock();
+    _address_func = func;
+    _address_changed = true;
+    _mutex.unlock();
+}
+
+void TextConsole::PutChar(char c) {
+    _mutex.lock();
+    put_char(c);
+    if (_auto_flush) {
+        flush();
+    }
+    _mutex.unlock();
+}
+
+void TextConsole::Flush(void) {
+    _mutex.lock();
+    flush();
+    _mutex.unlock();
+}
+
+void TextConsole::Clear(void) {
+    int y;
+
+    _mutex.lock();
+    for (y = 0; y < _rows; y++) {
+        erase_cells(0, y, _columns);
+    }
+    _cur_x = 0;
+    _cur_y = 0;
+    if (_auto_flush) {
+        flush();
+    }
+    _mutex.unlock();
+}
+
+uint8_t * TextConsole::GetStartAddress(void) {
+    return &_p_buf[_top * _row_bytes];
+}
+
+ssize_t TextConsole::write(const void * buffer, size_t size) {
+    const char * p_data = (const char *)buffer;
+    size_t i;
+
+    _mutex.lock();
+    for (i = 0; i < size; i++) {
+        put_char(p_data[i]);
+    }
+    if (_auto_flush) {
+        flush();
+    }
+    _mutex.unlock();
+
+    return size;
+}
+
+ssize_t TextConsole::read(void * buffer, size_t size) {
+    // The console has no input
+    (void)buffer;
+    (void)size;
+    return 0;
+}
+
+off_t TextConsole::seek(off_t offset, int whence) {
+    (void)offset;
+    (void)whence;
+    return -ESPIPE;
+}
+
+int TextConsole::close() {
+    return 0;
+}
+
+int TextConsole::isatty() {
+    return 1;
+}
+
+uint8_t TextConsole::cur_attr(void) {
+    uint8_t fg = _fg;
+    uint8_t bg = _bg;
+    uint8_t wk;
+
+    if (_bold && (fg < 8)) {
+        fg += 8;
+    }
+    if (_reverse) {
+        wk = fg;
+        fg = bg;
+        bg = wk;
+    }
+    return (uint8_t)(fg | (bg << 4));
+}
+
+void TextConsole::put_char(char c) {
+    int next;
+
+    if (_rows == 0) {
+        return;
+    }
+    switch (_state) {
+        case STATE_ESC:
+            escape(c);
+            return;
+        case STATE_CSI:
+            csi(c);
+            return;
+        default:
+            break;
+    }
+
+    switch (c) {
+        case '\x1b':
+            _state = STATE_ESC;
+            break;
+        case '\n':
+            new_line();
+            break;
+        case '\r':
+            _cur_x = 0;
+            break;
+        case '\b':
+            if (_cur_x >= _columns) {
+                _cur_x = _columns - 1;
+            }
+            if (_cur_x > 0) {
+                _cur_x--;
+            }
+            break;
+        case '\t':
+            next = ((_cur_x / TAB_SIZE) + 1) * TAB_SIZE;
+            if (next >= _columns) {
+                next = _columns - 1;
+            }
+            if (next > _cur_x) {
+                _cur_x = next;
+            }
+            break;
+        default:
+            if ((uint8_t)c < 0x20) {
+                // Other control characters are ignored
+                break;
+            }
+            // The line wraps when the next character is written to the right edge
+            if (_cur_x >= _columns) {
+                new_line();
+            }
+            set_cell(_cur_x, _cur_y, ((uint8_t)c < 0x7F) ? c : '?', cur_attr());
+            _cur_x++;
+            break;
+    }
+}
+
+void TextConsole::new_line(void) {
+    _cur_x = 0;
+    if (_cur_y < (_rows - 1)) {
+        _cur_y++;
+    } else {
+        scroll(1);
+    }
+}
+
+void TextConsole::scroll(int num) {
+    int keep = _rows - num;
+    int y;
+
+    if (keep > 0) {
+        memmove(&_cells[0], &_cells[num * _columns], sizeof(cell_t) * keep * _columns);
+        memmove(&_dirty[0], &_dirty[num * _columns], sizeof(bool) * keep * _columns);
+        memmove(&_dirty_row[0], &_dirty_row[num], sizeof(bool) * keep);
+    } else {
+        keep = 0;
+    }
+    for (y = keep; y < _rows; y++) {
+        erase_cells(0, y, _columns);
+    }
+    // The new rows do not match the frame buffer after it is scrolled
+    memset(&_dirty[keep * _columns], true, sizeof(bool) * (_rows - keep) * _columns);
+    memset(&_dirty_row[keep], true, sizeof(bool) * (_rows - keep));
+    // The frame buffer is scrolled by flush()
+    _pending_scroll += num;
+    if (_pending_scroll > _rows) {
+        _pending_scroll = _rows;
+    }
+}
+
+void TextConsole::set_cell(int x, int y, char c, uint8_t attr) {
+    int idx = (y * _columns) + x;
+
+    if ((_cells[idx].c != c) || (_cells[idx].attr != attr)) {
+        _cells[idx].c = c;
+        _cells[idx].attr = attr;
+        _dirty[idx] = true;
+        _dirty_row[y] = true;
+    }
+}
+
+void TextConsole::erase_cells(int x, int y, int num) {
+    uint8_t attr = cur_attr() & 0xF0;
+    int i;
+
+    attr |= (attr >> 4);  // the foreground is not visible
+    for (i = 0; (i < num) && ((x + i) < _columns); i++) {
+        set_cell(x + i, y, ' ', attr);
+    }
+}
+
+void TextConsole::escape(char c) {
+    int i;
+
+    _state = STATE_NORMAL;
+    switch (c) {
+        case '[':
+            for (i = 0; i < TEXT_CONSOLE_PARAM_MAX; i++) {
+                _param[i] = -1;
+            }
+            _param_num = 1;
+            _state = STATE_CSI;
+            break;
+        case '7':
+            _save_x = _cur_x;
+            _save_y = _cur_y;
+            break;
+        case '8':
+            _cur_x = _save_x;
+            _cur_y = _save_y;
+            break;
+        case '\x1b':
+            _state = STATE_ESC;
+            break;
+        default:
+            // Other sequences are ignored
+            break;
+    }
+}
+
+void TextConsole::csi(char c) {
+    int * p_param;
+    int n;
+    int y;
+
+    if ((c >= '0') && (c <= '9')) {
+        p_param = &_param[_param_num - 1];
+        if (*p_param < 0) {
+            *p_param = 0;
+        }
+        if (*p_param <= PARAM_VALUE_MAX) {
+            *p_param = (*p_param * 10) + (c - '0');
+        }
+        return;
+    }
+    if (c == ';') {
+        if (_param_num < TEXT_CONSOLE_PARAM_MAX) {
+            _param_num++;
+        }
+        return;
+    }
+    if (c == '\x1b') {
+        _state = STATE_ESC;
+        return;
+    }
+    if (((uint8_t)c < 0x40) || ((uint8_t)c > 0x7E)) {
+        // Private and intermediate bytes are ignored
+        return;
+    }
+
+    _state = STATE_NORMAL;
+    n = (_param[0] <= 0) ? 1 : _param[0];
+    if ((_cur_x >= _columns) && (c != 'm')) {
+        _cur_x = _columns - 1;
+    }
+    switch (c) {
+        case 'A':
+            _cur_y = (_cur_y > n) ? (_cur_y - n) : 0;
+            break;
+        case 'B':
+            _cur_y = ((_cur_y + n) < _rows) ? (_cur_y + n) : (_rows - 1);
+            break;
+        case 'C':
+            _cur_x = ((_cur_x + n) < _columns) ? (_cur_x + n) : (_columns - 1);
+            break;
+        case 'D':
+            _cur_x = (_cur_x > n) ? (_cur_x - n) : 0;
+            break;
+        case 'H':
+        case 'f':
+            _cur_y = n - 1;
+            _cur_x = ((_param_num < 2) || (_param[1] <= 0)) ? 0 : (_param[1] - 1);
+            if (_cur_y >= _rows) {
+                _cur_y = _rows - 1;
+            }
+            if (_cur_x >= _columns) {
+                _cur_x = _columns - 1;
+            }
+            break;
+        case 'J':
+            n = (_param[0] < 0) ? 0 : _param[0];
+            if (n == 0) {
+                erase_cells(_cur_x, _cur_y, _columns);
+                for (y = _cur_y + 1; y < _rows; y++) {
+                    erase_cells(0, y, _columns);
+                }
+            } else if (n == 1) {
+                for (y = 0; y < _cur_y; y++) {
+                    erase_cells(0, y, _columns);
+                }
+                erase_cells(0, _cur_y, _cur_x + 1);
+            } else {
+                for (y = 0; y < _rows; y++) {
+                    erase_cells(0, y, _columns);
+                }
+            }
+            break;
+        case 'K':
+            n = (_param[0] < 0) ? 0 : _param[0];
+            if (n == 0) {
+                erase_cells(_cur_x, _cur_y, _columns);
+            } else if (n == 1) {
+                erase_cells(0, _cur_y, _cur_x + 1);
+            } else {
+                erase_cells(0, _cur_y, _columns);
+            }
+            break;
+        case 'm':
+            sgr();
+            break;
+        default:
+            // Other sequences are ignored
+            break;
+    }
+}
+
+void TextConsole::sgr(void) {
+    int value;
+    int i;
+
+    for (i = 0; i < _param_num; i++) {
+        value = (_param[i] < 0) ? 0 : _param[i];
+        if (value == 0) {
+            _fg = ATTR_DEFAULT & 0x0F;
+            _bg = ATTR_DEFAULT >> 4;
+            _bold = false;
+            _reverse = false;
+        } else if (value == 1) {
+            _bold = true;
+        } else if (value == 7) {
+            _reverse = true;
+        } else if (value == 22) {
+            _bold = false;
+        } else if (value == 27) {
+            _reverse = false;
+        } else if ((value >= 30) && (value <= 37)) {
+            _fg = value - 30;
+        } else if (value == 39) {
+            _fg = ATTR_DEFAULT & 0x0F;
+        } else if ((value >= 40) && (value <= 47)) {
+            _bg = value - 40;
+        } else if (value == 49) {
+            _bg = ATTR_DEFAULT >> 4;
+        } else if ((value >= 90) && (value <= 97)) {
+            _fg = value - 90 + 8;
+        } else if ((value >= 100) && (value <= 107)) {
+            _bg = value - 100 + 8;
+        } else {
+            // do nothing
+        }
+    }
+}
+
+void TextConsole::draw_row(int y) {
+    bool * p_dirty = &_dirty[y * _columns];
+    cell_t * p_cell = &_cells[y * _columns];
+    int frame_y;
+    int alias_y;
+    int start;
+    int len;
+    uint8_t attr;
+    int x = 0;
+
+    frame_y = y;
+    alias_y = -1;
+    if (_mode == SCROLL_ADDRESS) {
+        // Each row is drawn at 2 places, so any 'rows' rows from _top are continuous
+        frame_y = _top + y;
+        alias_y = (frame_y >= _rows) ? (frame_y - _rows) : (frame_y + _rows);
+    }
+
+    while (x < _columns) {
+        if (!p_dirty[x]) {
+            x++;
+            continue;
+        }
+        // A run of the changed cells of the same colours is drawn at a time
+        start = x;
+        attr = p_cell[x].attr;
+        len = 0;
+        while ((x < _columns) && p_dirty[x] && (p_cell[x].attr == attr)) {
+            _line_buf[len++] = p_cell[x].c;
+            p_dirty[x] = false;
+            x++;
+        }
+        _line_buf[len] = '\0';
+        _font.SetBackground(_palette[attr >> 4]);
+        _font.DrawStr(_line_buf, start * _cell_width, frame_y * _cell_height, _palette[attr & 0x0F], _font_size, len);
+        if (alias_y >= 0) {
+            _font.DrawStr(_line_buf, start * _cell_width, alias_y * _cell_height, _palette[attr & 0x0F], _font_size, len);
+        }
+    }
+    _dirty_row[y] = false;
+}
+
+void TextConsole::flush(void) {
+    int y;
+
+    if (_rows == 0) {
+        return;
+    }
+    if (_pending_scroll > 0) {
+        if (_mode == SCROLL_ADDRESS) {
+            _top = (_top + _pending_scroll) % _rows;
+            _address_changed = true;
+        } else if (_pending_scroll < _rows) {
+            memmove(_p_buf, &_p_buf[_pending_scroll * _row_bytes], (_rows - _pending_scroll) * _row_bytes);
+        } else {
+            // All rows are redrawn
+        }
+        _pending_scroll = 0;
+    }
+    for (y = 0; y < _rows; y++) {
+        if (_dirty_row[y]) {
+            draw_row(y);
+        }
+    }
+    if (_address_changed && _address_func) {
+        _address_changed = false;
+        _address_func(GetStartAddress());
+    }
+}
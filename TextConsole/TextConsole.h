@@ -0,0 +1,251 @@
+/* mbed TextConsole Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          TextConsole.h
+* @brief         Text console on a frame buffer
+*
+* Control characters : BS, HT, LF (new line), CR
+* Escape sequences (CSI = ESC '[')
+*
+*   CSI n A / B / C / D       cursor up / down / forward / back
+*   CSI row ; col H (or f)    cursor position (1-origin)
+*   CSI n J                   erase in display (0: to the end, 1: to the cursor, 2: all)
+*   CSI n K                   erase in line (0: to the end, 1: to the cursor, 2: all)
+*   CSI n ; ... m             0: reset, 1: bold (bright), 7: reverse, 22, 27,
+*                             30-37 / 90-97: foreground, 39: default foreground,
+*                             40-47 / 100-107: background, 49: default background
+*   ESC 7 / ESC 8             save / restore cursor
+*
+* Other sequences are ignored.
+******************************************************************************/
+#ifndef __TEXT_CONSOLE_H__
+#define __TEXT_CONSOLE_H__
+
+#include "mbed.h"
+#include "AsciiFont.h"
+
+/** The maximum number of parameters of an escape sequence */
+#ifndef TEXT_CONSOLE_PARAM_MAX
+#define TEXT_CONSOLE_PARAM_MAX  (4)
+#endif
+
+/** A class of the text console drawn on a frame buffer
+ *
+ * The characters are kept in a grid of cells. The written characters only update the cells,
+ * and Flush() draws the cells which were changed. A new line scrolls the grid, and the frame buffer
+ * is scrolled once per Flush() by memmove of the rows or by moving the start address of the frame buffer.
+ * The console is a FileHandle, so it can be the console of stdout.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "EasyAttach_CameraAndLCD.h"
+ * #include "TextConsole.h"
+ *
+ * #define WIDTH           (LCD_PIXEL_WIDTH)
+ * #define HEIGHT          (LCD_PIXEL_HEIGHT)
+ * #define STRIDE          (((WIDTH * 2u) + 31u) & ~31u)
+ *
+ * // SCROLL_ADDRESS needs 2 screens
+ * static uint8_t console_buf[STRIDE * HEIGHT * 2] __attribute((section("NC_BSS"),aligned(32)));
+ * static TextConsole console(console_buf, WIDTH, HEIGHT, STRIDE, 2, 1, TextConsole::SCROLL_ADDRESS);
+ * DisplayBase Display;
+ *
+ * static void change_address(uint8_t * p_start) {
+ *     Display.Graphics_Read_Change(DisplayBase::GRAPHICS_LAYER_0, (void *)p_start);
+ * }
+ *
+ * namespace mbed {
+ * FileHandle * mbed_override_console(int fd) {
+ *     return &console;
+ * }
+ * }
+ *
+ * int main() {
+ *     DisplayBase::rect_t rect;
+ *
+ *     EasyAttach_Init(Display);
+ *     rect.vs = 0;
+ *     rect.vw = HEIGHT;
+ *     rect.hs = 0;
+ *     rect.hw = WIDTH;
+ *     Display.Graphics_Read_Setting(DisplayBase::GRAPHICS_LAYER_0, (void *)console_buf, STRIDE,
+ *                                   DisplayBase::GRAPHICS_FORMAT_RGB565, DisplayBase::WR_RD_WRSWA_32_16BIT, &rect);
+ *     Display.Graphics_Start(DisplayBase::GRAPHICS_LAYER_0);
+ *     EasyAttach_LcdBacklight(true);
+ *     console.SetAddressFunc(callback(change_address));
+ *
+ *     for (int i = 0; ; i++) {
+ *         printf("\x1b[32m%d\x1b[0m : Hello\n", i);
+ *     }
+ * }
+ * @endcode
+ */
+class TextConsole : public FileHandle {
+public:
+    /*! @enum scroll_mode_t
+        @brief How to scroll the frame buffer
+     */
+    typedef enum {
+        SCROLL_MEMMOVE = 0,             /*!< Move the rows in the frame buffer */
+        SCROLL_ADDRESS = 1,             /*!< Move the start address (the buffer must have 2 x height lines,
+                                             the lines below the last row of cells are not drawn) */
+    } scroll_mode_t;
+
+    /** Constructor
+     *
+     * The colours are the values of AsciiFont. The default palette is made for byte_per_pixel
+     * (1: CLUT8 index 0 - 15, 2: RGB565, 4: ARGB8888).
+     *
+     * @param p_buf Frame buffer address
+     * @param width Frame buffer width
+     * @param height Frame buffer height (the visible lines)
+     * @param stride Buffer stride
+     * @param byte_per_pixel Byte per pixel
+     * @param font_size Font size (>=1)
+     * @param mode How to scroll the frame buffer
+     */
+    TextConsole(uint8_t * p_buf, int width, int height, int stride, int byte_per_pixel, int font_size = 1,
+                scroll_mode_t mode = SCROLL_MEMMOVE);
+
+    /** Destructor
+     */
+    virtual ~TextConsole();
+
+    /** Set the palette
+     *
+     * @param p_palette 16 colours (0 - 7: black, red, green, yellow, blue, magenta, cyan, white, 8 - 15: bright)
+     */
+    void SetPalette(const uint32_t * p_palette);
+
+    /** Set the function to change the start address of the frame buffer (SCROLL_ADDRESS)
+     *
+     * @param func function called with the address of the top line after the frame buffer was drawn
+     */
+    void SetAddressFunc(Callback<void(uint8_t *)> func);
+
+    /** Set the flush timing
+     *
+     * @param auto_flush true = flush at the end of each write (default), false = call Flush()
+     */
+    void SetAutoFlush(bool auto_flush) {
+        _auto_flush = auto_flush;
+    }
+
+    /** Write a character
+     *
+     * @param c character
+     */
+    void PutChar(char c);
+
+    /** Draw the changed cells to the frame buffer
+     */
+    void Flush(void);
+
+    /** Clear the screen and move the cursor to the top left
+     */
+    void Clear(void);
+
+    /** Get the number of columns
+     *
+     * @return number of columns
+     */
+    int GetColumns(void) {
+        return _columns;
+    }
+
+    /** Get the number of rows
+     *
+     * @return number of rows
+     */
+    int GetRows(void) {
+        return _rows;
+    }
+
+    /** Get the frame buffer address of the top line
+     *
+     * @return address
+     */
+    uint8_t * GetStartAddress(void);
+
+    virtual ssize_t write(const void * buffer, size_t size);
+    virtual ssize_t read(void * buffer, size_t size);
+    virtual off_t seek(off_t offset, int whence = SEEK_SET);
+    virtual int close();
+    virtual int isatty();
+
+private:
+    typedef struct {
+        char        c;
+        uint8_t     attr;               /* foreground (bit 0-3) and background (bit 4-7) */
+    } cell_t;
+
+    typedef enum {
+        STATE_NORMAL,
+        STATE_ESC,
+        STATE_CSI,
+    } esc_state_t;
+
+    uint8_t * _p_buf;
+    int _width;
+    int _height;
+    int _stride;
+    int _font_size;
+    scroll_mode_t _mode;
+    AsciiFont _font;
+    int _cell_width;
+    int _cell_height;
+    int _columns;
+    int _rows;
+    uint32_t _row_bytes;                /* bytes of a row of cells */
+    cell_t * _cells;
+    bool * _dirty;                      /* changed cells */
+    bool * _dirty_row;                  /* rows which have changed cells */
+    char * _line_buf;
+    uint32_t _palette[16];
+    int _cur_x;
+    int _cur_y;
+    int _save_x;
+    int _save_y;
+    uint8_t _fg;
+    uint8_t _bg;
+    bool _bold;
+    bool _reverse;
+    esc_state_t _state;
+    int _param[TEXT_CONSOLE_PARAM_MAX];
+    int _param_num;
+    int _pending_scroll;
+    int _top;                           /* top row in the frame buffer (SCROLL_ADDRESS) */
+    bool _address_changed;
+    bool _auto_flush;
+    Callback<void(uint8_t *)> _address_func;
+    Mutex _mutex;
+
+    uint8_t cur_attr(void);
+    void put_char(char c);
+    void new_line(void);
+    void scroll(int num);
+    void set_cell(int x, int y, char c, uint8_t attr);
+    void erase_cells(int x, int y, int num);
+    void escape(char c);
+    void csi(char c);
+    void sgr(void);
+    void draw_row(int y);
+    void flush(void);
+};
+
+#endif
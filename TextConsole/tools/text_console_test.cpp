@@ -0,0 +1,206 @@
+/* mbed TextConsole Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**************************************************************************//**
+* @file          text_console_test.cpp
+* @brief         Check of the text, scrolling, wrapping and escape sequences of TextConsole on a Linux host
+*
+* Each case writes a string to a console of 10 columns x 4 rows (in up to 3 write() calls, so the
+* escape sequences can be split), and the visible frame buffer is compared with the expected screen
+* drawn cell by cell with AsciiFont. The frame buffer has 1 byte per pixel, so the pixels are the
+* indexes of the palette. Each case runs with SCROLL_MEMMOVE and SCROLL_ADDRESS, and with font
+* size 1 and 2. With SCROLL_ADDRESS, the address given to the function of SetAddressFunc() must be
+* GetStartAddress().
+*
+* Build (from TextConsole/):
+*   g++ -O2 -pthread -I. -I../AsciiFont -I../DisplayApp/tools/host_mbed -o text_console_test
+*       tools/text_console_test.cpp TextConsole.cpp ../AsciiFont/AsciiFont.cpp ../AsciiFont/ascii.c
+*
+* The exit status is 1 if a case fails.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "mbed.h"
+#include "TextConsole.h"
+
+#define COLUMNS         (10)
+#define ROWS            (4)
+#define CHUNK_MAX       (3)
+
+typedef struct {
+    const char *    name;
+    const char *    chunks[CHUNK_MAX];  /* Written by write() in turn (NULL: end) */
+    bool            auto_flush;         /* false: Flush() after the last chunk */
+    const char *    text[ROWS];         /* Expected characters (shorter rows and NULL are padded with spaces) */
+    const char *    attr[ROWS];         /* Expected colours, 2 hex digits (fg, bg) a cell (shorter: "70") */
+} console_case_t;
+
+static const console_case_t case_list[] = {
+    {"CR LF",           {"ab\r\ncd"}, true,
+     {"ab", "cd"}, {NULL}},
+    {"CR overwrite",    {"abcd\rXY"}, true,
+     {"XYcd"}, {NULL}},
+    {"wrap",            {"0123456789AB"}, true,
+     {"0123456789", "AB"}, {NULL}},
+    {"wrap + LF",       {"0123456789\nX"}, true,
+     {"0123456789", "X"}, {NULL}},
+    {"scroll",          {"1\n2\n3\n4\n5\n6"}, true,
+     {"3", "4", "5", "6"}, {NULL}},
+    {"scroll by chunk", {"1\n2\n3\n", "4\n5\n6"}, true,
+     {"3", "4", "5", "6"}, {NULL}},
+    {"scroll wraps",    {"1\n2\n3\n4\n5\n6", "\n7\n8"}, true,
+     {"5", "6", "7", "8"}, {NULL}},
+    {"scroll > rows",   {"1\n2\n3\n4\n5\n6\n7\n8\n9\nA"}, false,
+     {"7", "8", "9", "A"}, {NULL}},
+    {"wrap + scroll",   {"AAAAAAAAAABBBBBBBBBBCCCCCCCCCCDDDDDDDDDDZ"}, true,
+     {"BBBBBBBBBB", "CCCCCCCCCC", "DDDDDDDDDD", "Z"}, {NULL}},
+    {"BS",              {"\babc\b\bX"}, true,
+     {"aXc"}, {NULL}},
+    {"BS at the edge",  {"0123456789\b\bX"}, true,
+     {"0123456X89"}, {NULL}},
+    {"HT",              {"a\tb\tc"}, true,
+     {"a       bc"}, {NULL}},
+    {"control",         {"\x01" "a\x07" "b\x7f" "c\x80"}, true,
+     {"ab?c?"}, {NULL}},
+    {"CUP",             {"abc\x1b[2;3HZ\x1b[HY"}, true,
+     {"Ybc", "  Z"}, {NULL}},
+    {"CUP clipped",     {"\x1b[9;99HE"}, true,
+     {"", "", "", "         E"}, {NULL}},
+    {"CUU CUD CUF CUB", {"\x1b[2B\x1b[3CX\x1b[AY\x1b[2DZ"}, true,
+     {"", "   ZY", "   X"}, {NULL}},
+    {"EL",              {"abcdef\x1b[3D\x1b[K"}, true,
+     {"abc"}, {NULL}},
+    {"EL 1",            {"abcdef\x1b[3D\x1b[1K"}, true,
+     {"    ef"}, {NULL}},
+    {"ED",              {"11\n22\n33\x1b[2;2H\x1b[J"}, true,
+     {"11", "2"}, {NULL}},
+    {"ED 2",            {"11\n22\n33\x1b[2J"}, true,
+     {""}, {NULL}},
+    {"SGR",             {"\x1b[31;44mR\x1b[0mN\x1b[1;32mB\x1b[7mV\x1b[27;22;39m\x1b[103mD"}, true,
+     {"RNBVD"}, {"1470a00a7b"}},
+    {"SGR erase",       {"\x1b[43m\x1b[2J\x1b[49mab"}, true,
+     {"ab"}, {"70703333333333333333", "33333333333333333333", "33333333333333333333", "33333333333333333333"}},
+    {"ESC 7 / 8",       {"ab\x1b", "7\n\ncd\x1b", "8X"}, true,
+     {"abX", "", "cd"}, {NULL}},
+    {"split CSI",       {"\x1b[", "2;", "5HQ"}, true,
+     {"", "    Q"}, {NULL}},
+};
+
+static uint8_t * address;
+
+static void change_address(uint8_t * p_start) {
+    address = p_start;
+}
+
+static int hex(char c) {
+    return (c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10);
+}
+
+/* Draws the expected screen cell by cell */
+static void draw_expected(const console_case_t * p_case, int font_size, uint8_t * p_buf, int stride) {
+    int width = COLUMNS * AsciiFont::CHAR_PIX_WIDTH * font_size;
+    int height = ROWS * AsciiFont::CHAR_PIX_HEIGHT * font_size;
+    AsciiFont font(p_buf, width, height, stride, 1);
+    char str[2] = {' ', '\0'};
+    int x;
+    int y;
+
+    for (y = 0; y < ROWS; y++) {
+        const char * p_text = p_case->text[y];
+        const char * p_attr = p_case->attr[y];
+
+        for (x = 0; x < COLUMNS; x++) {
+            int fg = 7;
+            int bg = 0;
+
+            str[0] = ((p_text != NULL) && ((int)strlen(p_text) > x)) ? p_text[x] : ' ';
+            if ((p_attr != NULL) && ((int)strlen(p_attr) > (x * 2))) {
+                fg = hex(p_attr[x * 2]);
+                bg = hex(p_attr[(x * 2) + 1]);
+            }
+            font.SetBackground((uint32_t)bg);
+            (void)font.DrawStr(str, x * AsciiFont::CHAR_PIX_WIDTH * font_size,
+                               y * AsciiFont::CHAR_PIX_HEIGHT * font_size, (uint32_t)fg, font_size, 1);
+        }
+    }
+}
+
+static bool run_case(const console_case_t * p_case, TextConsole::scroll_mode_t mode, int font_size) {
+    int width = COLUMNS * AsciiFont::CHAR_PIX_WIDTH * font_size;
+    int height = ROWS * AsciiFont::CHAR_PIX_HEIGHT * font_size;
+    int stride = (width + 7) & ~7;
+    size_t visible_size = (size_t)stride * height;
+    std::vector<uint8_t> buf(visible_size * 2, 0xEE);
+    std::vector<uint8_t> expected(visible_size, 0xEE);
+    TextConsole console(&buf[0], width, height, stride, 1, font_size, mode);
+    bool address_ok = true;
+    int bad = 0;
+    size_t i;
+    int k;
+
+    address = NULL;
+    console.SetAddressFunc(callback(change_address));
+    console.SetAutoFlush(p_case->auto_flush);
+    console.Flush();
+    for (k = 0; (k < CHUNK_MAX) && (p_case->chunks[k] != NULL); k++) {
+        (void)console.write(p_case->chunks[k], strlen(p_case->chunks[k]));
+    }
+    if (!p_case->auto_flush) {
+        console.Flush();
+    }
+    draw_expected(p_case, font_size, &expected[0], stride);
+
+    for (i = 0; i < visible_size; i++) {
+        if (console.GetStartAddress()[i] != expected[i]) {
+            if (bad == 0) {
+                printf("    first error at (%d, %d): %02X, expected %02X\n", (int)(i % stride), (int)(i / stride),
+                       console.GetStartAddress()[i], expected[i]);
+            }
+            bad++;
+        }
+    }
+    if ((mode == TextConsole::SCROLL_ADDRESS) && (address != console.GetStartAddress())) {
+        address_ok = false;
+    }
+    printf("%-16s %-8s font_size %d  %5d pixels differ%s  %s\n", p_case->name,
+           (mode == TextConsole::SCROLL_ADDRESS) ? "address" : "memmove", font_size, bad,
+           address_ok ? "" : ", wrong address", ((bad == 0) && address_ok) ? "OK" : "NG");
+    return (bad == 0) && address_ok;
+}
+
+int main(void) {
+    int total = 0;
+    int fail = 0;
+    size_t i;
+    int mode;
+    int font_size;
+
+    for (i = 0; i < (sizeof(case_list) / sizeof(case_list[0])); i++) {
+        for (mode = 0; mode < 2; mode++) {
+            for (font_size = 1; font_size <= 2; font_size++) {
+                total++;
+                if (!run_case(&case_list[i], (mode == 0) ? TextConsole::SCROLL_MEMMOVE : TextConsole::SCROLL_ADDRESS,
+                              font_size)) {
+                    fail++;
+                }
+            }
+        }
+    }
+    printf("%d / %d cases passed\n", total - fail, total);
+    return (fail == 0) ? 0 : 1;
+}
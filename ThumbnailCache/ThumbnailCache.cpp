@@ -0,0 +1,560 @@
+/* mbed ThumbnailCache Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include <sys/stat.h>
+#include "dcache-control.h"
+#include "JPEG_Probe.h"
+#include "ThumbnailCache.h"
+
+#define CACHE_MAGIC             (0x424D4854u)   /* "THMB" */
+#define CACHE_VERSION           (2)
+#define CACHE_HEADER_SIZE       (32)
+#define SECTOR_ALIGN_UP(x)      (((x) + 511u) & ~511u)
+
+/* File header of the cache file */
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    width;
+    uint16_t    height;
+    uint8_t     format;
+    uint8_t     byte_per_pixel;
+    uint16_t    entry_max;
+    uint16_t    entry_num;
+    uint16_t    reserved0[2];
+    uint32_t    slot_size;
+    uint32_t    use_clock;
+    uint32_t    reserved1;
+} cache_header_t;
+
+static uint32_t path_hash(const char * path) {
+    uint32_t hash = 2166136261u;
+
+    while (*path != '\0') {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619u;
+    }
+    if (hash == 0) {
+        hash = 1;   // 0 is used for the unused entries
+    }
+
+    return hash;
+}
+
+ThumbnailCache::ThumbnailCache(JPEG_Converter * jcu, uint8_t * jpeg_buf, uint32_t jpeg_buf_size,
+                               uint8_t * work_buf, uint32_t work_buf_size) :
+    _jcu(jcu), _jpeg_buf(jpeg_buf), _jpeg_buf_size(jpeg_buf_size), _work_buf(work_buf), _work_buf_size(work_buf_size),
+    _fp(NULL), _index(NULL) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    close();
+}
+
+bool ThumbnailCache::open(const char * file_name, uint16_t width, uint16_t height,
+                          JPEG_Converter::wr_rd_format_t format, uint16_t entry_max) {
+    cache_header_t header;
+
+    if ((_fp != NULL) || (file_name == NULL) || (width == 0) || (height == 0) || (entry_max == 0)) {
+        return false;
+    }
+    if (format == JPEG_Converter::WR_RD_RGB565) {
+        _byte_per_pixel = 2;
+    } else if (format == JPEG_Converter::WR_RD_ARGB8888) {
+        _byte_per_pixel = 4;
+    } else {
+        return false;
+    }
+    _width = width;
+    _height = height;
+    _format = format;
+    _entry_max = entry_max;
+    _slot_size = SECTOR_ALIGN_UP(THUMBNAIL_CACHE_PATH_MAX + ((uint32_t)width * height * _byte_per_pixel));
+    _data_offset = SECTOR_ALIGN_UP(CACHE_HEADER_SIZE + (sizeof(index_entry_t) * entry_max));
+    memset(&_stats, 0, sizeof(_stats));
+
+    _index = new index_entry_t[entry_max];
+    if (_index == NULL) {
+        return false;
+    }
+
+    _fp = fopen(file_name, "r+b");
+    if ((_fp != NULL)
+     && (fread(&header, sizeof(header), 1, _fp) == 1)
+     && (header.magic == CACHE_MAGIC)
+     && (header.version == CACHE_VERSION)
+     && (header.width == width)
+     && (header.height == height)
+     && (header.format == (uint8_t)format)
+     && (header.entry_max == entry_max)
+     && (header.slot_size == _slot_size)
+     && (header.entry_num <= entry_max)
+     && (fseek(_fp, CACHE_HEADER_SIZE, SEEK_SET) == 0)
+     && (fread(_index, sizeof(index_entry_t), entry_max, _fp) == entry_max)) {
+        _entry_num = header.entry_num;
+        _use_clock = header.use_clock;
+        _dirty_first = -1;
+        _dirty_last = -1;
+        _unsaved_num = 0;
+        _stats.entry_num = _entry_num;
+        return true;
+    }
+
+    // Not a cache file of these parameters
+    if (_fp != NULL) {
+        fclose(_fp);
+    }
+    _fp = fopen(file_name, "w+b");
+    if ((_fp == NULL) || (!create_file())) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ThumbnailCache::close(void) {
+    if (_fp != NULL) {
+        (void)flush();
+        fclose(_fp);
+        _fp = NULL;
+    }
+    if (_index != NULL) {
+        delete [] _index;
+        _index = NULL;
+    }
+}
+
+bool ThumbnailCache::get(const char * path, uint8_t * dst, uint32_t dst_stride, int * p_width, int * p_height) {
+    struct stat st;
+    uint32_t hash;
+    uint32_t mtime;
+    uint32_t size;
+    int idx;
+    int width;
+    int height;
+
+    if ((_fp == NULL) || (path == NULL) || (dst == NULL) || (strlen(path) >= THUMBNAIL_CACHE_PATH_MAX)) {
+        return false;
+    }
+    // The fields which the file system does not set are left 0
+    memset(&st, 0, sizeof(st));
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    hash  = path_hash(path);
+    mtime = (uint32_t)st.st_mtime;
+    size  = (uint32_t)st.st_size;
+
+    idx = find_entry(hash, path, mtime, size);
+    if ((idx >= 0) && (_index[idx].mtime == mtime) && (_index[idx].size == size)) {
+        if (read_thumbnail(idx, dst, dst_stride)) {
+            _stats.hits++;
+            _index[idx].last_use = ++_use_clock;
+            set_dirty(idx);
+            if (p_width != NULL) {
+                *p_width = _index[idx].width;
+            }
+            if (p_height != NULL) {
+                *p_height = _index[idx].height;
+            }
+            return true;
+        }
+    }
+
+    // Not in the cache or the file has been changed
+    _stats.misses++;
+    if (!make_thumbnail(path, size, dst, dst_stride, &width, &height)) {
+        _stats.errors++;
+        return false;
+    }
+    if (idx < 0) {
+        idx = select_slot();
+    }
+    _index[idx].hash     = hash;
+    _index[idx].mtime    = mtime;
+    _index[idx].size     = size;
+    _index[idx].width    = (uint16_t)width;
+    _index[idx].height   = (uint16_t)height;
+    _index[idx].last_use = ++_use_clock;
+    if (!write_thumbnail(idx, path, dst, dst_stride)) {
+        _index[idx].hash = 0;
+    }
+    set_dirty(idx);
+    _unsaved_num++;
+    if (_unsaved_num >= THUMBNAIL_CACHE_FLUSH_MISSES) {
+        (void)flush();
+    }
+    _stats.entry_num = _entry_num;
+
+    if (p_width != NULL) {
+        *p_width = width;
+    }
+    if (p_height != NULL) {
+        *p_height = height;
+    }
+
+    return true;
+}
+
+void ThumbnailCache::get_stats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = _stats;
+    }
+}
+
+bool ThumbnailCache::flush(void) {
+    bool result = true;
+
+    if (_fp == NULL) {
+        return false;
+    }
+    if (_dirty_first >= 0) {
+        result = write_index(_dirty_first, _dirty_last) && write_header();
+        if (result) {
+            _dirty_first = -1;
+            _dirty_last = -1;
+            _unsaved_num = 0;
+        }
+    }
+    fflush(_fp);
+
+    return result;
+}
+
+bool ThumbnailCache::create_file(void) {
+    int i;
+
+    for (i = 0; i < _entry_max; i++) {
+        memset(&_index[i], 0, sizeof(index_entry_t));
+    }
+    _entry_num = 0;
+    _use_clock = 0;
+    _dirty_first = -1;
+    _dirty_last = -1;
+    _unsaved_num = 0;
+    if (!write_header()) {
+        return false;
+    }
+    if (fwrite(_index, sizeof(index_entry_t), _entry_max, _fp) != _entry_max) {
+        return false;
+    }
+    fflush(_fp);
+
+    return true;
+}
+
+bool ThumbnailCache::write_header(void) {
+    cache_header_t header;
+
+    memset(&header, 0, sizeof(header));
+    header.magic          = CACHE_MAGIC;
+    header.version        = CACHE_VERSION;
+    header.width          = _width;
+    header.height         = _height;
+    header.format         = (uint8_t)_format;
+    header.byte_per_pixel = (uint8_t)_byte_per_pixel;
+    header.entry_max      = _entry_max;
+    header.entry_num      = _entry_num;
+    header.slot_size      = _slot_size;
+    header.use_clock      = _use_clock;
+
+    if ((fseek(_fp, 0, SEEK_SET) != 0) || (fwrite(&header, sizeof(header), 1, _fp) != 1)) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Write the index entries from first to last with one fwrite() */
+bool ThumbnailCache::write_index(int first, int last) {
+    size_t num = (size_t)(last - first + 1);
+
+    if ((fseek(_fp, CACHE_HEADER_SIZE + (sizeof(index_entry_t) * first), SEEK_SET) != 0)
+     || (fwrite(&_index[first], sizeof(index_entry_t), num, _fp) != num)) {
+        return false;
+    }
+
+    return true;
+}
+
+void ThumbnailCache::set_dirty(int idx) {
+    if ((_dirty_first < 0) || (idx < _dirty_first)) {
+        _dirty_first = idx;
+    }
+    if (idx > _dirty_last) {
+        _dirty_last = idx;
+    }
+}
+
+/* Returns the slot for a new thumbnail: an unused slot (a failed write or a new one) or the least recently used */
+int ThumbnailCache::select_slot(void) {
+    int lru = 0;
+    int i;
+
+    for (i = 0; i < _entry_num; i++) {
+        if (_index[i].hash == 0) {
+            return i;
+        }
+    }
+    if (_entry_num < _entry_max) {
+        return _entry_num++;
+    }
+    for (i = 1; i < _entry_num; i++) {
+        // The difference from _use_clock is the age, which also works after _use_clock wraps around
+        if ((_use_clock - _index[i].last_use) > (_use_clock - _index[lru].last_use)) {
+            lru = i;
+        }
+    }
+
+    return lru;
+}
+
+/* Returns the entry of the path (the modification time may be different), or -1 */
+int ThumbnailCache::find_entry(uint32_t hash, const char * path, uint32_t mtime, uint32_t size) {
+    char entry_path[THUMBNAIL_CACHE_PATH_MAX];
+    int stale = -1;
+    int i;
+
+    for (i = 0; i < _entry_num; i++) {
+        if (_index[i].hash != hash) {
+            continue;
+        }
+        // The path is checked only when the hash matches
+        if ((fseek(_fp, _data_offset + (_slot_size * i), SEEK_SET) != 0)
+         || (fread(entry_path, 1, sizeof(entry_path), _fp) != sizeof(entry_path))) {
+            continue;
+        }
+        entry_path[THUMBNAIL_CACHE_PATH_MAX - 1] = '\0';
+        if (strcmp(entry_path, path) != 0) {
+            continue;
+        }
+        if ((_index[i].mtime == mtime) && (_index[i].size == size)) {
+            return i;
+        }
+        stale = i;
+    }
+
+    return stale;
+}
+
+bool ThumbnailCache::read_thumbnail(int idx, uint8_t * dst, uint32_t dst_stride) {
+    uint32_t line_size = _index[idx].width * _byte_per_pixel;
+    int y;
+
+    if (fseek(_fp, _data_offset + (_slot_size * idx) + THUMBNAIL_CACHE_PATH_MAX, SEEK_SET) != 0) {
+        return false;
+    }
+    if (dst_stride == line_size) {
+        return (fread(dst, 1, line_size * _index[idx].height, _fp) == (line_size * _index[idx].height));
+    }
+    for (y = 0; y < _index[idx].height; y++) {
+        if (fread(&dst[dst_stride * y], 1, line_size, _fp) != line_size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ThumbnailCache::write_thumbnail(int idx, const char * path, const uint8_t * src, uint32_t src_stride) {
+    char entry_path[THUMBNAIL_CACHE_PATH_MAX];
+    uint32_t line_size = _index[idx].width * _byte_per_pixel;
+    int y;
+
+    memset(entry_path, 0, sizeof(entry_path));
+    strncpy(entry_path, path, sizeof(entry_path) - 1);
+    if ((fseek(_fp, _data_offset + (_slot_size * idx), SEEK_SET) != 0)
+     || (fwrite(entry_path, 1, sizeof(entry_path), _fp) != sizeof(entry_path))) {
+        return false;
+    }
+    for (y = 0; y < _index[idx].height; y++) {
+        if (fwrite(&src[src_stride * y], 1, line_size, _fp) != line_size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ThumbnailCache::make_thumbnail(const char * path, uint32_t file_size, uint8_t * dst, uint32_t dst_stride,
+                                    int * p_width, int * p_height) {
+    JPEG_Probe::jpeg_info_t info;
+    JPEG_Probe::output_plan_t plan;
+    JPEG_Converter::decode_options_t options;
+    JPEG_Converter::bitmap_buff_info_t bitmap;
+    FILE * fp;
+    size_t read_size;
+    int dst_w;
+    int dst_h;
+    int hs;
+    int vs;
+
+    if ((file_size == 0) || (file_size > _jpeg_buf_size)) {
+        return false;
+    }
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    read_size = fread(_jpeg_buf, 1, file_size, fp);
+    fclose(fp);
+    if (read_size != file_size) {
+        return false;
+    }
+    if ((JPEG_Probe::Probe(_jpeg_buf, read_size, &info) != JPEG_Converter::JPEG_CONV_OK) || (!info.jcu_supported)) {
+        return false;
+    }
+
+    // Thumbnail size keeping the aspect ratio
+    if (((uint32_t)info.width * _height) >= ((uint32_t)info.height * _width)) {
+        dst_w = (info.width < _width) ? info.width : _width;
+        dst_h = (int)(((uint32_t)info.height * dst_w) / info.width);
+    } else {
+        dst_h = (info.height < _height) ? info.height : _height;
+        dst_w = (int)(((uint32_t)info.width * dst_h) / info.height);
+    }
+    if (dst_w < 1) {
+        dst_w = 1;
+    }
+    if (dst_h < 1) {
+        dst_h = 1;
+    }
+
+    // The largest sub-sampling whose output is not smaller than the thumbnail
+    for (hs = 3; hs > 0; hs--) {
+        if (((info.width + (1 << hs) - 1) >> hs) >= dst_w) {
+            break;
+        }
+    }
+    for (vs = 3; vs > 0; vs--) {
+        if (((info.height + (1 << vs) - 1) >> vs) >= dst_h) {
+            break;
+        }
+    }
+    while (true) {
+        options.horizontal_sub_sampling = (JPEG_Converter::sub_sampling_t)hs;
+        options.vertical_sub_sampling   = (JPEG_Converter::sub_sampling_t)vs;
+        if (JPEG_Probe::GetOutputPlan(&info, _format, &options, &plan) != JPEG_Converter::JPEG_CONV_OK) {
+            return false;
+        }
+        if (plan.buffer_size <= _work_buf_size) {
+            break;
+        }
+        // The work buffer is too small: reduce more
+        if ((hs >= 3) && (vs >= 3)) {
+            return false;
+        }
+        if (hs < 3) {
+            hs++;
+        }
+        if (vs < 3) {
+            vs++;
+        }
+    }
+    if (dst_w > plan.image_width) {
+        dst_w = plan.image_width;
+    }
+    if (dst_h > plan.image_height) {
+        dst_h = plan.image_height;
+    }
+
+    dcache_clean(_jpeg_buf, read_size);
+    bitmap.width          = plan.width;
+    bitmap.height         = plan.height;
+    bitmap.format         = _format;
+    bitmap.buffer_address = (void *)_work_buf;
+    if (_jcu->decode((void *)_jpeg_buf, &bitmap, &options) != JPEG_Converter::JPEG_CONV_OK) {
+        return false;
+    }
+    dcache_invalid(_work_buf, plan.buffer_size);
+
+    box_downscale(_work_buf, plan.width * _byte_per_pixel, plan.image_width, plan.image_height,
+                  dst, dst_stride, dst_w, dst_h);
+    *p_width = dst_w;
+    *p_height = dst_h;
+
+    return true;
+}
+
+/* The pixels are in the default output of the JCU (WR_RD_WRSWA_8BIT), that is little-endian.
+ * ARGB8888 is averaged for each byte. */
+void ThumbnailCache::box_downscale(const uint8_t * src, uint32_t src_stride, int src_w, int src_h,
+                                   uint8_t * dst, uint32_t dst_stride, int dst_w, int dst_h) {
+    const uint8_t * p_src;
+    uint8_t * p_dst;
+    uint32_t sum[4];
+    uint32_t pix;
+    uint32_t num;
+    int x0, x1, y0, y1;
+    int x, y, sx, sy, i;
+
+    for (y = 0; y < dst_h; y++) {
+        y0 = (y * src_h) / dst_h;
+        y1 = ((y + 1) * src_h) / dst_h;
+        if (y1 <= y0) {
+            y1 = y0 + 1;
+        }
+        p_dst = &dst[dst_stride * y];
+        for (x = 0; x < dst_w; x++) {
+            x0 = (x * src_w) / dst_w;
+            x1 = ((x + 1) * src_w) / dst_w;
+            if (x1 <= x0) {
+                x1 = x0 + 1;
+            }
+            sum[0] = 0;
+            sum[1] = 0;
+            sum[2] = 0;
+            sum[3] = 0;
+            num = (uint32_t)((x1 - x0) * (y1 - y0));
+            if (_byte_per_pixel == 2) {
+                for (sy = y0; sy < y1; sy++) {
+                    p_src = &src[(src_stride * sy) + (x0 * 2)];
+                    for (sx = x0; sx < x1; sx++) {
+                        pix = p_src[0] | ((uint32_t)p_src[1] << 8);
+                        sum[0] += (pix >> 11) & 0x1F;
+                        sum[1] += (pix >> 5) & 0x3F;
+                        sum[2] += pix & 0x1F;
+                        p_src += 2;
+                    }
+                }
+                pix = (((sum[0] + (num / 2)) / num) << 11)
+                    | (((sum[1] + (num / 2)) / num) << 5)
+                    | ((sum[2] + (num / 2)) / num);
+                p_dst[0] = (uint8_t)pix;
+                p_dst[1] = (uint8_t)(pix >> 8);
+                p_dst += 2;
+            } else {
+                for (sy = y0; sy < y1; sy++) {
+                    p_src = &src[(src_stride * sy) + (x0 * 4)];
+                    for (sx = x0; sx < x1; sx++) {
+                        sum[0] += p_src[0];
+                        sum[1] += p_src[1];
+                        sum[2] += p_src[2];
+                        sum[3] += p_src[3];
+                        p_src += 4;
+                    }
+                }
+                for (i = 0; i < 4; i++) {
+                    p_dst[i] = (uint8_t)((sum[i] + (num / 2)) / num);
+                }
+                p_dst += 4;
+            }
+        }
+    }
+}
@@ -0,0 +1,198 @@
+/* mbed ThumbnailCache Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          ThumbnailCache.h
+* @brief         JPEG thumbnail cache
+******************************************************************************/
+#ifndef __THUMBNAIL_CACHE_H__
+#define __THUMBNAIL_CACHE_H__
+
+#include "mbed.h"
+#include "JPEG_Converter.h"
+
+/** Maximum length of the source file path stored in the cache (including '\0') */
+#ifndef THUMBNAIL_CACHE_PATH_MAX
+#define THUMBNAIL_CACHE_PATH_MAX    (128)
+#endif
+
+/** Number of new thumbnails kept in the index in RAM before the index is written to the cache file */
+#ifndef THUMBNAIL_CACHE_FLUSH_MISSES
+#define THUMBNAIL_CACHE_FLUSH_MISSES    (16)
+#endif
+
+/** A class to make thumbnails of JPEG files and keep them in a cache file
+ *
+ * The JPEG is decoded with the largest JCU sub-sampling (1/2, 1/4, 1/8) whose output still
+ * covers the thumbnail size, and the result is reduced by a box filter.
+ * The thumbnails are stored in one cache file with an index. Each entry is keyed by the path,
+ * the modification time and the size of the source file (stat()), so a changed file is decoded again.
+ * FATFileSystem of mbed-os does not set the modification time (st_mtime is 0), so on the FAT file system
+ * the entries are keyed by the path and the size only: a file rewritten with the same size keeps its old
+ * thumbnail until the cache file is deleted.
+ * The index is read at open(), so showing a folder of thumbnails reads only the cache file.
+ * When the cache file is full, the least recently used thumbnail is replaced.
+ * The index is kept in RAM and written to the cache file by flush(), by close(), and after
+ * THUMBNAIL_CACHE_FLUSH_MISSES new thumbnails, so a miss writes only the thumbnail.
+ * If the index is not written (power off), the thumbnails made after the last flush are made again:
+ * each slot holds the path, so an old index entry never returns the thumbnail of another file.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "SdUsbConnect.h"
+ * #include "ThumbnailCache.h"
+ *
+ * static uint8_t jpeg_buf[1024 * 256] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t work_buf[1024 * 256] __attribute((section("NC_BSS"),aligned(32)));
+ * static uint8_t thumb_buf[80 * 60 * 2];
+ *
+ * JPEG_Converter Jcu;
+ * ThumbnailCache thumbnail(&Jcu, jpeg_buf, sizeof(jpeg_buf), work_buf, sizeof(work_buf));
+ *
+ * int main() {
+ *     SdUsbConnect storage("storage");
+ *     int w, h;
+ *
+ *     storage.wait_connect();
+ *     thumbnail.open("/storage/thumbs.dat", 80, 60);
+ *     if (thumbnail.get("/storage/DCIM/0001.jpg", thumb_buf, 80 * 2, &w, &h)) {
+ *         // draw thumb_buf (w x h, RGB565)
+ *     }
+ *     thumbnail.close();
+ * }
+ * @endcode
+ */
+class ThumbnailCache {
+public:
+    /*! @struct stats_t
+        @brief Cache statistics
+     */
+    typedef struct {
+        uint32_t    hits;               /*!< Number of thumbnails read from the cache file */
+        uint32_t    misses;             /*!< Number of thumbnails made from the JPEG */
+        uint32_t    errors;             /*!< Number of files which could not be decoded */
+        uint32_t    entry_num;          /*!< Number of entries in the cache file */
+    } stats_t;
+
+    /** Constructor
+     *
+     * The JCU reads jpeg_buf and writes work_buf, so non-cacheable memory is recommended.
+     *
+     * @param jcu JPEG converter
+     * @param jpeg_buf buffer to read a JPEG file (32 byte aligned)
+     * @param jpeg_buf_size size of jpeg_buf (maximum JPEG file size)
+     * @param work_buf buffer to decode (32 byte aligned)
+     * @param work_buf_size size of work_buf
+     */
+    ThumbnailCache(JPEG_Converter * jcu, uint8_t * jpeg_buf, uint32_t jpeg_buf_size,
+                   uint8_t * work_buf, uint32_t work_buf_size);
+
+    /** Destructor
+     */
+    virtual ~ThumbnailCache();
+
+    /** Open the cache file
+     *
+     * If the file does not exist or was made with other parameters, a new file is created.
+     *
+     * @param file_name cache file name
+     * @param width maximum width of the thumbnails
+     * @param height maximum height of the thumbnails
+     * @param format WR_RD_RGB565 or WR_RD_ARGB8888
+     * @param entry_max number of thumbnails in the cache file (the least recently used one is replaced)
+     * @return true = success, false = failure
+     */
+    bool open(const char * file_name, uint16_t width, uint16_t height,
+              JPEG_Converter::wr_rd_format_t format = JPEG_Converter::WR_RD_RGB565, uint16_t entry_max = 256);
+
+    /** Close the cache file
+     *
+     * The index is written to the cache file.
+     */
+    void close(void);
+
+    /** Write the index to the cache file
+     *
+     * @return true = success, false = failure
+     */
+    bool flush(void);
+
+    /** Get the thumbnail of a JPEG file
+     *
+     * The aspect ratio is kept, so the thumbnail is equal to or smaller than the size of open().
+     *
+     * @param path path of the JPEG file
+     * @param dst buffer of the thumbnail
+     * @param dst_stride line offset of dst (byte)
+     * @param p_width width of the thumbnail
+     * @param p_height height of the thumbnail
+     * @return true = success, false = failure
+     */
+    bool get(const char * path, uint8_t * dst, uint32_t dst_stride, int * p_width, int * p_height);
+
+    /** Get the cache statistics
+     *
+     * @param p_stats statistics
+     */
+    void get_stats(stats_t * p_stats);
+
+private:
+    typedef struct {
+        uint32_t    hash;               /* FNV-1a hash of the path (0: unused) */
+        uint32_t    mtime;              /* 0 if the file system does not set it */
+        uint32_t    size;
+        uint16_t    width;
+        uint16_t    height;
+        uint32_t    last_use;           /* _use_clock of the last get() */
+    } index_entry_t;
+
+    JPEG_Converter * _jcu;
+    uint8_t * _jpeg_buf;
+    uint32_t _jpeg_buf_size;
+    uint8_t * _work_buf;
+    uint32_t _work_buf_size;
+    FILE * _fp;
+    index_entry_t * _index;
+    uint16_t _width;
+    uint16_t _height;
+    JPEG_Converter::wr_rd_format_t _format;
+    uint32_t _byte_per_pixel;
+    uint16_t _entry_max;
+    uint16_t _entry_num;
+    uint32_t _use_clock;
+    int _dirty_first;                   /* Range of the index entries not written to the file, -1 = none */
+    int _dirty_last;
+    int _unsaved_num;                   /* Number of the new thumbnails after the last flush() */
+    uint32_t _slot_size;
+    uint32_t _data_offset;
+    stats_t _stats;
+
+    bool create_file(void);
+    bool write_header(void);
+    bool write_index(int first, int last);
+    void set_dirty(int idx);
+    int select_slot(void);
+    int find_entry(uint32_t hash, const char * path, uint32_t mtime, uint32_t size);
+    bool read_thumbnail(int idx, uint8_t * dst, uint32_t dst_stride);
+    bool make_thumbnail(const char * path, uint32_t file_size, uint8_t * dst, uint32_t dst_stride,
+                        int * p_width, int * p_height);
+    bool write_thumbnail(int idx, const char * path, const uint8_t * src, uint32_t src_stride);
+    void box_downscale(const uint8_t * src, uint32_t src_stride, int src_w, int src_h,
+                       uint8_t * dst, uint32_t dst_stride, int dst_w, int dst_h);
+};
+
+#endif
@@ -0,0 +1,613 @@
+/* mbed UnicodeFont Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "UnicodeFont.h"
+
+#define FONT_MAGIC              (0x544E4655u)   /* "UFNT" */
+#define FONT_VERSION            (1)
+#define FONT_HEADER_SIZE        (36)
+#define GLYPH_ENTRY_SIZE        (16)
+#define KERNING_ENTRY_SIZE      (12)
+#define REPLACEMENT_CHAR        (0xFFFDu)
+
+static inline uint32_t get_le16(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* v / 255 (rounded) for v = 0 - 65025 */
+static inline uint32_t div255(uint32_t v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+static inline uint32_t hash_code(uint32_t code) {
+    return (code * 2654435761u) >> 8;
+}
+
+UnicodeFont::UnicodeFont(uint8_t * p_buf, int width, int height, int stride, pixel_format_t format, int cache_num) :
+    _p_buf(p_buf), _width(width), _height(height), _stride(stride), _format(format), _cache_num(cache_num),
+    _fp(NULL), _p_data(NULL), _p_index(NULL), _p_glyph_index(NULL), _p_kerning(NULL), _glyph_num(0), _kerning_num(0),
+    _bitmap_offset(0), _default_code(0), _bpp(1), _max_width(0), _max_height(0), _line_height(0), _ascent(0),
+    _glyph(NULL), _coverage(NULL), _read_buf(NULL), _hash(NULL), _hash_mask(0), _use_count(0) {
+    if (_cache_num <= 0) {
+        _cache_num = 1;
+    }
+    if (_cache_num > 0x7FFF) {
+        _cache_num = 0x7FFF;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+UnicodeFont::~UnicodeFont() {
+    Close();
+}
+
+bool UnicodeFont::Open(const char * file_name) {
+    uint8_t header[FONT_HEADER_SIZE];
+    uint32_t glyph_num;
+    uint32_t kerning_num;
+
+    Close();
+    _fp = fopen(file_name, "rb");
+    if (_fp == NULL) {
+        return false;
+    }
+    if ((fread(header, 1, sizeof(header), _fp) != sizeof(header)) || (!open_common(header, 0))) {
+        Close();
+        return false;
+    }
+
+    // The glyph index and the kerning table are kept in RAM
+    glyph_num = get_le32(&header[16]);
+    kerning_num = get_le32(&header[20]);
+    _p_index = (uint8_t *)malloc((glyph_num * GLYPH_ENTRY_SIZE) + (kerning_num * KERNING_ENTRY_SIZE) + 1);
+    _read_buf = (uint8_t *)malloc((((_max_width * _bpp) + 7) / 8) * _max_height);
+    if ((_p_index == NULL) || (_read_buf == NULL)
+     || (fseek(_fp, get_le32(&header[24]), SEEK_SET) != 0)
+     || (fread(_p_index, GLYPH_ENTRY_SIZE, glyph_num, _fp) != glyph_num)
+     || ((kerning_num > 0) && (fseek(_fp, get_le32(&header[28]), SEEK_SET) != 0))
+     || ((kerning_num > 0) && (fread(&_p_index[glyph_num * GLYPH_ENTRY_SIZE], KERNING_ENTRY_SIZE, kerning_num, _fp)
+                               != kerning_num))) {
+        Close();
+        return false;
+    }
+    _p_glyph_index = _p_index;
+    _p_kerning = &_p_index[glyph_num * GLYPH_ENTRY_SIZE];
+
+    return true;
+}
+
+bool UnicodeFont::Open(const void * p_data, uint32_t size) {
+    const uint8_t * p_font = (const uint8_t *)p_data;
+    uint32_t index_end;
+    uint32_t kerning_end;
+
+    Close();
+    if ((p_font == NULL) || (size < FONT_HEADER_SIZE) || (!open_common(p_font, size))) {
+        Close();
+        return false;
+    }
+    index_end = get_le32(&p_font[24]) + (_glyph_num * GLYPH_ENTRY_SIZE);
+    kerning_end = get_le32(&p_font[28]) + (_kerning_num * KERNING_ENTRY_SIZE);
+    if ((index_end > size) || ((_kerning_num > 0) && (kerning_end > size)) || (_bitmap_offset > size)) {
+        Close();
+        return false;
+    }
+    _p_data = p_font;
+    _p_glyph_index = &p_font[get_le32(&p_font[24])];
+    _p_kerning = &p_font[get_le32(&p_font[28])];
+
+    return true;
+}
+
+bool UnicodeFont::open_common(const uint8_t * p_header, uint32_t size) {
+    int hash_num = 1;
+    int i;
+
+    if ((get_le32(&p_header[0]) != FONT_MAGIC) || (p_header[4] != FONT_VERSION)
+     || ((p_header[5] != 1) && (p_header[5] != 4)) || (p_header[6] == 0) || (p_header[7] == 0)) {
+        return false;
+    }
+    _bpp           = p_header[5];
+    _max_width     = p_header[6];
+    _max_height    = p_header[7];
+    _line_height   = get_le16(&p_header[8]);
+    _ascent        = get_le16(&p_header[10]);
+    _default_code  = get_le32(&p_header[12]);
+    _glyph_num     = get_le32(&p_header[16]);
+    _kerning_num   = get_le32(&p_header[20]);
+    _bitmap_offset = get_le32(&p_header[32]);
+    (void)size;
+
+    while (hash_num < (_cache_num * 2)) {
+        hash_num <<= 1;
+    }
+    _glyph = (glyph_t *)malloc(sizeof(glyph_t) * _cache_num);
+    _coverage = (uint8_t *)malloc(_max_width * _max_height * _cache_num);
+    _hash = (int16_t *)malloc(sizeof(int16_t) * hash_num);
+    if ((_glyph == NULL) || (_coverage == NULL) || (_hash == NULL)) {
+        return false;
+    }
+    _hash_mask = hash_num - 1;
+    for (i = 0; i < hash_num; i++) {
+        _hash[i] = -1;
+    }
+    for (i = 0; i < _cache_num; i++) {
+        _glyph[i].used = false;
+    }
+
+    return true;
+}
+
+void UnicodeFont::Close(void) {
+    if (_fp != NULL) {
+        fclose(_fp);
+        _fp = NULL;
+    }
+    free(_p_index);
+    free(_read_buf);
+    free(_glyph);
+    free(_coverage);
+    free(_hash);
+    _p_index = NULL;
+    _read_buf = NULL;
+    _glyph = NULL;
+    _coverage = NULL;
+    _hash = NULL;
+    _p_data = NULL;
+    _p_glyph_index = NULL;
+    _p_kerning = NULL;
+    _glyph_num = 0;
+    _kerning_num = 0;
+}
+
+void UnicodeFont::SetTextField(uint8_t * p_buf, int width, int height, int stride) {
+    _p_buf  = p_buf;
+    _width  = width;
+    _height = height;
+    _stride = stride;
+}
+
+void UnicodeFont::GetStats(stats_t * p_stats) {
+    if (p_stats != NULL) {
+        *p_stats = _stats;
+    }
+}
+
+void UnicodeFont::Erase(uint32_t const colour) {
+    Erase(colour, 0, 0, _width, _height);
+}
+
+void UnicodeFont::Erase(uint32_t const colour, int x, int y, int width, int height) {
+    uint8_t * p_line;
+    int i, j;
+
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+    if (y < 0) {
+        height += y;
+        y = 0;
+    }
+    if ((x + width) > _width) {
+        width = _width - x;
+    }
+    if ((y + height) > _height) {
+        height = _height - y;
+    }
+    if ((width <= 0) || (height <= 0)) {
+        return;
+    }
+    for (i = 0; i < height; i++) {
+        p_line = &_p_buf[(_stride * (y + i))];
+        if (_format == FORMAT_RGB565) {
+            for (j = 0; j < width; j++) {
+                ((uint16_t *)p_line)[x + j] = (uint16_t)colour;
+            }
+        } else if (_format == FORMAT_ARGB8888) {
+            for (j = 0; j < width; j++) {
+                ((uint32_t *)p_line)[x + j] = colour;
+            }
+        } else {
+            memset(&p_line[x], (uint8_t)colour, width);
+        }
+    }
+}
+
+uint32_t UnicodeFont::DecodeUtf8(const char ** p_str) {
+    const uint8_t * p = (const uint8_t *)*p_str;
+    uint32_t code;
+    uint32_t min_code;
+    int num;
+    int i;
+
+    if (p[0] == 0) {
+        return 0;
+    }
+    if (p[0] < 0x80) {
+        *p_str += 1;
+        return p[0];
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        code = p[0] & 0x1F;
+        num = 1;
+        min_code = 0x80;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        code = p[0] & 0x0F;
+        num = 2;
+        min_code = 0x800;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        code = p[0] & 0x07;
+        num = 3;
+        min_code = 0x10000;
+    } else {
+        *p_str += 1;
+        return REPLACEMENT_CHAR;
+    }
+    for (i = 1; i <= num; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            // Resume from the byte which is not a continuation byte
+            *p_str += i;
+            return REPLACEMENT_CHAR;
+        }
+        code = (code << 6) | (p[i] & 0x3F);
+    }
+    *p_str += num + 1;
+    if ((code < min_code) || (code > 0x10FFFF) || ((code >= 0xD800) && (code <= 0xDFFF))) {
+        return REPLACEMENT_CHAR;
+    }
+
+    return code;
+}
+
+int UnicodeFont::DrawStr(const char * str, int x, int y, uint32_t const colour, uint16_t const max_char_num) {
+    const glyph_t * p_glyph;
+    uint32_t code;
+    uint32_t prev_code = 0;
+    int char_num = 0;
+    int pen_x = x;
+    int right;
+
+    if ((str == NULL) || (_glyph == NULL)) {
+        return 0;
+    }
+    while (char_num < max_char_num) {
+        code = DecodeUtf8(&str);
+        if (code == 0) {
+            break;
+        }
+        p_glyph = get_glyph(code);
+        if (p_glyph == NULL) {
+            code = _default_code;
+            p_glyph = get_glyph(code);
+            if (p_glyph == NULL) {
+                continue;
+            }
+        }
+        if (prev_code != 0) {
+            pen_x += get_kerning(prev_code, code);
+        }
+        right = pen_x + p_glyph->x_offset + p_glyph->width;
+        if (right < (pen_x + p_glyph->advance)) {
+            right = pen_x + p_glyph->advance;
+        }
+        if (right > _width) {
+            break;
+        }
+        blit(p_glyph, &_coverage[(p_glyph - _glyph) * _max_width * _max_height], pen_x, y, colour);
+        pen_x += p_glyph->advance;
+        prev_code = code;
+        char_num++;
+    }
+
+    return char_num;
+}
+
+int UnicodeFont::DrawChar(uint32_t code, int x, int y, uint32_t const colour) {
+    const glyph_t * p_glyph;
+
+    if (_glyph == NULL) {
+        return -1;
+    }
+    p_glyph = get_glyph(code);
+    if (p_glyph == NULL) {
+        return -1;
+    }
+    blit(p_glyph, &_coverage[(p_glyph - _glyph) * _max_width * _max_height], x, y, colour);
+
+    return p_glyph->advance;
+}
+
+int UnicodeFont::GetStrWidth(const char * str, uint16_t const max_char_num) {
+    const glyph_t * p_glyph;
+    uint32_t code;
+    uint32_t prev_code = 0;
+    int char_num = 0;
+    int width = 0;
+
+    if ((str == NULL) || (_glyph == NULL)) {
+        return 0;
+    }
+    while (char_num < max_char_num) {
+        code = DecodeUtf8(&str);
+        if (code == 0) {
+            break;
+        }
+        p_glyph = get_glyph(code);
+        if (p_glyph == NULL) {
+            code = _default_code;
+            p_glyph = get_glyph(code);
+            if (p_glyph == NULL) {
+                continue;
+            }
+        }
+        if (prev_code != 0) {
+            width += get_kerning(prev_code, code);
+        }
+        width += p_glyph->advance;
+        prev_code = code;
+        char_num++;
+    }
+
+    return width;
+}
+
+const UnicodeFont::glyph_t * UnicodeFont::get_glyph(uint32_t code) {
+    const uint8_t * p_entry;
+    int16_t * p_link;
+    uint32_t bucket = hash_code(code) & _hash_mask;
+    int idx;
+    int i;
+
+    for (idx = _hash[bucket]; idx >= 0; idx = _glyph[idx].next) {
+        if (_glyph[idx].code == code) {
+            _use_count++;
+            _glyph[idx].last_use = _use_count;
+            _stats.hits++;
+            return &_glyph[idx];
+        }
+    }
+
+    p_entry = find_index(code);
+    if (p_entry == NULL) {
+        return NULL;
+    }
+    _stats.misses++;
+
+    // A free entry, or the least recently used glyph
+    idx = -1;
+    for (i = 0; i < _cache_num; i++) {
+        if (!_glyph[i].used) {
+            idx = i;
+            break;
+        }
+        if ((idx < 0) || ((int32_t)(_glyph[i].last_use - _glyph[idx].last_use) < 0)) {
+            idx = i;
+        }
+    }
+    if (_glyph[idx].used) {
+        p_link = &_hash[hash_code(_glyph[idx].code) & _hash_mask];
+        while (*p_link != idx) {
+            p_link = &_glyph[*p_link].next;
+        }
+        *p_link = _glyph[idx].next;
+        _glyph[idx].used = false;
+        _stats.evictions++;
+    }
+
+    if (!load_glyph(idx, p_entry)) {
+        _stats.errors++;
+        return NULL;
+    }
+    _use_count++;
+    _glyph[idx].code     = code;
+    _glyph[idx].used     = true;
+    _glyph[idx].last_use = _use_count;
+    _glyph[idx].next     = _hash[bucket];
+    _hash[bucket] = (int16_t)idx;
+
+    return &_glyph[idx];
+}
+
+const uint8_t * UnicodeFont::find_index(uint32_t code) {
+    const uint8_t * p_entry;
+    uint32_t low = 0;
+    uint32_t high = _glyph_num;
+    uint32_t mid;
+    uint32_t wk_code;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        p_entry = &_p_glyph_index[mid * GLYPH_ENTRY_SIZE];
+        wk_code = get_le32(p_entry);
+        if (wk_code == code) {
+            return p_entry;
+        } else if (wk_code < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+int UnicodeFont::get_kerning(uint32_t left, uint32_t right) {
+    const uint8_t * p_entry;
+    uint32_t low = 0;
+    uint32_t high = _kerning_num;
+    uint32_t mid;
+    uint32_t wk_left;
+    uint32_t wk_right;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        p_entry = &_p_kerning[mid * KERNING_ENTRY_SIZE];
+        wk_left = get_le32(&p_entry[0]);
+        wk_right = get_le32(&p_entry[4]);
+        if ((wk_left == left) && (wk_right == right)) {
+            return (int16_t)get_le16(&p_entry[8]);
+        } else if ((wk_left < left) || ((wk_left == left) && (wk_right < right))) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return 0;
+}
+
+bool UnicodeFont::load_glyph(int idx, const uint8_t * p_entry) {
+    glyph_t * p_glyph = &_glyph[idx];
+    uint8_t * p_coverage = &_coverage[idx * _max_width * _max_height];
+    const uint8_t * p_bitmap;
+    uint32_t offset = _bitmap_offset + get_le32(&p_entry[4]);
+    uint32_t line_size;
+    uint32_t bits;
+    int i, j;
+
+    p_glyph->width    = p_entry[8];
+    p_glyph->height   = p_entry[9];
+    p_glyph->x_offset = (int8_t)p_entry[10];
+    p_glyph->y_offset = (int8_t)p_entry[11];
+    p_glyph->advance  = p_entry[12];
+    if ((p_glyph->width > _max_width) || (p_glyph->height > _max_height)) {
+        return false;
+    }
+    line_size = ((p_glyph->width * _bpp) + 7) / 8;
+    if ((line_size * p_glyph->height) == 0) {
+        return true;    // space
+    }
+
+    if (_p_data != NULL) {
+        p_bitmap = &_p_data[offset];
+    } else {
+        if ((fseek(_fp, offset, SEEK_SET) != 0)
+         || (fread(_read_buf, 1, line_size * p_glyph->height, _fp) != (line_size * p_glyph->height))) {
+            return false;
+        }
+        p_bitmap = _read_buf;
+    }
+
+    // Convert to 8-bit coverage
+    for (i = 0; i < p_glyph->height; i++) {
+        for (j = 0; j < p_glyph->width; j++) {
+            if (_bpp == 1) {
+                bits = (p_bitmap[j >> 3] >> (7 - (j & 7))) & 0x01;
+                p_coverage[j] = bits ? 255 : 0;
+            } else {
+                bits = (p_bitmap[j >> 1] >> ((j & 1) ? 0 : 4)) & 0x0F;
+                p_coverage[j] = (uint8_t)(bits * 17);
+            }
+        }
+        p_bitmap += line_size;
+        p_coverage += _max_width;
+    }
+
+    return true;
+}
+
+void UnicodeFont::blit(const glyph_t * p_glyph, const uint8_t * p_coverage, int x, int y, uint32_t colour) {
+    int x0 = x + p_glyph->x_offset;
+    int y0 = y + _ascent - p_glyph->y_offset;
+    int i_start = 0;
+    int i_end = p_glyph->height;
+    int j_start = 0;
+    int j_end = p_glyph->width;
+    uint32_t src_r, src_g, src_b, src_a;
+    uint32_t a, d;
+    uint8_t * p_line;
+    const uint8_t * p_cov;
+    int i, j;
+
+    if (y0 < 0) {
+        i_start = -y0;
+    }
+    if ((y0 + i_end) > _height) {
+        i_end = _height - y0;
+    }
+    if (x0 < 0) {
+        j_start = -x0;
+    }
+    if ((x0 + j_end) > _width) {
+        j_end = _width - x0;
+    }
+
+    if (_format == FORMAT_RGB565) {
+        src_r = (colour >> 11) & 0x1F;
+        src_g = (colour >> 5) & 0x3F;
+        src_b = colour & 0x1F;
+        for (i = i_start; i < i_end; i++) {
+            p_line = &_p_buf[_stride * (y0 + i)];
+            p_cov = &p_coverage[_max_width * i];
+            for (j = j_start; j < j_end; j++) {
+                a = p_cov[j];
+                if (a == 0) {
+                    continue;
+                }
+                uint16_t * p_pix = &((uint16_t *)p_line)[x0 + j];
+                if (a == 255) {
+                    *p_pix = (uint16_t)colour;
+                } else {
+                    d = *p_pix;
+                    *p_pix = (uint16_t)((div255((src_r * a) + (((d >> 11) & 0x1F) * (255 - a))) << 11)
+                                      | (div255((src_g * a) + (((d >> 5) & 0x3F) * (255 - a))) << 5)
+                                      | div255((src_b * a) + ((d & 0x1F) * (255 - a))));
+                }
+            }
+        }
+    } else if (_format == FORMAT_ARGB8888) {
+        src_a = (colour >> 24) & 0xFF;
+        src_r = (colour >> 16) & 0xFF;
+        src_g = (colour >> 8) & 0xFF;
+        src_b = colour & 0xFF;
+        for (i = i_start; i < i_end; i++) {
+            p_line = &_p_buf[_stride * (y0 + i)];
+            p_cov = &p_coverage[_max_width * i];
+            for (j = j_start; j < j_end; j++) {
+                a = div255(p_cov[j] * src_a);
+                if (a == 0) {
+                    continue;
+                }
+                uint32_t * p_pix = &((uint32_t *)p_line)[x0 + j];
+                if (a == 255) {
+                    *p_pix = colour;
+                } else {
+                    d = *p_pix;
+                    *p_pix = ((a + div255(((d >> 24) & 0xFF) * (255 - a))) << 24)
+                           | (div255((src_r * a) + (((d >> 16) & 0xFF) * (255 - a))) << 16)
+                           | (div255((src_g * a) + (((d >> 8) & 0xFF) * (255 - a))) << 8)
+                           | div255((src_b * a) + ((d & 0xFF) * (255 - a)));
+                }
+            }
+        }
+    } else {
+        for (i = i_start; i < i_end; i++) {
+            p_line = &_p_buf[_stride * (y0 + i)];
+            p_cov = &p_coverage[_max_width * i];
+            for (j = j_start; j < j_end; j++) {
+                if (p_cov[j] >= 128) {
+                    p_line[x0 + j] = (uint8_t)colour;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,276 @@
+/* mbed UnicodeFont Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          UnicodeFont.h
+* @brief         Proportional font of Unicode (UTF-8) with a glyph cache
+*
+* Font file format (little-endian)
+*
+*   offset  size  contents
+*   0       4     'U' 'F' 'N' 'T'
+*   4       1     version (1)
+*   5       1     bits per pixel of the bitmaps (1 or 4)
+*   6       1     maximum glyph width
+*   7       1     maximum glyph height
+*   8       2     line height
+*   10      2     ascent (distance from the top of the line to the baseline)
+*   12      4     default code (drawn for the characters which are not in the font)
+*   16      4     number of glyphs
+*   20      4     number of kerning pairs
+*   24      4     offset of the glyph index
+*   28      4     offset of the kerning table
+*   32      4     offset of the bitmaps
+*
+* Glyph index entry (16 bytes, sorted by code)
+*   0       4     code (Unicode)
+*   4       4     offset of the bitmap (from the bitmaps)
+*   8       1     bitmap width
+*   9       1     bitmap height
+*   10      1     x offset of the bitmap from the pen position (signed)
+*   11      1     y offset of the top of the bitmap from the baseline (signed, upward is positive)
+*   12      1     advance width
+*   13      3     reserved
+*
+* Kerning pair (12 bytes, sorted by left code, then right code)
+*   0       4     left code
+*   4       4     right code
+*   8       2     adjustment of the advance (signed)
+*   10      2     reserved
+*
+* Bitmap : lines from the top, (width * bits per pixel + 7) / 8 bytes per line, MSB first.
+*          4 bits per pixel is the coverage (0: transparent - 15: opaque) for anti-aliasing.
+*
+* BDF fonts are converted to this format on a PC by tools/bdf2ufnt.cpp (excluded from the mbed build by .mbedignore).
+* fonts/sample_5x7_ufnt.h is a sample font made from fonts/sample_5x7.bdf, which can be opened from ROM:
+* Open(sample_5x7_ufnt, sizeof(sample_5x7_ufnt)).
+******************************************************************************/
+#ifndef __UNICODE_FONT_H__
+#define __UNICODE_FONT_H__
+
+#include "mbed.h"
+
+/** A class to draw UTF-8 strings with a proportional font
+ *
+ * The font is read from a file (the glyph index is loaded to RAM and the bitmaps are read when needed)
+ * or from memory (ROM). Glyphs are converted to 8-bit coverage and kept in a glyph cache,
+ * the least recently used glyph is replaced, so repeated characters are drawn from the cache.
+ * The glyphs are blended with the text field, so the background is kept.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "SdUsbConnect.h"
+ * #include "UnicodeFont.h"
+ *
+ * #define WIDTH           (480)
+ * #define HEIGHT          (272)
+ * #define STRIDE          (((WIDTH * 2u) + 31u) & ~31u)
+ *
+ * static uint8_t text_field[STRIDE * HEIGHT] __attribute((section("NC_BSS"),aligned(32)));
+ *
+ * int main() {
+ *     SdUsbConnect storage("storage");
+ *     UnicodeFont font(text_field, WIDTH, HEIGHT, STRIDE, UnicodeFont::FORMAT_RGB565);
+ *
+ *     storage.wait_connect();
+ *     if (font.Open("/storage/font16.ufn")) {
+ *         font.Erase(0x0000);
+ *         font.DrawStr("Hello, \xE3\x81\x93\xE3\x82\x93\xE3\x81\xAB\xE3\x81\xA1\xE3\x81\xAF", 0, 0, 0xFFFF);
+ *     }
+ * }
+ * @endcode
+ */
+class UnicodeFont {
+public:
+    /*! @enum pixel_format_t
+        @brief Pixel format of the text field
+     */
+    typedef enum {
+        FORMAT_RGB565   = 0,            /*!< RGB565 (2byte / px, CPU byte order) */
+        FORMAT_ARGB8888 = 1,            /*!< ARGB8888 (4byte / px, CPU byte order) */
+        FORMAT_8BIT     = 2,            /*!< CLUT8 or gray scale (1byte / px, no anti-aliasing) */
+    } pixel_format_t;
+
+    /*! @struct stats_t
+        @brief Glyph cache statistics
+     */
+    typedef struct {
+        uint32_t    hits;               /*!< Number of glyphs found in the cache */
+        uint32_t    misses;             /*!< Number of glyphs decoded */
+        uint32_t    evictions;          /*!< Number of glyphs replaced */
+        uint32_t    errors;             /*!< Number of read errors */
+    } stats_t;
+
+    /** Constructor
+     *
+     * @param p_buf Text field address
+     * @param width Text field width
+     * @param height Text field height
+     * @param stride Buffer stride
+     * @param format Pixel format
+     * @param cache_num Number of glyphs in the cache
+     */
+    UnicodeFont(uint8_t * p_buf, int width, int height, int stride, pixel_format_t format, int cache_num = 128);
+
+    /** Destructor
+     */
+    virtual ~UnicodeFont();
+
+    /** Open a font file
+     *
+     * @param file_name font file name
+     * @return true = success, false = failure
+     */
+    bool Open(const char * file_name);
+
+    /** Open a font in memory
+     *
+     * @param p_data font data (must be kept while the font is used)
+     * @param size data size
+     * @return true = success, false = failure
+     */
+    bool Open(const void * p_data, uint32_t size);
+
+    /** Close the font
+     */
+    void Close(void);
+
+    /** Change the text field
+     *
+     * @param p_buf Text field address
+     * @param width Text field width
+     * @param height Text field height
+     * @param stride Buffer stride
+     */
+    void SetTextField(uint8_t * p_buf, int width, int height, int stride);
+
+    /** Erase text field
+     *
+     * @param colour Background color
+     */
+    void Erase(uint32_t const colour);
+
+    /** Erase text field
+     *
+     * @param colour Background color
+     * @param x Erase start position of x coordinate
+     * @param y Erase start position of y coordinate
+     * @param width Erase field width
+     * @param height Erase field height
+     */
+    void Erase(uint32_t const colour, int x, int y, int width, int height);
+
+    /** Draw a string
+     *
+     * @param str String (UTF-8)
+     * @param x Drawing start position of x coordinate
+     * @param y Drawing start position of y coordinate (top of the line)
+     * @param colour Font color
+     * @param max_char_num The maximum number of characters
+     * @return The drawn number of characters (stops at the character which exceeds the right edge)
+     */
+    int DrawStr(const char * str, int x, int y, uint32_t const colour, uint16_t const max_char_num = 0xffff);
+
+    /** Draw a character
+     *
+     * @param code Unicode
+     * @param x Drawing start position of x coordinate (pen position)
+     * @param y Drawing start position of y coordinate (top of the line)
+     * @param colour Font color
+     * @return Advance width, -1 = the character is not in the font
+     */
+    int DrawChar(uint32_t code, int x, int y, uint32_t const colour);
+
+    /** Get the width of a string
+     *
+     * @param str String (UTF-8)
+     * @param max_char_num The maximum number of characters
+     * @return width (pixel)
+     */
+    int GetStrWidth(const char * str, uint16_t const max_char_num = 0xffff);
+
+    /** Get the line height
+     *
+     * @return line height (pixel)
+     */
+    int GetLineHeight(void) {
+        return _line_height;
+    }
+
+    /** Get the glyph cache statistics
+     *
+     * @param p_stats statistics
+     */
+    void GetStats(stats_t * p_stats);
+
+    /** Decode a character of UTF-8
+     *
+     * @param p_str string, advanced to the next character
+     * @return Unicode (0xFFFD: invalid sequence, 0: end of the string)
+     */
+    static uint32_t DecodeUtf8(const char ** p_str);
+
+private:
+    typedef struct {
+        uint32_t    code;
+        int16_t     next;               /* hash chain (-1: end) */
+        bool        used;
+        uint8_t     width;
+        uint8_t     height;
+        int8_t      x_offset;
+        int8_t      y_offset;
+        uint8_t     advance;
+        uint32_t    last_use;
+    } glyph_t;
+
+    uint8_t * _p_buf;
+    int _width;
+    int _height;
+    int _stride;
+    pixel_format_t _format;
+    int _cache_num;
+    FILE * _fp;
+    const uint8_t * _p_data;
+    uint8_t * _p_index;                 /* glyph index and kerning table loaded from the file */
+    const uint8_t * _p_glyph_index;
+    const uint8_t * _p_kerning;
+    uint32_t _glyph_num;
+    uint32_t _kerning_num;
+    uint32_t _bitmap_offset;
+    uint32_t _default_code;
+    int _bpp;
+    int _max_width;
+    int _max_height;
+    int _line_height;
+    int _ascent;
+    glyph_t * _glyph;
+    uint8_t * _coverage;                /* glyph cache (max_width x max_height per glyph) */
+    uint8_t * _read_buf;
+    int16_t * _hash;
+    int _hash_mask;
+    uint32_t _use_count;
+    stats_t _stats;
+
+    bool open_common(const uint8_t * p_header, uint32_t size);
+    const glyph_t * get_glyph(uint32_t code);
+    const uint8_t * find_index(uint32_t code);
+    int get_kerning(uint32_t left, uint32_t right);
+    bool load_glyph(int idx, const uint8_t * p_entry);
+    void blit(const glyph_t * p_glyph, const uint8_t * p_coverage, int x, int y, uint32_t colour);
+};
+
+#endif
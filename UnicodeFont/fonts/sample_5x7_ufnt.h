@@ -0,0 +1,161 @@
+/* Generated by bdf2ufnt from sample_5x7.bdf. Do not edit. */
+#ifndef SAMPLE_5X7_UFNT_H
+#define SAMPLE_5X7_UFNT_H
+
+#include <stdint.h>
+
+/* UnicodeFont::Open(sample_5x7_ufnt, sizeof(sample_5x7_ufnt)) */
+static const uint8_t sample_5x7_ufnt[2389] __attribute((aligned(4))) = {
+    0x55, 0x46, 0x4E, 0x54, 0x01, 0x01, 0x05, 0x09, 0x0A, 0x00, 0x08, 0x00, 0x3F, 0x00, 0x00, 0x00,
+    0x63, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x54, 0x06, 0x00, 0x00,
+    0xFC, 0x06, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x00, 0x07,
+    0x02, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x03, 0x02, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x26, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x07,
+    0x02, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x05, 0x05, 0x00, 0x06,
+    0x06, 0x00, 0x00, 0x00, 0x2B, 0x00, 0x00, 0x00, 0x3A, 0x00, 0x00, 0x00, 0x05, 0x05, 0x00, 0x06,
+    0x06, 0x00, 0x00, 0x00, 0x2C, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x02, 0x03, 0x00, 0x02,
+    0x03, 0x00, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00, 0x42, 0x00, 0x00, 0x00, 0x04, 0x01, 0x00, 0x04,
+    0x05, 0x00, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x43, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01,
+    0x02, 0x00, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x4B, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x31, 0x00, 0x00, 0x00, 0x52, 0x00, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x59, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x33, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x34, 0x00, 0x00, 0x00, 0x67, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x6E, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x36, 0x00, 0x00, 0x00, 0x75, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x37, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x83, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x39, 0x00, 0x00, 0x00, 0x8A, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x3A, 0x00, 0x00, 0x00, 0x91, 0x00, 0x00, 0x00, 0x01, 0x04, 0x00, 0x05,
+    0x02, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x00, 0x00, 0x95, 0x00, 0x00, 0x00, 0x02, 0x06, 0x00, 0x05,
+    0x03, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x9B, 0x00, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x3D, 0x00, 0x00, 0x00, 0xA2, 0x00, 0x00, 0x00, 0x04, 0x03, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0xA5, 0x00, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0xAC, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0xB3, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00, 0xBA, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x42, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x43, 0x00, 0x00, 0x00, 0xC8, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x44, 0x00, 0x00, 0x00, 0xCF, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0xD6, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x46, 0x00, 0x00, 0x00, 0xDD, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x47, 0x00, 0x00, 0x00, 0xE4, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0xEB, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x49, 0x00, 0x00, 0x00, 0xF2, 0x00, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x4A, 0x00, 0x00, 0x00, 0xF9, 0x00, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x4B, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x4C, 0x00, 0x00, 0x00, 0x07, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x4D, 0x00, 0x00, 0x00, 0x0E, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x4E, 0x00, 0x00, 0x00, 0x15, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x4F, 0x00, 0x00, 0x00, 0x1C, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x23, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x51, 0x00, 0x00, 0x00, 0x2A, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x52, 0x00, 0x00, 0x00, 0x31, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x53, 0x00, 0x00, 0x00, 0x38, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0x3F, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x46, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0x4D, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x57, 0x00, 0x00, 0x00, 0x54, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x58, 0x00, 0x00, 0x00, 0x5B, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x59, 0x00, 0x00, 0x00, 0x62, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x5A, 0x00, 0x00, 0x00, 0x69, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x5B, 0x00, 0x00, 0x00, 0x70, 0x01, 0x00, 0x00, 0x02, 0x07, 0x00, 0x07,
+    0x03, 0x00, 0x00, 0x00, 0x5C, 0x00, 0x00, 0x00, 0x77, 0x01, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x5D, 0x00, 0x00, 0x00, 0x7E, 0x01, 0x00, 0x00, 0x02, 0x07, 0x00, 0x07,
+    0x03, 0x00, 0x00, 0x00, 0x5E, 0x00, 0x00, 0x00, 0x85, 0x01, 0x00, 0x00, 0x05, 0x03, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x88, 0x01, 0x00, 0x00, 0x05, 0x01, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x89, 0x01, 0x00, 0x00, 0x02, 0x02, 0x00, 0x07,
+    0x03, 0x00, 0x00, 0x00, 0x61, 0x00, 0x00, 0x00, 0x8B, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x62, 0x00, 0x00, 0x00, 0x90, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x63, 0x00, 0x00, 0x00, 0x97, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x9C, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x65, 0x00, 0x00, 0x00, 0xA3, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x66, 0x00, 0x00, 0x00, 0xA8, 0x01, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x67, 0x00, 0x00, 0x00, 0xAF, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x68, 0x00, 0x00, 0x00, 0xB6, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x69, 0x00, 0x00, 0x00, 0xBD, 0x01, 0x00, 0x00, 0x01, 0x07, 0x00, 0x07,
+    0x02, 0x00, 0x00, 0x00, 0x6A, 0x00, 0x00, 0x00, 0xC4, 0x01, 0x00, 0x00, 0x02, 0x09, 0x00, 0x07,
+    0x03, 0x00, 0x00, 0x00, 0x6B, 0x00, 0x00, 0x00, 0xCD, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0x6C, 0x00, 0x00, 0x00, 0xD4, 0x01, 0x00, 0x00, 0x02, 0x07, 0x00, 0x07,
+    0x03, 0x00, 0x00, 0x00, 0x6D, 0x00, 0x00, 0x00, 0xDB, 0x01, 0x00, 0x00, 0x05, 0x05, 0x00, 0x05,
+    0x06, 0x00, 0x00, 0x00, 0x6E, 0x00, 0x00, 0x00, 0xE0, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x6F, 0x00, 0x00, 0x00, 0xE5, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0xEA, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x71, 0x00, 0x00, 0x00, 0xF1, 0x01, 0x00, 0x00, 0x04, 0x07, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x72, 0x00, 0x00, 0x00, 0xF8, 0x01, 0x00, 0x00, 0x03, 0x05, 0x00, 0x05,
+    0x04, 0x00, 0x00, 0x00, 0x73, 0x00, 0x00, 0x00, 0xFD, 0x01, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x74, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x75, 0x00, 0x00, 0x00, 0x09, 0x02, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x0E, 0x02, 0x00, 0x00, 0x05, 0x05, 0x00, 0x05,
+    0x06, 0x00, 0x00, 0x00, 0x77, 0x00, 0x00, 0x00, 0x13, 0x02, 0x00, 0x00, 0x05, 0x05, 0x00, 0x05,
+    0x06, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x18, 0x02, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x79, 0x00, 0x00, 0x00, 0x1D, 0x02, 0x00, 0x00, 0x04, 0x07, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x7A, 0x00, 0x00, 0x00, 0x24, 0x02, 0x00, 0x00, 0x04, 0x05, 0x00, 0x05,
+    0x05, 0x00, 0x00, 0x00, 0x7B, 0x00, 0x00, 0x00, 0x29, 0x02, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x30, 0x02, 0x00, 0x00, 0x01, 0x08, 0x00, 0x07,
+    0x02, 0x00, 0x00, 0x00, 0x7D, 0x00, 0x00, 0x00, 0x38, 0x02, 0x00, 0x00, 0x03, 0x07, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x3F, 0x02, 0x00, 0x00, 0x05, 0x03, 0x00, 0x05,
+    0x06, 0x00, 0x00, 0x00, 0xB0, 0x00, 0x00, 0x00, 0x42, 0x02, 0x00, 0x00, 0x03, 0x03, 0x00, 0x07,
+    0x04, 0x00, 0x00, 0x00, 0xE9, 0x00, 0x00, 0x00, 0x45, 0x02, 0x00, 0x00, 0x04, 0x07, 0x00, 0x07,
+    0x05, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x4C, 0x02, 0x00, 0x00, 0x04, 0x06, 0x00, 0x06,
+    0x05, 0x00, 0x00, 0x00, 0xAC, 0x20, 0x00, 0x00, 0x52, 0x02, 0x00, 0x00, 0x05, 0x07, 0x00, 0x07,
+    0x06, 0x00, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+    0x41, 0x00, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x46, 0x00, 0x00, 0x00,
+    0x2E, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x4C, 0x00, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0x00, 0x00, 0x4C, 0x00, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+    0x4C, 0x00, 0x00, 0x00, 0x59, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00,
+    0x2E, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0x61, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+    0x54, 0x00, 0x00, 0x00, 0x65, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00,
+    0x6F, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0x6F, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+    0x59, 0x00, 0x00, 0x00, 0x6F, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x80, 0xA0, 0xA0, 0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50, 0x20, 0x78, 0xA0, 0x70,
+    0x28, 0xF0, 0x20, 0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18, 0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90,
+    0x68, 0x80, 0x80, 0x20, 0x40, 0x80, 0x80, 0x80, 0x40, 0x20, 0x80, 0x40, 0x20, 0x20, 0x20, 0x40,
+    0x80, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x40, 0x40, 0x80, 0xF0, 0x80,
+    0x08, 0x10, 0x10, 0x20, 0x40, 0x40, 0x80, 0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70, 0x40, 0xC0,
+    0x40, 0x40, 0x40, 0x40, 0xE0, 0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8, 0x70, 0x88, 0x08, 0x30,
+    0x08, 0x88, 0x70, 0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10, 0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88,
+    0x70, 0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70, 0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, 0x70,
+    0x88, 0x88, 0x70, 0x88, 0x88, 0x70, 0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, 0x80, 0x00, 0x00,
+    0x80, 0x40, 0x00, 0x00, 0x40, 0x40, 0x80, 0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0xF0, 0x00,
+    0xF0, 0x80, 0x40, 0x20, 0x10, 0x20, 0x40, 0x80, 0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, 0x70,
+    0x88, 0xB8, 0xA8, 0xB8, 0x80, 0x78, 0x70, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0xF0, 0x88, 0x88,
+    0xF0, 0x88, 0x88, 0xF0, 0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0xE0, 0x90, 0x88, 0x88, 0x88,
+    0x90, 0xE0, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80,
+    0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0xE0, 0x40,
+    0x40, 0x40, 0x40, 0x40, 0xE0, 0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, 0x88, 0x90, 0xA0, 0xC0,
+    0xA0, 0x90, 0x88, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8, 0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88,
+    0x88, 0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0xF0,
+    0x88, 0x88, 0xF0, 0x80, 0x80, 0x80, 0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68, 0xF0, 0x88, 0x88,
+    0xF0, 0xA0, 0x90, 0x88, 0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0, 0xF8, 0x20, 0x20, 0x20, 0x20,
+    0x20, 0x20, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20,
+    0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50, 0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x88, 0x88,
+    0x50, 0x20, 0x20, 0x20, 0x20, 0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8, 0xC0, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0xC0, 0x80, 0x40, 0x40, 0x20, 0x10, 0x10, 0x08, 0xC0, 0x40, 0x40, 0x40, 0x40, 0x40,
+    0xC0, 0x20, 0x50, 0x88, 0xF8, 0x80, 0x40, 0x70, 0x10, 0x70, 0x90, 0x70, 0x80, 0x80, 0xE0, 0x90,
+    0x90, 0x90, 0xE0, 0x70, 0x80, 0x80, 0x80, 0x70, 0x10, 0x10, 0x70, 0x90, 0x90, 0x90, 0x70, 0x60,
+    0x90, 0xF0, 0x80, 0x70, 0x20, 0x40, 0xE0, 0x40, 0x40, 0x40, 0x40, 0x70, 0x90, 0x90, 0x70, 0x10,
+    0x90, 0x60, 0x80, 0x80, 0xE0, 0x90, 0x90, 0x90, 0x90, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x40, 0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x80, 0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0xD0, 0xA8, 0xA8, 0xA8, 0xA8, 0xE0, 0x90, 0x90, 0x90,
+    0x90, 0x60, 0x90, 0x90, 0x90, 0x60, 0xE0, 0x90, 0x90, 0x90, 0xE0, 0x80, 0x80, 0x70, 0x90, 0x90,
+    0x90, 0x70, 0x10, 0x10, 0xA0, 0xC0, 0x80, 0x80, 0x80, 0x70, 0x80, 0x60, 0x10, 0xE0, 0x40, 0x40,
+    0xE0, 0x40, 0x40, 0x40, 0x20, 0x90, 0x90, 0x90, 0x90, 0x70, 0x88, 0x88, 0x88, 0x50, 0x20, 0x88,
+    0x88, 0xA8, 0xA8, 0x50, 0x90, 0x90, 0x60, 0x90, 0x90, 0x90, 0x90, 0x90, 0x70, 0x10, 0x90, 0x60,
+    0xF0, 0x10, 0x60, 0x80, 0xF0, 0x20, 0x40, 0x40, 0x80, 0x40, 0x40, 0x20, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0x40, 0x20, 0x40, 0x40, 0x80, 0x40, 0xA8, 0x10, 0x40, 0xA0,
+    0x40, 0x20, 0x40, 0x60, 0x90, 0xF0, 0x80, 0x70, 0x90, 0x00, 0x90, 0x90, 0x90, 0x70, 0x38, 0x40,
+    0xF0, 0x40, 0xF0, 0x40, 0x38,
+};
+
+#endif
@@ -0,0 +1,637 @@
+/* mbed UnicodeFont Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          bdf2ufnt.cpp
+* @brief         BDF to UnicodeFont (UFNT) converter for a PC
+*
+* The glyphs are trimmed to the pixels drawn, and the glyphs of the same bitmap share the data.
+* The format of the output is described in UnicodeFont.h.
+*
+* Build:
+*   g++ -O2 -o bdf2ufnt bdf2ufnt.cpp
+*
+* Usage:
+*   bdf2ufnt [-b bpp] [-a scale] [-r ranges] [-k kerning_file] [-c symbol] input.bdf output
+*     -b  bits per pixel of the output, 1 or 4 (default 1)
+*     -a  the BDF is drawn "scale" times larger: it is reduced to 1/scale with 4 bits per pixel
+*         (anti-aliasing, -b 4 is implied)
+*     -r  Unicode ranges to convert (default all), e.g. 0x20-0x7E,0x3040-0x30FF
+*     -k  kerning pairs, one pair per line: left right adjustment (in pixels of the output)
+*         left and right are a character, U+XXXX, 0xXXXX or a decimal number. '#' starts a comment.
+*     -c  write a C header which defines "static const uint8_t symbol[]" instead of a binary file
+*
+* Example:
+*   bdf2ufnt -k ../fonts/sample_5x7_kerning.txt ../fonts/sample_5x7.bdf /storage/sample.ufn
+*   bdf2ufnt -c sample_5x7_ufnt ../fonts/sample_5x7.bdf ../fonts/sample_5x7_ufnt.h
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define UFNT_VERSION            (1)
+#define UFNT_HEADER_SIZE        (36)
+#define UFNT_KERNING_SIZE       (12)
+
+typedef struct {
+    uint32_t    code;
+    int         width;
+    int         height;
+    int         x_offset;               /* from the pen position */
+    int         y_offset;               /* top of the bitmap from the baseline, upward is positive */
+    int         advance;
+    std::vector<uint8_t> pixels;        /* coverage 0 - 15, width x height */
+} glyph_t;
+
+typedef struct {
+    uint32_t    left;
+    uint32_t    right;
+    int         adjust;
+} kerning_t;
+
+typedef struct {
+    uint32_t    first;
+    uint32_t    last;
+} range_t;
+
+typedef struct {
+    int         ascent;
+    int         descent;
+    int32_t     default_char;           /* -1: not set */
+    std::vector<glyph_t> glyphs;
+} font_t;
+
+static void put_le16(std::vector<uint8_t> & buf, uint32_t value) {
+    buf.push_back((uint8_t)value);
+    buf.push_back((uint8_t)(value >> 8));
+}
+
+static void put_le32(std::vector<uint8_t> & buf, uint32_t value) {
+    put_le16(buf, value & 0xFFFF);
+    put_le16(buf, value >> 16);
+}
+
+static int floor_div(int a, int b) {
+    return (a >= 0) ? (a / b) : -(((-a) + b - 1) / b);
+}
+
+static bool parse_code(const char * str, uint32_t * p_code) {
+    char * p_end;
+
+    if ((str[0] == 'U') && (str[1] == '+')) {
+        *p_code = (uint32_t)strtoul(&str[2], &p_end, 16);
+    } else if ((str[0] != '\0') && (str[1] == '\0') && ((str[0] < '0') || (str[0] > '9'))) {
+        *p_code = (uint8_t)str[0];
+        return true;
+    } else {
+        *p_code = (uint32_t)strtoul(str, &p_end, 0);
+    }
+
+    return (*p_end == '\0');
+}
+
+static bool parse_ranges(const char * str, std::vector<range_t> & ranges) {
+    std::string list(str);
+    std::string item;
+    size_t pos = 0;
+    size_t next;
+    size_t dash;
+    range_t range;
+
+    while (pos <= list.size()) {
+        next = list.find(',', pos);
+        if (next == std::string::npos) {
+            next = list.size();
+        }
+        item = list.substr(pos, next - pos);
+        dash = item.find('-');
+        if (dash == std::string::npos) {
+            if (!parse_code(item.c_str(), &range.first)) {
+                return false;
+            }
+            range.last = range.first;
+        } else if ((!parse_code(item.substr(0, dash).c_str(), &range.first))
+                || (!parse_code(item.substr(dash + 1).c_str(), &range.last)) || (range.last < range.first)) {
+            return false;
+        }
+        ranges.push_back(range);
+        pos = next + 1;
+    }
+
+    return true;
+}
+
+static bool in_ranges(const std::vector<range_t> & ranges, uint32_t code) {
+    size_t i;
+
+    if (ranges.empty()) {
+        return true;
+    }
+    for (i = 0; i < ranges.size(); i++) {
+        if ((code >= ranges[i].first) && (code <= ranges[i].last)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Remove the lines and the columns without pixels */
+static void trim_glyph(glyph_t * p_glyph) {
+    int left = p_glyph->width;
+    int right = -1;
+    int top = p_glyph->height;
+    int bottom = -1;
+    int x;
+    int y;
+    std::vector<uint8_t> pixels;
+
+    for (y = 0; y < p_glyph->height; y++) {
+        for (x = 0; x < p_glyph->width; x++) {
+            if (p_glyph->pixels[(y * p_glyph->width) + x] != 0) {
+                left   = std::min(left, x);
+                right  = std::max(right, x);
+                top    = std::min(top, y);
+                bottom = std::max(bottom, y);
+            }
+        }
+    }
+    if (right < 0) {
+        // No pixels (space)
+        p_glyph->width    = 0;
+        p_glyph->height   = 0;
+        p_glyph->x_offset = 0;
+        p_glyph->y_offset = 0;
+        p_glyph->pixels.clear();
+        return;
+    }
+    for (y = top; y <= bottom; y++) {
+        for (x = left; x <= right; x++) {
+            pixels.push_back(p_glyph->pixels[(y * p_glyph->width) + x]);
+        }
+    }
+    p_glyph->x_offset += left;
+    p_glyph->y_offset -= top;
+    p_glyph->width     = right - left + 1;
+    p_glyph->height    = bottom - top + 1;
+    p_glyph->pixels.swap(pixels);
+}
+
+/* Reduce a glyph drawn "scale" times larger to 4-bit coverage */
+static void reduce_glyph(glyph_t * p_glyph, int scale) {
+    int x0 = floor_div(p_glyph->x_offset, scale);
+    int x1 = floor_div(p_glyph->x_offset + p_glyph->width - 1, scale);
+    int y_bottom = p_glyph->y_offset - p_glyph->height;     /* bottom of the bitmap from the baseline */
+    int y0 = floor_div(y_bottom, scale);
+    int y1 = floor_div(p_glyph->y_offset - 1, scale);
+    int width = x1 - x0 + 1;
+    int height = y1 - y0 + 1;
+    std::vector<int> count(width * height, 0);
+    std::vector<uint8_t> pixels(width * height);
+    int x;
+    int y;
+    int ux;
+    int uy;
+    int i;
+
+    for (y = 0; y < p_glyph->height; y++) {
+        uy = p_glyph->y_offset - 1 - y;                     /* upward position of the pixel */
+        for (x = 0; x < p_glyph->width; x++) {
+            if (p_glyph->pixels[(y * p_glyph->width) + x] != 0) {
+                ux = p_glyph->x_offset + x;
+                count[((y1 - floor_div(uy, scale)) * width) + (floor_div(ux, scale) - x0)]++;
+            }
+        }
+    }
+    for (i = 0; i < (width * height); i++) {
+        pixels[i] = (uint8_t)(((count[i] * 15) + ((scale * scale) / 2)) / (scale * scale));
+    }
+    p_glyph->x_offset = x0;
+    p_glyph->y_offset = y1 + 1;
+    p_glyph->width    = width;
+    p_glyph->height   = height;
+    p_glyph->advance  = (p_glyph->advance + (scale / 2)) / scale;
+    p_glyph->pixels.swap(pixels);
+}
+
+static bool read_bdf(const char * path, const std::vector<range_t> & ranges, font_t * p_font) {
+    FILE * fp = fopen(path, "r");
+    char line[1024];
+    char keyword[64];
+    int line_no = 0;
+    int bbox[4] = {0, 0, 0, 0};
+    int char_bbox[4];
+    int row = -1;
+    int len;
+    int x;
+    long code = -1;
+    int advance = 0;
+    char hex[3] = {0, 0, 0};
+    glyph_t glyph;
+
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    p_font->ascent = -1;
+    p_font->descent = -1;
+    p_font->default_char = -1;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+        if (sscanf(line, "%63s", keyword) != 1) {
+            continue;
+        }
+        if (row >= 0) {
+            if (strcmp(keyword, "ENDCHAR") == 0) {
+                if ((code >= 0) && (in_ranges(ranges, (uint32_t)code))) {
+                    p_font->glyphs.push_back(glyph);
+                }
+                row = -1;
+            } else if (row < glyph.height) {
+                // Bitmap line: hex digits, MSB first
+                len = (int)strlen(keyword);
+                for (x = 0; (x < glyph.width) && ((((x / 8) * 2) + 1) < len); x++) {
+                    hex[0] = keyword[(x / 8) * 2];
+                    hex[1] = keyword[((x / 8) * 2) + 1];
+                    if ((strtoul(hex, NULL, 16) >> (7 - (x & 7))) & 1) {
+                        glyph.pixels[(row * glyph.width) + x] = 15;
+                    }
+                }
+                row++;
+            }
+        } else if (strcmp(keyword, "FONTBOUNDINGBOX") == 0) {
+            sscanf(line, "%*s %d %d %d %d", &bbox[0], &bbox[1], &bbox[2], &bbox[3]);
+        } else if (strcmp(keyword, "FONT_ASCENT") == 0) {
+            sscanf(line, "%*s %d", &p_font->ascent);
+        } else if (strcmp(keyword, "FONT_DESCENT") == 0) {
+            sscanf(line, "%*s %d", &p_font->descent);
+        } else if (strcmp(keyword, "DEFAULT_CHAR") == 0) {
+            sscanf(line, "%*s %d", &p_font->default_char);
+        } else if (strcmp(keyword, "STARTCHAR") == 0) {
+            code = -1;
+            advance = 0;
+            memcpy(char_bbox, bbox, sizeof(char_bbox));
+        } else if (strcmp(keyword, "ENCODING") == 0) {
+            sscanf(line, "%*s %ld", &code);
+        } else if (strcmp(keyword, "DWIDTH") == 0) {
+            sscanf(line, "%*s %d", &advance);
+        } else if (strcmp(keyword, "BBX") == 0) {
+            sscanf(line, "%*s %d %d %d %d", &char_bbox[0], &char_bbox[1], &char_bbox[2], &char_bbox[3]);
+        } else if (strcmp(keyword, "BITMAP") == 0) {
+            if ((char_bbox[0] < 0) || (char_bbox[1] < 0)) {
+                fprintf(stderr, "%s:%d: invalid BBX\n", path, line_no);
+                fclose(fp);
+                return false;
+            }
+            glyph.code     = (uint32_t)code;
+            glyph.width    = char_bbox[0];
+            glyph.height   = char_bbox[1];
+            glyph.x_offset = char_bbox[2];
+            glyph.y_offset = char_bbox[3] + char_bbox[1];
+            glyph.advance  = advance;
+            glyph.pixels.assign(glyph.width * glyph.height, 0);
+            row = 0;
+        } else {
+            // other keywords are not used
+        }
+    }
+    fclose(fp);
+
+    if (p_font->ascent < 0) {
+        p_font->ascent = bbox[1] + bbox[3];
+    }
+    if (p_font->descent < 0) {
+        p_font->descent = -bbox[3];
+    }
+
+    return true;
+}
+
+static bool read_kerning(const char * path, std::vector<kerning_t> & kerning) {
+    FILE * fp = fopen(path, "r");
+    char line[256];
+    char left[64];
+    char right[64];
+    int line_no = 0;
+    kerning_t pair;
+    char * p_comment;
+
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+        // '#' alone is a character, "# " starts a comment
+        p_comment = strstr(line, "# ");
+        if ((p_comment != NULL) && ((p_comment == line) || (p_comment[-1] == ' ') || (p_comment[-1] == '\t'))) {
+            *p_comment = '\0';
+        }
+        if (sscanf(line, "%63s %63s %d", left, right, &pair.adjust) != 3) {
+            if (sscanf(line, "%63s", left) == 1) {
+                fprintf(stderr, "%s:%d: invalid line\n", path, line_no);
+                fclose(fp);
+                return false;
+            }
+            continue;
+        }
+        if ((!parse_code(left, &pair.left)) || (!parse_code(right, &pair.right))) {
+            fprintf(stderr, "%s:%d: invalid code\n", path, line_no);
+            fclose(fp);
+            return false;
+        }
+        kerning.push_back(pair);
+    }
+    fclose(fp);
+
+    return true;
+}
+
+static void encode_bitmap(const glyph_t * p_glyph, int bpp, std::vector<uint8_t> & bitmap) {
+    int line_size = ((p_glyph->width * bpp) + 7) / 8;
+    size_t top = bitmap.size();
+    uint8_t value;
+    int x;
+    int y;
+
+    bitmap.resize(top + (line_size * p_glyph->height), 0);
+    for (y = 0; y < p_glyph->height; y++) {
+        for (x = 0; x < p_glyph->width; x++) {
+            value = p_glyph->pixels[(y * p_glyph->width) + x];
+            if (bpp == 1) {
+                if (value >= 8) {
+                    bitmap[top + (y * line_size) + (x >> 3)] |= (uint8_t)(0x80 >> (x & 7));
+                }
+            } else {
+                bitmap[top + (y * line_size) + (x >> 1)] |= (uint8_t)(value << ((x & 1) ? 0 : 4));
+            }
+        }
+    }
+}
+
+static bool kerning_less(const kerning_t & a, const kerning_t & b) {
+    return (a.left != b.left) ? (a.left < b.left) : (a.right < b.right);
+}
+
+static bool glyph_less(const glyph_t & a, const glyph_t & b) {
+    return a.code < b.code;
+}
+
+static bool make_ufnt(font_t * p_font, std::vector<kerning_t> & kerning, int bpp, std::vector<uint8_t> & out) {
+    std::map<std::vector<uint8_t>, uint32_t> shared;
+    std::vector<uint8_t> bitmaps;
+    std::vector<uint8_t> index;
+    std::vector<uint8_t> data;
+    std::map<std::vector<uint8_t>, uint32_t>::iterator it;
+    uint32_t default_code;
+    uint32_t offset;
+    int max_width = 1;
+    int max_height = 1;
+    size_t i;
+
+    std::sort(p_font->glyphs.begin(), p_font->glyphs.end(), glyph_less);
+    std::sort(kerning.begin(), kerning.end(), kerning_less);
+    for (i = 1; i < p_font->glyphs.size(); i++) {
+        if (p_font->glyphs[i].code == p_font->glyphs[i - 1].code) {
+            fprintf(stderr, "U+%04X is defined twice\n", p_font->glyphs[i].code);
+            return false;
+        }
+    }
+
+    for (i = 0; i < p_font->glyphs.size(); i++) {
+        const glyph_t & glyph = p_font->glyphs[i];
+
+        if ((glyph.width > 255) || (glyph.height > 255) || (glyph.advance < 0) || (glyph.advance > 255)
+         || (glyph.x_offset < -128) || (glyph.x_offset > 127) || (glyph.y_offset < -128) || (glyph.y_offset > 127)) {
+            fprintf(stderr, "U+%04X is too large\n", glyph.code);
+            return false;
+        }
+        max_width  = std::max(max_width, glyph.width);
+        max_height = std::max(max_height, glyph.height);
+
+        // Same bitmap: the data is shared
+        data.clear();
+        encode_bitmap(&glyph, bpp, data);
+        data.push_back((uint8_t)glyph.width);
+        it = shared.find(data);
+        if (it != shared.end()) {
+            offset = it->second;
+        } else {
+            offset = (uint32_t)bitmaps.size();
+            encode_bitmap(&glyph, bpp, bitmaps);
+            shared[data] = offset;
+        }
+
+        put_le32(index, glyph.code);
+        put_le32(index, offset);
+        index.push_back((uint8_t)glyph.width);
+        index.push_back((uint8_t)glyph.height);
+        index.push_back((uint8_t)(int8_t)glyph.x_offset);
+        index.push_back((uint8_t)(int8_t)glyph.y_offset);
+        index.push_back((uint8_t)glyph.advance);
+        index.push_back(0);
+        index.push_back(0);
+        index.push_back(0);
+    }
+
+    // The default character: DEFAULT_CHAR of the BDF, '?' or the first glyph
+    default_code = p_font->glyphs[0].code;
+    for (i = 0; i < p_font->glyphs.size(); i++) {
+        if (p_font->glyphs[i].code == '?') {
+            default_code = '?';
+        }
+    }
+    for (i = 0; i < p_font->glyphs.size(); i++) {
+        if ((p_font->default_char >= 0) && (p_font->glyphs[i].code == (uint32_t)p_font->default_char)) {
+            default_code = (uint32_t)p_font->default_char;
+        }
+    }
+
+    out.clear();
+    out.push_back('U');
+    out.push_back('F');
+    out.push_back('N');
+    out.push_back('T');
+    out.push_back(UFNT_VERSION);
+    out.push_back((uint8_t)bpp);
+    out.push_back((uint8_t)max_width);
+    out.push_back((uint8_t)max_height);
+    put_le16(out, (uint32_t)(p_font->ascent + p_font->descent));
+    put_le16(out, (uint32_t)p_font->ascent);
+    put_le32(out, default_code);
+    put_le32(out, (uint32_t)p_font->glyphs.size());
+    put_le32(out, (uint32_t)kerning.size());
+    put_le32(out, UFNT_HEADER_SIZE);
+    put_le32(out, (uint32_t)(UFNT_HEADER_SIZE + index.size()));
+    put_le32(out, (uint32_t)(UFNT_HEADER_SIZE + index.size() + (kerning.size() * UFNT_KERNING_SIZE)));
+    out.insert(out.end(), index.begin(), index.end());
+    for (i = 0; i < kerning.size(); i++) {
+        put_le32(out, kerning[i].left);
+        put_le32(out, kerning[i].right);
+        put_le16(out, (uint32_t)(int16_t)kerning[i].adjust);
+        put_le16(out, 0);
+    }
+    out.insert(out.end(), bitmaps.begin(), bitmaps.end());
+
+    printf("%u glyphs, %u kerning pairs, %dbpp, max %dx%d, line height %d, ascent %d, %u bytes\n",
+           (uint32_t)p_font->glyphs.size(), (uint32_t)kerning.size(), bpp, max_width, max_height,
+           p_font->ascent + p_font->descent, p_font->ascent, (uint32_t)out.size());
+
+    return true;
+}
+
+static bool write_binary(const char * path, const std::vector<uint8_t> & data) {
+    FILE * fp = fopen(path, "wb");
+    bool ret;
+
+    if (fp == NULL) {
+        return false;
+    }
+    ret = (fwrite(&data[0], 1, data.size(), fp) == data.size());
+    if (fclose(fp) != 0) {
+        ret = false;
+    }
+
+    return ret;
+}
+
+static bool write_header(const char * path, const char * symbol, const char * source,
+                         const std::vector<uint8_t> & data) {
+    FILE * fp = fopen(path, "w");
+    std::string guard(symbol);
+    const char * p_name = strrchr(source, '/');
+    size_t i;
+    bool ret;
+
+    if (fp == NULL) {
+        return false;
+    }
+    for (i = 0; i < guard.size(); i++) {
+        guard[i] = (char)toupper((unsigned char)guard[i]);
+    }
+    fprintf(fp, "/* Generated by bdf2ufnt from %s. Do not edit. */\n", (p_name != NULL) ? (p_name + 1) : source);
+    fprintf(fp, "#ifndef %s_H\n#define %s_H\n\n#include <stdint.h>\n\n", guard.c_str(), guard.c_str());
+    fprintf(fp, "/* UnicodeFont::Open(%s, sizeof(%s)) */\n", symbol, symbol);
+    fprintf(fp, "static const uint8_t %s[%u] __attribute((aligned(4))) = {\n", symbol, (uint32_t)data.size());
+    for (i = 0; i < data.size(); i++) {
+        fprintf(fp, "%s0x%02X,%s", ((i % 16) == 0) ? "    " : "", data[i],
+                (((i % 16) == 15) || (i == (data.size() - 1))) ? "\n" : " ");
+    }
+    fprintf(fp, "};\n\n#endif\n");
+    ret = (ferror(fp) == 0);
+    if (fclose(fp) != 0) {
+        ret = false;
+    }
+
+    return ret;
+}
+
+static void usage(const char * name) {
+    fprintf(stderr, "usage: %s [-b bpp] [-a scale] [-r ranges] [-k kerning_file] [-c symbol] input.bdf output\n",
+            name);
+}
+
+int main(int argc, char * argv[]) {
+    std::vector<range_t> ranges;
+    std::vector<kerning_t> kerning;
+    std::vector<uint8_t> out;
+    font_t font;
+    const char * kerning_path = NULL;
+    const char * symbol = NULL;
+    int bpp = 1;
+    int scale = 1;
+    int opt;
+    size_t i;
+
+    while ((opt = getopt(argc, argv, "b:a:r:k:c:")) != -1) {
+        switch (opt) {
+            case 'b':
+                bpp = atoi(optarg);
+                break;
+            case 'a':
+                scale = atoi(optarg);
+                break;
+            case 'r':
+                if (!parse_ranges(optarg, ranges)) {
+                    fprintf(stderr, "invalid ranges: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'k':
+                kerning_path = optarg;
+                break;
+            case 'c':
+                symbol = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (((bpp != 1) && (bpp != 4)) || (scale < 1) || (scale > 16) || ((optind + 2) != argc)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (scale > 1) {
+        bpp = 4;
+    }
+
+    if (!read_bdf(argv[optind], ranges, &font)) {
+        return 1;
+    }
+    if (font.glyphs.empty()) {
+        fprintf(stderr, "no glyphs\n");
+        return 1;
+    }
+    if ((kerning_path != NULL) && (!read_kerning(kerning_path, kerning))) {
+        return 1;
+    }
+    for (i = 0; i < font.glyphs.size(); i++) {
+        if (scale > 1) {
+            trim_glyph(&font.glyphs[i]);
+            if (font.glyphs[i].width != 0) {
+                reduce_glyph(&font.glyphs[i], scale);
+            } else {
+                font.glyphs[i].advance = (font.glyphs[i].advance + (scale / 2)) / scale;
+            }
+        }
+        trim_glyph(&font.glyphs[i]);
+    }
+    font.ascent  = (font.ascent + scale - 1) / scale;
+    font.descent = (font.descent + scale - 1) / scale;
+
+    if (!make_ufnt(&font, kerning, bpp, out)) {
+        return 1;
+    }
+    if (symbol != NULL) {
+        if (!write_header(argv[optind + 1], symbol, argv[optind], out)) {
+            fprintf(stderr, "cannot write %s\n", argv[optind + 1]);
+            return 1;
+        }
+    } else if (!write_binary(argv[optind + 1], out)) {
+        fprintf(stderr, "cannot write %s\n", argv[optind + 1]);
+        return 1;
+    }
+
+    return 0;
+}
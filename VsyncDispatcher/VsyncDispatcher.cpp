@@ -0,0 +1,84 @@
+/* mbed VsyncDispatcher Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "VsyncDispatcher.h"
+
+static Callback<void()> vsync_func[VSYNC_DISPATCHER_FUNC_MAX];
+static DisplayBase * vsync_display = NULL;
+static int vsync_func_num = 0;
+
+int VsyncDispatcher::Attach(DisplayBase * display, Callback<void()> func)
+{
+    int id;
+
+    if ((display == NULL) || (!func)) {
+        return -1;
+    }
+
+    // The handler is changed in the critical section, so Detach() of the last function
+    // does not clear the handler set by the next Attach()
+    core_util_critical_section_enter();
+    for (id = 0; id < VSYNC_DISPATCHER_FUNC_MAX; id++) {
+        if (!vsync_func[id]) {
+            break;
+        }
+    }
+    if (id >= VSYNC_DISPATCHER_FUNC_MAX) {
+        core_util_critical_section_exit();
+        return -1;
+    }
+    vsync_func[id] = func;
+    if (vsync_func_num == 0) {
+        vsync_display = display;
+        vsync_display->Graphics_Irq_Handler_Set(DisplayBase::INT_TYPE_S0_LO_VSYNC, 0, &vsync_isr);
+    }
+    vsync_func_num++;
+    core_util_critical_section_exit();
+
+    return id;
+}
+
+void VsyncDispatcher::Detach(int id)
+{
+    if ((id < 0) || (id >= VSYNC_DISPATCHER_FUNC_MAX)) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    if (vsync_func[id]) {
+        vsync_func[id] = Callback<void()>();
+        vsync_func_num--;
+        if (vsync_func_num == 0) {
+            vsync_display->Graphics_Irq_Handler_Set(DisplayBase::INT_TYPE_S0_LO_VSYNC, 0, NULL);
+            vsync_display = NULL;
+        }
+    }
+    core_util_critical_section_exit();
+}
+
+void VsyncDispatcher::vsync_isr(DisplayBase::int_type_t int_type)
+{
+    int id;
+
+    (void)int_type;
+
+    for (id = 0; id < VSYNC_DISPATCHER_FUNC_MAX; id++) {
+        if (vsync_func[id]) {
+            vsync_func[id].call();
+        }
+    }
+}
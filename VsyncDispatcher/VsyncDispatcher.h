@@ -0,0 +1,82 @@
+/* mbed VsyncDispatcher Library
+ * Copyright (C) 2019 dkato
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**************************************************************************//**
+* @file          VsyncDispatcher.h
+* @brief         Vsync interrupt shared by several modules
+******************************************************************************/
+#ifndef __VSYNC_DISPATCHER_H__
+#define __VSYNC_DISPATCHER_H__
+
+#include "mbed.h"
+#include "DisplayBace.h"
+
+/** Maximum number of functions called at the vsync */
+#ifndef VSYNC_DISPATCHER_FUNC_MAX
+#define VSYNC_DISPATCHER_FUNC_MAX   (8)
+#endif
+
+/** A class to share the vsync interrupt (INT_TYPE_S0_LO_VSYNC) of DisplayBase
+ *
+ * Graphics_Irq_Handler_Set() has only one handler for each interrupt type.
+ * The modules (PresentQueue, EasyMoviePlayer) and the application attach their functions here
+ * instead of setting the handler. The handler is set when the first function is attached,
+ * and cleared when the last function is detached.
+ * The functions are called in the interrupt context, in the order of the ID.
+ *
+ * Example
+ * @code
+ * #include "mbed.h"
+ * #include "VsyncDispatcher.h"
+ *
+ * DisplayBase Display;
+ * static volatile uint32_t vsync_count = 0;
+ *
+ * static void vsync_func(void) {
+ *     vsync_count++;
+ * }
+ *
+ * int main() {
+ *     // Start the LCD here
+ *     int id = VsyncDispatcher::Attach(&Display, &vsync_func);
+ *     ...
+ *     VsyncDispatcher::Detach(id);
+ * }
+ * @endcode
+ */
+class VsyncDispatcher {
+public:
+    /** Attach a function called at the vsync
+     *
+     * @param display display (the handler is set to this display by the first attachment)
+     * @param func function called in the vsync interrupt
+     * @return ID used by Detach(), -1 = failure (no free entry or func is empty)
+     */
+    static int Attach(DisplayBase * display, Callback<void()> func);
+
+    /** Detach a function
+     *
+     * @param id ID returned by Attach()
+     */
+    static void Detach(int id);
+
+private:
+    VsyncDispatcher();
+
+    static void vsync_isr(DisplayBase::int_type_t int_type);
+};
+
+#endif